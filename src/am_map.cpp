@@ -26,6 +26,7 @@
 //-----------------------------------------------------------------------------
 
 #include <stdio.h>
+#include <float.h>
 #include <array>
 
 #include "doomdef.h"
@@ -1010,6 +1011,7 @@ class DAutomap :public DAutomapBase
 	void changeWindowScale(double delta);
 	void clearFB(const AMColor &color);
 	bool clipMline(mline_t *ml, fline_t *fl);
+	bool isMapBoxVisible(double left, double bottom, double right, double top);
 	void drawMline(mline_t *ml, const AMColor &color);
 	void drawMline(mline_t *ml, int colorindex);
 	void drawGrid(int color);
@@ -1723,6 +1725,30 @@ bool DAutomap::clipMline (mline_t *ml, fline_t *fl)
 	return true;
 }
 
+//=============================================================================
+//
+// Checks if a map space box can be inside the automap's window.
+// This is done before any rotation or classification so that the parts of
+// big maps that are far off screen cost as little as possible.
+//
+//=============================================================================
+
+bool DAutomap::isMapBoxVisible(double left, double bottom, double right, double top)
+{
+	double extx = m_w / 2;
+	double exty = m_h / 2;
+	double centerx = m_x + extx;
+	double centery = m_y + exty;
+
+	if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+	{
+		// The map rotates around the window's center so anything within
+		// its circumscribed circle can end up on screen.
+		extx = exty = sqrt(extx * extx + exty * exty);
+	}
+	return right >= centerx - extx && left <= centerx + extx && top >= centery - exty && bottom <= centery + exty;
+}
+
 //=============================================================================
 //
 // Clip lines, draw visible parts of lines.
@@ -1967,6 +1993,21 @@ void DAutomap::drawSubsectors()
 			continue;
 		}
 
+		// Skip everything that is off screen before doing any of the lighting and texture work.
+		double left = DBL_MAX, bottom = DBL_MAX, right = -DBL_MAX, top = -DBL_MAX;
+		for (uint32_t j = 0; j < sub->numlines; ++j)
+		{
+			auto v = sub->firstline[j].v1;
+			left = MIN(left, v->fX());
+			right = MAX(right, v->fX());
+			bottom = MIN(bottom, v->fY());
+			top = MAX(top, v->fY());
+		}
+		if (!isMapBoxVisible(left, bottom, right, top))
+		{
+			continue;
+		}
+
 		// Fill the points array from the subsector.
 		points.Resize(sub->numlines);
 		for (uint32_t j = 0; j < sub->numlines; ++j)
@@ -2507,6 +2548,11 @@ void DAutomap::drawWalls (bool allmap)
 			}
 			else continue;
 
+			if (!isMapBoxVisible(line.bbox[BOXLEFT] + offset.X, line.bbox[BOXBOTTOM] + offset.Y, line.bbox[BOXRIGHT] + offset.X, line.bbox[BOXTOP] + offset.Y))
+			{
+				continue;
+			}
+
 			l.a.x = (line.v1->fX() + offset.X);
 			l.a.y = (line.v1->fY() + offset.Y);
 			l.b.x = (line.v2->fX() + offset.X);
@@ -189,18 +189,143 @@ DEFINE_ACTION_FUNCTION_NATIVE(DShape2D, PushTriangle, Shape2D_PushTriangle)
 //
 //==========================================================================
 
+void F2DDrawer::SetBounds(RenderCommand &cmd)
+{
+	if (cmd.mVertCount <= 0)
+	{
+		cmd.mBounds[0] = cmd.mBounds[1] = cmd.mBounds[2] = cmd.mBounds[3] = 0;
+		return;
+	}
+	auto ptr = &mVertices[cmd.mVertIndex];
+	float x1 = ptr->x, y1 = ptr->y, x2 = ptr->x, y2 = ptr->y;
+	for (int i = 1; i < cmd.mVertCount; i++)
+	{
+		x1 = std::min(x1, ptr[i].x);
+		y1 = std::min(y1, ptr[i].y);
+		x2 = std::max(x2, ptr[i].x);
+		y2 = std::max(y2, ptr[i].y);
+	}
+	// Leave some room for lines, points and texture filtering reaching into the neighboring pixels.
+	cmd.mBounds[0] = x1 - 1;
+	cmd.mBounds[1] = y1 - 1;
+	cmd.mBounds[2] = x2 + 1;
+	cmd.mBounds[3] = y2 + 1;
+}
+
+//==========================================================================
+//
+// Status bars and fonts interleave different textures a lot, so only
+// merging with the last command leaves many tiny draw calls. Instead look
+// back over the last few commands for one this can be merged with. It may
+// be moved in front of all commands in between as long as it does not touch
+// any of them, because then the order in which they are drawn is irrelevant.
+// Only the index data needs to be rearranged for this. Lines and points draw
+// directly from their vertices and are not affected by that.
+//
+//==========================================================================
+
+enum { MAX_2D_LOOKBACK = 32 };
+
+bool F2DDrawer::MergeCommand(const RenderCommand &cmd)
+{
+	if (cmd.mType != DrawTypeTriangles)
+	{
+		// These are drawn from their vertex range, so they can only ever be appended to the last command.
+		auto &last = mData.Last();
+		if (!cmd.isCompatible(last)) return false;
+		last.mVertCount += cmd.mVertCount;
+		return true;
+	}
+	// The new indices must be at the end of the buffer so that they can be moved.
+	if (cmd.mIndexIndex + cmd.mIndexCount != (int)mIndices.Size()) return false;
+
+	int expected = cmd.mIndexIndex;
+	for (int i = (int)mData.Size() - 1, n = 0; i >= 0 && n < MAX_2D_LOOKBACK; i--, n++)
+	{
+		auto &other = mData[i];
+		if (other.mType == DrawTypeTriangles)
+		{
+			// Only move across commands whose indices are stored in the same order as the commands themselves.
+			if (other.mIndexIndex + other.mIndexCount != expected) return false;
+			if (cmd.isCompatible(other))
+			{
+				if (expected != cmd.mIndexIndex)
+				{
+					std::rotate(mIndices.Data() + expected, mIndices.Data() + cmd.mIndexIndex, mIndices.Data() + mIndices.Size());
+					for (unsigned j = i + 1; j < mData.Size(); j++)
+					{
+						if (mData[j].mType == DrawTypeTriangles) mData[j].mIndexIndex += cmd.mIndexCount;
+					}
+				}
+				other.mIndexCount += cmd.mIndexCount;
+				other.mVertCount += cmd.mVertCount;
+				other.mBounds[0] = std::min(other.mBounds[0], cmd.mBounds[0]);
+				other.mBounds[1] = std::min(other.mBounds[1], cmd.mBounds[1]);
+				other.mBounds[2] = std::max(other.mBounds[2], cmd.mBounds[2]);
+				other.mBounds[3] = std::max(other.mBounds[3], cmd.mBounds[3]);
+				return true;
+			}
+			expected = other.mIndexIndex;
+		}
+		if (other.Overlaps(cmd)) return false;
+	}
+	return false;
+}
+
 int F2DDrawer::AddCommand(const RenderCommand *data) 
 {
-	if (mData.Size() > 0 && data->isCompatible(mData.Last()))
+	RenderCommand cmd = *data;
+	SetBounds(cmd);
+	for (auto recording : mRecordings)
+	{
+		// Take a copy before merging can move the indices around.
+		auto &rec = *recording;
+		RenderCommand &copy = rec.Commands[rec.Commands.Push(cmd)];
+		copy.mVertIndex = rec.Vertices.Reserve(cmd.mVertCount);
+		if (cmd.mVertCount > 0) memcpy(&rec.Vertices[copy.mVertIndex], &mVertices[cmd.mVertIndex], cmd.mVertCount * sizeof(TwoDVertex));
+		if (cmd.mType == DrawTypeTriangles)
+		{
+			copy.mIndexIndex = rec.Indices.Size();
+			for (int i = 0; i < cmd.mIndexCount; i++)
+			{
+				rec.Indices.Push(mIndices[cmd.mIndexIndex + i] - cmd.mVertIndex + copy.mVertIndex);
+			}
+		}
+	}
+	if (mData.Size() > 0 && MergeCommand(cmd))
 	{
-		// Merge with the last command.
-		mData.Last().mIndexCount += data->mIndexCount;
-		mData.Last().mVertCount += data->mVertCount;
 		return mData.Size();
 	}
 	else
 	{
-		return mData.Push(*data);
+		return mData.Push(cmd);
+	}
+}
+
+//==========================================================================
+//
+// Adds everything from a recording as if the draw calls were made again.
+//
+//==========================================================================
+
+void F2DDrawer::Replay(const FRecordedDraws &rec)
+{
+	if (rec.Commands.Size() == 0) return;
+	int vbase = mVertices.Reserve(rec.Vertices.Size());
+	if (rec.Vertices.Size() > 0) memcpy(&mVertices[vbase], rec.Vertices.Data(), rec.Vertices.Size() * sizeof(TwoDVertex));
+	for (auto cmd : rec.Commands)
+	{
+		if (cmd.mType == DrawTypeTriangles)
+		{
+			int ibase = mIndices.Reserve(cmd.mIndexCount);
+			for (int i = 0; i < cmd.mIndexCount; i++)
+			{
+				mIndices[ibase + i] = rec.Indices[cmd.mIndexIndex + i] + vbase;
+			}
+			cmd.mIndexIndex = ibase;
+		}
+		cmd.mVertIndex += vbase;
+		AddCommand(&cmd);
 	}
 }
 
@@ -835,6 +960,7 @@ void F2DDrawer::AddColorOnlyQuad(int x1, int y1, int w, int h, PalEntry color, F
 	{
 		// Only needed by Raze's fullscreen blends because they are being calculated late when half of the 2D content has already been submitted,
 		// This ensures they are below the HUD, not above it.
+		SetBounds(dg);
 		mData.Insert(0, dg);
 	}
 }
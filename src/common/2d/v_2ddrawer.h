@@ -134,6 +134,7 @@ public:
 		ETexMode mDrawMode;
 		uint8_t mLightLevel;
 		uint8_t mFlags;
+		float mBounds[4];	// screen area covered by the vertices, used to decide whether commands may be reordered.
 
 		RenderCommand()
 		{
@@ -157,6 +158,12 @@ public:
 				mColor1.d == other.mColor1.d;
 
 		}
+
+		bool Overlaps(const RenderCommand &other) const
+		{
+			return mBounds[0] < other.mBounds[2] && other.mBounds[0] < mBounds[2] &&
+				mBounds[1] < other.mBounds[3] && other.mBounds[1] < mBounds[3];
+		}
 	};
 
 	TArray<int> mIndices;
@@ -164,13 +171,37 @@ public:
 	TArray<RenderCommand> mData;
 	int Width, Height;
 	bool isIn2D;
+
+	// The output of a sequence of draw calls, so that it can be added again without going through all the setup.
+	// Vertex and index positions are relative to the recording.
+	struct FRecordedDraws
+	{
+		TArray<RenderCommand> Commands;
+		TArray<TwoDVertex> Vertices;
+		TArray<int> Indices;
+
+		void Clear()
+		{
+			Commands.Clear();
+			Vertices.Clear();
+			Indices.Clear();
+		}
+	};
+private:
+	TArray<FRecordedDraws *> mRecordings;	// Recordings can be nested, every command goes into all of them.
 public:
+	void BeginRecording(FRecordedDraws *rec) { mRecordings.Push(rec); }
+	void EndRecording() { mRecordings.Pop(); }
+	void Replay(const FRecordedDraws &rec);
+
 	int fullscreenautoaspect = 0;
 	int cliptop = -1, clipleft = -1, clipwidth = -1, clipheight = -1;
 	
 	int AddCommand(const RenderCommand *data);
 	void AddIndices(int firstvert, int count, ...);
 private:
+	void SetBounds(RenderCommand &cmd);
+	bool MergeCommand(const RenderCommand &cmd);
 	void AddIndices(int firstvert, TArray<int> &v);
 	bool SetStyle(FGameTexture *tex, DrawParms &parms, PalEntry &color0, RenderCommand &quad);
 	void SetColorOverlay(PalEntry color, float alpha, PalEntry &vertexcolor, PalEntry &overlaycolor);
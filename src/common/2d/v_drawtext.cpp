@@ -43,6 +43,8 @@
 #include "gstrings.h"
 #include "vm.h"
 #include "printf.h"
+#include "superfasthash.h"
+#include "i_time.h"
 
 int ListGetInt(VMVa_List &tags);
 
@@ -246,7 +248,7 @@ DEFINE_ACTION_FUNCTION(_Screen, DrawChar)
 EColorRange V_ParseFontColor(const char32_t *&color_value, int normalcolor, int boldcolor) { return CR_UNTRANSLATED; } 
 
 template<class chartype>
-void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, double y, const chartype *string, DrawParms &parms)
+static void DrawTextRun(F2DDrawer *drawer, FFont *font, int normalcolor, double x, double y, const chartype *string, DrawParms &parms)
 {
 	int 		w;
 	const chartype *ch;
@@ -341,6 +343,100 @@ void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, d
 }
 
 
+//==========================================================================
+//
+// Most text gets drawn in the same place with the same settings every
+// frame, like the HUD, the console or menus, and produces the exact same
+// output each time. So the draw commands for a text run are recorded once
+// and then get replayed until it has not been drawn for a while.
+// Everything the output depends on goes into the key, including the
+// complete DrawParms, which is why those must be cleared before parsing.
+//
+//==========================================================================
+
+struct FCachedText
+{
+	TArray<uint8_t> Key;
+	F2DDrawer::FRecordedDraws Draws;
+	uint64_t LastUsed;
+};
+
+static TMap<uint32_t, FCachedText> TextCache;
+static uint64_t NextTextCachePrune;
+
+void ClearTextCache()
+{
+	TextCache.Clear();
+}
+
+static void PruneTextCache(uint64_t now)
+{
+	NextTextCachePrune = now + 1000;
+	TArray<uint32_t> expired;
+	TMap<uint32_t, FCachedText>::Iterator it(TextCache);
+	TMap<uint32_t, FCachedText>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		if (pair->Value.LastUsed + 1000 < now) expired.Push(pair->Key);
+	}
+	for (auto key : expired) TextCache.Remove(key);
+}
+
+template<class chartype>
+void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, double y, const chartype *string, DrawParms &parms)
+{
+	struct
+	{
+		F2DDrawer *drawer;
+		FFont *font;
+		double x, y;
+		int normalcolor;
+		int width, height;
+		int autoaspect;
+		int charsize;
+	} header;
+
+	memset(&header, 0, sizeof(header));
+	header.drawer = drawer;
+	header.font = font;
+	header.x = x;
+	header.y = y;
+	header.normalcolor = normalcolor;
+	header.width = drawer->GetWidth();
+	header.height = drawer->GetHeight();
+	header.autoaspect = twod->fullscreenautoaspect;
+	header.charsize = sizeof(chartype);
+
+	size_t len = 0;
+	while ((int)len < parms.maxstrlen && string[len] != 0) len++;
+
+	TArray<uint8_t> key(sizeof(header) + sizeof(parms) + len * sizeof(chartype), true);
+	memcpy(&key[0], &header, sizeof(header));
+	memcpy(&key[sizeof(header)], &parms, sizeof(parms));
+	if (len > 0) memcpy(&key[sizeof(header) + sizeof(parms)], string, len * sizeof(chartype));
+
+	uint32_t hash = SuperFastHash((const char *)key.Data(), key.Size());
+	uint64_t now = I_msTime();
+	if (now >= NextTextCachePrune) PruneTextCache(now);
+
+	auto cached = TextCache.CheckKey(hash);
+	if (cached != nullptr && cached->Key == key)
+	{
+		cached->LastUsed = now;
+		drawer->Replay(cached->Draws);
+		return;
+	}
+
+	// On a hash collision the older entry simply gets replaced.
+	auto &entry = TextCache[hash];
+	entry.Key = std::move(key);
+	entry.Draws.Clear();
+	entry.LastUsed = now;
+	drawer->BeginRecording(&entry.Draws);
+	DrawTextRun(drawer, font, normalcolor, x, y, string, parms);
+	drawer->EndRecording();
+}
+
 // For now the 'drawer' parameter is a placeholder - this should be the way to handle it later to allow different drawers.
 void DrawText(F2DDrawer *drawer, FFont* font, int normalcolor, double x, double y, const char* string, int tag_first, ...)
 {
@@ -350,6 +446,8 @@ void DrawText(F2DDrawer *drawer, FFont* font, int normalcolor, double x, double
 	if (font == NULL || string == NULL)
 		return;
 
+	memset(&parms, 0, sizeof(parms));	// identical text must have identical parameters for the text cache.
+
 	va_start(tags.list, tag_first);
 	bool res = ParseDrawTextureTags(drawer, nullptr, 0, 0, tag_first, tags, &parms, true);
 	va_end(tags.list);
@@ -369,6 +467,8 @@ void DrawText(F2DDrawer *drawer, FFont* font, int normalcolor, double x, double
 	if (font == NULL || string == NULL)
 		return;
 
+	memset(&parms, 0, sizeof(parms));	// identical text must have identical parameters for the text cache.
+
 	va_start(tags.list, tag_first);
 	bool res = ParseDrawTextureTags(drawer, nullptr, 0, 0, tag_first, tags, &parms, true);
 	va_end(tags.list);
@@ -387,6 +487,8 @@ void DrawText(F2DDrawer *drawer, FFont *font, int normalcolor, double x, double
 	if (font == NULL || string == NULL)
 		return;
 
+	memset(&parms, 0, sizeof(parms));	// identical text must have identical parameters for the text cache.
+
 	uint32_t tag = ListGetInt(args);
 	bool res = ParseDrawTextureTags(drawer, nullptr, 0, 0, tag, args, &parms, true);
 	if (!res)
@@ -389,7 +389,14 @@ void FSoundFontManager::CollectSoundfonts()
 {
 	findstate_t c_file;
 	void *file;
+	TArray<FString> files;
 
+	WaitForCollection();
+
+	// Only the directory scan happens here, because it needs the config.
+	// Opening and identifying the files can take a while with large archives
+	// or slow drives, so that is left to a worker thread. Everything that
+	// looks at the list waits for it to finish.
 	if (GameConfig != NULL && GameConfig->SetSection ("SoundfontSearch.Directories"))
 	{
 		const char *key;
@@ -413,8 +420,7 @@ void FSoundFontManager::CollectSoundfonts()
 						{
 							if (!(I_FindAttr(&c_file) & FA_DIREC))
 							{
-								FStringf name("%s%s", dir.GetChars(), I_FindName(&c_file));
-								ProcessOneFile(name);
+								files.Push(FStringf("%s%s", dir.GetChars(), I_FindName(&c_file)));
 							}
 						} while (I_FindNext(file, &c_file) == 0);
 						I_FindClose(file);
@@ -424,12 +430,41 @@ void FSoundFontManager::CollectSoundfonts()
 		}
 	}
 
-	if (soundfonts.Size() == 0)
+	FString fallback = NicePath("$PROGDIR/soundfonts/" GAMENAMELOWERCASE ".sf2");
+
+	collector = std::thread([this, files = std::move(files), fallback]()
+	{
+		for (auto &name : files)
+		{
+			ProcessOneFile(name);
+		}
+
+		if (soundfonts.Size() == 0)
+		{
+			ProcessOneFile(fallback);
+		}
+	});
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FSoundFontManager::WaitForCollection() const
+{
+	if (collector.joinable())
 	{
-		ProcessOneFile(NicePath("$PROGDIR/soundfonts/" GAMENAMELOWERCASE ".sf2"));
+		collector.join();
 	}
 }
 
+FSoundFontManager::~FSoundFontManager()
+{
+	WaitForCollection();
+}
+
 //==========================================================================
 //
 //
@@ -438,6 +473,7 @@ void FSoundFontManager::CollectSoundfonts()
 
 const FSoundFontInfo *FSoundFontManager::FindSoundFont(const char *name, int allowed) const
 {
+	WaitForCollection();
 	for(auto &sfi : soundfonts)
 	{
 		// an empty name will pick the first one in a compatible format.
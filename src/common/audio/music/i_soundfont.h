@@ -1,5 +1,6 @@
 #pragma once
 
+#include <thread>
 #include "zstring.h"
 #include "tarray.h"
 #include "filesystem.h"
@@ -147,14 +148,17 @@ public:
 class FSoundFontManager
 {
     TArray<FSoundFontInfo> soundfonts;
+    mutable std::thread collector;	// identifies the files found by CollectSoundfonts
     
     void ProcessOneFile(const FString & fn);
+    void WaitForCollection() const;
     
 public:
+    ~FSoundFontManager();
     void CollectSoundfonts();
     const FSoundFontInfo *FindSoundFont(const char *name, int allowedtypes) const;
     FSoundFontReader *OpenSoundFont(const char *name, int allowedtypes);
-    const auto &GetList() const { return soundfonts; } // This is for the menu
+    const auto &GetList() const { WaitForCollection(); return soundfonts; } // This is for the menu
     
 };
 
@@ -88,6 +88,18 @@ typedef bool (*SoundStreamCallback)(SoundStream *stream, void *buff, int len, vo
 struct SoundDecoder;
 class MIDIDevice;
 
+// A sound that was decoded to PCM but not yet handed to the sound device.
+struct FDecodedSound
+{
+	std::vector<uint8_t> Data;
+	int SampleRate = 0;
+	ChannelConfig Channels = ChannelConfig_Mono;
+	SampleType Type = SampleType_UInt8;
+	uint32_t LoopStart = 0, LoopEnd = ~0u;
+	bool StartAss = false, EndAss = false;
+	bool Valid = false;
+};
+
 class SoundRenderer
 {
 public:
@@ -98,11 +110,16 @@ public:
 	virtual void SetSfxVolume (float volume) = 0;
 	virtual void SetMusicVolume (float volume) = 0;
 	virtual SoundHandle LoadSound(uint8_t *sfxdata, int length) = 0;
+	// Decoding does not touch the sound device, so unlike everything else here it may be called from any thread.
+	// LoadDecodedSound must then be called on the main thread to get a playable sound.
+	virtual void DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &out) { out.Valid = false; }
+	virtual SoundHandle LoadDecodedSound(FDecodedSound &decoded) { SoundHandle retval = { nullptr }; return retval; }
 	SoundHandle LoadSoundVoc(uint8_t *sfxdata, int length);
 	virtual SoundHandle LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1) = 0;
 	virtual void UnloadSound (SoundHandle sfx) = 0;	// unloads a sound from memory
 	virtual unsigned int GetMSLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
 	virtual unsigned int GetSampleLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
+	virtual unsigned int GetDataSize(SoundHandle sfx) { return 0; }	// Gets the memory used by a sound's data
 	virtual float GetOutputRate() = 0;
 
 	// Streaming sounds.
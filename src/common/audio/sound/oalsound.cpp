@@ -60,6 +60,15 @@ CVAR(Bool, snd_waterreverb, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR (String, snd_aldevice, "Default", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, snd_efx, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (String, snd_alresampler, "Default", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+// Mixer updates per second. Higher values give a shorter and more predictable latency at a slightly higher CPU cost. 0 uses the device's default.
+CUSTOM_CVAR (Int, snd_alrefresh, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG|CVAR_NOINITCALL)
+{
+	if (self < 0) self = 0;
+	else if (self > 0 && self < 20) self = 20;
+	else if (self > 200) self = 200;
+}
+CVAR (Bool, snd_aloutputlimiter, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVARD(Int, snd_streambuffers, 8, CVAR_ARCHIVE|CVAR_GLOBALCONFIG, "number of buffers a music stream keeps decoded ahead of playback. Takes effect with the next song")
 
 #ifdef _WIN32
 #define OPENALLIB "openal32.dll"
@@ -176,9 +185,9 @@ class OpenALSoundStream : public SoundStream
 	ALenum Format;
 	ALsizei FrameSize;
 
-	static const int BufferCount = 4;
-	ALuint Buffers[BufferCount];
+	TArray<ALuint> Buffers;
 	ALuint Source;
+	int BufferMS;	// playing time of one buffer
 
 	std::atomic<bool> Playing;
 	bool Looping;
@@ -221,15 +230,16 @@ class OpenALSoundStream : public SoundStream
 		if(Renderer->AL.SOFT_source_spatialize)
 			alSourcei(Source, AL_SOURCE_SPATIALIZE_SOFT, AL_AUTO_SOFT);
 
-		alGenBuffers(BufferCount, Buffers);
+		Buffers.Resize(clamp<int>(snd_streambuffers, 2, 32));
+		memset(Buffers.Data(), 0, Buffers.Size() * sizeof(ALuint));
+		alGenBuffers(Buffers.Size(), Buffers.Data());
 		return (getALError() == AL_NO_ERROR);
 	}
 
 public:
 	OpenALSoundStream(OpenALSoundRenderer *renderer)
-	  : Renderer(renderer), Source(0), Playing(false), Looping(false), Volume(1.0f)
+	  : Renderer(renderer), Source(0), BufferMS(100), Playing(false), Looping(false), Volume(1.0f)
 	{
-		memset(Buffers, 0, sizeof(Buffers));
 		Renderer->AddStream(this);
 	}
 
@@ -246,10 +256,10 @@ public:
 			Source = 0;
 		}
 
-		if(Buffers[0])
+		if(Buffers.Size() > 0 && Buffers[0])
 		{
-			alDeleteBuffers(BufferCount, &Buffers[0]);
-			memset(Buffers, 0, sizeof(Buffers));
+			alDeleteBuffers(Buffers.Size(), Buffers.Data());
+			Buffers.Clear();
 		}
 		getALError();
 	}
@@ -264,7 +274,7 @@ public:
 
 		/* Clear the buffer queue, then fill and queue each buffer */
 		alSourcei(Source, AL_BUFFER, 0);
-		for(int i = 0;i < BufferCount;i++)
+		for(unsigned i = 0;i < Buffers.Size();i++)
 		{
 			if(!Callback(this, &Data[0], Data.Size(), UserData))
 			{
@@ -366,6 +376,13 @@ public:
 		return stats;
 	}
 
+	// The background thread has to come back before a buffer's worth of
+	// playing time has passed, or the queue drains.
+	int GetRefillInterval() const
+	{
+		return MAX(BufferMS / 2, 1);
+	}
+
 	bool Process()
 	{
 		if(!Playing.load())
@@ -471,6 +488,7 @@ public:
 		buffbytes += FrameSize-1;
 		buffbytes -= buffbytes%FrameSize;
 		Data.Resize(buffbytes);
+		BufferMS = int(int64_t(buffbytes / FrameSize) * 1000 / SampleRate);
 
 		return true;
 	}
@@ -556,6 +574,7 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 	ALC.EXT_disconnect = !!alcIsExtensionPresent(Device, "ALC_EXT_disconnect");
 	ALC.SOFT_HRTF = !!alcIsExtensionPresent(Device, "ALC_SOFT_HRTF");
 	ALC.SOFT_pause_device = !!alcIsExtensionPresent(Device, "ALC_SOFT_pause_device");
+	ALC.SOFT_output_limiter = !!alcIsExtensionPresent(Device, "ALC_SOFT_output_limiter");
 
 	const ALCchar *current = NULL;
 	if(alcIsExtensionPresent(Device, "ALC_ENUMERATE_ALL_EXT"))
@@ -592,7 +611,22 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 		else
 			attribs.Push(ALC_DONT_CARE_SOFT);
 	}
-	// Other attribs..?
+	if(*snd_alrefresh > 0)
+	{
+		attribs.Push(ALC_REFRESH);
+		attribs.Push(*snd_alrefresh);
+	}
+	// Only the first auxiliary send is ever used. OpenAL Soft mixes every send a source has, so don't ask for more.
+	if(ALC.EXT_EFX)
+	{
+		attribs.Push(ALC_MAX_AUXILIARY_SENDS);
+		attribs.Push(1);
+	}
+	if(ALC.SOFT_output_limiter)
+	{
+		attribs.Push(ALC_OUTPUT_LIMITER_SOFT);
+		attribs.Push(*snd_aloutputlimiter ? ALC_TRUE : ALC_FALSE);
+	}
 	attribs.Push(0);
 
 	Context = alcCreateContext(Device, &attribs[0]);
@@ -714,6 +748,7 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 	DPrintf(DMSG_NOTIFY, "  Allocated " TEXTCOLOR_BLUE"%u" TEXTCOLOR_NORMAL" sources\n", Sources.Size());
 
 	WasInWater = false;
+	LoadedEffect = 0;
 	if(*snd_efx && ALC.EXT_EFX)
 	{
 		// EFX function pointers
@@ -863,6 +898,7 @@ OpenALSoundRenderer::~OpenALSoundRenderer()
 	}
 	EnvSlot = 0;
 	EnvFilters[0] = EnvFilters[1] = 0;
+	LoadedEffect = 0;
 
 	alcMakeContextCurrent(NULL);
 	alcDestroyContext(Context);
@@ -883,10 +919,15 @@ void OpenALSoundRenderer::BackgroundProc()
 		}
 		else
 		{
-			// Else, process all active streams and sleep for 100ms
+			// Else, process all active streams and sleep until the one with
+			// the shortest buffers needs a refill, but at most 100ms
+			int interval = 100;
 			for(size_t i = 0;i < Streams.Size();i++)
+			{
 				Streams[i]->Process();
-			StreamWake.wait_for(lock, std::chrono::milliseconds(100));
+				interval = MIN(interval, Streams[i]->GetRefillInterval());
+			}
+			StreamWake.wait_for(lock, std::chrono::milliseconds(interval));
 		}
 	}
 }
@@ -974,6 +1015,18 @@ unsigned int OpenALSoundRenderer::GetSampleLength(SoundHandle sfx)
 	return 0;
 }
 
+unsigned int OpenALSoundRenderer::GetDataSize(SoundHandle sfx)
+{
+	if(sfx.data)
+	{
+		ALint size;
+		alGetBufferi(GET_PTRID(sfx.data), AL_SIZE, &size);
+		if(getALError() == AL_NO_ERROR)
+			return size;
+	}
+	return 0;
+}
+
 float OpenALSoundRenderer::GetOutputRate()
 {
 	ALCint rate = 44100; // Default, just in case
@@ -1053,20 +1106,52 @@ SoundHandle OpenALSoundRenderer::LoadSoundRaw(uint8_t *sfxdata, int length, int
 
 SoundHandle OpenALSoundRenderer::LoadSound(uint8_t *sfxdata, int length)
 {
-	SoundHandle retval = { NULL };
-	ALenum format = AL_NONE;
-	ChannelConfig chans;
-	SampleType type;
-	int srate;
-	uint32_t loop_start = 0, loop_end = ~0u;
+	FDecodedSound decoded;
+	DecodeSound(sfxdata, length, decoded);
+	return LoadDecodedSound(decoded);
+}
+
+void OpenALSoundRenderer::DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &out)
+{
 	zmusic_bool startass = false, endass = false;
 
-	FindLoopTags(sfxdata, length, &loop_start, &startass, &loop_end, &endass);
+	out.Valid = false;
+	FindLoopTags(sfxdata, length, &out.LoopStart, &startass, &out.LoopEnd, &endass);
+	out.StartAss = startass;
+	out.EndAss = endass;
 	auto decoder = CreateDecoder(sfxdata, length, true);
 	if (!decoder)
+		return;
+
+	SoundDecoder_GetInfo(decoder, &out.SampleRate, &out.Channels, &out.Type);
+
+	auto &data = out.Data;
+	unsigned total = 0;
+	unsigned got;
+
+	data.resize(total + 32768);
+	while ((got = (unsigned)SoundDecoder_Read(decoder, (char*)&data[total], data.size() - total)) > 0)
+	{
+		total += got;
+		data.resize(total * 2);
+	}
+	data.resize(total);
+	SoundDecoder_Close(decoder);
+	out.Valid = true;
+}
+
+SoundHandle OpenALSoundRenderer::LoadDecodedSound(FDecodedSound &decoded)
+{
+	SoundHandle retval = { NULL };
+	ALenum format = AL_NONE;
+	auto chans = decoded.Channels;
+	auto type = decoded.Type;
+	int srate = decoded.SampleRate;
+	uint32_t loop_start = decoded.LoopStart, loop_end = decoded.LoopEnd;
+
+	if (!decoded.Valid)
 		return retval;
 
-	SoundDecoder_GetInfo(decoder, &srate, &chans, &type);
 	int samplesize = 1;
 	if (chans == ChannelConfig_Mono)
 	{
@@ -1081,24 +1166,12 @@ SoundHandle OpenALSoundRenderer::LoadSound(uint8_t *sfxdata, int length)
 
 	if (format == AL_NONE)
 	{
-		SoundDecoder_Close(decoder);
 		Printf("Unsupported audio format: %s, %s\n", GetChannelConfigName(chans),
 			GetSampleTypeName(type));
 		return retval;
 	}
 
-	std::vector<uint8_t> data;
-	unsigned total = 0;
-	unsigned got;
-
-	data.resize(total + 32768);
-	while ((got = (unsigned)SoundDecoder_Read(decoder, (char*)&data[total], data.size() - total)) > 0)
-	{
-		total += got;
-		data.resize(total * 2);
-	}
-	data.resize(total);
-	SoundDecoder_Close(decoder);
+	auto &data = decoded.Data;
 
 	ALenum err;
 	ALuint buffer = 0;
@@ -1112,8 +1185,8 @@ SoundHandle OpenALSoundRenderer::LoadSound(uint8_t *sfxdata, int length)
 		return retval;
 	}
 
-	if (!startass) loop_start = Scale(loop_start, srate, 1000);
-	if (!endass && loop_end != ~0u) loop_end = Scale(loop_end, srate, 1000);
+	if (!decoded.StartAss) loop_start = Scale(loop_start, srate, 1000);
+	if (!decoded.EndAss && loop_end != ~0u) loop_end = Scale(loop_end, srate, 1000);
 	const uint32_t samples = (uint32_t)data.size() / samplesize;
 	if (loop_start > samples) loop_start = 0;
 	if (loop_end > samples) loop_end = samples;
@@ -1244,8 +1317,6 @@ FISoundChannel *OpenALSoundRenderer::StartSound(SoundHandle sfx, float vol, int
 		return NULL;
 
 	alSourcei(source, AL_BUFFER, buffer);
-	if((chanflags&SNDF_NOPAUSE) || !SFXPaused)
-		alSourcePlay(source);
 	if(getALError() != AL_NO_ERROR)
 	{
 		alSourcei(source, AL_BUFFER, 0);
@@ -1253,6 +1324,8 @@ FISoundChannel *OpenALSoundRenderer::StartSound(SoundHandle sfx, float vol, int
 		return NULL;
 	}
 
+	if((chanflags&SNDF_NOPAUSE) || !SFXPaused)
+		PendingPlays.Push(source);
 	if(!(chanflags&SNDF_NOREVERB))
 		ReverbSfx.Push(source);
 	if(!(chanflags&SNDF_NOPAUSE))
@@ -1443,8 +1516,6 @@ FISoundChannel *OpenALSoundRenderer::StartSound3D(SoundHandle sfx, SoundListener
 		return NULL;
 
 	alSourcei(source, AL_BUFFER, buffer);
-	if((chanflags&SNDF_NOPAUSE) || !SFXPaused)
-		alSourcePlay(source);
 	if(getALError() != AL_NO_ERROR)
 	{
 		alSourcei(source, AL_BUFFER, 0);
@@ -1452,6 +1523,8 @@ FISoundChannel *OpenALSoundRenderer::StartSound3D(SoundHandle sfx, SoundListener
 		return NULL;
 	}
 
+	if((chanflags&SNDF_NOPAUSE) || !SFXPaused)
+		PendingPlays.Push(source);
 	if(!(chanflags&SNDF_NOREVERB))
 		ReverbSfx.Push(source);
 	if(!(chanflags&SNDF_NOPAUSE))
@@ -1509,6 +1582,8 @@ void OpenALSoundRenderer::StopChannel(FISoundChannel *chan)
 	getALError();
 
 	uint32_t i;
+	if((i=PendingPlays.Find(source)) < PendingPlays.Size())
+		PendingPlays.Delete(i);
 	if((i=PausableSfx.Find(source)) < PausableSfx.Size())
 		PausableSfx.Delete(i);
 	if((i=ReverbSfx.Find(source)) < ReverbSfx.Size())
@@ -1542,6 +1617,7 @@ void OpenALSoundRenderer::SetSfxPaused(bool paused, int slot)
 		SFXPaused |= 1 << slot;
 		if(oldslots == 0 && PausableSfx.Size() > 0)
 		{
+			FlushPendingPlays();
 			alSourcePausev(PausableSfx.Size(), &PausableSfx[0]);
 			getALError();
 			PurgeStoppedSources();
@@ -1590,6 +1666,7 @@ void OpenALSoundRenderer::Sync(bool sync)
 	{
 		if(SfxGroup.Size() > 0)
 		{
+			FlushPendingPlays();
 			alSourcePausev(SfxGroup.Size(), &SfxGroup[0]);
 			getALError();
 			PurgeStoppedSources();
@@ -1618,6 +1695,9 @@ void OpenALSoundRenderer::Sync(bool sync)
 			alSourcePlayv(toplay.Size(), &toplay[0]);
 			getALError();
 		}
+		// Everything that was still waiting to be started was just included above.
+		// Starting it again would rewind it.
+		PendingPlays.Clear();
 	}
 }
 
@@ -1688,102 +1768,96 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 		if(!env)
 			env = DefaultEnvironments[0];
 	}
-	if(env != PrevEnvironment || env->Modified)
+	if(env != PrevEnvironment)
 	{
 		PrevEnvironment = env;
 		DPrintf(DMSG_NOTIFY, "Reverb Environment %s\n", env->Name);
-
-		if(EnvSlot != 0)
-			LoadReverb(env);
-
-		const_cast<ReverbContainer*>(env)->Modified = false;
 	}
-	
+
 	// NOTE: Moving into and out of water will undo pitch variations on sounds.
-	if(listener->underwater || env->SoftwareWater)
+	bool inWater = listener->underwater || env->SoftwareWater;
+
+	// Decide on the reverb only after both the environment and the water state
+	// are known, so that a single update never reconfigures the effect slot twice.
+	// LoadReverb leaves the slot alone if it already holds the unmodified effect.
+	if(EnvSlot != 0)
 	{
-		if(!WasInWater)
+		const ReverbContainer *reverb = env;
+		if(inWater && *snd_waterreverb)
 		{
-			WasInWater = true;
-
-			if(EnvSlot != 0 && *snd_waterreverb)
-			{
-				// Find the "Underwater" reverb environment
-				env = S_FindEnvironment(0x1600);
-				LoadReverb(env ? env : DefaultEnvironments[0]);
-
-				alFilterf(EnvFilters[0], AL_LOWPASS_GAIN, 1.f);
-				alFilterf(EnvFilters[0], AL_LOWPASS_GAINHF, 0.125f);
-				alFilterf(EnvFilters[1], AL_LOWPASS_GAIN, 1.f);
-				alFilterf(EnvFilters[1], AL_LOWPASS_GAINHF, 1.f);
-
-				// Apply the updated filters on the sources
-				FSoundChan *schan = soundEngine->GetChannels();
-				while (schan)
-				{
-					ALuint source = GET_PTRID(schan->SysChannel);
-					if (source && !(schan->ChanFlags & CHANF_UI))
-					{
-						alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
-						alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
-					}
-					schan = schan->NextChan;
-				}
-			}
-
-			FSoundChan *schan = soundEngine->GetChannels();
-			while (schan)
-			{
-				ALuint source = GET_PTRID(schan->SysChannel);
-				if (source && !(schan->ChanFlags & CHANF_UI))
-					alSourcef(source, AL_PITCH, schan->Pitch / 128.0f * PITCH_MULT);
-				schan = schan->NextChan;
-			}
-			getALError();
+			// Find the "Underwater" reverb environment
+			reverb = S_FindEnvironment(0x1600);
+			if(!reverb) reverb = DefaultEnvironments[0];
 		}
+		LoadReverb(reverb);
+		// An environment that is not in use keeps its Modified flag until it gets loaded.
+		const_cast<ReverbContainer*>(reverb)->Modified = false;
 	}
-	else if(WasInWater)
+
+	if(inWater != WasInWater)
 	{
-		
-		WasInWater = false;
+		WasInWater = inWater;
 
-		if(EnvSlot != 0)
+		bool setFilters = EnvSlot != 0 && (!inWater || *snd_waterreverb);
+		if(setFilters)
 		{
-			LoadReverb(env);
-
 			alFilterf(EnvFilters[0], AL_LOWPASS_GAIN, 1.f);
-			alFilterf(EnvFilters[0], AL_LOWPASS_GAINHF, 1.f);
+			alFilterf(EnvFilters[0], AL_LOWPASS_GAINHF, inWater ? 0.125f : 1.f);
 			alFilterf(EnvFilters[1], AL_LOWPASS_GAIN, 1.f);
 			alFilterf(EnvFilters[1], AL_LOWPASS_GAINHF, 1.f);
+		}
 
-			FSoundChan *schan = soundEngine->GetChannels();
-			while (schan)
+		// Apply the updated filters and pitch on the sources in a single pass
+		float pitchMult = inWater ? PITCH_MULT : 1.f;
+		FSoundChan *schan = soundEngine->GetChannels();
+		while (schan)
+		{
+			ALuint source = GET_PTRID(schan->SysChannel);
+			if (source && !(schan->ChanFlags & CHANF_UI))
 			{
-				ALuint source = GET_PTRID(schan->SysChannel);
-				if (source && !(schan->ChanFlags & CHANF_UI))
+				if(setFilters)
 				{
 					alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
 					alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
 				}
-				schan = schan->NextChan;
+				alSourcef(source, AL_PITCH, schan->Pitch / 128.0f * pitchMult);
 			}
+			schan = schan->NextChan;
 		}
+		getALError();
+	}
+}
 
-		FSoundChan *schan = soundEngine->GetChannels();
-		while (schan)
+//==========================================================================
+//
+// Starts all sources that were set up since the last update with a single
+// call, so that the mixer picks them all up in the same update and the
+// game thread does not have to acquire the context lock once per sound.
+//
+//==========================================================================
+
+void OpenALSoundRenderer::FlushPendingPlays()
+{
+	if(PendingPlays.Size() == 0)
+		return;
+
+	alSourcePlayv(PendingPlays.Size(), &PendingPlays[0]);
+	if(getALError() != AL_NO_ERROR)
+	{
+		// One invalid source makes the entire call fail, so retry them one by one.
+		for(auto source : PendingPlays)
 		{
-			ALuint source = GET_PTRID(schan->SysChannel);
-			if (source && !(schan->ChanFlags & CHANF_UI))
-				alSourcef(source, AL_PITCH, schan->Pitch / 128.0f);
-			schan = schan->NextChan;
+			alSourcePlay(source);
+			getALError();
 		}
-		getALError();
 	}
+	PendingPlays.Clear();
 }
 
 void OpenALSoundRenderer::UpdateSounds()
 {
 	alProcessUpdatesSOFT();
+	FlushPendingPlays();
 
 	if(ALC.EXT_disconnect)
 	{
@@ -2047,7 +2121,13 @@ void OpenALSoundRenderer::LoadReverb(const ReverbContainer *env)
 #undef mB2Gain
 	}
 
-	alAuxiliaryEffectSloti(EnvSlot, AL_EFFECTSLOT_EFFECT, *envReverb);
+	// Rebinding the slot costs a reconfiguration in the mixer and cuts off the
+	// reverb tail, so only do it when the effect actually changed.
+	if(doLoad || *envReverb != LoadedEffect)
+	{
+		alAuxiliaryEffectSloti(EnvSlot, AL_EFFECTSLOT_EFFECT, *envReverb);
+		LoadedEffect = *envReverb;
+	}
 	getALError();
 }
 
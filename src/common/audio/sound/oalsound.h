@@ -56,6 +56,11 @@ ALC_API ALCboolean ALC_APIENTRY alcResetDeviceSOFT(ALCdevice *device, const ALCi
 #endif
 #endif
 
+#ifndef ALC_SOFT_output_limiter
+#define ALC_SOFT_output_limiter 1
+#define ALC_OUTPUT_LIMITER_SOFT                  0x199A
+#endif
+
 #ifndef AL_EXT_source_distance_model
 #define AL_EXT_source_distance_model 1
 #define AL_SOURCE_DISTANCE_MODEL                 0x200
@@ -126,10 +131,13 @@ public:
 	virtual void SetSfxVolume(float volume);
 	virtual void SetMusicVolume(float volume);
 	virtual SoundHandle LoadSound(uint8_t *sfxdata, int length);
+	virtual void DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &out);
+	virtual SoundHandle LoadDecodedSound(FDecodedSound &decoded);
 	virtual SoundHandle LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1);
 	virtual void UnloadSound(SoundHandle sfx);
 	virtual unsigned int GetMSLength(SoundHandle sfx);
 	virtual unsigned int GetSampleLength(SoundHandle sfx);
+	virtual unsigned int GetDataSize(SoundHandle sfx);
 	virtual float GetOutputRate();
 
 	// Streaming sounds.
@@ -181,6 +189,7 @@ private:
         bool EXT_disconnect;
         bool SOFT_HRTF;
         bool SOFT_pause_device;
+        bool SOFT_output_limiter;
     } ALC;
     struct {
         bool EXT_source_distance_model;
@@ -245,6 +254,7 @@ private:
 
 	void LoadReverb(const ReverbContainer *env);
 	void PurgeStoppedSources();
+	void FlushPendingPlays();
 	static FSoundChan *FindLowestChannel();
 
     std::thread StreamThread;
@@ -265,6 +275,7 @@ private:
 	TArray<ALuint> PausableSfx;
 	TArray<ALuint> ReverbSfx;
 	TArray<ALuint> SfxGroup;
+	TArray<ALuint> PendingPlays;
 
 	const ReverbContainer *PrevEnvironment;
 
@@ -273,6 +284,7 @@ private:
     ALuint EnvSlot;
     ALuint EnvFilters[2];
     EffectMap EnvEffects;
+    ALuint LoadedEffect;	// the effect currently bound to EnvSlot
 
     bool WasInWater;
 
@@ -41,6 +41,15 @@
 #include "m_swap.h"
 #include "superfasthash.h"
 #include "s_music.h"
+#include "c_cvars.h"
+#include "printf.h"
+#include "stats.h"
+#include "i_time.h"
+#include "zonetrace.h"
+#include "memstats.h"
+#include "ctpl.h"
+#include <map>
+#include <future>
 
 
 enum
@@ -51,6 +60,23 @@ enum
 SoundEngine* soundEngine;
 int sfx_empty = -1;
 
+// Looping sounds out of hearing range are stopped and only tracked by the sound engine until they come back into range.
+CVAR(Bool, snd_virtualize, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Budget for the memory used by loaded sounds. Once it is exceeded the sounds that have not been used for the longest time get unloaded.
+CUSTOM_CVAR(Int, snd_cachesize, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+}
+// Sounds that were used within this many seconds are never unloaded.
+CUSTOM_CVAR(Int, snd_cachetimeout, 30, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+}
+
+// Sounds that are being decoded in the background while a level's sounds are precached, by lump number.
+static std::map<int, std::future<FDecodedSound>> PendingDecodes;
+
 //==========================================================================
 //
 // S_Init
@@ -130,6 +156,19 @@ void SoundEngine::CacheMarkedSounds()
 		MarkUsed(chan->SoundID);
 	}
 
+	// Reading the lumps has to stay on this thread, but decoding compressed formats is independent per sound.
+	// The decoded data gets picked up by LoadSound, so the buffers still get created in the same order as before.
+	unsigned numthreads = std::thread::hardware_concurrency();
+	ctpl::thread_pool pool;
+	if (numthreads > 1 && !GSnd->IsNull())
+	{
+		pool.resize(numthreads - 1);
+		for (unsigned i = 1; i < S_sfx.Size(); ++i)
+		{
+			if (S_sfx[i].bUsed) QueueDecode(pool, i);
+		}
+	}
+
 	for (unsigned i = 1; i < S_sfx.Size(); ++i)
 	{
 		if (S_sfx[i].bUsed)
@@ -137,6 +176,9 @@ void SoundEngine::CacheMarkedSounds()
 			CacheSound(&S_sfx[i]);
 		}
 	}
+	// Decodes for sounds that ended up not being loaded, e.g. because they got linked to another sound, are discarded.
+	PendingDecodes.clear();
+
 	for (unsigned i = 1; i < S_sfx.Size(); ++i)
 	{
 		if (!S_sfx[i].bUsed && S_sfx[i].link == sfxinfo_t::NO_LINK)
@@ -146,6 +188,54 @@ void SoundEngine::CacheMarkedSounds()
 	}
 }
 
+//==========================================================================
+//
+// Starts decoding a sound that is about to be cached on a worker thread.
+// Sounds in formats that need no decoding are left to LoadSound.
+//
+//==========================================================================
+
+void SoundEngine::QueueDecode(ctpl::thread_pool &pool, int sound_id)
+{
+	sfxinfo_t *sfx = &S_sfx[sound_id];
+	if (sfx->bTentative) return;
+	if (sfx->bRandomHeader)
+	{
+		const FRandomSoundList *list = &S_rnd[sfx->link];
+		for (unsigned i = 0; i < list->Choices.Size(); ++i)
+		{
+			QueueDecode(pool, list->Choices[i]);
+		}
+		return;
+	}
+	while (sfx->link != sfxinfo_t::NO_LINK && !sfx->bRandomHeader) sfx = &S_sfx[sfx->link];
+	if (sfx->bRandomHeader)
+	{
+		QueueDecode(pool, int(sfx - &S_sfx[0]));
+		return;
+	}
+	if (sfx->data.isValid() || sfx->bLoadRAW || sfx->lumpnum < 0 || sfx->lumpnum == sfx_empty) return;
+	if (PendingDecodes.find(sfx->lumpnum) != PendingDecodes.end()) return;
+
+	auto sfxdata = ReadSound(sfx->lumpnum);
+	int size = sfxdata.Size();
+	if (size <= 8) return;
+	// VOC and DMX sounds are cheap to convert and get handled by LoadSound directly.
+	int32_t dmxlen = LittleLong(((int32_t *)sfxdata.Data())[1]);
+	if (strncmp((const char *)sfxdata.Data(), "Creative Voice File", 19) == 0) return;
+	if (sfxdata[0] == 3 && sfxdata[1] == 0 && dmxlen <= size - 8) return;
+
+	PendingDecodes[sfx->lumpnum] = pool.push([data = std::move(sfxdata)](int) mutable
+	{
+		FDecodedSound decoded;
+		FString output;
+		PrintCaptureBuffer = &output;	// the console may not be accessed from here.
+		GSnd->DecodeSound(data.Data(), data.Size(), decoded);
+		PrintCaptureBuffer = nullptr;
+		return decoded;
+	});
+}
+
 //==========================================================================
 //
 // S_CacheSound
@@ -184,6 +274,111 @@ void SoundEngine::UnloadSound (sfxinfo_t *sfx)
 	if (sfx->data.isValid())
 		GSnd->UnloadSound(sfx->data);
 	sfx->data.Clear();
+	sfx->DataSize = 0;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static size_t SoundMemoryUsage()
+{
+	size_t total = 0;
+	if (soundEngine != nullptr)
+	{
+		for (auto &sfx : soundEngine->GetSounds())
+		{
+			if (sfx.data.isValid()) total += sfx.DataSize;
+		}
+	}
+	return total;
+}
+
+static FMemReporter SoundMemory(MEM_Sounds, SoundMemoryUsage);
+
+//==========================================================================
+//
+// TrimSoundCache
+//
+// Unloads the least recently used sounds until the loaded data fits
+// into snd_cachesize again. Sounds that are referenced by a channel,
+// even an evicted one, stay. Anything unloaded here simply gets loaded
+// from its lump again the next time it is played.
+//
+//==========================================================================
+
+void SoundEngine::TrimSoundCache()
+{
+	uint64_t now = I_msTime();
+	if (snd_cachesize <= 0 || now < NextCacheTrim || GSnd == nullptr || GSnd->IsNull()) return;
+	NextCacheTrim = now + 1000;
+
+	uint64_t budget = uint64_t(snd_cachesize) << 20;
+	uint64_t total = 0;
+	for (auto &sfx : S_sfx)
+	{
+		if (sfx.data.isValid()) total += sfx.DataSize;
+	}
+	if (total <= budget) return;
+
+	TArray<bool> inuse(S_sfx.Size(), true);
+	memset(inuse.Data(), 0, inuse.Size() * sizeof(bool));
+	for (FSoundChan *chan = Channels; chan != nullptr; chan = chan->NextChan)
+	{
+		for (unsigned id = chan->SoundID; id < S_sfx.Size() && !inuse[id]; id = S_sfx[id].link)
+		{
+			inuse[id] = true;
+			if (S_sfx[id].bRandomHeader) break;
+		}
+	}
+
+	uint64_t oldest = now - std::min<uint64_t>(now, uint64_t(snd_cachetimeout) * 1000);
+	TArray<unsigned> candidates;
+	for (unsigned i = 1; i < S_sfx.Size(); i++)
+	{
+		auto &sfx = S_sfx[i];
+		if (sfx.data.isValid() && !inuse[i] && sfx.LastUsed <= oldest) candidates.Push(i);
+	}
+	std::sort(candidates.begin(), candidates.end(), [&](unsigned a, unsigned b) { return S_sfx[a].LastUsed < S_sfx[b].LastUsed; });
+
+	for (unsigned i = 0; i < candidates.Size() && total > budget; i++)
+	{
+		auto sfx = &S_sfx[candidates[i]];
+		total -= sfx->DataSize;
+		// Sounds linked to this one keep their link and will load it again when they get played.
+		UnloadSound(sfx);
+	}
+}
+
+//==========================================================================
+//
+// GetCacheStats
+//
+//==========================================================================
+
+FString SoundEngine::GetCacheStats()
+{
+	uint64_t total = 0;
+	unsigned count = 0;
+	for (auto &sfx : S_sfx)
+	{
+		if (sfx.data.isValid())
+		{
+			total += sfx.DataSize;
+			count++;
+		}
+	}
+	FString out;
+	out.Format("Loaded sounds: %u, %.2f MB", count, total / 1048576.);
+	if (snd_cachesize > 0) out.AppendFormat(" of %d MB", *snd_cachesize);
+	return out;
+}
+
+ADD_STAT(soundcache)
+{
+	return soundEngine ? soundEngine->GetCacheStats() : FString();
 }
 
 //==========================================================================
@@ -661,13 +856,13 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 			return;
 		}
 
-		chan->ChanFlags &= ~(CHANF_EVICTED|CHANF_ABSTIME);
+		chan->ChanFlags &= ~(CHANF_EVICTED|CHANF_ABSTIME|CHANF_INAUDIBLE);
         ochan = (FSoundChan*)GSnd->StartSound3D(sfx->data, &listener, chan->Volume, &chan->Rolloff, chan->DistanceScale, chan->Pitch,
             chan->Priority, pos, vel, chan->EntChannel, startflags, chan);
 	}
 	else
 	{
-		chan->ChanFlags &= ~(CHANF_EVICTED|CHANF_ABSTIME);
+		chan->ChanFlags &= ~(CHANF_EVICTED|CHANF_ABSTIME|CHANF_INAUDIBLE);
 		ochan = (FSoundChan*)GSnd->StartSound(sfx->data, chan->Volume, chan->Pitch, startflags, chan);
 	}
 	assert(ochan == NULL || ochan == chan);
@@ -688,6 +883,7 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 {
 	if (GSnd->IsNull()) return sfx;
+	TRACE_ZONE_ARG("LoadSound", sfx->name.GetChars());
 
 	while (!sfx->data.isValid())
 	{
@@ -711,12 +907,27 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 				// This is necessary to avoid using the rolloff settings of the linked sound if its
 				// settings are different.
 				if (sfx->Rolloff.MinDistance == 0) sfx->Rolloff = S_Rolloff;
+				S_sfx[i].LastUsed = I_msTime();
 				return &S_sfx[i];
 			}
 		}
 
 		//DPrintf(DMSG_NOTIFY, "Loading sound \"%s\" (%td)\n", sfx->name.GetChars(), sfx - &S_sfx[0]);
 
+		auto pending = PendingDecodes.find(sfx->lumpnum);
+		if (pending != PendingDecodes.end())
+		{
+			auto decoded = pending->second.get();
+			PendingDecodes.erase(pending);
+			sfx->data = GSnd->LoadDecodedSound(decoded);
+			if (sfx->data.isValid())
+			{
+				sfx->DataSize = GSnd->GetDataSize(sfx->data);
+				break;
+			}
+			// Let the regular path have another go at it, in case it can make more sense of the data.
+		}
+
 		auto sfxdata = ReadSound(sfx->lumpnum);
 		int size = sfxdata.Size();
 		if (size > 8)
@@ -755,8 +966,10 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 				continue;
 			}
 		}
+		sfx->DataSize = GSnd->GetDataSize(sfx->data);
 		break;
 	}
+	sfx->LastUsed = I_msTime();
 	return sfx;
 }
 
@@ -816,7 +1029,16 @@ bool SoundEngine::CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_
 				return false;
 			}
 
-			CalcPosVel(chan, &chanorigin, NULL);
+			// Nearly all sounds that get checked here were already positioned by the last update,
+			// so only recalculate those which were started since.
+			if (chan->CachedPosStamp == UpdateStamp)
+			{
+				chanorigin = chan->CachedPos;
+			}
+			else
+			{
+				CalcPosVel(chan, &chanorigin, NULL);
+			}
 			if ((chanorigin - pos).LengthSquared() <= limit_range)
 			{
 				count++;
@@ -1223,23 +1445,50 @@ void SoundEngine::RestoreEvictedChannels()
 void SoundEngine::UpdateSounds(int time)
 {
 	FVector3 pos, vel;
+	FSoundChan *next;
 
-	for (FSoundChan* chan = Channels; chan != NULL; chan = chan->NextChan)
+	if (++UpdateStamp == 0) UpdateStamp = 1;
+
+	for (FSoundChan* chan = Channels; chan != NULL; chan = next)
 	{
+		next = chan->NextChan;
 		if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_IS3D)) == CHANF_IS3D)
 		{
 			CalcPosVel(chan, &pos, &vel);
+			chan->CachedPos = pos;
+			chan->CachedPosStamp = UpdateStamp;
 
-			if (ValidatePosVel(chan, pos, vel))
+			if (chan->SysChannel != NULL && IsInaudible(chan, pos))
+			{
+				// Keep the channel around like EvictAllChannels does, but give its source to a sound that can be heard.
+				if (!(chan->ChanFlags & CHANF_ABSTIME))
+				{
+					chan->StartTime = GSnd->GetPosition(chan);
+					chan->ChanFlags |= CHANF_ABSTIME;
+				}
+				chan->ChanFlags |= CHANF_EVICTED | CHANF_INAUDIBLE;
+				StopChannel(chan);
+			}
+			else if (ValidatePosVel(chan, pos, vel))
 			{
 				GSnd->UpdateSoundParams3D(&listener, chan, !!(chan->ChanFlags & CHANF_AREA), pos, vel);
 			}
 		}
+		else if ((chan->ChanFlags & CHANF_INAUDIBLE) && time >= RestartEvictionsAt)
+		{
+			// Only the position is needed to decide whether the sound can be heard again.
+			CalcPosVel(chan, &pos, nullptr);
+			if (!IsInaudible(chan, pos))
+			{
+				RestartChannel(chan);
+			}
+		}
 		chan->ChanFlags &= ~CHANF_JUSTSTARTED;
 	}
 
 	GSnd->UpdateListener(&listener);
 	GSnd->UpdateSounds();
+	TrimSoundCache();
 
 	if (time >= RestartEvictionsAt)
 	{
@@ -1248,6 +1497,26 @@ void SoundEngine::UpdateSounds(int time)
 	}
 }
 
+//==========================================================================
+//
+// IsInaudible
+//
+// Checks if a looping sound is so far away from the listener that its
+// rolloff makes it completely silent. Such a sound does not need a voice
+// in the sound backend until it comes back into hearing range.
+//
+//==========================================================================
+
+bool SoundEngine::IsInaudible(const FSoundChan *chan, const FVector3 &pos)
+{
+	if (!snd_virtualize || !listener.valid) return false;
+	if ((chan->ChanFlags & (CHANF_LOOP | CHANF_AREA | CHANF_IS3D)) != (CHANF_LOOP | CHANF_IS3D)) return false;
+	if (chan->Rolloff.MinDistance == 0 || chan->Rolloff.RolloffType == ROLLOFF_Log) return false;
+
+	float distance = (pos - listener.position).Length() * chan->DistanceScale;
+	return GetRolloff(&chan->Rolloff, distance) <= 0;
+}
+
 //==========================================================================
 //
 // S_GetRolloff
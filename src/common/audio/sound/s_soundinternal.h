@@ -2,6 +2,8 @@
 
 #include "i_sound.h"
 
+namespace ctpl { class thread_pool; }
+
 struct FRandomSoundList
 {
 	TArray<uint32_t> Choices;
@@ -50,6 +52,9 @@ struct sfxinfo_t
 	FRolloffInfo	Rolloff;
 	float		Attenuation;			// Multiplies the attenuation passed to S_Sound.
 
+	unsigned	DataSize;				// Memory used by the loaded sound data, in bytes.
+	uint64_t	LastUsed;				// I_msTime of the last time this sound was started.
+
 	void		MarkUsed();				// Marks this sound as used.
 
 	void Clear()
@@ -80,6 +85,8 @@ struct sfxinfo_t
 
 		Rolloff = {};
 		Attenuation = 1.f;
+		DataSize = 0;
+		LastUsed = 0;
 	}
 };
 
@@ -172,6 +179,8 @@ struct FSoundChan : public FISoundChannel
 	float		LimitRange;
 	const void *Source;
 	float Point[3];	// Sound is not attached to any source.
+	FVector3	CachedPos;	// Position calculated by the last UpdateSounds call.
+	unsigned	CachedPosStamp;
 };
 
 
@@ -240,6 +249,8 @@ protected:
 	TMap<int, int> ResIdMap;
 	TArray<FRandomSoundList> S_rnd;
 	bool blockNewSounds = false;
+	uint64_t NextCacheTrim = 0;
+	unsigned UpdateStamp = 1;	// identifies the cached channel positions. 0 is never valid.
 
 private:
 	void LinkChannel(FSoundChan* chan, FSoundChan** head);
@@ -247,6 +258,9 @@ private:
 	void ReturnChannel(FSoundChan* chan);
 	void RestartChannel(FSoundChan* chan);
 	void RestoreEvictedChannel(FSoundChan* chan);
+	void QueueDecode(ctpl::thread_pool& pool, int sound_id);
+	void TrimSoundCache();
+	bool IsInaudible(const FSoundChan* chan, const FVector3& pos);
 
 	bool IsChannelUsed(int sourcetype, const void* actor, int channel, int* seen);
 	// This is the actual sound positioning logic which needs to be provided by the client.
@@ -280,6 +294,7 @@ public:
 
 	virtual void StopChannel(FSoundChan* chan);
 	sfxinfo_t* LoadSound(sfxinfo_t* sfx);
+	FString GetCacheStats();
 
 	// Initializes sound stuff, including volume
 	// Sets channels, SFX and music volume,
@@ -36,6 +36,9 @@
 #include "c_console.h"
 #include "c_consolebuffer.h"
 #include "printf.h"
+#include "c_cvars.h"
+
+CVAR(Bool, con_coalesce, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// show repeats of the same line as one line with a count
 
 
 //==========================================================================
@@ -53,6 +56,9 @@ FConsoleBuffer::FConsoleBuffer()
 	mLastLineNeedsUpdate = false;
 	mTextLines = 0;
 	mBufferWasCleared = true;
+	mLastPrintLevel = 0;
+	mLastLength = 0;
+	mRepeatCount = 0;
 	mBrokenStart.Push(0);
 }
 
@@ -67,12 +73,38 @@ FConsoleBuffer::FConsoleBuffer()
 // relatively expensive. The old console did them each time text was added
 // resulting in extremely bad performance with a high output rate.
 //
+// A complete line that repeats the previous one only updates that line's
+// repeat count so that scripts printing the same message every tic do not
+// push everything else out of the buffer.
+//
 //==========================================================================
 
 void FConsoleBuffer::AddText(int printlevel, const char *text)
 {
 	FString build = TEXTCOLOR_TAN;
-	
+	size_t textsize = strlen(text);
+
+	if (mAddType == NEWLINE && con_coalesce && mConsoleText.Size() > 0 && textsize > 0 && text[textsize-1] == '\n')
+	{
+		if (printlevel == mLastPrintLevel && mLastText.Compare(text) == 0)
+		{
+			FString &last = mConsoleText.Last();
+			if (mRepeatCount > 0) last.Truncate(mLastLength);
+			else mLastLength = last.Len();
+			mRepeatCount++;
+			last.AppendFormat(" " TEXTCOLOR_DARKGRAY "(x%d)", mRepeatCount + 1);
+			mLastLineNeedsUpdate = true;
+			return;
+		}
+		mLastText = text;
+		mLastPrintLevel = printlevel;
+	}
+	else
+	{
+		mLastText = "";
+	}
+	mRepeatCount = 0;
+
 	if (mAddType == REPLACELINE)
 	{
 		// Just wondering: Do we actually need this case? If so, it may need some work.
@@ -92,8 +124,6 @@ void FConsoleBuffer::AddText(int printlevel, const char *text)
 		else if (printlevel < PRINTLEVELS) build.Format("%c%c", TEXTCOLOR_ESCAPE, PrintColors[printlevel]+'A');
 	}
 	
-	size_t textsize = strlen(text);
-	
 	if (text[textsize-1] == '\r')
 	{
 		textsize--;
@@ -165,6 +195,10 @@ void FConsoleBuffer::FormatText(FFont *formatfont, int displaywidth)
 //
 // Delete old content if number of lines gets too large
 //
+// The formatted text of the deleted lines gets removed along with them.
+// Reformatting everything here would happen every tic once the buffer is
+// full and text keeps getting added.
+//
 //==========================================================================
 
 void FConsoleBuffer::ResizeBuffer(unsigned newsize)
@@ -173,7 +207,18 @@ void FConsoleBuffer::ResizeBuffer(unsigned newsize)
 	{
 		unsigned todelete = mConsoleText.Size() - newsize;
 		mConsoleText.Delete(0, todelete);
-		mBufferWasCleared = true;
+
+		if (mBufferWasCleared || todelete >= m_BrokenConsoleText.Size())
+		{
+			mBufferWasCleared = true;
+			return;
+		}
+		unsigned brokendelete = mBrokenStart[todelete];
+		m_BrokenConsoleText.Delete(0, todelete);
+		mBrokenStart.Delete(0, todelete);
+		for (auto &start : mBrokenStart) start -= brokendelete;
+		mBrokenLines.Delete(0, brokendelete);
+		mTextLines = mBrokenLines.Size();
 	}
 }
 
@@ -61,6 +61,11 @@ class FConsoleBuffer
 	int mLastDisplayWidth;
 	bool mLastLineNeedsUpdate;
 
+	FString mLastText;		// the last complete line as it was added, for coalescing repeats.
+	int mLastPrintLevel;
+	unsigned mLastLength;	// length of the last line without the repeat count
+	int mRepeatCount;
+
 	
 public:
 	FConsoleBuffer();
@@ -71,6 +76,8 @@ public:
 	{
 		mBufferWasCleared = true;
 		mConsoleText.Clear();
+		mLastText = "";
+		mRepeatCount = 0;
 	}
 	int GetFormattedLineCount() { return mTextLines; }
 	FBrokenLines *GetLines() { return &mBrokenLines[0]; }
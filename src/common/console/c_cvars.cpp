@@ -57,8 +57,10 @@ static TArray<FLatchedValue> LatchedValues;
 
 bool FBaseCVar::m_DoNoSet = false;
 bool FBaseCVar::m_UseCallback = false;
+int FBaseCVar::ChangeCount;
 
 FBaseCVar *CVars = NULL;
+FBaseCVar *FBaseCVar::CVarHash[FBaseCVar::HASH_SIZE];
 
 int cvar_defflags;
 
@@ -102,6 +104,11 @@ FBaseCVar::FBaseCVar (const char *var_name, uint32_t flags, void (*callback)(FBa
 		VarName = var_name;
 		m_Next = CVars;
 		CVars = this;
+
+		// A redefined CVAR must be found before the old one, just like in the main list.
+		auto bucket = &CVarHash[MakeKey(var_name) % HASH_SIZE];
+		m_HashNext = *bucket;
+		*bucket = this;
 	}
 
 	if (var)
@@ -140,6 +147,14 @@ FBaseCVar::~FBaseCVar ()
 			else
 				CVars = m_Next;
 		}
+		for (auto link = &CVarHash[MakeKey(VarName.GetChars()) % HASH_SIZE]; *link != nullptr; link = &(*link)->m_HashNext)
+		{
+			if (*link == this)
+			{
+				*link = m_HashNext;
+				break;
+			}
+		}
 		if (var->Flags & CVAR_AUTO)
 			C_RemoveTabCommand(VarName);
 	}
@@ -153,6 +168,7 @@ const char *FBaseCVar::GetHumanString(int precision) const
 void FBaseCVar::ForceSet (UCVarValue value, ECVarType type, bool nouserinfosend)
 {
 	DoSet (value, type);
+	ChangeCount++;
 	if ((Flags & CVAR_USERINFO) && !nouserinfosend && !(Flags & CVAR_IGNORE))
 		if (callbacks && callbacks->UserInfoChanged) callbacks->UserInfoChanged(this);
 	if (m_UseCallback)
@@ -1252,13 +1268,20 @@ void C_ForgetCVars (void)
 FBaseCVar *FindCVar (const char *var_name, FBaseCVar **prev)
 {
 	FBaseCVar *var;
-	FBaseCVar *dummy;
 
 	if (var_name == NULL)
 		return NULL;
 
 	if (prev == NULL)
-		prev = &dummy;
+	{
+		// Without a predecessor to report the hash can be used.
+		for (var = FBaseCVar::CVarHash[MakeKey(var_name) % FBaseCVar::HASH_SIZE]; var != nullptr; var = var->m_HashNext)
+		{
+			if (stricmp(var->GetName(), var_name) == 0)
+				break;
+		}
+		return var;
+	}
 
 	var = CVars;
 	*prev = NULL;
@@ -1279,7 +1302,7 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 	if (var_name == NULL)
 		return NULL;
 
-	var = CVars;
+	var = FBaseCVar::CVarHash[MakeKey(var_name, namelen) % FBaseCVar::HASH_SIZE];
 	while (var)
 	{
 		const char *probename = var->GetName ();
@@ -1289,7 +1312,7 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 		{
 			break;
 		}
-		var = var->m_Next;
+		var = var->m_HashNext;
 	}
 	return var;
 }
@@ -133,6 +133,7 @@ public:
 	}
 
 	inline const char *GetName () const { return VarName.GetChars(); }
+	static int GetChangeCount() { return ChangeCount; }	// increases each time any CVAR gets set, for caches depending on settings.
 	inline uint32_t GetFlags () const { return Flags; }
 	inline FBaseCVar *GetNext() const { return m_Next; }
 
@@ -201,9 +202,14 @@ private:
 
 	void (*m_Callback)(FBaseCVar &);
 	FBaseCVar *m_Next;
+	FBaseCVar *m_HashNext;
+
+	enum { HASH_SIZE = 1021 };
+	static FBaseCVar *CVarHash[HASH_SIZE];	// Lookup by name. The m_Next list retains the order of creation.
 
 	static bool m_UseCallback;
 	static bool m_DoNoSet;
+	static int ChangeCount;
 
 	// These need to go away!
 	friend FString C_GetMassCVarString (uint32_t filter, bool compact);
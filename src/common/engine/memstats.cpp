@@ -0,0 +1,112 @@
+/*
+** memstats.cpp
+** Memory accounting by subsystem
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The numbers are estimates of the payload sizes. Allocator overhead and
+** driver side copies of hardware resources are not included.
+**
+*/
+
+#include "memstats.h"
+#include "stats.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "dobject.h"
+
+std::atomic<int64_t> MemCounters[NUM_MEMCATEGORIES];
+FMemReporter *FMemReporter::First;
+
+static const char *const MemCategoryNames[NUM_MEMCATEGORIES] =
+{
+	"Textures",
+	"Hardware textures",
+	"Sounds",
+	"Models",
+	"Level geometry",
+	"Actors",
+	"ZScript objects",
+	"VM frames",
+	"File cache",
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FMemReporter::FMemReporter(EMemCategory cat, size_t (*func)())
+{
+	Category = cat;
+	Report = func;
+	Next = First;
+	First = this;
+}
+
+size_t FMemReporter::GetUsage(EMemCategory cat)
+{
+	int64_t total = MemCounters[cat].load(std::memory_order_relaxed);
+	for (auto rep = First; rep != nullptr; rep = rep->Next)
+	{
+		if (rep->Category == cat) total += rep->Report();
+	}
+	return total > 0 ? size_t(total) : 0;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static FString MemStat_Format()
+{
+	FString out;
+	size_t sum = 0;
+	for (int i = 0; i < NUM_MEMCATEGORIES; i++)
+	{
+		size_t usage = FMemReporter::GetUsage(EMemCategory(i));
+		sum += usage;
+		out.AppendFormat("%s: %.2f MB\n", MemCategoryNames[i], usage / 1048576.);
+	}
+	out.AppendFormat("Total accounted: %.2f MB, M_Malloc total: %.2f MB", sum / 1048576., GC::AllocBytes / 1048576.);
+	return out;
+}
+
+ADD_STAT(memory)
+{
+	return MemStat_Format();
+}
+
+CCMD(memstats)
+{
+	Printf("%s\n", MemStat_Format().GetChars());
+}
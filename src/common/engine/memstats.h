@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Memory accounting by subsystem, shown by the "memory" stat and the memstats command.
+//
+// Memory whose owners can be enumerated gets reported by FMemReporter callbacks when the numbers are needed.
+// Everything else is tracked with MemStat_Add at the allocation and release sites.
+
+enum EMemCategory
+{
+	MEM_Textures,
+	MEM_HWTextures,
+	MEM_Sounds,
+	MEM_Models,
+	MEM_Level,
+	MEM_Actors,
+	MEM_Objects,
+	MEM_VMFrames,
+	MEM_FileCache,
+
+	NUM_MEMCATEGORIES
+};
+
+extern std::atomic<int64_t> MemCounters[NUM_MEMCATEGORIES];
+
+inline void MemStat_Add(EMemCategory cat, int64_t bytes)
+{
+	MemCounters[cat].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+class FMemReporter
+{
+public:
+	FMemReporter(EMemCategory cat, size_t (*func)());
+
+	static size_t GetUsage(EMemCategory cat);
+
+private:
+	FMemReporter *Next;
+	EMemCategory Category;
+	size_t (*Report)();
+
+	static FMemReporter *First;
+};
@@ -85,6 +85,7 @@ void PaletteContainer::SetPalette(const uint8_t* colors, int transparent_index)
 	}
 
 	uniqueRemaps[0]->crc32 = CalcCRC32((uint8_t*)uniqueRemaps[0]->Palette, sizeof(uniqueRemaps[0]->Palette));
+	ColorMatcher.SetPalette(BaseColors);	// the matcher's lookup depends on the palette's contents.
 
 
 	// Find white and black from the original palette so that they can be
@@ -88,5 +88,9 @@ int DPrintf (int level, const char *format, ...) ATTRIBUTE((format(printf,2,3)))
 
 void debugprintf(const char* f, ...);	// Prints to the debugger's log.
 
+// Worker threads may not access the console. If this is set, the thread's output gets appended to it instead.
+class FString;
+extern thread_local FString *PrintCaptureBuffer;
+
 // flag to silence non-error output
 extern bool batchrun;
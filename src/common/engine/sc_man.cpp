@@ -478,6 +478,24 @@ void FScanner::SetStateMode(bool stately)
 	StateOptions = stately;
 }
 
+//==========================================================================
+//
+// FScanner :: CountLines
+//
+// Advances the line counter past all newlines in the given range.
+//
+//==========================================================================
+
+void FScanner::CountLines(const char *start, const char *end)
+{
+	while ((start = (const char *)memchr(start, '\n', end - start)) != nullptr)
+	{
+		Line++;
+		Crossed = true;
+		start++;
+	}
+}
+
 //==========================================================================
 //
 // FScanner::ScanString
@@ -133,6 +133,7 @@ protected:
 	void PrepareScript();
 	void CheckOpen();
 	bool ScanString(bool tokens);
+	void CountLines(const char *start, const char *end);
 
 	// Strings longer than this minus one will be dynamically allocated.
 	static const int MAX_STRING_SIZE = 128;
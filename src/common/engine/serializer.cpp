@@ -162,9 +162,10 @@ bool FSerializer::OpenReader(FCompressedBuffer *input)
 	}
 	else
 	{
-		TArray<char> unpacked(input->mSize);
+		TArray<char> unpacked(input->mSize + 1, true);
 		input->Decompress(unpacked.Data());
-		r = new FReader(unpacked.Data(), input->mSize);
+		unpacked[input->mSize] = 0;
+		r = new FReader(std::move(unpacked));
 	}
 	return true;
 }
@@ -719,19 +720,31 @@ const char *FSerializer::GetOutput(unsigned *len)
 FCompressedBuffer FSerializer::GetCompressedOutput()
 {
 	if (isReading()) return{ 0,0,0,0,0,nullptr };
-	FCompressedBuffer buff;
 	WriteObjects();
 	EndObject();
-	buff.mSize = (unsigned)w->mOutString.GetSize();
+	return CompressJSON(w->mOutString.GetString(), (unsigned)w->mOutString.GetSize());
+}
+
+//==========================================================================
+//
+// This only depends on the passed data so it can also be used
+// for output that gets compressed on another thread.
+//
+//==========================================================================
+
+FCompressedBuffer CompressJSON(const char *data, unsigned size)
+{
+	FCompressedBuffer buff;
+	buff.mSize = size;
 	buff.mZipFlags = 0;
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
+	buff.mCRC32 = crc32(0, (const Bytef*)data, buff.mSize);
 
 	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
+	stream.next_in = (Bytef *)data;
 	stream.avail_in = buff.mSize;
 	stream.next_out = (Bytef*)compressbuf;
 	stream.avail_out = buff.mSize;
@@ -765,7 +778,9 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	}
 
 error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
+	memcpy(compressbuf, data, buff.mSize);
+	compressbuf[buff.mSize] = 0;
+	buff.mBuffer = (char*)compressbuf;
 	buff.mCompressedSize = buff.mSize;
 	buff.mMethod = METHOD_STORED;
 	return buff;
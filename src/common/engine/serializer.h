@@ -183,6 +183,8 @@ public:
 	int mErrors = 0;
 };
 
+FCompressedBuffer CompressJSON(const char *data, unsigned size);	// compresses the text from GetOutput like GetCompressedOutput does.
+
 FSerializer& Serialize(FSerializer& arc, const char* key, char& value, char* defval);
 
 FSerializer &Serialize(FSerializer &arc, const char *key, bool &value, bool *defval);
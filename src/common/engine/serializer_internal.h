@@ -1,3 +1,5 @@
+#include <algorithm>
+
 const char* UnicodeToString(const char* cc);
 const char* StringToUnicode(const char* cc, int size = -1);
 
@@ -9,9 +11,14 @@ const char* StringToUnicode(const char* cc, int size = -1);
 
 struct FJSONObject
 {
+	// Objects with more members than this get a hash index on their first lookup.
+	enum { IndexThreshold = 8 };
+
 	rapidjson::Value* mObject;
 	rapidjson::Value::MemberIterator mIterator;
 	int mIndex;
+	unsigned mHint = 0;				// member after the last one found. Keys are mostly read in the order they were written.
+	TArray<uint64_t> mKeyIndex;		// sorted list of (key hash << 32 | member index)
 
 	FJSONObject(rapidjson::Value* v)
 	{
@@ -22,6 +29,70 @@ struct FJSONObject
 			mIndex = 0;
 		}
 	}
+
+	static uint32_t HashKey(const char *key, size_t len)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < len; i++) hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+		return hash;
+	}
+
+	bool MatchKey(unsigned index, const char *key, size_t len)
+	{
+		auto &name = (mObject->MemberBegin() + index)->name;
+		return name.GetStringLength() == len && !memcmp(name.GetString(), key, len);
+	}
+
+	void BuildKeyIndex()
+	{
+		unsigned count = mObject->MemberCount();
+		mKeyIndex.Resize(count);
+		auto it = mObject->MemberBegin();
+		for (unsigned i = 0; i < count; i++, ++it)
+		{
+			mKeyIndex[i] = (uint64_t(HashKey(it->name.GetString(), it->name.GetStringLength())) << 32) | i;
+		}
+		std::sort(mKeyIndex.begin(), mKeyIndex.end());
+	}
+
+	rapidjson::Value *FindMember(const char *key)
+	{
+		unsigned count = mObject->MemberCount();
+		size_t len = strlen(key);
+
+		if (mHint < count && MatchKey(mHint, key, len))
+		{
+			return &(mObject->MemberBegin() + mHint++)->value;
+		}
+		if (count <= IndexThreshold)
+		{
+			for (unsigned i = 0; i < count; i++)
+			{
+				if (MatchKey(i, key, len))
+				{
+					mHint = i + 1;
+					return &(mObject->MemberBegin() + i)->value;
+				}
+			}
+			return nullptr;
+		}
+
+		// Keys that were omitted because they had their default value would need a full scan to find out they are not there,
+		// so larger objects get looked up through the index.
+		if (mKeyIndex.Size() == 0) BuildKeyIndex();
+		uint64_t hash = uint64_t(HashKey(key, len)) << 32;
+		auto it = std::lower_bound(mKeyIndex.begin(), mKeyIndex.end(), hash);
+		for (; it != mKeyIndex.end() && (*it & 0xffffffff00000000ull) == hash; ++it)
+		{
+			unsigned i = unsigned(*it);
+			if (MatchKey(i, key, len))
+			{
+				mHint = i + 1;
+				return &(mObject->MemberBegin() + i)->value;
+			}
+		}
+		return nullptr;
+	}
 };
 
 //==========================================================================
@@ -179,6 +250,7 @@ struct FWriter
 struct FReader
 {
 	TArray<FJSONObject> mObjects;
+	TArray<char> mBuffer;	// The document is parsed in place, so its strings point into this and it must outlive mDoc.
 	rapidjson::Document mDoc;
 	TArray<DObject *> mDObjects;
 	rapidjson::Value *mKeyValue = nullptr;
@@ -186,7 +258,24 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		mBuffer.Resize(unsigned(length + 1));
+		memcpy(mBuffer.Data(), buffer, length);
+		mBuffer[length] = 0;
+		Parse();
+	}
+
+	// 'buffer' must contain the text followed by a terminating 0.
+	FReader(TArray<char> &&buffer) : mBuffer(std::move(buffer))
+	{
+		Parse();
+	}
+
+	void Parse()
+	{
+		// Parsing in place decodes the strings inside the buffer instead of
+		// allocating a copy of each one, which for a savegame are most of the
+		// document's allocations.
+		mDoc.ParseInsitu<rapidjson::kParseFullPrecisionFlag>(mBuffer.Data());
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
@@ -206,9 +295,7 @@ struct FReader
 			else
 			{
 				// Find the given key by name;
-				auto it = obj.mObject->FindMember(key);
-				if (it == obj.mObject->MemberEnd()) return nullptr;
-				return &it->value;
+				return obj.FindMember(key);
 			}
 		}
 		else if (obj.mObject->IsArray() && (unsigned)obj.mIndex < obj.mObject->Size())
@@ -47,6 +47,29 @@
 //==========================================================================
 
 void FStringTable::LoadStrings (const char *language)
+{
+	uint32_t langid = GetLanguageID(language);
+
+	loadFilter.Clear();
+	loadFilter.Push(override_table);
+	loadFilter.Push(global_table);
+	loadFilter.Push(default_table);
+	loadFilter.Push(langid);
+	loadFilter.Push(langid & MAKE_ID(0xff, 0xff, 0, 0));
+	LoadLumps();
+	loadFilter.Clear();
+
+	UpdateLanguage(language);
+}
+
+//==========================================================================
+//
+// Parses all LANGUAGE lumps. Only the tables in loadFilter get filled,
+// unless it is empty.
+//
+//==========================================================================
+
+void FStringTable::LoadLumps()
 {
 	int lastlump, lump;
 
@@ -64,10 +87,45 @@ void FStringTable::LoadStrings (const char *language)
 		if (!ParseLanguageCSV(lump, lumpdata))
  			LoadLanguage (lump, lumpdata);
 	}
-	UpdateLanguage(language);
 	allMacros.Clear();
 }
 
+//==========================================================================
+//
+// Checks if a string for the given table should be stored. If not, the
+// table gets remembered so that it can be loaded once it is needed.
+//
+//==========================================================================
+
+bool FStringTable::WantLanguage(uint32_t langid)
+{
+	if (loadFilter.Size() == 0 || loadFilter.Find(langid) < loadFilter.Size()) return true;
+	if (!allStrings.CheckKey(langid) && pendingLanguages.Find(langid) == pendingLanguages.Size())
+	{
+		pendingLanguages.Push(langid);
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// Loads a table that got skipped at startup. Every table is built
+// independently of the others so this yields the same content as
+// loading everything at once.
+//
+//==========================================================================
+
+void FStringTable::LoadPendingLanguage(uint32_t langid)
+{
+	unsigned index = pendingLanguages.Find(langid);
+	if (index == pendingLanguages.Size()) return;
+
+	pendingLanguages.Delete(index);
+	loadFilter.Push(langid);
+	LoadLumps();
+	loadFilter.Clear();
+}
+
 
 //==========================================================================
 //
@@ -397,7 +455,9 @@ void FStringTable::LoadLanguage (int lumpnum, const TArray<uint8_t> &buffer)
 
 void FStringTable::DeleteString(int langid, FName label)
 {
-	allStrings[langid].Remove(label);
+	if (!WantLanguage(langid)) return;
+	auto map = allStrings.CheckKey(langid);
+	if (map) map->Remove(label);
 }
 
 //==========================================================================
@@ -415,6 +475,7 @@ void FStringTable::DeleteForLabel(int lumpnum, FName label)
 
 	while (it.NextPair(pair))
 	{
+		if (loadFilter.Size() > 0 && loadFilter.Find(pair->Key) == loadFilter.Size()) continue;
 		auto entry = pair->Value.CheckKey(label);
 		if (entry && entry->filenum < filenum)
 		{
@@ -432,6 +493,8 @@ void FStringTable::DeleteForLabel(int lumpnum, FName label)
 
 void FStringTable::InsertString(int lumpnum, int langid, FName label, const FString &string)
 {
+	if (!WantLanguage(langid)) return;
+
 	const char *strlangid = (const char *)&langid;
 	TableElement te = { fileSystem.GetFileContainer(lumpnum), { string, string, string, string } };
 	long index;
@@ -467,11 +530,10 @@ void FStringTable::UpdateLanguage(const char *language)
 {
 	if (language) activeLanguage = language;
 	else language = activeLanguage.GetChars();
-	size_t langlen = strlen(language);
 
-	int LanguageID = (langlen < 2 || langlen > 3) ?
-		MAKE_ID('e', 'n', 'u', '\0') :
-		MAKE_ID(language[0], language[1], language[2], '\0');
+	uint32_t LanguageID = GetLanguageID(language);
+	LoadPendingLanguage(LanguageID);
+	LoadPendingLanguage(LanguageID & MAKE_ID(0xff, 0xff, 0, 0));
 
 	currentLanguageSet.Clear();
 
@@ -489,6 +551,21 @@ void FStringTable::UpdateLanguage(const char *language)
 	checkone(default_table);
 }
 
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+uint32_t FStringTable::GetLanguageID(const char *language)
+{
+	size_t langlen = strlen(language);
+
+	return (langlen < 2 || langlen > 3) ?
+		MAKE_ID('e', 'n', 'u', '\0') :
+		MAKE_ID(language[0], language[1], language[2], '\0');
+}
+
 //==========================================================================
 //
 // Replace \ escape sequences in a string with the escaped characters.
@@ -588,7 +665,7 @@ const char *FStringTable::GetString(const char *name, uint32_t *langtable, int g
 //
 //==========================================================================
 
-const char *FStringTable::GetLanguageString(const char *name, uint32_t langtable, int gender) const
+const char *FStringTable::GetLanguageString(const char *name, uint32_t langtable, int gender)
 {
 	if (name == nullptr || *name == 0)
 	{
@@ -599,6 +676,7 @@ const char *FStringTable::GetLanguageString(const char *name, uint32_t langtable
 	FName nm(name, true);
 	if (nm != NAME_None)
 	{
+		LoadPendingLanguage(langtable);
 		auto map = allStrings.CheckKey(langtable);
 		if (map == nullptr) return nullptr;
 		auto item = map->CheckKey(nm);
@@ -610,7 +688,7 @@ const char *FStringTable::GetLanguageString(const char *name, uint32_t langtable
 	return nullptr;
 }
 
-bool FStringTable::MatchDefaultString(const char *name, const char *content) const
+bool FStringTable::MatchDefaultString(const char *name, const char *content)
 {
 	// This only compares the first line to avoid problems with bad linefeeds. For the few cases where this feature is needed it is sufficient.
 	auto c = GetLanguageString(name, FStringTable::default_table);
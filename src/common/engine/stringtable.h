@@ -99,8 +99,8 @@ public:
 		UpdateLanguage(nullptr);
 	}
 	
-	const char *GetLanguageString(const char *name, uint32_t langtable, int gender = -1) const;
-	bool MatchDefaultString(const char *name, const char *content) const;
+	const char *GetLanguageString(const char *name, uint32_t langtable, int gender = -1);
+	bool MatchDefaultString(const char *name, const char *content);
 	const char *GetString(const char *name, uint32_t *langtable, int gender = -1) const;
 	const char *operator() (const char *name) const;	// Never returns NULL
 	const char *operator[] (const char *name) const
@@ -118,6 +118,11 @@ private:
 	TArray<std::pair<uint32_t, StringMap*>> currentLanguageSet;
 	StringtableCallbacks* callbacks = nullptr;
 
+	// Only the tables needed by the current language get filled at startup.
+	// The others are only parsed when they actually get used.
+	TArray<uint32_t> loadFilter;
+	TArray<uint32_t> pendingLanguages;
+
 	void LoadLanguage (int lumpnum, const TArray<uint8_t> &buffer);
 	TArray<TArray<FString>> parseCSV(const TArray<uint8_t> &buffer);
 	bool ParseLanguageCSV(int lumpnum, const TArray<uint8_t> &buffer);
@@ -127,6 +132,11 @@ private:
 	void InsertString(int lumpnum, int langid, FName label, const FString &string);
 	void DeleteString(int langid, FName label);
 	void DeleteForLabel(int lumpnum, FName label);
+	bool WantLanguage(uint32_t langid);
+	void LoadLumps();
+	void LoadPendingLanguage(uint32_t langid);
+
+	static uint32_t GetLanguageID(const char *language);
 
 	static size_t ProcessEscapes (char *str);
 public:
@@ -0,0 +1,302 @@
+/*
+** zonetrace.cpp
+** Scoped zone tracing in Chrome's trace event format
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Every thread collects its finished zones in a private buffer which only
+** gets handed to the file writer when it is full, so recording a zone
+** does not need any synchronization.
+**
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include "zonetrace.h"
+#include "tarray.h"
+#include "i_time.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "templates.h"
+
+bool TraceActive;
+
+struct FTraceEvent
+{
+	const char *name;
+	uint64_t start, end;
+	int tid;
+	char arg[48];
+};
+
+static std::mutex TraceLock;
+static FILE *TraceFile;
+static uint64_t TraceStartTime;			// events from before the file was opened must not end up in it.
+static bool TraceFirstEvent;
+static std::atomic<int> TraceThreadCount;
+
+static TArray<FTraceEvent> TraceHistory;
+static uint64_t HistoryStartTime;
+static uint64_t HistoryLength;			// in ns, 0 if disabled.
+
+static void Trace_Flush(TArray<FTraceEvent> &events);
+
+struct FTraceThread
+{
+	TArray<FTraceEvent> events;
+	int tid = TraceThreadCount++;
+
+	~FTraceThread()
+	{
+		Trace_Flush(events);
+	}
+};
+
+static thread_local FTraceThread TraceThread;
+
+enum
+{
+	TRACE_BUFFER_SIZE = 4096
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void Trace_WriteEvent(FILE *f, const FTraceEvent &ev, uint64_t base, bool first)
+{
+	fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+		first ? "" : ",\n", ev.name, ev.tid, (ev.start - base) / 1000., (ev.end - ev.start) / 1000.);
+	if (ev.arg[0] != 0)
+	{
+		fputs(",\"args\":{\"name\":\"", f);
+		for (const char *c = ev.arg; *c; c++)
+		{
+			if (*c == '"' || *c == '\\') fputc('\\', f);
+			if ((unsigned char)*c >= 32) fputc(*c, f);
+		}
+		fputs("\"}", f);
+	}
+	fputc('}', f);
+}
+
+//==========================================================================
+//
+// Hands a thread's events to the file and the history.
+// Must not be called with TraceLock held.
+//
+//==========================================================================
+
+static void Trace_Flush(TArray<FTraceEvent> &events)
+{
+	if (events.Size() == 0) return;
+
+	std::lock_guard<std::mutex> lock(TraceLock);
+	uint64_t latest = 0;
+	for (auto &ev : events)
+	{
+		if (TraceFile != nullptr && ev.start >= TraceStartTime)
+		{
+			Trace_WriteEvent(TraceFile, ev, TraceStartTime, TraceFirstEvent);
+			TraceFirstEvent = false;
+		}
+		if (HistoryLength > 0 && ev.start >= HistoryStartTime)
+		{
+			TraceHistory.Push(ev);
+			latest = MAX(latest, ev.end);
+		}
+	}
+	events.Clear();
+
+	// The history only gets trimmed once it holds twice the requested time so that this doesn't have to move the events around all the time.
+	if (TraceHistory.Size() > 0 && TraceHistory[0].start + 2 * HistoryLength < latest)
+	{
+		unsigned i = 0;
+		while (i < TraceHistory.Size() && TraceHistory[i].start + HistoryLength < latest) i++;
+		TraceHistory.Delete(0, i);
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+uint64_t Trace_Begin()
+{
+	return I_nsTime();
+}
+
+void Trace_End(const char *name, uint64_t start, const char *arg)
+{
+	auto &thread = TraceThread;
+	auto &ev = thread.events[thread.events.Reserve(1)];
+	ev.name = name;
+	ev.start = start;
+	ev.end = I_nsTime();
+	ev.tid = thread.tid;
+	ev.arg[0] = 0;
+	if (arg != nullptr)
+	{
+		strncpy(ev.arg, arg, sizeof(ev.arg) - 1);
+		ev.arg[sizeof(ev.arg) - 1] = 0;
+	}
+	if (thread.events.Size() >= TRACE_BUFFER_SIZE) Trace_Flush(thread.events);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool Trace_Start(const char *filename)
+{
+	Trace_Stop();
+
+	std::lock_guard<std::mutex> lock(TraceLock);
+	TraceFile = fopen(filename, "wt");
+	if (TraceFile == nullptr)
+	{
+		Printf("Unable to open trace file %s\n", filename);
+		return false;
+	}
+	fputs("[\n", TraceFile);
+	TraceFirstEvent = true;
+	TraceStartTime = I_nsTime();
+	TraceActive = true;
+	Printf("Recording trace to %s\n", filename);
+	return true;
+}
+
+//==========================================================================
+//
+// Zones that are still open or sitting in other threads' buffers are lost.
+//
+//==========================================================================
+
+void Trace_Stop()
+{
+	if (TraceFile == nullptr) return;
+
+	Trace_Flush(TraceThread.events);
+
+	std::lock_guard<std::mutex> lock(TraceLock);
+	fputs("\n]\n", TraceFile);
+	fclose(TraceFile);
+	TraceFile = nullptr;
+	TraceActive = HistoryLength > 0;
+	Printf("Trace recording stopped\n");
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void Trace_SetHistory(double seconds)
+{
+	std::lock_guard<std::mutex> lock(TraceLock);
+	uint64_t length = seconds > 0 ? uint64_t(seconds * 1'000'000'000) : 0;
+	if (length > 0 && HistoryLength == 0)
+	{
+		HistoryStartTime = I_nsTime();
+	}
+	else if (length == 0)
+	{
+		TraceHistory.Reset();
+	}
+	HistoryLength = length;
+	TraceActive = HistoryLength > 0 || TraceFile != nullptr;
+}
+
+//==========================================================================
+//
+// Writes out the zones of the last few seconds. The calling thread's
+// buffer gets included, other threads only contribute what they already
+// handed over.
+//
+//==========================================================================
+
+bool Trace_WriteHistory(const char *filename)
+{
+	if (HistoryLength == 0) return false;
+	Trace_Flush(TraceThread.events);
+
+	std::lock_guard<std::mutex> lock(TraceLock);
+	FILE *f = fopen(filename, "wt");
+	if (f == nullptr) return false;
+
+	uint64_t latest = 0, base = UINT64_MAX;
+	for (auto &ev : TraceHistory) latest = MAX(latest, ev.end);
+	for (auto &ev : TraceHistory) if (ev.start + HistoryLength >= latest) base = MIN(base, ev.start);
+
+	fputs("[\n", f);
+	bool first = true;
+	for (auto &ev : TraceHistory)
+	{
+		if (ev.start + HistoryLength >= latest)
+		{
+			Trace_WriteEvent(f, ev, base, first);
+			first = false;
+		}
+	}
+	fputs("\n]\n", f);
+	fclose(f);
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(trace)
+{
+	if (argv.argc() < 2 || (stricmp(argv[1], "start") && stricmp(argv[1], "stop")))
+	{
+		Printf("Usage: trace start [<file>] | trace stop\n");
+		return;
+	}
+	if (!stricmp(argv[1], "start"))
+	{
+		Trace_Start(argv.argc() > 2 ? argv[2] : "trace.json");
+	}
+	else
+	{
+		Trace_Stop();
+	}
+}
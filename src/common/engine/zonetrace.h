@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+// Scoped zone tracing for diagnosing stutters.
+//
+// Zones are recorded per thread and written as Chrome trace events which can be viewed with
+// chrome://tracing or Perfetto and imported into Tracy. Nesting follows from the zones' time ranges.
+// While no trace is being recorded a zone costs a single well predicted branch, so they can stay in release builds.
+//
+// Zone names must be string literals because only the pointer gets stored.
+// The optional argument, e.g. a lump name, gets copied.
+
+extern bool TraceActive;
+
+uint64_t Trace_Begin();
+void Trace_End(const char *name, uint64_t start, const char *arg = nullptr);
+bool Trace_Start(const char *filename);
+void Trace_Stop();
+
+// Keeps the zones of the last few seconds in memory so they can be written out after something interesting happened.
+void Trace_SetHistory(double seconds);
+bool Trace_WriteHistory(const char *filename);
+
+class FTraceZone
+{
+	const char *name;
+	const char *arg;
+	uint64_t start;
+
+public:
+	explicit FTraceZone(const char *n, const char *a = nullptr) : name(n), arg(a), start(TraceActive ? Trace_Begin() : 0) {}
+	~FTraceZone()
+	{
+		if (start != 0) Trace_End(name, start, arg);
+	}
+
+	FTraceZone(const FTraceZone &) = delete;
+	FTraceZone &operator=(const FTraceZone &) = delete;
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_ZONE(name) FTraceZone TRACE_CONCAT(tracezone_, __LINE__)(name)
+#define TRACE_ZONE_ARG(name, arg) FTraceZone TRACE_CONCAT(tracezone_, __LINE__)(name, arg)
@@ -34,11 +34,14 @@
 */
 
 #include <time.h>
+#include <mutex>
 #include "file_zip.h"
 #include "cmdlib.h"
 #include "templates.h"
 #include "printf.h"
 #include "w_zip.h"
+#include "i_specialpaths.h"
+#include "superfasthash.h"
 
 #include "ancientzip.h"
 
@@ -158,6 +161,148 @@ static uint32_t Zip_FindCentralDir(FileReader &fin)
 	return uPosFound;
 }
 
+//==========================================================================
+//
+// Zip directory cache
+//
+// Caches the parsed central directories of all Zips that were opened
+// from disk so that the next launch does not have to seek to the end of
+// each file to read them. Entries are validated by the file's size and
+// modification time.
+//
+//==========================================================================
+
+static const char ZipCacheMagic[4] = { 'Z', 'D', 'I', '1' };
+static const unsigned MAX_ZIPCACHE_ENTRIES = 512;
+
+struct FZipCacheEntry
+{
+	uint64_t FileSize;
+	uint64_t FileTime;
+	uint32_t FilterHash;
+	bool Used;
+	TArray<uint8_t> Data;
+};
+
+static std::mutex ZipCacheMutex;	// archives get opened on worker threads.
+static TMap<FString, FZipCacheEntry> ZipCache;
+static bool ZipCacheLoaded;
+static bool ZipCacheChanged;
+
+static FString ZipCacheFileName(bool create)
+{
+	FString path = M_GetCachePath(create);
+	if (create) CreatePath(path);
+	path << "/zipdircache.zdzc";
+	return path;
+}
+
+static void LoadZipCache()
+{
+	ZipCacheLoaded = true;
+	FileReader fr;
+	if (!fr.OpenFile(ZipCacheFileName(false))) return;
+
+	char magic[4];
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, ZipCacheMagic, 4) != 0) return;
+	uint32_t count = fr.ReadUInt32();
+	if (count > MAX_ZIPCACHE_ENTRIES) return;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t namelen = fr.ReadUInt32();
+		if (namelen > 4096)	break;
+		TArray<char> name(namelen, true);
+		if (fr.Read(name.Data(), namelen) != namelen) break;
+
+		FZipCacheEntry entry;
+		if (fr.Read(&entry.FileSize, 8) != 8 || fr.Read(&entry.FileTime, 8) != 8) break;
+		entry.FilterHash = fr.ReadUInt32();
+		uint32_t datalen = fr.ReadUInt32();
+		if (datalen > 0x4000000) break;
+		entry.Data.Resize(datalen);
+		if (fr.Read(entry.Data.Data(), datalen) != datalen) break;
+		entry.Used = false;
+		ZipCache.Insert(FString(name.Data(), namelen), std::move(entry));
+	}
+}
+
+//==========================================================================
+//
+// Writes the cache back if anything was added to it. Entries that were
+// not used in this session get dropped first if the cache gets too large.
+//
+//==========================================================================
+
+void SaveZipDirectoryCache()
+{
+	std::lock_guard<std::mutex> lock(ZipCacheMutex);
+	if (!ZipCacheChanged) return;
+	ZipCacheChanged = false;
+
+	TArray<TMap<FString, FZipCacheEntry>::Pair *> entries;
+	TMap<FString, FZipCacheEntry>::Iterator it(ZipCache);
+	TMap<FString, FZipCacheEntry>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		if (pair->Value.Used) entries.Push(pair);
+	}
+	it.Reset();
+	while (it.NextPair(pair) && entries.Size() < MAX_ZIPCACHE_ENTRIES)
+	{
+		if (!pair->Value.Used) entries.Push(pair);
+	}
+	if (entries.Size() > MAX_ZIPCACHE_ENTRIES) entries.Resize(MAX_ZIPCACHE_ENTRIES);
+
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(ZipCacheFileName(true)));
+	if (fw == nullptr) return;
+	uint32_t count = entries.Size();
+	fw->Write(ZipCacheMagic, 4);
+	fw->Write(&count, 4);
+	for (auto entry : entries)
+	{
+		uint32_t namelen = entry->Key.Len();
+		uint32_t datalen = entry->Value.Data.Size();
+		fw->Write(&namelen, 4);
+		fw->Write(entry->Key.GetChars(), namelen);
+		fw->Write(&entry->Value.FileSize, 8);
+		fw->Write(&entry->Value.FileTime, 8);
+		fw->Write(&entry->Value.FilterHash, 4);
+		fw->Write(&datalen, 4);
+		fw->Write(entry->Value.Data.Data(), datalen);
+	}
+}
+
+//==========================================================================
+//
+// The prefix stripping in FZipFile::Open depends on these parts of the
+// filter so they must be part of the cache key.
+//
+//==========================================================================
+
+static uint32_t ZipFilterHash(LumpFilterInfo *filter)
+{
+	if (filter == nullptr) return 0;
+	uint32_t hash = 1;
+	for (auto &str : filter->reservedFolders) hash = hash * 31 + SuperFastHash(str.GetChars(), str.Len() + 1);
+	hash = hash * 31;
+	for (auto &str : filter->requiredPrefixes) hash = hash * 31 + SuperFastHash(str.GetChars(), str.Len() + 1);
+	return hash;
+}
+
+template<class T> static void WriteCacheValue(TArray<uint8_t> &data, T value)
+{
+	unsigned pos = data.Reserve(sizeof(T));
+	memcpy(&data[pos], &value, sizeof(T));
+}
+
+template<class T> static bool ReadCacheValue(const TArray<uint8_t> &data, unsigned &pos, T &value)
+{
+	if (pos + sizeof(T) > data.Size()) return false;
+	memcpy(&value, &data[pos], sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
 //==========================================================================
 //
 // Zip file
@@ -170,14 +315,127 @@ FZipFile::FZipFile(const char * filename, FileReader &file)
 	Lumps = NULL;
 }
 
+//==========================================================================
+//
+// Sets up the lumps from the directory cache, if it has a valid entry for this file.
+//
+//==========================================================================
+
+bool FZipFile::OpenFromCache(LumpFilterInfo* filter, size_t filesize, time_t filetime)
+{
+	std::lock_guard<std::mutex> lock(ZipCacheMutex);
+	if (!ZipCacheLoaded) LoadZipCache();
+	auto entry = ZipCache.CheckKey(FileName);
+	if (entry == nullptr || entry->FileSize != filesize || entry->FileTime != (uint64_t)filetime || entry->FilterHash != ZipFilterHash(filter))
+	{
+		return false;
+	}
+
+	unsigned pos = 0;
+	uint32_t count;
+	if (!ReadCacheValue(entry->Data, pos, count) || count > entry->Data.Size()) return false;
+
+	Lumps = new FZipLump[count];
+	for (uint32_t i = 0; i < count; i++)
+	{
+		auto lump_p = &Lumps[i];
+		uint32_t namelen;
+		if (!ReadCacheValue(entry->Data, pos, namelen) || pos + namelen > entry->Data.Size())
+		{
+			goto broken;
+		}
+		lump_p->LumpNameSetup(FString((const char*)&entry->Data[pos], namelen));
+		pos += namelen;
+		if (!ReadCacheValue(entry->Data, pos, lump_p->LumpSize) ||
+			!ReadCacheValue(entry->Data, pos, lump_p->Method) ||
+			!ReadCacheValue(entry->Data, pos, lump_p->GPFlags) ||
+			!ReadCacheValue(entry->Data, pos, lump_p->CRC32) ||
+			!ReadCacheValue(entry->Data, pos, lump_p->CompressedSize) ||
+			!ReadCacheValue(entry->Data, pos, lump_p->Position))
+		{
+			goto broken;
+		}
+		lump_p->Owner = this;
+		lump_p->Flags = LUMPF_FULLPATH;
+		lump_p->NeedFileStart = true;
+		if (lump_p->Method != METHOD_STORED) lump_p->Flags |= LUMPF_COMPRESSED;
+		lump_p->CheckEmbedded();
+	}
+	NumLumps = count;
+	entry->Used = true;
+	return true;
+
+broken:
+	delete[] Lumps;
+	Lumps = nullptr;
+	ZipCache.Remove(FileName);
+	ZipCacheChanged = true;
+	return false;
+}
+
+//==========================================================================
+//
+// Stores the lump directory in the cache. Must be done before any name filtering.
+//
+//==========================================================================
+
+void FZipFile::WriteToCache(LumpFilterInfo* filter, size_t filesize, time_t filetime)
+{
+	FZipCacheEntry entry;
+	entry.FileSize = filesize;
+	entry.FileTime = filetime;
+	entry.FilterHash = ZipFilterHash(filter);
+	entry.Used = true;
+	WriteCacheValue(entry.Data, NumLumps);
+	for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		auto lump_p = &Lumps[i];
+		auto name = lump_p->getName();
+		uint32_t namelen = (uint32_t)strlen(name);
+		WriteCacheValue(entry.Data, namelen);
+		unsigned pos = entry.Data.Reserve(namelen);
+		memcpy(&entry.Data[pos], name, namelen);
+		WriteCacheValue(entry.Data, lump_p->LumpSize);
+		WriteCacheValue(entry.Data, lump_p->Method);
+		WriteCacheValue(entry.Data, lump_p->GPFlags);
+		WriteCacheValue(entry.Data, lump_p->CRC32);
+		WriteCacheValue(entry.Data, lump_p->CompressedSize);
+		WriteCacheValue(entry.Data, lump_p->Position);
+	}
+
+	std::lock_guard<std::mutex> lock(ZipCacheMutex);
+	// Copy the name so that it cannot share its reference counted data with a string on another thread.
+	ZipCache.Insert(FString(FileName.GetChars()), std::move(entry));
+	ZipCacheChanged = true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 {
-	uint32_t centraldir = Zip_FindCentralDir(Reader);
 	FZipEndOfCentralDirectory info;
 	int skipped = 0;
+	bool warned = false;
 
 	Lumps = NULL;
 
+	// Only files that are directly on disk can be cached. For everything else this check fails.
+	size_t filesize = 0;
+	time_t filetime = 0;
+	bool cacheable = GetFileInfo(FileName, &filesize, &filetime) && (long)filesize == Reader.GetLength();
+	if (cacheable && OpenFromCache(filter, filesize, filetime))
+	{
+		GenerateHash();
+		PostProcessArchive(&Lumps[0], sizeof(FZipLump), filter);
+		return true;
+	}
+
+	uint32_t centraldir = Zip_FindCentralDir(Reader);
+
 	if (centraldir == 0)
 	{
 		if (!quiet) Printf(TEXTCOLOR_RED "\n%s: ZIP file corrupt!\n", FileName.GetChars());
@@ -303,6 +561,7 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 		{
 			if (!quiet) Printf(TEXTCOLOR_YELLOW "\n%s: '%s' uses an unsupported compression algorithm (#%d).\n", FileName.GetChars(), name.GetChars(), zip_fh->Method);
 			skipped++;
+			warned = true;
 			continue;
 		}
 		// Also ignore encrypted entries
@@ -311,6 +570,7 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 		{
 			if (!quiet) Printf(TEXTCOLOR_YELLOW "\n%s: '%s' is encrypted. Encryption is not supported.\n", FileName.GetChars(), name.GetChars());
 			skipped++;
+			warned = true;
 			continue;
 		}
 
@@ -337,6 +597,9 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 	NumLumps -= skipped;
 	free(directory);
 
+	// Files with problems are not cached so that the warnings get printed each time.
+	if (cacheable && !warned) WriteToCache(filter, filesize, filetime);
+
 	GenerateHash();
 	PostProcessArchive(&Lumps[0], sizeof(FZipLump), filter);
 	return true;
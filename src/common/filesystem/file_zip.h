@@ -38,6 +38,9 @@ class FZipFile : public FResourceFile
 {
 	FZipLump *Lumps;
 
+	bool OpenFromCache(LumpFilterInfo* filter, size_t filesize, time_t filetime);
+	void WriteToCache(LumpFilterInfo* filter, size_t filesize, time_t filetime);
+
 public:
 	FZipFile(const char * filename, FileReader &file);
 	virtual ~FZipFile();
@@ -39,6 +39,7 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
+#include <algorithm>
 
 #include "m_argv.h"
 #include "cmdlib.h"
@@ -46,6 +47,11 @@
 #include "m_crc32.h"
 #include "printf.h"
 #include "md5.h"
+#include "engineerrors.h"
+#include "ctpl.h"
+#include "superfasthash.h"
+#include "zonetrace.h"
+#include "memstats.h"
 
 extern	FILE* hashfile;
 
@@ -159,6 +165,7 @@ FileSystem::~FileSystem ()
 
 void FileSystem::DeleteAll ()
 {
+	ClearPrefetches();
 	Hashes.Clear();
 	NumEntries = 0;
 
@@ -193,6 +200,47 @@ void FileSystem::InitSingleFile(const char* filename, bool quiet)
 	InitMultipleFiles(filenames, true);
 }
 
+//==========================================================================
+//
+// FString uses non-atomic reference counting so the worker threads each
+// need their own copy of the filter that does not share any string data.
+//
+//==========================================================================
+
+static void CloneStrings(TArray<FString> &dest, const TArray<FString> &src)
+{
+	for (auto &str : src) dest.Push(FString(str.GetChars()));
+}
+
+static void CloneFilter(LumpFilterInfo &dest, const LumpFilterInfo &src)
+{
+	CloneStrings(dest.gameTypeFilter, src.gameTypeFilter);
+	dest.dotFilter = FString(src.dotFilter.GetChars());
+	CloneStrings(dest.reservedFolders, src.reservedFolders);
+	CloneStrings(dest.requiredPrefixes, src.requiredPrefixes);
+}
+
+//==========================================================================
+//
+// Opens a file and reads its directory. This runs on a worker thread.
+// Everything it prints gets collected so that it can be output once the
+// file is being added.
+//
+//==========================================================================
+
+void FileSystem::PrepareFile(FPreparedFile &prep, bool quiet)
+{
+	bool isdir = false;
+	PrintCaptureBuffer = &prep.Output;
+	if (DirEntryExists(prep.FileName, &isdir))
+	{
+		auto filter = prep.HasFilter ? &prep.Filter : nullptr;
+		if (!isdir) prep.ResFile = FResourceFile::OpenResourceFile(prep.FileName, quiet, false, filter);
+		else prep.ResFile = FResourceFile::OpenDirectory(prep.FileName, quiet, filter);
+	}
+	PrintCaptureBuffer = nullptr;
+}
+
 void FileSystem::InitMultipleFiles (TArray<FString> &filenames, bool quiet, LumpFilterInfo* filter)
 {
 	int numfiles;
@@ -201,10 +249,45 @@ void FileSystem::InitMultipleFiles (TArray<FString> &filenames, bool quiet, Lump
 	DeleteAll();
 	numfiles = 0;
 
+	// Opening the files and parsing their directories is independent of each other, so do that in parallel.
+	// Adding them to the lump directory is done in load order afterward so that later files still override earlier ones.
+	// (The hash file needs the file's reader after opening, so that always goes the serial route.)
+	TArray<FPreparedFile> prepared;
+	std::vector<std::future<void>> jobs;
+	unsigned numthreads = std::min<unsigned>(std::thread::hardware_concurrency(), filenames.Size());
+	if (hashfile == nullptr && numthreads > 1)
+	{
+		ctpl::thread_pool pool(numthreads);
+		prepared.Resize(filenames.Size());
+		for (unsigned i = 0; i < filenames.Size(); i++)
+		{
+			prepared[i].FileName = filenames[i].GetChars();	// must not share the string data with the main thread.
+			if (filter)
+			{
+				CloneFilter(prepared[i].Filter, *filter);
+				prepared[i].HasFilter = true;
+			}
+			jobs.push_back(pool.push([this, &prepared, i, quiet](int) { PrepareFile(prepared[i], quiet); }));
+		}
+	}
+
 	for(unsigned i=0;i<filenames.Size(); i++)
 	{
 		int baselump = NumEntries;
-		AddFile (filenames[i], nullptr, quiet, filter);
+		if (i < jobs.size())
+		{
+			// rethrows any error that occured on the worker.
+			jobs[i].get();
+		}
+		if (i < prepared.Size() && prepared[i].ResFile != nullptr)
+		{
+			AddFile(filenames[i], nullptr, quiet, filter, &prepared[i]);
+		}
+		else
+		{
+			// Let the regular path report why the file could not be opened.
+			AddFile(filenames[i], nullptr, quiet, filter);
+		}
 		
 		if (i == (unsigned)MaxIwadIndex) MoveLumpsInFolder("after_iwad/");
 		FStringf path("filter/%s", Files.Last()->GetHash().GetChars());
@@ -218,6 +301,7 @@ void FileSystem::InitMultipleFiles (TArray<FString> &filenames, bool quiet, Lump
 		else return;
 	}
 	if (filter && filter->postprocessFunc) filter->postprocessFunc();
+	SaveZipDirectoryCache();
 
 	// [RH] Set up hash table
 	InitHashChains ();
@@ -280,13 +364,17 @@ int FileSystem::AddFromBuffer(const char* name, const char* type, char* data, in
 // [RH] Removed reload hack
 //==========================================================================
 
-void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, LumpFilterInfo* filter)
+void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, LumpFilterInfo* filter, FPreparedFile *prepared)
 {
 	int startlump;
 	bool isdir = false;
 	FileReader filereader;
 
-	if (filer == nullptr)
+	if (prepared != nullptr)
+	{
+		// already opened by InitMultipleFiles.
+	}
+	else if (filer == nullptr)
 	{
 		// Does this exist? If so, is it a directory?
 		if (!DirEntryExists(filename, &isdir))
@@ -301,7 +389,7 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, L
 
 		if (!isdir)
 		{
-			if (!filereader.OpenFile(filename))
+			if (!filereader.OpenMappedFile(filename) && !filereader.OpenFile(filename))
 			{ // Didn't find file
 				if (!quiet)
 				{
@@ -319,7 +407,13 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, L
 
 	FResourceFile *resfile;
 	
-	if (!isdir)
+	if (prepared != nullptr)
+	{
+		if (prepared->Output.IsNotEmpty()) Printf("%s", prepared->Output.GetChars());
+		resfile = prepared->ResFile;
+		prepared->ResFile = nullptr;
+	}
+	else if (!isdir)
 		resfile = FResourceFile::OpenResourceFile(filename, filereader, quiet, false, filter);
 	else
 		resfile = FResourceFile::OpenDirectory(filename, quiet, filter);
@@ -850,26 +944,57 @@ void FileSystem::InitHashChains (void)
 	NextLumpIndex_ResId = &Hashes[NumEntries * 7];
 
 
+	// Calculating the hash keys is the expensive part so for large directories this gets split up between multiple threads.
+	// Linking the chains must be done in lump order so that later lumps are found first, but that is cheap.
+	TArray<uint32_t> keys(NumEntries * 3, true);
+	auto calckeys = [&](unsigned start, unsigned end)
+	{
+		for (unsigned k = start; k < end; k++)
+		{
+			keys[k * 3] = LumpNameHash(FileInfo[k].shortName.String);
+			auto &longName = FileInfo[k].longName;
+			if (longName.IsNotEmpty())
+			{
+				// This may not create any FStrings because their reference counting is not thread safe.
+				const char *name = longName.GetChars();
+				const char *dot = strrchr(name, '.');
+				const char *slash = strrchr(name, '/');
+				size_t noextlen = dot != nullptr && dot > slash ? dot - name : strlen(name);
+				keys[k * 3 + 1] = MakeKey(name);
+				keys[k * 3 + 2] = MakeKey(name, noextlen);
+			}
+		}
+	};
+	unsigned numthreads = NumEntries >= 0x10000 ? std::min(std::thread::hardware_concurrency(), 8u) : 1;
+	if (numthreads > 1)
+	{
+		ctpl::thread_pool pool(numthreads - 1);
+		std::vector<std::future<void>> jobs;
+		unsigned partsize = (NumEntries + numthreads - 1) / numthreads;
+		for (unsigned p = 1; p < numthreads; p++)
+		{
+			jobs.push_back(pool.push([=](int) { calckeys(std::min(p * partsize, NumEntries), std::min((p + 1) * partsize, NumEntries)); }));
+		}
+		calckeys(0, partsize);
+		for (auto &job : jobs) job.get();
+	}
+	else calckeys(0, NumEntries);
+
 	// Now set up the chains
 	for (i = 0; i < (unsigned)NumEntries; i++)
 	{
-		j = LumpNameHash (FileInfo[i].shortName.String) % NumEntries;
+		j = keys[i * 3] % NumEntries;
 		NextLumpIndex[i] = FirstLumpIndex[j];
 		FirstLumpIndex[j] = i;
 
 		// Do the same for the full paths
 		if (FileInfo[i].longName.IsNotEmpty())
 		{
-			j = MakeKey(FileInfo[i].longName) % NumEntries;
+			j = keys[i * 3 + 1] % NumEntries;
 			NextLumpIndex_FullName[i] = FirstLumpIndex_FullName[j];
 			FirstLumpIndex_FullName[j] = i;
 
-			FString nameNoExt = FileInfo[i].longName;
-			auto dot = nameNoExt.LastIndexOf('.');
-			auto slash = nameNoExt.LastIndexOf('/');
-			if (dot > slash) nameNoExt.Truncate(dot);
-
-			j = MakeKey(nameNoExt) % NumEntries;
+			j = keys[i * 3 + 2] % NumEntries;
 			NextLumpIndex_NoExt[i] = FirstLumpIndex_NoExt[j];
 			FirstLumpIndex_NoExt[j] = i;
 
@@ -1315,6 +1440,143 @@ TArray<uint8_t> FileSystem::GetFileData(int lump, int pad)
 	if (pad > 0) memset(&data[size], 0, pad);
 	return data;
 }
+//==========================================================================
+//
+// GetFileDataAsync
+//
+// Reading the raw data is done right away, only the decompression is
+// handed off to a worker so that large lumps can be prefetched without
+// blocking. Uncompressed lumps are read directly and return a future
+// that is already satisfied. Decompression errors are passed on as
+// exceptions by the future.
+//
+//==========================================================================
+
+static ctpl::thread_pool DecompressPool;
+
+std::future<TArray<uint8_t>> FileSystem::GetFileDataAsync(int lump, int pad)
+{
+	if ((size_t)lump >= FileInfo.Size() || !(FileInfo[lump].lump->Flags & LUMPF_COMPRESSED) || FileInfo[lump].lump->LockCount() != 0)
+	{
+		std::promise<TArray<uint8_t>> promise;
+		promise.set_value(GetFileData(lump, pad));
+		return promise.get_future();
+	}
+
+	FCompressedBuffer cbuf = FileInfo[lump].lump->GetRawData();
+	if (cbuf.mMethod == METHOD_STORED)
+	{
+		// This archive type has no separate compressed representation so it already got decompressed here.
+		TArray<uint8_t> data(cbuf.mSize + pad, true);
+		memcpy(data.Data(), cbuf.mBuffer, cbuf.mSize);
+		if (pad > 0) memset(&data[cbuf.mSize], 0, pad);
+		cbuf.Clean();
+		std::promise<TArray<uint8_t>> promise;
+		promise.set_value(std::move(data));
+		return promise.get_future();
+	}
+
+	if (DecompressPool.size() == 0) DecompressPool.resize(2);
+	return DecompressPool.push([=](int) mutable
+	{
+		TArray<uint8_t> data(cbuf.mSize + pad, true);
+		FString errors;
+		PrintCaptureBuffer = &errors;	// the console may not be accessed from here.
+		bool ok = cbuf.Decompress((char*)data.Data());
+		PrintCaptureBuffer = nullptr;
+		if (pad > 0) memset(&data[cbuf.mSize], 0, pad);
+		cbuf.Clean();
+		if (!ok) throw CRecoverableError(errors.GetChars());
+		return data;
+	});
+}
+
+//==========================================================================
+//
+// PrefetchFile
+//
+// Only compressed lumps benefit from this. Everything else can be read
+// directly and is left alone.
+//
+//==========================================================================
+
+void FileSystem::PrefetchFile(int lump)
+{
+	if ((size_t)lump >= FileInfo.Size()) return;
+	auto rl = FileInfo[lump].lump;
+	if (!(rl->Flags & LUMPF_COMPRESSED) || rl->Cache != nullptr || rl->LumpSize <= 0) return;
+	if (Prefetches.find(lump) != Prefetches.end()) return;
+	Prefetches[lump] = GetFileDataAsync(lump);
+}
+
+//==========================================================================
+//
+// Moves a finished prefetch into the lump's cache. This holds one
+// reference that the caller must release after locking the lump for
+// its own use, so that the data gets freed with the last regular
+// reference.
+//
+//==========================================================================
+
+bool FileSystem::FinishPrefetch(int lump)
+{
+	if (Prefetches.empty()) return false;
+	auto it = Prefetches.find(lump);
+	if (it == Prefetches.end()) return false;
+	auto future = std::move(it->second);
+	Prefetches.erase(it);
+
+	TArray<uint8_t> data;
+	try
+	{
+		data = future.get();
+	}
+	catch (CRecoverableError &)
+	{
+		// Let the regular path run into the error again so that it gets reported in the usual way.
+		return false;
+	}
+	auto rl = FileInfo[lump].lump;
+	if (rl->Cache != nullptr || data.Size() < (unsigned)rl->LumpSize) return false;
+	rl->Cache = new char[rl->LumpSize];
+	memcpy(rl->Cache, data.Data(), rl->LumpSize);
+	rl->RefCount = 1;
+	return true;
+}
+
+void FileSystem::ClearPrefetches()
+{
+	for (auto &pf : Prefetches)
+	{
+		// Results that were not needed are discarded, but the workers must be done with them first.
+		pf.second.wait();
+	}
+	Prefetches.clear();
+}
+
+//==========================================================================
+//
+// GetCacheSize
+//
+//==========================================================================
+
+size_t FileSystem::GetCacheSize () const
+{
+	size_t total = 0;
+	for (auto &rec : FileInfo)
+	{
+		if (rec.lump->Cache != nullptr) total += rec.lump->LumpSize;
+	}
+	return total;
+}
+
+static size_t FileCacheUsage()
+{
+	return fileSystem.GetCacheSize();
+}
+
+static FMemReporter FileCacheMemory(MEM_FileCache, FileCacheUsage);
+
 //==========================================================================
 //
 // W_ReadFile
@@ -1325,6 +1587,7 @@ TArray<uint8_t> FileSystem::GetFileData(int lump, int pad)
 
 void FileSystem::ReadFile (int lump, void *dest)
 {
+	TRACE_ZONE_ARG("FileSystem::ReadFile", GetFileFullName(lump));
 	auto lumpr = OpenFileReader (lump);
 	auto size = lumpr.GetLength ();
 	auto numread = lumpr.Read (dest, size);
@@ -1367,6 +1630,7 @@ FileReader FileSystem::OpenFileReader(int lump)
 	}
 
 	auto rl = FileInfo[lump].lump;
+	bool prefetched = FinishPrefetch(lump);
 	auto rd = rl->GetReader();
 
 	if (rl->RefCount == 0 && rd != nullptr && !rd->GetBuffer() && !(rl->Flags & LUMPF_COMPRESSED))
@@ -1375,7 +1639,9 @@ FileReader FileSystem::OpenFileReader(int lump)
 		rdr.OpenFilePart(*rd, rl->GetFileOffset(), rl->LumpSize);
 		return rdr;
 	}
-	return rl->NewReader();	// This always gets a reader to the cache
+	auto rdr = rl->NewReader();	// This always gets a reader to the cache
+	if (prefetched) rl->Unlock();
+	return rdr;
 }
 
 FileReader FileSystem::ReopenFileReader(int lump, bool alwayscache)
@@ -1386,6 +1652,7 @@ FileReader FileSystem::ReopenFileReader(int lump, bool alwayscache)
 	}
 
 	auto rl = FileInfo[lump].lump;
+	bool prefetched = FinishPrefetch(lump);
 	auto rd = rl->GetReader();
 
 	if (rl->RefCount == 0 && rd != nullptr && !rd->GetBuffer() && !alwayscache && !(rl->Flags & LUMPF_COMPRESSED))
@@ -1398,7 +1665,9 @@ FileReader FileSystem::ReopenFileReader(int lump, bool alwayscache)
 			return fr;
 		}
 	}
-	return rl->NewReader();	// This always gets a reader to the cache
+	auto rdr = rl->NewReader();	// This always gets a reader to the cache
+	if (prefetched) rl->Unlock();
+	return rdr;
 }
 
 FileReader FileSystem::OpenFileReader(const char* name)
@@ -1567,6 +1836,7 @@ FileData::~FileData ()
 
 FString::FString (ELumpNum lumpnum)
 {
+	TRACE_ZONE_ARG("FileSystem::ReadFile", fileSystem.GetFileFullName((int)lumpnum));
 	auto lumpr = fileSystem.OpenFileReader ((int)lumpnum);
 	auto size = lumpr.GetLength ();
 	AllocBuffer (1 + size);
@@ -1663,7 +1933,10 @@ const void *FileSystem::Lock(int lump)
 {
 	if ((size_t)lump >= FileInfo.Size()) return nullptr;
 	auto lumpp = FileInfo[lump].lump;
-	return lumpp->Lock();
+	bool prefetched = FinishPrefetch(lump);
+	auto p = lumpp->Lock();
+	if (prefetched) lumpp->Unlock();
+	return p;
 }
 
 void FileSystem::Unlock(int lump)
@@ -1677,6 +1950,7 @@ const void *FileSystem::Get(int lump)
 {
 	if ((size_t)lump >= FileInfo.Size()) return nullptr;
 	auto lumpp = FileInfo[lump].lump;
+	FinishPrefetch(lump);	// no need to release the reference here.
 	auto p = lumpp->Lock();
 	lumpp->RefCount = INT_MAX/2; // lock forever.
 	return p;
@@ -13,6 +13,8 @@
 #include "cmdlib.h"
 #include "zstring.h"
 #include "resourcefile.h"
+#include <future>
+#include <map>
 
 class FResourceFile;
 struct FResourceLump;
@@ -57,6 +59,16 @@ struct FolderEntry
 class FileSystem
 {
 public:
+	// A file that got opened ahead of time by a worker thread.
+	struct FPreparedFile
+	{
+		FString FileName;
+		LumpFilterInfo Filter;
+		bool HasFilter = false;
+		FResourceFile *ResFile = nullptr;
+		FString Output;		// what got printed while opening the file.
+	};
+
 	FileSystem ();
 	~FileSystem ();
 
@@ -69,7 +81,7 @@ public:
 
 	void InitSingleFile(const char *filename, bool quiet = false);
 	void InitMultipleFiles (TArray<FString> &filenames, bool quiet = false, LumpFilterInfo* filter = nullptr);
-	void AddFile (const char *filename, FileReader *wadinfo, bool quiet, LumpFilterInfo* filter);
+	void AddFile (const char *filename, FileReader *wadinfo, bool quiet, LumpFilterInfo* filter, FPreparedFile *prepared = nullptr);
 	int CheckIfResourceFileLoaded (const char *name) noexcept;
 	void AddAdditionalFile(const char* filename, FileReader* wadinfo = NULL) {}
 
@@ -130,6 +142,9 @@ public:
 
 	void ReadFile (int lump, void *dest);
 	TArray<uint8_t> GetFileData(int lump, int pad = 0);	// reads lump into a writable buffer and optionally adds some padding at the end. (FileData isn't writable!)
+	std::future<TArray<uint8_t>> GetFileDataAsync(int lump, int pad = 0);	// same, but compressed lumps get decompressed on a worker thread.
+	void PrefetchFile(int lump);	// starts decompressing a lump in the background. The next access will then find it in the cache.
+	void ClearPrefetches();
 	FileData ReadFile (int lump);
 	FileData ReadFile (const char *name) { return ReadFile (GetNumForName (name)); }
 
@@ -166,6 +181,7 @@ public:
 	FString GetFileFullPath (int lump) const;		// [RH] Returns wad's name + lump's full name
 	int GetFileContainer (int lump) const;				// [RH] Returns wadnum for a specified lump
 	int GetFileNamespace (int lump) const;			// [RH] Returns the namespace a lump belongs to
+	size_t GetCacheSize () const;					// Returns the size of all lumps currently held in memory
 	void SetFileNamespace(int lump, int ns);
 	int GetResourceId(int lump) const;				// Returns the RFF index number for this lump
 	const char* GetResourceType(int lump) const;
@@ -221,6 +237,8 @@ protected:
 	uint32_t* FirstLumpIndex_ResId;	// The same information for fully qualified paths from .zips
 	uint32_t* NextLumpIndex_ResId;
 
+	std::map<int, std::future<TArray<uint8_t>>> Prefetches;
+
 	uint32_t NumEntries = 0;					// Not necessarily the same as FileInfo.Size()
 	uint32_t NumWads;
 
@@ -230,6 +248,8 @@ protected:
 private:
 	void DeleteAll();
 	void MoveLumpsInFolder(const char *);
+	void PrepareFile(FPreparedFile &prep, bool quiet);
+	bool FinishPrefetch(int lump);
 
 };
 
@@ -264,7 +264,8 @@ FResourceFile *FResourceFile::OpenResourceFile(const char *filename, FileReader
 FResourceFile *FResourceFile::OpenResourceFile(const char *filename, bool quiet, bool containeronly, LumpFilterInfo* filter)
 {
 	FileReader file;
-	if (!file.OpenFile(filename)) return nullptr;
+	// Prefer mapping the file so that uncompressed lumps can be used in place instead of being read into the heap.
+	if (!file.OpenMappedFile(filename) && !file.OpenFile(filename)) return nullptr;
 	return DoOpenResourceFile(filename, file, quiet, containeronly, filter);
 }
 
@@ -169,6 +169,8 @@ public:
 	FResourceLump *FindLump(const char *name);
 };
 
+void SaveZipDirectoryCache();
+
 struct FUncompressedLump : public FResourceLump
 {
 	int				Position;
@@ -55,6 +55,7 @@
 #include "fontchars.h"
 #include "multipatchtexture.h"
 #include "texturemanager.h"
+#include "v_draw.h"
 
 #include "fontinternals.h"
 
@@ -474,6 +475,9 @@ void FFont::ReadSheetFont(TArray<FolderEntry> &folderdata, int width, int height
 
 FFont::~FFont ()
 {
+	// Cached text runs refer to this font's glyphs.
+	ClearTextCache();
+
 	FFont **prev = &FirstFont;
 	FFont *font = *prev;
 
@@ -885,7 +889,7 @@ int FFont::GetCharCode(int code, bool needpic) const
 		// regular chars turn negative when the 8th bit is set.
 		code &= 255;
 	}
-	if (code >= FirstChar && code <= LastChar && (!needpic || Chars[code - FirstChar].TranslatedPic != nullptr))
+	if (code >= FirstChar && code <= LastChar && (!needpic || HasGlyph(code)))
 	{
 		return code;
 	}
@@ -899,7 +903,7 @@ int FFont::GetCharCode(int code, bool needpic) const
 		if (myislower(code))
 		{
 			code = upperforlower[code];
-			if (code >= FirstChar && code <= LastChar && (!needpic || Chars[code - FirstChar].TranslatedPic != nullptr))
+			if (code >= FirstChar && code <= LastChar && (!needpic || HasGlyph(code)))
 			{
 				return code;
 			}
@@ -909,7 +913,7 @@ int FFont::GetCharCode(int code, bool needpic) const
 		if (newcode != code)
 		{
 			code = newcode;
-			if (code >= FirstChar && code <= LastChar && (!needpic || Chars[code - FirstChar].TranslatedPic != nullptr))
+			if (code >= FirstChar && code <= LastChar && (!needpic || HasGlyph(code)))
 			{
 				return code;
 			}
@@ -924,7 +928,7 @@ int FFont::GetCharCode(int code, bool needpic) const
 		while ((newcode = stripaccent(code)) != code)
 		{
 			code = newcode;
-			if (code >= FirstChar && code <= LastChar && (!needpic || Chars[code - FirstChar].TranslatedPic != nullptr))
+			if (code >= FirstChar && code <= LastChar && (!needpic || HasGlyph(code)))
 			{
 				return code;
 			}
@@ -942,7 +946,7 @@ int FFont::GetCharCode(int code, bool needpic) const
 		while ((newcode = stripaccent(code)) != code)
 		{
 			code = newcode;
-			if (code >= FirstChar && code <= LastChar && (!needpic || Chars[code - FirstChar].TranslatedPic != nullptr))
+			if (code >= FirstChar && code <= LastChar && (!needpic || HasGlyph(code)))
 			{
 				return code;
 			}
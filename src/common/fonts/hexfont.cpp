@@ -230,51 +230,92 @@ TArray<uint8_t> FHexFontChar2::CreatePalettedPixels(int)
 
 
 
-class FHexFont : public FFont
-{
-	
-public:
-	//==========================================================================
-	//
-	// FHexFont :: FHexFont
-	//
-	// Loads a HEX font
-	//
-	//==========================================================================
+//==========================================================================
+//
+// FHexFontBase
+//
+// Both hex fonts span the entire BMP, so the glyph textures only get
+// created when a character is actually requested for the first time.
+//
+//==========================================================================
 
-	FHexFont (const char *fontname, int lump)
+class FHexFontBase : public FFont
+{
+protected:
+	FHexFontBase(const char *fontname, int lump, int height, int kerning)
 		: FFont(lump)
 	{
 		const int spacing = 9;
 		assert(lump >= 0);
 
 		FontName = fontname;
-		
+
 		FirstChar = hexdata.FirstChar;
 		LastChar = hexdata.LastChar;
 
 		Next = FirstFont;
 		FirstFont = this;
-		FontHeight = 16;
+		FontHeight = height;
 		SpaceWidth = 9;
-		GlobalKerning = 0;
+		GlobalKerning = kerning;
 		translateUntranslated = true;
 
 		Chars.Resize(LastChar - FirstChar + 1);
 		for (int i = FirstChar; i <= LastChar; i++)
 		{
-			if (hexdata.glyphmap[i] > 0)
+			auto offset = hexdata.glyphmap[i];
+			Chars[i - FirstChar].XMove = offset > 0 ? hexdata.glyphdata[offset] / 16 * spacing : spacing;
+		}
+	}
+
+	virtual FImageSource *CreateGlyph(uint8_t *sourcedata, int size) const = 0;
+
+	bool HasGlyph(int code) const override
+	{
+		return hexdata.glyphmap[code] > 0;
+	}
+
+public:
+	FGameTexture *GetChar(int code, int translation, int *const width, bool *redirected) const override
+	{
+		int realcode = GetCharCode(code, true);
+		if (realcode >= 0)
+		{
+			// This only fills in a cache entry so it is safe to do from a const method.
+			auto &chr = const_cast<CharData &>(Chars[realcode - FirstChar]);
+			if (chr.TranslatedPic == nullptr)
 			{
-				auto offset = hexdata.glyphmap[i];
-				int size = hexdata.glyphdata[offset] / 16;
-				Chars[i - FirstChar].TranslatedPic = MakeGameTexture(new FImageTexture(new FHexFontChar(&hexdata.glyphdata[offset + 1], size, size * 9, 16)), nullptr, ETextureType::FontChar);
-				Chars[i - FirstChar].OriginalPic = Chars[i - FirstChar].TranslatedPic;
-				Chars[i - FirstChar].XMove = size * spacing;
-				TexMan.AddGameTexture(Chars[i - FirstChar].TranslatedPic);
+				auto offset = hexdata.glyphmap[realcode];
+				chr.TranslatedPic = MakeGameTexture(new FImageTexture(CreateGlyph(&hexdata.glyphdata[offset + 1], hexdata.glyphdata[offset] / 16)), nullptr, ETextureType::FontChar);
+				chr.OriginalPic = chr.TranslatedPic;
+				TexMan.AddGameTexture(chr.TranslatedPic);
 			}
-			else Chars[i - FirstChar].XMove = spacing;
-
 		}
+		return FFont::GetChar(code, translation, width, redirected);
+	}
+};
+
+
+class FHexFont : public FHexFontBase
+{
+	
+public:
+	//==========================================================================
+	//
+	// FHexFont :: FHexFont
+	//
+	// Loads a HEX font
+	//
+	//==========================================================================
+
+	FHexFont (const char *fontname, int lump)
+		: FHexFontBase(fontname, lump, 16, 0)
+	{
+	}
+
+	FImageSource *CreateGlyph(uint8_t *sourcedata, int size) const override
+	{
+		return new FHexFontChar(sourcedata, size, size * 9, 16);
 	}
 
 	//==========================================================================
@@ -302,7 +343,7 @@ public:
 };
 
 
-class FHexFont2 : public FFont
+class FHexFont2 : public FHexFontBase
 {
 
 public:
@@ -315,37 +356,13 @@ public:
 	//==========================================================================
 
 	FHexFont2(const char *fontname, int lump)
-		: FFont(lump)
+		: FHexFontBase(fontname, lump, 18, -1)
 	{
-		const int spacing = 9;
-		assert(lump >= 0);
-
-		FontName = fontname;
-
-		FirstChar = hexdata.FirstChar;
-		LastChar = hexdata.LastChar;
-
-		Next = FirstFont;
-		FirstFont = this;
-		FontHeight = 18;
-		SpaceWidth = 9;
-		GlobalKerning = -1;
-		translateUntranslated = true;
-		Chars.Resize(LastChar - FirstChar + 1);
-		for (int i = FirstChar; i <= LastChar; i++)
-		{
-			if (hexdata.glyphmap[i] > 0)
-			{
-				auto offset = hexdata.glyphmap[i];
-				int size = hexdata.glyphdata[offset] / 16;
-				Chars[i - FirstChar].TranslatedPic = MakeGameTexture(new FImageTexture(new FHexFontChar2(&hexdata.glyphdata[offset + 1], size, 2 + size * 8, 18)), nullptr, ETextureType::FontChar);
-				Chars[i - FirstChar].OriginalPic = Chars[i - FirstChar].TranslatedPic;
-				Chars[i - FirstChar].XMove = size * spacing;
-				TexMan.AddGameTexture(Chars[i - FirstChar].TranslatedPic);
-			}
-			else Chars[i - FirstChar].XMove = spacing;
+	}
 
-		}
+	FImageSource *CreateGlyph(uint8_t *sourcedata, int size) const override
+	{
+		return new FHexFontChar2(sourcedata, size, 2 + size * 8, 18);
 	}
 
 	//==========================================================================
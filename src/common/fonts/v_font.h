@@ -140,6 +140,7 @@ protected:
 	void BuildTranslations (const double *luminosity, const uint8_t *identity,
 		const void *ranges, int total_colors, const PalEntry *palette, std::function<void(FRemapTable*)> post = nullptr);
 	void FixXMoves();
+	virtual bool HasGlyph(int code) const { return Chars[code - FirstChar].TranslatedPic != nullptr; }
 
 	static int SimpleTranslation (uint32_t *colorsused, uint8_t *translation,
 		uint8_t *identity, TArray<double> &Luminosity);
@@ -61,6 +61,7 @@ public:
 	virtual int FindFrame(const char * name) = 0;
 	virtual void RenderFrame(FModelRenderer *renderer, FGameTexture * skin, int frame, int frame2, double inter, int translation=0) = 0;
 	virtual void BuildVertexBuffer(FModelRenderer *renderer) = 0;
+	virtual void PrepareVertexData() {}	// CPU side of BuildVertexBuffer. May not touch any renderer state because it gets called from worker threads.
 	virtual void AddSkins(uint8_t *hitlist) = 0;
 	virtual float getAspectFactor(float vscale) { return 1.f; }
 
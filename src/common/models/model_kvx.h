@@ -46,6 +46,7 @@ protected:
 	bool mOwningVoxel;	// if created through MODELDEF deleting this object must also delete the voxel object
 	FTextureID mPalette;
 	unsigned int mNumIndices;
+	bool mMeshReady = false;
 	TArray<FModelVertex> mVertices;
 	TArray<unsigned int> mIndices;
 	
@@ -63,6 +64,7 @@ public:
 	virtual void AddSkins(uint8_t *hitlist);
 	FTextureID GetPaletteTexture() const { return mPalette; }
 	void BuildVertexBuffer(FModelRenderer *renderer);
+	void PrepareVertexData() override;
 	float getAspectFactor(float vscale) override;
 };
 
@@ -79,12 +79,13 @@ private:
 	TArray<FVector2> uvs;
 	TArray<OBJFace> faces;
 	TArray<OBJSurface> surfaces;
+	TArray<FModelVertex> vertexData;	// filled by PrepareVertexData, only kept until the vertex buffer is built.
 	FScanner sc;
 	TArray<OBJTriRef>* vertFaces;
 
 	int ResolveIndex(int origIndex, FaceElement el);
 	template<typename T, size_t L> void ParseVector(TArray<T> &array);
-	bool ParseFaceSide(const FString &side, OBJFace &face, int sidx);
+	bool ParseFaceSide(const char *side, OBJFace &face, int sidx);
 	void ConstructSurfaceTris(OBJSurface &surf);
 	void AddVertFaces();
 	void TriangulateQuad(const OBJFace &quad, OBJFace *tris);
@@ -99,6 +100,7 @@ public:
 	bool Load(const char* fn, int lumpnum, const char* buffer, int length) override;
 	int FindFrame(const char* name) override;
 	void RenderFrame(FModelRenderer* renderer, FGameTexture* skin, int frame, int frame2, double inter, int translation=0) override;
+	void PrepareVertexData() override;
 	void BuildVertexBuffer(FModelRenderer* renderer) override;
 	void AddSkins(uint8_t* hitlist) override;
 };
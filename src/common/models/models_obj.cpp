@@ -168,23 +168,20 @@ bool FOBJModel::Load(const char* fn, int lumpnum, const char* buffer, int length
 		}
 		else if (sc.Compare("f"))
 		{
-			FString sides[4];
 			OBJFace face;
 			for (int i = 0; i < 3; i++)
 			{
 				// A face must have at least 3 sides
 				sc.MustGetString();
-				sides[i] = sc.String;
-				if (!ParseFaceSide(sides[i], face, i)) return false;
+				if (!ParseFaceSide(sc.String, face, i)) return false;
 			}
 			face.sideCount = 3;
 			if (sc.GetString())
 			{
-				if (!sc.Compare("f") && FString(sc.String).IndexOfAny("-0123456789") == 0)
+				if (!sc.Compare("f") && sc.String[0] != 0 && strchr("-0123456789", sc.String[0]) != nullptr)
 				{
-					sides[3] = sc.String;
 					face.sideCount += 1;
-					if (!ParseFaceSide(sides[3], face, 3)) return false;
+					if (!ParseFaceSide(sc.String, face, 3)) return false;
 				}
 				else
 				{
@@ -258,18 +255,20 @@ template<typename T, size_t L> void FOBJModel::ParseVector(TArray<T> &array)
  * @param sidx The 0-based index of the side
  * @return Whether or not the face side was parsed successfully
  */
-bool FOBJModel::ParseFaceSide(const FString &sideStr, OBJFace &face, int sidx)
+bool FOBJModel::ParseFaceSide(const char *sideStr, OBJFace &face, int sidx)
 {
+	// The side is split at the separators here instead of creating strings for
+	// its parts because this runs for every corner of every face in the model.
 	OBJFaceSide side;
-	int origIdx;
-	if (sideStr.IndexOf(newSideSep) >= 0)
+	const char *uvStr = strchr(sideStr, *newSideSep);
+	if (uvStr != nullptr)
 	{
-		TArray<FString> sides = sideStr.Split(newSideSep, FString::TOK_KEEPEMPTY);
+		uvStr++;
+		const char *normStr = strchr(uvStr, *newSideSep);
 
-		if (sides[0].Len() > 0)
+		if (uvStr - 1 > sideStr)
 		{
-			origIdx = atoi(sides[0].GetChars());
-			side.vertref = ResolveIndex(origIdx, FaceElement::VertexIndex);
+			side.vertref = ResolveIndex(atoi(sideStr), FaceElement::VertexIndex);
 		}
 		else
 		{
@@ -277,28 +276,18 @@ bool FOBJModel::ParseFaceSide(const FString &sideStr, OBJFace &face, int sidx)
 			return false;
 		}
 
-		if (sides[1].Len() > 0)
+		if (*uvStr != 0 && *uvStr != *newSideSep)
 		{
-			origIdx = atoi(sides[1].GetChars());
-			side.uvref = ResolveIndex(origIdx, FaceElement::UVIndex);
+			side.uvref = ResolveIndex(atoi(uvStr), FaceElement::UVIndex);
 		}
 		else
 		{
 			side.uvref = -1;
 		}
 
-		if (sides.Size() > 2)
+		if (normStr != nullptr && normStr[1] != 0 && normStr[1] != *newSideSep)
 		{
-			if (sides[2].Len() > 0)
-			{
-				origIdx = atoi(sides[2].GetChars());
-				side.normref = ResolveIndex(origIdx, FaceElement::VNormalIndex);
-			}
-			else
-			{
-				side.normref = -1;
-				hasMissingNormals = true;
-			}
+			side.normref = ResolveIndex(atoi(normStr + 1), FaceElement::VNormalIndex);
 		}
 		else
 		{
@@ -308,8 +297,7 @@ bool FOBJModel::ParseFaceSide(const FString &sideStr, OBJFace &face, int sidx)
 	}
 	else
 	{
-		origIdx = atoi(sideStr.GetChars());
-		side.vertref = ResolveIndex(origIdx, FaceElement::VertexIndex);
+		side.vertref = ResolveIndex(atoi(sideStr), FaceElement::VertexIndex);
 		side.normref = -1;
 		hasMissingNormals = true;
 		side.uvref = -1;
@@ -352,13 +340,13 @@ int FOBJModel::ResolveIndex(int origIndex, FaceElement el)
 }
 
 /**
- * Construct the vertex buffer for this model
+ * Generate the vertex data for this model
  *
- * @param renderer A pointer to the model renderer. Used to allocate the vertex buffer.
+ * This only works on the model's own data, so it can run on a worker thread.
  */
-void FOBJModel::BuildVertexBuffer(FModelRenderer *renderer)
+void FOBJModel::PrepareVertexData()
 {
-	if (GetVertexBuffer(renderer->GetType()))
+	if (vertexData.Size() > 0)
 	{
 		return;
 	}
@@ -377,10 +365,8 @@ void FOBJModel::BuildVertexBuffer(FModelRenderer *renderer)
 		AddVertFaces();
 	}
 
-	auto vbuf = renderer->CreateVertexBuffer(false,true);
-	SetVertexBuffer(renderer->GetType(), vbuf);
-
-	FModelVertex *vertptr = vbuf->LockVertexBuffer(vbufsize);
+	vertexData.Resize(vbufsize);
+	FModelVertex *vertptr = vertexData.Data();
 
 	for (unsigned int i = 0; i < surfaces.Size(); i++)
 	{
@@ -434,7 +420,31 @@ void FOBJModel::BuildVertexBuffer(FModelRenderer *renderer)
 		}
 		delete[] vertFaces;
 	}
+}
+
+/**
+ * Construct the vertex buffer for this model
+ *
+ * @param renderer A pointer to the model renderer. Used to allocate the vertex buffer.
+ */
+void FOBJModel::BuildVertexBuffer(FModelRenderer *renderer)
+{
+	if (GetVertexBuffer(renderer->GetType()))
+	{
+		return;
+	}
+
+	PrepareVertexData();
+
+	auto vbuf = renderer->CreateVertexBuffer(false,true);
+	SetVertexBuffer(renderer->GetType(), vbuf);
+
+	FModelVertex *vertptr = vbuf->LockVertexBuffer(vertexData.Size());
+	if (vertexData.Size() > 0) memcpy(vertptr, vertexData.Data(), vertexData.Size() * sizeof(FModelVertex));
 	vbuf->UnlockVertexBuffer();
+
+	// Another renderer's buffer can generate the data again.
+	vertexData.Reset();
 }
 
 /**
@@ -473,7 +483,6 @@ void FOBJModel::ConstructSurfaceTris(OBJSurface &surf)
 			delete[] triangulated;
 			triIdx += 1; // Filling out two faces
 		}
-		DPrintf(DMSG_SPAMMY, "Smooth group: %d\n", surf.tris[triIdx].smoothGroup);
 	}
 }
 
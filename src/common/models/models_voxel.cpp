@@ -312,6 +312,19 @@ void FVoxelModel::Initialize()
 			}
 		}
 	}
+	mMeshReady = true;
+}
+
+//===========================================================================
+//
+// Builds the mesh ahead of time so that the precacher can do this for
+// all voxels in parallel and BuildVertexBuffer only has to upload it.
+//
+//===========================================================================
+
+void FVoxelModel::PrepareVertexData()
+{
+	if (!mMeshReady) Initialize();
 }
 
 //===========================================================================
@@ -324,7 +337,7 @@ void FVoxelModel::BuildVertexBuffer(FModelRenderer *renderer)
 {
 	if (!GetVertexBuffer(renderer->GetType()))
 	{
-		Initialize();
+		PrepareVertexData();
 
 		auto vbuf = renderer->CreateVertexBuffer(true, true);
 		SetVertexBuffer(renderer->GetType(), vbuf);
@@ -344,6 +357,7 @@ void FVoxelModel::BuildVertexBuffer(FModelRenderer *renderer)
 		mIndices.Clear();
 		mVertices.ShrinkToFit();
 		mIndices.ShrinkToFit();
+		mMeshReady = false;
 	}
 }
 
@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <type_traits>
 #include "m_alloc.h"
+#include "dobjpool.h"
 #include "vectors.h"
 #include "name.h"
 #include "palentry.h"
@@ -266,18 +267,18 @@ private:
 
 	void *operator new(size_t len, nonew&)
 	{
-		return M_Malloc(len);
+		return M_AllocObject(len);
 	}
 public:
 
 	void operator delete (void *mem, nonew&)
 	{
-		M_Free(mem);
+		M_FreeObject(mem);
 	}
 
 	void operator delete (void *mem)
 	{
-		M_Free(mem);
+		M_FreeObject(mem);
 	}
 
 	// GC fiddling
@@ -344,7 +345,7 @@ protected:
 
 	void operator delete (void *mem, EInPlace *)
 	{
-		M_Free (mem);
+		M_FreeObject (mem);
 	}
 
 	template<typename T, typename... Args>
@@ -389,6 +390,7 @@ static inline void GC::WriteBarrier(DObject *pointed)
 }
 
 #include "memarena.h"
+#include "flatmap.h"
 extern FMemArena ClassDataAllocator;
 #include "symbols.h"
 #include "dobjtype.h"
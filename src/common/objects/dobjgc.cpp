@@ -62,6 +62,10 @@
 #include "menu.h"
 #include "stats.h"
 #include "printf.h"
+#include "c_cvars.h"
+#include "i_time.h"
+#include "zonetrace.h"
+#include "memstats.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -91,6 +95,12 @@
 #define GCSWEEPCOST		10
 #define GCFINALIZECOST	100
 
+// Number of single steps between checks of the time budget.
+#define GCBUDGETCHECK	16
+
+// Upper bounds in microseconds of the pause histogram's buckets.
+static const int GCPauseBuckets[] = { 50, 100, 250, 500, 1000, 2000, 5000 };
+
 // TYPES -------------------------------------------------------------------
 
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
@@ -103,6 +113,12 @@
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
+// Maximum time in microseconds the collector may spend per tic. 0 means no limit.
+CUSTOM_CVAR(Int, gc_timebudget, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+}
+
 namespace GC
 {
 size_t AllocBytes;
@@ -122,6 +138,12 @@ bool FinalGC;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
+static int BudgetTic = -1;
+static uint64_t BudgetUsed;
+static int PauseHistogram[countof(GCPauseBuckets) + 1];
+static uint64_t MaxPause;
+static int BudgetCutoffs;
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -373,6 +395,7 @@ static size_t SingleStep()
 
 void Step()
 {
+	TRACE_ZONE("GC::Step");
 	size_t lim = (GCSTEPSIZE/100) * StepMul;
 	size_t olim;
 	if (lim == 0)
@@ -380,11 +403,44 @@ void Step()
 		lim = (~(size_t)0) / 2;		// no limit
 	}
 	Dept += AllocBytes - Threshold;
+
+	uint64_t start = I_nsTime();
+	uint64_t budget = 0;
+	if (gc_timebudget > 0)
+	{
+		int tic = I_GetTime();
+		if (tic != BudgetTic)
+		{
+			BudgetTic = tic;
+			BudgetUsed = 0;
+		}
+		// Ignore the budget if the collector falls too far behind the allocations.
+		if (AllocBytes < (Estimate / 100) * Pause * 2)
+		{
+			budget = uint64_t(gc_timebudget) * 1000;
+			if (BudgetUsed >= budget) budget = 1;	// still make some progress
+			else budget -= BudgetUsed;
+		}
+	}
+
+	int steps = 0;
 	do
 	{
 		olim = lim;
 		lim -= SingleStep();
+		if (budget != 0 && ++steps % GCBUDGETCHECK == 0 && I_nsTime() - start >= budget)
+		{
+			if (olim > lim) BudgetCutoffs++;
+			break;
+		}
 	} while (olim > lim && State != GCS_Pause);
+
+	uint64_t time = I_nsTime() - start;
+	BudgetUsed += time;
+	if (time > MaxPause) MaxPause = time;
+	unsigned bucket = 0;
+	while (bucket < countof(GCPauseBuckets) && time > uint64_t(GCPauseBuckets[bucket]) * 1000) bucket++;
+	PauseHistogram[bucket]++;
 	if (State != GCS_Pause)
 	{
 		if (Dept < GCSTEPSIZE)
@@ -415,6 +471,7 @@ void Step()
 
 void FullGC()
 {
+	TRACE_ZONE("GC::FullGC");
 	if (State <= GCS_Propagate)
 	{
 		// Reset sweep mark to sweep all elements (returning them to white)
@@ -554,6 +611,37 @@ void DelSoftRoot(DObject *obj)
 
 }
 
+//==========================================================================
+//
+// Sizes of all live objects, split into actors and everything else.
+// Memory owned by their fields, like strings and arrays, is not included.
+//
+//==========================================================================
+
+static size_t ObjectMemoryUsage(bool actors)
+{
+	size_t total = 0;
+	auto actorclass = PClass::FindClass(NAME_Actor);
+	for (DObject *obj = GC::Root; obj != nullptr; obj = obj->ObjNext)
+	{
+		if ((actorclass != nullptr && obj->IsKindOf(actorclass)) == actors) total += obj->GetClass()->Size;
+	}
+	return total;
+}
+
+static size_t ActorMemoryUsage()
+{
+	return ObjectMemoryUsage(true);
+}
+
+static size_t OtherObjectMemoryUsage()
+{
+	return ObjectMemoryUsage(false);
+}
+
+static FMemReporter ActorMemory(MEM_Actors, ActorMemoryUsage);
+static FMemReporter ObjectMemory(MEM_Objects, OtherObjectMemoryUsage);
+
 //==========================================================================
 //
 // STAT gc
@@ -583,6 +671,26 @@ ADD_STAT(gc)
 	return out;
 }
 
+//==========================================================================
+//
+// STAT gcpause
+//
+// Shows how long the collection steps took, to tune gc_timebudget.
+//
+//==========================================================================
+
+ADD_STAT(gcpause)
+{
+	FString out;
+	out.Format("Max: %.3f ms  Cut off by budget: %d\n", GC::MaxPause / 1000000., GC::BudgetCutoffs);
+	for (unsigned i = 0; i < countof(GC::PauseHistogram); i++)
+	{
+		if (i < countof(GCPauseBuckets)) out.AppendFormat("<%d us: %d  ", GCPauseBuckets[i], GC::PauseHistogram[i]);
+		else out.AppendFormat(">%d us: %d", GCPauseBuckets[i - 1], GC::PauseHistogram[i]);
+	}
+	return out;
+}
+
 //==========================================================================
 //
 // CCMD gc
@@ -595,7 +703,7 @@ CCMD(gc)
 {
 	if (argv.argc() == 1)
 	{
-		Printf ("Usage: gc stop|now|full|count|pause [size]|stepmul [size]\n");
+		Printf ("Usage: gc stop|now|full|count|resetstats|pause [size]|stepmul [size]\n");
 		return;
 	}
 	if (stricmp(argv[1], "stop") == 0)
@@ -610,6 +718,12 @@ CCMD(gc)
 	{
 		GC::FullGC();
 	}
+	else if (stricmp(argv[1], "resetstats") == 0)
+	{
+		memset(GC::PauseHistogram, 0, sizeof(GC::PauseHistogram));
+		GC::MaxPause = 0;
+		GC::BudgetCutoffs = 0;
+	}
 	else if (stricmp(argv[1], "count") == 0)
 	{
 		int cnt = 0;
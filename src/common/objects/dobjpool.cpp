@@ -0,0 +1,171 @@
+/*
+** dobjpool.cpp
+** Size class pools for DObject memory
+**
+**---------------------------------------------------------------------------
+**
+** Every block is preceded by a small header telling which pool it came
+** from, because objects get destroyed through DObject's operator delete
+** which has no idea of the object's real size. (Script classes can be
+** larger than their native base.) Freed blocks go on their pool's free
+** list where the next spawn of the same size picks them up again, so
+** the slabs get recycled each time the collector sweeps.
+**
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "dobject.h"
+#include "dobjpool.h"
+#include "engineerrors.h"
+#include "stats.h"
+#include "printf.h"
+
+enum
+{
+	POOL_GRANULARITY = 16,
+	POOL_MAXSIZE = 2048,		// larger objects are allocated individually.
+	POOL_NUMPOOLS = POOL_MAXSIZE / POOL_GRANULARITY,
+	POOL_SLABSIZE = 64 * 1024,
+};
+
+// The header keeps the object aligned to 16 bytes.
+struct alignas(16) FObjectHeader
+{
+	unsigned Pool;	// 0 means the block was allocated with M_Malloc.
+};
+
+struct FFreeObject
+{
+	FFreeObject *Next;
+};
+
+struct FObjectPool
+{
+	FFreeObject *FreeList;
+	uint8_t *SlabPos;
+	uint8_t *SlabEnd;
+	size_t BlockSize;
+	size_t InUse;
+	size_t Allocated;
+};
+
+static FObjectPool Pools[POOL_NUMPOOLS + 1];
+static size_t NumSlabs;
+
+//==========================================================================
+//
+// NewSlab
+//
+// Slabs are never returned to the system, so they do not count against
+// the GC's allocation estimate. Only the blocks in use do.
+//
+//==========================================================================
+
+static void NewSlab(FObjectPool &pool)
+{
+	uint8_t *slab = (uint8_t *)malloc(POOL_SLABSIZE);
+	if (slab == nullptr)
+	{
+		I_FatalError("Could not allocate %d bytes for an object pool", POOL_SLABSIZE);
+	}
+	pool.SlabPos = slab;
+	pool.SlabEnd = slab + POOL_SLABSIZE - POOL_SLABSIZE % pool.BlockSize;
+	NumSlabs++;
+}
+
+//==========================================================================
+//
+// M_AllocObject
+//
+//==========================================================================
+
+void *M_AllocObject(size_t size)
+{
+	unsigned index = unsigned((size + POOL_GRANULARITY - 1) / POOL_GRANULARITY);
+	FObjectHeader *header;
+
+	if (index > POOL_NUMPOOLS)
+	{
+		header = (FObjectHeader *)M_Malloc(sizeof(FObjectHeader) + size);
+		header->Pool = 0;
+		return header + 1;
+	}
+
+	auto &pool = Pools[index];
+	if (pool.BlockSize == 0)
+	{
+		pool.BlockSize = sizeof(FObjectHeader) + index * POOL_GRANULARITY;
+	}
+	if (pool.FreeList != nullptr)
+	{
+		header = (FObjectHeader *)pool.FreeList;
+		pool.FreeList = pool.FreeList->Next;
+	}
+	else
+	{
+		if (pool.SlabPos == pool.SlabEnd)
+		{
+			NewSlab(pool);
+		}
+		header = (FObjectHeader *)pool.SlabPos;
+		pool.SlabPos += pool.BlockSize;
+		pool.Allocated++;
+	}
+	pool.InUse++;
+	header->Pool = index;
+	GC::AllocBytes += pool.BlockSize;
+	return header + 1;
+}
+
+//==========================================================================
+//
+// M_FreeObject
+//
+//==========================================================================
+
+void M_FreeObject(void *mem)
+{
+	if (mem == nullptr)
+	{
+		return;
+	}
+	FObjectHeader *header = (FObjectHeader *)mem - 1;
+	if (header->Pool == 0)
+	{
+		M_Free(header);
+		return;
+	}
+	auto &pool = Pools[header->Pool];
+	auto block = (FFreeObject *)header;
+	block->Next = pool.FreeList;
+	pool.FreeList = block;
+	pool.InUse--;
+	GC::AllocBytes -= pool.BlockSize;
+}
+
+//==========================================================================
+//
+// STAT objpool
+//
+//==========================================================================
+
+ADD_STAT(objpool)
+{
+	size_t inuse = 0, allocated = 0, used = 0;
+	int pools = 0;
+	for (auto &pool : Pools)
+	{
+		if (pool.Allocated > 0)
+		{
+			inuse += pool.InUse;
+			allocated += pool.Allocated;
+			used += pool.InUse * pool.BlockSize;
+			pools++;
+		}
+	}
+	FString out;
+	out.Format("Objects: %zu of %zu in %d pools, %zuK of %zuK used",
+		inuse, allocated, pools, (used + 1023) >> 10, (NumSlabs * POOL_SLABSIZE) >> 10);
+	return out;
+}
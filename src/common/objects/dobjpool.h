@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stddef.h>
+
+// Memory for DObjects. Small objects are taken from per size class pools
+// so that spawning and destroying them does not need to go through malloc.
+// Allocations are accounted in GC::AllocBytes just like M_Malloc does.
+void *M_AllocObject(size_t size);
+void M_FreeObject(void *mem);
@@ -38,6 +38,7 @@
 #include "gl_renderstate.h"
 #include "v_video.h"
 #include "flatvertices.h"
+#include "templates.h"
 
 namespace OpenGLRenderer
 {
@@ -53,6 +54,11 @@ static inline void InvalidateBufferState()
 	gl_RenderState.ResetVertexBuffer();	// force rebinding of buffers on next Apply call.
 }
 
+// Ring buffers all switch sections together, one per frame the GPU may still be working on.
+static TArray<GLBuffer*> RingBuffers;
+static GLsync FrameFences[MAX_FRAMES_IN_FLIGHT];
+static int FrameSection;
+
 GLBuffer::GLBuffer(int usetype)
 	: mUseType(usetype)
 {
@@ -61,6 +67,7 @@ GLBuffer::GLBuffer(int usetype)
 
 GLBuffer::~GLBuffer()
 {
+	if (mSections > 1) RingBuffers.Delete(RingBuffers.Find(this));
 	if (mBufferId != 0)
 	{
 		glBindBuffer(mUseType, mBufferId);
@@ -88,24 +95,92 @@ void GLBuffer::SetData(size_t size, const void *data, bool staticdata)
 		mPersistent = screen->BuffersArePersistent() && !staticdata;
 		if (mPersistent)
 		{
-			glBufferStorage(mUseType, size, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-			map = glMapBufferRange(mUseType, 0, size, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+			glBufferStorage(mUseType, size * mSections, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+			mPersistentMap = glMapBufferRange(mUseType, 0, size * mSections, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 		}
 		else
 		{
 			glBufferData(mUseType, size, nullptr, staticdata ? GL_STATIC_DRAW : GL_STREAM_DRAW);
-			map = nullptr;
+			mPersistentMap = nullptr;
 		}
 		if (!staticdata) nomap = false;
 	}
 	buffersize = size;
+	SelectSection();
 	InvalidateBufferState();
 }
 
 void GLBuffer::SetSubData(size_t offset, size_t size, const void *data)
 {
 	Bind();
-	glBufferSubData(mUseType, offset, size, data);
+	glBufferSubData(mUseType, offset + mSectionOffset, size, data);
+}
+
+//==========================================================================
+//
+// Turns a persistently mapped streaming buffer into a ring of one copy
+// per frame in flight so that the CPU can fill the next frame's data
+// while the GPU is still reading the previous ones. This discards the
+// current contents. Without persistent mapping nothing changes, these
+// buffers then get synchronized with glFinish.
+//
+//==========================================================================
+
+void GLBuffer::SetRing()
+{
+	if (!mPersistent || mSections > 1) return;
+
+	Bind();
+	glUnmapBuffer(mUseType);
+	glDeleteBuffers(1, &mBufferId);
+	glGenBuffers(1, &mBufferId);
+	mSections = MAX_FRAMES_IN_FLIGHT;
+	SetData(buffersize, nullptr, false);
+	RingBuffers.Push(this);
+}
+
+void GLBuffer::SelectSection()
+{
+	mSectionOffset = mSections > 1 ? FrameSection * buffersize : 0;
+	map = mPersistentMap == nullptr ? nullptr : (uint8_t*)mPersistentMap + mSectionOffset;
+}
+
+void GLDataBuffer::SelectSection()
+{
+	GLBuffer::SelectSection();
+	if (mBoundBase) BindBase();
+}
+
+//==========================================================================
+//
+// Called after a frame got submitted. Waits until the GPU is no more than
+// 'depth' frames behind and moves all ring buffers to the next section.
+// The section that gets reused is always waited for, regardless of the
+// depth.
+//
+//==========================================================================
+
+static void WaitForFrame(int section)
+{
+	if (FrameFences[section] == nullptr) return;
+	while (glClientWaitSync(FrameFences[section], GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED)
+	{
+	}
+	glDeleteSync(FrameFences[section]);
+	FrameFences[section] = nullptr;
+}
+
+void GLBuffer::NextFrame(int depth)
+{
+	if (FrameFences[FrameSection] != nullptr) glDeleteSync(FrameFences[FrameSection]);
+	FrameFences[FrameSection] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	FrameSection = (FrameSection + 1) % MAX_FRAMES_IN_FLIGHT;
+	depth = clamp(depth, 1, (int)MAX_FRAMES_IN_FLIGHT);
+	WaitForFrame((FrameSection + MAX_FRAMES_IN_FLIGHT - depth) % MAX_FRAMES_IN_FLIGHT);
+	WaitForFrame(FrameSection);
+
+	for (auto buffer : RingBuffers) buffer->SelectSection();
 }
 
 void GLBuffer::Map()
@@ -152,6 +227,7 @@ void GLBuffer::Resize(size_t newsize)
 	{
 		// reallocate the buffer with twice the size
 		unsigned int oldbuffer = mBufferId;
+		size_t oldsize = buffersize, oldoffset = mSectionOffset;
 
 		// first unmap the old buffer
 		Bind();
@@ -161,8 +237,8 @@ void GLBuffer::Resize(size_t newsize)
 		SetData(newsize, nullptr, false);
 		glBindBuffer(GL_COPY_READ_BUFFER, oldbuffer);
 
-		// copy contents and delete the old buffer.
-		glCopyBufferSubData(GL_COPY_READ_BUFFER, mUseType, 0, 0, buffersize);
+		// copy contents and delete the old buffer. For a ring buffer only the current frame's section is still needed.
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, mUseType, oldoffset, mSectionOffset, oldsize);
 		glBindBuffer(GL_COPY_READ_BUFFER, 0);
 		glDeleteBuffers(1, &oldbuffer);
 		buffersize = newsize;
@@ -213,7 +289,7 @@ void GLVertexBuffer::Bind(int *offsets)
 		else
 		{
 			glEnableVertexAttribArray(i);
-			size_t ofs = offsets == nullptr ? attrinf.offset : attrinf.offset + mStride * offsets[attrinf.bindingpoint];
+			size_t ofs = mSectionOffset + (offsets == nullptr ? attrinf.offset : attrinf.offset + mStride * offsets[attrinf.bindingpoint]);
 			glVertexAttribPointer(i, attrinf.size, attrinf.format, attrinf.format != GL_FLOAT, (GLsizei)mStride, (void*)(intptr_t)ofs);
 		}
 		i++;
@@ -222,12 +298,15 @@ void GLVertexBuffer::Bind(int *offsets)
 
 void GLDataBuffer::BindRange(FRenderState *state, size_t start, size_t length)
 {
-	glBindBufferRange(mUseType, mBindingPoint, mBufferId, start, length);
+	glBindBufferRange(mUseType, mBindingPoint, mBufferId, start + mSectionOffset, length);
+	mBoundBase = false;
 }
 
 void GLDataBuffer::BindBase()
 {
-	glBindBufferBase(mUseType, mBindingPoint, mBufferId);
+	if (mSections > 1) glBindBufferRange(mUseType, mBindingPoint, mBufferId, mSectionOffset, buffersize);
+	else glBindBufferBase(mUseType, mBindingPoint, mBufferId);
+	mBoundBase = true;
 }
 
 
@@ -11,6 +11,11 @@
 namespace OpenGLRenderer
 {
 
+enum
+{
+	MAX_FRAMES_IN_FLIGHT = 3
+};
+
 class GLBuffer : virtual public IBuffer
 {
 protected:
@@ -19,9 +24,13 @@ protected:
 	int mAllocationSize = 0;
 	bool mPersistent = false;
 	bool nomap = true;
+	int mSections = 1;				// MAX_FRAMES_IN_FLIGHT for ring buffers, each frame writes to its own copy.
+	size_t mSectionOffset = 0;
+	void *mPersistentMap = nullptr;
 
 	GLBuffer(int usetype);
 	~GLBuffer();
+	virtual void SelectSection();
 	void SetData(size_t size, const void *data, bool staticdata) override;
 	void SetSubData(size_t offset, size_t size, const void *data) override;
 	void Map() override;
@@ -31,6 +40,9 @@ protected:
 	void Unlock() override;
 public:
 	void Bind();
+	void SetRing();
+
+	static void NextFrame(int depth);
 };
 
 
@@ -64,6 +76,9 @@ public:
 class GLDataBuffer : public IDataBuffer, public GLBuffer
 {
 	int mBindingPoint;
+	bool mBoundBase = false;
+
+	void SelectSection() override;
 public:
 	GLDataBuffer(int bindingpoint, bool is_ssbo);
 	void BindRange(FRenderState* state, size_t start, size_t length);
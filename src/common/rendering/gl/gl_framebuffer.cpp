@@ -75,6 +75,7 @@ extern bool vid_hdr_active;
 namespace OpenGLRenderer
 {
 	FGLRenderer *GLRenderer;
+	void FlushProgramBinaryCache();
 
 //==========================================================================
 //
@@ -98,6 +99,8 @@ OpenGLFrameBuffer::OpenGLFrameBuffer(void *hMonitor, bool fullscreen) :
 
 OpenGLFrameBuffer::~OpenGLFrameBuffer()
 {
+	// postprocessing shaders are compiled on demand, so their binaries only get written out here.
+	FlushProgramBinaryCache();
 	PPResource::ResetAll();
 
 	if (mVertexData != nullptr) delete mVertexData;
@@ -164,12 +167,17 @@ void OpenGLFrameBuffer::InitializeState()
 
 	SetViewportRects(nullptr);
 
-	mVertexData = new FFlatVertexBuffer(GetWidth(), GetHeight());
+	mVertexData = new FFlatVertexBuffer(GetWidth(), GetHeight(), BuffersArePersistent() ? MAX_FRAMES_IN_FLIGHT : 1);
 	mSkyData = new FSkyVertexBuffer;
 	mViewpoints = new HWViewpointBuffer;
 	mLights = new FLightBuffer();
 	GLRenderer = new FGLRenderer(this);
 	GLRenderer->Initialize(GetWidth(), GetHeight());
+
+	// These get completely refilled each frame and never need to wait for the GPU.
+	static_cast<GLDataBuffer*>(mViewpoints->GetBuffer())->SetRing();
+	static_cast<GLDataBuffer*>(mLights->GetBuffer())->SetRing();
+	mViewpoints->Invalidate();
 	static_cast<GLDataBuffer*>(mLights->GetBuffer())->BindBase();
 
 	mDebug = std::make_shared<FGLDebug>();
@@ -209,6 +217,22 @@ void OpenGLFrameBuffer::CopyScreenToBuffer(int width, int height, uint8_t* scr)
 	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, scr);
 }
 
+//===========================================================================
+//
+// Scene depth readback for the occlusion culling
+//
+//===========================================================================
+
+bool OpenGLFrameBuffer::StartSceneDepthReadback(int width, int height)
+{
+	return GLRenderer->mBuffers->StartSceneDepthReadback(mSceneViewport, width, height);
+}
+
+bool OpenGLFrameBuffer::FinishSceneDepthReadback(TArray<float> &depth)
+{
+	return GLRenderer->mBuffers->FinishSceneDepthReadback(depth);
+}
+
 //===========================================================================
 //
 // Camera texture rendering
@@ -250,16 +274,25 @@ const char* OpenGLFrameBuffer::DeviceName() const
 //==========================================================================
 
 CVAR(Bool, gl_finishbeforeswap, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
+CVARD(Int, gl_pipeline_depth, 2, CVAR_ARCHIVE|CVAR_GLOBALCONFIG, "number of frames the GPU may lag behind, 0 waits for each frame to finish")
 
 void OpenGLFrameBuffer::Swap()
 {
 	bool swapbefore = gl_finishbeforeswap && camtexcount == 0;
+	// Without persistent buffers there is nothing to put the next frames in while the GPU still needs the current one.
+	bool pipelined = !swapbefore && gl_pipeline_depth > 0 && BuffersArePersistent();
 	Finish.Reset();
 	Finish.Clock();
 	if (swapbefore) glFinish();
 	FPSLimit();
 	SwapBuffers();
-	if (!swapbefore) glFinish();
+	if (pipelined)
+	{
+		GLBuffer::NextFrame(gl_pipeline_depth);
+		mViewpoints->Invalidate();
+		gl_RenderState.ResetLightBinding();
+	}
+	else if (!swapbefore) glFinish();
 	Finish.Unclock();
 	camtexcount = 0;
 	FHardwareTexture::UnbindAll();
@@ -310,15 +343,22 @@ void OpenGLFrameBuffer::PrecacheMaterial(FMaterial *mat, int translation)
 	int flags = mat->GetScaleFlags();
 	int numLayers = mat->NumLayers();
 	MaterialLayerInfo* layer;
-	auto base = static_cast<FHardwareTexture*>(mat->GetLayer(0, translation, &layer));
+	bool shadertranslation = mat->GetTranslationFlags(translation, CLAMP_NONE) != 0;
+	auto base = static_cast<FHardwareTexture*>(mat->GetLayer(0, shadertranslation ? FMaterial::TRANSLATION_INDEXED : translation, &layer));
 
-	if (base->BindOrCreate(layer->layerTexture, 0, CLAMP_NONE, translation, layer->scaleFlags))
+	if (base->BindOrCreate(layer->layerTexture, 0, shadertranslation ? CLAMP_NOFILTER : CLAMP_NONE, translation, shadertranslation ? layer->scaleFlags | CTF_Indexed : layer->scaleFlags))
 	{
 		for (int i = 1; i < numLayers; i++)
 		{
 			auto systex = static_cast<FHardwareTexture*>(mat->GetLayer(i, 0, &layer));
 			systex->BindOrCreate(layer->layerTexture, i, CLAMP_NONE, 0, layer->scaleFlags);
 		}
+		if (shadertranslation)
+		{
+			auto lut = FMaterial::GetTranslationLUT();
+			auto systex = static_cast<FHardwareTexture*>(lut->GetHardwareTexture(translation, 0));
+			systex->BindOrCreate(lut, FMaterial::TRANSLATION_LUT_LAYER, CLAMP_NOFILTER_XY, translation, 0);
+		}
 	}
 	// unbind everything. 
 	FHardwareTexture::UnbindAll();
@@ -411,8 +451,11 @@ void OpenGLFrameBuffer::UpdateShadowMap()
 		GLRenderer->mShadowMapShader->Uniforms.SetData();
 		static_cast<GLDataBuffer*>(GLRenderer->mShadowMapShader->Uniforms.GetBuffer())->BindBase();
 
-		glViewport(0, 0, gl_shadowmap_quality, 1024);
-		GLRenderer->RenderScreenQuad();
+		for (auto &rows : screen->mShadowMap.DirtyRows())
+		{
+			glViewport(0, rows.start, gl_shadowmap_quality, rows.count);
+			GLRenderer->RenderScreenQuad();
+		}
 
 		const auto& viewport = screen->mScreenViewport;
 		glViewport(viewport.left, viewport.top, viewport.width, viewport.height);
@@ -35,6 +35,8 @@ public:
 	void WaitForCommands(bool finish) override;
 	void SetSaveBuffers(bool yes) override;
 	void CopyScreenToBuffer(int width, int height, uint8_t* buffer) override;
+	bool StartSceneDepthReadback(int width, int height) override;
+	bool FinishSceneDepthReadback(TArray<float> &depth) override;
 	bool FlipSavePic() const override { return true; }
 
 	FRenderState* RenderState() override;
@@ -45,6 +45,8 @@
 #include "gl_renderstate.h"
 #include "gl_samplers.h"
 #include "gl_hwtexture.h"
+#include "zonetrace.h"
+#include "memstats.h"
 
 namespace OpenGLRenderer
 {
@@ -77,18 +79,30 @@ unsigned int FHardwareTexture::lastbound[FHardwareTexture::MAX_TEXTURES];
 //
 //===========================================================================
 
+//===========================================================================
+// 
+//	Picks the internal format for gl_texture_compression. Small textures
+//	are left alone because they save little and artifacts are far more
+//	visible on them.
+//
+//===========================================================================
+
+static int GetCompressedFormat(int w, int h)
+{
+	enum { MIN_COMPRESSED_SIZE = 256 * 256 };
+	if (gl_texture_compression == 0 || w * h < MIN_COMPRESSED_SIZE) return GL_RGBA8;
+	if (gl_texture_compression >= 3 && gl.glslversion >= 4.2f) return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	if (gl_texture_compression >= 2 && (gl.flags & RFL_TEXTURE_COMPRESSION_S3TC)) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	return GL_COMPRESSED_RGBA;
+}
+
 unsigned int FHardwareTexture::CreateTexture(unsigned char * buffer, int w, int h, int texunit, bool mipmap, const char *name)
 {
+	TRACE_ZONE("TextureUpload");
 	int rh,rw;
-	int texformat = GL_RGBA8;// TexFormat[gl_texture_format];
+	int texformat = GL_RGBA8;
 	bool deletebuffer=false;
 
-	/*
-	if (forcenocompression)
-	{
-		texformat = GL_RGBA8;
-	}
-	*/
 	bool firstCall = glTexID == 0;
 	if (firstCall)
 	{
@@ -105,6 +119,7 @@ unsigned int FHardwareTexture::CreateTexture(unsigned char * buffer, int w, int
 
 	rw = GetTexDimension(w);
 	rh = GetTexDimension(h);
+	bool hasimage = buffer != nullptr && glBufferID == 0;
 	if (glBufferID > 0)
 	{
 		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
@@ -147,12 +162,17 @@ unsigned int FHardwareTexture::CreateTexture(unsigned char * buffer, int w, int
 	else
 	{
 		sourcetype = GL_BGRA;
+		// Only regular image textures get compressed. Buffered ones are canvases which get updated constantly.
+		if (hasimage) texformat = GetCompressedFormat(rw, rh);
 	}
 	
 	if (!firstCall && glBufferID > 0)
 		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rw, rh, sourcetype, GL_UNSIGNED_BYTE, buffer);
 	else
+	{
 		glTexImage2D(GL_TEXTURE_2D, 0, texformat, rw, rh, 0, sourcetype, GL_UNSIGNED_BYTE, buffer);
+		mImageBytes = size_t(rw) * rh * (glTextureBytes > 0 ? glTextureBytes : 4);
+	}
 
 	if (deletebuffer && buffer) free(buffer);
 	else if (glBufferID)
@@ -166,6 +186,7 @@ unsigned int FHardwareTexture::CreateTexture(unsigned char * buffer, int w, int
 		glGenerateMipmap(GL_TEXTURE_2D);
 		mipmapped = true;
 	}
+	UpdateMemoryUsage();
 
 	if (texunit > 0) glActiveTexture(GL_TEXTURE0);
 	else if (texunit == -1) glBindTexture(GL_TEXTURE_2D, textureBinding);
@@ -194,6 +215,20 @@ void FHardwareTexture::AllocateBuffer(int w, int h, int texelsize)
 	}
 }
 
+//===========================================================================
+// 
+// The actual size depends on the driver, so this is only an estimate
+// that ignores texture compression.
+//
+//===========================================================================
+
+void FHardwareTexture::UpdateMemoryUsage()
+{
+	size_t bytes = mipmapped ? mImageBytes * 4 / 3 : mImageBytes;
+	MemStat_Add(MEM_HWTextures, int64_t(bytes) - int64_t(mMemoryUsage));
+	mMemoryUsage = bytes;
+}
+
 
 uint8_t *FHardwareTexture::MapBuffer()
 {
@@ -210,6 +245,7 @@ FHardwareTexture::~FHardwareTexture()
 { 
 	if (glTexID != 0) glDeleteTextures(1, &glTexID);
 	if (glBufferID != 0) glDeleteBuffers(1, &glBufferID);
+	MemStat_Add(MEM_HWTextures, -int64_t(mMemoryUsage));
 }
 
 
@@ -231,6 +267,7 @@ unsigned int FHardwareTexture::Bind(int texunit, bool needmipmap)
 		{
 			glGenerateMipmap(GL_TEXTURE_2D);
 			mipmapped = true;
+			UpdateMemoryUsage();
 		}
 		if (texunit != 0) glActiveTexture(GL_TEXTURE0);
 		return glTexID;
@@ -314,6 +351,7 @@ bool FHardwareTexture::BindOrCreate(FTexture *tex, int texunit, int clampmode, i
 			forcenofilter = true;
 		}
 		int w = 0, h = 0;
+		TRACE_ZONE("TextureLoad");
 
 		// Create this texture
 		
@@ -45,8 +45,11 @@ private:
 	unsigned int glBufferID = 0;
 	int glTextureBytes;
 	bool mipmapped = false;
+	size_t mImageBytes = 0;		// size of the base level
+	size_t mMemoryUsage = 0;
 
 	int GetDepthBuffer(int w, int h);
+	void UpdateMemoryUsage();
 
 public:
 	FHardwareTexture(int numchannels = 4, bool disablefilter = false)
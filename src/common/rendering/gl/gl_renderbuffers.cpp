@@ -62,6 +62,7 @@ FGLRenderBuffers::~FGLRenderBuffers()
 	ClearPipeline();
 	ClearEyeBuffers();
 	ClearShadowMap();
+	ClearDepthReadback();
 	DeleteTexture(mDitherTexture);
 }
 
@@ -524,6 +525,114 @@ void FGLRenderBuffers::BlitSceneToTexture()
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
+//==========================================================================
+//
+// Copies a downscaled version of the scene depth buffer into a pixel pack
+// buffer so that it can be read back once the GPU got to it without ever
+// stalling the pipeline. Multisampled depth buffers cannot be scaled so
+// these are not supported.
+//
+//==========================================================================
+
+bool FGLRenderBuffers::StartSceneDepthReadback(const IntRect &bounds, int width, int height)
+{
+	if (mSamples > 1 || mDepthReadbackSync != 0 || width <= 0 || height <= 0)
+		return false;
+
+	GLint readFramebuffer, drawFramebuffer;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+
+	if (width != mDepthReadbackWidth || height != mDepthReadbackHeight)
+	{
+		ClearDepthReadback();
+		mDepthReadbackColorBuf = CreateRenderBuffer("DepthReadbackColor", GL_R8, width, height);
+		mDepthReadbackDepthBuf = CreateRenderBuffer("DepthReadbackDepth", GL_DEPTH24_STENCIL8, width, height);
+		mDepthReadbackFB = CreateFrameBuffer("DepthReadbackFB", mDepthReadbackColorBuf, mDepthReadbackDepthBuf);
+
+		glGenBuffers(1, &mDepthReadbackPBO);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, mDepthReadbackPBO);
+		glBufferData(GL_PIXEL_PACK_BUFFER, width * height * sizeof(float), nullptr, GL_STREAM_READ);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		mDepthReadbackWidth = width;
+		mDepthReadbackHeight = height;
+	}
+
+	GLboolean scissorEnabled;
+	glGetBooleanv(GL_SCISSOR_TEST, &scissorEnabled);
+	glDisable(GL_SCISSOR_TEST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, mSceneFB.handle);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mDepthReadbackFB.handle);
+	glBlitFramebuffer(bounds.left, bounds.top, bounds.left + bounds.width, bounds.top + bounds.height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, mDepthReadbackFB.handle);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, mDepthReadbackPBO);
+	glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	mDepthReadbackSync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+	if (scissorEnabled)
+		glEnable(GL_SCISSOR_TEST);
+	return true;
+}
+
+//==========================================================================
+//
+// Returns the depth copy if the GPU is done with it. Otherwise it stays
+// pending and no new copy can be started.
+//
+//==========================================================================
+
+bool FGLRenderBuffers::FinishSceneDepthReadback(TArray<float> &depth)
+{
+	if (mDepthReadbackSync == 0)
+		return false;
+
+	GLenum status = glClientWaitSync(mDepthReadbackSync, 0, 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+
+	glDeleteSync(mDepthReadbackSync);
+	mDepthReadbackSync = 0;
+	if (status == GL_WAIT_FAILED)
+		return false;
+
+	unsigned size = mDepthReadbackWidth * mDepthReadbackHeight;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, mDepthReadbackPBO);
+	void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size * sizeof(float), GL_MAP_READ_BIT);
+	if (data)
+	{
+		depth.Resize(size);
+		memcpy(depth.Data(), data, size * sizeof(float));
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return data != nullptr;
+}
+
+void FGLRenderBuffers::ClearDepthReadback()
+{
+	if (mDepthReadbackSync != 0)
+	{
+		glDeleteSync(mDepthReadbackSync);
+		mDepthReadbackSync = 0;
+	}
+	if (mDepthReadbackPBO != 0)
+	{
+		glDeleteBuffers(1, &mDepthReadbackPBO);
+		mDepthReadbackPBO = 0;
+	}
+	DeleteFrameBuffer(mDepthReadbackFB);
+	DeleteRenderBuffer(mDepthReadbackColorBuf);
+	DeleteRenderBuffer(mDepthReadbackDepthBuf);
+	mDepthReadbackWidth = 0;
+	mDepthReadbackHeight = 0;
+}
+
 //==========================================================================
 //
 // Eye textures and their frame buffers
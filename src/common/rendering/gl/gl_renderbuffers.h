@@ -114,6 +114,9 @@ public:
 	void BindSceneDepthTexture(int index);
 	void BlitSceneToTexture();
 
+	bool StartSceneDepthReadback(const IntRect &bounds, int width, int height);
+	bool FinishSceneDepthReadback(TArray<float> &depth);
+
 	void BindCurrentTexture(int index, int filter = GL_NEAREST, int wrap = GL_CLAMP_TO_EDGE);
 	void BindCurrentFB();
 	void BindNextFB();
@@ -145,6 +148,7 @@ private:
 	void ClearPipeline();
 	void ClearEyeBuffers();
 	void ClearShadowMap();
+	void ClearDepthReadback();
 	void CreateScene(int width, int height, int samples, bool needsSceneTextures);
 	void CreatePipeline(int width, int height);
 	void CreateEyeBuffers(int eye);
@@ -201,6 +205,15 @@ private:
 	PPGLFrameBuffer mShadowMapFB;
 	int mCurrentShadowMapSize = 0;
 
+	// Downscaled scene depth copy
+	PPGLRenderBuffer mDepthReadbackColorBuf;
+	PPGLRenderBuffer mDepthReadbackDepthBuf;
+	PPGLFrameBuffer mDepthReadbackFB;
+	GLuint mDepthReadbackPBO = 0;
+	GLsync mDepthReadbackSync = 0;
+	int mDepthReadbackWidth = 0;
+	int mDepthReadbackHeight = 0;
+
 	PPGLTexture mDitherTexture;
 
 	static bool FailedCreate;
@@ -46,6 +46,8 @@ FGLRenderState gl_RenderState;
 
 static VSMatrix identityMatrix(1);
 
+CVARD(Bool, gl_drawbatching, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "combine consecutive draws with identical state into one multi-draw call")
+
 static void matrixToGL(const VSMatrix &mat, int loc)
 {
 	glUniformMatrix4fv(loc, 1, false, (float*)&mat);
@@ -184,15 +186,27 @@ bool FGLRenderState::ApplyShader()
 
 	if (mModelMatrixEnabled)
 	{
-		matrixToGL(mModelMatrix, activeShader->modelmatrix_index);
-		VSMatrix norm;
-		norm.computeNormalMatrix(mModelMatrix);
-		matrixToGL(norm, activeShader->normalmodelmatrix_index);
+		// Models issue one draw per surface with the same matrix, so only upload it if it actually changed,
+		// and only invert it again if it differs from the last one that got inverted.
+		if (!activeShader->currentModelMatrixValid || memcmp(activeShader->currentModelMatrix.get(), mModelMatrix.get(), 16 * sizeof(FLOATTYPE)))
+		{
+			if (!mNormalMatrixValid || memcmp(mNormalMatrixSource.get(), mModelMatrix.get(), 16 * sizeof(FLOATTYPE)))
+			{
+				mNormalMatrixSource = mModelMatrix;
+				mNormalModelMatrix.computeNormalMatrix(mModelMatrix);
+				mNormalMatrixValid = true;
+			}
+			matrixToGL(mModelMatrix, activeShader->modelmatrix_index);
+			matrixToGL(mNormalModelMatrix, activeShader->normalmodelmatrix_index);
+			activeShader->currentModelMatrix = mModelMatrix;
+			activeShader->currentModelMatrixValid = true;
+		}
 		activeShader->currentModelMatrixState = true;
 	}
 	else if (activeShader->currentModelMatrixState)
 	{
 		activeShader->currentModelMatrixState = false;
+		activeShader->currentModelMatrixValid = false;
 		matrixToGL(identityMatrix, activeShader->modelmatrix_index);
 		matrixToGL(identityMatrix, activeShader->normalmodelmatrix_index);
 	}
@@ -285,6 +299,7 @@ void FGLRenderState::ApplyBuffers()
 
 void FGLRenderState::Apply()
 {
+	FlushDraws();
 	ApplyState();
 	ApplyBuffers();
 	ApplyShader();
@@ -298,6 +313,7 @@ void FGLRenderState::Apply()
 
 void FGLRenderState::ApplyMaterial(FMaterial *mat, int clampmode, int translation, int overrideshader)
 {
+	FlushDraws();
 	if (mat->Source()->isHardwareCanvas())
 	{
 		mTempTM = TM_OPAQUE;
@@ -315,19 +331,21 @@ void FGLRenderState::ApplyMaterial(FMaterial *mat, int clampmode, int translatio
 	clampmode = tex->GetClampMode(clampmode);
 	
 	// avoid rebinding the same texture multiple times.
-	if (mat == lastMaterial && lastClamp == clampmode && translation == lastTranslation) return;
+	bool shadertranslation = mat->GetTranslationFlags(translation, clampmode) != 0;
+	int translationkey = shadertranslation ? translation | 0x40000000 : translation;
+	if (mat == lastMaterial && lastClamp == clampmode && translationkey == lastTranslation) return;
 	lastMaterial = mat;
 	lastClamp = clampmode;
-	lastTranslation = translation;
+	lastTranslation = translationkey;
 
 	int usebright = false;
 	int maxbound = 0;
 
 	int numLayers = mat->NumLayers();
 	MaterialLayerInfo* layer;
-	auto base = static_cast<FHardwareTexture*>(mat->GetLayer(0, translation, &layer));
+	auto base = static_cast<FHardwareTexture*>(mat->GetLayer(0, shadertranslation ? FMaterial::TRANSLATION_INDEXED : translation, &layer));
 
-	if (base->BindOrCreate(tex->GetTexture(), 0, clampmode, translation, layer->scaleFlags))
+	if (base->BindOrCreate(tex->GetTexture(), 0, shadertranslation ? FMaterial::NoFilterClampMode(clampmode) : clampmode, translation, shadertranslation ? layer->scaleFlags | CTF_Indexed : layer->scaleFlags))
 	{
 		for (int i = 1; i<numLayers; i++)
 		{
@@ -336,6 +354,13 @@ void FGLRenderState::ApplyMaterial(FMaterial *mat, int clampmode, int translatio
 			systex->BindOrCreate(layer->layerTexture, i, clampmode, 0, layer->scaleFlags);
 			maxbound = i;
 		}
+		if (shadertranslation)
+		{
+			auto lut = FMaterial::GetTranslationLUT();
+			auto systex = static_cast<FHardwareTexture*>(lut->GetHardwareTexture(translation, 0));
+			systex->BindOrCreate(lut, FMaterial::TRANSLATION_LUT_LAYER, CLAMP_NOFILTER_XY, translation, 0);
+			maxbound = FMaterial::TRANSLATION_LUT_LAYER;
+		}
 	}
 	// unbind everything from the last texture that's still active
 	for (int i = maxbound + 1; i <= maxBoundMaterial; i++)
@@ -391,8 +416,95 @@ void FGLRenderState::ApplyBlendMode()
 
 static int dt2gl[] = { GL_POINTS, GL_LINES, GL_TRIANGLES, GL_TRIANGLE_FAN, GL_TRIANGLE_STRIP };
 
+//==========================================================================
+//
+// Draw call batching
+//
+// While enabled, draws whose complete render state matches the previous
+// one are not submitted immediately but collected and later sent in one
+// glMultiDrawArrays/glMultiDrawElements call. Anything that changes GL
+// state outside the buffered render state has to flush the pending batch.
+//
+//==========================================================================
+
+void FGLRenderState::EnableDrawBatching(bool on)
+{
+	FlushDraws();
+	mBatching = on && gl_drawbatching;
+}
+
+bool FGLRenderState::GetBatchKey(FDrawBatchKey &key)
+{
+	// Matrices and depth bias are uploaded outside the compared state, and the legacy light buffer rebinds ranges per draw.
+	if (mTextureMatrixEnabled || mModelMatrixEnabled || mBias.mChanged) return false;
+	if (mLightIndex >= 0 && !screen->mLights->GetBufferType()) return false;
+
+	memset(&key, 0, sizeof(key));	// the key gets compared with memcmp so the padding must be cleared.
+	key.streamData = mStreamData;
+	memcpy(key.lightParms, mLightParms, sizeof(key.lightParms));
+	memcpy(key.clipSplit, mClipSplit, sizeof(key.clipSplit));
+	key.alphaThreshold = mAlphaThreshold;
+	key.material = mMaterial.mMaterial;
+	key.clampMode = mMaterial.mClampMode;
+	key.translation = mMaterial.mTranslation;
+	key.overrideShader = mMaterial.mOverrideShader;
+	key.lightIndex = mLightIndex;
+	key.specialEffect = mSpecialEffect;
+	key.textureMode = mTextureMode;
+	key.textureModeFlags = mTextureModeFlags;
+	key.renderStyle = mRenderStyle.AsDWORD;
+	key.vertexBuffer = mVertexBuffer;
+	key.vertexOffsets[0] = mVertexOffsets[0];
+	key.vertexOffsets[1] = mVertexOffsets[1];
+	key.indexBuffer = mIndexBuffer;
+	key.passType = mPassType;
+	key.flags = mTextureEnabled | (mGlowEnabled << 1) | (mGradientEnabled << 2) | (mSplitEnabled << 3) | (mBrightmapEnabled << 4);
+	key.fogEnabled = mFogEnabled;
+	return true;
+}
+
+bool FGLRenderState::AddToBatch(int dt, int index, int count, bool indexed)
+{
+	FDrawBatchKey key;
+	if (!GetBatchKey(key)) return false;
+
+	if (mBatchCount.Size() == 0 || dt != mBatchDrawType || indexed != mBatchIndexed || memcmp(&key, &mBatchKey, sizeof(key)))
+	{
+		FlushDraws();
+		Apply();
+		mBatchKey = key;
+		mBatchDrawType = dt;
+		mBatchIndexed = indexed;
+	}
+	if (indexed) mBatchIndices.Push((const void*)(intptr_t)(index * sizeof(uint32_t)));
+	else mBatchFirst.Push(index);
+	mBatchCount.Push(count);
+	return true;
+}
+
+void FGLRenderState::FlushBatch()
+{
+	drawcalls.Clock();
+	if (mBatchIndexed)
+	{
+		if (mBatchCount.Size() == 1) glDrawElements(dt2gl[mBatchDrawType], mBatchCount[0], GL_UNSIGNED_INT, mBatchIndices[0]);
+		else glMultiDrawElements(dt2gl[mBatchDrawType], mBatchCount.Data(), GL_UNSIGNED_INT, mBatchIndices.Data(), mBatchCount.Size());
+	}
+	else
+	{
+		if (mBatchCount.Size() == 1) glDrawArrays(dt2gl[mBatchDrawType], mBatchFirst[0], mBatchCount[0]);
+		else glMultiDrawArrays(dt2gl[mBatchDrawType], mBatchFirst.Data(), mBatchCount.Data(), mBatchCount.Size());
+	}
+	drawcalls.Unclock();
+	mBatchFirst.Clear();
+	mBatchCount.Clear();
+	mBatchIndices.Clear();
+}
+
 void FGLRenderState::Draw(int dt, int index, int count, bool apply)
 {
+	if (mBatching && apply && AddToBatch(dt, index, count, false)) return;
+	FlushDraws();
 	if (apply)
 	{
 		Apply();
@@ -404,6 +516,8 @@ void FGLRenderState::Draw(int dt, int index, int count, bool apply)
 
 void FGLRenderState::DrawIndexed(int dt, int index, int count, bool apply)
 {
+	if (mBatching && apply && AddToBatch(dt, index, count, true)) return;
+	FlushDraws();
 	if (apply)
 	{
 		Apply();
@@ -415,27 +529,32 @@ void FGLRenderState::DrawIndexed(int dt, int index, int count, bool apply)
 
 void FGLRenderState::SetDepthMask(bool on)
 {
+	FlushDraws();
 	glDepthMask(on);
 }
 
 void FGLRenderState::SetDepthFunc(int func)
 {
+	FlushDraws();
 	static int df2gl[] = { GL_LESS, GL_LEQUAL, GL_ALWAYS };
 	glDepthFunc(df2gl[func]);
 }
 
 void FGLRenderState::SetDepthRange(float min, float max)
 {
+	FlushDraws();
 	glDepthRange(min, max);
 }
 
 void FGLRenderState::SetColorMask(bool r, bool g, bool b, bool a)
 {
+	FlushDraws();
 	glColorMask(r, g, b, a);
 }
 
 void FGLRenderState::SetStencil(int offs, int op, int flags = -1)
 {
+	FlushDraws();
 	static int op2gl[] = { GL_KEEP, GL_INCR, GL_DECR };
 
 	glStencilFunc(GL_EQUAL, screen->stencilValue + offs, ~0);		// draw sky into stencil
@@ -451,6 +570,7 @@ void FGLRenderState::SetStencil(int offs, int op, int flags = -1)
 
 void FGLRenderState::ToggleState(int state, bool on)
 {
+	FlushDraws();
 	if (on)
 	{
 		glEnable(state);
@@ -463,6 +583,7 @@ void FGLRenderState::ToggleState(int state, bool on)
 
 void FGLRenderState::SetCulling(int mode)
 {
+	FlushDraws();
 	if (mode != Cull_None)
 	{
 		glEnable(GL_CULL_FACE);
@@ -485,6 +606,7 @@ void FGLRenderState::EnableClipDistance(int num, bool state)
 
 void FGLRenderState::Clear(int targets)
 {
+	FlushDraws();
 	// This always clears to default values.
 	int gltarget = 0;
 	if (targets & CT_Depth)
@@ -512,6 +634,7 @@ void FGLRenderState::EnableStencil(bool on)
 
 void FGLRenderState::SetScissor(int x, int y, int w, int h)
 {
+	FlushDraws();
 	if (w > -1)
 	{
 		glEnable(GL_SCISSOR_TEST);
@@ -525,6 +648,7 @@ void FGLRenderState::SetScissor(int x, int y, int w, int h)
 
 void FGLRenderState::SetViewport(int x, int y, int w, int h)
 {
+	FlushDraws();
 	glViewport(x, y, w, h);
 }
 
@@ -550,6 +674,7 @@ void FGLRenderState::EnableLineSmooth(bool on)
 //==========================================================================
 void FGLRenderState::ClearScreen()
 {
+	FlushDraws();
 	bool multi = !!glIsEnabled(GL_MULTISAMPLE);
 
 	screen->mViewpoints->Set2D(*this, SCREENWIDTH, SCREENHEIGHT);
@@ -576,6 +701,7 @@ void FGLRenderState::ClearScreen()
 
 bool FGLRenderState::SetDepthClamp(bool on)
 {
+	FlushDraws();
 	bool res = mLastDepthClamp;
 	if (!on) glDisable(GL_DEPTH_CLAMP);
 	else glEnable(GL_DEPTH_CLAMP);
@@ -71,6 +71,43 @@ class FGLRenderState final : public FRenderState
 	int mCurrentVertexOffsets[2];	// one per binding point
 	IIndexBuffer *mCurrentIndexBuffer;
 
+	// Draw batching: consecutive draws with identical state get collected and submitted with one glMultiDraw* call.
+	struct FDrawBatchKey
+	{
+		StreamData streamData;
+		float lightParms[4];
+		float clipSplit[2];
+		float alphaThreshold;
+		FMaterial *material;
+		int clampMode, translation, overrideShader;
+		int lightIndex, specialEffect, textureMode, textureModeFlags;
+		uint32_t renderStyle;
+		IVertexBuffer *vertexBuffer;
+		int vertexOffsets[2];
+		IIndexBuffer *indexBuffer;
+		int passType;
+		uint8_t flags, fogEnabled;
+	};
+
+	VSMatrix mNormalMatrixSource, mNormalModelMatrix;
+	bool mNormalMatrixValid = false;
+
+	bool mBatching = false;
+	int mBatchDrawType;
+	bool mBatchIndexed;
+	FDrawBatchKey mBatchKey;
+	TArray<GLint> mBatchFirst;
+	TArray<GLsizei> mBatchCount;
+	TArray<const void *> mBatchIndices;
+
+	bool GetBatchKey(FDrawBatchKey &key);
+	bool AddToBatch(int dt, int index, int count, bool indexed);
+	void FlushBatch();
+	void FlushDraws()
+	{
+		if (mBatchCount.Size() > 0) FlushBatch();
+	}
+
 
 public:
 
@@ -86,6 +123,11 @@ public:
 		lastMaterial = nullptr;
 	}
 
+	void ResetLightBinding()
+	{
+		mLastMappedLightIndex = SIZE_MAX;
+	}
+
 	void ApplyMaterial(FMaterial *mat, int clampmode, int translation, int overrideshader);
 
 	void Apply();
@@ -110,6 +152,7 @@ public:
 		count = std::min(count, 3);
 		if (mNumDrawBuffers != count)
 		{
+			FlushDraws();
 			static GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
 			glDrawBuffers(count, buffers);
 			mNumDrawBuffers = count;
@@ -138,6 +181,7 @@ public:
 	void EnableDepthTest(bool on) override;
 	void EnableMultisampling(bool on) override;
 	void EnableLineSmooth(bool on) override;
+	void EnableDrawBatching(bool on) override;
 
 
 };
@@ -41,6 +41,7 @@
 #include "i_specialpaths.h"
 #include "printf.h"
 #include "version.h"
+#include "zonetrace.h"
 
 #include "gl_interface.h"
 #include "gl_debug.h"
@@ -62,18 +63,30 @@ static const char *ShaderMagic = "ZDSC";
 
 static std::map<FString, std::unique_ptr<ProgramBinary>> ShaderCache; // Not a TMap because it doesn't support unique_ptr move semantics
 
+//==========================================================================
+//
+// 0: never cache program binaries
+// 1: only cache them where the driver does not do it on its own (Intel)
+// 2: always cache them
+//
+//==========================================================================
+
+CVAR(Int, gl_shadercache, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static bool ShaderCacheDirty;
+
 bool IsShaderCacheActive()
 {
-	static bool active = true;
+	static bool isintel = false;
 	static bool firstcall = true;
 
 	if (firstcall)
 	{
 		const char *vendor = (const char *)glGetString(GL_VENDOR);
-		active = !(strstr(vendor, "Intel") == nullptr);
+		isintel = !(strstr(vendor, "Intel") == nullptr);
 		firstcall = false;
 	}
-	return active;
+	return gl_shadercache >= 2 || (gl_shadercache == 1 && isintel);
 }
 
 static FString CalcProgramBinaryChecksum(const FString &vertex, const FString &fragment)
@@ -204,14 +217,44 @@ void SaveCachedProgramBinary(const FString &vertex, const FString &fragment, con
 	entry->format = binaryFormat;
 	entry->data = binary;
 
-	SaveShaders();
+	// Writing out the entire cache for each new program would make a cold start quadratic in the number of shaders.
+	ShaderCacheDirty = true;
 }
 
+void FlushProgramBinaryCache()
+{
+	if (ShaderCacheDirty)
+	{
+		SaveShaders();
+		ShaderCacheDirty = false;
+	}
+}
+
+//==========================================================================
+//
+// Compiles the shader and waits for the result.
+//
+//==========================================================================
+
 bool FShader::Load(const char * name, const char * vert_prog_lump, const char * frag_prog_lump, const char * proc_prog_lump, const char * light_fragprog, const char * defines)
 {
-	static char buffer[10000];
-	FString error;
+	if (!BeginLoad(name, vert_prog_lump, frag_prog_lump, proc_prog_lump, light_fragprog, defines))
+		return false;
+	return FinishLoad();
+}
+
+//==========================================================================
+//
+// Sets up the source and submits compilation and linking to the driver
+// without querying any results, so that drivers which compile in the
+// background can work on many programs at once. FinishLoad must be called
+// before the shader can be used.
+//
+//==========================================================================
 
+bool FShader::BeginLoad(const char * name, const char * vert_prog_lump, const char * frag_prog_lump, const char * proc_prog_lump, const char * light_fragprog, const char * defines)
+{
+	TRACE_ZONE_ARG("ShaderCompile", name);
 	FString i_data = R"(
 		// these settings are actually pointless but there seem to be some old ATI drivers that fail to compile the shader without setting the precision here.
 		precision highp int;
@@ -525,8 +568,41 @@ bool FShader::Load(const char * name, const char * vert_prog_lump, const char *
 		glAttachShader(hShader, hVertProg);
 		glAttachShader(hShader, hFragProg);
 
+		if (glProgramParameteri && IsShaderCacheActive())
+			glProgramParameteri(hShader, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 		glLinkProgram(hShader);
 
+		// the sources are needed once more to store the binary in the cache.
+		mVertexSource = vp_comb;
+		mFragmentSource = fp_comb;
+		mLinkPending = true;
+	}
+	else
+	{
+		hVertProg = 0;
+		hFragProg = 0;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// Waits for the link result and sets up the uniforms.
+//
+//==========================================================================
+
+bool FShader::FinishLoad()
+{
+	TRACE_ZONE("ShaderLink");
+	static char buffer[10000];
+	FString error;
+	bool linked = true;
+
+	if (mLinkPending)
+	{
+		mLinkPending = false;
+
 		glGetShaderInfoLog(hVertProg, 10000, NULL, buffer);
 		if (*buffer)
 		{
@@ -549,22 +625,21 @@ bool FShader::Load(const char * name, const char * vert_prog_lump, const char *
 		if (!linked)
 		{
 			// only print message if there's an error.
-			I_Error("Init Shader '%s':\n%s\n", name, error.GetChars());
+			I_Error("Init Shader '%s':\n%s\n", mName.GetChars(), error.GetChars());
 		}
 		else if (glProgramBinary && IsShaderCacheActive())
 		{
+			uint32_t binaryFormat = 0;
+			TArray<uint8_t> binary;
 			int binaryLength = 0;
 			glGetProgramiv(hShader, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
 			binary.Resize(binaryLength);
 			glGetProgramBinary(hShader, binary.Size(), &binaryLength, &binaryFormat, binary.Data());
 			binary.Resize(binaryLength);
-			SaveCachedProgramBinary(vp_comb, fp_comb, binary, binaryFormat);
+			SaveCachedProgramBinary(mVertexSource, mFragmentSource, binary, binaryFormat);
 		}
-	}
-	else
-	{
-		hVertProg = 0;
-		hFragProg = 0;
+		mVertexSource = "";
+		mFragmentSource = "";
 	}
 
 	muDesaturation.Init(hShader, "uDesaturationFactor");
@@ -603,7 +678,7 @@ bool FShader::Load(const char * name, const char * vert_prog_lump, const char *
 	texturematrix_index = glGetUniformLocation(hShader, "TextureMatrix");
 	normalmodelmatrix_index = glGetUniformLocation(hShader, "NormalModelMatrix");
 
-	if (!lightbuffertype)
+	if (!screen->mLights->GetBufferType())
 	{
 		int tempindex = glGetUniformBlockIndex(hShader, "LightBufferUBO");
 		if (tempindex != -1) glUniformBlockBinding(hShader, tempindex, LIGHTBUF_BINDINGPOINT);
@@ -663,7 +738,7 @@ bool FShader::Bind()
 //
 //==========================================================================
 
-FShader *FShaderCollection::Compile (const char *ShaderName, const char *ShaderPath, const char *LightModePath, const char *shaderdefines, bool usediscard, EPassType passType)
+FShader *FShaderCollection::Compile (const char *ShaderName, const char *ShaderPath, const char *LightModePath, const char *shaderdefines, bool usediscard, EPassType passType, bool deferred)
 {
 	FString defines;
 	defines += shaderdefines;
@@ -675,7 +750,7 @@ FShader *FShaderCollection::Compile (const char *ShaderName, const char *ShaderP
 	try
 	{
 		shader = new FShader(ShaderName);
-		if (!shader->Load(ShaderName, "shaders/glsl/main.vp", "shaders/glsl/main.fp", ShaderPath, LightModePath, defines.GetChars()))
+		if (!shader->BeginLoad(ShaderName, "shaders/glsl/main.vp", "shaders/glsl/main.fp", ShaderPath, LightModePath, defines.GetChars()))
 		{
 			I_FatalError("Unable to load shader %s\n", ShaderName);
 		}
@@ -686,6 +761,7 @@ FShader *FShaderCollection::Compile (const char *ShaderName, const char *ShaderP
 		shader = NULL;
 		I_FatalError("Unable to load shader %s:\n%s\n", ShaderName, err.GetMessage());
 	}
+	if (!deferred) FinishCompile(shader);
 	return shader;
 }
 
@@ -695,10 +771,32 @@ FShader *FShaderCollection::Compile (const char *ShaderName, const char *ShaderP
 //
 //==========================================================================
 
+void FShaderCollection::FinishCompile(FShader *shader)
+{
+	try
+	{
+		if (!shader->FinishLoad())
+		{
+			I_FatalError("Unable to load shader %s\n", shader->mName.GetChars());
+		}
+	}
+	catch (CRecoverableError &err)
+	{
+		I_FatalError("Unable to load shader %s:\n%s\n", shader->mName.GetChars(), err.GetMessage());
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 FShaderManager::FShaderManager()
 {
 	for (int passType = 0; passType < MAX_PASS_TYPES; passType++)
 		mPassShaders.Push(new FShaderCollection((EPassType)passType));
+	FlushProgramBinaryCache();
 }
 
 FShaderManager::~FShaderManager()
@@ -772,13 +870,14 @@ void FShaderCollection::CompileShaders(EPassType passType)
 		mEffectShaders[i] = NULL;
 	}
 
+	// All programs get submitted first and are only checked afterward so that the driver can compile them in parallel.
 	for(int i=0;defaultshaders[i].ShaderName != NULL;i++)
 	{
-		FShader *shc = Compile(defaultshaders[i].ShaderName, defaultshaders[i].gettexelfunc, defaultshaders[i].lightfunc, defaultshaders[i].Defines, true, passType);
+		FShader *shc = Compile(defaultshaders[i].ShaderName, defaultshaders[i].gettexelfunc, defaultshaders[i].lightfunc, defaultshaders[i].Defines, true, passType, true);
 		mMaterialShaders.Push(shc);
 		if (i < SHADER_NoTexture)
 		{
-			FShader *shc = Compile(defaultshaders[i].ShaderName, defaultshaders[i].gettexelfunc, defaultshaders[i].lightfunc, defaultshaders[i].Defines, false, passType);
+			FShader *shc = Compile(defaultshaders[i].ShaderName, defaultshaders[i].gettexelfunc, defaultshaders[i].lightfunc, defaultshaders[i].Defines, false, passType, true);
 			mMaterialShadersNAT.Push(shc);
 		}
 	}
@@ -787,20 +886,31 @@ void FShaderCollection::CompileShaders(EPassType passType)
 	{
 		FString name = ExtractFileBase(usershaders[i].shader);
 		FString defines = defaultshaders[usershaders[i].shaderType].Defines + usershaders[i].defines;
-		FShader *shc = Compile(name, usershaders[i].shader, defaultshaders[usershaders[i].shaderType].lightfunc, defines, true, passType);
+		FShader *shc = Compile(name, usershaders[i].shader, defaultshaders[usershaders[i].shaderType].lightfunc, defines, true, passType, true);
 		mMaterialShaders.Push(shc);
 	}
 
 	for(int i=0;i<MAX_EFFECTS;i++)
 	{
 		FShader *eff = new FShader(effectshaders[i].ShaderName);
-		if (!eff->Load(effectshaders[i].ShaderName, effectshaders[i].vp, effectshaders[i].fp1,
+		if (!eff->BeginLoad(effectshaders[i].ShaderName, effectshaders[i].vp, effectshaders[i].fp1,
 						effectshaders[i].fp2, effectshaders[i].fp3, effectshaders[i].defines))
 		{
 			delete eff;
 		}
 		else mEffectShaders[i] = eff;
 	}
+
+	for (auto shc : mMaterialShaders) FinishCompile(shc);
+	for (auto shc : mMaterialShadersNAT) FinishCompile(shc);
+	for (int i = 0; i < MAX_EFFECTS; i++)
+	{
+		if (mEffectShaders[i] != NULL && !mEffectShaders[i]->FinishLoad())
+		{
+			delete mEffectShaders[i];
+			mEffectShaders[i] = NULL;
+		}
+	}
 }
 
 //==========================================================================
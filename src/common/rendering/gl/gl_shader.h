@@ -235,6 +235,11 @@ class FShader
 	unsigned int hFragProg;
 	FName mName;
 
+	// only valid while the link is pending
+	FString mVertexSource;
+	FString mFragmentSource;
+	bool mLinkPending = false;
+
 	FBufferedUniform1f muDesaturation;
 	FBufferedUniform1i muFogEnabled;
 	FBufferedUniform1i muTextureMode;
@@ -278,6 +283,8 @@ class FShader
 	int currentfixedcolormap = 0;
 	bool currentTextureMatrixState = true;// by setting the matrix state to 'true' it is guaranteed to be set the first time the render state gets applied.
 	bool currentModelMatrixState = true;
+	bool currentModelMatrixValid = false;	// true if currentModelMatrix is what the shader's uniform holds.
+	VSMatrix currentModelMatrix;
 
 public:
 	FShader(const char *name)
@@ -289,6 +296,8 @@ public:
 	~FShader();
 
 	bool Load(const char * name, const char * vert_prog_lump, const char * fragprog, const char * fragprog2, const char * light_fragprog, const char *defines);
+	bool BeginLoad(const char * name, const char * vert_prog_lump, const char * fragprog, const char * fragprog2, const char * light_fragprog, const char *defines);
+	bool FinishLoad();
 
 	bool Bind();
 	unsigned int GetHandle() const { return hShader; }
@@ -329,7 +338,8 @@ class FShaderCollection
 public:
 	FShaderCollection(EPassType passType);
 	~FShaderCollection();
-	FShader *Compile(const char *ShaderName, const char *ShaderPath, const char *LightModePath, const char *shaderdefines, bool usediscard, EPassType passType);
+	FShader *Compile(const char *ShaderName, const char *ShaderPath, const char *LightModePath, const char *shaderdefines, bool usediscard, EPassType passType, bool deferred = false);
+	void FinishCompile(FShader *shader);
 	int Find(const char *mame);
 	FShader *BindEffect(int effect);
 
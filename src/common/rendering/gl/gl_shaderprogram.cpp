@@ -158,6 +158,9 @@ void FShaderProgram::Link(const char *name)
 		CompileShader(Vertex);
 		CompileShader(Fragment);
 
+		if (glProgramParameteri && IsShaderCacheActive())
+			glProgramParameteri(mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 		glLinkProgram(mProgram);
 
 		GLint status = 0;
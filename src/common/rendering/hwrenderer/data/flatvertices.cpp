@@ -45,8 +45,9 @@
 //
 //==========================================================================
 
-FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
+FFlatVertexBuffer::FFlatVertexBuffer(int width, int height, int numframes)
 {
+	mNumFrames = numframes;
 	vbo_shadowdata.Resize(NUM_RESERVED);
 
 	// the first quad is reserved for handling coordinates through uniforms.
@@ -90,8 +91,9 @@ FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
 	};
 	mVertexBuffer->SetFormat(1, 2, sizeof(FFlatVertex), format);
 
-	mIndex = mCurIndex = NUM_RESERVED;
+	mIndex = NUM_RESERVED;
 	mNumReserved = NUM_RESERVED;
+	Reset();
 	Copy(0, NUM_RESERVED);
 }
 
@@ -135,10 +137,10 @@ std::pair<FFlatVertex *, unsigned int> FFlatVertexBuffer::AllocVertices(unsigned
 	FFlatVertex *p = GetBuffer();
 	auto index = mCurIndex.fetch_add(count);
 	auto offset = index;
-	if (index + count >= BUFFER_SIZE_TO_USE)
+	if (index + count >= mFrameEnd)
 	{
 		// If a single scene needs 2'000'000 vertices there must be something very wrong. 
-		I_FatalError("Out of vertex memory. Tried to allocate more than %u vertices for a single frame", index + count);
+		I_FatalError("Out of vertex memory. Tried to allocate more than %u vertices for a single frame", index + count - mFrameStart);
 	}
 	return std::make_pair(p, index);
 }
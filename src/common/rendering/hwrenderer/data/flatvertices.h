@@ -52,6 +52,9 @@ public:
 	unsigned int mIndex;
 	std::atomic<unsigned int> mCurIndex;
 	unsigned int mNumReserved;
+	unsigned int mFrameCount = 0;	// incremented by each Reset, used to validate persistent allocations.
+	unsigned int mNumFrames;		// the per-frame vertices get split into this many parts so that the GPU can still read the previous frames' ones.
+	unsigned int mFrameStart, mFrameEnd;
 
 
 	static const unsigned int BUFFER_SIZE = 2000000;
@@ -69,7 +72,7 @@ public:
 		NUM_RESERVED = 20
 	};
 
-	FFlatVertexBuffer(int width, int height);
+	FFlatVertexBuffer(int width, int height, int numframes = 1);
 	~FFlatVertexBuffer();
 
 	void OutputResized(int width, int height);
@@ -95,7 +98,10 @@ public:
 
 	void Reset()
 	{
-		mCurIndex = mIndex;
+		unsigned int framesize = (BUFFER_SIZE_TO_USE - mIndex) / mNumFrames;
+		mFrameCount++;
+		mCurIndex = mFrameStart = mIndex + (mFrameCount % mNumFrames) * framesize;
+		mFrameEnd = mFrameStart + framesize;
 	}
 
 	void Map()
@@ -37,6 +37,12 @@ struct AABBTreeLine
 	float dx, dy;
 };
 
+// Area touched by a dynamic line that was moved
+struct AABBTreeChange
+{
+	float left, top, right, bottom;
+};
+
 class LevelAABBTree
 {
 protected:
@@ -49,6 +55,9 @@ protected:
 	int dynamicStartNode = 0;
 	int dynamicStartLine = 0;
 
+	// Old and new bounds of all dynamic lines that moved during the last Update call.
+	TArray<AABBTreeChange> changes;
+
 public:
 	// Shoot a ray from ray_start to ray_end and return the closest hit as a fractional value between 0 and 1. Returns 1 if no line was hit.
 	double RayTest(const DVector3 &ray_start, const DVector3 &ray_end);
@@ -67,6 +76,7 @@ public:
 	size_t DynamicLinesOffset() const { return dynamicStartLine * sizeof(AABBTreeLine); }
 
 	virtual bool Update() = 0;
+	const TArray<AABBTreeChange> &Changes() const { return changes; }
 
 	virtual ~LevelAABBTree() = default;
 
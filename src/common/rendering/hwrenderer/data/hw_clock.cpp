@@ -203,10 +203,11 @@ CCMD(bench)
 }
 
 bool glcycle_t::active = false;
+bool bench_forceclocks;	// set by unattended benchmark runs which need the timings for every frame.
 
 void  checkBenchActive()
 {
 	FStat *stat = FStat::FindStat("rendertimes");
-	glcycle_t::active = ((stat != NULL && stat->isActive()) || printstats);
+	glcycle_t::active = ((stat != NULL && stat->isActive()) || printstats || bench_forceclocks);
 }
 
@@ -24,6 +24,7 @@ extern int vertexcount, flatvertices, flatprimitives;
 void ResetProfilingData();
 void CheckBench();
 void  checkBenchActive();
+extern bool bench_forceclocks;
 
 
 #endif
@@ -42,6 +42,7 @@
 #include "hw_cvars.h"
 #include "menu.h"
 #include "printf.h"
+#include "texturemanager.h"
 
 
 CUSTOM_CVAR(Int, gl_fogmode, 1, CVAR_ARCHIVE | CVAR_NOINITCALL)
@@ -131,6 +132,12 @@ CUSTOM_CVARD(Int, gl_texture_filter, 4, CVAR_ARCHIVE|CVAR_GLOBALCONFIG|CVAR_NOIN
 	screen->SetTextureFilterMode();
 }
 
+CUSTOM_CVARD(Int, gl_texture_compression, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG|CVAR_NOINITCALL, "compresses large textures on upload to save video memory. 0: off, 1: driver default, 2: S3TC, 3: BPTC")
+{
+	if (self < 0 || self > 3) self = 0;
+	TexMan.FlushAll();
+}
+
 CVAR(Bool, gl_precache, false, CVAR_ARCHIVE)
 
 
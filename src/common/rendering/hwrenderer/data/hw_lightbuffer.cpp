@@ -32,6 +32,29 @@
 static const int ELEMENTS_PER_LIGHT = 4;			// each light needs 4 vec4's.
 static const int ELEMENT_SIZE = (4*sizeof(float));
 
+// Consecutive surfaces, like the parts of one wall or a flat's subsectors, often get the very same lights.
+// Each thread remembers its last upload so that these can share one copy in the buffer.
+struct FLastLightUpload
+{
+	const FLightBuffer *buffer = nullptr;
+	unsigned int generation = 0;
+	int index = -1;
+	FDynLightData data;
+};
+
+static thread_local FLastLightUpload LastUpload;
+static unsigned int LightBufferGeneration;
+
+static bool SameLightData(const FDynLightData &a, const FDynLightData &b)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (a.arrays[i].Size() != b.arrays[i].Size()) return false;
+		if (a.arrays[i].Size() > 0 && memcmp(a.arrays[i].Data(), b.arrays[i].Data(), a.arrays[i].Size() * sizeof(float))) return false;
+	}
+	return true;
+}
+
 
 FLightBuffer::FLightBuffer()
 {
@@ -73,6 +96,7 @@ FLightBuffer::~FLightBuffer()
 void FLightBuffer::Clear()
 {
 	mIndex = 0;
+	mGeneration = ++LightBufferGeneration;
 }
 
 int FLightBuffer::UploadLights(FDynLightData &data)
@@ -105,6 +129,12 @@ int FLightBuffer::UploadLights(FDynLightData &data)
 	assert(mBufferPointer != nullptr);
 	if (mBufferPointer == nullptr) return -1;
 	if (totalsize <= 1) return -1;	// there are no lights
+
+	auto &last = LastUpload;
+	if (last.buffer == this && last.generation == mGeneration && SameLightData(last.data, data))
+	{
+		return last.index;
+	}
 	
 	unsigned thisindex = mIndex.fetch_add(totalsize);
 	float parmcnt[] = { 0, float(size0), float(size0 + size1), float(size0 + size1 + size2) };
@@ -117,6 +147,15 @@ int FLightBuffer::UploadLights(FDynLightData &data)
 		memcpy(&copyptr[4], &data.arrays[0][0], size0 * ELEMENT_SIZE);
 		memcpy(&copyptr[4 + 4*size0], &data.arrays[1][0], size1 * ELEMENT_SIZE);
 		memcpy(&copyptr[4 + 4*(size0 + size1)], &data.arrays[2][0], size2 * ELEMENT_SIZE);
+
+		last.buffer = this;
+		last.generation = mGeneration;
+		last.index = thisindex;
+		for (int i = 0; i < 3; i++)
+		{
+			last.data.arrays[i].Resize(data.arrays[i].Size());
+			if (data.arrays[i].Size() > 0) memcpy(last.data.arrays[i].Data(), data.arrays[i].Data(), data.arrays[i].Size() * sizeof(float));
+		}
 		return thisindex;
 	}
 	else
@@ -20,6 +20,7 @@ class FLightBuffer
 	unsigned int mBufferSize;
 	unsigned int mByteSize;
     unsigned int mMaxUploadSize;
+	unsigned int mGeneration = 0;
     
 	void CheckSize();
 
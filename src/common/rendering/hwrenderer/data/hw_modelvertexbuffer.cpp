@@ -30,6 +30,7 @@
 #include "v_video.h"
 #include "cmdlib.h"
 #include "hw_modelvertexbuffer.h"
+#include "memstats.h"
 
 //===========================================================================
 //
@@ -62,6 +63,7 @@ FModelVertexBuffer::~FModelVertexBuffer()
 {
 	if (mIndexBuffer) delete mIndexBuffer;
 	delete mVertexBuffer;
+	MemStat_Add(MEM_Models, -int64_t(mVertexBytes + mIndexBytes));
 }
 
 //===========================================================================
@@ -72,6 +74,8 @@ FModelVertexBuffer::~FModelVertexBuffer()
 
 FModelVertex *FModelVertexBuffer::LockVertexBuffer(unsigned int size)
 {
+	MemStat_Add(MEM_Models, int64_t(size * sizeof(FModelVertex)) - int64_t(mVertexBytes));
+	mVertexBytes = size * sizeof(FModelVertex);
 	return static_cast<FModelVertex*>(mVertexBuffer->Lock(size * sizeof(FModelVertex)));
 }
 
@@ -94,7 +98,12 @@ void FModelVertexBuffer::UnlockVertexBuffer()
 
 unsigned int *FModelVertexBuffer::LockIndexBuffer(unsigned int size)
 {
-	if (mIndexBuffer) return static_cast<unsigned int*>(mIndexBuffer->Lock(size * sizeof(unsigned int)));
+	if (mIndexBuffer)
+	{
+		MemStat_Add(MEM_Models, int64_t(size * sizeof(unsigned int)) - int64_t(mIndexBytes));
+		mIndexBytes = size * sizeof(unsigned int);
+		return static_cast<unsigned int*>(mIndexBuffer->Lock(size * sizeof(unsigned int)));
+	}
 	else return nullptr;
 }
 
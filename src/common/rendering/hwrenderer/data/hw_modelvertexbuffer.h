@@ -9,6 +9,8 @@ class FModelVertexBuffer : public IModelVertexBuffer
 {
 	IVertexBuffer *mVertexBuffer;
 	IIndexBuffer *mIndexBuffer;
+	size_t mVertexBytes = 0;
+	size_t mIndexBytes = 0;
 
 public:
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include "vectors.h"
 #include "matrix.h"
 #include "hw_material.h"
@@ -548,16 +549,18 @@ public:
 
 	void SetDepthBias(float a, float b)
 	{
-		mBias.mFactor = a;
-		mBias.mUnits = b;
-		mBias.mChanged = true;
+		// Sprites set and clear the bias for every single draw so only flag actual changes.
+		if (mBias.mFactor != a || mBias.mUnits != b)
+		{
+			mBias.mFactor = a;
+			mBias.mUnits = b;
+			mBias.mChanged = true;
+		}
 	}
 
 	void ClearDepthBias()
 	{
-		mBias.mFactor = 0;
-		mBias.mUnits = 0;
-		mBias.mChanged = true;
+		SetDepthBias(0, 0);
 	}
 
 	void SetMaterial(FMaterial *mat, int clampmode, int translation, int overrideshader)
@@ -567,7 +570,7 @@ public:
 		mMaterial.mTranslation = translation;
 		mMaterial.mOverrideShader = overrideshader;
 		mMaterial.mChanged = true;
-		mTextureModeFlags = mat->GetLayerFlags();
+		mTextureModeFlags = mat->GetLayerFlags() | mat->GetTranslationFlags(translation, clampmode);
 		auto scale = mat->GetDetailScale();
 		mStreamData.uDetailParms = { scale.X, scale.Y, 0, 0 };
 	}
@@ -674,6 +677,12 @@ public:
 	virtual void EnableMultisampling(bool on) = 0;				// only active for 2D
 	virtual void EnableLineSmooth(bool on) = 0;					// constant setting for each 2D drawer operation
 	virtual void EnableDrawBuffers(int count, bool apply = false) = 0;	// Used by SSAO and EnableDrawBufferAttachments
+	virtual void EnableDrawBatching(bool on) {}						// Used by the draw lists to coalesce consecutive draws with identical state.
+
+	// Draws 'count' items split into consecutive ranges that may get recorded on several threads, each starting with a copy of this state,
+	// so no item may depend on state left behind by the ones before it. 'prepare' runs first on the calling thread.
+	// Returns false if the backend cannot do that, in which case nothing was drawn and the caller has to do it itself.
+	virtual bool DrawParallel(unsigned count, const std::function<void()> &prepare, const std::function<void(FRenderState &state, unsigned start, unsigned end)> &draw) { return false; }
 
 	void SetColorMask(bool on)
 	{
@@ -58,13 +58,14 @@
 cycle_t IShadowMap::UpdateCycles;
 int IShadowMap::LightsProcessed;
 int IShadowMap::LightsShadowmapped;
+int IShadowMap::LightsUpdated;
 
 CVAR(Bool, gl_light_shadowmap, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
 ADD_STAT(shadowmap)
 {
 	FString out;
-	out.Format("upload=%04.2f ms  lights=%d  shadowmapped=%d", IShadowMap::UpdateCycles.TimeMS(), IShadowMap::LightsProcessed, IShadowMap::LightsShadowmapped);
+	out.Format("upload=%04.2f ms  lights=%d  shadowmapped=%d  updated=%d", IShadowMap::UpdateCycles.TimeMS(), IShadowMap::LightsProcessed, IShadowMap::LightsShadowmapped, IShadowMap::LightsUpdated);
 	return out;
 }
 
@@ -97,6 +98,7 @@ bool IShadowMap::PerformUpdate()
 
 	LightsProcessed = 0;
 	LightsShadowmapped = 0;
+	LightsUpdated = 0;
 
 	if (gl_light_shadowmap && (screen->hwcaps & RFL_SHADER_STORAGE_BUFFER) && CollectLights != nullptr)
 	{
@@ -112,6 +114,7 @@ void IShadowMap::UploadLights()
 {
 	mLights.Resize(1024 * 4);
 	CollectLights();
+	FindDirtyRows();
 
 	if (mLightList == nullptr)
 		mLightList = screen->CreateDataBuffer(LIGHTLIST_BINDINGPOINT, true, false);
@@ -120,11 +123,64 @@ void IShadowMap::UploadLights()
 }
 
 
+//==========================================================================
+//
+// A row needs to be rendered again if its light moved or changed its size,
+// or if a dynamic line within the light's radius moved. Everything else
+// is still the same as when the row was rendered. The backends recreate
+// the texture when the quality changes, so that invalidates all rows.
+//
+//==========================================================================
+
+void IShadowMap::FindDirtyRows()
+{
+	bool all = mTreeReset || mRenderedQuality != gl_shadowmap_quality || mRenderedLights.Size() != mLights.Size();
+	mTreeReset = false;
+	mRenderedQuality = gl_shadowmap_quality;
+	if (all) mRenderedLights.Resize(mLights.Size());
+
+	auto &changes = mAABBTree->Changes();
+	mDirtyRows.Clear();
+	for (unsigned row = 0; row < mLights.Size() / 4; row++)
+	{
+		const float *light = &mLights[row * 4];
+		float *rendered = &mRenderedLights[row * 4];
+
+		// The rows only depend on the light's 2D position and its radius.
+		bool dirty = all || light[0] != rendered[0] || light[1] != rendered[1] || light[3] != rendered[3];
+		if (!dirty && light[3] > 0.f)
+		{
+			for (auto &change : changes)
+			{
+				if (light[0] + light[3] >= change.left && light[0] - light[3] <= change.right &&
+					light[1] + light[3] >= change.top && light[1] - light[3] <= change.bottom)
+				{
+					dirty = true;
+					break;
+				}
+			}
+		}
+		if (!dirty) continue;
+
+		memcpy(rendered, light, 4 * sizeof(float));
+		if (light[3] > 0.f) LightsUpdated++;
+		if (mDirtyRows.Size() > 0 && mDirtyRows.Last().start + mDirtyRows.Last().count == (int)row)
+		{
+			mDirtyRows.Last().count++;
+		}
+		else
+		{
+			mDirtyRows.Push({ (int)row, 1 });
+		}
+	}
+}
+
 void IShadowMap::UploadAABBTree()
 {
 	if (mNewTree)
 	{
 		mNewTree = false;
+		mTreeReset = true;
 
 		if (!mNodesBuffer)
 			mNodesBuffer = screen->CreateDataBuffer(LIGHTNODES_BINDINGPOINT, true, false);
@@ -143,6 +199,7 @@ void IShadowMap::UploadAABBTree()
 
 void IShadowMap::Reset()
 {
+	mRenderedQuality = 0;
 	delete mLightList; mLightList = nullptr;
 	delete mNodesBuffer; mNodesBuffer = nullptr;
 	delete mLinesBuffer; mLinesBuffer = nullptr;
@@ -21,6 +21,13 @@ public:
 	static cycle_t UpdateCycles;
 	static int LightsProcessed;
 	static int LightsShadowmapped;
+	static int LightsUpdated;
+
+	// A range of shadowmap rows that needs to be rendered
+	struct RowRange
+	{
+		int start, count;
+	};
 
 	bool PerformUpdate();
 	void FinishUpdate()
@@ -28,6 +35,12 @@ public:
 		UpdateCycles.Clock();
 	}
 
+	// Only the rows whose light or surrounding geometry changed since they were last rendered need to be updated.
+	const TArray<RowRange> &DirtyRows() const
+	{
+		return mDirtyRows;
+	}
+
 	unsigned int NodesCount() const
 	{
 		assert(mAABBTree);
@@ -58,10 +71,17 @@ protected:
 	// Upload the AABB-tree to the GPU
 	void UploadAABBTree();
 	void UploadLights();
+	void FindDirtyRows();
 
 	// Working buffer for creating the list of lights. Stored here to avoid allocating memory each frame
 	TArray<float> mLights;
 
+	// The lights the rows currently in the shadowmap texture were rendered for
+	TArray<float> mRenderedLights;
+	int mRenderedQuality = 0;
+	bool mTreeReset = false;
+	TArray<RowRange> mDirtyRows;
+
 	// AABB-tree of the level, used for ray tests, owned by the playsim, not the renderer.
 	hwrenderer::LevelAABBTree* mAABBTree = nullptr;
 	bool mNewTree = false;
@@ -31,5 +31,18 @@ public:
 	void Set2D(FRenderState &di, int width, int height, int pll = 0);
 	int SetViewpoint(FRenderState &di, HWViewpointUniforms *vp);
 	unsigned int GetBlockSize() const { return mBlockSize; }
+
+	// For backends whose buffer moves to different memory each frame. Forces the 2D projection to be rewritten and everything to be rebound.
+	void Invalidate()
+	{
+		m2DWidth = m2DHeight = -1;
+		mLastMappedIndex = UINT_MAX;
+	}
+
+	// OpenGL needs the buffer to mess around with the binding.
+	IDataBuffer* GetBuffer() const
+	{
+		return mBuffer;
+	}
 };
 
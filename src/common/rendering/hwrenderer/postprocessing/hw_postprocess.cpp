@@ -532,14 +532,12 @@ void PPCameraExposure::UpdateTextures(int width, int height)
 
 /////////////////////////////////////////////////////////////////////////////
 
-void PPColormap::Render(PPRenderState *renderstate, int fixedcm, float flash)
+bool PPColormap::GetUniforms(int fixedcm, float flash, ColormapUniforms &uniforms)
 {
-	ColormapUniforms uniforms;
-
 	if (fixedcm < CM_FIRSTSPECIALCOLORMAP || fixedcm >= CM_MAXCOLORMAP)
 	{
 		if (flash == 1.f)
-			return;
+			return false;
 
 		uniforms.MapStart = { 0,0,0, flash };
 		uniforms.MapRange = { 0,0,0, 1.f };
@@ -552,7 +550,11 @@ void PPColormap::Render(PPRenderState *renderstate, int fixedcm, float flash)
 		uniforms.MapRange = { scm->ColorizeEnd[0] - scm->ColorizeStart[0],
 			scm->ColorizeEnd[1] - scm->ColorizeStart[1], scm->ColorizeEnd[2] - scm->ColorizeStart[2], 0.f };
 	}
+	return true;
+}
 
+void PPColormap::Render(PPRenderState *renderstate, const ColormapUniforms &uniforms)
+{
 	renderstate->PushGroup("colormap");
 
 	renderstate->Clear();
@@ -597,11 +599,11 @@ void PPTonemap::UpdateTextures()
 	}
 }
 
-void PPTonemap::Render(PPRenderState *renderstate)
+bool PPTonemap::Render(PPRenderState *renderstate, const ColormapUniforms *colormap)
 {
 	if (gl_tonemap == 0)
 	{
-		return;
+		return false;
 	}
 
 	UpdateTextures();
@@ -610,17 +612,18 @@ void PPTonemap::Render(PPRenderState *renderstate)
 	switch (gl_tonemap)
 	{
 	default:
-	case Linear:		shader = &LinearShader; break;
-	case Reinhard:		shader = &ReinhardShader; break;
-	case HejlDawson:	shader = &HejlDawsonShader; break;
-	case Uncharted2:	shader = &Uncharted2Shader; break;
-	case Palette:		shader = &PaletteShader; break;
+	case Linear:		shader = colormap ? &LinearColormapShader : &LinearShader; break;
+	case Reinhard:		shader = colormap ? &ReinhardColormapShader : &ReinhardShader; break;
+	case HejlDawson:	shader = colormap ? &HejlDawsonColormapShader : &HejlDawsonShader; break;
+	case Uncharted2:	shader = colormap ? &Uncharted2ColormapShader : &Uncharted2Shader; break;
+	case Palette:		shader = colormap ? &PaletteColormapShader : &PaletteShader; break;
 	}
 
 	renderstate->PushGroup("tonemap");
 
 	renderstate->Clear();
 	renderstate->Shader = shader;
+	if (colormap) renderstate->Uniforms.Set(*colormap);
 	renderstate->Viewport = screen->mScreenViewport;
 	renderstate->SetInputCurrent(0);
 	if (gl_tonemap == Palette)
@@ -630,6 +633,7 @@ void PPTonemap::Render(PPRenderState *renderstate)
 	renderstate->Draw();
 
 	renderstate->PopGroup();
+	return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -701,11 +705,12 @@ void PPAmbientOcclusion::CreateShaders()
 
 void PPAmbientOcclusion::UpdateTextures(int width, int height)
 {
-	if ((width <= 0 || height <= 0) || (width == LastWidth && height == LastHeight))
+	int divisor = gl_ssao_quarterres ? 4 : 2;
+	if ((width <= 0 || height <= 0) || (width == LastWidth && height == LastHeight && divisor == LastDivisor))
 		return;
 
-	AmbientWidth = (width + 1) / 2;
-	AmbientHeight = (height + 1) / 2;
+	AmbientWidth = (width + divisor - 1) / divisor;
+	AmbientHeight = (height + divisor - 1) / divisor;
 
 	LinearDepthTexture = { AmbientWidth, AmbientHeight, PixelFormat::R32f };
 	Ambient0 = { AmbientWidth, AmbientHeight, PixelFormat::Rg16f };
@@ -713,6 +718,7 @@ void PPAmbientOcclusion::UpdateTextures(int width, int height)
 
 	LastWidth = width;
 	LastHeight = height;
+	LastDivisor = divisor;
 }
 
 void PPAmbientOcclusion::Render(PPRenderState *renderstate, float m5, int sceneWidth, int sceneHeight)
@@ -881,14 +887,17 @@ void PPShadowMap::Update(PPRenderState* renderstate)
 
 	renderstate->PushGroup("shadowmap");
 
-	renderstate->Clear();
-	renderstate->Shader = &ShadowMap;
-	renderstate->Uniforms.Set(uniforms);
-	renderstate->Viewport = { 0, 0, gl_shadowmap_quality, 1024 };
-	renderstate->SetShadowMapBuffers(true);
-	renderstate->SetOutputShadowMap();
-	renderstate->SetNoBlend();
-	renderstate->Draw();
+	for (auto &rows : screen->mShadowMap.DirtyRows())
+	{
+		renderstate->Clear();
+		renderstate->Shader = &ShadowMap;
+		renderstate->Uniforms.Set(uniforms);
+		renderstate->Viewport = { 0, rows.start, gl_shadowmap_quality, rows.count };
+		renderstate->SetShadowMapBuffers(true);
+		renderstate->SetOutputShadowMap();
+		renderstate->SetNoBlend();
+		renderstate->Draw();
+	}
 
 	renderstate->PopGroup();
 }
@@ -1125,8 +1134,13 @@ void Postprocess::Pass1(PPRenderState* state, int fixedcm, int sceneWidth, int s
 
 void Postprocess::Pass2(PPRenderState* state, int fixedcm, float flash, int sceneWidth, int sceneHeight)
 {
-	tonemap.Render(state);
-	colormap.Render(state, fixedcm, flash);
+	// The colormap is merged into the tonemap pass if there is one.
+	ColormapUniforms cmuniforms;
+	bool hascolormap = colormap.GetUniforms(fixedcm, flash, cmuniforms);
+	if (!tonemap.Render(state, hascolormap ? &cmuniforms : nullptr) && hascolormap)
+	{
+		colormap.Render(state, cmuniforms);
+	}
 	lens.Render(state);
 	fxaa.Render(state);
 	customShaders.Run(state, "scene");
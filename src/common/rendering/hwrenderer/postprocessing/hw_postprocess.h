@@ -530,7 +530,8 @@ struct ColormapUniforms
 class PPColormap
 {
 public:
-	void Render(PPRenderState *renderstate, int fixedcm, float flash);
+	static bool GetUniforms(int fixedcm, float flash, ColormapUniforms &uniforms);
+	void Render(PPRenderState *renderstate, const ColormapUniforms &uniforms);
 
 private:
 	PPShader Colormap = { "shaders/pp/colormap.fp", "", ColormapUniforms::Desc() };
@@ -541,7 +542,8 @@ private:
 class PPTonemap
 {
 public:
-	void Render(PPRenderState *renderstate);
+	// If a colormap is passed it gets applied in the same pass. Returns false if tonemapping is off.
+	bool Render(PPRenderState *renderstate, const ColormapUniforms *colormap);
 	void ClearTonemapPalette() { PaletteTexture = {}; }
 
 private:
@@ -555,6 +557,12 @@ private:
 	PPShader Uncharted2Shader = { "shaders/pp/tonemap.fp", "#define UNCHARTED2\n", {} };
 	PPShader PaletteShader = { "shaders/pp/tonemap.fp", "#define PALETTE\n", {} };
 
+	PPShader LinearColormapShader = { "shaders/pp/tonemap.fp", "#define LINEAR\n#define COLORMAP\n", ColormapUniforms::Desc() };
+	PPShader ReinhardColormapShader = { "shaders/pp/tonemap.fp", "#define REINHARD\n#define COLORMAP\n", ColormapUniforms::Desc() };
+	PPShader HejlDawsonColormapShader = { "shaders/pp/tonemap.fp", "#define HEJLDAWSON\n#define COLORMAP\n", ColormapUniforms::Desc() };
+	PPShader Uncharted2ColormapShader = { "shaders/pp/tonemap.fp", "#define UNCHARTED2\n#define COLORMAP\n", ColormapUniforms::Desc() };
+	PPShader PaletteColormapShader = { "shaders/pp/tonemap.fp", "#define PALETTE\n#define COLORMAP\n", ColormapUniforms::Desc() };
+
 	enum TonemapMode
 	{
 		None,
@@ -698,6 +706,7 @@ private:
 	int LastQuality = -1;
 	int LastWidth = 0;
 	int LastHeight = 0;
+	int LastDivisor = 0;
 
 	PPShader LinearDepth;
 	PPShader LinearDepthMS;
@@ -70,6 +70,8 @@ CUSTOM_CVAR(Int, gl_ssao_portals, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 		self = 0;
 }
 
+CVAR(Bool, gl_ssao_quarterres, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// calculate SSAO at quarter instead of half resolution
+
 CVAR(Float, gl_ssao_strength, 0.7f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR(Int, gl_ssao_debug, 0, 0)
 CVAR(Float, gl_ssao_bias, 0.2f, 0)
@@ -38,6 +38,7 @@ EXTERN_CVAR(Float, gl_lens_chromatic)
 EXTERN_CVAR(Int, gl_fxaa)
 EXTERN_CVAR(Int, gl_ssao)
 EXTERN_CVAR(Int, gl_ssao_portals)
+EXTERN_CVAR(Bool, gl_ssao_quarterres)
 EXTERN_CVAR(Float, gl_ssao_strength)
 EXTERN_CVAR(Int, gl_ssao_debug)
 EXTERN_CVAR(Float, gl_ssao_bias)
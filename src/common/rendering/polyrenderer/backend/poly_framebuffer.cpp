@@ -178,6 +178,9 @@ void PolyFrameBuffer::Update()
 		if (dst)
 		{
 #if 1
+			// The poly drawers split the canvas into tiles, the copy interleaves the lines. Let the drawing finish first.
+			DrawerThreads::WaitForWorkers();
+
 			auto copyqueue = std::make_shared<DrawerCommandQueue>(&mFrameMemory);
 			copyqueue->Push<MemcpyCommand>(dst, pitch / pixelsize, src, w, h, w, pixelsize);
 			DrawerThreads::Execute(copyqueue);
@@ -45,15 +45,15 @@ void PolyTriangleThreadData::ClearDepth(float value)
 	int height = depthstencil->Height();
 	float *data = depthstencil->DepthValues();
 
-	int skip = skipped_by_thread(0);
-	int count = count_for_thread(0, height);
-
-	data += skip * width;
-	for (int i = 0; i < count; i++)
+	int end = MIN(height, numa_end_y);
+	for (int y = next_line_for_thread(0); y < end; y = next_line_for_thread(y))
 	{
-		for (int x = 0; x < width; x++)
-			data[x] = value;
-		data += num_cores * width;
+		for (int tileend = MIN(tile_end(y), end); y < tileend; y++)
+		{
+			float *line = data + y * width;
+			for (int x = 0; x < width; x++)
+				line[x] = value;
+		}
 	}
 }
 
@@ -63,14 +63,12 @@ void PolyTriangleThreadData::ClearStencil(uint8_t value)
 	int height = depthstencil->Height();
 	uint8_t *data = depthstencil->StencilValues();
 
-	int skip = skipped_by_thread(0);
-	int count = count_for_thread(0, height);
-
-	data += skip * width;
-	for (int i = 0; i < count; i++)
+	int end = MIN(height, numa_end_y);
+	for (int y = next_line_for_thread(0); y < end; y = next_line_for_thread(y))
 	{
-		memset(data, value, width);
-		data += num_cores * width;
+		int tileend = MIN(tile_end(y), end);
+		memset(data + y * width, value, (tileend - y) * width);
+		y = tileend;
 	}
 }
 
@@ -412,6 +410,33 @@ bool PolyTriangleThreadData::IsDegenerate(const ShadedTriVertex *const* vert)
 	return crosslengthsqr <= 1.e-8f;
 }
 
+bool PolyTriangleThreadData::IsOutsideThreadTiles(const ShadedTriVertex *const* vert)
+{
+	// Bin the triangle by the screen rows it may touch. Clipping can only make it smaller, so the bounds of the
+	// unclipped vertices are good enough as long as none of them is behind the eye.
+	float miny = FLT_MAX, maxy = -FLT_MAX;
+	for (int i = 0; i < 3; i++)
+	{
+		const auto &pos = vert[i]->gl_Position;
+		if (pos.W <= 0.0f)
+			return false;
+
+		float y = pos.Y / pos.W;
+		y = topdown ? viewport_y + viewport_height * (1.0f - y) * 0.5f : viewport_y + viewport_height * (1.0f + y) * 0.5f;
+		miny = MIN(miny, y);
+		maxy = MAX(maxy, y);
+	}
+
+	int top = MAX(clip.top, numa_start_y);
+	int bottom = MIN(clip.bottom, numa_end_y);
+	if (miny > (float)bottom || maxy < (float)top)
+		return true;
+
+	top = MAX(top, (int)MAX(miny, (float)top));
+	bottom = MIN(bottom, (int)MIN(maxy, (float)bottom) + 2);
+	return next_line_for_thread(top) >= bottom;
+}
+
 bool PolyTriangleThreadData::IsFrontfacing(TriDrawTriangleArgs *args)
 {
 	float a =
@@ -531,8 +556,8 @@ void PolyTriangleThreadData::DrawShadedLine(const ShadedTriVertex *const* vert)
 
 void PolyTriangleThreadData::DrawShadedTriangle(const ShadedTriVertex *const* vert, bool ccw)
 {
-	// Reject triangle if degenerate
-	if (IsDegenerate(vert))
+	// Reject triangle if degenerate or not covering any tile of this thread
+	if (IsDegenerate(vert) || IsOutsideThreadTiles(vert))
 		return;
 
 	// Cull, clip and generate additional vertices as needed
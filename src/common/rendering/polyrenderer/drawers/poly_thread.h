@@ -78,23 +78,30 @@ public:
 	int numa_start_y;
 	int numa_end_y;
 
+	// The screen is divided into tiles of tileHeight rows which are handed out round robin to the threads.
+	// Each thread only sets up and rasterizes the triangles overlapping its own tiles.
+	// Note that the other drawer commands (MemcpyCommand, the swrenderer drawers) interleave single lines,
+	// so the queue must be drained before they touch anything the poly drawers rendered to.
+	enum { tileHeight = 16 };
+
 	bool line_skipped_by_thread(int line)
 	{
-		return line < numa_start_y || line >= numa_end_y || line % num_cores != core;
+		return line < numa_start_y || line >= numa_end_y || (line / tileHeight) % num_cores != core;
 	}
 
-	int skipped_by_thread(int first_line)
+	// The first line at or after the given one which is rendered by this thread
+	int next_line_for_thread(int line)
 	{
-		int clip_first_line = MAX(first_line, numa_start_y);
-		int core_skip = (num_cores - (clip_first_line - core) % num_cores) % num_cores;
-		return clip_first_line + core_skip - first_line;
+		line = MAX(line, MAX(numa_start_y, 0));
+		int tile = line / tileHeight;
+		int tileskip = (core - tile % num_cores + num_cores) % num_cores;
+		return tileskip == 0 ? line : (tile + tileskip) * tileHeight;
 	}
 
-	int count_for_thread(int first_line, int count)
+	// The end of the tile the given line is part of
+	int tile_end(int line)
 	{
-		count = MIN(count, numa_end_y - first_line);
-		int c = (count - skipped_by_thread(first_line) + num_cores - 1) / num_cores;
-		return MAX(c, 0);
+		return MIN((line / tileHeight + 1) * tileHeight, numa_end_y);
 	}
 
 	struct Scanline
@@ -181,6 +188,7 @@ private:
 	void DrawShadedTriangle(const ShadedTriVertex *const* vertices, bool ccw);
 	static bool IsDegenerate(const ShadedTriVertex *const* vertices);
 	static bool IsFrontfacing(TriDrawTriangleArgs *args);
+	bool IsOutsideThreadTiles(const ShadedTriVertex *const* vertices);
 
 	int ClipEdge(const ShadedTriVertex *const* verts);
 
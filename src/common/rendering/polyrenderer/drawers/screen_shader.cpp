@@ -64,6 +64,27 @@ static void EffectFogBoundary(int x0, int x1, PolyTriangleThreadData* thread)
 	}
 }
 
+// Must match the noise in burn.fp
+static float BurnHash(int x, int y)
+{
+	uint32_t h = uint32_t(x) * 374761393u + uint32_t(y) * 668265263u;
+	h = (h ^ (h >> 13)) * 1274126177u;
+	return ((h ^ (h >> 16)) & 0xffff) / 65535.0f;
+}
+
+static float BurnNoise(float x, float y)
+{
+	float fx = std::floor(x), fy = std::floor(y);
+	int ix = (int)fx, iy = (int)fy;
+	fx = x - fx;
+	fy = y - fy;
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fy = fy * fy * (3.0f - 2.0f * fy);
+	float a = BurnHash(ix, iy) + (BurnHash(ix + 1, iy) - BurnHash(ix, iy)) * fx;
+	float b = BurnHash(ix, iy + 1) + (BurnHash(ix + 1, iy + 1) - BurnHash(ix, iy + 1)) * fx;
+	return a + (b - a) * fy;
+}
+
 static void EffectBurn(int x0, int x1, PolyTriangleThreadData* thread)
 {
 	int texWidth = thread->textures[0].width;
@@ -71,11 +92,6 @@ static void EffectBurn(int x0, int x1, PolyTriangleThreadData* thread)
 	const void* texPixels = thread->textures[0].pixels;
 	bool texBgra = thread->textures[0].bgra;
 
-	int tex2Width = thread->textures[1].width;
-	int tex2Height = thread->textures[1].height;
-	const void* tex2Pixels = thread->textures[1].pixels;
-	bool tex2Bgra = thread->textures[1].bgra;
-
 	uint32_t* fragcolor = thread->scanline.FragColor;
 	uint16_t* u = thread->scanline.U;
 	uint16_t* v = thread->scanline.V;
@@ -84,19 +100,22 @@ static void EffectBurn(int x0, int x1, PolyTriangleThreadData* thread)
 		uint32_t frag_r = thread->scanline.vColorR[x];
 		uint32_t frag_g = thread->scanline.vColorG[x];
 		uint32_t frag_b = thread->scanline.vColorB[x];
-		uint32_t frag_a = thread->scanline.vColorA[x];
 		frag_r += frag_r >> 7; // 255 -> 256
 		frag_g += frag_g >> 7; // 255 -> 256
 		frag_b += frag_b >> 7; // 255 -> 256
-		frag_a += frag_a >> 7; // 255 -> 256
 
 		uint32_t t1 = SampleTexture(u[x], v[x], texPixels, texWidth, texHeight, texBgra);
-		uint32_t t2 = SampleTexture(u[x], 0xffff - v[x], tex2Pixels, tex2Width, tex2Height, tex2Bgra);
+
+		float s = u[x] * (1.0f / 65536.0f);
+		float t = v[x] * (1.0f / 65536.0f);
+		float px = s * 16.0f, py = (1.0f - t) * 8.0f;
+		float noise = (BurnNoise(px, py) * 4.0f + BurnNoise(px * 2.0f, py * 2.0f) * 2.0f + BurnNoise(px * 4.0f, py * 4.0f)) / 7.0f;
+		float level = thread->scanline.vColorA[x] * (1.75f / 255.0f) - t - noise * 0.5f;
 
 		uint32_t r = (frag_r * RPART(t1)) >> 8;
 		uint32_t g = (frag_g * GPART(t1)) >> 8;
 		uint32_t b = (frag_b * BPART(t1)) >> 8;
-		uint32_t a = (frag_a * APART(t2)) >> 8;
+		uint32_t a = static_cast<uint32_t>(clamp(level * 4.0f, 0.0f, 1.0f) * 255.0f);
 
 		fragcolor[x] = MAKEARGB(a, r, g, b);
 	}
@@ -33,6 +33,10 @@
 #include "x86.h"
 #include <cmath>
 
+#ifndef NO_SSE
+#include <immintrin.h>
+#endif
+
 static void WriteDepth(int y, int x0, int x1, PolyTriangleThreadData* thread)
 {
 	size_t pitch = thread->depthstencil->Width();
@@ -93,6 +97,55 @@ static void DrawSpan(int y, int x0, int x1, const TriDrawTriangleArgs* args, Pol
 	}
 }
 
+// Returns the first pixel from x on whose depth and stencil test result differs from the passed argument
+template<typename OptT, bool passed>
+static int FindTestEdge(int x, int xend, const float* zbufferLine, const float* w, float depthbias, const uint8_t* stencilLine, uint8_t stencilTestValue)
+{
+#ifndef NO_SSE
+	// Test four pixels at a time. Whole blocks which pass or fail can then be accepted or rejected without looking at the individual pixels.
+	__m128 mdepthbias = _mm_set1_ps(depthbias);
+	__m128i mstenciltestvalue = _mm_set1_epi8(stencilTestValue);
+	while (x + 4 <= xend)
+	{
+		int mask = 15;
+		if (OptT::Flags & SWTRI_DepthTest)
+			mask &= _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(zbufferLine + x), _mm_add_ps(_mm_loadu_ps(w + x), mdepthbias)));
+		if (OptT::Flags & SWTRI_StencilTest)
+		{
+			uint32_t stencil4;
+			memcpy(&stencil4, stencilLine + x, sizeof(uint32_t));
+			mask &= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_cvtsi32_si128(stencil4), mstenciltestvalue));
+		}
+
+		if (passed)
+			mask = ~mask & 15;
+		if (mask != 0)
+		{
+			while (!(mask & 1))
+			{
+				mask >>= 1;
+				x++;
+			}
+			return x;
+		}
+		x += 4;
+	}
+#endif
+
+	while (x < xend)
+	{
+		bool result = true;
+		if (OptT::Flags & SWTRI_DepthTest)
+			result = result && zbufferLine[x] >= w[x] + depthbias;
+		if (OptT::Flags & SWTRI_StencilTest)
+			result = result && stencilLine[x] == stencilTestValue;
+		if (result != passed)
+			break;
+		x++;
+	}
+	return x;
+}
+
 template<typename OptT>
 static void TestSpan(int y, int x0, int x1, const TriDrawTriangleArgs* args, PolyTriangleThreadData* thread)
 {
@@ -102,24 +155,20 @@ static void TestSpan(int y, int x0, int x1, const TriDrawTriangleArgs* args, Pol
 	{
 		size_t pitch = thread->depthstencil->Width();
 
-		uint8_t* stencilbuffer;
-		uint8_t* stencilLine;
-		uint8_t stencilTestValue;
+		uint8_t* stencilLine = nullptr;
+		uint8_t stencilTestValue = 0;
 		if (OptT::Flags & SWTRI_StencilTest)
 		{
-			stencilbuffer = thread->depthstencil->StencilValues();
-			stencilLine = stencilbuffer + pitch * y;
+			stencilLine = thread->depthstencil->StencilValues() + pitch * y;
 			stencilTestValue = thread->StencilTestValue;
 		}
 
-		float* zbuffer;
-		float* zbufferLine;
-		float* w;
-		float depthbias;
+		float* zbufferLine = nullptr;
+		float* w = nullptr;
+		float depthbias = 0.0f;
 		if (OptT::Flags & SWTRI_DepthTest)
 		{
-			zbuffer = thread->depthstencil->DepthValues();
-			zbufferLine = zbuffer + pitch * y;
+			zbufferLine = thread->depthstencil->DepthValues() + pitch * y;
 			w = thread->scanline.W;
 			depthbias = thread->depthbias;
 		}
@@ -129,47 +178,14 @@ static void TestSpan(int y, int x0, int x1, const TriDrawTriangleArgs* args, Pol
 		while (x < xend)
 		{
 			int xstart = x;
-
-			if ((OptT::Flags & SWTRI_DepthTest) && (OptT::Flags & SWTRI_StencilTest))
-			{
-				while (zbufferLine[x] >= w[x] + depthbias && stencilLine[x] == stencilTestValue && x < xend)
-					x++;
-			}
-			else if (OptT::Flags & SWTRI_DepthTest)
-			{
-				while (zbufferLine[x] >= w[x] + depthbias && x < xend)
-					x++;
-			}
-			else if (OptT::Flags & SWTRI_StencilTest)
-			{
-				while (stencilLine[x] == stencilTestValue && x < xend)
-					x++;
-			}
-			else
-			{
-				x = xend;
-			}
+			x = FindTestEdge<OptT, true>(x, xend, zbufferLine, w, depthbias, stencilLine, stencilTestValue);
 
 			if (x > xstart)
 			{
 				DrawSpan(y, xstart, x, args, thread);
 			}
 
-			if ((OptT::Flags & SWTRI_DepthTest) && (OptT::Flags & SWTRI_StencilTest))
-			{
-				while ((zbufferLine[x] < w[x] + depthbias || stencilLine[x] != stencilTestValue) && x < xend)
-					x++;
-			}
-			else if (OptT::Flags & SWTRI_DepthTest)
-			{
-				while (zbufferLine[x] < w[x] + depthbias && x < xend)
-					x++;
-			}
-			else if (OptT::Flags & SWTRI_StencilTest)
-			{
-				while (stencilLine[x] != stencilTestValue && x < xend)
-					x++;
-			}
+			x = FindTestEdge<OptT, false>(x, xend, zbufferLine, w, depthbias, stencilLine, stencilTestValue);
 		}
 	}
 	else
@@ -224,53 +240,31 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 	if (thread->StencilTest) opt |= SWTRI_StencilTest;
 	testfunc = ScreenTriangle::TestSpanOpts[opt];
 
-	topY += thread->skipped_by_thread(topY);
-	int num_cores = thread->num_cores;
-
 	// Find start/end X positions for each line covered by the triangle:
 
-	int y = topY;
-
 	float longDX = sortedVertices[2]->x - sortedVertices[0]->x;
 	float longDY = sortedVertices[2]->y - sortedVertices[0]->y;
 	float longStep = longDX / longDY;
-	float longPos = sortedVertices[0]->x + longStep * (y + 0.5f - sortedVertices[0]->y) + 0.5f;
-	longStep *= num_cores;
 
-	if (y < midY)
-	{
-		float shortDX = sortedVertices[1]->x - sortedVertices[0]->x;
-		float shortDY = sortedVertices[1]->y - sortedVertices[0]->y;
-		float shortStep = shortDX / shortDY;
-		float shortPos = sortedVertices[0]->x + shortStep * (y + 0.5f - sortedVertices[0]->y) + 0.5f;
-		shortStep *= num_cores;
+	float topDY = sortedVertices[1]->y - sortedVertices[0]->y;
+	float topStep = (topY < midY) ? (sortedVertices[1]->x - sortedVertices[0]->x) / topDY : 0.0f;
 
-		while (y < midY)
-		{
-			int x0 = (int)shortPos;
-			int x1 = (int)longPos;
-			if (x1 < x0) std::swap(x0, x1);
-			x0 = clamp(x0, clipleft, clipright);
-			x1 = clamp(x1, clipleft, clipright);
+	float bottomDY = sortedVertices[2]->y - sortedVertices[1]->y;
+	float bottomStep = (midY < bottomY) ? (sortedVertices[2]->x - sortedVertices[1]->x) / bottomDY : 0.0f;
 
-			testfunc(y, x0, x1, args, thread);
-
-			shortPos += shortStep;
-			longPos += longStep;
-			y += num_cores;
-		}
-	}
-
-	if (y < bottomY)
+	// Only walk the lines of the tiles belonging to this thread
+	for (int y = thread->next_line_for_thread(topY); y < bottomY; y = thread->next_line_for_thread(y))
 	{
-		float shortDX = sortedVertices[2]->x - sortedVertices[1]->x;
-		float shortDY = sortedVertices[2]->y - sortedVertices[1]->y;
-		float shortStep = shortDX / shortDY;
-		float shortPos = sortedVertices[1]->x + shortStep * (y + 0.5f - sortedVertices[1]->y) + 0.5f;
-		shortStep *= num_cores;
-
-		while (y < bottomY)
+		for (int tileend = MIN(thread->tile_end(y), bottomY); y < tileend; y++)
 		{
+			float centerY = y + 0.5f;
+			float longPos = sortedVertices[0]->x + longStep * (centerY - sortedVertices[0]->y) + 0.5f;
+			float shortPos;
+			if (y < midY)
+				shortPos = sortedVertices[0]->x + topStep * (centerY - sortedVertices[0]->y) + 0.5f;
+			else
+				shortPos = sortedVertices[1]->x + bottomStep * (centerY - sortedVertices[1]->y) + 0.5f;
+
 			int x0 = (int)shortPos;
 			int x1 = (int)longPos;
 			if (x1 < x0) std::swap(x0, x1);
@@ -278,10 +272,6 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 			x1 = clamp(x1, clipleft, clipright);
 
 			testfunc(y, x0, x1, args, thread);
-
-			shortPos += shortStep;
-			longPos += longStep;
-			y += num_cores;
 		}
 	}
 }
@@ -32,6 +32,10 @@
 #include "polyrenderer/drawers/poly_triangle.h"
 #include <chrono>
 
+#ifdef ARCH_IA32
+#include <immintrin.h>
+#endif
+
 #ifdef WIN32
 void PeekThreadedErrorPane();
 #endif
@@ -39,6 +43,18 @@ void PeekThreadedErrorPane();
 CVAR(Int, r_multithreaded, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 CVAR(Int, r_debug_draw, 0, 0);
 
+// How many times a worker polls for new work before it goes to sleep
+static const int SpinCount = 2000;
+
+static void SpinPause()
+{
+#ifdef ARCH_IA32
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
 /////////////////////////////////////////////////////////////////////////////
 
 DrawerThreads *DrawerThreads::Instance()
@@ -63,16 +79,31 @@ void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
 	
 	auto queue = Instance();
 
+	std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+
 	queue->StartThreads();
 
-	// Add to queue and awaken worker threads
-	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
-	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
-	queue->active_commands.push_back(commands);
-	queue->tasks_left += queue->threads.size();
-	end_lock.unlock();
-	start_lock.unlock();
-	queue->start_condition.notify_all();
+	// All slots in flight. Wait for the workers to release them.
+	size_t index = queue->submitted_queues.load(std::memory_order_relaxed);
+	if (index - queue->collected_queues == MaxActiveQueues)
+	{
+		queue->WaitForTasks();
+		queue->CollectQueues();
+	}
+
+	// Publish the queue to the workers
+	queue->active_commands[index % MaxActiveQueues] = commands;
+	queue->tasks_left.fetch_add(queue->threads.size());
+	queue->submitted_queues.store(index + 1);
+	submit_lock.unlock();
+
+	// Spinning workers pick up the queue on their own. Only wake the parked ones.
+	if (queue->parked_workers.load() > 0)
+	{
+		std::unique_lock<std::mutex> start_lock(queue->start_mutex);
+		start_lock.unlock();
+		queue->start_condition.notify_all();
+	}
 }
 
 void DrawerThreads::ResetDebugDrawPos()
@@ -93,49 +124,82 @@ void DrawerThreads::ResetDebugDrawPos()
 }
 
 void DrawerThreads::WaitForWorkers()
+{
+	auto queue = Instance();
+	while (true)
+	{
+		queue->WaitForTasks();
+
+		// Only release the slots if nothing got submitted in the meantime
+		std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+		if (queue->tasks_left.load(std::memory_order_acquire) == 0)
+		{
+			queue->CollectQueues();
+			break;
+		}
+	}
+}
+
+void DrawerThreads::WaitForTasks()
 {
 	using namespace std::chrono_literals;
 
-	// Wait for workers to finish
-	auto queue = Instance();
-	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
-	if (!queue->end_condition.wait_for(end_lock, 5s, [&]() { return queue->tasks_left == 0; }))
+	// Most of the time the workers are almost done, so spin a bit before sleeping.
+	for (int i = 0; i < SpinCount && tasks_left.load(std::memory_order_acquire) != 0; i++)
+		SpinPause();
+
+	if (tasks_left.load(std::memory_order_acquire) != 0)
 	{
+		std::unique_lock<std::mutex> end_lock(end_mutex);
+		if (!end_condition.wait_for(end_lock, 5s, [&]() { return tasks_left.load(std::memory_order_acquire) == 0; }))
+		{
 #ifdef WIN32
-		PeekThreadedErrorPane();
+			PeekThreadedErrorPane();
 #endif
-		// Invoke the crash reporter so that we can capture the call stack of whatever the hung worker thread is doing
-		int *threadCrashed = nullptr;
-		*threadCrashed = 0xdeadbeef;
+			// Invoke the crash reporter so that we can capture the call stack of whatever the hung worker thread is doing
+			int *threadCrashed = nullptr;
+			*threadCrashed = 0xdeadbeef;
+		}
 	}
-	end_lock.unlock();
-
-	// Clean up
-	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
-	for (auto &thread : queue->threads)
-		thread.current_queue = 0;
+}
 
-	for (auto &list : queue->active_commands)
+// Must be called with submit_mutex held and all tasks finished
+void DrawerThreads::CollectQueues()
+{
+	size_t submitted = submitted_queues.load(std::memory_order_relaxed);
+	for (size_t i = collected_queues; i < submitted; i++)
 	{
+		auto &list = active_commands[i % MaxActiveQueues];
 		for (auto &command : list->commands)
 			command->~DrawerCommand();
 		list->Clear();
+		list.reset();
 	}
-	queue->active_commands.clear();
+	collected_queues = submitted;
 }
 
 void DrawerThreads::WorkerMain(DrawerThread *thread)
 {
 	while (true)
 	{
-		// Wait until we are signalled to run:
-		std::unique_lock<std::mutex> start_lock(start_mutex);
-		start_condition.wait(start_lock, [&]() { return thread->current_queue < active_commands.size() || shutdown_flag; });
+		// Wait until we are signalled to run. Spin first as the next queue usually follows quickly.
+		auto hasWork = [&]() { return thread->current_queue < submitted_queues.load() || shutdown_flag.load(); };
+		for (int i = 0; i < SpinCount && !hasWork(); i++)
+			SpinPause();
+
+		if (!hasWork())
+		{
+			std::unique_lock<std::mutex> start_lock(start_mutex);
+			parked_workers++;
+			start_condition.wait(start_lock, hasWork);
+			parked_workers--;
+		}
+
 		if (shutdown_flag)
 			break;
 
 		// Grab the commands
-		DrawerCommandQueuePtr list = active_commands[thread->current_queue];
+		DrawerCommandQueuePtr list = active_commands[thread->current_queue % MaxActiveQueues];
 		thread->current_queue++;
 		thread->numa_start_y = thread->numa_node * screen->GetHeight() / thread->num_numa_nodes;
 		thread->numa_end_y = (thread->numa_node + 1) * screen->GetHeight() / thread->num_numa_nodes;
@@ -144,7 +208,6 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 			thread->poly->numa_start_y = thread->numa_start_y;
 			thread->poly->numa_end_y = thread->numa_end_y;
 		}
-		start_lock.unlock();
 
 		// Do the work:
 		if (r_debug_draw)
@@ -163,14 +226,15 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 				command->Execute(thread);
 			}
 		}
+		list.reset();
 
 		// Notify main thread that we finished:
-		std::unique_lock<std::mutex> end_lock(end_mutex);
-		tasks_left--;
-		bool finishedTasks = tasks_left == 0;
-		end_lock.unlock();
-		if (finishedTasks)
+		if (tasks_left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::unique_lock<std::mutex> end_lock(end_mutex);
+			end_lock.unlock();
 			end_condition.notify_all();
+		}
 	}
 }
 
@@ -203,9 +267,13 @@ void DrawerThreads::StartThreads()
 
 	if (num_threads != (int)threads.size())
 	{
+		// The old workers must be done with everything that was submitted to them
+		WaitForTasks();
 		StopThreads();
 
 		threads.resize(num_threads);
+		for (auto &thread : threads)
+			thread.current_queue = submitted_queues.load();
 
 		if (num_threads == num_numathreads)
 		{
@@ -270,10 +338,28 @@ void *DrawerCommandQueue::AllocMemory(size_t size)
 
 void GroupMemoryBarrierCommand::Execute(DrawerThread *thread)
 {
+	size_t num_cores = (size_t)thread->num_cores;
+	if (++count >= num_cores)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (parked)
+		{
+			lock.unlock();
+			condition.notify_all();
+		}
+		return;
+	}
+
+	for (int i = 0; i < SpinCount; i++)
+	{
+		if (count.load() >= num_cores)
+			return;
+		SpinPause();
+	}
+
 	std::unique_lock<std::mutex> lock(mutex);
-	count++;
-	condition.notify_all();
-	condition.wait(lock, [&]() { return count >= (size_t)thread->num_cores; });
+	parked = true;
+	condition.wait(lock, [&]() { return count.load() >= num_cores; });
 }
 
 /////////////////////////////////////////////////////////////////////////////
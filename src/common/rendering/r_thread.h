@@ -26,6 +26,7 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include "templates.h"
 #include "c_cvars.h"
@@ -121,9 +122,12 @@ public:
 	void Execute(DrawerThread *thread);
 
 private:
+	std::atomic<size_t> count{};
+
+	// Only used once spinning did not get all threads past the fence
 	std::mutex mutex;
 	std::condition_variable condition;
-	size_t count = 0;
+	bool parked = false;
 };
 
 // Copy finished rows to video memory
@@ -164,20 +168,32 @@ private:
 	void StartThreads();
 	void StopThreads();
 	void WorkerMain(DrawerThread *thread);
+	void WaitForTasks();
+	void CollectQueues();
 
 	static DrawerThreads *Instance();
 	
 	std::mutex threads_mutex;
 	std::vector<DrawerThread> threads;
 
+	// Ring of submitted queues which the workers read without taking any lock. Each worker walks through all of them.
+	// The slots get released by WaitForWorkers once every worker is done with them.
+	// Several scene threads may submit at the same time, so the producer side is serialized by submit_mutex.
+	enum { MaxActiveQueues = 256 };
+	DrawerCommandQueuePtr active_commands[MaxActiveQueues];
+	std::atomic<size_t> submitted_queues{};
+	size_t collected_queues = 0;
+	std::mutex submit_mutex;
+	std::atomic<bool> shutdown_flag{};
+
+	// Workers spin for a short while before they park on the condition
 	std::mutex start_mutex;
 	std::condition_variable start_condition;
-	std::vector<DrawerCommandQueuePtr> active_commands;
-	bool shutdown_flag = false;
+	std::atomic<int> parked_workers{};
 
 	std::mutex end_mutex;
 	std::condition_variable end_condition;
-	size_t tasks_left = 0;
+	std::atomic<size_t> tasks_left{};
 
 	size_t debug_draw_end = 0;
 
@@ -168,6 +168,28 @@ CUSTOM_CVAR(Bool, vid_cropaspect, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 	setsizeneeded = true;
 }
 
+// Dynamic resolution: lowers the scale factor when frames take longer than the target
+// frame rate allows and raises it again when there is enough headroom. This measures
+// the time the frame takes on the CPU side, including the buffer swap, so it works
+// best with vsync off and vid_maxfps set to the target.
+static float DynamicScale = 1.f;
+
+CUSTOM_CVAR(Int, vid_dynamicres, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// target frame rate, 0 = off
+{
+	if (self < 0) self = 0;
+	if (DynamicScale != 1.f)
+	{
+		DynamicScale = 1.f;
+		setsizeneeded = true;
+	}
+}
+
+CUSTOM_CVAR(Float, vid_dynamicres_min, 0.5f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0.25f) self = 0.25f;
+	else if (self > 1.f) self = 1.f;
+}
+
 bool ViewportLinearScale()
 {
 	if (isOutOfBounds(vid_scalemode))
@@ -179,6 +201,9 @@ bool ViewportLinearScale()
 		aspectmult = 1.f / aspectmult;
 	if ((ViewportScaledWidth(x,y) > (x * aspectmult)) || (ViewportScaledHeight(x,y) > (y * aspectmult)))
 		return true;
+	// nearest neighbor looks bad with a constantly changing resolution
+	if (DynamicScale < 1.f)
+		return true;
 	
 	return vid_scale_linear;
 }
@@ -193,7 +218,7 @@ int ViewportScaledWidth(int width, int height)
 		width = ((float)width/height > ActiveRatio(width, height)) ? (int)(height * ActiveRatio(width, height)) : width;
 		height = ((float)width/height < ActiveRatio(width, height)) ? (int)(width / ActiveRatio(width, height)) : height;
 	}
-	return (int)std::max((int32_t)min_width, (int32_t)(vid_scalefactor * vScaleTable[vid_scalemode].GetScaledWidth(width, height)));
+	return (int)std::max((int32_t)min_width, (int32_t)(vid_scalefactor * DynamicScale * vScaleTable[vid_scalemode].GetScaledWidth(width, height)));
 }
 
 int ViewportScaledHeight(int width, int height)
@@ -205,7 +230,7 @@ int ViewportScaledHeight(int width, int height)
 		height = ((float)width/height < ActiveRatio(width, height)) ? (int)(width / ActiveRatio(width, height)) : height;
 		width = ((float)width/height > ActiveRatio(width, height)) ? (int)(height * ActiveRatio(width, height)) : width;
 	}
-	return (int)std::max((int32_t)min_height, (int32_t)(vid_scalefactor * vScaleTable[vid_scalemode].GetScaledHeight(width, height)));
+	return (int)std::max((int32_t)min_height, (int32_t)(vid_scalefactor * DynamicScale * vScaleTable[vid_scalemode].GetScaledHeight(width, height)));
 }
 
 float ViewportPixelAspect()
@@ -218,10 +243,48 @@ float ViewportPixelAspect()
 	return vScaleTable[vid_scalemode].pixelAspect;
 }
 
+//==========================================================================
+//
+// Adjusts the dynamic resolution scale. Negative frame times indicate
+// frames that should not be measured, like wipes or loading screens.
+//
+// Every change reallocates the scene buffers, so it only steps in
+// coarse increments and waits for the frame time to settle in between.
+//
+//==========================================================================
+
+void R_UpdateDynamicResolution(double frametime)
+{
+	static double average;
+	static int frames;
+
+	if (vid_dynamicres <= 0 || frametime < 0 || frametime > 250)
+	{
+		frames = 0;
+		return;
+	}
+
+	average = frames == 0 ? frametime : average * 0.95 + frametime * 0.05;
+	if (++frames < 60) return;
+
+	double target = 1000. / vid_dynamicres;
+	float newscale = DynamicScale;
+	if (average > target * 1.05) newscale = std::max<float>(vid_dynamicres_min, DynamicScale - 0.1f);
+	else if (average < target * 0.75) newscale = std::min(1.f, DynamicScale + 0.1f);
+
+	if (newscale != DynamicScale)
+	{
+		DynamicScale = newscale;
+		setsizeneeded = true;
+		frames = 0;
+	}
+}
+
 void R_ShowCurrentScaling()
 {
 	int x1 = screen->GetClientWidth(), y1 = screen->GetClientHeight(), x2 = ViewportScaledWidth(x1, y1), y2 = ViewportScaledHeight(x1, y1);
 	Printf("Current vid_scalefactor: %f\n", (float)(vid_scalefactor));
+	if (vid_dynamicres > 0) Printf("Current dynamic resolution scale: %f\n", DynamicScale);
 	Printf("Real resolution: %i x %i\nEmulated resolution: %i x %i\n", x1, y1, x2, y2);
 }
 
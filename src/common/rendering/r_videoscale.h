@@ -37,4 +37,5 @@ bool ViewportLinearScale();
 int ViewportScaledWidth(int width, int height);
 int ViewportScaledHeight(int width, int height);
 float ViewportPixelAspect();
+void R_UpdateDynamicResolution(double frametime);
 #endif //__VIDEOSCALE_H__
\ No newline at end of file
@@ -50,6 +50,8 @@
 #include "flatvertices.h"
 #include "version.h"
 #include "hw_material.h"
+#include "stats.h"
+#include "templates.h"
 
 #include <chrono>
 #include <thread>
@@ -58,7 +60,9 @@
 CVAR(Bool, gl_scale_viewport, true, CVAR_ARCHIVE);
 
 EXTERN_CVAR(Int, vid_maxfps)
+EXTERN_CVAR(Int, i_spinmargin)
 CVAR(Bool, cl_capfps, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVARD(Bool, vid_lowlatencylimit, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "apply the frame rate limit before input gets read instead of right before presenting a finished frame")
 EXTERN_CVAR(Int, screenblocks)
 
 //==========================================================================
@@ -245,38 +249,50 @@ void DFrameBuffer::ScaleCoordsFromWindow(int16_t &x, int16_t &y)
 	y = int16_t((y - letterboxY) * Height / letterboxHeight);
 }
 
-void DFrameBuffer::FPSLimit()
+//==========================================================================
+//
+// The backends call this right before presenting a frame. With
+// vid_lowlatencylimit the wait happens at the start of the next frame
+// instead, so that a finished frame is not held back and the following
+// one gets built from input and timing that was sampled after the wait.
+//
+//==========================================================================
+
+// Lateness of the recent limiter wakeups, for the fpslimit stat.
+static int64_t PacingError[64];
+static unsigned PacingErrorPos;
+
+ADD_STAT(fpslimit)
+{
+	unsigned count = MIN<unsigned>(PacingErrorPos, countof(PacingError));
+	int64_t total = 0, worst = 0;
+	for (unsigned i = 0; i < count; i++)
+	{
+		total += PacingError[i];
+		worst = MAX(worst, PacingError[i]);
+	}
+	FString out;
+	out.Format("pacing error: avg=%lld us  max=%lld us  (spin margin %d us)", count ? (long long)(total / count) : 0ll, (long long)worst, *i_spinmargin);
+	return out;
+}
+
+void DFrameBuffer::FPSLimit(bool framestart)
 {
 	using namespace std::chrono;
-	using namespace std::this_thread;
 
-	if (vid_maxfps <= 0 || cl_capfps)
+	if (vid_maxfps <= 0 || cl_capfps || framestart != vid_lowlatencylimit)
 		return;
 
 	uint64_t targetWakeTime = fpsLimitTime + 1'000'000 / vid_maxfps;
+	uint64_t now = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
 
-	while (true)
+	if (targetWakeTime > now && targetWakeTime - now <= 1'000'000)
 	{
-		fpsLimitTime = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
-		int64_t timeToWait = targetWakeTime - fpsLimitTime;
-
-		if (timeToWait > 1'000'000 || timeToWait <= 0)
-		{
-			break;
-		}
-
-		if (timeToWait <= 2'000)
-		{
-			// We are too close to the deadline. OS sleep is not precise enough to wake us before it elapses.
-			// Yield execution and check time again.
-			sleep_for(nanoseconds(0));
-		}
-		else
-		{
-			// Sleep, but try to wake before deadline.
-			sleep_for(microseconds(timeToWait - 2'000));
-		}
+		I_WaitUntilUS(targetWakeTime);
+		now = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+		PacingError[PacingErrorPos++ % countof(PacingError)] = now - targetWakeTime;
 	}
+	fpsLimitTime = now;
 }
 
 FMaterial* DFrameBuffer::CreateMaterial(FGameTexture* tex, int scaleflags)
@@ -234,6 +234,9 @@ public:
 	virtual void SetSaveBuffers(bool yes) {}
 	virtual void ImageTransitionScene(bool unknown) {}
 	virtual void CopyScreenToBuffer(int width, int height, uint8_t* buffer)	{ memset(buffer, 0, width* height); }
+	// Asynchronous copies of the scene's depth buffer, scaled down to the given size. Used for occlusion culling.
+	virtual bool StartSceneDepthReadback(int width, int height) { return false; }
+	virtual bool FinishSceneDepthReadback(TArray<float> &depth) { return false; }
 	virtual bool FlipSavePic() const { return false; }
 	virtual void RenderTextureView(FCanvasTexture* tex, std::function<void(IntRect&)> renderFunc) {}
 	virtual void SetActiveRenderTarget() {}
@@ -252,7 +255,10 @@ public:
 	int ScreenToWindowX(int x);
 	int ScreenToWindowY(int y);
 
-	void FPSLimit();
+	void FPSLimit(bool framestart = false);
+
+	// Called at the start of each frame, before any input gets read. Backends that can tell how long the frame may start late and still make it to the screen in time can wait here.
+	virtual void WaitForFrameStart() {}
 
 	// Retrieves a buffer containing image data for a screenshot.
 	// Hint: Pitch can be negative for upside-down images, in which case buffer
@@ -39,6 +39,7 @@
 #include "templates.h"
 
 EXTERN_CVAR(Int, gl_dither_bpc)
+EXTERN_CVAR(Bool, vk_submit_passes)
 
 VkPostprocess::VkPostprocess()
 {
@@ -293,6 +294,9 @@ void VkPostprocess::UpdateShadowMap()
 		imageTransition.execute(fb->GetDrawCommands());
 
 		screen->mShadowMap.FinishUpdate();
+
+		// Let the GPU trace the shadow maps while the scene is still being processed.
+		if (vk_submit_passes) fb->FlushCommands(false);
 	}
 }
 
@@ -773,7 +777,7 @@ void VkPPRenderPassSetup::CreatePipeline(const VkPPRenderPassKey &key)
 	builder.setRasterizationSamples(key.Samples);
 	builder.setLayout(PipelineLayout.get());
 	builder.setRenderPass(RenderPass.get());
-	Pipeline = builder.create(GetVulkanFrameBuffer()->device);
+	Pipeline = builder.create(GetVulkanFrameBuffer()->device, GetVulkanFrameBuffer()->GetRenderPassManager()->GetPipelineCache());
 	Pipeline->SetDebugName("VkPPRenderPassSetup.Pipeline");
 }
 
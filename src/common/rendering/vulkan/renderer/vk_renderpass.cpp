@@ -31,6 +31,16 @@
 #include "flatvertices.h"
 #include "hw_viewpointuniforms.h"
 #include "v_2ddrawer.h"
+#include "i_specialpaths.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "m_crc32.h"
+#include "printf.h"
+#include "i_time.h"
+
+static const char *PipelineCacheMagic = "ZVPC";
+static const uint32_t PipelineCacheVersion = 1;
+static const uint32_t MaxKnownPipelines = 4096;
 
 VkRenderPassManager::VkRenderPassManager()
 {
@@ -47,6 +57,7 @@ void VkRenderPassManager::Init()
 	CreateDescriptorPool();
 	CreateDynamicSet();
 	CreateNullTexture();
+	CreatePipelineCache();
 }
 
 void VkRenderPassManager::RenderBuffersReset()
@@ -75,7 +86,10 @@ VkRenderPassSetup *VkRenderPassManager::GetRenderPass(const VkRenderPassKey &key
 {
 	auto &item = RenderPassSetup[key];
 	if (!item)
+	{
 		item.reset(new VkRenderPassSetup(key));
+		PrewarmPipelines(item.get());
+	}
 	return item.get();
 }
 
@@ -134,8 +148,228 @@ void VkRenderPassManager::CreateDynamicSetLayout()
 	DynamicSetLayout->SetDebugName("VkRenderPassManager.DynamicSetLayout");
 }
 
+//==========================================================================
+//
+// Pipeline cache
+//
+// The file stores the driver's pipeline cache blob plus the list of all
+// pipeline keys that have been created so far. Both are only valid for the
+// exact device and driver that wrote them.
+//
+//==========================================================================
+
+static FString CreatePipelineCacheName(bool create)
+{
+	FString path = M_GetCachePath(create);
+	if (create) CreatePath(path);
+	path << "/vkpipelinecache.zdpc";
+	return path;
+}
+
+static void GetPipelineCacheHeader(VulkanDevice *device, uint32_t *header)
+{
+	const auto &props = device->PhysicalDevice.Properties;
+	header[0] = PipelineCacheVersion;
+	header[1] = (uint32_t)(sizeof(VkRenderPassKey) | (sizeof(VkPipelineKey) << 16));
+	header[2] = props.vendorID;
+	header[3] = props.deviceID;
+	header[4] = props.driverVersion;
+}
+
+template<class T>
+static void AppendData(TArray<uint8_t> &out, const T &value)
+{
+	const uint8_t *p = (const uint8_t *)&value;
+	for (size_t i = 0; i < sizeof(T); i++)
+		out.Push(p[i]);
+}
+
+template<class T>
+static bool ExtractData(const TArray<uint8_t> &in, unsigned &pos, T &value)
+{
+	if (pos + sizeof(T) > in.Size())
+		return false;
+	memcpy(&value, &in[pos], sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+bool VkRenderPassManager::ReadPipelineCacheFile(TArray<uint8_t> &data)
+{
+	FileReader fr;
+	if (!fr.OpenFile(CreatePipelineCacheName(false)))
+		return false;
+
+	char magic[4];
+	uint32_t header[5], fileheader[5];
+	uint8_t uuid[VK_UUID_SIZE];
+	auto device = GetVulkanFrameBuffer()->device;
+	GetPipelineCacheHeader(device, header);
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, PipelineCacheMagic, 4) != 0)
+		return false;
+	if (fr.Read(fileheader, sizeof(fileheader)) != sizeof(fileheader) || memcmp(header, fileheader, sizeof(header)) != 0)
+		return false;
+	if (fr.Read(uuid, VK_UUID_SIZE) != VK_UUID_SIZE || memcmp(uuid, device->PhysicalDevice.Properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		return false;
+
+	uint32_t crc = fr.ReadUInt32();
+	uint32_t size = fr.ReadUInt32();
+	if (size > 256 * 1024 * 1024)
+		return false;
+
+	TArray<uint8_t> payload(size, true);
+	if (fr.Read(payload.Data(), size) != size || CalcCRC32(payload.Data(), size) != crc)
+		return false;
+
+	unsigned pos = 0;
+	uint32_t blobsize;
+	if (!ExtractData(payload, pos, blobsize) || pos + blobsize > payload.Size())
+		return false;
+	data.Resize(blobsize);
+	if (blobsize > 0) memcpy(data.Data(), &payload[pos], blobsize);
+	pos += blobsize;
+
+	uint32_t count;
+	if (!ExtractData(payload, pos, count) || count > MaxKnownPipelines)
+		return false;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		VkRenderPassKey passKey;
+		VkPipelineKey pipelineKey;
+		int32_t numBindingPoints;
+		uint32_t stride, numAttrs;
+		FVertexBufferAttribute attrs[VATTR_MAX];
+
+		if (!ExtractData(payload, pos, passKey) || !ExtractData(payload, pos, pipelineKey) ||
+			!ExtractData(payload, pos, numBindingPoints) || !ExtractData(payload, pos, stride) || !ExtractData(payload, pos, numAttrs) || numAttrs > VATTR_MAX)
+			return false;
+
+		for (uint32_t j = 0; j < numAttrs; j++)
+		{
+			if (!ExtractData(payload, pos, attrs[j]))
+				return false;
+		}
+
+		// Vertex format indices depend on the order in which the formats got registered, so they must be remapped for this session.
+		pipelineKey.VertexFormat = GetVertexFormat(numBindingPoints, numAttrs, stride, attrs);
+		KnownPipelines.insert({ passKey, pipelineKey });
+	}
+	return true;
+}
+
+void VkRenderPassManager::CreatePipelineCache()
+{
+	TArray<uint8_t> data;
+	if (!ReadPipelineCacheFile(data))
+	{
+		data.Clear();
+		KnownPipelines.clear();
+	}
+
+	auto fb = GetVulkanFrameBuffer();
+	PipelineCacheBuilder builder;
+	builder.setInitialData(data.Data(), data.Size());
+	try
+	{
+		PipelineCache = builder.create(fb->device);
+	}
+	catch (...)
+	{
+		// Some drivers fail instead of ignoring data they do not like. Start over with an empty cache then.
+		KnownPipelines.clear();
+		PipelineCacheBuilder emptybuilder;
+		PipelineCache = emptybuilder.create(fb->device);
+	}
+	PipelineCache->SetDebugName("VkRenderPassManager.PipelineCache");
+}
+
+void VkRenderPassManager::SavePipelineCache()
+{
+	if (!PipelineCache)
+		return;
+
+	std::vector<uint8_t> blob;
+	try
+	{
+		blob = PipelineCache->getData();
+	}
+	catch (...)
+	{
+		return;
+	}
+
+	TArray<uint8_t> payload;
+	AppendData(payload, (uint32_t)blob.size());
+	for (uint8_t b : blob)
+		payload.Push(b);
+
+	AppendData(payload, (uint32_t)KnownPipelines.size());
+	for (const auto &it : KnownPipelines)
+	{
+		const VkVertexFormat &vfmt = VertexFormats[it.second.VertexFormat];
+		AppendData(payload, it.first);
+		AppendData(payload, it.second);
+		AppendData(payload, (int32_t)vfmt.NumBindingPoints);
+		AppendData(payload, (uint32_t)vfmt.Stride);
+		AppendData(payload, (uint32_t)vfmt.Attrs.size());
+		for (const auto &attr : vfmt.Attrs)
+			AppendData(payload, attr);
+	}
+
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(CreatePipelineCacheName(true)));
+	if (fw)
+	{
+		// This runs during shutdown when the global screen pointer may already be gone.
+		auto device = PipelineCache->device;
+		uint32_t header[5];
+		GetPipelineCacheHeader(device, header);
+		uint32_t crc = CalcCRC32(payload.Data(), payload.Size());
+		uint32_t size = payload.Size();
+		fw->Write(PipelineCacheMagic, 4);
+		fw->Write(header, sizeof(header));
+		fw->Write(device->PhysicalDevice.Properties.pipelineCacheUUID, VK_UUID_SIZE);
+		fw->Write(&crc, sizeof(uint32_t));
+		fw->Write(&size, sizeof(uint32_t));
+		fw->Write(payload.Data(), payload.Size());
+	}
+}
+
+void VkRenderPassManager::AddKnownPipeline(const VkRenderPassKey &passKey, const VkPipelineKey &pipelineKey)
+{
+	std::lock_guard<std::recursive_mutex> lock(Lock);
+	if (KnownPipelines.size() < MaxKnownPipelines)
+		KnownPipelines.insert({ passKey, pipelineKey });
+}
+
+//==========================================================================
+//
+// Creates all pipelines that an earlier session used with this render pass.
+// With a warm driver cache this is a cheap lookup per pipeline, and doing it
+// here keeps the cost out of the frames that first use them.
+//
+//==========================================================================
+
+void VkRenderPassManager::PrewarmPipelines(VkRenderPassSetup *setup)
+{
+	int count = 0;
+	uint64_t start = I_msTime();
+	for (const auto &it : KnownPipelines)
+	{
+		// Custom shaders may have changed since the cache was written.
+		if (it.first == setup->PassKey && setup->GetProgram(it.second))
+		{
+			setup->GetPipeline(it.second);
+			count++;
+		}
+	}
+	if (count > 0)
+		DPrintf(DMSG_NOTIFY, "Created %d cached pipelines in %d ms\n", count, (int)(I_msTime() - start));
+}
+
 VulkanDescriptorSetLayout *VkRenderPassManager::GetTextureSetLayout(int numLayers)
 {
+	std::lock_guard<std::recursive_mutex> lock(Lock);
 	if (TextureSetLayouts.size() < (size_t)numLayers)
 		TextureSetLayouts.resize(numLayers);
 
@@ -155,6 +389,7 @@ VulkanDescriptorSetLayout *VkRenderPassManager::GetTextureSetLayout(int numLayer
 
 VulkanPipelineLayout* VkRenderPassManager::GetPipelineLayout(int numLayers)
 {
+	std::lock_guard<std::recursive_mutex> lock(Lock);
 	if (PipelineLayouts.size() <= (size_t)numLayers)
 		PipelineLayouts.resize(numLayers + 1);
 
@@ -213,6 +448,7 @@ void VkRenderPassManager::CreateNullTexture()
 
 VulkanDescriptorSet* VkRenderPassManager::GetNullTextureDescriptorSet()
 {
+	std::lock_guard<std::recursive_mutex> lock(Lock);
 	if (!NullTextureDescriptorSet)
 	{
 		NullTextureDescriptorSet = AllocateTextureDescriptorSet(SHADER_MIN_REQUIRED_TEXTURE_LAYERS);
@@ -254,6 +490,7 @@ void VkRenderPassManager::UpdateDynamicSet()
 
 std::unique_ptr<VulkanDescriptorSet> VkRenderPassManager::AllocateTextureDescriptorSet(int numLayers)
 {
+	std::lock_guard<std::recursive_mutex> lock(Lock);
 	if (TextureDescriptorSetsLeft == 0 || TextureDescriptorsLeft < numLayers)
 	{
 		TextureDescriptorSetsLeft = 1000;
@@ -339,26 +576,32 @@ VulkanRenderPass *VkRenderPassSetup::GetRenderPass(int clearTargets)
 
 VulkanPipeline *VkRenderPassSetup::GetPipeline(const VkPipelineKey &key)
 {
+	std::lock_guard<std::mutex> lock(PipelineLock);
 	auto &item = Pipelines[key];
 	if (!item)
 		item = CreatePipeline(key);
 	return item.get();
 }
 
-std::unique_ptr<VulkanPipeline> VkRenderPassSetup::CreatePipeline(const VkPipelineKey &key)
+VkShaderProgram *VkRenderPassSetup::GetProgram(const VkPipelineKey &key)
 {
 	auto fb = GetVulkanFrameBuffer();
-	GraphicsPipelineBuilder builder;
-
-	VkShaderProgram *program;
 	if (key.SpecialEffect != EFF_NONE)
 	{
-		program = fb->GetShaderManager()->GetEffect(key.SpecialEffect, PassKey.DrawBuffers > 1 ? GBUFFER_PASS : NORMAL_PASS);
+		return fb->GetShaderManager()->GetEffect(key.SpecialEffect, PassKey.DrawBuffers > 1 ? GBUFFER_PASS : NORMAL_PASS);
 	}
 	else
 	{
-		program = fb->GetShaderManager()->Get(key.EffectState, key.AlphaTest, PassKey.DrawBuffers > 1 ? GBUFFER_PASS : NORMAL_PASS);
+		return fb->GetShaderManager()->Get(key.EffectState, key.AlphaTest, PassKey.DrawBuffers > 1 ? GBUFFER_PASS : NORMAL_PASS);
 	}
+}
+
+std::unique_ptr<VulkanPipeline> VkRenderPassSetup::CreatePipeline(const VkPipelineKey &key)
+{
+	auto fb = GetVulkanFrameBuffer();
+	GraphicsPipelineBuilder builder;
+
+	VkShaderProgram *program = GetProgram(key);
 	builder.addVertexShader(program->vert.get());
 	builder.addFragmentShader(program->frag.get());
 
@@ -435,7 +678,8 @@ std::unique_ptr<VulkanPipeline> VkRenderPassSetup::CreatePipeline(const VkPipeli
 
 	builder.setLayout(fb->GetRenderPassManager()->GetPipelineLayout(key.NumTextureLayers));
 	builder.setRenderPass(GetRenderPass(0));
-	auto pipeline = builder.create(fb->device);
+	auto pipeline = builder.create(fb->device, fb->GetRenderPassManager()->GetPipelineCache());
 	pipeline->SetDebugName("VkRenderPassSetup.Pipeline");
+	fb->GetRenderPassManager()->AddKnownPipeline(PassKey, key);
 	return pipeline;
 }
@@ -7,8 +7,11 @@
 #include "hw_renderstate.h"
 #include <string.h>
 #include <map>
+#include <set>
+#include <mutex>
 
 class VKDataBuffer;
+class VkShaderProgram;
 
 class VkPipelineKey
 {
@@ -55,6 +58,7 @@ public:
 
 	VulkanRenderPass *GetRenderPass(int clearTargets);
 	VulkanPipeline *GetPipeline(const VkPipelineKey &key);
+	VkShaderProgram *GetProgram(const VkPipelineKey &key);
 
 	VkRenderPassKey PassKey;
 	std::unique_ptr<VulkanRenderPass> RenderPasses[8];
@@ -63,6 +67,8 @@ public:
 private:
 	std::unique_ptr<VulkanRenderPass> CreateRenderPass(int clearTargets);
 	std::unique_ptr<VulkanPipeline> CreatePipeline(const VkPipelineKey &key);
+
+	std::mutex PipelineLock;	// pipelines get created on demand, possibly by several recording threads at once.
 };
 
 class VkVertexFormat
@@ -96,6 +102,10 @@ public:
 	VulkanDescriptorSet* GetNullTextureDescriptorSet();
 	VulkanImageView* GetNullTextureView();
 
+	VulkanPipelineCache *GetPipelineCache() { return PipelineCache.get(); }
+	void AddKnownPipeline(const VkRenderPassKey &passKey, const VkPipelineKey &pipelineKey);
+	void SavePipelineCache();
+
 	std::unique_ptr<VulkanDescriptorSetLayout> DynamicSetLayout;
 	std::map<VkRenderPassKey, std::unique_ptr<VkRenderPassSetup>> RenderPassSetup;
 
@@ -106,9 +116,15 @@ private:
 	void CreateDescriptorPool();
 	void CreateDynamicSet();
 	void CreateNullTexture();
+	void CreatePipelineCache();
+	bool ReadPipelineCacheFile(TArray<uint8_t> &data);
+	void PrewarmPipelines(VkRenderPassSetup *setup);
 
 	VulkanDescriptorSetLayout *GetTextureSetLayout(int numLayers);
 
+	// Guards everything that gets created on demand while recording, which may happen on several threads.
+	std::recursive_mutex Lock;
+
 	int TextureDescriptorSetsLeft = 0;
 	int TextureDescriptorsLeft = 0;
 	std::vector<std::unique_ptr<VulkanDescriptorPool>> TextureDescriptorPools;
@@ -120,4 +136,9 @@ private:
 	std::unique_ptr<VulkanImage> NullTexture;
 	std::unique_ptr<VulkanImageView> NullTextureView;
 	std::unique_ptr<VulkanDescriptorSet> NullTextureDescriptorSet;
+
+	// Persisted across sessions so that pipelines seen in an earlier run can be recreated from the driver's cache
+	// as soon as their render pass shows up, instead of on first use in the middle of a frame.
+	std::unique_ptr<VulkanPipelineCache> PipelineCache;
+	std::set<std::pair<VkRenderPassKey, VkPipelineKey>> KnownPipelines;
 };
@@ -35,8 +35,19 @@
 #include "flatvertices.h"
 #include "hwrenderer/data/hw_viewpointbuffer.h"
 #include "hwrenderer/data/shaderuniforms.h"
+#include "ctpl.h"
+#include <thread>
 
 CVAR(Int, vk_submit_size, 1000, 0);
+CVARD(Int, vk_recording_threads, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "number of threads recording the opaque geometry, 0 picks one for the CPU and 1 records everything on the main thread")
+
+enum
+{
+	MAX_RECORDING_THREADS = 8,
+	MIN_ITEMS_PER_THREAD = 200,		// below that the extra render pass and thread handoff cost more than they save.
+};
+
+static ctpl::thread_pool RecordingPool;
 
 VkRenderState::VkRenderState()
 {
@@ -55,6 +66,8 @@ void VkRenderState::Draw(int dt, int index, int count, bool apply)
 {
 	if (apply || mNeedApply)
 		Apply(dt);
+	if (mWorkerFailed)
+		return;
 
 	mCommandBuffer->draw(count, 1, index, 0);
 }
@@ -63,6 +76,8 @@ void VkRenderState::DrawIndexed(int dt, int index, int count, bool apply)
 {
 	if (apply || mNeedApply)
 		Apply(dt);
+	if (mWorkerFailed)
+		return;
 
 	mCommandBuffer->drawIndexed(count, 1, index, 0, 0);
 }
@@ -176,6 +191,14 @@ void VkRenderState::EnableLineSmooth(bool on)
 
 void VkRenderState::Apply(int dt)
 {
+	// Workers run concurrently with each other, so they must neither submit nor touch the stat clocks.
+	if (mIsWorker)
+	{
+		if (!mWorkerFailed)
+			ApplyState(dt);
+		return;
+	}
+
 	drawcalls.Clock();
 
 	mApplyCount++;
@@ -185,6 +208,13 @@ void VkRenderState::Apply(int dt)
 		mApplyCount = 0;
 	}
 
+	ApplyState(dt);
+
+	drawcalls.Unclock();
+}
+
+void VkRenderState::ApplyState(int dt)
+{
 	ApplyStreamData();
 	ApplyMatrices();
 	ApplyRenderPass(dt);
@@ -197,8 +227,6 @@ void VkRenderState::Apply(int dt)
 	ApplyDynamicSet();
 	ApplyMaterial();
 	mNeedApply = false;
-
-	drawcalls.Unclock();
 }
 
 void VkRenderState::ApplyDepthBias()
@@ -260,6 +288,7 @@ void VkRenderState::ApplyRenderPass(int dt)
 	if (changingPipeline)
 	{
 		mCommandBuffer->bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, mPassSetup->GetPipeline(pipelineKey));
+		mPipelineLayout = GetVulkanFrameBuffer()->GetRenderPassManager()->GetPipelineLayout(pipelineKey.NumTextureLayers);
 		mPipelineKey = pipelineKey;
 	}
 }
@@ -342,6 +371,11 @@ void VkRenderState::ApplyStreamData()
 
 	if (!mStreamBufferWriter.Write(mStreamData))
 	{
+		if (mIsWorker)
+		{
+			mWorkerFailed = true;
+			return;
+		}
 		WaitForStreamBuffers();
 		mStreamBufferWriter.Write(mStreamData);
 	}
@@ -390,15 +424,18 @@ void VkRenderState::ApplyPushConstants()
 	mPushConstants.uLightIndex = mLightIndex;
 	mPushConstants.uDataIndex = mStreamBufferWriter.DataIndex();
 
-	auto fb = GetVulkanFrameBuffer();
-	auto passManager = fb->GetRenderPassManager();
-	mCommandBuffer->pushConstants(passManager->GetPipelineLayout(mPipelineKey.NumTextureLayers), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, (uint32_t)sizeof(PushConstants), &mPushConstants);
+	mCommandBuffer->pushConstants(mPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, (uint32_t)sizeof(PushConstants), &mPushConstants);
 }
 
 void VkRenderState::ApplyMatrices()
 {
 	if (!mMatrixBufferWriter.Write(mModelMatrix, mModelMatrixEnabled, mTextureMatrix, mTextureMatrixEnabled))
 	{
+		if (mIsWorker)
+		{
+			mWorkerFailed = true;
+			return;
+		}
 		WaitForStreamBuffers();
 		mMatrixBufferWriter.Write(mModelMatrix, mModelMatrixEnabled, mTextureMatrix, mTextureMatrixEnabled);
 	}
@@ -436,7 +473,14 @@ void VkRenderState::ApplyMaterial()
 
 		VulkanDescriptorSet* descriptorset = mMaterial.mMaterial ? static_cast<VkMaterial*>(mMaterial.mMaterial)->GetDescriptorSet(mMaterial) : passManager->GetNullTextureDescriptorSet();
 
-		mCommandBuffer->bindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, passManager->GetPipelineLayout(mPipelineKey.NumTextureLayers), 1, descriptorset);
+		// SetMaterial flags a change even if the same material gets set again, which is the common case for consecutive walls and flats.
+		// Only rebind if the set is different or the pipeline layout has changed in a way that disturbed the binding.
+		if (descriptorset != mLastMaterialSet || mPipelineKey.NumTextureLayers != mLastMaterialLayers)
+		{
+			mCommandBuffer->bindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 1, descriptorset);
+			mLastMaterialSet = descriptorset;
+			mLastMaterialLayers = mPipelineKey.NumTextureLayers;
+		}
 		mMaterial.mChanged = false;
 	}
 }
@@ -451,7 +495,7 @@ void VkRenderState::ApplyDynamicSet()
 		auto passManager = fb->GetRenderPassManager();
 
 		uint32_t offsets[3] = { mViewpointOffset, matrixOffset, streamDataOffset };
-		mCommandBuffer->bindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, passManager->GetPipelineLayout(mPipelineKey.NumTextureLayers), 0, passManager->DynamicSet.get(), 3, offsets);
+		mCommandBuffer->bindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, passManager->DynamicSet.get(), 3, offsets);
 
 		mLastViewpointOffset = mViewpointOffset;
 		mLastMatricesOffset = matrixOffset;
@@ -493,6 +537,7 @@ void VkRenderState::EndRenderPass()
 		mLastViewpointOffset = 0xffffffff;
 		mLastVertexBuffer = nullptr;
 		mLastIndexBuffer = nullptr;
+		mLastMaterialSet = nullptr;
 		mLastModelMatrixEnabled = true;
 		mLastTextureMatrixEnabled = true;
 	}
@@ -525,7 +570,7 @@ void VkRenderState::SetRenderTarget(VkTextureImage *image, VulkanImageView *dept
 	mRenderTarget.Samples = samples;
 }
 
-void VkRenderState::BeginRenderPass(VulkanCommandBuffer *cmdbuffer)
+void VkRenderState::BeginRenderPass(VulkanCommandBuffer *cmdbuffer, VkSubpassContents contents)
 {
 	auto fb = GetVulkanFrameBuffer();
 
@@ -569,7 +614,12 @@ void VkRenderState::BeginRenderPass(VulkanCommandBuffer *cmdbuffer)
 	if (key.DrawBuffers > 2)
 		beginInfo.addClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	beginInfo.addClearDepthStencil(1.0f, 0);
-	cmdbuffer->beginRenderPass(beginInfo);
+	cmdbuffer->beginRenderPass(beginInfo, contents);
+
+	mInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	mInheritance.renderPass = beginInfo.renderPassInfo.renderPass;
+	mInheritance.subpass = 0;
+	mInheritance.framebuffer = beginInfo.renderPassInfo.framebuffer;
 
 	mMaterial.mChanged = true;
 	mClearTargets = 0;
@@ -577,6 +627,103 @@ void VkRenderState::BeginRenderPass(VulkanCommandBuffer *cmdbuffer)
 
 /////////////////////////////////////////////////////////////////////////////
 
+void VkRenderState::BeginWorker(VulkanCommandBuffer *cmdbuffer)
+{
+	mIsWorker = true;
+	mWorkerFailed = false;
+
+	// Secondary command buffers inherit no state at all from the primary one.
+	mCommandBuffer = cmdbuffer;
+	mPipelineKey = {};
+	mScissorChanged = true;
+	mViewportChanged = true;
+	mStencilRefChanged = true;
+	mBias.mChanged = true;
+	mMaterial.mChanged = true;
+	mNeedApply = true;
+
+	mLastViewpointOffset = 0xffffffff;
+	mLastVertexBuffer = nullptr;
+	mLastIndexBuffer = nullptr;
+	mLastMaterialSet = nullptr;
+
+	mStreamBufferWriter.StartBlock();
+}
+
+bool VkRenderState::DrawParallel(unsigned count, const std::function<void()> &prepare, const std::function<void(FRenderState &state, unsigned start, unsigned end)> &draw)
+{
+	int numthreads = vk_recording_threads > 0 ? *vk_recording_threads : MIN<int>(std::thread::hardware_concurrency(), 4);
+	int numshards = MIN<int>(MIN(numthreads, (int)MAX_RECORDING_THREADS), count / MIN_ITEMS_PER_THREAD);
+	if (numshards < 2 || mIsWorker || !mRenderTarget.Image)
+		return false;
+
+	prepare();
+
+	auto fb = GetVulkanFrameBuffer();
+	EndRenderPass();
+	VulkanCommandBuffer *primary = fb->GetDrawCommands();
+	BeginRenderPass(primary, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+	std::unique_ptr<VulkanCommandBuffer> commands[MAX_RECORDING_THREADS];
+	std::unique_ptr<VkRenderState> workers[MAX_RECORDING_THREADS];
+	for (int i = 0; i < numshards; i++)
+	{
+		commands[i] = fb->GetSecondaryCommandPool(i)->createBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+		commands[i]->begin(mInheritance);
+		workers[i] = CreateWorker();
+		workers[i]->BeginWorker(commands[i].get());
+	}
+
+	if ((int)RecordingPool.size() < numshards - 1) RecordingPool.resize(numshards - 1);
+	std::future<void> futures[MAX_RECORDING_THREADS];
+	for (int i = 1; i < numshards; i++)
+	{
+		futures[i] = RecordingPool.push([&, i](int) { draw(*workers[i], count * i / numshards, count * (i + 1) / numshards); });
+	}
+	draw(*workers[0], 0, count / numshards);
+	for (int i = 1; i < numshards; i++) futures[i].wait();
+	for (int i = 1; i < numshards; i++) futures[i].get();	// passes on exceptions once no thread uses the workers anymore.
+
+	bool failed = false;
+	VkCommandBuffer buffers[MAX_RECORDING_THREADS];
+	for (int i = 0; i < numshards; i++)
+	{
+		commands[i]->end();
+		buffers[i] = commands[i]->buffer;
+		failed |= workers[i]->mWorkerFailed;
+	}
+	if (!failed)
+		primary->executeCommands(numshards, buffers);
+	primary->endRenderPass();
+
+	// The primary buffer references them until the GPU is done with the frame.
+	for (int i = 0; i < numshards; i++)
+		fb->FrameDeleteList.CommandBuffers.push_back(std::move(commands[i]));
+
+	if (!failed)
+	{
+		// Continue with the state the last range left behind, just like a serial draw would.
+		VkRenderState::operator=(*workers[numshards - 1]);
+		mIsWorker = false;
+		mCommandBuffer = nullptr;
+		mPipelineKey = {};
+		mNeedApply = true;
+		mLastViewpointOffset = 0xffffffff;
+		mLastVertexBuffer = nullptr;
+		mLastIndexBuffer = nullptr;
+		mLastMaterialSet = nullptr;
+	}
+	else
+	{
+		// The stream buffers ran full. None of the recorded commands were used so draw everything again after the GPU caught up.
+		WaitForStreamBuffers();
+		draw(*this, 0, count);
+	}
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 void VkRenderStateMolten::Draw(int dt, int index, int count, bool apply)
 {
 	if (dt == DT_TriangleFan)
@@ -589,7 +736,8 @@ void VkRenderStateMolten::Draw(int dt, int index, int count, bool apply)
 		else
 			ApplyVertexBuffers();
 
-		mCommandBuffer->drawIndexed((count - 2) * 3, 1, 0, index, 0);
+		if (!mWorkerFailed)
+			mCommandBuffer->drawIndexed((count - 2) * 3, 1, 0, index, 0);
 
 		mIndexBuffer = oldIndexBuffer;
 	}
@@ -598,6 +746,7 @@ void VkRenderStateMolten::Draw(int dt, int index, int count, bool apply)
 		if (apply || mNeedApply)
 			Apply(dt);
 
-		mCommandBuffer->draw(count, 1, index, 0);
+		if (!mWorkerFailed)
+			mCommandBuffer->draw(count, 1, index, 0);
 	}
 }
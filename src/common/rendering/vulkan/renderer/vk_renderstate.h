@@ -42,6 +42,7 @@ public:
 	void EnableMultisampling(bool on) override;
 	void EnableLineSmooth(bool on) override;
 	void EnableDrawBuffers(int count, bool apply) override;
+	bool DrawParallel(unsigned count, const std::function<void()> &prepare, const std::function<void(FRenderState &state, unsigned start, unsigned end)> &draw) override;
 
 	void BeginFrame();
 	void SetRenderTarget(VkTextureImage *image, VulkanImageView *depthStencilView, int width, int height, VkFormat Format, VkSampleCountFlagBits samples);
@@ -50,7 +51,11 @@ public:
 	void EndFrame();
 
 protected:
+	virtual std::unique_ptr<VkRenderState> CreateWorker() { return std::make_unique<VkRenderState>(*this); }
+	void BeginWorker(VulkanCommandBuffer *cmdbuffer);
+
 	void Apply(int dt);
+	void ApplyState(int dt);
 	void ApplyRenderPass(int dt);
 	void ApplyStencilRef();
 	void ApplyDepthBias();
@@ -63,13 +68,15 @@ protected:
 	void ApplyVertexBuffers();
 	void ApplyMaterial();
 
-	void BeginRenderPass(VulkanCommandBuffer *cmdbuffer);
+	void BeginRenderPass(VulkanCommandBuffer *cmdbuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 	void WaitForStreamBuffers();
 
 	bool mDepthClamp = true;
 	VulkanCommandBuffer *mCommandBuffer = nullptr;
 	VkPipelineKey mPipelineKey = {};
 	VkRenderPassSetup *mPassSetup = nullptr;
+	VulkanPipelineLayout *mPipelineLayout = nullptr;
+	VkCommandBufferInheritanceInfo mInheritance = {};
 	int mClearTargets = 0;
 	bool mNeedApply = true;
 
@@ -103,12 +110,19 @@ protected:
 	int mLastVertexOffsets[2] = { 0, 0 };
 	IVertexBuffer *mLastVertexBuffer = nullptr;
 	IIndexBuffer *mLastIndexBuffer = nullptr;
+	VulkanDescriptorSet *mLastMaterialSet = nullptr;
+	int mLastMaterialLayers = 0;
 
 	bool mLastModelMatrixEnabled = true;
 	bool mLastTextureMatrixEnabled = true;
 
 	int mApplyCount = 0;
 
+	// Set for the copies that record into secondary command buffers. They cannot submit or wait for the GPU,
+	// so running out of stream buffer space marks them as failed and their commands get thrown away.
+	bool mIsWorker = false;
+	bool mWorkerFailed = false;
+
 	struct RenderTarget
 	{
 		VkTextureImage *Image = nullptr;
@@ -127,4 +141,7 @@ public:
 	using VkRenderState::VkRenderState;
 
 	void Draw(int dt, int index, int count, bool apply = true) override;
+
+protected:
+	std::unique_ptr<VkRenderState> CreateWorker() override { return std::make_unique<VkRenderStateMolten>(*this); }
 };
@@ -40,13 +40,14 @@ VkStreamBuffer::~VkStreamBuffer()
 
 uint32_t VkStreamBuffer::NextStreamDataBlock()
 {
-	mStreamDataOffset += mBlockSize;
-	if (mStreamDataOffset + (size_t)mBlockSize >= UniformBuffer->Size())
+	// Threaded recording has several writers on the same buffer so the block must be claimed in one step.
+	// Once full, the buffer stays full until the owner waited for the GPU and called Reset.
+	uint32_t offset = mStreamDataOffset.fetch_add(mBlockSize) + mBlockSize;
+	if (offset + (size_t)mBlockSize >= UniformBuffer->Size())
 	{
-		mStreamDataOffset = 0;
 		return 0xffffffff;
 	}
-	return mStreamDataOffset;
+	return offset;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,7 @@
 
 #include "vulkan/system/vk_buffers.h"
 #include "vulkan/shaders/vk_shader.h"
+#include <atomic>
 
 class VkStreamBuffer;
 class VkMatrixBuffer;
@@ -15,6 +16,9 @@ public:
 	bool Write(const StreamData& data);
 	void Reset();
 
+	// The next write claims a block of its own, so that writers on different threads never share one.
+	void StartBlock() { mDataIndex = MAX_STREAM_DATA - 1; }
+
 	uint32_t DataIndex() const { return mDataIndex; }
 	uint32_t StreamDataOffset() const { return mStreamDataOffset; }
 
@@ -54,5 +58,5 @@ public:
 
 private:
 	uint32_t mBlockSize = 0;
-	uint32_t mStreamDataOffset = 0;
+	std::atomic<uint32_t> mStreamDataOffset = { 0 };
 };
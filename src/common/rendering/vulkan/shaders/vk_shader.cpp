@@ -26,6 +26,7 @@
 #include "filesystem.h"
 #include "engineerrors.h"
 #include "version.h"
+#include "zonetrace.h"
 #include <ShaderLang.h>
 
 VkShaderManager::VkShaderManager(VulkanDevice *device) : device(device)
@@ -275,6 +276,7 @@ static const char *shaderBindings = R"(
 
 std::unique_ptr<VulkanShader> VkShaderManager::LoadVertShader(FString shadername, const char *vert_lump, const char *defines)
 {
+	TRACE_ZONE_ARG("ShaderCompile", shadername.GetChars());
 	FString code = GetTargetGlslVersion();
 	code << defines;
 	code << "\n#define MAX_STREAM_DATA " << std::to_string(MAX_STREAM_DATA).c_str() << "\n";
@@ -293,6 +295,7 @@ std::unique_ptr<VulkanShader> VkShaderManager::LoadVertShader(FString shadername
 
 std::unique_ptr<VulkanShader> VkShaderManager::LoadFragShader(FString shadername, const char *frag_lump, const char *material_lump, const char *light_lump, const char *defines, bool alphatest, bool gbufferpass)
 {
+	TRACE_ZONE_ARG("ShaderCompile", shadername.GetChars());
 	FString code = GetTargetGlslVersion();
 	code << defines;
 	code << "\n$placeholder$";	// here the code can later add more needed #defines.
@@ -43,6 +43,7 @@ public:
 	void setFormat(VkFormat format);
 	void setUsage(VkImageUsageFlags imageUsage, VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY, VmaAllocationCreateFlags allocFlags = 0);
 	void setMemoryType(VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, uint32_t memoryTypeBits = 0);
+	void setPool(VmaPool pool);
 	void setLinearTiling();
 
 	bool isFormatSupported(VulkanDevice *device);
@@ -175,6 +176,19 @@ private:
 	VkQueryPoolCreateInfo poolInfo = {};
 };
 
+class PipelineCacheBuilder
+{
+public:
+	PipelineCacheBuilder();
+
+	void setInitialData(const void *data, size_t size);
+
+	std::unique_ptr<VulkanPipelineCache> create(VulkanDevice *device);
+
+private:
+	VkPipelineCacheCreateInfo cacheInfo = {};
+};
+
 class FramebufferBuilder
 {
 public:
@@ -229,7 +243,7 @@ public:
 
 	void addDynamicState(VkDynamicState state);
 
-	std::unique_ptr<VulkanPipeline> create(VulkanDevice *device);
+	std::unique_ptr<VulkanPipeline> create(VulkanDevice *device, VulkanPipelineCache *cache = nullptr);
 
 private:
 	VkGraphicsPipelineCreateInfo pipelineInfo = { };
@@ -424,6 +438,11 @@ inline bool ImageBuilder::isFormatSupported(VulkanDevice *device)
 	return true;
 }
 
+inline void ImageBuilder::setPool(VmaPool pool)
+{
+	allocInfo.pool = pool;
+}
+
 inline std::unique_ptr<VulkanImage> ImageBuilder::create(VulkanDevice *device, VkDeviceSize* allocatedBytes)
 {
 	VkImage image;
@@ -707,6 +726,27 @@ inline std::unique_ptr<VulkanQueryPool> QueryPoolBuilder::create(VulkanDevice *d
 
 /////////////////////////////////////////////////////////////////////////////
 
+inline PipelineCacheBuilder::PipelineCacheBuilder()
+{
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+}
+
+inline void PipelineCacheBuilder::setInitialData(const void *data, size_t size)
+{
+	cacheInfo.pInitialData = data;
+	cacheInfo.initialDataSize = size;
+}
+
+inline std::unique_ptr<VulkanPipelineCache> PipelineCacheBuilder::create(VulkanDevice *device)
+{
+	VkPipelineCache pipelineCache;
+	VkResult result = vkCreatePipelineCache(device->device, &cacheInfo, nullptr, &pipelineCache);
+	CheckVulkanError(result, "Could not create pipeline cache");
+	return std::make_unique<VulkanPipelineCache>(device, pipelineCache);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 inline FramebufferBuilder::FramebufferBuilder()
 {
 	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -1030,10 +1070,10 @@ inline void GraphicsPipelineBuilder::addDynamicState(VkDynamicState state)
 	dynamicState.pDynamicStates = dynamicStates.data();
 }
 
-inline std::unique_ptr<VulkanPipeline> GraphicsPipelineBuilder::create(VulkanDevice *device)
+inline std::unique_ptr<VulkanPipeline> GraphicsPipelineBuilder::create(VulkanDevice *device, VulkanPipelineCache *cache)
 {
 	VkPipeline pipeline = 0;
-	VkResult result = vkCreateGraphicsPipelines(device->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+	VkResult result = vkCreateGraphicsPipelines(device->device, cache ? cache->cache : VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
 	CheckVulkanError(result, "Could not create graphics pipeline");
 	return std::make_unique<VulkanPipeline>(device, pipeline);
 }
@@ -223,6 +223,97 @@ void VulkanDevice::CreateAllocator()
 	allocinfo.preferredLargeHeapBlockSize = 64 * 1024 * 1024;
 	if (vmaCreateAllocator(&allocinfo, &allocator) != VK_SUCCESS)
 		VulkanError("Unable to create allocator");
+
+	CreateTexturePools();
+}
+
+//==========================================================================
+//
+// A texture can only go into a pool if its memory type is allowed for it,
+// so this checks that all formats the textures use agree on one.
+// Without pools the textures just use the allocator's default blocks.
+//
+//==========================================================================
+
+void VulkanDevice::CreateTexturePools()
+{
+	uint32_t typeBits = UINT32_MAX;
+	for (VkFormat format : { VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R8_UNORM })
+	{
+		VkImageCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		info.imageType = VK_IMAGE_TYPE_2D;
+		info.format = format;
+		info.extent = { 64, 64, 1 };
+		info.mipLevels = 7;
+		info.arrayLayers = 1;
+		info.samples = VK_SAMPLE_COUNT_1_BIT;
+		info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VkImage image;
+		if (vkCreateImage(device, &info, nullptr, &image) != VK_SUCCESS) return;
+		VkMemoryRequirements reqs;
+		vkGetImageMemoryRequirements(device, image, &reqs);
+		vkDestroyImage(device, image, nullptr);
+		typeBits &= reqs.memoryTypeBits;
+	}
+
+	VmaAllocationCreateInfo allocinfo = {};
+	allocinfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+	uint32_t memoryTypeIndex;
+	if (typeBits == 0 || vmaFindMemoryTypeIndex(allocator, typeBits, &allocinfo, &memoryTypeIndex) != VK_SUCCESS) return;
+
+	static const VkDeviceSize blockSizes[NUM_TEXTURE_POOLS] = { 8 * 1024 * 1024, 32 * 1024 * 1024 };
+	for (int i = 0; i < NUM_TEXTURE_POOLS; i++)
+	{
+		VmaPoolCreateInfo poolinfo = {};
+		poolinfo.memoryTypeIndex = memoryTypeIndex;
+		poolinfo.blockSize = blockSizes[i];
+		if (vmaCreatePool(allocator, &poolinfo, &TexturePools[i]) != VK_SUCCESS)
+			TexturePools[i] = VK_NULL_HANDLE;
+	}
+}
+
+VmaPool VulkanDevice::GetTexturePool(VkDeviceSize size) const
+{
+	if (size <= 256 * 1024) return TexturePools[TEXTURE_POOL_SMALL];
+	if (size <= 4 * 1024 * 1024) return TexturePools[TEXTURE_POOL_MEDIUM];
+	return VK_NULL_HANDLE;	// large ones are better off in the allocator's big blocks or dedicated allocations.
+}
+
+//==========================================================================
+//
+// Returns the device local memory in use and available to this process.
+// This is only known with VK_EXT_memory_budget.
+//
+//==========================================================================
+
+bool VulkanDevice::GetMemoryBudget(VkDeviceSize &usage, VkDeviceSize &budget)
+{
+	if (!SupportsDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) || !vkGetPhysicalDeviceMemoryProperties2KHR ||
+		std::find(EnabledExtensions.begin(), EnabledExtensions.end(), VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == EnabledExtensions.end())
+		return false;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {};
+	budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 props = {};
+	props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	props.pNext = &budgetProps;
+	vkGetPhysicalDeviceMemoryProperties2KHR(PhysicalDevice.Device, &props);
+
+	usage = budget = 0;
+	for (uint32_t i = 0; i < props.memoryProperties.memoryHeapCount; i++)
+	{
+		if (props.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			usage += budgetProps.heapUsage[i];
+			budget += budgetProps.heapBudget[i];
+		}
+	}
+	return budget > 0;
 }
 
 void VulkanDevice::CreateDevice()
@@ -500,6 +591,12 @@ void VulkanDevice::ReleaseResources()
 	if (device)
 		vkDeviceWaitIdle(device);
 
+	for (auto &pool : TexturePools)
+	{
+		if (pool) vmaDestroyPool(allocator, pool);
+		pool = VK_NULL_HANDLE;
+	}
+
 	if (allocator)
 		vmaDestroyAllocator(allocator);
 
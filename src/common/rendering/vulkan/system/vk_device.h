@@ -54,17 +54,21 @@ public:
 
 	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
+	// Textures are kept in pools by size so that the many small ones do not fragment the blocks the large ones need.
+	VmaPool GetTexturePool(VkDeviceSize size) const;
+	bool GetMemoryBudget(VkDeviceSize &usage, VkDeviceSize &budget);
+
 	// Instance setup
 	std::vector<VkLayerProperties> AvailableLayers;
 	std::vector<VkExtensionProperties> Extensions;
 	std::vector<const char *> EnabledExtensions;
-	std::vector<const char *> OptionalExtensions = { VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME };
+	std::vector<const char *> OptionalExtensions = { VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME };
 	std::vector<const char*> EnabledValidationLayers;
 
 	// Device setup
 	VkPhysicalDeviceFeatures UsedDeviceFeatures = {};
 	std::vector<const char *> EnabledDeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
-	std::vector<const char *> OptionalDeviceExtensions = { VK_EXT_HDR_METADATA_EXTENSION_NAME, VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME };
+	std::vector<const char *> OptionalDeviceExtensions = { VK_EXT_HDR_METADATA_EXTENSION_NAME, VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME };
 	VulkanPhysicalDevice PhysicalDevice;
 	bool DebugLayerActive = false;
 
@@ -73,6 +77,14 @@ public:
 	VkDevice device = VK_NULL_HANDLE;
 	VmaAllocator allocator = VK_NULL_HANDLE;
 
+	enum
+	{
+		TEXTURE_POOL_SMALL,
+		TEXTURE_POOL_MEDIUM,
+		NUM_TEXTURE_POOLS
+	};
+	VmaPool TexturePools[NUM_TEXTURE_POOLS] = {};
+
 	VkQueue graphicsQueue = VK_NULL_HANDLE;
 	VkQueue presentQueue = VK_NULL_HANDLE;
 
@@ -87,6 +99,7 @@ private:
 	void SelectFeatures();
 	void CreateDevice();
 	void CreateAllocator();
+	void CreateTexturePools();
 	void ReleaseResources();
 
 	bool SupportsDeviceExtension(const char *ext) const;
@@ -20,6 +20,8 @@
 **
 */
 
+#include <chrono>
+#include <thread>
 #include "volk/volk.h"
 
 #include "v_video.h"
@@ -61,6 +63,7 @@ EXTERN_CVAR(Bool, r_drawvoxels)
 EXTERN_CVAR(Int, gl_tonemap)
 EXTERN_CVAR(Int, screenblocks)
 EXTERN_CVAR(Bool, cl_capfps)
+CVARD(Bool, vk_submit_passes, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "submit the shadow map update and the 3D scene as soon as they are recorded, so the GPU works while the rest of the frame is built")
 
 extern int rendered_commandbuffers;
 int current_rendered_commandbuffers;
@@ -100,6 +103,9 @@ VulkanFrameBuffer::~VulkanFrameBuffer()
 {
 	vkDeviceWaitIdle(device->device); // make sure the GPU is no longer using any objects before RAII tears them down
 
+	if (mRenderPassManager)
+		mRenderPassManager->SavePipelineCache();
+
 	// screen is already null at this point, but VkHardwareTexture::ResetAll needs it during clean up. Is there a better way we can do this?
 	auto tmp = screen;
 	screen = this;
@@ -203,6 +209,7 @@ void VulkanFrameBuffer::Update()
 
 	WaitForCommands(true);
 	UpdateGpuStats();
+	VkMaterial::EvictIdleTextures();
 
 	Super::Update();
 }
@@ -316,6 +323,77 @@ void VulkanFrameBuffer::WaitForCommands(bool finish)
 		Finish.Unclock();
 		rendered_commandbuffers = current_rendered_commandbuffers;
 		current_rendered_commandbuffers = 0;
+		UpdateLatencyDelay();
+	}
+}
+
+//==========================================================================
+//
+// Low latency mode for the FIFO present modes: the next frame's start
+// gets delayed after the GPU finished the previous one so that its input
+// is read as late as possible. The delay grows slowly as long as frames
+// keep completing one refresh apart and backs off when one misses its
+// vertical blank.
+//
+//==========================================================================
+
+CVARD(Bool, vk_lowlatency, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "with vsync, start each frame as late as it can still be shown at the next refresh")
+
+enum
+{
+	LATENCY_DELAY_STEP = 250,
+	LATENCY_MARGIN = 2000,
+};
+
+bool VulkanFrameBuffer::LowLatencyActive() const
+{
+	if (!vk_lowlatency || !swapChain) return false;
+	auto mode = swapChain->swapChainPresentMode;
+	return mode == VK_PRESENT_MODE_FIFO_KHR || mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+}
+
+void VulkanFrameBuffer::UpdateLatencyDelay()
+{
+	int64_t now = I_nsTime() / 1000;
+	int64_t interval = now - mLatencyFrameDone;
+	mLatencyFrameDone = now;
+
+	if (!LowLatencyActive() || interval <= 0 || interval > 1'000'000)
+	{
+		mLatencyDelay = 0;
+		return;
+	}
+
+	// The refresh interval is what the frames settle to when vsync holds them back.
+	if (mLatencyRefresh == 0 || interval < mLatencyRefresh / 2)
+		mLatencyRefresh = interval;
+	else if (interval < mLatencyRefresh * 3 / 2)
+		mLatencyRefresh += (interval - mLatencyRefresh) / 16;
+
+	if (interval >= mLatencyRefresh * 3 / 2)
+		mLatencyDelay -= mLatencyRefresh / 4;
+	else
+		mLatencyDelay += LATENCY_DELAY_STEP;
+	mLatencyDelay = clamp<int64_t>(mLatencyDelay, 0, MAX<int64_t>(mLatencyRefresh - LATENCY_MARGIN, 0));
+}
+
+void VulkanFrameBuffer::WaitForFrameStart()
+{
+	if (mLatencyDelay <= 0 || !LowLatencyActive())
+		return;
+
+	int64_t wakeTime = mLatencyFrameDone + mLatencyDelay;
+	while (true)
+	{
+		int64_t timeToWait = wakeTime - int64_t(I_nsTime() / 1000);
+		if (timeToWait <= 0)
+			break;
+
+		// Same as in FPSLimit: OS sleep is not precise enough to wake up right at the deadline.
+		if (timeToWait <= 2'000)
+			std::this_thread::sleep_for(std::chrono::nanoseconds(0));
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(timeToWait - 2'000));
 	}
 }
 
@@ -354,6 +432,8 @@ void VulkanFrameBuffer::RenderTextureView(FCanvasTexture* tex, std::function<voi
 
 void VulkanFrameBuffer::PostProcessScene(bool swscene, int fixedcm, float flash, const std::function<void()> &afterBloomDrawEndScene2D)
 {
+	// The GPU can render the scene while the post processing and the 2D overlay get recorded.
+	if (vk_submit_passes) FlushCommands(false);
 	if (!swscene) mPostprocess->BlitSceneToPostprocess(); // Copy the resulting scene to the current post process texture
 	mPostprocess->PostProcessScene(fixedcm, flash, afterBloomDrawEndScene2D);
 }
@@ -377,8 +457,19 @@ void VulkanFrameBuffer::PrecacheMaterial(FMaterial *mat, int translation)
 
 	MaterialLayerInfo* layer;
 
-	auto systex = static_cast<VkHardwareTexture*>(mat->GetLayer(0, translation, &layer));
-	systex->GetImage(layer->layerTexture, translation, layer->scaleFlags);
+	if (mat->GetTranslationFlags(translation, CLAMP_NONE))
+	{
+		auto systex = static_cast<VkHardwareTexture*>(mat->GetLayer(0, FMaterial::TRANSLATION_INDEXED, &layer));
+		systex->GetImage(layer->layerTexture, 0, layer->scaleFlags | CTF_Indexed);
+
+		auto lut = FMaterial::GetTranslationLUT();
+		static_cast<VkHardwareTexture*>(lut->GetHardwareTexture(translation, 0))->GetImage(lut, translation, 0);
+	}
+	else
+	{
+		auto systex = static_cast<VkHardwareTexture*>(mat->GetLayer(0, translation, &layer));
+		systex->GetImage(layer->layerTexture, translation, layer->scaleFlags);
+	}
 
 	int numLayers = mat->NumLayers();
 	for (int i = 1; i < numLayers; i++)
@@ -660,6 +751,23 @@ VulkanCommandBuffer *VulkanFrameBuffer::GetDrawCommands()
 	return mDrawCommands.get();
 }
 
+//==========================================================================
+//
+// Command pools may only be used by one thread at a time, so every thread
+// that records secondary command buffers gets its own.
+//
+//==========================================================================
+
+VulkanCommandPool *VulkanFrameBuffer::GetSecondaryCommandPool(int index)
+{
+	while (mSecondaryCommandPools.size() <= (size_t)index)
+	{
+		mSecondaryCommandPools.push_back(std::make_unique<VulkanCommandPool>(device, device->graphicsFamily));
+		mSecondaryCommandPools.back()->SetDebugName("VulkanFrameBuffer.mSecondaryCommandPools");
+	}
+	return mSecondaryCommandPools[index].get();
+}
+
 unsigned int VulkanFrameBuffer::GetLightBufferBlockSize() const
 {
 	return mLights->GetBlockSize();
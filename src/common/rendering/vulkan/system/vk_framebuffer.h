@@ -29,6 +29,7 @@ public:
 
 	VulkanCommandBuffer *GetTransferCommands();
 	VulkanCommandBuffer *GetDrawCommands();
+	VulkanCommandPool *GetSecondaryCommandPool(int index);
 	VkShaderManager *GetShaderManager() { return mShaderManager.get(); }
 	VkSamplerManager *GetSamplerManager() { return mSamplerManager.get(); }
 	VkRenderPassManager *GetRenderPassManager() { return mRenderPassManager.get(); }
@@ -104,6 +105,7 @@ public:
 	void Draw2D() override;
 
 	void WaitForCommands(bool finish) override;
+	void WaitForFrameStart() override;
 
 	void PushGroup(const FString &name);
 	void PopGroup();
@@ -118,6 +120,8 @@ private:
 	void CopyScreenToBuffer(int w, int h, uint8_t *data) override;
 	void DeleteFrameObjects();
 	void FlushCommands(VulkanCommandBuffer **commands, size_t count, bool finish, bool lastsubmit);
+	bool LowLatencyActive() const;
+	void UpdateLatencyDelay();
 
 	std::unique_ptr<VkShaderManager> mShaderManager;
 	std::unique_ptr<VkSamplerManager> mSamplerManager;
@@ -126,6 +130,7 @@ private:
 	std::unique_ptr<VkPostprocess> mPostprocess;
 	std::unique_ptr<VkRenderPassManager> mRenderPassManager;
 	std::unique_ptr<VulkanCommandPool> mCommandPool;
+	std::vector<std::unique_ptr<VulkanCommandPool>> mSecondaryCommandPools;
 	std::unique_ptr<VulkanCommandBuffer> mTransferCommands;
 	std::unique_ptr<VkRenderState> mRenderState;
 
@@ -142,6 +147,11 @@ private:
 
 	VkRenderBuffers *mActiveRenderBuffers = nullptr;
 
+	// vk_lowlatency, all in microseconds
+	int64_t mLatencyFrameDone = 0;
+	int64_t mLatencyRefresh = 0;
+	int64_t mLatencyDelay = 0;
+
 	struct TimestampQuery
 	{
 		FString name;
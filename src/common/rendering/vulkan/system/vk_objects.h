@@ -237,6 +237,24 @@ private:
 	VulkanPipeline &operator=(const VulkanPipeline &) = delete;
 };
 
+class VulkanPipelineCache
+{
+public:
+	VulkanPipelineCache(VulkanDevice *device, VkPipelineCache cache);
+	~VulkanPipelineCache();
+
+	void SetDebugName(const char *name) { device->SetDebugObjectName(name, (uint64_t)cache, VK_OBJECT_TYPE_PIPELINE_CACHE); }
+
+	std::vector<uint8_t> getData();
+
+	VulkanDevice *device;
+	VkPipelineCache cache;
+
+private:
+	VulkanPipelineCache(const VulkanPipelineCache &) = delete;
+	VulkanPipelineCache &operator=(const VulkanPipelineCache &) = delete;
+};
+
 class VulkanPipelineLayout
 {
 public:
@@ -291,12 +309,13 @@ private:
 class VulkanCommandBuffer
 {
 public:
-	VulkanCommandBuffer(VulkanCommandPool *pool);
+	VulkanCommandBuffer(VulkanCommandPool *pool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 	~VulkanCommandBuffer();
 
 	void SetDebugName(const char *name);
 
 	void begin();
+	void begin(const VkCommandBufferInheritanceInfo &inheritance);
 	void end();
 
 	void bindPipeline(VkPipelineBindPoint pipelineBindPoint, VulkanPipeline *pipeline);
@@ -373,7 +392,7 @@ public:
 
 	void SetDebugName(const char *name) { device->SetDebugObjectName(name, (uint64_t)pool, VK_OBJECT_TYPE_COMMAND_POOL); }
 
-	std::unique_ptr<VulkanCommandBuffer> createBuffer();
+	std::unique_ptr<VulkanCommandBuffer> createBuffer(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
 	VkCommandPool pool = VK_NULL_HANDLE;
 
@@ -457,9 +476,9 @@ inline VulkanCommandPool::~VulkanCommandPool()
 	vkDestroyCommandPool(device->device, pool, nullptr);
 }
 
-inline std::unique_ptr<VulkanCommandBuffer> VulkanCommandPool::createBuffer()
+inline std::unique_ptr<VulkanCommandBuffer> VulkanCommandPool::createBuffer(VkCommandBufferLevel level)
 {
-	return std::make_unique<VulkanCommandBuffer>(this);
+	return std::make_unique<VulkanCommandBuffer>(this, level);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -530,11 +549,11 @@ inline void RenderPassBegin::addClearDepthStencil(float depthValue, int stencilV
 
 /////////////////////////////////////////////////////////////////////////////
 
-inline VulkanCommandBuffer::VulkanCommandBuffer(VulkanCommandPool *pool) : pool(pool)
+inline VulkanCommandBuffer::VulkanCommandBuffer(VulkanCommandPool *pool, VkCommandBufferLevel level) : pool(pool)
 {
 	VkCommandBufferAllocateInfo allocInfo = {};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.level = level;
 	allocInfo.commandPool = pool->pool;
 	allocInfo.commandBufferCount = 1;
 
@@ -558,6 +577,17 @@ inline void VulkanCommandBuffer::begin()
 	CheckVulkanError(result, "Could not begin recording command buffer");
 }
 
+inline void VulkanCommandBuffer::begin(const VkCommandBufferInheritanceInfo &inheritance)
+{
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+
+	VkResult result = vkBeginCommandBuffer(buffer, &beginInfo);
+	CheckVulkanError(result, "Could not begin recording command buffer");
+}
+
 inline void VulkanCommandBuffer::end()
 {
 	VkResult result = vkEndCommandBuffer(buffer);
@@ -1045,6 +1075,30 @@ inline VulkanPipeline::~VulkanPipeline()
 
 /////////////////////////////////////////////////////////////////////////////
 
+inline VulkanPipelineCache::VulkanPipelineCache(VulkanDevice *device, VkPipelineCache cache) : device(device), cache(cache)
+{
+}
+
+inline VulkanPipelineCache::~VulkanPipelineCache()
+{
+	vkDestroyPipelineCache(device->device, cache, nullptr);
+}
+
+inline std::vector<uint8_t> VulkanPipelineCache::getData()
+{
+	size_t size = 0;
+	VkResult result = vkGetPipelineCacheData(device->device, cache, &size, nullptr);
+	CheckVulkanError(result, "Could not get pipeline cache size");
+
+	std::vector<uint8_t> data(size);
+	result = vkGetPipelineCacheData(device->device, cache, &size, data.data());
+	CheckVulkanError(result, "Could not get pipeline cache data");
+	data.resize(size);
+	return data;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 inline VulkanPipelineLayout::VulkanPipelineLayout(VulkanDevice *device, VkPipelineLayout layout) : device(device), layout(layout)
 {
 }
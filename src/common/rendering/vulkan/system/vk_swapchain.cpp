@@ -26,9 +26,12 @@
 #include "version.h"
 #include "v_video.h"
 #include "vk_framebuffer.h"
+#include "cmdlib.h"
 
 
 CVAR(Bool, vk_hdr, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVARD(Int, vk_presentmode, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "0 = from vid_vsync, 1 = fifo, 2 = fifo relaxed, 3 = mailbox, 4 = immediate")
+CVARD(Int, vk_maxframes, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "maximum number of frames queued for presentation, 0 picks it from the present mode")
 
 void I_GetVulkanDrawableSize(int *width, int *height);
 
@@ -44,13 +47,15 @@ VulkanSwapChain::~VulkanSwapChain()
 uint32_t VulkanSwapChain::AcquireImage(int width, int height, VulkanSemaphore *semaphore, VulkanFence *fence)
 {
 	auto vsync = static_cast<VulkanFrameBuffer*>(screen)->cur_vsync;
-	if (lastSwapWidth != width || lastSwapHeight != height || lastVsync != vsync || lastHdr != vk_hdr || !swapChain)
+	if (lastSwapWidth != width || lastSwapHeight != height || lastVsync != vsync || lastHdr != vk_hdr || lastPresentMode != vk_presentmode || lastMaxFrames != vk_maxframes || !swapChain)
 	{
 		Recreate();
 		lastSwapWidth = width;
 		lastSwapHeight = height;
 		lastVsync = vsync;
 		lastHdr = vk_hdr;
+		lastPresentMode = vk_presentmode;
+		lastMaxFrames = vk_maxframes;
 	}
 
 	uint32_t imageIndex;
@@ -175,10 +180,14 @@ bool VulkanSwapChain::CreateSwapChain(VkSwapchainKHR oldSwapChain)
 
 	// When vsync is on we only want two images. This creates a slight performance penalty in exchange for reduced input latency (less mouse lag).
 	// When vsync is off we want three images as it allows us to generate new images even during the vertical blanking period where one entry is being used by the presentation engine.
-	if (swapChainPresentMode == VK_PRESENT_MODE_MAILBOX_KHR || swapChainPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
+	if (vk_maxframes > 0)
+		imageCount = std::max(surfaceCapabilities.minImageCount, (uint32_t)vk_maxframes);
+	else if (swapChainPresentMode == VK_PRESENT_MODE_MAILBOX_KHR || swapChainPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
 		imageCount = std::min(imageCount, (uint32_t)3);
 	else
 		imageCount = std::min(imageCount, (uint32_t)2);
+	if (surfaceCapabilities.maxImageCount > 0 && imageCount > surfaceCapabilities.maxImageCount)
+		imageCount = surfaceCapabilities.maxImageCount;
 
 	VkSwapchainCreateInfoKHR swapChainCreateInfo = {};
 	swapChainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -308,6 +317,15 @@ void VulkanSwapChain::SelectPresentMode()
 	if (presentModes.empty())
 		VulkanError("No surface present modes supported");
 
+	// An explicitly requested mode falls back to the vid_vsync based choice if the surface does not support it.
+	static const VkPresentModeKHR requestModes[] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+	if (vk_presentmode >= 1 && vk_presentmode <= (int)countof(requestModes))
+	{
+		swapChainPresentMode = requestModes[vk_presentmode - 1];
+		if (std::find(presentModes.begin(), presentModes.end(), swapChainPresentMode) != presentModes.end())
+			return;
+	}
+
 	swapChainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
 	auto vsync = static_cast<VulkanFrameBuffer*>(screen)->cur_vsync;
 	if (vsync)
@@ -48,6 +48,8 @@ private:
 	int lastSwapHeight = 0;
 	bool lastVsync = false;
 	bool lastHdr = false;
+	int lastPresentMode = 0;
+	int lastMaxFrames = 0;
 
 	VulkanSwapChain(const VulkanSwapChain &) = delete;
 	VulkanSwapChain &operator=(const VulkanSwapChain &) = delete;
@@ -20,6 +20,7 @@
 **
 */
 
+#include <algorithm>
 #include "templates.h"
 #include "c_cvars.h"
 #include "hw_material.h"
@@ -34,6 +35,9 @@
 #include "vulkan/renderer/vk_renderbuffers.h"
 #include "vulkan/shaders/vk_shader.h"
 #include "vk_hwtexture.h"
+#include "zonetrace.h"
+#include "memstats.h"
+#include "printf.h"
 
 VkHardwareTexture *VkHardwareTexture::First = nullptr;
 
@@ -59,6 +63,36 @@ void VkHardwareTexture::ResetAll()
 		cur->Reset();
 }
 
+//===========================================================================
+//
+// Estimated from the image sizes, the allocator's alignment is ignored.
+//
+//===========================================================================
+
+size_t VkHardwareTexture::GetMemoryUsage()
+{
+	size_t total = 0;
+	for (VkHardwareTexture *cur = VkHardwareTexture::First; cur; cur = cur->Next)
+	{
+		total += cur->GetImageSize();
+		if (auto image = cur->mDepthStencil.Image.get())
+		{
+			total += size_t(image->width) * image->height * 4;
+		}
+	}
+	return total;
+}
+
+size_t VkHardwareTexture::GetImageSize() const
+{
+	auto image = mImage.Image.get();
+	if (image == nullptr) return 0;
+	size_t bytes = size_t(image->width) * image->height * mTexelsize;
+	return image->mipLevels > 1 ? bytes * 4 / 3 : bytes;
+}
+
+static FMemReporter VkTextureMemory(MEM_HWTextures, VkHardwareTexture::GetMemoryUsage);
+
 void VkHardwareTexture::Reset()
 {
 	if (auto fb = GetVulkanFrameBuffer())
@@ -123,10 +157,14 @@ VkTextureImage *VkHardwareTexture::GetDepthStencil(FTexture *tex)
 
 void VkHardwareTexture::CreateImage(FTexture *tex, int translation, int flags)
 {
+	TRACE_ZONE("TextureLoad");
 	if (!tex->isHardwareCanvas())
 	{
 		FTextureBuffer texbuffer = tex->CreateTexBuffer(translation, flags | CTF_ProcessData);
-		CreateTexture(texbuffer.mWidth, texbuffer.mHeight, 4, VK_FORMAT_B8G8R8A8_UNORM, texbuffer.mBuffer);
+		if (flags & CTF_Indexed)
+			CreateTexture(texbuffer.mWidth, texbuffer.mHeight, 1, VK_FORMAT_R8_UNORM, texbuffer.mBuffer);
+		else
+			CreateTexture(texbuffer.mWidth, texbuffer.mHeight, 4, VK_FORMAT_B8G8R8A8_UNORM, texbuffer.mBuffer);
 	}
 	else
 	{
@@ -158,6 +196,7 @@ void VkHardwareTexture::CreateImage(FTexture *tex, int translation, int flags)
 
 void VkHardwareTexture::CreateTexture(int w, int h, int pixelsize, VkFormat format, const void *pixels)
 {
+	TRACE_ZONE("TextureUpload");
 	auto fb = GetVulkanFrameBuffer();
 
 	int totalSize = w * h * pixelsize;
@@ -176,7 +215,14 @@ void VkHardwareTexture::CreateTexture(int w, int h, int pixelsize, VkFormat form
 	imgbuilder.setFormat(format);
 	imgbuilder.setSize(w, h, GetMipLevels(w, h));
 	imgbuilder.setUsage(VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
-	mImage.Image = imgbuilder.create(fb->device);
+	if (VmaPool pool = fb->device->GetTexturePool(VkDeviceSize(totalSize) * 4 / 3))
+	{
+		imgbuilder.setPool(pool);
+		mImage.Image = imgbuilder.tryCreate(fb->device);
+		imgbuilder.setPool(VK_NULL_HANDLE);
+	}
+	if (!mImage.Image) mImage.Image = imgbuilder.create(fb->device);
+	mTexelsize = pixelsize;
 	mImage.Image->SetDebugName("VkHardwareTexture.mImage");
 
 	ImageViewBuilder viewbuilder;
@@ -362,8 +408,89 @@ void VkMaterial::ResetAllDescriptors()
 		fb->GetRenderPassManager()->TextureSetPoolReset();
 }
 
+//===========================================================================
+//
+// The texture memory the material's base layer would give back.
+// Only plain images can be evicted, they can be recreated at any time.
+//
+//===========================================================================
+
+size_t VkMaterial::GetEvictableSize() const
+{
+	auto tex = GetLayerArray()[0].layerTexture;
+	if (tex->GetImage() == nullptr || tex->isHardwareCanvas() || Source()->GetUseType() == ETextureType::SWCanvas) return 0;
+
+	size_t size = 0;
+	tex->SystemTextures.Iterate([&](IHardwareTexture *hwtex) { size += static_cast<VkHardwareTexture*>(hwtex)->GetImageSize(); });
+	return size;
+}
+
+//===========================================================================
+//
+// When the textures exceed the memory budget, the ones of materials that
+// have not been drawn for a while get deleted, oldest first. They are
+// created again when needed.
+//
+//===========================================================================
+
+CVAR(Int, vk_texture_budget, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in MB, 0 uses the budget reported by the driver if it supports VK_EXT_memory_budget.
+
+enum
+{
+	EVICT_CHECK_INTERVAL = 1000,	// ms
+	EVICT_IDLE_TIME = 10000,		// ms a material must not have been used for
+};
+
+void VkMaterial::EvictIdleTextures()
+{
+	static uint64_t lastcheck;
+	uint64_t now = screen->FrameTime;
+	if (now - lastcheck < EVICT_CHECK_INTERVAL) return;
+	lastcheck = now;
+
+	auto fb = GetVulkanFrameBuffer();
+	VkDeviceSize usage, budget;
+	if (vk_texture_budget > 0)
+	{
+		usage = VkHardwareTexture::GetMemoryUsage();
+		budget = VkDeviceSize(vk_texture_budget) << 20;
+	}
+	else if (fb->device->GetMemoryBudget(usage, budget))
+	{
+		// Leave some room for everything else that is not a texture.
+		budget = budget / 10 * 9;
+	}
+	else return;
+	if (usage <= budget) return;
+
+	TArray<std::pair<VkMaterial*, size_t>> idle;
+	for (VkMaterial* cur = First; cur; cur = cur->Next)
+	{
+		if (now - cur->mLastUsed < EVICT_IDLE_TIME) continue;
+		size_t size = cur->GetEvictableSize();
+		if (size > 0) idle.Push(std::make_pair(cur, size));
+	}
+	if (idle.Size() == 0) return;
+	std::sort(idle.begin(), idle.end(), [](const auto &a, const auto &b) { return a.first->mLastUsed < b.first->mLastUsed; });
+
+	VkDeviceSize excess = usage - budget, freed = 0;
+	for (auto &entry : idle)
+	{
+		if (freed >= excess) break;
+		entry.first->GetLayerArray()[0].layerTexture->SystemTextures.Iterate([](IHardwareTexture *hwtex) { static_cast<VkHardwareTexture*>(hwtex)->Reset(); });
+		freed += entry.second;
+	}
+
+	// Other materials may share the deleted images so none of the descriptor sets can be trusted anymore.
+	ResetAllDescriptors();
+	DPrintf(DMSG_NOTIFY, "Evicted %u KB of idle textures\n", unsigned(freed >> 10));
+}
+
 VulkanDescriptorSet* VkMaterial::GetDescriptorSet(const FMaterialState& state)
 {
+	// Creating the set may upload textures, and the recording threads can ask for the same material at the same time.
+	std::lock_guard<std::recursive_mutex> lock(ResourceLock);
+	mLastUsed = screen->FrameTime;
 	auto base = Source();
 	int clampmode = state.mClampMode;
 	int translation = state.mTranslation;
@@ -374,9 +501,13 @@ VulkanDescriptorSet* VkMaterial::GetDescriptorSet(const FMaterialState& state)
 
 	clampmode = base->GetClampMode(clampmode);
 
+	// The shader translations need a different set because the base layer is the indexed texture.
+	bool shadertranslation = GetTranslationFlags(state.mTranslation, clampmode) != 0;
+	int flags = shadertranslation ? translation | 0x40000000 : translation;
+
 	for (auto& set : mDescriptorSets)
 	{
-		if (set.descriptor && set.clampmode == clampmode && set.flags == translation) return set.descriptor.get();
+		if (set.descriptor && set.clampmode == clampmode && set.flags == flags) return set.descriptor.get();
 	}
 
 	int numLayers = NumLayers();
@@ -390,8 +521,18 @@ VulkanDescriptorSet* VkMaterial::GetDescriptorSet(const FMaterialState& state)
 
 	WriteDescriptors update;
 	MaterialLayerInfo *layer;
-	auto systex = static_cast<VkHardwareTexture*>(GetLayer(0, state.mTranslation, &layer));
-	update.addCombinedImageSampler(descriptor.get(), 0, systex->GetImage(layer->layerTexture, state.mTranslation, layer->scaleFlags)->View.get(), sampler, systex->mImage.Layout);
+	VkHardwareTexture *systex;
+	if (!shadertranslation)
+	{
+		systex = static_cast<VkHardwareTexture*>(GetLayer(0, state.mTranslation, &layer));
+		update.addCombinedImageSampler(descriptor.get(), 0, systex->GetImage(layer->layerTexture, state.mTranslation, layer->scaleFlags)->View.get(), sampler, systex->mImage.Layout);
+	}
+	else
+	{
+		VulkanSampler* nofilter = fb->GetSamplerManager()->Get(NoFilterClampMode(clampmode));
+		systex = static_cast<VkHardwareTexture*>(GetLayer(0, TRANSLATION_INDEXED, &layer));
+		update.addCombinedImageSampler(descriptor.get(), 0, systex->GetImage(layer->layerTexture, 0, layer->scaleFlags | CTF_Indexed)->View.get(), nofilter, systex->mImage.Layout);
+	}
 	for (int i = 1; i < numLayers; i++)
 	{
 		auto systex = static_cast<VkHardwareTexture*>(GetLayer(i, 0, &layer));
@@ -401,11 +542,17 @@ VulkanDescriptorSet* VkMaterial::GetDescriptorSet(const FMaterialState& state)
 	auto dummyImage = fb->GetRenderPassManager()->GetNullTextureView();
 	for (int i = numLayers; i < SHADER_MIN_REQUIRED_TEXTURE_LAYERS; i++)
 	{
-		update.addCombinedImageSampler(descriptor.get(), i, dummyImage, sampler, systex->mImage.Layout);
+		if (shadertranslation && i == TRANSLATION_LUT_LAYER)
+		{
+			auto lut = GetTranslationLUT();
+			auto luttex = static_cast<VkHardwareTexture*>(lut->GetHardwareTexture(state.mTranslation, 0));
+			update.addCombinedImageSampler(descriptor.get(), i, luttex->GetImage(lut, state.mTranslation, 0)->View.get(), fb->GetSamplerManager()->Get(CLAMP_NOFILTER_XY), luttex->mImage.Layout);
+		}
+		else update.addCombinedImageSampler(descriptor.get(), i, dummyImage, sampler, systex->mImage.Layout);
 	}
 
 	update.updateSets(fb->device);
-	mDescriptorSets.emplace_back(clampmode, translation, std::move(descriptor));
+	mDescriptorSets.emplace_back(clampmode, flags, std::move(descriptor));
 	return mDescriptorSets.back().descriptor.get();
 }
 
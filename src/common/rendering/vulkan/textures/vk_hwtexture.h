@@ -30,6 +30,9 @@ public:
 	static void ResetAll();
 	void Reset();
 
+	static size_t GetMemoryUsage();
+	size_t GetImageSize() const;
+
 	// Software renderer stuff
 	void AllocateBuffer(int w, int h, int texelsize) override;
 	uint8_t *MapBuffer() override;
@@ -82,6 +85,9 @@ class VkMaterial : public FMaterial
 	};
 
 	std::vector<DescriptorEntry> mDescriptorSets;
+	uint64_t mLastUsed = 0;		// frame time of the last draw
+
+	size_t GetEvictableSize() const;
 
 public:
 	VkMaterial(FGameTexture *tex, int scaleflags);
@@ -89,5 +95,6 @@ public:
 	VulkanDescriptorSet* GetDescriptorSet(const FMaterialState& state);
 	void DeleteDescriptors() override;
 	static void ResetAllDescriptors();
+	static void EvictIdleTextures();
 
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "tarray.h"
+#include "flatmap.h"
 #include "zstring.h"
 #include "dobject.h"
 
@@ -19,7 +20,7 @@ class Dictionary final : public DObject
 
 public:
 
-	using StringMap = TMap<FString, FString>;
+	using StringMap = TFlatMap<FString, FString>;
 	using ConstIterator = StringMap::ConstIterator;
 	using ConstPair = StringMap::ConstPair;
 
@@ -33,7 +33,9 @@
 **
 */
 
+#include <algorithm>
 #include "tarray.h"
+#include "templates.h"
 #include "dobject.h"
 #include "vm.h"
 #include "types.h"
@@ -131,6 +133,109 @@ template<class T> void ArrayClear(T *self)
 	self->Clear();
 }
 
+// Bulk operations for the numeric arrays. These only exist for Int32 and both
+// float types. Int32 arrays are interpreted as signed for all comparisons.
+// The loops are kept simple so that the compiler can vectorize the integer
+// versions. Float sums are added strictly in order so that the result does
+// not depend on the platform.
+
+template<class V> struct FArrayValueLess
+{
+	bool operator()(V a, V b) const
+	{
+		// NaNs are placed at the end so that this remains a strict weak ordering.
+		return a < b || (b != b && a == a);
+	}
+};
+
+template<class T, class V> void ArraySort(T *self)
+{
+	auto data = reinterpret_cast<V*>(self->Data());
+	std::stable_sort(data, data + self->Size(), FArrayValueLess<V>());
+}
+
+template<class T, class V, class U> int ArraySortedFind(T *self, U val)
+{
+	auto data = reinterpret_cast<V*>(self->Data());
+	auto end = data + self->Size();
+	V v = static_cast<V>(val);
+	auto it = std::lower_bound(data, end, v, FArrayValueLess<V>());
+	return (it != end && !FArrayValueLess<V>()(v, *it)) ? int(it - data) : int(self->Size());
+}
+
+template<class T, class U> int ArrayFindAll(T *self, U val, FDynArray_I32 *indices)
+{
+	auto v = static_cast<typename T::value_type>(val);
+	FDynArray_I32 result;
+	for (unsigned i = 0; i < self->Size(); i++)
+	{
+		if ((*self)[i] == v) result.Push(i);
+	}
+	// self and indices may be the same array.
+	*indices = std::move(result);
+	return indices->Size();
+}
+
+template<class T, class U> void ArrayFill(T *self, U val)
+{
+	auto v = static_cast<typename T::value_type>(val);
+	auto data = self->Data();
+	for (unsigned i = 0; i < self->Size(); i++) data[i] = v;
+}
+
+template<class T, class U> int ArrayReserveFill(T *self, int amount, U val)
+{
+	auto v = static_cast<typename T::value_type>(val);
+	unsigned index = self->Reserve(amount);
+	auto data = self->Data();
+	for (unsigned i = index; i < self->Size(); i++) data[i] = v;
+	return index;
+}
+
+template<class T> void ArrayCopySlice(T *self, T *other, int start, int count)
+{
+	int size = other->Size();
+	start = clamp(start, 0, size);
+	if (count < 0 || count > size - start) count = size - start;
+
+	if (self == other)
+	{
+		self->Delete(0, start);
+		self->Resize(count);
+	}
+	else
+	{
+		self->Resize(count);
+		if (count > 0) memcpy(self->Data(), other->Data() + start, count * sizeof((*self)[0]));
+	}
+}
+
+template<class T, class A, class R> R ArraySum(T *self)
+{
+	auto data = self->Data();
+	A sum = 0;
+	for (unsigned i = 0; i < self->Size(); i++) sum += data[i];
+	return static_cast<R>(sum);
+}
+
+template<class T, class V, class R> R ArrayMinValue(T *self)
+{
+	if (self->Size() == 0) return 0;
+	auto data = reinterpret_cast<V*>(self->Data());
+	V m = data[0];
+	for (unsigned i = 1; i < self->Size(); i++) m = data[i] < m ? data[i] : m;
+	return m;
+}
+
+template<class T, class V, class R> R ArrayMaxValue(T *self)
+{
+	if (self->Size() == 0) return 0;
+	auto data = reinterpret_cast<V*>(self->Data());
+	V m = data[0];
+	for (unsigned i = 1; i < self->Size(); i++) m = data[i] > m ? data[i] : m;
+	return m;
+}
+
 // without this the two-argument templates cannot be used in macros.
 #define COMMA ,
 
@@ -467,6 +572,72 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Clear, ArrayClear<FDynArray_I32>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Sort, ArraySort<FDynArray_I32 COMMA int32_t>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	ArraySort<FDynArray_I32, int32_t>(self);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, SortedFind, ArraySortedFind<FDynArray_I32 COMMA int32_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(val);
+	ACTION_RETURN_INT((ArraySortedFind<FDynArray_I32, int32_t, int>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, FindAll, ArrayFindAll<FDynArray_I32 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(val);
+	PARAM_POINTER(indices, FDynArray_I32);
+	ACTION_RETURN_INT(ArrayFindAll(self, val, indices));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Fill, ArrayFill<FDynArray_I32 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(val);
+	ArrayFill(self, val);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, ReserveFill, ArrayReserveFill<FDynArray_I32 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(count);
+	PARAM_INT(val);
+	ACTION_RETURN_INT(ArrayReserveFill(self, count, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, CopySlice, ArrayCopySlice<FDynArray_I32>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_POINTER(other, FDynArray_I32);
+	PARAM_INT(start);
+	PARAM_INT(count);
+	ArrayCopySlice(self, other, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Sum, ArraySum<FDynArray_I32 COMMA uint32_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	ACTION_RETURN_INT((ArraySum<FDynArray_I32, uint32_t, int>(self)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, MinValue, ArrayMinValue<FDynArray_I32 COMMA int32_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	ACTION_RETURN_INT((ArrayMinValue<FDynArray_I32, int32_t, int>(self)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, MaxValue, ArrayMaxValue<FDynArray_I32 COMMA int32_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	ACTION_RETURN_INT((ArrayMaxValue<FDynArray_I32, int32_t, int>(self)));
+}
+
 //-----------------------------------------------------
 //
 // Float32 array
@@ -578,6 +749,64 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Clear, ArrayClear<FDynArray_F32>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Sort, ArraySort<FDynArray_F32 COMMA float>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	ArraySort<FDynArray_F32, float>(self);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, SortedFind, ArraySortedFind<FDynArray_F32 COMMA float COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT((ArraySortedFind<FDynArray_F32, float, double>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Fill, ArrayFill<FDynArray_F32 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_FLOAT(val);
+	ArrayFill(self, val);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, ReserveFill, ArrayReserveFill<FDynArray_F32 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_INT(count);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT(ArrayReserveFill(self, count, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, CopySlice, ArrayCopySlice<FDynArray_F32>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_POINTER(other, FDynArray_F32);
+	PARAM_INT(start);
+	PARAM_INT(count);
+	ArrayCopySlice(self, other, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Sum, ArraySum<FDynArray_F32 COMMA double COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	ACTION_RETURN_FLOAT((ArraySum<FDynArray_F32, double, double>(self)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, MinValue, ArrayMinValue<FDynArray_F32 COMMA float COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	ACTION_RETURN_FLOAT((ArrayMinValue<FDynArray_F32, float, double>(self)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, MaxValue, ArrayMaxValue<FDynArray_F32 COMMA float COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	ACTION_RETURN_FLOAT((ArrayMaxValue<FDynArray_F32, float, double>(self)));
+}
+
 //-----------------------------------------------------
 //
 // Float64 array
@@ -689,6 +918,64 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Clear, ArrayClear<FDynArray_F64>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Sort, ArraySort<FDynArray_F64 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	ArraySort<FDynArray_F64, double>(self);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, SortedFind, ArraySortedFind<FDynArray_F64 COMMA double COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT((ArraySortedFind<FDynArray_F64, double, double>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Fill, ArrayFill<FDynArray_F64 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_FLOAT(val);
+	ArrayFill(self, val);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, ReserveFill, ArrayReserveFill<FDynArray_F64 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_INT(count);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT(ArrayReserveFill(self, count, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, CopySlice, ArrayCopySlice<FDynArray_F64>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_POINTER(other, FDynArray_F64);
+	PARAM_INT(start);
+	PARAM_INT(count);
+	ArrayCopySlice(self, other, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Sum, ArraySum<FDynArray_F64 COMMA double COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	ACTION_RETURN_FLOAT((ArraySum<FDynArray_F64, double, double>(self)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, MinValue, ArrayMinValue<FDynArray_F64 COMMA double COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	ACTION_RETURN_FLOAT((ArrayMinValue<FDynArray_F64, double, double>(self)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, MaxValue, ArrayMaxValue<FDynArray_F64 COMMA double COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	ACTION_RETURN_FLOAT((ArrayMaxValue<FDynArray_F64, double, double>(self)));
+}
+
 //-----------------------------------------------------
 //
 // Pointer array
@@ -61,16 +61,15 @@ void AddInclude(ZCC_ExprConstant *node)
 
 struct TokenMapEntry
 {
-	int16_t TokenType;
+	int16_t TokenType;	// 0 if the scanner token has no ZScript equivalent.
 	uint16_t TokenName;
-	TokenMapEntry(int16_t a, uint16_t b)
-	: TokenType(a), TokenName(b)
-	{ }
 };
-static TMap<int16_t, TokenMapEntry> TokenMap;
+// Indexed directly by the scanner's token type because this gets looked up for nearly every token that gets parsed.
+static TokenMapEntry TokenMap[TK_LastToken];
+static bool TokenMapInitialized;
 static int16_t BackTokenMap[YYERRORSYMBOL];	// YYERRORSYMBOL immediately follows the terminals described by the grammar
 
-#define TOKENDEF2(sc, zcc, name)	{ TokenMapEntry tme(zcc, name); TokenMap.Insert(sc, tme); } BackTokenMap[zcc] = sc
+#define TOKENDEF2(sc, zcc, name)	{ TokenMap[sc].TokenType = zcc; TokenMap[sc].TokenName = name; } BackTokenMap[zcc] = sc
 #define TOKENDEF(sc, zcc)			TOKENDEF2(sc, zcc, NAME_None)
 
 static void InitTokenMap()
@@ -327,8 +326,8 @@ static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void
 			break;
 
 		default:
-			TokenMapEntry *zcctoken = TokenMap.CheckKey(sc.TokenType);
-			if (zcctoken != nullptr)
+			TokenMapEntry *zcctoken = (unsigned)sc.TokenType < countof(TokenMap) ? &TokenMap[sc.TokenType] : nullptr;
+			if (zcctoken != nullptr && zcctoken->TokenType != 0)
 			{
 				tokentype = zcctoken->TokenType;
 				value.Int = zcctoken->TokenName;
@@ -358,9 +357,10 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 	int lumpnum = baselump;
 	auto fileno = fileSystem.GetFileContainer(lumpnum);
 
-	if (TokenMap.CountUsed() == 0)
+	if (!TokenMapInitialized)
 	{
 		InitTokenMap();
+		TokenMapInitialized = true;
 	}
 
 	parser = ZCCParseAlloc(malloc);
@@ -48,7 +48,8 @@ FString FStringFormat(VM_ARGS, int offset)
 	PARAM_VA_POINTER(va_reginfo)	// Get the hidden type information array
 	assert(va_reginfo[offset] == REGT_STRING);
 
-	FString fmtstring = param[offset].s().GetChars();
+	// The output is a local string, so this cannot alias it and needs no copy.
+	const FString &fmtstring = param[offset].s();
 
 	param += offset;
 	numparam -= offset;
@@ -59,7 +60,22 @@ FString FStringFormat(VM_ARGS, int offset)
 	//       https://en.wikipedia.org/wiki/Printf_format_string#Format_placeholder_specification
 	FString output;
 	bool in_fmt = false;
-	FString fmt_current;
+	// The placeholder being parsed. These are short, so building them in a
+	// local buffer saves growing a string one character at a time.
+	char fmt_current[64];
+	size_t fmt_len = 0;
+	auto fmt_add = [&](char ch)
+	{
+		if (fmt_len >= sizeof(fmt_current) - 1) ThrowAbortException(X_FORMAT_ERROR, "Format placeholder too long.");
+		fmt_current[fmt_len++] = ch;
+		fmt_current[fmt_len] = 0;
+	};
+	auto fmt_reset = [&]()
+	{
+		fmt_current[0] = '%';
+		fmt_current[1] = fmt_current[2] = 0;
+		fmt_len = 1;
+	};
 	int argnum = 1;
 	int argauto = 1;
 	// % = starts
@@ -73,30 +89,30 @@ FString FStringFormat(VM_ARGS, int offset)
 		char c = fmtstring[i];
 		if (in_fmt)
 		{
-			if (c == '*' && (fmt_current.Len() == 1 || (fmt_current.Len() == 2 && fmt_current[1] == '0')))
+			if (c == '*' && (fmt_len == 1 || (fmt_len == 2 && fmt_current[1] == '0')))
 			{
-				fmt_current += c;
+				fmt_add(c);
 			}
 			else if ((c >= '0' && c <= '9') ||
-				c == '-' || c == '+' || (c == ' ' && fmt_current.Back() != ' ') || c == '#' || c == '.')
+				c == '-' || c == '+' || (c == ' ' && fmt_current[fmt_len - 1] != ' ') || c == '#' || c == '.')
 			{
-				fmt_current += c;
+				fmt_add(c);
 			}
 			else if (c == '$') // %number$format
 			{
 				if (!haveargnums && argauto > 1)
 					ThrowAbortException(X_FORMAT_ERROR, "Cannot mix explicit and implicit arguments.");
-				FString argnumstr = fmt_current.Mid(1);
+				FString argnumstr = fmt_current + 1;
 				if (!argnumstr.IsInt()) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for argument number, got '%s'.", argnumstr.GetChars());
 				auto argnum64 = argnumstr.ToLong();
 				if (argnum64 < 1 || argnum64 >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format (tried to access argument %d, %d total).", argnum64, numparam);
-				fmt_current = "%";
+				fmt_reset();
 				haveargnums = true;
 				argnum = int(argnum64);
 			}
 			else
 			{
-				fmt_current += c;
+				fmt_add(c);
 
 				switch (c)
 				{
@@ -108,9 +124,9 @@ FString FStringFormat(VM_ARGS, int offset)
 					in_fmt = false;
 					// fail if something was found, but it's not a string
 					if (argnum >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format.");
-					if (va_reginfo[argnum] != REGT_STRING) ThrowAbortException(X_FORMAT_ERROR, "Expected a string for format %s.", fmt_current.GetChars());
+					if (va_reginfo[argnum] != REGT_STRING) ThrowAbortException(X_FORMAT_ERROR, "Expected a string for format %s.", fmt_current);
 					// append
-					output.AppendFormat(fmt_current.GetChars(), param[argnum].s().GetChars());
+					output.AppendFormat(fmt_current, param[argnum].s().GetChars());
 					if (!haveargnums) argnum = ++argauto;
 					else argnum = -1;
 					break;
@@ -124,9 +140,9 @@ FString FStringFormat(VM_ARGS, int offset)
 					in_fmt = false;
 					// fail if something was found, but it's not a string
 					if (argnum >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format.");
-					if (va_reginfo[argnum] != REGT_POINTER) ThrowAbortException(X_FORMAT_ERROR, "Expected a pointer for format %s.", fmt_current.GetChars());
+					if (va_reginfo[argnum] != REGT_POINTER) ThrowAbortException(X_FORMAT_ERROR, "Expected a pointer for format %s.", fmt_current);
 					// append
-					output.AppendFormat(fmt_current.GetChars(), param[argnum].a);
+					output.AppendFormat(fmt_current, param[argnum].a);
 					if (!haveargnums) argnum = ++argauto;
 					else argnum = -1;
 					break;
@@ -151,11 +167,11 @@ FString FStringFormat(VM_ARGS, int offset)
 						// fail if something was found, but it's not an int
 						if (argnum+1 >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format.");
 						if (va_reginfo[argnum] != REGT_INT &&
-							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current.GetChars());
+							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current);
 						if (va_reginfo[argnum+1] != REGT_INT &&
-							va_reginfo[argnum+1] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current.GetChars());
+							va_reginfo[argnum+1] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current);
 
-						output.AppendFormat(fmt_current.GetChars(), param[argnum].ToInt(va_reginfo[argnum]), param[argnum + 1].ToInt(va_reginfo[argnum + 1]));
+						output.AppendFormat(fmt_current, param[argnum].ToInt(va_reginfo[argnum]), param[argnum + 1].ToInt(va_reginfo[argnum + 1]));
 						argauto++;
 					}
 					else
@@ -163,8 +179,8 @@ FString FStringFormat(VM_ARGS, int offset)
 						// fail if something was found, but it's not an int
 						if (argnum >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format.");
 						if (va_reginfo[argnum] != REGT_INT &&
-							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current.GetChars());
-						output.AppendFormat(fmt_current.GetChars(), param[argnum].ToInt(va_reginfo[argnum]));
+							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current);
+						output.AppendFormat(fmt_current, param[argnum].ToInt(va_reginfo[argnum]));
 					}
 					if (!haveargnums) argnum = ++argauto;
 					else argnum = -1;
@@ -189,11 +205,11 @@ FString FStringFormat(VM_ARGS, int offset)
 						// fail if something was found, but it's not an int
 						if (argnum + 1 >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format.");
 						if (va_reginfo[argnum] != REGT_INT &&
-							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current.GetChars());
+							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current);
 						if (va_reginfo[argnum + 1] != REGT_INT &&
-							va_reginfo[argnum + 1] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current.GetChars());
+							va_reginfo[argnum + 1] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current);
 
-						output.AppendFormat(fmt_current.GetChars(), param[argnum].ToInt(va_reginfo[argnum]), param[argnum + 1].ToDouble(va_reginfo[argnum + 1]));
+						output.AppendFormat(fmt_current, param[argnum].ToInt(va_reginfo[argnum]), param[argnum + 1].ToDouble(va_reginfo[argnum + 1]));
 						argauto++;
 					}
 					else
@@ -201,9 +217,9 @@ FString FStringFormat(VM_ARGS, int offset)
 						// fail if something was found, but it's not a float
 						if (argnum >= numparam) ThrowAbortException(X_FORMAT_ERROR, "Not enough arguments for format.");
 						if (va_reginfo[argnum] != REGT_INT &&
-							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current.GetChars());
+							va_reginfo[argnum] != REGT_FLOAT) ThrowAbortException(X_FORMAT_ERROR, "Expected a numeric value for format %s.", fmt_current);
 						// append
-						output.AppendFormat(fmt_current.GetChars(), param[argnum].ToDouble(va_reginfo[argnum]));
+						output.AppendFormat(fmt_current, param[argnum].ToDouble(va_reginfo[argnum]));
 					}
 					if (!haveargnums) argnum = ++argauto;
 					else argnum = -1;
@@ -212,7 +228,7 @@ FString FStringFormat(VM_ARGS, int offset)
 
 				default:
 					// invalid character
-					output += fmt_current;
+					output.AppendCStrPart(fmt_current, fmt_len);
 					in_fmt = false;
 					break;
 				}
@@ -230,12 +246,16 @@ FString FStringFormat(VM_ARGS, int offset)
 				else
 				{
 					in_fmt = true;
-					fmt_current = "%";
+					fmt_reset();
 				}
 			}
 			else
 			{
-				output += c;
+				// Copy the whole run of plain text up to the next placeholder at once.
+				size_t end = i + 1;
+				while (end < fmtstring.Len() && fmtstring[end] != '%') end++;
+				output.AppendCStrPart(fmtstring.GetChars() + i, end - i);
+				i = end - 1;
 			}
 		}
 	}
@@ -1,4 +1,6 @@
 
+#include <thread>
+#include <condition_variable>
 #include "jit.h"
 #include "jitintern.h"
 #include "printf.h"
@@ -9,7 +11,7 @@ extern PStruct *TypeVector3;
 
 static void OutputJitLog(const asmjit::StringLogger &logger);
 
-JitFuncPtr JitCompile(VMScriptFunction *sfunc)
+JitFuncPtr JitCompile(VMScriptFunction *sfunc, bool quiet)
 {
 #if 0
 	if (strcmp(sfunc->PrintableName.GetChars(), "StatusScreen.drawNum") != 0)
@@ -17,29 +19,138 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 #endif
 
 	using namespace asmjit;
-	StringLogger logger;
+	std::lock_guard<std::recursive_mutex> lock(JitMutex);
 	try
 	{
+		// Functions may get compiled in the middle of a game once they become hot,
+		// so do not waste any time on logging output unless something goes wrong.
 		ThrowingErrorHandler errorHandler;
 		CodeHolder code;
 		code.init(GetHostCodeInfo());
 		code.setErrorHandler(&errorHandler);
-		code.setLogger(&logger);
 
 		JitCompiler compiler(&code, sfunc);
 		return reinterpret_cast<JitFuncPtr>(AddJitFunction(&code, &compiler));
 	}
 	catch (const CRecoverableError &e)
 	{
+		// The background thread may not print. The caller compiles the function
+		// again on the main thread to get the log.
+		if (quiet)
+			return nullptr;
+
+		// Generate the code again with a logger attached to show where it failed.
+		StringLogger logger;
+		try
+		{
+			ThrowingErrorHandler errorHandler;
+			CodeHolder code;
+			code.init(GetHostCodeInfo());
+			code.setErrorHandler(&errorHandler);
+			code.setLogger(&logger);
+
+			JitCompiler compiler(&code, sfunc);
+			compiler.Codegen();
+		}
+		catch (const CRecoverableError &)
+		{
+		}
 		OutputJitLog(logger);
 		Printf("%s: Unexpected JIT error: %s\n",sfunc->PrintableName.GetChars(), e.what());
 		return nullptr;
 	}
 }
 
+//==========================================================================
+//
+// Background compilation
+//
+// The first call of a function only queues it here and gets interpreted.
+// Once the native code is ready, FirstScriptCall installs it on the main
+// thread, so ScriptCall itself is never written from the compile thread.
+//
+//==========================================================================
+
+static std::mutex CompileQueueMutex;
+static std::condition_variable CompileQueueWake;
+static TArray<VMScriptFunction *> CompileQueue;
+static std::thread CompileThread;
+static bool StopCompileThread;
+
+static void CompileThreadProc()
+{
+	std::unique_lock<std::mutex> lock(CompileQueueMutex);
+	while (true)
+	{
+		CompileQueueWake.wait(lock, [] { return StopCompileThread || CompileQueue.Size() > 0; });
+		if (StopCompileThread)
+			break;
+
+		VMScriptFunction *func = CompileQueue[0];
+		CompileQueue.Delete(0);
+		lock.unlock();
+
+		JitFuncPtr code = nullptr;
+		try
+		{
+			code = JitCompile(func, true);
+		}
+		catch (...)
+		{
+		}
+		func->JitCode = code;
+		func->JitStatus.store(code ? VMScriptFunction::JIT_Done : VMScriptFunction::JIT_Failed, std::memory_order_release);
+
+		lock.lock();
+	}
+}
+
+void JitCompileInBackground(VMScriptFunction *func)
+{
+	std::unique_lock<std::mutex> lock(CompileQueueMutex);
+	if (!CompileThread.joinable())
+	{
+		StopCompileThread = false;
+		CompileThread = std::thread(CompileThreadProc);
+	}
+	func->JitStatus.store(VMScriptFunction::JIT_Queued, std::memory_order_relaxed);
+	CompileQueue.Push(func);
+	lock.unlock();
+	CompileQueueWake.notify_one();
+}
+
+void JitStopBackground()
+{
+	std::unique_lock<std::mutex> lock(CompileQueueMutex);
+	if (!CompileThread.joinable())
+		return;
+
+	StopCompileThread = true;
+	for (auto func : CompileQueue)
+	{
+		func->JitStatus.store(VMScriptFunction::JIT_None, std::memory_order_relaxed);
+	}
+	CompileQueue.Clear();
+	lock.unlock();
+	CompileQueueWake.notify_one();
+	CompileThread.join();
+}
+
+static struct FJitThreadShutdown
+{
+	~FJitThreadShutdown() { JitStopBackground(); }
+} JitThreadShutdown;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 void JitDumpLog(FILE *file, VMScriptFunction *sfunc)
 {
 	using namespace asmjit;
+	std::lock_guard<std::recursive_mutex> lock(JitMutex);
 	StringLogger logger;
 	try
 	{
@@ -97,6 +208,7 @@ static const char *OpNames[NUM_OPS] =
 
 asmjit::CCFunc *JitCompiler::Codegen()
 {
+	logging = cc.getCode()->hasLogger();
 	Setup();
 
 	int lastLine = -1;
@@ -122,7 +234,7 @@ asmjit::CCFunc *JitCompiler::Codegen()
 			LineInfo.Push(info);
 		}
 
-		if (op != OP_PARAM && op != OP_PARAMI && op != OP_VTBL)
+		if (logging && op != OP_PARAM && op != OP_PARAMI && op != OP_VTBL)
 		{
 			FString lineinfo;
 			lineinfo.Format("; line %d: %02x%02x%02x%02x %s", curLine, pc->op, pc->a, pc->b, pc->c, OpNames[op]);
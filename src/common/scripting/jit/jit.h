@@ -3,6 +3,7 @@
 
 #include "vmintern.h"
 
-JitFuncPtr JitCompile(VMScriptFunction *func);
+JitFuncPtr JitCompile(VMScriptFunction *func, bool quiet = false);
+void JitCompileInBackground(VMScriptFunction *func);
 void JitDumpLog(FILE *file, VMScriptFunction *func);
 FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames);
@@ -40,12 +40,104 @@ void JitCompiler::EmitVtbl(const VMOP *op)
 	cc.mov(regA[a], asmjit::x86::qword_ptr(regA[a], c * (int)sizeof(void*)));
 }
 
+//==========================================================================
+//
+// Returns the function in the given virtual function table slot if all
+// classes agree on it. Calls through such a slot do not need to be
+// dispatched at run time.
+//
+//==========================================================================
+
+struct FUniqueVirtual
+{
+	bool Checked;
+	VMFunction *Func;
+};
+
+static VMFunction *FindUniqueVirtual(unsigned slot)
+{
+	static TArray<FUniqueVirtual> slots;
+	static unsigned numclasses;
+
+	if (numclasses != PClass::AllClasses.Size())
+	{
+		// Only classes that get added after the scripts are compiled can change the result.
+		numclasses = PClass::AllClasses.Size();
+		slots.Clear();
+	}
+	if (slot >= slots.Size())
+	{
+		unsigned oldsize = slots.Size();
+		slots.Resize(slot + 1);
+		memset(&slots[oldsize], 0, (slot + 1 - oldsize) * sizeof(FUniqueVirtual));
+	}
+
+	auto &entry = slots[slot];
+	if (!entry.Checked)
+	{
+		entry.Checked = true;
+		for (auto cls : PClass::AllClasses)
+		{
+			// Empty slots belong to abstract functions which can never be the call target.
+			if (slot >= cls->Virtuals.Size() || cls->Virtuals[slot] == nullptr) continue;
+			if (entry.Func == nullptr)
+			{
+				entry.Func = cls->Virtuals[slot];
+			}
+			else if (entry.Func != cls->Virtuals[slot])
+			{
+				entry.Func = nullptr;
+				break;
+			}
+		}
+	}
+	return entry.Func;
+}
+
 void JitCompiler::EmitCALL()
 {
-	EmitVMCall(regA[A], nullptr);
+	VMFunction *target = nullptr;
+	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
+	{
+		target = FindUniqueVirtual((pc - 1)->c);
+	}
+
+	if (target == nullptr)
+	{
+		EmitVMCall(regA[A], nullptr);
+	}
+	else
+	{
+		// Nothing overrides this virtual function, so call it like a non-virtual one.
+		EmitDevirtualizedVtbl(pc - 1, target);
+
+		VMNativeFunction *ntarget = nullptr;
+		if (target->VarFlags & VARF_Native)
+			ntarget = static_cast<VMNativeFunction *>(target);
+
+		if (ntarget && ntarget->DirectNativeCall)
+		{
+			EmitNativeCall(ntarget, true);
+		}
+		else
+		{
+			auto ptr = newTempIntPtr();
+			cc.mov(ptr, asmjit::imm_ptr(target));
+			EmitVMCall(ptr, target, true);
+		}
+	}
 	pc += C; // Skip RESULTs
 }
 
+void JitCompiler::EmitDevirtualizedVtbl(const VMOP *op, VMFunction *target)
+{
+	auto label = EmitThrowExceptionLabel(X_READ_NIL);
+	cc.test(regA[op->b], regA[op->b]);
+	cc.jz(label);
+
+	cc.mov(regA[op->a], asmjit::imm_ptr(target));
+}
+
 void JitCompiler::EmitCALL_K()
 {
 	VMFunction *target = static_cast<VMFunction*>(konsta[A].v);
@@ -68,7 +160,7 @@ void JitCompiler::EmitCALL_K()
 	pc += C; // Skip RESULTs
 }
 
-void JitCompiler::EmitVMCall(asmjit::X86Gp vmfunc, VMFunction *target)
+void JitCompiler::EmitVMCall(asmjit::X86Gp vmfunc, VMFunction *target, bool devirtualized)
 {
 	using namespace asmjit;
 
@@ -78,7 +170,7 @@ void JitCompiler::EmitVMCall(asmjit::X86Gp vmfunc, VMFunction *target)
 	if (numparams != B)
 		I_Error("OP_CALL parameter count does not match the number of preceding OP_PARAM instructions");
 
-	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
+	if (!devirtualized && pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
 		EmitVtbl(pc - 1);
 
 	FillReturns(pc + 1, C);
@@ -314,11 +406,11 @@ void JitCompiler::FillReturns(const VMOP *retval, int numret)
 	}
 }
 
-void JitCompiler::EmitNativeCall(VMNativeFunction *target)
+void JitCompiler::EmitNativeCall(VMNativeFunction *target, bool devirtualized)
 {
 	using namespace asmjit;
 
-	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
+	if (!devirtualized && pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
 	{
 		I_Error("Native direct member function calls not implemented\n");
 	}
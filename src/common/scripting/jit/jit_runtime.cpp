@@ -22,6 +22,10 @@ struct JitFuncInfo
 	void *end;
 };
 
+// Held while compiling and while looking at the compiled code's debug info,
+// since functions may get compiled on the background thread.
+std::recursive_mutex JitMutex;
+
 static TArray<JitFuncInfo> JitDebugInfo;
 static TArray<uint8_t*> JitBlocks;
 static TArray<uint8_t*> JitFrames;
@@ -305,7 +309,8 @@ void *AddJitFunction(asmjit::CodeHolder* code, JitCompiler *compiler)
 	if (result == 0)
 		I_Error("RtlAddFunctionTable failed");
 
-	JitDebugInfo.Push({ compiler->GetScriptFunction()->PrintableName, compiler->GetScriptFunction()->SourceFileName, compiler->LineInfo, startaddr, endaddr });
+	// Copy the strings' contents, sharing their buffers is not safe from the background thread.
+	JitDebugInfo.Push({ compiler->GetScriptFunction()->PrintableName.GetChars(), compiler->GetScriptFunction()->SourceFileName.GetChars(), compiler->LineInfo, startaddr, endaddr });
 #endif
 
 	return p;
@@ -729,7 +734,8 @@ void *AddJitFunction(asmjit::CodeHolder* code, JitCompiler *compiler)
 #endif
 	}
 
-	JitDebugInfo.Push({ compiler->GetScriptFunction()->PrintableName, compiler->GetScriptFunction()->SourceFileName, compiler->LineInfo, startaddr, endaddr });
+	// Copy the strings' contents, sharing their buffers is not safe from the background thread.
+	JitDebugInfo.Push({ compiler->GetScriptFunction()->PrintableName.GetChars(), compiler->GetScriptFunction()->SourceFileName.GetChars(), compiler->LineInfo, startaddr, endaddr });
 
 	return p;
 }
@@ -737,6 +743,7 @@ void *AddJitFunction(asmjit::CodeHolder* code, JitCompiler *compiler)
 
 void JitRelease()
 {
+	std::lock_guard<std::recursive_mutex> lock(JitMutex);
 #ifdef _WIN64
 	for (auto p : JitFrames)
 	{
@@ -957,6 +964,8 @@ FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames)
 	void *frames[32];
 	int numframes = CaptureStackTrace(32, frames);
 
+	std::lock_guard<std::recursive_mutex> lock(JitMutex);
+
 	std::unique_ptr<NativeSymbolResolver> nativeSymbols;
 	if (includeNativeFrames)
 		nativeSymbols.reset(new NativeSymbolResolver());
@@ -12,9 +12,11 @@
 #include <asmjit/x86.h>
 #include <functional>
 #include <vector>
+#include <mutex>
 
 extern cycle_t VMCycles[10];
 extern int VMCalls[10];
+extern std::recursive_mutex JitMutex;
 
 #define A				(pc[0].a)
 #define B				(pc[0].b)
@@ -43,6 +45,8 @@ public:
 	TArray<JitLineInfo> LineInfo;
 
 private:
+	bool logging = false;
+
 	// Declare EmitXX functions for the opcodes:
 	#define xx(op, name, mode, alt, kreg, ktype)	void Emit##op();
 	#include "vmops.h"
@@ -60,9 +64,10 @@ private:
 	void EmitOpcode();
 	void EmitPopFrame();
 
-	void EmitNativeCall(VMNativeFunction *target);
-	void EmitVMCall(asmjit::X86Gp ptr, VMFunction *target);
+	void EmitNativeCall(VMNativeFunction *target, bool devirtualized = false);
+	void EmitVMCall(asmjit::X86Gp ptr, VMFunction *target, bool devirtualized = false);
 	void EmitVtbl(const VMOP *op);
+	void EmitDevirtualizedVtbl(const VMOP *op, VMFunction *target);
 
 	int StoreCallParams();
 	void LoadInOuts();
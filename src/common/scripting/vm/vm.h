@@ -55,6 +55,7 @@ extern FMemArena ClassDataAllocator;
 #define MAX_TRY_DEPTH	8	// Maximum number of nested TRYs in a single function
 
 void JitRelease();
+void JitStopBackground();
 
 extern void (*VM_CastSpriteIDToString)(FString* a, unsigned int b);
 
@@ -414,6 +415,7 @@ public:
 	TArray<uint32_t> ArgFlags;		// Should be the same length as Proto->ArgumentTypes
 
 	int(*ScriptCall)(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret) = nullptr;
+	int(*ProfiledScriptCall)(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret) = nullptr;	// the real ScriptCall while the profiler is active
 
 	VMFunction(FName name = NAME_None) : ImplicitArgs(0), Name(name), Proto(NULL)
 	{
@@ -430,6 +432,8 @@ public:
 	void operator delete[](void *block) {}
 	static void DeleteAll()
 	{
+		// nothing may still be compiling the functions that get destroyed here
+		JitStopBackground();
 		for (auto f : AllFunctions)
 		{
 			f->~VMFunction();
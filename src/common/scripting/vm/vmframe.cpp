@@ -33,9 +33,11 @@
 */
 
 #include <new>
+#include <algorithm>
 #include "dobject.h"
 #include "v_text.h"
 #include "stats.h"
+#include "memstats.h"
 #include "c_dispatch.h"
 #include "templates.h"
 #include "vmintern.h"
@@ -43,6 +45,8 @@
 #include "jit.h"
 #include "c_cvars.h"
 #include "version.h"
+#include "i_time.h"
+#include "files.h"
 
 #ifdef HAVE_VM_JIT
 #ifdef __DragonFly__
@@ -54,10 +58,18 @@ CUSTOM_CVAR(Bool, vm_jit, true, CVAR_NOINITCALL)
 	Printf("You must restart " GAMENAME " for this change to take effect.\n");
 	Printf("This cvar is currently not saved. You must specify it on the command line.");
 }
+
+// Number of interpreted calls before a function gets compiled. With 0 every function gets compiled on its first call.
+CUSTOM_CVAR(Int, vm_jit_threshold, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+}
+CVARD(Bool, vm_jit_background, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "compile script functions on a background thread and interpret them until the native code is ready")
 #else
 CVAR(Bool, vm_jit, false, CVAR_NOINITCALL|CVAR_NOSET)
 FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames) { return FString(); }
 void JitRelease() {}
+void JitStopBackground() {}
 #endif
 
 cycle_t VMCycles[10];
@@ -285,6 +297,36 @@ static bool CanJit(VMScriptFunction *func)
 int VMScriptFunction::FirstScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
 {
 #ifdef HAVE_VM_JIT
+	if (vm_jit && static_cast<VMScriptFunction*>(func)->CallCount++ < vm_jit_threshold)
+	{
+		// Not hot enough yet to be worth compiling, so keep ScriptCall pointing here and interpret it.
+		return VMExec(func, params, numparams, ret, numret);
+	}
+	if (vm_jit && vm_jit_background)
+	{
+		auto sfunc = static_cast<VMScriptFunction*>(func);
+		switch (sfunc->JitStatus.load(std::memory_order_acquire))
+		{
+		case VMScriptFunction::JIT_None:
+			if (!CanJit(sfunc))
+			{
+				func->ScriptCall = VMExec;
+				return VMExec(func, params, numparams, ret, numret);
+			}
+			JitCompileInBackground(sfunc);
+			[[fallthrough]];
+		case VMScriptFunction::JIT_Queued:
+			return VMExec(func, params, numparams, ret, numret);
+
+		case VMScriptFunction::JIT_Done:
+			func->ScriptCall = sfunc->JitCode;
+			return func->ScriptCall(func, params, numparams, ret, numret);
+
+		default:
+			// Failed. Compile it here again, this time with the error log.
+			break;
+		}
+	}
 	if (vm_jit && CanJit(static_cast<VMScriptFunction*>(func)))
 	{
 		func->ScriptCall = JitCompile(static_cast<VMScriptFunction*>(func));
@@ -363,6 +405,7 @@ VMFrameStack::~VMFrameStack()
 		for (block = Blocks; block != NULL; block = next)
 		{
 			next = block->NextBlock;
+			MemStat_Add(MEM_VMFrames, -block->BlockSize);
 			delete[] (VM_UBYTE *)block;
 		}
 		Blocks = NULL;
@@ -373,6 +416,7 @@ VMFrameStack::~VMFrameStack()
 		for (block = UnusedBlocks; block != NULL; block = next)
 		{
 			next = block->NextBlock;
+			MemStat_Add(MEM_VMFrames, -block->BlockSize);
 			delete[] (VM_UBYTE *)block;
 		}
 		UnusedBlocks = NULL;
@@ -397,7 +441,14 @@ VMFrame *VMFrameStack::AllocFrame(VMScriptFunction *func)
 	frame->NumRegS = func->NumRegS;
 	frame->NumRegA = func->NumRegA;
 	frame->MaxParam = func->MaxParam;
-	frame->Func = func;
+	frame->NumParam = 0;
+
+	// Only clear what may be read before it gets written: The parameter area is always filled
+	// by OP_PARAM before a call reads it, and the string registers get constructed anyway.
+	// Everything from the pointer registers on, i.e. the integer registers and the extra space, is contiguous.
+	memset(frame->GetRegF(), 0, func->NumRegF * sizeof(double));
+	uint8_t *rega = (uint8_t *)frame->GetRegA();
+	memset(rega, 0, (uint8_t *)frame + ((func->StackSize + 15) & ~15) - rega);
 	frame->InitRegS();
 	if (func->SpecialInits.Size())
 	{
@@ -453,6 +504,7 @@ VMFrame *VMFrameStack::Alloc(int size)
 		{
 			block = (BlockHeader *)new VM_UBYTE[blocksize];
 			block->BlockSize = blocksize;
+			MemStat_Add(MEM_VMFrames, blocksize);
 		}
 		block->InitFreeSpace();
 		block->LastFrame = NULL;
@@ -460,7 +512,7 @@ VMFrame *VMFrameStack::Alloc(int size)
 		Blocks = block;
 	}
 	frame = (VMFrame *)block->FreeSpace;
-	memset(frame, 0, size);
+	// AllocFrame clears the registers which need it.
 	frame->ParentFrame = parent;
 	block->FreeSpace += size;
 	block->LastFrame = frame;
@@ -773,3 +825,221 @@ CCMD(vmengine)
 	Printf("Usage: vmengine <default|checked|unchecked>\n");
 }
 
+
+//==========================================================================
+//
+// Script profiler
+//
+// While active, every script function's ScriptCall gets replaced with a
+// thunk that measures the call, so this works for interpreted and JIT
+// compiled code alike. Calls are recorded per call path, which allows
+// exporting the results as collapsed stacks for flame graph tools.
+// Natives which the JIT calls directly are not seen and count towards
+// their caller's own time.
+//
+//==========================================================================
+
+struct FProfileNode
+{
+	VMFunction *Func;
+	int Parent;
+	TArray<int> Children;
+	uint64_t Calls;
+	uint64_t Inclusive;	// in nanoseconds
+	uint64_t ChildTime;
+};
+
+static TArray<FProfileNode> ProfileNodes;
+static int ProfileCurrent = -1;
+static bool ProfileActive;
+
+static int FindProfileNode(int parent, VMFunction *func)
+{
+	for (auto child : ProfileNodes[parent].Children)
+	{
+		if (ProfileNodes[child].Func == func) return child;
+	}
+	int index = ProfileNodes.Reserve(1);
+	auto &node = ProfileNodes[index];
+	node.Func = func;
+	node.Parent = parent;
+	node.Calls = node.Inclusive = node.ChildTime = 0;
+	// The array may have been reallocated so the parent must be looked up again.
+	ProfileNodes[parent].Children.Push(index);
+	return index;
+}
+
+static int ProfilerScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	int parent = ProfileCurrent;
+	int node = FindProfileNode(parent, func);
+	ProfileCurrent = node;
+
+	auto finish = [=](uint64_t start)
+	{
+		uint64_t time = I_nsTime() - start;
+		ProfileNodes[node].Calls++;
+		ProfileNodes[node].Inclusive += time;
+		if (parent > 0) ProfileNodes[parent].ChildTime += time;
+		ProfileCurrent = parent;
+	};
+
+	int result;
+	uint64_t start = I_nsTime();
+	try
+	{
+		result = func->ProfiledScriptCall(func, params, numparams, ret, numret);
+	}
+	catch (...)
+	{
+		finish(start);
+		throw;
+	}
+	finish(start);
+
+	// FirstScriptCall replaces ScriptCall with the real function once it gets called, so take that over.
+	if (ProfileActive && func->ScriptCall != ProfilerScriptCall)
+	{
+		func->ProfiledScriptCall = func->ScriptCall;
+		func->ScriptCall = ProfilerScriptCall;
+	}
+	return result;
+}
+
+static void StartProfiler()
+{
+	if (ProfileActive) return;
+	if (ProfileNodes.Size() == 0)
+	{
+		// Node 0 is the root which holds everything called from native code.
+		auto &root = ProfileNodes[ProfileNodes.Reserve(1)];
+		root.Func = nullptr;
+		root.Parent = -1;
+		root.Calls = root.Inclusive = root.ChildTime = 0;
+	}
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (!(func->VarFlags & VARF_Native) && func->ScriptCall != nullptr)
+		{
+			func->ProfiledScriptCall = func->ScriptCall;
+			func->ScriptCall = ProfilerScriptCall;
+		}
+	}
+	ProfileCurrent = 0;
+	ProfileActive = true;
+}
+
+static void StopProfiler()
+{
+	if (!ProfileActive) return;
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (func->ScriptCall == ProfilerScriptCall)
+		{
+			func->ScriptCall = func->ProfiledScriptCall;
+			func->ProfiledScriptCall = nullptr;
+		}
+	}
+	ProfileCurrent = -1;
+	ProfileActive = false;
+}
+
+static void WriteCollapsedStack(FileWriter *fw, int index, const FString &path)
+{
+	auto &node = ProfileNodes[index];
+	FString mypath = path;
+	if (node.Func != nullptr)
+	{
+		if (mypath.IsNotEmpty()) mypath += ';';
+		mypath += node.Func->PrintableName;
+		uint64_t exclusive = node.Inclusive > node.ChildTime ? node.Inclusive - node.ChildTime : 0;
+		if (exclusive >= 1000) fw->Printf("%s %llu\n", mypath.GetChars(), (unsigned long long)(exclusive / 1000));
+	}
+	for (unsigned i = 0; i < ProfileNodes[index].Children.Size(); i++)
+	{
+		WriteCollapsedStack(fw, ProfileNodes[index].Children[i], mypath);
+	}
+}
+
+//-----------------------------------------------------------------------------
+//
+//
+//
+//-----------------------------------------------------------------------------
+
+CCMD(vmprofile)
+{
+	if (argv.argc() >= 2)
+	{
+		if (stricmp(argv[1], "start") == 0)
+		{
+			StartProfiler();
+			return;
+		}
+		else if (stricmp(argv[1], "stop") == 0)
+		{
+			StopProfiler();
+			return;
+		}
+		else if (stricmp(argv[1], "clear") == 0)
+		{
+			bool active = ProfileActive;
+			StopProfiler();
+			ProfileNodes.Clear();
+			if (active) StartProfiler();
+			return;
+		}
+		else if (stricmp(argv[1], "report") == 0)
+		{
+			struct FFuncProfile
+			{
+				VMFunction *Func = nullptr;
+				uint64_t Calls = 0, Inclusive = 0, Exclusive = 0;
+			};
+			TMap<VMFunction *, FFuncProfile> funcs;
+			for (unsigned i = 1; i < ProfileNodes.Size(); i++)
+			{
+				auto &node = ProfileNodes[i];
+				auto &prof = funcs[node.Func];
+				prof.Func = node.Func;
+				prof.Calls += node.Calls;
+				// Recursive calls are counted multiple times in the inclusive time.
+				prof.Inclusive += node.Inclusive;
+				prof.Exclusive += node.Inclusive > node.ChildTime ? node.Inclusive - node.ChildTime : 0;
+			}
+			TArray<FFuncProfile> sorted;
+			TMap<VMFunction *, FFuncProfile>::Iterator it(funcs);
+			TMap<VMFunction *, FFuncProfile>::Pair *pair;
+			while (it.NextPair(pair)) sorted.Push(pair->Value);
+			std::sort(sorted.begin(), sorted.end(), [](const FFuncProfile &a, const FFuncProfile &b) { return a.Exclusive > b.Exclusive; });
+
+			unsigned count = argv.argc() >= 3 ? (unsigned)atoi(argv[2]) : 20;
+			Printf(TEXTCOLOR_YELLOW "%-50s %10s %12s %12s\n", "Function", "Calls", "Incl. ms", "Excl. ms");
+			for (unsigned i = 0; i < sorted.Size() && i < count; i++)
+			{
+				Printf("%-50s %10llu %12.3f %12.3f\n", sorted[i].Func->PrintableName.GetChars(), (unsigned long long)sorted[i].Calls,
+					sorted[i].Inclusive / 1000000., sorted[i].Exclusive / 1000000.);
+			}
+			return;
+		}
+		else if (stricmp(argv[1], "dump") == 0 && argv.argc() >= 3)
+		{
+			if (ProfileNodes.Size() == 0)
+			{
+				Printf("No profiling data collected\n");
+				return;
+			}
+			FileWriter *fw = FileWriter::Open(argv[2]);
+			if (fw == nullptr)
+			{
+				Printf("Could not open %s\n", argv[2]);
+				return;
+			}
+			WriteCollapsedStack(fw, 0, "");
+			delete fw;
+			Printf("Collapsed stacks (exclusive time in microseconds) written to %s\n", argv[2]);
+			return;
+		}
+	}
+	Printf("Usage: vmprofile <start|stop|clear|report [count]|dump filename>\n");
+}
@@ -2,6 +2,7 @@
 
 #include "vm.h"
 #include <csetjmp>
+#include <atomic>
 
 class VMScriptFunction;
 
@@ -471,6 +472,17 @@ public:
 	VM_UHALF NumKonstA;
 	VM_UHALF MaxParam;		// Maximum number of parameters this function has on the stack at once
 	VM_UBYTE NumArgs;		// Number of arguments this function takes
+	int CallCount = 0;		// Number of interpreted calls while waiting to be compiled
+
+	enum
+	{
+		JIT_None,
+		JIT_Queued,
+		JIT_Done,
+		JIT_Failed,
+	};
+	std::atomic<int> JitStatus{ JIT_None };	// state of the background compilation
+	JitFuncPtr JitCode = nullptr;			// only valid once JitStatus is JIT_Done
 	TArray<FTypeAndOffset> SpecialInits;	// list of all contents on the extra stack which require construction and destruction
 
 	void InitExtra(void *addr);
@@ -51,10 +51,16 @@ void AnimTexture::SetFrameSize(int  format, int width, int height)
 
 void AnimTexture::SetFrame(const uint8_t* palette, const void* data_)
 {
-    memcpy(Palette, palette, 768);
+    if (pixelformat == Paletted)
+    {
+        // Convert the palette once here instead of doing it for every pixel when uploading.
+        for (int i = 0; i < 256; i++)
+        {
+            Palette[i] = PalEntry(255, palette[i * 3], palette[i * 3 + 1], palette[i * 3 + 2]);
+        }
+    }
     memcpy(Image.Data(), data_, Width * Height * (pixelformat == Paletted ? 1 : 3));
     CleanHardwareTextures();
-    pixelformat = Paletted;
 }
 
 //===========================================================================
@@ -73,24 +79,22 @@ FBitmap AnimTexture::GetBgraBitmap(const PalEntry* remap, int* trans)
     auto dpix = bmp.GetPixels();
     if (pixelformat == Paletted)
     {
+        auto dpal = (PalEntry*)dpix;
         for (int i = 0; i < Width * Height; i++)
         {
-            int p = i * 4;
-            int index = spix[i];
-            dpix[p + 0] = Palette[index * 3 + 2];
-            dpix[p + 1] = Palette[index * 3 + 1];
-            dpix[p + 2] = Palette[index * 3];
-            dpix[p + 3] = 255;
+            dpal[i] = Palette[spix[i]];
         }
     }
     else if (pixelformat == RGB)
     {
+        // The source has 3 bytes per pixel, the bitmap 4.
         for (int i = 0; i < Width * Height; i++)
         {
             int p = i * 4;
-            dpix[p + 0] = spix[p + 2];
-            dpix[p + 1] = spix[p + 1];
-            dpix[p + 2] = spix[p];
+            int s = i * 3;
+            dpix[p + 0] = spix[s + 2];
+            dpix[p + 1] = spix[s + 1];
+            dpix[p + 2] = spix[s];
             dpix[p + 3] = 255;
         }
     }
@@ -99,9 +103,10 @@ FBitmap AnimTexture::GetBgraBitmap(const PalEntry* remap, int* trans)
         for (int i = 0; i < Width * Height; i++)
         {
             int p = i * 4;
-            float y = spix[p] * (1 / 255.f);
-            float u = spix[p + 1] * (1 / 255.f) - 0.5f;
-            float v = spix[p + 2] * (1 / 255.f) - 0.5f;
+            int s = i * 3;
+            float y = spix[s] * (1 / 255.f);
+            float u = spix[s + 1] * (1 / 255.f) - 0.5f;
+            float v = spix[s + 2] * (1 / 255.f) - 0.5f;
 
             y = 1.1643f * (y - 0.0625f);
 
@@ -5,7 +5,7 @@
 
 class AnimTexture : public FTexture
 {
-	uint8_t Palette[768];
+	PalEntry Palette[256];	// already in the bitmap's BGRA layout
 	TArray<uint8_t> Image;
 	int pixelformat;
 public:
@@ -35,6 +35,11 @@
 #include "bitmap.h"
 #include "palutil.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BITMAP_SSE2
+#include <emmintrin.h>
+#endif
+
 uint8_t IcePalette[16][3] =
 {
 	{  10,  8, 18 },
@@ -230,6 +235,69 @@ static const CopyFunc copyfuncs[][11]={
 };
 #undef COPY_FUNCS
 
+//===========================================================================
+//
+// Fast paths for the by far most common case, copying unblended 32 bit
+// pixels, which is what building textures and composing multipatch
+// textures mostly do. These work on whole pixels instead of single color
+// components. Like bCopy, pixels with an alpha of 0 leave the destination
+// alone unless 'overwrite' is set.
+//
+//===========================================================================
+
+#ifndef __BIG_ENDIAN__
+static void CopyRow32(uint8_t *pout, const uint8_t *pin, int count, bool swaprb, bool overwrite)
+{
+	uint32_t *out = (uint32_t *)pout;
+	int i = 0;
+#ifdef BITMAP_SSE2
+	const __m128i alphamask = _mm_set1_epi32(0xff000000);
+	const __m128i agmask = _mm_set1_epi32(0xff00ff00);
+	const __m128i lowmask = _mm_set1_epi32(0xff);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i *)(pin + i * 4));
+		if (swaprb)
+		{
+			__m128i r = _mm_and_si128(c, lowmask);
+			__m128i b = _mm_and_si128(_mm_srli_epi32(c, 16), lowmask);
+			c = _mm_or_si128(_mm_and_si128(c, agmask), _mm_or_si128(b, _mm_slli_epi32(r, 16)));
+		}
+		if (!overwrite)
+		{
+			__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(c, alphamask), zero);
+			__m128i d = _mm_loadu_si128((const __m128i *)(out + i));
+			c = _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, c));
+		}
+		_mm_storeu_si128((__m128i *)(out + i), c);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		uint32_t c;
+		memcpy(&c, pin + i * 4, 4);
+		if (swaprb) c = (c & 0xff00ff00) | ((c >> 16) & 0xff) | ((c & 0xff) << 16);
+		if (overwrite || (c & 0xff000000)) out[i] = c;
+	}
+}
+
+static void CopyPaletted32(uint8_t *buffer, const uint8_t *patch, int srcwidth, int srcheight, int Pitch,
+	int step_x, int step_y, const PalEntry *palette, bool overwrite)
+{
+	for (int y = 0; y < srcheight; y++)
+	{
+		uint32_t *out = (uint32_t *)(buffer + y * Pitch);
+		const uint8_t *in = patch + y * step_y;
+		for (int x = 0; x < srcwidth; x++, in += step_x)
+		{
+			uint32_t c = palette[*in].d;
+			if (overwrite || (c & 0xff000000)) out[x] = c;
+		}
+	}
+}
+#endif
+
 //===========================================================================
 //
 // Clips the copy area for CopyPixelData functions
@@ -396,6 +464,17 @@ void FBitmap::CopyPixelDataRGB(int originx, int originy, const uint8_t *patch, i
 	{
 		uint8_t *buffer = data + 4 * originx + Pitch * originy;
 		int op = inf==NULL? OP_COPY : inf->op;
+#ifndef __BIG_ENDIAN__
+		if ((op == OP_COPY || op == OP_OVERWRITE) && (inf == NULL || inf->blend == BLEND_NONE) && step_x == 4 &&
+			(ct == CF_BGRA || ct == CF_PalEntry || ct == CF_RGBA))
+		{
+			for (int y = 0; y < srcheight; y++)
+			{
+				CopyRow32(&buffer[y*Pitch], &patch[y*step_y], srcwidth, ct == CF_RGBA, op == OP_OVERWRITE);
+			}
+			return;
+		}
+#endif
 		for (int y=0;y<srcheight;y++)
 		{
 			copyfuncs[op][ct](&buffer[y*Pitch], &patch[y*step_y], srcwidth, step_x, inf, r, g, b);
@@ -474,7 +553,15 @@ void FBitmap::CopyPixelData(int originx, int originy, const uint8_t * patch, int
 			}
 		}
 
-		copypalettedfuncs[inf==NULL? OP_COPY : inf->op](buffer, patch, srcwidth, srcheight, Pitch, 
+		int op = inf == NULL ? OP_COPY : inf->op;
+#ifndef __BIG_ENDIAN__
+		if (op == OP_COPY || op == OP_OVERWRITE)
+		{
+			CopyPaletted32(buffer, patch, srcwidth, srcheight, Pitch, step_x, step_y, palette, op == OP_OVERWRITE);
+			return;
+		}
+#endif
+		copypalettedfuncs[op](buffer, patch, srcwidth, srcheight, Pitch, 
 														step_x, step_y, rotate, palette, inf);
 	}
 }
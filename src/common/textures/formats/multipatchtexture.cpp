@@ -154,7 +154,7 @@ static uint8_t *GetBlendMap(PalEntry blend, uint8_t *blendwork)
 
 void FMultiPatchTexture::CopyToBlock(uint8_t *dest, int dwidth, int dheight, FImageSource *source, int xpos, int ypos, int rotate, const uint8_t *translation, int style)
 {
-	auto cimage = source->GetCachedPalettedPixels(style);	// should use composition cache
+	auto cimage = source->GetCachedPalettedPixels(style);
 	auto &image = cimage.Pixels;
 	const uint8_t *pixels = image.Data();
 	int srcwidth = source->GetWidth();
@@ -203,6 +203,7 @@ void FMultiPatchTexture::CopyToBlock(uint8_t *dest, int dwidth, int dheight, FIm
 
 TArray<uint8_t> FMultiPatchTexture::CreatePalettedPixels(int conversion)
 {
+	FComposingScope composing;
 	int numpix = Width * Height;
 	uint8_t blendwork[256];
 	bool buildrgb = bComplex;
@@ -280,6 +281,7 @@ TArray<uint8_t> FMultiPatchTexture::CreatePalettedPixels(int conversion)
 
 int FMultiPatchTexture::CopyPixels(FBitmap *bmp, int conversion)
 {
+	FComposingScope composing;
 	int retv = -1;
 
 	if (conversion == noremap0)
@@ -45,6 +45,11 @@
 #include "textures.h"
 #include "texturemanager.h"
 #include "printf.h"
+#include "md5.h"
+#include "files.h"
+#include "cmdlib.h"
+#include "i_specialpaths.h"
+#include <zlib.h>
 
 int upscalemask;
 
@@ -101,6 +106,8 @@ CUSTOM_CVAR(Int, gl_texture_hqresize_mt_height, 4, CVAR_ARCHIVE | CVAR_GLOBALCON
 
 CVAR(Int, xbrz_colorformat, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
+CVARD(Bool, gl_texture_hqresize_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "keep upscaled textures in the disk cache so that they only need to be upscaled once")
+
 void UpdateUpscaleMask()
 {
 	if (!gl_texture_hqresizemode || gl_texture_hqresizemult == 1) upscalemask = 0;
@@ -314,7 +321,7 @@ static unsigned char *hqNxAsmHelper( void (*hqNxFunction) ( int*, unsigned char*
 }
 #endif
 
-static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*, unsigned*, int, int ),
+static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( uint32_t*, uint32_t, uint32_t*, uint32_t, int, int, int, int ),
 							  const int N,
 							  unsigned char *inputBuffer,
 							  const int inWidth,
@@ -333,7 +340,27 @@ static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*,
 	outHeight = N *inHeight;
 
 	unsigned char * newBuffer = new unsigned char[outWidth*outHeight*4];
-	hqNxFunction( reinterpret_cast<unsigned*>(inputBuffer), reinterpret_cast<unsigned*>(newBuffer), inWidth, inHeight );
+
+	const int thresholdWidth  = gl_texture_hqresize_mt_width;
+	const int thresholdHeight = gl_texture_hqresize_mt_height;
+	const uint32_t inRowBytes = inWidth * 4;
+	const uint32_t outRowBytes = outWidth * 4;
+
+	if (gl_texture_hqresize_multithread
+		&& inWidth  > thresholdWidth
+		&& inHeight > thresholdHeight)
+	{
+		parallel_for(inHeight, thresholdHeight, [=](int sliceY)
+		{
+			hqNxFunction(reinterpret_cast<uint32_t*>(inputBuffer), inRowBytes, reinterpret_cast<uint32_t*>(newBuffer), outRowBytes,
+				inWidth, inHeight, sliceY, sliceY + thresholdHeight);
+		});
+	}
+	else
+	{
+		hqNxFunction(reinterpret_cast<uint32_t*>(inputBuffer), inRowBytes, reinterpret_cast<uint32_t*>(newBuffer), outRowBytes,
+			inWidth, inHeight, 0, inHeight);
+	}
 	delete[] inputBuffer;
 	return newBuffer;
 }
@@ -411,6 +438,85 @@ static void xbrzOldScale(size_t factor, const uint32_t* src, uint32_t* trg, int
 }
 
 
+//===========================================================================
+// 
+// Disk cache for the upscaled images.
+//
+// The cache is keyed by the source pixels and all settings affecting the
+// scaler's output so an entry can never be stale, which allows it to be shared
+// between all games and content sets. Only the expensive scalers are cached.
+//
+//===========================================================================
+
+static const char UpscaleCacheMagic[4] = { 'Z', 'H', 'Q', '1' };
+
+static FString UpscaleCacheDir(bool create)
+{
+	FString path = M_GetCachePath(create);
+	path << "/upscaled";
+	if (create) CreatePath(path);
+	return path;
+}
+
+static bool UpscaleCacheKey(int type, int mult, const unsigned char *buffer, int width, int height, FString &path)
+{
+	if (!gl_texture_hqresize_cache || type < 2 || type > 5) return false;
+
+	MD5Context md5;
+	int32_t header[] = { type, mult, width, height };
+	md5.Update((const uint8_t*)header, sizeof(header));
+	if (type >= 4)
+	{
+		float options[] = { xbrz_luminanceweight, xbrz_equalcolortolerance, xbrz_centerdirectionbias, xbrz_dominantdirectionthreshold, xbrz_steepdirectionthreshold, (float)(xbrz_colorformat != 0) };
+		md5.Update((const uint8_t*)options, sizeof(options));
+	}
+	md5.Update(buffer, width * height * 4);
+	uint8_t digest[16];
+	md5.Final(digest);
+
+	path = UpscaleCacheDir(false);
+	path << '/';
+	for (auto c : digest) path.AppendFormat("%02x", c);
+	path << ".zhq";
+	return true;
+}
+
+static unsigned char *LoadUpscaledImage(const FString &path, int outWidth, int outHeight)
+{
+	FileReader fr;
+	if (!fr.OpenFile(path)) return nullptr;
+
+	char magic[4];
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, UpscaleCacheMagic, 4) != 0) return nullptr;
+	if ((int)fr.ReadUInt32() != outWidth || (int)fr.ReadUInt32() != outHeight) return nullptr;
+	auto packed = fr.Read();
+
+	uLongf size = outWidth * outHeight * 4;
+	auto output = new unsigned char[size];
+	if (uncompress(output, &size, packed.Data(), (uLong)packed.Size()) != Z_OK || size != (uLongf)(outWidth * outHeight * 4))
+	{
+		delete[] output;
+		return nullptr;
+	}
+	return output;
+}
+
+static void SaveUpscaledImage(const FString &path, const unsigned char *buffer, int outWidth, int outHeight)
+{
+	uLong size = outWidth * outHeight * 4;
+	uLongf packedsize = compressBound(size);
+	TArray<uint8_t> packed(packedsize, true);
+	if (compress2(packed.Data(), &packedsize, buffer, size, Z_BEST_SPEED) != Z_OK) return;
+
+	UpscaleCacheDir(true);
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(path));
+	if (fw == nullptr) return;
+	uint32_t dims[] = { LittleLong((uint32_t)outWidth), LittleLong((uint32_t)outHeight) };
+	fw->Write(UpscaleCacheMagic, 4);
+	fw->Write(dims, sizeof(dims));
+	fw->Write(packed.Data(), packedsize);
+}
+
 //===========================================================================
 // 
 // [BB] Upsamples the texture in texbuffer.mBuffer, frees texbuffer.mBuffer and returns
@@ -441,7 +547,18 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 
 	if (!checkonly)
 	{
-		if (type == 1)
+		FString cachepath;
+		bool cached = UpscaleCacheKey(type, mult, texbuffer.mBuffer, inWidth, inHeight, cachepath);
+		unsigned char *cachedImage = cached ? LoadUpscaledImage(cachepath, inWidth * mult, inHeight * mult) : nullptr;
+
+		if (cachedImage != nullptr)
+		{
+			delete[] texbuffer.mBuffer;
+			texbuffer.mBuffer = cachedImage;
+			texbuffer.mWidth = inWidth * mult;
+			texbuffer.mHeight = inHeight * mult;
+		}
+		else if (type == 1)
 		{
 			if (mult == 2)
 				texbuffer.mBuffer = scaleNxHelper(&scale2x, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
@@ -454,11 +571,11 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 		else if (type == 2)
 		{
 			if (mult == 2)
-				texbuffer.mBuffer = hqNxHelper(&hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+				texbuffer.mBuffer = hqNxHelper(&hq2x_32_rb, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
 			else if (mult == 3)
-				texbuffer.mBuffer = hqNxHelper(&hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+				texbuffer.mBuffer = hqNxHelper(&hq3x_32_rb, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
 			else if (mult == 4)
-				texbuffer.mBuffer = hqNxHelper(&hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+				texbuffer.mBuffer = hqNxHelper(&hq4x_32_rb, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
 			else return;
 		}
 #ifdef HAVE_MMX
@@ -481,6 +598,11 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 			texbuffer.mBuffer = normalNx(mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
 		else
 			return;
+
+		if (cached && cachedImage == nullptr)
+		{
+			SaveUpscaledImage(cachepath, texbuffer.mBuffer, texbuffer.mWidth, texbuffer.mHeight);
+		}
 	}
 	else
 	{
@@ -28,6 +28,37 @@
 #include "texturemanager.h"
 #include "c_cvars.h"
 #include "v_video.h"
+#include "image.h"
+#include "palettecontainer.h"
+#include "i_interface.h"
+
+CVARD(Bool, gl_shadertranslations, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "do palette translations in the shader instead of creating a translated copy of the texture")
+EXTERN_CVAR(Int, gl_texture_filter)
+
+//===========================================================================
+//
+// An identity row of palette indices. Its translated versions are the
+// lookup tables for the shader translations.
+//
+//===========================================================================
+
+class FTranslationLUTImage : public FImageSource
+{
+public:
+	FTranslationLUTImage()
+	{
+		Width = 256;
+		Height = 1;
+		bMasked = false;
+	}
+
+	TArray<uint8_t> CreatePalettedPixels(int conversion) override
+	{
+		TArray<uint8_t> pix(256, true);
+		for (int i = 0; i < 256; i++) pix[i] = i;
+		return pix;
+	}
+};
 
 //===========================================================================
 //
@@ -128,7 +159,6 @@ FMaterial::FMaterial(FGameTexture * tx, int scaleflags)
 	mScaleFlags = scaleflags;
 
 	mTextureLayers.ShrinkToFit();
-	tx->Material[scaleflags] = this;
 	if (tx->isHardwareCanvas()) tx->SetTranslucent(false);
 }
 
@@ -158,6 +188,65 @@ IHardwareTexture *FMaterial::GetLayer(int i, int translation, MaterialLayerInfo
 	return nullptr;
 }
 
+//===========================================================================
+//
+// Checks whether this material can be drawn with the given translation
+// from its indexed texture, so that all translations share one upload.
+// Returns the texture mode flags for that or 0 if it needs a translated
+// copy.
+//
+//===========================================================================
+
+int FMaterial::GetTranslationFlags(int translation, int clampmode) const
+{
+	if (translation <= 0 || !gl_shadertranslations || screen->IsPoly()) return 0;
+
+	// The LUT layer must not collide with one the material uses and custom shaders do not know about it.
+	if (NumLayers() > TRANSLATION_LUT_LAYER || mShaderIndex >= FIRST_USER_SHADER || mShaderIndex == SHADER_Paletted) return 0;
+
+	auto &layer = mTextureLayers[0];
+	if ((layer.scaleFlags & CTF_Upscale) || layer.layerTexture->GetImage() == nullptr || layer.layerTexture->isHardwareCanvas()) return 0;
+
+	auto remap = GPalette.TranslationToTable(translation);
+	if (remap == nullptr || remap->Index == 0 || remap->Inactive) return 0;
+
+	int filter = sysCallbacks && sysCallbacks->DisableTextureFilter && sysCallbacks->DisableTextureFilter() ? 0 : *gl_texture_filter;
+	bool linear = filter >= 2 && filter <= 4 && NoFilterClampMode(clampmode) != clampmode;
+	return linear ? TEXF_Translated | TEXF_TranslatedFilter : TEXF_Translated;
+}
+
+//===========================================================================
+//
+// Indices cannot be filtered by the hardware.
+//
+//===========================================================================
+
+int FMaterial::NoFilterClampMode(int clampmode)
+{
+	if (clampmode <= CLAMP_XY) return clampmode + CLAMP_NOFILTER - CLAMP_NONE;
+	if (clampmode == CLAMP_XY_NOMIP) return CLAMP_NOFILTER_XY;
+	if (clampmode == CLAMP_CAMTEX) return CLAMP_NOFILTER;
+	return clampmode;
+}
+
+//===========================================================================
+//
+// Its hardware textures for each translation are the lookup tables.
+// The texture manager owns it so that it gets deleted along with all the others.
+//
+//===========================================================================
+
+FTexture *FMaterial::GetTranslationLUT()
+{
+	auto texid = TexMan.CheckForTexture("@@translationlut@@", ETextureType::Any);
+	if (!texid.Exists())
+	{
+		auto tex = MakeGameTexture(new FImageTexture(new FTranslationLUTImage), "@@translationlut@@", ETextureType::Special);
+		texid = TexMan.AddGameTexture(tex);
+	}
+	return TexMan.GetGameTexture(texid)->GetTexture();
+}
+
 //==========================================================================
 //
 // Gets a texture from the texture manager and checks its validity for
@@ -174,13 +263,22 @@ FMaterial * FMaterial::ValidateTexture(FGameTexture * gtex, int scaleflags, bool
 		FMaterial *hwtex = gtex->Material[scaleflags];
 		if (hwtex == NULL && create)
 		{
-			hwtex = screen->CreateMaterial(gtex, scaleflags);
+			// Only publish the material once it is fully constructed because other threads look it up without the lock.
+			std::lock_guard<std::recursive_mutex> lock(ResourceLock);
+			hwtex = gtex->Material[scaleflags];
+			if (hwtex == NULL)
+			{
+				hwtex = screen->CreateMaterial(gtex, scaleflags);
+				gtex->Material[scaleflags] = hwtex;
+			}
 		}
 		return hwtex;
 	}
 	return NULL;
 }
 
+std::recursive_mutex FMaterial::ResourceLock;
+
 void DeleteMaterial(FMaterial* mat)
 {
 	delete mat;
@@ -2,6 +2,7 @@
 #ifndef __GL_MATERIAL_H
 #define __GL_MATERIAL_H
 
+#include <mutex>
 #include "m_fixed.h"
 #include "textures.h"
 
@@ -23,6 +24,15 @@ struct MaterialLayerInfo
 
 class FMaterial
 {
+public:
+	enum
+	{
+		// Translated paletted textures can be drawn from their indexed version with the translation's palette in this layer.
+		// It must be below SHADER_MIN_REQUIRED_TEXTURE_LAYERS so that every Vulkan pipeline has a binding for it.
+		TRANSLATION_LUT_LAYER = 7,
+		TRANSLATION_INDEXED = -1,		// the hardware texture slot for the indexed version.
+	};
+
 	private:
 	TArray<MaterialLayerInfo> mTextureLayers; // the only layers allowed to scale are the brightmap and the glowmap.
 	int mShaderIndex;
@@ -64,9 +74,16 @@ public:
 	}
 
 	IHardwareTexture *GetLayer(int i, int translation, MaterialLayerInfo **pLayer = nullptr) const;
+	int GetTranslationFlags(int translation, int clampmode) const;
+	static FTexture *GetTranslationLUT();
+	static int NoFilterClampMode(int clampmode);
 
 
 	static FMaterial *ValidateTexture(FGameTexture * tex, int scaleflags, bool create = true);
+
+	// Held while materials or their hardware resources get created, which a backend may do on several threads.
+	static std::recursive_mutex ResourceLock;
+
 	const TArray<MaterialLayerInfo> &GetLayerArray() const
 	{
 		return mTextureLayers;
@@ -34,12 +34,17 @@
 **
 */
 
+#include <zlib.h>
 #include "bitmap.h"
 #include "image.h"
 #include "filesystem.h"
 #include "files.h"
 #include "cmdlib.h"
 #include "palettecontainer.h"
+#include "c_cvars.h"
+#include "printf.h"
+#include "i_specialpaths.h"
+#include "stats.h"
 
 FMemArena ImageArena(32768);
 TArray<FImageSource *>FImageSource::ImageForLump;
@@ -65,6 +70,178 @@ struct PrecacheDataRgba
 TArray<PrecacheDataPaletted> precacheDataPaletted;
 TArray<PrecacheDataRgba> precacheDataRgba;
 
+CVAR(Int, r_imagecache, 64, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in MB
+
+//===========================================================================
+//
+// The image cache keeps decoded images that were not covered by precaching
+// so that building them again, e.g. for another translation or after a
+// hardware texture got deleted, doesn't need to decode them again.
+// Unlike the precache data the entries stay until the cache exceeds its
+// budget, then the least recently used ones get dropped.
+//
+//===========================================================================
+
+struct ImageCacheEntry
+{
+	TArray<uint8_t> Paletted;
+	FBitmap Rgba;
+	int TransInfo;
+	int ImageID;
+	bool TrueColor;
+	uint64_t LastUse;
+
+	size_t Size() const { return TrueColor ? size_t(Rgba.GetPitch()) * Rgba.GetHeight() : Paletted.Size(); }
+};
+
+int FImageSource::Composing;
+static TArray<ImageCacheEntry> imageCache;
+static TArray<unsigned> imageCacheIndex[2];		// by image ID and TrueColor, index + 1 into imageCache or 0.
+static size_t imageCacheSize;
+static uint64_t imageCacheClock;
+static unsigned imageCacheHits, imageCacheMisses;
+
+static size_t ImageCacheBudget()
+{
+	return size_t(std::max<int>(r_imagecache, 0)) << 20;
+}
+
+static ImageCacheEntry *FindImageCache(int imageID, bool truecolor)
+{
+	auto &index = imageCacheIndex[truecolor];
+	if (unsigned(imageID) >= index.Size() || index[imageID] == 0) return nullptr;
+	return &imageCache[index[imageID] - 1];
+}
+
+// Everything that is needed to create the pixels must be done before this because it may move the entries around.
+static ImageCacheEntry &AddImageCache(int imageID, bool truecolor)
+{
+	auto &index = imageCacheIndex[truecolor];
+	if (unsigned(imageID) >= index.Size())
+	{
+		unsigned oldsize = index.Size();
+		index.Resize(imageID + 1);
+		for (unsigned i = oldsize; i < index.Size(); i++) index[i] = 0;
+	}
+	index[imageID] = imageCache.Reserve(1) + 1;
+	auto &entry = imageCache.Last();
+	entry.ImageID = imageID;
+	entry.TrueColor = truecolor;
+	entry.TransInfo = 0;
+	return entry;
+}
+
+//===========================================================================
+//
+// Removes the least recently used entries until the cache fits its budget.
+// The entry that was used last is never removed because its caller still
+// needs it.
+//
+//===========================================================================
+
+static void TrimImageCache()
+{
+	size_t budget = ImageCacheBudget();
+	while (imageCacheSize > budget && imageCache.Size() > 1)
+	{
+		unsigned oldest = 0;
+		for (unsigned i = 1; i < imageCache.Size(); i++)
+		{
+			if (imageCache[i].LastUse < imageCache[oldest].LastUse) oldest = i;
+		}
+		if (imageCache[oldest].LastUse == imageCacheClock) break;
+
+		auto &entry = imageCache[oldest];
+		imageCacheSize -= entry.Size();
+		imageCacheIndex[entry.TrueColor][entry.ImageID] = 0;
+		if (oldest != imageCache.Size() - 1)
+		{
+			entry = std::move(imageCache.Last());
+			imageCacheIndex[entry.TrueColor][entry.ImageID] = oldest + 1;
+		}
+		imageCache.Pop();
+	}
+}
+
+static void ClearImageCache()
+{
+	imageCache.Reset();
+	imageCacheIndex[0].Reset();
+	imageCacheIndex[1].Reset();
+	imageCacheSize = 0;
+}
+
+//===========================================================================
+//
+// The returned pixels are a reference to the cache and only valid until
+// the next call, just like GetCachedPalettedPixels' result.
+//
+//===========================================================================
+
+bool FImageSource::GetImageCachePaletted(PalettedPixels &ret)
+{
+	size_t budget = ImageCacheBudget();
+	if (size_t(Width) * Height > budget / 4) return false;
+
+	auto entry = FindImageCache(ImageID, false);
+	if (entry == nullptr)
+	{
+		imageCacheMisses++;
+		auto pixels = CreatePalettedPixels(normal);
+		entry = &AddImageCache(ImageID, false);
+		entry->Paletted = std::move(pixels);
+		imageCacheSize += entry->Size();
+	}
+	else imageCacheHits++;
+
+	entry->LastUse = ++imageCacheClock;
+	TrimImageCache();
+	entry = FindImageCache(ImageID, false);
+	ret.Pixels.Set(entry->Paletted.Data(), entry->Paletted.Size());
+	return true;
+}
+
+//===========================================================================
+//
+// Multipatch composition gets a reference to the cache because it uses
+// the image right away, everything else gets a copy.
+//
+//===========================================================================
+
+bool FImageSource::GetImageCacheBitmap(FBitmap &ret, int &trans)
+{
+	size_t budget = ImageCacheBudget();
+	if (size_t(Width) * Height * 4 > budget / 4) return false;
+
+	auto entry = FindImageCache(ImageID, true);
+	if (entry == nullptr)
+	{
+		imageCacheMisses++;
+		FBitmap pixels;
+		pixels.Create(Width, Height);
+		int transinfo = CopyPixels(&pixels, normal);
+		entry = &AddImageCache(ImageID, true);
+		entry->Rgba = std::move(pixels);
+		entry->TransInfo = transinfo;
+		imageCacheSize += entry->Size();
+	}
+	else imageCacheHits++;
+
+	entry->LastUse = ++imageCacheClock;
+	TrimImageCache();
+	entry = FindImageCache(ImageID, true);
+	trans = entry->TransInfo;
+	ret.Copy(entry->Rgba, Composing == 0);
+	return true;
+}
+
+ADD_STAT(imagecache)
+{
+	FString out;
+	out.Format("Image cache: %u images, %.1f of %d MB, %u hits, %u misses", imageCache.Size(), imageCacheSize / 1048576., *r_imagecache, imageCacheHits, imageCacheMisses);
+	return out;
+}
+
 //===========================================================================
 // 
 // the default just returns an empty texture.
@@ -116,7 +293,11 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion)
 	{
 		// The image wasn't cached. Now there's two possibilities: 
 		auto info = precacheInfo.CheckKey(ImageID);
-		if (!info || info->second <= 1 || conversion != normal)
+		if ((!info || info->second <= 1) && conversion == normal && GetImageCachePaletted(ret))
+		{
+			// Not precached but small enough to be kept in the image cache.
+		}
+		else if (!info || info->second <= 1 || conversion != normal)
 		{
 			// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
 			//Printf("returning fresh copy of %s\n", name.GetChars());
@@ -182,8 +363,14 @@ int FImageSource::CopyPixels(FBitmap *bmp, int conversion)
 
 int FImageSource::CopyTranslatedPixels(FBitmap *bmp, const PalEntry *remap)
 {
-	auto ppix = CreatePalettedPixels(false);
-	bmp->CopyPixelData(0, 0, ppix.Data(), Width, Height, Height, 1, 0, remap, nullptr);
+	// All translations of an image share the same paletted source.
+	PalettedPixels ppix;
+	if (!GetImageCachePaletted(ppix))
+	{
+		ppix.PixelStore = CreatePalettedPixels(normal);
+		ppix.Pixels.Set(ppix.PixelStore.Data(), ppix.PixelStore.Size());
+	}
+	bmp->CopyPixelData(0, 0, ppix.Pixels.Data(), Width, Height, Height, 1, 0, remap, nullptr);
 	return 0;
 }
 
@@ -246,7 +433,11 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 		{
 			// The image wasn't cached. Now there's two possibilities:
 			auto info = precacheInfo.CheckKey(ImageID);
-			if (!info || info->first <= 1 || conversion != normal)
+			if ((!info || info->first <= 1) && conversion == normal && GetImageCacheBitmap(ret, trans))
+			{
+				// Not precached but small enough to be kept in the image cache.
+			}
+			else if (!info || info->first <= 1 || conversion != normal)
 			{
 				// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
 				//Printf("returning fresh copy of %s\n", name.GetChars());
@@ -338,9 +529,14 @@ FImageSource *EmptyImage_TryCreate(FileReader &, int lumpnum);
 FImageSource *AutomapImage_TryCreate(FileReader &, int lumpnum);
 
 
+//==========================================================================
+//
 // Examines the lump contents to decide what type of texture to create,
 // and creates the texture.
-FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
+//
+//==========================================================================
+
+static FImageSource *ProbeImage(FileReader &data, int lumpnum, bool isflat)
 {
 	static TexCreateInfo CreateInfo[] = {
 		{ IMGZImage_TryCreate,			false },
@@ -357,6 +553,330 @@ FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
 		{ AutomapImage_TryCreate,		false },
 	};
 
+	for (size_t i = 0; i < countof(CreateInfo); i++)
+	{
+		if (!CreateInfo[i].checkflat || isflat)
+		{
+			auto image = CreateInfo[i].TryCreate(data, lumpnum);
+			if (image != nullptr) return image;
+		}
+	}
+	return nullptr;
+}
+
+//==========================================================================
+//
+// Image info cache
+//
+// Probing every image candidate at startup means opening, and for
+// compressed archives decompressing, thousands of lumps of which most
+// will never be shown. So the results get cached on disk per archive.
+// In later runs an image found in the cache is represented by a stand-in
+// that knows the cached size information and only probes the lump once
+// its pixels are needed.
+//
+//==========================================================================
+
+CVAR(Bool, r_cacheimageinfo, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+enum
+{
+	IIF_KNOWN = 1,			// the entry has been filled in.
+	IIF_IMAGE = 2,			// the lump is an image.
+	IIF_FLAT = 4,			// it was probed as a flat.
+	IIF_GAMEPALETTE = 8,
+	IIF_MASKED = 16,
+	IIF_REMAP0 = 32,
+};
+
+struct FImageInfo
+{
+	uint32_t NameHash;
+	uint32_t Size;
+	int32_t Width, Height;
+	int32_t LeftOffset, TopOffset;
+	int8_t Translucent;
+	uint8_t Flags;
+};
+
+struct FImageInfoFile
+{
+	bool Checked = false;		// false until the archive has been looked at.
+	bool Dirty = false;
+	FString CachePath;			// empty if the archive cannot be cached.
+	FString ArchivePath;
+	uint64_t ArchiveSize = 0;
+	int64_t ArchiveTime = 0;
+	TArray<FImageInfo> Entries;	// indexed by the lump's position in the archive.
+};
+
+static TArray<FImageInfoFile> ImageInfoFiles;
+
+static const uint32_t IMAGEINFO_VERSION = 1;
+static const unsigned IMAGEINFO_ENTRYSIZE = 26;
+
+static uint32_t ImageInfoHash(int lumpnum)
+{
+	const char *name = fileSystem.GetFileFullName(lumpnum);
+	return crc32(0, (const Bytef*)name, (uInt)strlen(name));
+}
+
+static void ReadImageInfoFile(FImageInfoFile &file)
+{
+	FileReader fr;
+	if (!fr.OpenFile(file.CachePath)) return;
+
+	auto data = fr.Read();
+	unsigned pos = 0;
+	auto readlong = [&]() -> uint32_t
+	{
+		if (pos + 4 > data.Size()) return 0;
+		uint32_t v = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | (uint32_t(data[pos + 3]) << 24);
+		pos += 4;
+		return v;
+	};
+
+	if (data.Size() < 8 || memcmp(data.Data(), "IMGI", 4)) return;
+	pos = 4;
+	if (readlong() != IMAGEINFO_VERSION) return;
+
+	unsigned pathlen = readlong();
+	if (pos + pathlen > data.Size() || file.ArchivePath.Compare(FString((const char*)&data[pos], pathlen))) return;
+	pos += pathlen;
+
+	uint64_t size = readlong();
+	size |= uint64_t(readlong()) << 32;
+	uint64_t time = readlong();
+	time |= uint64_t(readlong()) << 32;
+	unsigned count = readlong();
+	if (size != file.ArchiveSize || int64_t(time) != file.ArchiveTime || count != file.Entries.Size()) return;
+	if (pos + count * IMAGEINFO_ENTRYSIZE != data.Size()) return;
+
+	for (auto &entry : file.Entries)
+	{
+		entry.NameHash = readlong();
+		entry.Size = readlong();
+		entry.Width = readlong();
+		entry.Height = readlong();
+		entry.LeftOffset = readlong();
+		entry.TopOffset = readlong();
+		entry.Translucent = (int8_t)data[pos++];
+		entry.Flags = data[pos++];
+	}
+}
+
+static void WriteImageInfoFile(FImageInfoFile &file)
+{
+	TArray<uint8_t> data;
+	auto writelong = [&](uint32_t v)
+	{
+		data.Push(uint8_t(v));
+		data.Push(uint8_t(v >> 8));
+		data.Push(uint8_t(v >> 16));
+		data.Push(uint8_t(v >> 24));
+	};
+	auto writebytes = [&](const void *p, unsigned len)
+	{
+		memcpy(&data[data.Reserve(len)], p, len);
+	};
+
+	writebytes("IMGI", 4);
+	writelong(IMAGEINFO_VERSION);
+	writelong((uint32_t)file.ArchivePath.Len());
+	writebytes(file.ArchivePath.GetChars(), (unsigned)file.ArchivePath.Len());
+	writelong(uint32_t(file.ArchiveSize));
+	writelong(uint32_t(file.ArchiveSize >> 32));
+	writelong(uint32_t(file.ArchiveTime));
+	writelong(uint32_t(uint64_t(file.ArchiveTime) >> 32));
+	writelong(file.Entries.Size());
+	for (auto &entry : file.Entries)
+	{
+		writelong(entry.NameHash);
+		writelong(entry.Size);
+		writelong(entry.Width);
+		writelong(entry.Height);
+		writelong(entry.LeftOffset);
+		writelong(entry.TopOffset);
+		data.Push(uint8_t(entry.Translucent));
+		data.Push(entry.Flags);
+	}
+
+	FileWriter *fw = FileWriter::Open(file.CachePath);
+	if (fw != nullptr)
+	{
+		if (fw->Write(data.Data(), data.Size()) != data.Size())
+		{
+			DPrintf(DMSG_WARNING, "Error saving image info to %s\n", file.CachePath.GetChars());
+		}
+		delete fw;
+	}
+}
+
+// Returns the cache slot for the given lump or nullptr if its archive cannot be cached.
+static FImageInfo *FindImageInfo(int lumpnum)
+{
+	if (!r_cacheimageinfo) return nullptr;
+
+	int wadnum = fileSystem.GetFileContainer(lumpnum);
+	if (wadnum < 0) return nullptr;
+	int first = fileSystem.GetFirstEntry(wadnum);
+	int last = fileSystem.GetLastEntry(wadnum);
+	if (lumpnum < first || lumpnum > last) return nullptr;
+
+	if ((unsigned)wadnum >= ImageInfoFiles.Size()) ImageInfoFiles.Resize(wadnum + 1);
+	auto &file = ImageInfoFiles[wadnum];
+	if (!file.Checked)
+	{
+		file.Checked = true;
+		file.ArchivePath = fileSystem.GetResourceFileFullName(wadnum);
+
+		// Only real files can be checked for modification. Directories and nested archives are not cached.
+		size_t size;
+		time_t time;
+		if (!GetFileInfo(file.ArchivePath, &size, &time)) return nullptr;
+		file.ArchiveSize = size;
+		file.ArchiveTime = time;
+
+		FImageInfo blank = {};
+		file.Entries.Resize(last - first + 1);
+		for (auto &entry : file.Entries) entry = blank;
+
+		uint32_t pathhash = crc32(0, (const Bytef*)file.ArchivePath.GetChars(), (uInt)file.ArchivePath.Len());
+		file.CachePath.Format("%s/imageinfo/%08x.dat", M_GetCachePath(false).GetChars(), pathhash);
+		ReadImageInfoFile(file);
+	}
+	if (file.CachePath.IsEmpty()) return nullptr;
+	return &file.Entries[lumpnum - first];
+}
+
+static void StoreImageInfo(int lumpnum, FImageInfo &info, FImageSource *image, bool isflat)
+{
+	info = {};
+	info.NameHash = ImageInfoHash(lumpnum);
+	info.Size = fileSystem.FileLength(lumpnum);
+	info.Flags = IIF_KNOWN | (isflat ? IIF_FLAT : 0);
+	if (image != nullptr)
+	{
+		info.Flags |= IIF_IMAGE;
+		info.Width = image->GetWidth();
+		info.Height = image->GetHeight();
+		std::tie(info.LeftOffset, info.TopOffset) = image->GetOffsets();
+		info.Translucent = image->bTranslucent;
+		if (image->UseGamePalette()) info.Flags |= IIF_GAMEPALETTE;
+		if (image->bMasked) info.Flags |= IIF_MASKED;
+		if (image->SupportRemap0()) info.Flags |= IIF_REMAP0;
+	}
+	ImageInfoFiles[fileSystem.GetFileContainer(lumpnum)].Dirty = true;
+}
+
+void FImageSource::SaveImageInfo()
+{
+	bool created = false;
+	for (auto &file : ImageInfoFiles)
+	{
+		if (file.Dirty && file.CachePath.IsNotEmpty())
+		{
+			if (!created)
+			{
+				CreatePath(M_GetCachePath(true) + "/imageinfo");
+				created = true;
+			}
+			WriteImageInfoFile(file);
+			file.Dirty = false;
+		}
+	}
+}
+
+void FImageSource::ClearImages()
+{
+	ImageArena.FreeAll();
+	ImageForLump.Clear();
+	NextID = 0;
+	ClearImageCache();	// the image IDs get reused.
+	// The lump numbers will be different after a restart.
+	ImageInfoFiles.Clear();
+}
+
+//==========================================================================
+//
+// The stand-in for an image whose properties came from the cache.
+//
+//==========================================================================
+
+class FLazyImageSource : public FImageSource
+{
+	FImageSource *Real = nullptr;
+	bool Probed = false;
+	bool IsFlat;
+	bool Remap0;
+
+	FImageSource *GetReal()
+	{
+		if (!Probed)
+		{
+			Probed = true;
+			auto data = fileSystem.OpenFileReader(SourceLump);
+			if (data.isOpen()) Real = ProbeImage(data, SourceLump, IsFlat);
+			// If the lump does not match what was cached the image's size is already in use and cannot be changed anymore.
+			if (Real != nullptr && (Real->GetWidth() != Width || Real->GetHeight() != Height)) Real = nullptr;
+		}
+		return Real;
+	}
+
+public:
+	FLazyImageSource(int lumpnum, bool isflat, const FImageInfo &info) : FImageSource(lumpnum)
+	{
+		IsFlat = isflat;
+		Width = info.Width;
+		Height = info.Height;
+		LeftOffset = info.LeftOffset;
+		TopOffset = info.TopOffset;
+		bTranslucent = info.Translucent;
+		bUseGamePalette = !!(info.Flags & IIF_GAMEPALETTE);
+		bMasked = !!(info.Flags & IIF_MASKED);
+		Remap0 = !!(info.Flags & IIF_REMAP0);
+	}
+
+	TArray<uint8_t> CreatePalettedPixels(int conversion) override
+	{
+		auto real = GetReal();
+		if (real != nullptr) return real->CreatePalettedPixels(conversion);
+		return FImageSource::CreatePalettedPixels(conversion);
+	}
+
+	int CopyPixels(FBitmap *bmp, int conversion) override
+	{
+		auto real = GetReal();
+		if (real != nullptr) return real->CopyPixels(bmp, conversion);
+		return FImageSource::CopyPixels(bmp, conversion);
+	}
+
+	bool SupportRemap0() override
+	{
+		return Remap0;
+	}
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool IsCached(FImageInfo *info, int lumpnum, bool isflat)
+{
+	return info != nullptr && (info->Flags & IIF_KNOWN) && !!(info->Flags & IIF_FLAT) == isflat &&
+		info->Size == (uint32_t)fileSystem.FileLength(lumpnum) && info->NameHash == ImageInfoHash(lumpnum);
+}
+
+bool FImageSource::NeedsProbing(int lumpnum, bool isflat)
+{
+	if ((unsigned)lumpnum < ImageForLump.Size() && ImageForLump[lumpnum] != nullptr) return false;
+	return !IsCached(FindImageInfo(lumpnum), lumpnum, isflat);
+}
+
+FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
+{
 	if (lumpnum == -1) return nullptr;
 
 	unsigned size = ImageForLump.Size();
@@ -369,21 +889,21 @@ FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
 	// An image for this lump already exists. We do not need another one.
 	if (ImageForLump[lumpnum] != nullptr) return ImageForLump[lumpnum];
 
+	auto info = FindImageInfo(lumpnum);
+	if (IsCached(info, lumpnum, isflat))
+	{
+		if (!(info->Flags & IIF_IMAGE)) return nullptr;
+		auto image = new FLazyImageSource(lumpnum, isflat, *info);
+		ImageForLump[lumpnum] = image;
+		return image;
+	}
+
 	auto data = fileSystem.OpenFileReader(lumpnum);
 	if (!data.isOpen()) 
 		return nullptr;
 
-	for (size_t i = 0; i < countof(CreateInfo); i++)
-	{
-		if (!CreateInfo[i].checkflat || isflat)
-		{
-			auto image = CreateInfo[i].TryCreate(data, lumpnum);
-			if (image != nullptr)
-			{
-				ImageForLump[lumpnum] = image;
-				return image;
-			}
-		}
-	}
-	return nullptr;
+	auto image = ProbeImage(data, lumpnum, isflat);
+	if (info != nullptr) StoreImageInfo(lumpnum, *info, image, isflat);
+	if (image != nullptr) ImageForLump[lumpnum] = image;
+	return image;
 }
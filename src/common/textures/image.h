@@ -37,10 +37,19 @@ private:
 class FImageSource
 {
 	friend class FBrightmapTexture;
+	friend class FLazyImageSource;
 protected:
 
 	static TArray<FImageSource *>ImageForLump;
 	static int NextID;
+	static int Composing;
+
+	// While one of these exists, bitmaps from the image cache are returned as references instead of copies.
+	struct FComposingScope
+	{
+		FComposingScope() { Composing++; }
+		~FComposingScope() { Composing--; }
+	};
 
 	int SourceLump;
 	int Width = 0, Height = 0;
@@ -54,6 +63,8 @@ protected:
 	virtual TArray<uint8_t> CreatePalettedPixels(int conversion);
 	virtual int CopyPixels(FBitmap *bmp, int conversion);			// This will always ignore 'luminance'.
 	int CopyTranslatedPixels(FBitmap *bmp, const PalEntry *remap);
+	bool GetImageCachePaletted(PalettedPixels &ret);
+	bool GetImageCacheBitmap(FBitmap &ret, int &trans);
 
 
 public:
@@ -90,8 +101,10 @@ public:
 	// Unlile for paletted images there is no variant here that returns a persistent bitmap, because all users have to process the returned image into another format.
 	FBitmap GetCachedBitmap(const PalEntry *remap, int conversion, int *trans = nullptr);
 
-	static void ClearImages() { ImageArena.FreeAll(); ImageForLump.Clear(); NextID = 0; }
+	static void ClearImages();
 	static FImageSource * GetImage(int lumpnum, bool checkflat);
+	static void SaveImageInfo();	// writes the probing results that were not cached yet.
+	static bool NeedsProbing(int lumpnum, bool isflat);	// false if GetImage can do without reading the lump.
 
 
 
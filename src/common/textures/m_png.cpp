@@ -488,6 +488,12 @@ bool M_ReadIDAT (FileReader &file, uint8_t *buffer, int width, int height, int p
 	int bytesPerPixel;
 	bool initpass;
 
+	// Non-interlaced images get inflated many rows at a time. Inflating single rows keeps zlib out of its fast path most of the time.
+	TArray<Byte> rowbatch;
+	int batchstride = 0, batchrows = 0, batchdone = 0;
+	// If the file is in memory, inflate straight from there instead of copying everything to the chunk buffer first.
+	const Byte *membuffer = (const Byte *)file.GetBuffer();
+
 	switch (colortype)
 	{
 	case 2:		bytesPerPixel = 3;		break;		// RGB
@@ -560,13 +566,35 @@ bool M_ReadIDAT (FileReader &file, uint8_t *buffer, int width, int height, int p
 			}
 			curr = buffer + rowoffset*pitch + coloffset*bytesPerPixel;
 			passpitch = pitch << passheightshift[pass];
-			stream.next_out = inputLine;
-			stream.avail_out = bytesPerRowIn + 1;
+			if (!interlace)
+			{
+				batchstride = bytesPerRowIn + 1;
+				batchrows = std::max(1, std::min(65536 / batchstride, height));
+				rowbatch.Resize(batchstride * batchrows);
+				batchdone = 0;
+				stream.next_out = rowbatch.Data();
+				stream.avail_out = batchstride * batchrows;
+			}
+			else
+			{
+				stream.next_out = inputLine;
+				stream.avail_out = bytesPerRowIn + 1;
+			}
 		}
 		if (stream.avail_in == 0 && chunklen > 0)
 		{
-			stream.next_in = chunkbuffer;
-			stream.avail_in = (uInt)file.Read (chunkbuffer, std::min<uint32_t>(chunklen,sizeof(chunkbuffer)));
+			if (membuffer != nullptr)
+			{
+				auto pos = file.Tell();
+				stream.next_in = (Bytef *)membuffer + pos;
+				stream.avail_in = (uInt)std::min<FileReader::Size>(chunklen, file.GetLength() - pos);
+				file.Seek(stream.avail_in, FileReader::SeekCur);
+			}
+			else
+			{
+				stream.next_in = chunkbuffer;
+				stream.avail_in = (uInt)file.Read (chunkbuffer, std::min<uint32_t>(chunklen,sizeof(chunkbuffer)));
+			}
 			chunklen -= stream.avail_in;
 		}
 
@@ -577,7 +605,28 @@ bool M_ReadIDAT (FileReader &file, uint8_t *buffer, int width, int height, int p
 			return false;
 		}
 
-		if (stream.avail_out == 0)
+		if (!interlace)
+		{
+			// Unfilter all rows that are complete. They can be stored directly into the output buffer.
+			int rowsready = int(stream.next_out - rowbatch.Data()) / batchstride;
+			for (; batchdone < rowsready; batchdone++)
+			{
+				UnfilterRow (bytesPerRowIn, curr, rowbatch.Data() + batchdone * batchstride, prev, bytesPerPixel);
+				prev = curr;
+				if ((curr += passpitch) >= bufferend)
+				{
+					++pass;
+					break;
+				}
+			}
+			if (stream.avail_out == 0)
+			{
+				batchdone = 0;
+				stream.next_out = rowbatch.Data();
+				stream.avail_out = batchstride * batchrows;
+			}
+		}
+		else if (stream.avail_out == 0)
 		{
 			if (pass >= 6)
 			{
@@ -328,16 +328,30 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 	if (flags & CTF_Indexed)
 	{
 		// Indexed textures will never be translated and never be scaled.
+		int exx = !!(flags & CTF_Expand);
 		int w = GetWidth(), h = GetHeight();
+		int W = w + 2 * exx, H = h + 2 * exx;
 
 		auto store = Get8BitPixels(false);
 		const uint8_t* p = store.Data();
 
-		result.mBuffer = new uint8_t[w * h];
-		result.mWidth = w;
-		result.mHeight = h;
+		result.mBuffer = new uint8_t[W * H];
+		result.mWidth = W;
+		result.mHeight = H;
 		result.mContentId = 0;
-		ImageHelpers::FlipNonSquareBlock(result.mBuffer, p, h, w, h);
+		if (!exx)
+		{
+			ImageHelpers::FlipNonSquareBlock(result.mBuffer, p, h, w, h);
+		}
+		else
+		{
+			// The border is index 0 which is transparent for the shader translations.
+			memset(result.mBuffer, 0, W * H);
+			for (int y = 0; y < h; y++)
+			{
+				ImageHelpers::FlipNonSquareBlock(result.mBuffer + (y + 1) * W + 1, p + y, 1, w, h);
+			}
+		}
 	}
 	else
 	{
@@ -50,6 +50,28 @@
 
 FTextureManager TexMan;
 
+//==========================================================================
+//
+// Probing a lump from a compressed archive means decompressing it first, which
+// is where most of the time goes for large texture packs. The probing itself
+// must stay on this thread because the image sources get registered globally
+// and the archives' readers are shared, but the lumps that come next can already
+// be decompressed in the background while the current one is being looked at.
+//
+//==========================================================================
+
+enum { PREFETCH_AHEAD = 16 };
+
+template<class Filter>
+static void PrefetchAhead(int &nextprefetch, int current, int last, Filter filter)
+{
+	if (nextprefetch <= current) nextprefetch = current + 1;
+	for (; nextprefetch <= last && nextprefetch <= current + PREFETCH_AHEAD; nextprefetch++)
+	{
+		if (filter(nextprefetch)) fileSystem.PrefetchFile(nextprefetch);
+	}
+}
+
 
 //==========================================================================
 //
@@ -170,12 +192,13 @@ FTextureID FTextureManager::CheckForTexture (const char *name, ETextureType uset
 		return FTextureID(0);
 	}
 
-	for(i = HashFirst[MakeKey(name) % HASH_SIZE]; i != HASH_END; i = Textures[i].HashNext)
+	unsigned key = MakeKey(name);
+	for(i = HashFirst[key % HASH_SIZE]; i != HASH_END; i = Textures[i].HashNext)
 	{
 		auto tex = Textures[i].Texture;
 
 
-		if (stricmp (tex->GetName(), name) == 0 )
+		if (Textures[i].NameKey == key && stricmp (tex->GetName(), name) == 0 )
 		{
 			// If we look for short names, we must ignore any long name texture.
 			if ((flags & TEXMAN_ShortNameOnly) && tex->isFullNameTexture())
@@ -290,13 +313,14 @@ int FTextureManager::ListTextures (const char *name, TArray<FTextureID> &list, b
 	{
 		return 0;
 	}
-	i = HashFirst[MakeKey (name) % HASH_SIZE];
+	unsigned key = MakeKey (name);
+	i = HashFirst[key % HASH_SIZE];
 
 	while (i != HASH_END)
 	{
 		auto tex = Textures[i].Texture;
 
-		if (stricmp (tex->GetName(), name) == 0)
+		if (Textures[i].NameKey == key && stricmp (tex->GetName(), name) == 0)
 		{
 			auto texUseType = tex->GetUseType();
 			// NULL textures must be ignored.
@@ -410,9 +434,11 @@ FTextureID FTextureManager::AddGameTexture (FGameTexture *texture, bool addtohas
 	}
 
 	// Textures without name can't be looked for
+	unsigned key = 0;
 	if (addtohash && texture->GetName().IsNotEmpty())
 	{
-		bucket = int(MakeKey (texture->GetName()) % HASH_SIZE);
+		key = MakeKey (texture->GetName().GetChars());
+		bucket = int(key % HASH_SIZE);
 		hash = HashFirst[bucket];
 	}
 	else
@@ -421,7 +447,7 @@ FTextureID FTextureManager::AddGameTexture (FGameTexture *texture, bool addtohas
 		hash = -1;
 	}
 
-	TextureHash hasher = { texture, -1, -1, -1, hash };
+	TextureHash hasher = { texture, -1, -1, -1, hash, false, key };
 	int trans = Textures.Push (hasher);
 	Translation.Push (trans);
 	if (bucket >= 0) HashFirst[bucket] = trans;
@@ -545,6 +571,7 @@ void FTextureManager::AddGroup(int wadnum, int ns, ETextureType usetype)
 {
 	int firsttx = fileSystem.GetFirstEntry(wadnum);
 	int lasttx = fileSystem.GetLastEntry(wadnum);
+	int nextprefetch = firsttx;
 	FString Name;
 
 	// Go from first to last so that ANIMDEFS work as expected. However,
@@ -554,6 +581,11 @@ void FTextureManager::AddGroup(int wadnum, int ns, ETextureType usetype)
 
 	for (; firsttx <= lasttx; ++firsttx)
 	{
+		PrefetchAhead(nextprefetch, firsttx - 1, lasttx, [=](int lump)
+		{
+			return fileSystem.GetFileNamespace(lump) == ns && FImageSource::NeedsProbing(lump, usetype == ETextureType::Flat);
+		});
+
 		if (fileSystem.GetFileNamespace(firsttx) == ns)
 		{
 			fileSystem.GetFileShortName (Name, firsttx);
@@ -913,9 +945,19 @@ void FTextureManager::AddTexturesForWad(int wadnum, FMultipatchTextureBuilder &b
 	// Sixth step: Try to find any lump in the WAD that may be a texture and load as a TEX_MiscPatch
 	int firsttx = fileSystem.GetFirstEntry(wadnum);
 	int lasttx = fileSystem.GetLastEntry(wadnum);
+	int nextprefetch = firsttx;
+
+	auto maybegraphic = [](int lump)
+	{
+		int ns = fileSystem.GetFileNamespace(lump);
+		return (ns == ns_graphics || ns >= ns_firstskin || (ns == ns_global && !(fileSystem.GetFileFlags(lump) & LUMPF_FULLPATH))) &&
+			FImageSource::NeedsProbing(lump, false);
+	};
 
 	for (int i= firsttx; i <= lasttx; i++)
 	{
+		PrefetchAhead(nextprefetch, i - 1, lasttx, maybegraphic);
+
 		bool skin = false;
 		FString Name;
 		fileSystem.GetFileShortName(Name, i);
@@ -989,6 +1031,9 @@ void FTextureManager::AddTexturesForWad(int wadnum, FMultipatchTextureBuilder &b
 		}
 	}
 
+	// Whatever was prefetched but not used up is no longer needed.
+	fileSystem.ClearPrefetches();
+
 	// Check for text based texture definitions
 	LoadTextureDefs(wadnum, "TEXTURES", build);
 	LoadTextureDefs(wadnum, "HIRESTEX", build);
@@ -1203,6 +1248,7 @@ void FTextureManager::Init(void (*progressFunc_)(), void (*checkForHacks)(BuildI
 		Textures[i].Texture->SetID(i);
 	}
 
+	FImageSource::SaveImageInfo();
 }
 
 //==========================================================================
@@ -178,8 +178,9 @@ private:
 		int RawTexture;		
 		int HashNext;
 		bool HasLocalization;
+		unsigned NameKey;	// MakeKey of the name, so the hash chains only need to compare strings that match
 	};
-	enum { HASH_END = -1, HASH_SIZE = 1027 };
+	enum { HASH_END = -1, HASH_SIZE = 8191 };
 	TArray<TextureHash> Textures;
 	TMap<uint64_t, int> LocalizedTextures;
 	int HashFirst[HASH_SIZE];
@@ -92,6 +92,8 @@ enum texflags
 	TEXF_Brightmap = 0x10000,
 	TEXF_Detailmap = 0x20000,
 	TEXF_Glowmap = 0x40000,
+	TEXF_Translated = 0x80000,			// the base layer holds palette indices, the translation is done by the shader.
+	TEXF_TranslatedFilter = 0x100000,	// ...and needs to be filtered by the shader.
 };
 
 
@@ -141,6 +143,7 @@ class ISoftwareTexture
 {
 public:
 	virtual ~ISoftwareTexture() = default;
+	virtual size_t GetMemoryUsage() const { return 0; }
 };
 
 class FGLRenderState;
@@ -352,26 +352,6 @@ int SFMTObj::GetMinArraySize64()
 	return SFMT::N64;
 }
 
-#ifndef ONLY64
-/**
-* This function generates and returns 32-bit pseudorandom number.
-* init_gen_rand or init_by_array must be called before this function.
-* @return 32-bit pseudorandom number
-*/
-unsigned int SFMTObj::GenRand32()
-{
-	uint32_t r;
-
-	assert(initialized);
-	if (idx >= SFMT::N32)
-	{
-		GenRandAll();
-		idx = 0;
-	}
-	r = sfmt.u[idx++];
-	return r;
-}
-#endif
 /**
 * This function generates and returns 64-bit pseudorandom number.
 * init_gen_rand or init_by_array must be called before this function.
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include <assert.h>
 #include "SFMT.h"
 
 struct SFMTObj
@@ -14,7 +15,19 @@ struct SFMTObj
 	void PeriodCertification();
 	int GetMinArraySize32();
 	int GetMinArraySize64();
-	unsigned int GenRand32();
+	unsigned int GenRand32()
+	{
+		// This is called for every random number the game uses, so only the
+		// refill of the state array is out of line. The numbers are generated
+		// in blocks of N32 by GenRandAll and just read from the array here.
+		assert(initialized);
+		if (idx >= SFMT::N32)
+		{
+			GenRandAll();
+			idx = 0;
+		}
+		return sfmt.u[idx++];
+	}
 	uint64_t GenRand64();
 	void FillArray32(uint32_t *array, int size);
 	void FillArray64(uint64_t *array, int size);
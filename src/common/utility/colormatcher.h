@@ -35,12 +35,18 @@
 ** revisiting the problem. I never did, so now it's relegated to the mists
 ** of SVN history, and this is just a thin wrapper around BestColor().
 **
+** It now splits the color cube into cells and for each cell remembers the
+** palette entries that can be the closest color for any point inside it.
+** Picks only search those, which gives the exact same result as searching
+** the whole palette. A cell's list gets built the first time it is needed.
+**
 */
 
 #ifndef __COLORMATCHER_H__
 #define __COLORMATCHER_H__
 
 #include "palutil.h"
+#include "tarray.h"
 
 int BestColor (const uint32_t *pal_in, int r, int g, int b, int first, int num);
 
@@ -48,17 +54,21 @@ class FColorMatcher
 {
 public:
 	FColorMatcher () = default;
-	FColorMatcher (const uint32_t *palette) { Pal = reinterpret_cast<const PalEntry*>(palette); }
+	FColorMatcher (const uint32_t *palette) { SetPalette(palette); }
 	FColorMatcher (const FColorMatcher &other) = default;
 
-	void SetPalette(PalEntry* palette) { Pal = palette; }
-	void SetPalette (const uint32_t *palette) { Pal = reinterpret_cast<const PalEntry*>(palette); }
+	// Must be called again when the palette's contents change.
+	void SetPalette(PalEntry* palette) { Pal = palette; ClearCells(); }
+	void SetPalette (const uint32_t *palette) { Pal = reinterpret_cast<const PalEntry*>(palette); ClearCells(); }
 	uint8_t Pick (int r, int g, int b)
 	{
 		if (Pal == nullptr)
 			return 1;
 
-		return (uint8_t)BestColor ((uint32_t *)Pal, r, g, b, 1, 255);
+		if ((unsigned)(r | g | b) > 255)
+			return (uint8_t)BestColor ((uint32_t *)Pal, r, g, b, 1, 255);
+
+		return PickFromCell(r, g, b);
 	}
 	
 	uint8_t Pick (PalEntry pe)
@@ -69,7 +79,20 @@ public:
 	FColorMatcher &operator= (const FColorMatcher &other) = default;
 
 private:
-	const PalEntry *Pal;
+	enum
+	{
+		CELL_BITS = 4,		// 16 cells per axis
+		CELL_SHIFT = 8 - CELL_BITS,
+		NUM_CELLS = 1 << (3 * CELL_BITS),
+	};
+
+	void ClearCells();
+	void BuildCell(int cell);
+	uint8_t PickFromCell(int r, int g, int b);
+
+	const PalEntry *Pal = nullptr;
+	TArray<uint32_t> CellStart;		// index into Candidates, UINT32_MAX if the cell was not needed yet.
+	TArray<uint8_t> Candidates;		// for each cell the count followed by the palette indices.
 };
 
 extern FColorMatcher ColorMatcher;
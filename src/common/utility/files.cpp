@@ -33,6 +33,17 @@
 **
 */
 
+#include <limits.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "files.h"
 #include "templates.h"	// just for 'clamp'
 #include "zstring.h"
@@ -348,6 +359,71 @@ public:
 };
 
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a memory mapped file. Since this exposes the mapping
+// through GetBuffer, uncompressed lumps can be used in place without
+// ever getting copied to the heap.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+#ifdef _WIN32
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+	HANDLE hMapping = nullptr;
+#endif
+
+public:
+	MappedFileReader() = default;
+
+	~MappedFileReader()
+	{
+#ifdef _WIN32
+		if (bufptr != nullptr) UnmapViewOfFile(bufptr);
+		if (hMapping != nullptr) CloseHandle(hMapping);
+		if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+		if (bufptr != nullptr) munmap((void*)bufptr, Length);
+#endif
+	}
+
+	bool Open(const char *filename)
+	{
+#ifdef _WIN32
+		hFile = CreateFileW(WideString(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(hFile, &size) || size.QuadPart <= 0 || size.QuadPart > LONG_MAX) return false;
+		// Copy-on-write, because some lump users modify the cached data in place.
+		hMapping = CreateFileMappingW(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (hMapping == nullptr) return false;
+		bufptr = (const char*)MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+		if (bufptr == nullptr) return false;
+		Length = (long)size.QuadPart;
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 || info.st_size > LONG_MAX)
+		{
+			close(fd);
+			return false;
+		}
+		// Copy-on-write, because some lump users modify the cached data in place.
+		void *map = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);	// the mapping stays valid without the descriptor.
+		if (map == MAP_FAILED) return false;
+		bufptr = (const char*)map;
+		Length = (long)info.st_size;
+#endif
+		FilePos = 0;
+		return true;
+	}
+};
+
 
 //==========================================================================
 //
@@ -370,6 +446,21 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenMappedFile(const char *filename)
+{
+	// 32 bit builds would be too easily starved of address space by large archives.
+	if (sizeof(void*) < 8) return false;
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return false;
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, (long)start, (long)length);
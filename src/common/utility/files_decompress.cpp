@@ -39,6 +39,7 @@
 #include <zlib.h>
 #include <bzlib.h>
 #include <algorithm>
+#include <limits.h>
 #include <stdexcept>
 
 #include "files.h"
@@ -102,10 +103,11 @@ void DecompressorBase::SetOwnsReader()
 
 class DecompressorZ : public DecompressorBase
 {
-	enum { BUFF_SIZE = 4096 };
+	enum { BUFF_SIZE = 65536 };
 
 	bool SawEOF;
 	z_stream Stream;
+	const uint8_t *MemBuff;		// if the source is in memory, inflate directly from it.
 	uint8_t InBuff[BUFF_SIZE];
 	
 public:
@@ -116,6 +118,7 @@ public:
 
 		File = file;
 		SetErrorCallback(cb);
+		MemBuff = (const uint8_t *)File->GetBuffer();
 		FillBuffer ();
 
 		Stream.zalloc = Z_NULL;
@@ -135,6 +138,15 @@ public:
 		inflateEnd (&Stream);
 	}
 
+	void SyncSource()
+	{
+		// Keep the source's position in line with what inflate actually consumed.
+		if (MemBuff != nullptr)
+		{
+			File->Seek((long)(Stream.next_in - MemBuff), FileReader::SeekSet);
+		}
+	}
+
 	long Read (void *buffer, long len) override
 	{
 		int err;
@@ -150,6 +162,7 @@ public:
 				FillBuffer ();
 			}
 		} while (err == Z_OK && Stream.avail_out != 0);
+		SyncSource();
 
 		if (err != Z_OK && err != Z_STREAM_END)
 		{
@@ -166,6 +179,16 @@ public:
 
 	void FillBuffer ()
 	{
+		if (MemBuff != nullptr)
+		{
+			// Hand inflate everything that's left so that it can stay in its fast path for as long as possible.
+			auto pos = File->Tell();
+			auto remaining = std::min<FileReader::Size>(File->GetLength() - pos, UINT_MAX);
+			SawEOF = true;
+			Stream.next_in = (Bytef *)MemBuff + pos;
+			Stream.avail_in = (uInt)remaining;
+			return;
+		}
 		auto numread = File->Read (InBuff, BUFF_SIZE);
 
 		if (numread < BUFF_SIZE)
@@ -188,7 +211,7 @@ public:
 //==========================================================================
 
 class DecompressorBZ2;
-static DecompressorBZ2 * stupidGlobal;	// Why does that dumb global error callback not pass the decompressor state?
+static thread_local DecompressorBZ2 * stupidGlobal;	// Why does that dumb global error callback not pass the decompressor state?
 										// Thanks to that brain-dead interface we have to use a global variable to get the error to the proper handler.
 
 class DecompressorBZ2 : public DecompressorBase
@@ -45,7 +45,7 @@
 
 #include "cmdlib.h"
 
-static const char *pattern;
+static thread_local const char *pattern;	// thread_local because archives can get opened on worker threads.
 
 static int matchfile(const struct dirent *ent)
 {
@@ -0,0 +1,501 @@
+#pragma once
+
+// Open addressing hash table in the style of Google's Swiss tables.
+//
+// Next to the slots a separate array of control bytes is kept, one per slot, holding either 7 bits of the
+// key's hash or a marker for empty and deleted slots. The slots are split into groups of 16 and a lookup
+// checks the control bytes of an entire group at once, so the keys themselves only need to be compared for
+// the few slots whose hash bits match. All pairs live in one flat allocation, so unlike TMap no chain
+// pointers need to be followed on collisions.
+//
+// The interface mirrors TMap's so that it can be used as a drop-in replacement, including the hash and
+// value traits and the NextPair style iterators. Other than TMap, removing a key never relocates any
+// other pair, so it is safe to remove pairs while iterating over the table.
+
+#include <stdint.h>
+#include "tarray.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLATMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+template<class KT, class VT, class MapType> class TFlatMapIterator;
+template<class KT, class VT, class MapType> class TFlatMapConstIterator;
+
+template<class KT, class VT, class HashTraits=THashTraits<KT>, class ValueTraits=TValueTraits<VT> >
+class TFlatMap
+{
+	template<class KTa, class VTa, class MTa> friend class TFlatMapIterator;
+	template<class KTb, class VTb, class MTb> friend class TFlatMapConstIterator;
+
+public:
+	typedef class TFlatMap<KT, VT, HashTraits, ValueTraits> MyType;
+	typedef class TFlatMapIterator<KT, VT, MyType> Iterator;
+	typedef class TFlatMapConstIterator<KT, VT, MyType> ConstIterator;
+	typedef struct { const KT Key; VT Value; } Pair;
+	typedef const Pair ConstPair;
+
+	TFlatMap() { SetSlotVector(0); }
+	TFlatMap(hash_t size) { SetSlotVector(size); }
+	~TFlatMap() { ClearSlotVector(); }
+
+	TFlatMap(const TFlatMap &o)
+	{
+		SetSlotVector(o.NumUsed);
+		CopySlots(o);
+	}
+
+	TFlatMap &operator= (const TFlatMap &o)
+	{
+		if (&o != this)
+		{
+			ClearSlotVector();
+			SetSlotVector(o.NumUsed);
+			CopySlots(o);
+		}
+		return *this;
+	}
+
+	// Moves the contents from one map to another, leaving the map moved from empty.
+	void TransferFrom(TFlatMap &o)
+	{
+		ClearSlotVector();
+		Control = o.Control;
+		Slots = o.Slots;
+		Size = o.Size;
+		NumUsed = o.NumUsed;
+		GrowthLeft = o.GrowthLeft;
+		o.SetSlotVector(0);
+	}
+
+	// Empties out the table and resizes it with room for count entries.
+	void Clear(hash_t count = 0)
+	{
+		ClearSlotVector();
+		SetSlotVector(count);
+	}
+
+	hash_t CountUsed() const
+	{
+		return NumUsed;
+	}
+
+	// Returns a reference to the value associated with a particular key, creating the pair if the key isn't already in the table.
+	VT &operator[] (const KT key)
+	{
+		hash_t hash = MixHash(key);
+		IPair *p = FindKey(key, hash);
+		if (p == nullptr)
+		{
+			p = NewKey(key, hash);
+			ValueTraits traits;
+			traits.Init(p->Value);
+		}
+		return p->Value;
+	}
+
+	// Returns a pointer to the value associated with a particular key, or nullptr if the key isn't in the table.
+	VT *CheckKey(const KT key)
+	{
+		IPair *p = FindKey(key, MixHash(key));
+		return p != nullptr ? &p->Value : nullptr;
+	}
+
+	const VT *CheckKey(const KT key) const
+	{
+		const IPair *p = const_cast<MyType *>(this)->FindKey(key, MixHash(key));
+		return p != nullptr ? &p->Value : nullptr;
+	}
+
+	// Adds a key/value pair to the table if key isn't in the table, or replaces the value for the existing pair if the key is in the table.
+	VT &Insert(const KT key, const VT &value)
+	{
+		hash_t hash = MixHash(key);
+		IPair *p = FindKey(key, hash);
+		if (p != nullptr)
+		{
+			p->Value = value;
+		}
+		else
+		{
+			p = NewKey(key, hash);
+			::new(&p->Value) VT(value);
+		}
+		return p->Value;
+	}
+
+	VT &Insert(const KT key, VT &&value)
+	{
+		hash_t hash = MixHash(key);
+		IPair *p = FindKey(key, hash);
+		if (p != nullptr)
+		{
+			p->Value = std::move(value);
+		}
+		else
+		{
+			p = NewKey(key, hash);
+			::new(&p->Value) VT(std::move(value));
+		}
+		return p->Value;
+	}
+
+	VT &InsertNew(const KT key)
+	{
+		hash_t hash = MixHash(key);
+		IPair *p = FindKey(key, hash);
+		if (p != nullptr)
+		{
+			p->Value.~VT();
+		}
+		else
+		{
+			p = NewKey(key, hash);
+		}
+		::new(&p->Value) VT;
+		return p->Value;
+	}
+
+	// Removes the key/value pair for a particular key if it is in the table.
+	void Remove(const KT key)
+	{
+		IPair *p = FindKey(key, MixHash(key));
+		if (p == nullptr) return;
+
+		hash_t index = hash_t(p - Slots);
+		p->~IPair();
+		--NumUsed;
+
+		// If the slot's group still has an empty slot, no probe sequence can ever have passed through
+		// this group, so the slot can become empty again instead of leaving a tombstone behind.
+		if (MatchEmpty(&Control[index & ~(GROUP_SIZE - 1)]) != 0)
+		{
+			Control[index] = CTRL_EMPTY;
+			++GrowthLeft;
+		}
+		else
+		{
+			Control[index] = CTRL_DELETED;
+		}
+	}
+
+	void Swap(MyType &other)
+	{
+		std::swap(Control, other.Control);
+		std::swap(Slots, other.Slots);
+		std::swap(Size, other.Size);
+		std::swap(NumUsed, other.NumUsed);
+		std::swap(GrowthLeft, other.GrowthLeft);
+	}
+
+protected:
+	struct IPair	// This must be the same as Pair above, but with a
+	{				// non-const Key.
+		KT Key;
+		VT Value;
+	};
+
+	enum : int8_t
+	{
+		CTRL_EMPTY = -128,
+		CTRL_DELETED = -2,	// full slots have a value in the range 0..127
+	};
+	enum { GROUP_SIZE = 16 };
+
+	int8_t *Control;
+	IPair *Slots;
+	hash_t Size;		// 0 or a power of 2 which is at least GROUP_SIZE
+	hash_t NumUsed;
+	hash_t GrowthLeft;	// how many empty slots can still be filled before the table needs to be rehashed
+
+	static hash_t MixHash(const KT &key)
+	{
+		// Many hash traits just return the key itself, e.g. for pointers and names, so the bits
+		// have to be mixed before they can be split into the group index and the control byte.
+		HashTraits Traits;
+		hash_t h = Traits.Hash(key);
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	static int LowestBit(unsigned mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (int)index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	// Returns a bit mask of all slots in the group whose control byte matches the given hash bits.
+	static unsigned MatchHash(const int8_t *group, int8_t h2)
+	{
+#ifdef FLATMAP_SSE2
+		__m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+		return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+		unsigned mask = 0;
+		for (int i = 0; i < GROUP_SIZE; i++) if (group[i] == h2) mask |= 1u << i;
+		return mask;
+#endif
+	}
+
+	static unsigned MatchEmpty(const int8_t *group)
+	{
+		return MatchHash(group, CTRL_EMPTY);
+	}
+
+	static unsigned MatchEmptyOrDeleted(const int8_t *group)
+	{
+#ifdef FLATMAP_SSE2
+		__m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+		return (unsigned)_mm_movemask_epi8(_mm_cmplt_epi8(ctrl, _mm_set1_epi8(-1)));
+#else
+		unsigned mask = 0;
+		for (int i = 0; i < GROUP_SIZE; i++) if (group[i] < -1) mask |= 1u << i;
+		return mask;
+#endif
+	}
+
+	// Largest number of pairs a table of the given size may hold. Keeping 1/8 of the slots empty
+	// guarantees that every probe sequence terminates and keeps the sequences short.
+	static hash_t MaxLoad(hash_t size)
+	{
+		return size - size / 8;
+	}
+
+	void SetSlotVector(hash_t count)
+	{
+		NumUsed = 0;
+		if (count == 0)
+		{
+			// Empty tables do not allocate anything. All lookups check NumUsed first.
+			Control = nullptr;
+			Slots = nullptr;
+			Size = 0;
+			GrowthLeft = 0;
+			return;
+		}
+		for (Size = GROUP_SIZE; MaxLoad(Size) < count; Size <<= 1)
+		{ }
+		// The control bytes go first, since Size is a multiple of 16 the slots after them are properly aligned.
+		Control = (int8_t *)M_Malloc(Size + Size * sizeof(IPair));
+		Slots = (IPair *)(Control + Size);
+		memset(Control, CTRL_EMPTY, Size);
+		GrowthLeft = MaxLoad(Size);
+	}
+
+	void ClearSlotVector()
+	{
+		for (hash_t i = 0; i < Size; ++i)
+		{
+			if (Control[i] >= 0)
+			{
+				Slots[i].~IPair();
+			}
+		}
+		M_Free(Control);
+		Control = nullptr;
+		Slots = nullptr;
+		Size = 0;
+		NumUsed = 0;
+		GrowthLeft = 0;
+	}
+
+	// Groups are probed quadratically (by triangular numbers), which visits every group exactly once for power of 2 group counts.
+	IPair *FindKey(const KT &key, hash_t hash)
+	{
+		if (NumUsed == 0) return nullptr;
+
+		HashTraits Traits;
+		const int8_t h2 = int8_t(hash & 0x7f);
+		const hash_t groupmask = Size / GROUP_SIZE - 1;
+		hash_t group = (hash >> 7) & groupmask;
+
+		for (hash_t probe = 1; probe <= groupmask + 1; probe++)
+		{
+			const int8_t *ctrl = &Control[group * GROUP_SIZE];
+			for (unsigned mask = MatchHash(ctrl, h2); mask != 0; mask &= mask - 1)
+			{
+				IPair *p = &Slots[group * GROUP_SIZE + LowestBit(mask)];
+				if (!Traits.Compare(p->Key, key))
+				{
+					return p;
+				}
+			}
+			if (MatchEmpty(ctrl) != 0)
+			{
+				break;
+			}
+			group = (group + probe) & groupmask;
+		}
+		return nullptr;
+	}
+
+	// Finds the first free slot for the given hash. This requires at least one free slot in the table.
+	hash_t FindFreeSlot(hash_t hash) const
+	{
+		const hash_t groupmask = Size / GROUP_SIZE - 1;
+		hash_t group = (hash >> 7) & groupmask;
+
+		for (hash_t probe = 1; ; probe++)
+		{
+			unsigned mask = MatchEmptyOrDeleted(&Control[group * GROUP_SIZE]);
+			if (mask != 0)
+			{
+				return group * GROUP_SIZE + LowestBit(mask);
+			}
+			group = (group + probe) & groupmask;
+		}
+	}
+
+	// Inserts a new key which must not be in the table yet. The Value field is left unconstructed.
+	IPair *NewKey(const KT &key, hash_t hash)
+	{
+		hash_t index = Size > 0 ? FindFreeSlot(hash) : 0;
+		if (Size == 0 || (GrowthLeft == 0 && Control[index] == CTRL_EMPTY))
+		{
+			// If the table is mostly filled with tombstones it is enough to rehash it at its current size.
+			Resize(NumUsed + 1 > MaxLoad(Size) / 2 ? Size * 2 : Size);
+			index = FindFreeSlot(hash);
+		}
+		if (Control[index] == CTRL_EMPTY)
+		{
+			--GrowthLeft;
+		}
+		Control[index] = int8_t(hash & 0x7f);
+		++NumUsed;
+		IPair *p = &Slots[index];
+		::new(&p->Key) KT(key);
+		return p;
+	}
+
+	void Resize(hash_t newsize)
+	{
+		int8_t *oldcontrol = Control;
+		IPair *oldslots = Slots;
+		hash_t oldsize = Size;
+		hash_t oldused = NumUsed;
+
+		if (newsize < GROUP_SIZE) newsize = GROUP_SIZE;
+		Size = newsize;
+		Control = (int8_t *)M_Malloc(Size + Size * sizeof(IPair));
+		Slots = (IPair *)(Control + Size);
+		memset(Control, CTRL_EMPTY, Size);
+		GrowthLeft = MaxLoad(Size) - oldused;
+		NumUsed = oldused;
+
+		// Tombstones do not get carried over.
+		for (hash_t i = 0; i < oldsize; ++i)
+		{
+			if (oldcontrol[i] >= 0)
+			{
+				hash_t hash = MixHash(oldslots[i].Key);
+				hash_t index = FindFreeSlot(hash);
+				Control[index] = oldcontrol[i];
+				::new(&Slots[index]) IPair(std::move(oldslots[i]));
+				oldslots[i].~IPair();
+			}
+		}
+		M_Free(oldcontrol);
+	}
+
+	void CopySlots(const TFlatMap &o)
+	{
+		for (hash_t i = 0; i < o.Size; ++i)
+		{
+			if (o.Control[i] >= 0)
+			{
+				hash_t hash = MixHash(o.Slots[i].Key);
+				IPair *p = NewKey(o.Slots[i].Key, hash);
+				::new(&p->Value) VT(o.Slots[i].Value);
+			}
+		}
+	}
+};
+
+// TFlatMapIterator ---------------------------------------------------------
+// A class to iterate over all the pairs in a TFlatMap.
+
+template<class KT, class VT, class MapType=TFlatMap<KT,VT> >
+class TFlatMapIterator
+{
+public:
+	TFlatMapIterator(MapType &map)
+		: Map(map), Position(0)
+	{
+	}
+
+	// Returns false if there are no more entries in the table. Otherwise, it returns true,
+	// and pair is filled with a pointer to the pair in the table.
+	bool NextPair(typename MapType::Pair *&pair)
+	{
+		for (; Position < Map.Size; Position++)
+		{
+			if (Map.Control[Position] >= 0)
+			{
+				pair = reinterpret_cast<typename MapType::Pair *>(&Map.Slots[Position]);
+				Position += 1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Restarts the iteration so you can do it all over again.
+	void Reset()
+	{
+		Position = 0;
+	}
+
+protected:
+	MapType &Map;
+	hash_t Position;
+};
+
+// TFlatMapConstIterator ----------------------------------------------------
+// Exactly the same as TFlatMapIterator, but it works with a const TFlatMap.
+
+template<class KT, class VT, class MapType=TFlatMap<KT,VT> >
+class TFlatMapConstIterator
+{
+public:
+	TFlatMapConstIterator(const MapType &map)
+		: Map(map), Position(0)
+	{
+	}
+
+	bool NextPair(typename MapType::ConstPair *&pair)
+	{
+		for (; Position < Map.Size; Position++)
+		{
+			if (Map.Control[Position] >= 0)
+			{
+				pair = reinterpret_cast<typename MapType::ConstPair *>(&Map.Slots[Position]);
+				Position += 1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Reset()
+	{
+		Position = 0;
+	}
+
+protected:
+	const MapType &Map;
+	hash_t Position;
+};
@@ -36,6 +36,21 @@
 #include <chrono>
 #include <thread>
 #include "i_time.h"
+#include "c_cvars.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+CUSTOM_CVARD(Int, i_spinmargin, 1000, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "microseconds before a frame or tic deadline at which waiting switches from sleeping to spinning")
+{
+	if (self < 0) self = 0;
+	else if (self > 10'000) self = 10'000;
+}
 
 //==========================================================================
 //
@@ -102,6 +117,62 @@ void I_WaitVBL(int count)
 	I_SetFrameTime();
 }
 
+//==========================================================================
+//
+// Hybrid wait: the OS sleep is only trusted up to i_spinmargin before the
+// deadline, the rest gets spun away so that frames and tics start within
+// a few microseconds of when they are due.
+//
+// On Windows a high resolution waitable timer is used where available, which
+// is far more accurate than Sleep, even with timeBeginPeriod(1).
+//
+//==========================================================================
+
+static uint64_t GetRawTimeUS()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void SleepUS(uint64_t us)
+{
+#ifdef _WIN32
+	static thread_local HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (timer != nullptr)
+	{
+		LARGE_INTEGER due;
+		due.QuadPart = -(LONGLONG)(us * 10);	// relative, in 100 ns units
+		if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE))
+		{
+			WaitForSingleObject(timer, INFINITE);
+			return;
+		}
+	}
+#endif
+	std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void I_WaitUntilUS(uint64_t deadline)
+{
+	const uint64_t margin = i_spinmargin;
+	while (true)
+	{
+		const uint64_t now = GetRawTimeUS();
+		if (now >= deadline)
+			break;
+
+		const uint64_t remaining = deadline - now;
+		if (remaining > margin)
+		{
+			SleepUS(remaining - margin);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
 int I_WaitForTic(int prevtic)
 {
 	// Waits until the current tic is greater than prevtic. Time must not be frozen.
@@ -118,12 +189,8 @@ int I_WaitForTic(int prevtic)
 
 		if (next > now)
 		{
-			const uint64_t sleepTime = NSToMS(next - now);
-
-			if (sleepTime > 2)
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(sleepTime - 2));
-			}
+			// The tic clock runs at TimeScale, the wait is in real time.
+			I_WaitUntilUS(GetRawTimeUS() + (uint64_t)((next - now) / (TimeScale * 1000)) + 1);
 		}
 
 		I_SetFrameTime();
@@ -16,6 +16,9 @@ double I_GetTimeFrac();
 // like I_GetTime, except it waits for a new tic before returning
 int I_WaitForTic(int);
 
+// Sleeps, then spins, until the steady clock reaches the given microsecond count
+void I_WaitUntilUS(uint64_t deadline);
+
 // Freezes tic counting temporarily. While frozen, calls to I_GetTime()
 // will always return the same value.
 // You must also not call I_WaitForTic() while freezing time, since the
@@ -0,0 +1,152 @@
+#pragma once
+
+// Work stealing job queue for handing out many small, independent jobs to a fixed set of worker threads.
+//
+// Each worker owns one lane. A single producer (usually the main thread) distributes the jobs over the lanes,
+// each worker drains its own lane first and only steals from the other lanes once its own one runs dry.
+// This keeps the workers mostly off each other's cache lines while still balancing uneven workloads.
+//
+// The queue is meant to be refilled once per batch, i.e. per frame, so the lanes never wrap around
+// and storage is only reclaimed by calling ReleaseAll once all workers have finished.
+
+#include <atomic>
+#include <stdint.h>
+#include "tarray.h"
+
+#ifdef ARCH_IA32
+#include <immintrin.h>
+#endif
+
+template<class T>
+class TJobLane
+{
+	TArray<T> pool;
+
+	// keep the indices on separate cache lines so that the producer and the consumers do not false-share.
+	alignas(64) std::atomic<unsigned> readindex{};
+	alignas(64) std::atomic<unsigned> writeindex{};
+
+public:
+	void Resize(unsigned capacity)
+	{
+		pool.Resize(capacity);
+		ReleaseAll();
+	}
+
+	// May only be called by the producer thread.
+	bool Push(const T &job)
+	{
+		unsigned w = writeindex.load(std::memory_order_relaxed);
+		if (w >= pool.Size()) return false;
+		pool[w] = job;
+		writeindex.store(w + 1, std::memory_order_release);	// publish the index only after the value has been written.
+		return true;
+	}
+
+	// May be called by any consumer, the lane's owner as well as thieves.
+	T *Take()
+	{
+		unsigned r = readindex.load(std::memory_order_relaxed);
+		while (r < writeindex.load(std::memory_order_acquire))
+		{
+			if (readindex.compare_exchange_weak(r, r + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				return &pool[r];
+			}
+		}
+		return nullptr;
+	}
+
+	bool IsEmpty() const
+	{
+		return readindex.load(std::memory_order_acquire) >= writeindex.load(std::memory_order_acquire);
+	}
+
+	void ReleaseAll()
+	{
+		readindex = 0;
+		writeindex = 0;
+	}
+};
+
+template<class T>
+class TWorkStealingQueue
+{
+	TDeletingArray<TJobLane<T> *> lanes;
+	unsigned nextlane = 0;
+	std::atomic<bool> finished{};
+
+public:
+	// Must not be called while any worker is active.
+	void Init(unsigned numlanes, unsigned capacity)
+	{
+		if (numlanes < 1) numlanes = 1;
+		if (lanes.Size() != numlanes)
+		{
+			lanes.DeleteAndClear();
+			for (unsigned i = 0; i < numlanes; i++) lanes.Push(new TJobLane<T>);
+		}
+		for (auto lane : lanes) lane->Resize(capacity);
+		ReleaseAll();
+	}
+
+	unsigned NumLanes() const
+	{
+		return lanes.Size();
+	}
+
+	// Distributes jobs round robin over all lanes. If one lane is full the next one gets used.
+	// Returns false if all lanes are full.
+	bool Push(const T &job)
+	{
+		for (unsigned tries = 0; tries < lanes.Size(); tries++)
+		{
+			auto lane = lanes[nextlane];
+			if (++nextlane == lanes.Size()) nextlane = 0;
+			if (lane->Push(job)) return true;
+		}
+		return false;
+	}
+
+	// Gets a job for the given worker, stealing from the other lanes if its own one is empty.
+	T *GetJob(unsigned worker)
+	{
+		unsigned numlanes = lanes.Size();
+		for (unsigned i = 0; i < numlanes; i++)
+		{
+			auto job = lanes[(worker + i) % numlanes]->Take();
+			if (job != nullptr) return job;
+		}
+		return nullptr;
+	}
+
+	// Tells the workers that no more jobs will be added so that they can return once all lanes are empty.
+	void Finish()
+	{
+		finished.store(true, std::memory_order_release);
+	}
+
+	// Waits for the next job. Returns nullptr once Finish has been called and no work is left.
+	T *WaitForJob(unsigned worker)
+	{
+		while (true)
+		{
+			// The flag must be checked before the lanes. Otherwise a job pushed right before Finish could get lost.
+			bool done = finished.load(std::memory_order_acquire);
+			auto job = GetJob(worker);
+			if (job != nullptr || done) return job;
+#ifdef ARCH_IA32
+			// The queue is empty. But yielding would be too costly here and possibly cause further delays down the line if the thread is halted.
+			// So instead add a few pause instructions and retry immediately.
+			for (int i = 0; i < 10; i++) _mm_pause();
+#endif
+		}
+	}
+
+	void ReleaseAll()
+	{
+		for (auto lane : lanes) lane->ReleaseAll();
+		nextlane = 0;
+		finished = false;
+	}
+};
@@ -33,6 +33,8 @@
 */
 
 #include <string.h>
+#include <mutex>
+#include <new>
 #include "name.h"
 #include "superfasthash.h"
 #include "cmdlib.h"
@@ -45,9 +47,6 @@
 // that is just large enough to hold it.
 #define BLOCK_SIZE			4096
 
-// How many entries to grow the NameArray by when it needs to grow.
-#define NAME_GROW_AMOUNT	256
-
 // TYPES -------------------------------------------------------------------
 
 // Name text is stored in a linked list of NameBlock structures. This
@@ -69,6 +68,9 @@ struct FName::NameManager::NameBlock
 FName::NameManager FName::NameData;
 bool FName::NameManager::Inited;
 
+// Serializes adding new names. Looking up existing ones needs no lock.
+static std::mutex NameLock;
+
 // Define the predefined names.
 static const char *PredefinedNames[] =
 {
@@ -103,27 +105,41 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 
 	unsigned int hash = MakeKey (text);
 	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
 
 	// See if the name already exists.
-	while (scanner >= 0)
+	int index = LookupName (text, hash, bucket);
+	if (index >= 0 || noCreate)
 	{
-		if (NameArray[scanner].Hash == hash && stricmp (NameArray[scanner].Text, text) == 0)
-		{
-			return scanner;
-		}
-		scanner = NameArray[scanner].NextHash;
+		return index >= 0 ? index : 0;
 	}
 
-	// If we get here, then the name does not exist.
-	if (noCreate)
+	// If we get here, then the name does not exist. Another thread may have
+	// added it in the meantime, so check again once nobody else can.
+	std::lock_guard<std::mutex> lock(NameLock);
+	index = LookupName (text, hash, bucket);
+	if (index >= 0)
 	{
-		return 0;
+		return index;
 	}
-
 	return AddName (text, hash, bucket);
 }
 
+int FName::NameManager::LookupName (const char *text, unsigned int hash, unsigned int bucket)
+{
+	int scanner = Buckets[bucket].load(std::memory_order_acquire);
+
+	while (scanner >= 0)
+	{
+		auto &entry = Entry(scanner);
+		if (entry.Hash == hash && stricmp (entry.Text, text) == 0)
+		{
+			return scanner;
+		}
+		scanner = entry.NextHash;
+	}
+	return -1;
+}
+
 //==========================================================================
 //
 // The same as above, but the text length is also passed, for creating
@@ -145,29 +161,41 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 
 	unsigned int hash = MakeKey (text, textLen);
 	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
 
 	// See if the name already exists.
-	while (scanner >= 0)
+	int index = LookupName (text, textLen, hash, bucket);
+	if (index >= 0 || noCreate)
 	{
-		if (NameArray[scanner].Hash == hash &&
-			strnicmp (NameArray[scanner].Text, text, textLen) == 0 &&
-			NameArray[scanner].Text[textLen] == '\0')
-		{
-			return scanner;
-		}
-		scanner = NameArray[scanner].NextHash;
+		return index >= 0 ? index : 0;
 	}
 
-	// If we get here, then the name does not exist.
-	if (noCreate)
+	std::lock_guard<std::mutex> lock(NameLock);
+	index = LookupName (text, textLen, hash, bucket);
+	if (index >= 0)
 	{
-		return 0;
+		return index;
 	}
-
 	return AddName (text, hash, bucket);
 }
 
+int FName::NameManager::LookupName (const char *text, size_t textLen, unsigned int hash, unsigned int bucket)
+{
+	int scanner = Buckets[bucket].load(std::memory_order_acquire);
+
+	while (scanner >= 0)
+	{
+		auto &entry = Entry(scanner);
+		if (entry.Hash == hash &&
+			strnicmp (entry.Text, text, textLen) == 0 &&
+			entry.Text[textLen] == '\0')
+		{
+			return scanner;
+		}
+		scanner = entry.NextHash;
+	}
+	return -1;
+}
+
 //==========================================================================
 //
 // FName :: NameManager :: InitBuckets
@@ -179,7 +207,7 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 void FName::NameManager::InitBuckets ()
 {
 	Inited = true;
-	memset (Buckets, -1, sizeof(Buckets));
+	for (auto &bucket : Buckets) bucket.store(-1, std::memory_order_relaxed);
 
 	// Register built-in names. 'None' must be name 0.
 	for (size_t i = 0; i < countof(PredefinedNames); ++i)
@@ -215,22 +243,27 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 	strcpy (textstore, text);
 	block->NextAlloc += len;
 
-	// Add an entry for the name to the NameArray
-	if (NumNames >= MaxNames)
+	// Add an entry for the name to the chunk it belongs to.
+	int index = NumNames.load(std::memory_order_relaxed);
+	int chunk = index >> CHUNK_SHIFT;
+	if (chunk >= MAX_CHUNKS)
 	{
-		// If no names have been defined yet, make the first allocation
-		// large enough to hold all the predefined names.
-		MaxNames += MaxNames == 0 ? countof(PredefinedNames) + NAME_GROW_AMOUNT : NAME_GROW_AMOUNT;
-
-		NameArray = (NameEntry *)M_Realloc (NameArray, MaxNames * sizeof(NameEntry));
+		throw std::bad_alloc();
+	}
+	if (Chunks[chunk] == NULL)
+	{
+		Chunks[chunk] = (NameEntry *)M_Malloc (CHUNK_SIZE * sizeof(NameEntry));
 	}
 
-	NameArray[NumNames].Text = textstore;
-	NameArray[NumNames].Hash = hash;
-	NameArray[NumNames].NextHash = Buckets[bucket];
-	Buckets[bucket] = NumNames;
+	auto &entry = Entry(index);
+	entry.Text = textstore;
+	entry.Hash = hash;
+	entry.NextHash = Buckets[bucket].load(std::memory_order_relaxed);
 
-	return NumNames++;
+	// Publish the entry only after it has been completely written.
+	NumNames.store(index + 1, std::memory_order_release);
+	Buckets[bucket].store(index, std::memory_order_release);
+	return index;
 }
 
 //==========================================================================
@@ -279,11 +312,14 @@ FName::NameManager::~NameManager()
 	}
 	Blocks = NULL;
 
-	if (NameArray != NULL)
+	for (auto &chunk : Chunks)
 	{
-		M_Free (NameArray);
-		NameArray = NULL;
+		if (chunk != NULL)
+		{
+			M_Free (chunk);
+			chunk = NULL;
+		}
 	}
-	NumNames = MaxNames = 0;
-	memset (Buckets, -1, sizeof(Buckets));
+	NumNames = 0;
+	for (auto &bucket : Buckets) bucket.store(-1, std::memory_order_relaxed);
 }
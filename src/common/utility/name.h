@@ -34,6 +34,7 @@
 #ifndef NAME_H
 #define NAME_H
 
+#include <atomic>
 #include "tarray.h"
 #include "zstring.h"
 
@@ -60,7 +61,7 @@ public:
  //   ~FName () {}	// Names can be added but never removed.
 
 	int GetIndex() const { return Index; }
-	const char *GetChars() const { return NameData.NameArray[Index].Text; }
+	const char *GetChars() const { return NameData.Entry(Index).Text; }
 
 	FName &operator = (const char *text) { Index = NameData.FindName (text, false); return *this; }
 	FName& operator = (const FString& text) { Index = NameData.FindName(text.GetChars(), text.Len(), false); return *this; }
@@ -69,7 +70,7 @@ public:
 
 	int SetName (const char *text, bool noCreate=false) { return Index = NameData.FindName (text, noCreate); }
 
-	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames; }
+	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames.load(std::memory_order_acquire); }
 
 	// Note that the comparison operators compare the names' indices, not
 	// their text, so they cannot be used to do a lexicographical sort.
@@ -107,11 +108,20 @@ protected:
 		enum { HASH_SIZE = 1024 };
 		struct NameBlock;
 
+		// Names can be looked up from any thread without locking, only adding
+		// them is serialized. For that the entries are stored in chunks that
+		// never move once allocated, and a new entry only becomes visible once
+		// it is completely set up.
+		enum { CHUNK_SHIFT = 12, CHUNK_SIZE = 1 << CHUNK_SHIFT, MAX_CHUNKS = 1024 };
+
 		NameBlock *Blocks;
-		NameEntry *NameArray;
-		int NumNames, MaxNames;
-		int Buckets[HASH_SIZE];
+		NameEntry *Chunks[MAX_CHUNKS];
+		std::atomic<int> NumNames;
+		std::atomic<int> Buckets[HASH_SIZE];
 
+		NameEntry &Entry (int index) { return Chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)]; }
+		int LookupName (const char *text, unsigned int hash, unsigned int bucket);
+		int LookupName (const char *text, size_t textlen, unsigned int hash, unsigned int bucket);
 		int FindName (const char *text, bool noCreate);
 		int FindName (const char *text, size_t textlen, bool noCreate);
 		int AddName (const char *text, unsigned int hash, unsigned int bucket);
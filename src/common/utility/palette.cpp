@@ -41,6 +41,7 @@
 #include "printf.h"
 #include "templates.h"
 #include "m_png.h"
+#include "colormatcher.h"
 
 /****************************/
 /* Palette management stuff */
@@ -71,6 +72,93 @@ int BestColor (const uint32_t *pal_in, int r, int g, int b, int first, int num)
 }
 
 
+//==========================================================================
+//
+// FColorMatcher
+//
+// For each palette entry the smallest and largest possible distance to a
+// point inside the cell are computed. An entry can only be the closest
+// color for some point in the cell if its smallest distance is not larger
+// than the largest distance of the entry that is furthest away at most.
+// The candidates stay in palette order so ties resolve like BestColor.
+//
+//==========================================================================
+
+void FColorMatcher::ClearCells()
+{
+	CellStart.Clear();
+	Candidates.Clear();
+}
+
+void FColorMatcher::BuildCell(int cell)
+{
+	const int size = 1 << CELL_SHIFT;
+	int lo[3] = {
+		(cell >> (2 * CELL_BITS)) << CELL_SHIFT,
+		((cell >> CELL_BITS) & ((1 << CELL_BITS) - 1)) << CELL_SHIFT,
+		(cell & ((1 << CELL_BITS) - 1)) << CELL_SHIFT };
+	int mindist[256];
+	int bound = INT_MAX;
+
+	for (int color = 1; color < 255; color++)
+	{
+		int c[3] = { Pal[color].r, Pal[color].g, Pal[color].b };
+		int mind = 0, maxd = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			int hi = lo[i] + size - 1;
+			int d = c[i] < lo[i] ? lo[i] - c[i] : c[i] > hi ? c[i] - hi : 0;
+			int far = std::max(abs(c[i] - lo[i]), abs(c[i] - hi));
+			mind += d * d;
+			maxd += far * far;
+		}
+		mindist[color] = mind;
+		bound = std::min(bound, maxd);
+	}
+
+	unsigned start = Candidates.Reserve(1);
+	for (int color = 1; color < 255; color++)
+	{
+		if (mindist[color] <= bound) Candidates.Push(color);
+	}
+	// a candidate count of 256 cannot happen, the palette searched has 254 entries.
+	Candidates[start] = uint8_t(Candidates.Size() - start - 1);
+	CellStart[cell] = start;
+}
+
+uint8_t FColorMatcher::PickFromCell(int r, int g, int b)
+{
+	if (CellStart.Size() == 0)
+	{
+		CellStart.Resize(NUM_CELLS);
+		for (auto &start : CellStart) start = UINT32_MAX;
+	}
+	int cell = ((r >> CELL_SHIFT) << (2 * CELL_BITS)) | ((g >> CELL_SHIFT) << CELL_BITS) | (b >> CELL_SHIFT);
+	if (CellStart[cell] == UINT32_MAX) BuildCell(cell);
+
+	const uint8_t *list = &Candidates[CellStart[cell]];
+	int count = *list++;
+	int bestcolor = list[0];
+	int bestdist = INT_MAX;
+	for (int i = 0; i < count; i++)
+	{
+		int color = list[i];
+		int x = r - Pal[color].r;
+		int y = g - Pal[color].g;
+		int z = b - Pal[color].b;
+		int dist = x*x + y*y + z*z;
+		if (dist < bestdist)
+		{
+			if (dist == 0)
+				return color;
+
+			bestdist = dist;
+			bestcolor = color;
+		}
+	}
+	return bestcolor;
+}
+
 // [SP] Re-implemented BestColor for more precision rather than speed. This function is only ever called once until the game palette is changed.
 
 int PTM_BestColor (const uint32_t *pal_in, int r, int g, int b, bool reverselookup, float powtable_val, int first, int num)
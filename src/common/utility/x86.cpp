@@ -72,6 +72,32 @@ FString DumpCPUInfo(const CPUInfo *cpu)
 #endif
 #endif
 
+#ifdef _MSC_VER
+#define __cpuidex_sub(output, func, sub) __cpuidex(output, func, sub)
+#elif defined(__i386__) && defined(__PIC__)
+#define __cpuidex_sub(output, func, sub) \
+	__asm__ __volatile__("xchgl\t%%ebx, %1\n\t" \
+						 "cpuid\n\t" \
+						 "xchgl\t%%ebx, %1\n\t" \
+		: "=a" ((output)[0]), "=r" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) \
+		: "a" (func), "c" (sub));
+#else
+#define __cpuidex_sub(output, func, sub) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
+	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func), "c" (sub));
+#endif
+
+// Reads the extended control register which tells which register states the OS saves on context switches.
+static uint64_t ReadXCR0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
 void CheckCPUID(CPUInfo *cpu)
 {
 	int foo[4];
@@ -145,6 +171,12 @@ haveid:
 
 	cpu->HyperThreading = (foo[3] & (1 << 28)) > 0;
 
+	// AVX needs both the CPU flag and the OS having enabled the YMM state through OSXSAVE.
+	if ((foo[2] & (1 << 27)) && (foo[2] & (1 << 28)))
+	{
+		cpu->bAVX = (ReadXCR0() & 6) == 6;
+	}
+
 	// If CLFLUSH instruction is supported, get the real cache line size.
 	if (foo[3] & (1 << 19))
 	{
@@ -165,6 +197,14 @@ haveid:
 		cpu->Model |= (foo[0] >> 12) & 0xF0;
 	}
 
+	// Get structured extended feature flags.
+	__cpuid(foo, 0);
+	if (foo[0] >= 7)
+	{
+		__cpuidex_sub(foo, 7, 0);
+		cpu->bAVX2 = cpu->bAVX && (foo[1] & (1 << 5));
+	}
+
 	// Check for extended functions.
 	__cpuid(foo, 0x80000000);
 	maxext = (unsigned int)foo[0];
@@ -252,6 +292,8 @@ FString DumpCPUInfo(const CPUInfo *cpu)
 		if (cpu->bSSSE3)		out += (" SSSE3");
 		if (cpu->bSSE41)		out += (" SSE4.1");
 		if (cpu->bSSE42)		out += (" SSE4.2");
+		if (cpu->bAVX)			out += (" AVX");
+		if (cpu->bAVX2)			out += (" AVX2");
 		if (cpu->b3DNow)		out += (" 3DNow!");
 		if (cpu->b3DNowPlus)	out += (" 3DNow!+");
 		if (cpu->HyperThreading)	out += (" HyperThreading");
@@ -99,6 +99,9 @@ struct CPUInfo	// 92 bytes
 		};
 		uint32_t AMD_DataL1Info;
 	};
+
+	uint8_t bAVX;		// includes OS support for saving the YMM registers
+	uint8_t bAVX2;
 };
 
 
@@ -1339,11 +1339,8 @@ static HANDLE StringHeap;
 const SIZE_T STRING_HEAP_SIZE = 64*1024;
 #endif
 
-FStringData *FStringData::Alloc (size_t strlen)
+static void *RawStringAlloc(size_t size)
 {
-	strlen += 1 + sizeof(FStringData);	// Add space for header and terminating null
-	strlen = (strlen + 7) & ~7;			// Pad length up
-
 #ifdef _WIN32
 	if (StringHeap == NULL)
 	{
@@ -1353,11 +1350,82 @@ FStringData *FStringData::Alloc (size_t strlen)
 			throw std::bad_alloc();
 		}
 	}
+	return HeapAlloc (StringHeap, 0, size);
+#else
+	return malloc (size);
+#endif
+}
 
-	FStringData *block = (FStringData *)HeapAlloc (StringHeap, 0, strlen);
+static void RawStringFree(void *block)
+{
+#ifdef _WIN32
+	HeapFree (StringHeap, 0, block);
 #else
-	FStringData *block = (FStringData *)malloc (strlen);
+	free (block);
 #endif
+}
+
+//==========================================================================
+//
+// Most strings are short and many of them only live for a moment, like
+// formatted temporaries or string registers in the VM. Instead of going
+// to the heap each time, freed blocks up to a small size are kept for reuse.
+// The blocks stay separate heap allocations, so they can still be resized
+// and freed like any other string. Each thread has its own cache so that no
+// locking is needed. A block freed on a different thread than the one that
+// allocated it simply goes to the freeing thread's cache.
+//
+//==========================================================================
+
+enum
+{
+	STRING_POOL_GRANULARITY = 16,			// block sizes get rounded up to this
+	STRING_POOL_CLASSES = 8,				// so the largest pooled block is 128 bytes
+	STRING_POOL_MAX_BLOCKS = 64,			// per size class and thread
+};
+
+struct FStringPool
+{
+	FStringData *Blocks[STRING_POOL_CLASSES][STRING_POOL_MAX_BLOCKS];
+	int Count[STRING_POOL_CLASSES] = {};
+
+	~FStringPool();
+};
+
+// Strings with static storage can still be freed after the pool of the main thread is gone.
+static thread_local bool StringPoolDestroyed;
+static thread_local FStringPool StringPool;
+
+FStringPool::~FStringPool()
+{
+	StringPoolDestroyed = true;
+	for (int i = 0; i < STRING_POOL_CLASSES; i++)
+	{
+		for (int j = 0; j < Count[i]; j++) RawStringFree(Blocks[i][j]);
+		Count[i] = 0;
+	}
+}
+
+FStringData *FStringData::Alloc (size_t strlen)
+{
+	strlen += 1 + sizeof(FStringData);	// Add space for header and terminating null
+
+	FStringData *block;
+	size_t sizeclass = (strlen - 1) / STRING_POOL_GRANULARITY;
+	if (sizeclass < STRING_POOL_CLASSES)
+	{
+		strlen = (sizeclass + 1) * STRING_POOL_GRANULARITY;
+		if (!StringPoolDestroyed && StringPool.Count[sizeclass] > 0)
+		{
+			block = StringPool.Blocks[sizeclass][--StringPool.Count[sizeclass]];
+		}
+		else block = (FStringData *)RawStringAlloc (strlen);
+	}
+	else
+	{
+		strlen = (strlen + 7) & ~7;			// Pad length up
+		block = (FStringData *)RawStringAlloc (strlen);
+	}
 	if (block == NULL)
 	{
 		throw std::bad_alloc();
@@ -1392,11 +1460,15 @@ void FStringData::Dealloc ()
 {
 	assert (RefCount <= 0);
 
-#ifdef _WIN32
-	HeapFree (StringHeap, 0, this);
-#else
-	free (this);
-#endif
+	// Only blocks whose size matches a size class exactly may go to the pool. Anything else, e.g. most reallocated blocks, is freed.
+	size_t size = AllocLen + 1 + sizeof(FStringData);
+	size_t sizeclass = size / STRING_POOL_GRANULARITY - 1;
+	if (size % STRING_POOL_GRANULARITY == 0 && sizeclass < STRING_POOL_CLASSES && !StringPoolDestroyed && StringPool.Count[sizeclass] < STRING_POOL_MAX_BLOCKS)
+	{
+		StringPool.Blocks[sizeclass][StringPool.Count[sizeclass]++] = this;
+		return;
+	}
+	RawStringFree (this);
 }
 
 FStringData *FStringData::MakeCopy ()
@@ -895,11 +895,19 @@ void WriteLineToLog(FILE *LogFile, const char *outline)
 
 extern bool gameisdead;
 
+thread_local FString *PrintCaptureBuffer;
+
 int PrintString (int iprintlevel, const char *outline)
 {
 	if (gameisdead)
 		return 0;
 
+	if (PrintCaptureBuffer != nullptr)
+	{
+		*PrintCaptureBuffer += outline;
+		return (int)strlen(outline);
+	}
+
 	if (!conbuffer) return 0;	// when called too early
 	int printlevel = iprintlevel & PRINT_TYPES;
 	if (printlevel < msglevel || *outline == '\0')
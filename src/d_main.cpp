@@ -116,6 +116,11 @@
 #include "v_palette.h"
 #include "texturemanager.h"
 #include "hw_clock.h"
+#include "g_benchmark.h"
+#include "zonetrace.h"
+#include "g_hitchdetect.h"
+#include "g_capture.h"
+#include "r_videoscale.h"
 #include "hwrenderer/scene/hw_drawinfo.h"
 
 #ifdef __unix__
@@ -295,6 +300,7 @@ bool wantToRestart;
 bool DrawFSHUD;				// [RH] Draw fullscreen HUD?
 TArray<FString> allwads;
 bool devparm;				// started game with -devparm
+bool headless;				// started game with -headless: no video, no sound
 const char *D_DrawIcon;	// [RH] Patch name of icon to draw on next refresh
 int NoWipe;				// [RH] Allow wipe? (Needs to be set each time)
 bool singletics = false;	// debug flag to cancel adaptiveness
@@ -934,6 +940,7 @@ static void End2DAndUpdate()
 
 void D_Display ()
 {
+	TRACE_ZONE("D_Display");
 	FGameTexture *wipe = nullptr;
 	int wipe_type;
 	sector_t *viewsec;
@@ -1252,6 +1259,34 @@ void D_ErrorCleanup ()
 	ClearGlobalVMStack();
 }
 
+//==========================================================================
+//
+// D_SingleTic
+//
+// Runs exactly one tic, no matter how much time has passed.
+//
+//==========================================================================
+
+static void D_SingleTic ()
+{
+	I_StartTic ();
+	D_ProcessEvents ();
+	G_BuildTiccmd (&netcmds[consoleplayer][maketic%BACKUPTICS]);
+	if (advancedemo)
+		D_DoAdvanceDemo ();
+	C_Ticker ();
+	M_Ticker ();
+	BenchTicCycles.Clock();
+	G_Ticker ();
+	BenchTicCycles.Unclock();
+	// [RH] Use the consoleplayer's camera to update sounds
+	S_UpdateSounds (players[consoleplayer].camera);	// move positional sounds
+	gametic++;
+	maketic++;
+	GC::CheckGC ();
+	Net_NewMakeTic ();
+}
+
 //==========================================================================
 //
 // D_DoomLoop
@@ -1277,31 +1312,35 @@ void D_DoomLoop ()
 	{
 		try
 		{
+			screen->FPSLimit(true);
+			screen->WaitForFrameStart();
+
 			// frame syncronous IO operations
+			// The joysticks get polled after the frame limiter's wait, so that the
+			// ticcmds built from them below do not use a state from before the sleep.
 			if (gametic > lasttic)
 			{
 				lasttic = gametic;
 				I_StartFrame ();
 			}
 			I_SetFrameTime();
+			G_FinishSaveGames(false);
+			M_FinishScreenShots(false);
+			G_FinishSnapshots(false);
 
 			// process one or more tics
-			if (singletics)
+			if (G_DemoSeeking())
+			{
+				// Run the demo as fast as possible but still show a frame every now and then.
+				uint64_t seekstart = I_msTime();
+				do
+				{
+					D_SingleTic ();
+				} while (G_DemoSeeking() && I_msTime() - seekstart < 100);
+			}
+			else if (singletics)
 			{
-				I_StartTic ();
-				D_ProcessEvents ();
-				G_BuildTiccmd (&netcmds[consoleplayer][maketic%BACKUPTICS]);
-				if (advancedemo)
-					D_DoAdvanceDemo ();
-				C_Ticker ();
-				M_Ticker ();
-				G_Ticker ();
-				// [RH] Use the consoleplayer's camera to update sounds
-				S_UpdateSounds (players[consoleplayer].camera);	// move positional sounds
-				gametic++;
-				maketic++;
-				GC::CheckGC ();
-				Net_NewMakeTic ();
+				D_SingleTic ();
 			}
 			else
 			{
@@ -1309,7 +1348,12 @@ void D_DoomLoop ()
 			}
 			// Update display, next frame, with current state.
 			I_StartTic ();
+			BM_FlythroughFrame();
 			D_Display ();
+			R_UpdateDynamicResolution(gamestate == GS_LEVEL ? FrameCycles.TimeMS() : -1);
+			CAP_EndFrame();
+			BM_EndFrame();
+			HD_EndFrame();
 			S_UpdateMusic();
 			if (wantToRestart)
 			{
@@ -1323,12 +1367,14 @@ void D_DoomLoop ()
 			{
 				Printf (PRINT_BOLD, "\n%s\n", error.GetMessage());
 			}
+			BM_ReportError(error.GetMessage());
 			D_ErrorCleanup ();
 		}
 		catch (CVMAbortException &error)
 		{
 			error.MaybePrintMessage();
 			Printf("%s", error.stacktrace.GetChars());
+			BM_ReportError(error.GetMessage());
 			D_ErrorCleanup();
 		}
 	}
@@ -2989,6 +3035,59 @@ static void GC_MarkGameRoots()
 	// NextToThink must not be freed while thinkers are ticking.
 	GC::Mark(NextToThink);
 }
+//==========================================================================
+//
+// Startup phase timing
+//
+// Every call ends the running phase and starts the next one, if a name
+// is given. The phases also show up in a zone trace started with -trace.
+//
+//==========================================================================
+
+struct FStartupPhase
+{
+	const char *name;
+	uint64_t start, end;
+};
+
+static TArray<FStartupPhase> StartupPhases;
+
+static void D_StartupPhase(const char *name)
+{
+	uint64_t now = I_nsTime();
+	if (StartupPhases.Size() > 0 && StartupPhases.Last().end == 0)
+	{
+		auto &phase = StartupPhases.Last();
+		phase.end = now;
+		if (TraceActive) Trace_End(phase.name, phase.start);
+	}
+	if (name != nullptr) StartupPhases.Push({ name, now, 0 });
+}
+
+static void D_PrintStartupTimes()
+{
+	uint64_t total = 0;
+	for (auto &phase : StartupPhases)
+	{
+		if (phase.end != 0) total += phase.end - phase.start;
+	}
+	if (total == 0) return;
+
+	Printf("Startup times:\n");
+	for (auto &phase : StartupPhases)
+	{
+		if (phase.end == 0) continue;
+		uint64_t time = phase.end - phase.start;
+		Printf("  %-24s %8.1f ms %5.1f%%\n", phase.name, time / 1'000'000., time * 100. / total);
+	}
+	Printf("  %-24s %8.1f ms\n", "Total", total / 1'000'000.);
+}
+
+CCMD(startuptimes)
+{
+	D_PrintStartupTimes();
+}
+
 //==========================================================================
 //
 // D_DoomMain
@@ -3064,6 +3163,22 @@ static int D_DoomMain_Internal (void)
 		Printf("\n");
 	}
 
+	// Start tracing as early as possible to also get the startup's file access.
+	const char *tracefile = Args->CheckValue("-trace");
+	if (tracefile != nullptr)
+	{
+		Trace_Start(tracefile);
+	}
+
+	// A headless server never initializes the video and sound hardware.
+	// The dummy frame buffer stays in place and nothing gets drawn.
+	headless = !!Args->CheckParm("-headless");
+	if (headless)
+	{
+		nodrawers = true;
+		Args->AppendArg("-nosound");
+	}
+
 	if (Args->CheckParm("-hashfiles"))
 	{
 		const char *filename = "fileinfo.txt";
@@ -3121,6 +3236,8 @@ static int D_DoomMain_Internal (void)
 
 	do
 	{
+		StartupPhases.Clear();
+		D_StartupPhase("Type system");
 		PClass::StaticInit();
 		PType::StaticInit();
 
@@ -3193,6 +3310,7 @@ static int D_DoomMain_Internal (void)
 			Printf("Notice: File hashing is incredibly verbose. Expect loading files to take much longer than usual.\n");
 		}
 
+		D_StartupPhase("File system");
 		if (!batchrun) Printf ("W_Init: Init WADfiles.\n");
 
 		LumpFilterInfo lfi;
@@ -3243,9 +3361,11 @@ static int D_DoomMain_Internal (void)
 			exec = NULL;
 		}
 
+		D_StartupPhase("String table");
 		// [RH] Initialize localizable strings.
 		GStrings.LoadStrings (language);
 
+		D_StartupPhase("Console and screen");
 		V_InitFontColors ();
 
 		// [RH] Moved these up here so that we can do most of our
@@ -3286,11 +3406,12 @@ static int D_DoomMain_Internal (void)
 		// Base systems have been inited; enable cvar callbacks
 		FBaseCVar::EnableCallbacks ();
 
+		D_StartupPhase("S_Init");
 		if (!batchrun) Printf ("S_Init: Setting up sound.\n");
 		S_Init ();
 
 		if (!batchrun) Printf ("ST_Init: Init startup screen.\n");
-		if (!restart)
+		if (!restart && !headless)
 		{
 			if (GameStartupInfo.Type == FStartupInfo::DefaultStartup)
 			{
@@ -3321,6 +3442,7 @@ static int D_DoomMain_Internal (void)
 
 		CheckCmdLine();
 
+		D_StartupPhase("Sound definitions");
 		// [RH] Load sound environments
 		S_ParseReverbDef ();
 
@@ -3328,6 +3450,7 @@ static int D_DoomMain_Internal (void)
 		if (!batchrun) Printf ("S_InitData: Load sound definitions.\n");
 		S_InitData ();
 
+		D_StartupPhase("MAPINFO");
 		// [RH] Parse through all loaded mapinfo lumps
 		if (!batchrun) Printf ("G_ParseMapInfo: Load map definitions.\n");
 		G_ParseMapInfo (iwad_info->MapInfo);
@@ -3339,6 +3462,7 @@ static int D_DoomMain_Internal (void)
 		// MUSINFO must be parsed after MAPINFO
 		S_ParseMusInfo();
 
+		D_StartupPhase("Textures");
 		if (!batchrun) Printf ("Texman.Init: Init texture manager.\n");
 		UpdateUpscaleMask();
 		SpriteFrames.Clear();
@@ -3348,6 +3472,7 @@ static int D_DoomMain_Internal (void)
 		C_InitConback();
 
 		StartScreen->Progress();
+		D_StartupPhase("Fonts and translations");
 		V_InitFonts();
 		V_LoadTranslations();
 		UpdateGenericUI(false);
@@ -3357,6 +3482,7 @@ static int D_DoomMain_Internal (void)
 		TeamLibrary.ParseTeamInfo ();
 
 		R_ParseTrnslate();
+		D_StartupPhase("Actor definitions");
 		PClassActor::StaticInit ();
 
 		// [GRB] Initialize player class list
@@ -3373,12 +3499,15 @@ static int D_DoomMain_Internal (void)
 
 		StartScreen->Progress ();
 
+		D_StartupPhase("GLDEFS");
 		ParseGLDefs();
 
+		D_StartupPhase("R_Init");
 		if (!batchrun) Printf ("R_Init: Init %s refresh subsystem.\n", gameinfo.ConfigName.GetChars());
 		StartScreen->LoadingStatus ("Loading graphics", 0x3f);
 		R_Init ();
 
+		D_StartupPhase("Decals and Dehacked");
 		if (!batchrun) Printf ("DecalLibrary: Load decals.\n");
 		DecalLibrary.ReadAllDecals ();
 
@@ -3411,6 +3540,7 @@ static int D_DoomMain_Internal (void)
 		// Create replacements for dehacked pickups
 		FinishDehPatch();
 
+		D_StartupPhase("Menus");
 		if (!batchrun) Printf("M_Init: Init menus.\n");
 		M_Init();
 		M_CreateGameMenus();
@@ -3433,6 +3563,7 @@ static int D_DoomMain_Internal (void)
 		primaryLevel->BotInfo.spawn_tries = 0;
 		primaryLevel->BotInfo.wanted_botnum = primaryLevel->BotInfo.getspawned.Size();
 
+		D_StartupPhase("Game engine");
 		if (!batchrun) Printf ("P_Init: Init Playloop state.\n");
 		StartScreen->LoadingStatus ("Init game engine", 0x3f);
 		AM_StaticInit();
@@ -3460,6 +3591,8 @@ static int D_DoomMain_Internal (void)
 			}
 		}
 
+		D_StartupPhase(nullptr);
+
 		if (!restart)
 		{
 			if (!batchrun) Printf ("D_CheckNetGame: Checking network game status.\n");
@@ -3510,7 +3643,10 @@ static int D_DoomMain_Internal (void)
 				return 1337; // special exit
 			}
 
-			V_Init2();
+			D_StartupPhase("V_Init2");
+			if (!headless) V_Init2();
+			D_StartupPhase(nullptr);
+			if (Args->CheckParm("-startuptimes")) D_PrintStartupTimes();
 			twod->fullscreenautoaspect = gameinfo.fullscreenautoaspect;
 			// Initialize the size of the 2D drawer so that an attempt to access it outside the draw code won't crash.
 			twod->Begin(screen->GetWidth(), screen->GetHeight());
@@ -3539,6 +3675,7 @@ static int D_DoomMain_Internal (void)
 				v = Args->CheckValue("-timedemo");
 				if (v)
 				{
+					BM_Init(v);
 					G_TimeDemo(v);
 					D_DoomLoop();	// never returns
 				}
@@ -3618,6 +3755,7 @@ int GameMain()
 	}
 	// Unless something really bad happened, the game should only exit through this single point in the code.
 	// No more 'exit', please.
+	Trace_Stop();
 	D_Cleanup();
 	CloseNetwork();
 	GC::FinalGC = true;
@@ -3643,6 +3781,11 @@ int GameMain()
 
 void D_Cleanup()
 {
+	G_FinishSaveGames(true);
+	CAP_Stop();
+	M_FinishScreenShots(true);
+	G_FinishSnapshots(true);
+
 	if (demorecording)
 	{
 		G_CheckDemoStatus();
@@ -3764,6 +3907,8 @@ CUSTOM_CVAR(Int, I_FriendlyWindowTitle, 1, CVAR_GLOBALCONFIG|CVAR_ARCHIVE|CVAR_N
 
 void I_UpdateWindowTitle()
 {
+	if (headless) return;	// there is no window.
+
 	FString titlestr;
 	switch (I_FriendlyWindowTitle)
 	{
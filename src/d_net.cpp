@@ -68,6 +68,7 @@
 #include "vm.h"
 #include "gstrings.h"
 #include "s_music.h"
+#include "zonetrace.h"
 
 EXTERN_CVAR (Int, disableautosave)
 EXTERN_CVAR (Int, autosavecount)
@@ -154,12 +155,23 @@ CUSTOM_CVAR(Int, net_extratic, 0, CVAR_SERVERINFO | CVAR_NOSAVE)
 	{
 		self = 0;
 	}
-	else if (self > 2)
+	else if (self > 3)
 	{
-		self = 2;
+		self = 3;
 	}
 }
 
+// [net_extratic 3] Estimated share of packets from each node that ask for a
+// retransmission, as a moving average scaled to NETLOSS_SCALE. This decides on a
+// per node basis how many old tics get sent again with every packet.
+enum
+{
+	NETLOSS_SCALE = 1024,
+	NETLOSS_LOW = NETLOSS_SCALE / 50,	// 2% of the packets asked for a resend
+	NETLOSS_HIGH = NETLOSS_SCALE / 10,	// 10% of the packets asked for a resend
+};
+static int netloss[MAXNETNODES];
+
 #ifdef _DEBUG
 CVAR(Int, net_fakelatency, 0, 0);
 
@@ -321,6 +333,7 @@ void Net_ClearBuffers ()
 	memset (remoteresend, 0, sizeof(remoteresend));
 	memset (resendto, 0, sizeof(resendto));
 	memset (resendcount, 0, sizeof(resendcount));
+	memset (netloss, 0, sizeof(netloss));
 	memset (lastrecvtime, 0, sizeof(lastrecvtime));
 	memset (currrecvtime, 0, sizeof(currrecvtime));
 	memset (consistancy, 0, sizeof(consistancy));
@@ -861,6 +874,8 @@ void GetPackets (void)
 		
 		nodeforplayer[netconsole] = netnode;
 		
+		netloss[netnode] += ((netbuffer[0] & NCMD_RETRANSMIT) ? NETLOSS_SCALE - netloss[netnode] : -netloss[netnode]) / 16;
+
 		// check for retransmit request
 		if (resendcount[netnode] <= 0 && (netbuffer[0] & NCMD_RETRANSMIT))
 		{
@@ -1156,7 +1171,13 @@ void NetUpdate (void)
 		if (numtics > BACKUPTICS)
 			I_Error ("NetUpdate: Node %d missed too many tics", i);
 
-		switch (net_extratic)
+		int extratic = net_extratic;
+		if (extratic == 3)
+		{
+			// Pick the redundancy based on how lossy the connection to this node has been.
+			extratic = netloss[i] >= NETLOSS_HIGH ? 2 : netloss[i] >= NETLOSS_LOW ? 1 : 0;
+		}
+		switch (extratic)
 		{
 		case 0:
 		default: 
@@ -1664,6 +1685,7 @@ bool D_CheckNetGame (void)
 		nettics[i] = 0;
 		remoteresend[i] = false;		// set when local needs tics
 		resendto[i] = 0;				// which tic to start sending
+		netloss[i] = 0;
 	}
 
 	// Packet server has proven to be rather slow over the internet. Print a warning about it.
@@ -1813,18 +1835,12 @@ static uint64_t stabilitystarttime = 0;
 static void TicStabilityWait()
 {
 	using namespace std::chrono;
-	using namespace std::this_thread;
 
 	if (!r_ticstability)
 		return;
 
 	uint64_t start = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
-	while (true)
-	{
-		uint64_t cur = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
-		if (cur - start > stabilityticduration)
-			break;
-	}
+	I_WaitUntilUS(start + stabilityticduration + 1);
 }
 
 static void TicStabilityBegin()
@@ -1845,6 +1861,7 @@ static void TicStabilityEnd()
 //
 void TryRunTics (void)
 {
+	TRACE_ZONE("TryRunTics");
 	int 		i;
 	int 		lowtic;
 	int 		realtics;
@@ -116,6 +116,7 @@ extern	bool			viewactive;
 
 extern	bool	 		nodrawers;
 extern	bool	 		noblit;
+extern	bool			headless;
 
 extern	int 			viewwindowx;
 extern	int 			viewwindowy;
@@ -47,6 +47,7 @@ EventManager staticEventManager;
 
 void EventManager::CallOnRegister()
 {
+	WorldEventsValid = false;
 	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
 	{
 		handler->OnRegister();
@@ -62,6 +63,9 @@ bool EventManager::RegisterHandler(DStaticEventHandler* handler)
 
 	handler->OnRegister();
 	handler->owner = this;
+	// Set this up right away in case the handler is registered while an event is being sent.
+	handler->WorldEvents = handler->GetWorldEventMask();
+	WorldEvents |= handler->WorldEvents;
 	
 	// link into normal list
 	// update: link at specific position based on order.
@@ -130,6 +134,7 @@ bool EventManager::UnregisterHandler(DStaticEventHandler* handler)
 		return false;
 
 	handler->OnUnregister();
+	WorldEventsValid = false;
 
 	// link out of normal list
 	if (handler->prev)
@@ -271,6 +276,18 @@ void EventManager::Shutdown()
 		handler->Destroy();
 	}
 	FirstEventHandler = LastEventHandler = nullptr;
+	WorldEventsValid = false;
+}
+
+void EventManager::UpdateWorldEvents()
+{
+	WorldEvents = 0;
+	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+	{
+		handler->WorldEvents = handler->GetWorldEventMask();
+		WorldEvents |= handler->WorldEvents;
+	}
+	WorldEventsValid = true;
 }
 
 #define DEFINE_EVENT_LOOPER(name, play) void EventManager::name() \
@@ -315,8 +332,11 @@ void EventManager::WorldThingSpawned(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingSpawned(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingSpawned(actor);
+	if (HasWorldEvent(WEM_ThingSpawned))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_ThingSpawned) handler->WorldThingSpawned(actor);
+	}
 }
 
 void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
@@ -327,8 +347,11 @@ void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDied(actor, inflictor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDied(actor, inflictor);
+	if (HasWorldEvent(WEM_ThingDied))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_ThingDied) handler->WorldThingDied(actor, inflictor);
+	}
 }
 
 void EventManager::WorldThingRevived(AActor* actor)
@@ -339,8 +362,11 @@ void EventManager::WorldThingRevived(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingRevived(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingRevived(actor);
+	if (HasWorldEvent(WEM_ThingRevived))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_ThingRevived) handler->WorldThingRevived(actor);
+	}
 }
 
 void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* source, int damage, FName mod, int flags, DAngle angle)
@@ -351,8 +377,11 @@ void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* s
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
+	if (HasWorldEvent(WEM_ThingDamaged))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_ThingDamaged) handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
+	}
 }
 
 void EventManager::WorldThingDestroyed(AActor* actor)
@@ -365,8 +394,11 @@ void EventManager::WorldThingDestroyed(AActor* actor)
 	if (!(actor->ObjectFlags & OF_Spawned))
 		return;
 
-	for (DStaticEventHandler* handler = LastEventHandler; handler; handler = handler->prev)
-		handler->WorldThingDestroyed(actor);
+	if (HasWorldEvent(WEM_ThingDestroyed))
+	{
+		for (DStaticEventHandler* handler = LastEventHandler; handler; handler = handler->prev)
+			if (handler->WorldEvents & WEM_ThingDestroyed) handler->WorldThingDestroyed(actor);
+	}
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDestroyed(actor);
 }
@@ -375,24 +407,33 @@ void EventManager::WorldLinePreActivated(line_t* line, AActor* actor, int activa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLinePreActivated(line, actor, activationType, shouldactivate);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
+	if (HasWorldEvent(WEM_LinePreActivated))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_LinePreActivated) handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
+	}
 }
 
 void EventManager::WorldLineActivated(line_t* line, AActor* actor, int activationType)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineActivated(line, actor, activationType);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLineActivated(line, actor, activationType);
+	if (HasWorldEvent(WEM_LineActivated))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_LineActivated) handler->WorldLineActivated(line, actor, activationType);
+	}
 }
 
 int EventManager::WorldSectorDamaged(sector_t* sector, AActor* source, int damage, FName damagetype, int part, DVector3 position, bool isradius)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
+	if (HasWorldEvent(WEM_SectorDamaged))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_SectorDamaged) damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
+	}
 	return damage;
 }
 
@@ -400,8 +441,11 @@ int EventManager::WorldLineDamaged(line_t* line, AActor* source, int damage, FNa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
+	if (HasWorldEvent(WEM_LineDamaged))
+	{
+		for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			if (handler->WorldEvents & WEM_LineDamaged) damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
+	}
 	return damage;
 }
 
@@ -699,6 +743,34 @@ static bool isEmptyInt(VMFunction *func)
 	return (code == nullptr || code->word == (0x00048000|OP_RET));
 }
 
+// Collects the world events this handler's class implements, in EWorldEventMask order.
+uint32_t DStaticEventHandler::GetWorldEventMask()
+{
+	static const char *const names[] = { "WorldThingSpawned", "WorldThingDied", "WorldThingRevived", "WorldThingDamaged", "WorldThingDestroyed",
+		"WorldLinePreActivated", "WorldLineActivated", "WorldSectorDamaged", "WorldLineDamaged" };
+	static unsigned VIndex[countof(names)];
+	static bool indexed = false;
+
+	if (!indexed)
+	{
+		for (unsigned i = 0; i < countof(names); i++)
+		{
+			VIndex[i] = GetVirtualIndex(RUNTIME_CLASS(DStaticEventHandler), names[i]);
+			assert(VIndex[i] != ~0u);
+		}
+		indexed = true;
+	}
+
+	auto clss = GetClass();
+	uint32_t mask = 0;
+	for (unsigned i = 0; i < countof(names); i++)
+	{
+		VMFunction *func = clss->Virtuals.Size() > VIndex[i] ? clss->Virtuals[VIndex[i]] : nullptr;
+		if (func != nullptr && !isEmpty(func)) mask |= 1u << i;
+	}
+	return mask;
+}
+
 // ===========================================
 //
 //  Event handlers
@@ -17,6 +17,22 @@ enum class EventHandlerType
 	PerMap
 };
 
+// The world events the handler lists keep track of. A handler only gets called
+// for these if its class actually implements them, and if no handler does, the
+// event is skipped entirely.
+enum EWorldEventMask : uint32_t
+{
+	WEM_ThingSpawned = 1 << 0,
+	WEM_ThingDied = 1 << 1,
+	WEM_ThingRevived = 1 << 2,
+	WEM_ThingDamaged = 1 << 3,
+	WEM_ThingDestroyed = 1 << 4,
+	WEM_LinePreActivated = 1 << 5,
+	WEM_LineActivated = 1 << 6,
+	WEM_SectorDamaged = 1 << 7,
+	WEM_LineDamaged = 1 << 8,
+};
+
 // ==============================================
 //
 //  EventHandler - base class
@@ -45,6 +61,9 @@ public:
 	int Order;
 	bool IsUiProcessor;
 	bool RequireMouse;
+	uint32_t WorldEvents = 0;	// EWorldEventMask of this handler, set up by the owner. Not serialized.
+
+	uint32_t GetWorldEventMask();
 
 	// serialization handler. let's keep it here so that I don't get lost in serialized/not serialized fields
 	void Serialize(FSerializer& arc) override
@@ -204,6 +223,8 @@ struct EventManager
 	FLevelLocals *Level = nullptr;
 	DStaticEventHandler* FirstEventHandler = nullptr;
 	DStaticEventHandler* LastEventHandler = nullptr;
+	uint32_t WorldEvents = 0;	// combined EWorldEventMask of all handlers
+	bool WorldEventsValid = false;
 
 	EventManager() = default;
 	EventManager(FLevelLocals *l) { Level = l; }
@@ -300,6 +321,14 @@ struct EventManager
 		{
 			existinghandler->owner = this;
 		}
+		WorldEventsValid = false;
+	}
+
+	void UpdateWorldEvents();
+	bool HasWorldEvent(uint32_t event)
+	{
+		if (!WorldEventsValid) UpdateWorldEvents();
+		return !!(WorldEvents & event);
 	}
 
 };
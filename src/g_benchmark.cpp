@@ -0,0 +1,571 @@
+/*
+** g_benchmark.cpp
+** Unattended benchmark runs with machine readable output
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** When started with -timedemo <demo> [<demo>...] -benchout <file> all the
+** given demos get timed in sequence. For every displayed frame the
+** playsim time and the renderer's phase timings are recorded. When the
+** last demo ends, the results are written to the given file, as CSV
+** summary if the file name ends with .csv, otherwise as JSON including
+** all frames, and the engine exits with status 0 on success or 1 if any
+** demo failed to play.
+**
+*/
+
+#include <algorithm>
+#include "g_benchmark.h"
+#include "g_game.h"
+#include "d_event.h"
+#include "doomstat.h"
+#include "m_argv.h"
+#include "i_time.h"
+#include "printf.h"
+#include "engineerrors.h"
+#include "hw_clock.h"
+#include "templates.h"
+#include "c_dispatch.h"
+#include "sc_man.h"
+#include "filesystem.h"
+#include "g_levellocals.h"
+#include "actorinlines.h"
+
+extern cycle_t FrameCycles;
+
+cycle_t BenchTicCycles;
+
+enum
+{
+	BF_TIC, BF_FRAME, BF_BSP, BF_DRAW, BF_SWAP, NUM_BF
+};
+
+static const char *columnnames[] = { "playsim", "frame", "bsp", "draw", "swap" };
+
+struct FBenchFrame
+{
+	int demo;
+	int gametic;
+	double times[NUM_BF];
+};
+
+struct FBenchDemo
+{
+	FString name;
+	int tics = 0;
+	uint64_t mstime = 0;
+	int frames = 0;
+	FString error;
+};
+
+static bool benchactive;
+static FString benchfile;
+static TArray<FString> benchdemos;
+static TArray<FBenchDemo> benchresults;
+static TArray<FBenchFrame> benchframes;
+static unsigned nextdemo;
+static int demostarttic;
+static uint64_t demostarttime;
+
+EXTERN_CVAR(Int, vid_rendermode)
+EXTERN_CVAR(Int, vid_preferbackend)
+
+enum
+{
+	FLY_OFF,
+	FLY_PENDING,
+	FLY_RUNNING
+};
+
+struct FFlyKey
+{
+	DVector3 pos;
+	DAngle angle, pitch;
+	int frames;
+};
+
+static int flystate = FLY_OFF;
+static FString flylump;
+static bool flyexit;
+static TArray<FFlyKey> flykeys;
+static unsigned flykey;
+static int flyframe;
+static TObjPtr<AActor*> flycam;
+static TObjPtr<AActor*> flyoldcamera;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool BM_Active()
+{
+	return benchactive;
+}
+
+static void BM_StartDemo(const char *name)
+{
+	auto &res = benchresults[benchresults.Reserve(1)];
+	res.name = name;
+	demostarttic = gametic;
+	demostarttime = I_msTime();
+	BenchTicCycles.Reset();
+}
+
+void BM_Init(const char *firstdemo)
+{
+	const char *out = Args->CheckValue("-benchout");
+	if (out == nullptr) return;
+
+	benchactive = true;
+	benchfile = out;
+	bench_forceclocks = true;
+
+	FString *list;
+	int count = Args->CheckParmList("-timedemo", &list);
+	benchdemos.Clear();
+	benchdemos.Push(firstdemo);
+	for (int i = 1; i < count; i++) benchdemos.Push(list[i]);
+	nextdemo = 1;
+
+	Printf("Benchmarking %u demo%s, results go to %s\n", benchdemos.Size(), benchdemos.Size() == 1 ? "" : "s", benchfile.GetChars());
+	BM_StartDemo(firstdemo);
+}
+
+//==========================================================================
+//
+// Called once per displayed frame.
+//
+//==========================================================================
+
+void BM_EndFrame()
+{
+	if (!benchactive || !(demoplayback || flystate == FLY_RUNNING) || benchresults.Size() == 0) return;
+
+	FBenchFrame frame;
+	frame.demo = benchresults.Size() - 1;
+	frame.gametic = gametic - demostarttic;
+	frame.times[BF_TIC] = BenchTicCycles.TimeMS();
+	frame.times[BF_FRAME] = nodrawers ? 0. : FrameCycles.TimeMS();
+	frame.times[BF_BSP] = Bsp.TimeMS();
+	frame.times[BF_DRAW] = RenderAll.TimeMS();
+	frame.times[BF_SWAP] = Finish.TimeMS();
+	benchframes.Push(frame);
+	benchresults.Last().frames++;
+	BenchTicCycles.Reset();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void BM_ReportError(const char *message)
+{
+	if (benchactive && benchresults.Size() > 0 && benchresults.Last().error.IsEmpty())
+	{
+		benchresults.Last().error = (message && *message) ? message : "unknown error";
+	}
+}
+
+//==========================================================================
+//
+// Percentiles are taken with the nearest rank method.
+//
+//==========================================================================
+
+struct FBenchSummary
+{
+	double mean, p50, p90, p99, max;
+};
+
+static FBenchSummary Summarize(int demo, int column)
+{
+	TArray<double> values;
+	for (auto &frame : benchframes)
+	{
+		if (demo >= 0 && frame.demo != demo) continue;
+		values.Push(frame.times[column]);
+	}
+
+	FBenchSummary sum = {};
+	if (values.Size() == 0) return sum;
+
+	std::sort(values.begin(), values.end());
+	double total = 0;
+	for (auto v : values) total += v;
+
+	auto rank = [&](double pct)
+	{
+		unsigned index = unsigned(pct * values.Size() + 0.999999);
+		return values[clamp<unsigned>(index, 1, values.Size()) - 1];
+	};
+	sum.mean = total / values.Size();
+	sum.p50 = rank(0.5);
+	sum.p90 = rank(0.9);
+	sum.p99 = rank(0.99);
+	sum.max = values.Last();
+	return sum;
+}
+
+static FString JsonString(const char *str)
+{
+	FString out = "\"";
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\') out << '\\' << *str;
+		else if ((unsigned char)*str < 32) out.AppendFormat("\\u%04x", (unsigned char)*str);
+		else out << *str;
+	}
+	out << '"';
+	return out;
+}
+
+static void AppendJsonSummary(FString &out, int demo, const char *indent)
+{
+	out.AppendFormat("%s\"summary\": {\n", indent);
+	for (int c = 0; c < NUM_BF; c++)
+	{
+		auto sum = Summarize(demo, c);
+		out.AppendFormat("%s\t\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+			indent, columnnames[c], sum.mean, sum.p50, sum.p90, sum.p99, sum.max, c < NUM_BF - 1 ? "," : "");
+	}
+	out.AppendFormat("%s}", indent);
+}
+
+static FString WriteJson(bool success)
+{
+	FString out;
+	out.AppendFormat("{\n\t\"success\": %s,\n\t\"rendermode\": %d,\n\t\"backend\": %d,\n\t\"demos\": [\n", success ? "true" : "false", *vid_rendermode, *vid_preferbackend);
+	for (unsigned d = 0; d < benchresults.Size(); d++)
+	{
+		auto &res = benchresults[d];
+		out.AppendFormat("\t\t{\n\t\t\t\"name\": %s,\n\t\t\t\"tics\": %d,\n\t\t\t\"ms\": %llu,\n\t\t\t\"frames\": %d,\n\t\t\t\"error\": %s,\n",
+			JsonString(res.name.GetChars()).GetChars(), res.tics, (unsigned long long)res.mstime, res.frames,
+			res.error.IsEmpty() ? "null" : JsonString(res.error.GetChars()).GetChars());
+		AppendJsonSummary(out, d, "\t\t\t");
+		out << ",\n\t\t\t\"frametimes\": [\n";
+		bool first = true;
+		for (auto &frame : benchframes)
+		{
+			if (frame.demo != (int)d) continue;
+			out.AppendFormat("%s\t\t\t\t[%d", first ? "" : ",\n", frame.gametic);
+			for (auto t : frame.times) out.AppendFormat(", %.4f", t);
+			out << "]";
+			first = false;
+		}
+		out.AppendFormat("\n\t\t\t]\n\t\t}%s\n", d < benchresults.Size() - 1 ? "," : "");
+	}
+	out << "\t],\n\t\"frametimecolumns\": [\"gametic\"";
+	for (auto name : columnnames) out.AppendFormat(", \"%s\"", name);
+	out << "],\n";
+	AppendJsonSummary(out, -1, "\t");
+	out << "\n}\n";
+	return out;
+}
+
+static FString WriteCsv()
+{
+	FString out = "demo,tics,ms,frames,error,metric,mean,p50,p90,p99,max\n";
+	for (int d = -1; d < (int)benchresults.Size(); d++)
+	{
+		FString prefix;
+		if (d < 0)
+		{
+			int tics = 0, frames = 0;
+			uint64_t ms = 0;
+			bool failed = false;
+			for (auto &res : benchresults)
+			{
+				tics += res.tics;
+				ms += res.mstime;
+				frames += res.frames;
+				failed |= res.error.IsNotEmpty();
+			}
+			prefix.Format("*,%d,%llu,%d,%d", tics, (unsigned long long)ms, frames, int(failed));
+		}
+		else
+		{
+			auto &res = benchresults[d];
+			FString name = res.name;
+			name.Substitute(",", "_");
+			prefix.Format("%s,%d,%llu,%d,%d", name.GetChars(), res.tics, (unsigned long long)res.mstime, res.frames, int(res.error.IsNotEmpty()));
+		}
+		for (int c = 0; c < NUM_BF; c++)
+		{
+			auto sum = Summarize(d, c);
+			out.AppendFormat("%s,%s,%.4f,%.4f,%.4f,%.4f,%.4f\n", prefix.GetChars(), columnnames[c], sum.mean, sum.p50, sum.p90, sum.p99, sum.max);
+		}
+	}
+	return out;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool WriteResults()
+{
+	bool success = true;
+	for (auto &res : benchresults)
+	{
+		if (res.error.IsNotEmpty()) success = false;
+	}
+
+	FString text = benchfile.Right(4).MakeLower().Compare(".csv") == 0 ? WriteCsv() : WriteJson(success);
+	FILE *f = fopen(benchfile.GetChars(), "wt");
+	if (f == nullptr)
+	{
+		Printf("Unable to write benchmark results to %s\n", benchfile.GetChars());
+		success = false;
+	}
+	else
+	{
+		fputs(text.GetChars(), f);
+		fclose(f);
+		Printf("Benchmark results saved to %s\n", benchfile.GetChars());
+	}
+	return success;
+}
+
+//==========================================================================
+//
+// Called when a timed demo ends. Either starts the next one and returns
+// true or writes the results and exits.
+//
+//==========================================================================
+
+bool BM_EndDemo()
+{
+	if (benchresults.Size() > 0)
+	{
+		auto &res = benchresults.Last();
+		res.tics = gametic - demostarttic;
+		res.mstime = I_msTime() - demostarttime;
+		Printf("%s: %d gametics in %llu ms, %d frames\n", res.name.GetChars(), res.tics, (unsigned long long)res.mstime, res.frames);
+	}
+
+	if (nextdemo < benchdemos.Size())
+	{
+		auto &demo = benchdemos[nextdemo++];
+		BM_StartDemo(demo.GetChars());
+		G_TimeDemo(demo.GetChars());
+		return true;
+	}
+
+	bool success = WriteResults();
+	benchactive = false;
+	throw CExitEvent(success ? 0 : 1);
+}
+
+//==========================================================================
+//
+// Renderer benchmark: moves the view along a spline through the keyframes
+// of a text lump while the playsim is frozen. Every keyframe is given as
+//
+//   x y z angle pitch frames
+//
+// where 'frames' is the number of frames to get to the next keyframe.
+// The path always takes the same number of frames, so the numbers are
+// comparable between the different renderers and backends.
+//
+//==========================================================================
+
+bool BM_FlythroughActive()
+{
+	return flystate == FLY_RUNNING;
+}
+
+static bool BM_ParseFlythrough(const char *name)
+{
+	int lump = fileSystem.CheckNumForFullName(name, true);
+	if (lump < 0)
+	{
+		Printf("Flythrough path '%s' not found\n", name);
+		return false;
+	}
+
+	FScanner sc;
+	sc.OpenLumpNum(lump);
+	flykeys.Clear();
+	while (sc.GetFloat())
+	{
+		FFlyKey key;
+		key.pos.X = sc.Float;
+		sc.MustGetFloat();
+		key.pos.Y = sc.Float;
+		sc.MustGetFloat();
+		key.pos.Z = sc.Float;
+		sc.MustGetFloat();
+		key.angle = DAngle(sc.Float);
+		sc.MustGetFloat();
+		key.pitch = DAngle(sc.Float);
+		sc.MustGetNumber();
+		key.frames = MAX(sc.Number, 1);
+		flykeys.Push(key);
+	}
+	if (flykeys.Size() < 2)
+	{
+		Printf("Flythrough path '%s' needs at least 2 keyframes\n", name);
+		return false;
+	}
+	return true;
+}
+
+static void BM_StopFlythrough(const char *error)
+{
+	auto player = &players[consoleplayer];
+	if (flycam != nullptr)
+	{
+		if (player->camera == flycam) player->camera = flyoldcamera != nullptr ? flyoldcamera.Get() : player->mo;
+		flycam->Destroy();
+	}
+	flycam = nullptr;
+	flyoldcamera = nullptr;
+	flystate = FLY_OFF;
+	if (error != nullptr) BM_ReportError(error);
+
+	bool success = WriteResults();
+	benchactive = false;
+	bench_forceclocks = false;
+	if (flyexit) throw CExitEvent(success ? 0 : 1);
+}
+
+static bool BM_StartFlythrough()
+{
+	if (!BM_ParseFlythrough(flylump.GetChars())) return false;
+
+	flycam = Spawn(primaryLevel, NAME_MapSpot, flykeys[0].pos, NO_REPLACE);
+	if (flycam == nullptr) return false;
+	flycam->CameraHeight = 0;
+	flyoldcamera = players[consoleplayer].camera;
+	players[consoleplayer].camera = flycam;
+
+	benchresults.Clear();
+	benchframes.Clear();
+	BM_StartDemo(flylump.GetChars());
+	benchactive = true;
+	bench_forceclocks = true;
+	flykey = 0;
+	flyframe = 0;
+	flystate = FLY_RUNNING;
+	return true;
+}
+
+//==========================================================================
+//
+// Called before every frame gets rendered.
+//
+//==========================================================================
+
+void BM_FlythroughFrame()
+{
+	if (flystate == FLY_OFF) return;
+	if (flystate == FLY_PENDING)
+	{
+		// wait for the level to be fully set up if it was started from the command line.
+		if (gamestate != GS_LEVEL || gameaction != ga_nothing) return;
+		if (!BM_StartFlythrough())
+		{
+			flystate = FLY_OFF;
+			if (flyexit) throw CExitEvent(1);
+			return;
+		}
+	}
+	if (flycam == nullptr || gamestate != GS_LEVEL)
+	{
+		BM_StopFlythrough("level was exited");
+		return;
+	}
+	if (flykey >= flykeys.Size() - 1)
+	{
+		auto &res = benchresults.Last();
+		res.tics = 0;
+		res.mstime = I_msTime() - demostarttime;
+		Printf("%s: %d frames in %llu ms\n", res.name.GetChars(), res.frames, (unsigned long long)res.mstime);
+		BM_StopFlythrough(nullptr);
+		return;
+	}
+
+	// Catmull-Rom spline through the key positions, the angles are interpolated linearly.
+	auto &k1 = flykeys[flykey];
+	auto &k2 = flykeys[flykey + 1];
+	auto &p0 = flykeys[flykey > 0 ? flykey - 1 : 0].pos;
+	auto &p3 = flykeys[MIN<unsigned>(flykey + 2, flykeys.Size() - 1)].pos;
+	double t = double(flyframe) / k1.frames;
+	double t2 = t * t, t3 = t2 * t;
+	DVector3 pos = ((k1.pos * 2) + (k2.pos - p0) * t + (p0 * 2 - k1.pos * 5 + k2.pos * 4 - p3) * t2 + (k1.pos * 3 - p0 - k2.pos * 3 + p3) * t3) * 0.5;
+
+	flycam->SetOrigin(pos, false);
+	flycam->Angles.Yaw = k1.angle + deltaangle(k1.angle, k2.angle) * t;
+	flycam->Angles.Pitch = k1.pitch + deltaangle(k1.pitch, k2.pitch) * t;
+	flycam->ClearInterpolation();
+
+	if (++flyframe >= k1.frames)
+	{
+		flyframe = 0;
+		flykey++;
+	}
+}
+
+CCMD(benchflythrough)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: benchflythrough <path lump> [<output file>] [exit]\n");
+		return;
+	}
+	if (netgame || demoplayback || demorecording)
+	{
+		Printf("Flythroughs are only available in single player games\n");
+		return;
+	}
+	if (flystate != FLY_OFF || benchactive)
+	{
+		Printf("A benchmark is already running\n");
+		return;
+	}
+
+	static bool registered;
+	if (!registered)
+	{
+		GC::AddMarkerFunc([]() { GC::Mark(flycam); GC::Mark(flyoldcamera); });
+		registered = true;
+	}
+
+	flylump = argv[1];
+	benchfile = argv.argc() > 2 ? argv[2] : "flythrough.json";
+	flyexit = argv.argc() > 3 && !stricmp(argv[3], "exit");
+	flystate = FLY_PENDING;
+	C_HideConsole();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "stats.h"
+
+// Unattended benchmark runs for timed demos (-timedemo <demos...> -benchout <file>)
+// and renderer flythroughs (benchflythrough <path lump> [<file>] [exit])
+
+extern cycle_t BenchTicCycles;
+
+bool BM_Active();
+void BM_Init(const char *firstdemo);
+void BM_EndFrame();
+void BM_ReportError(const char *message);
+bool BM_EndDemo();
+
+bool BM_FlythroughActive();
+void BM_FlythroughFrame();
@@ -0,0 +1,381 @@
+/*
+** g_capture.cpp
+** Continuous capture of the presented frames
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Each captured frame is read back on the main thread right after it has
+** been presented and then handed to a single worker thread that runs the
+** encoder. At most MAX_PENDING frames can wait for the encoder. If it
+** falls further behind, frames get dropped instead of stalling the game,
+** so the frame pacing stays close to what it is without capturing.
+**
+** Next to the frames, every capture writes frames.txt, which lists each
+** frame's number, the game tic it was taken in and its time in ms since
+** the capture started, so that the video can be matched against tics.
+**
+*/
+
+#include <future>
+#include "g_capture.h"
+#include "doomdef.h"
+#include "doomstat.h"
+#include "v_video.h"
+#include "c_dispatch.h"
+#include "cmdlib.h"
+#include "i_time.h"
+#include "i_specialpaths.h"
+#include "palettecontainer.h"
+#include "printf.h"
+#include "ctpl.h"
+
+EXTERN_CVAR(String, screenshot_dir)
+
+enum
+{
+	MAX_PENDING = 8,
+};
+
+struct FCaptureFrame
+{
+	TArray<uint8_t> pixels;
+	ESSType color_type;
+	int width, height, pitch;
+	int frame, tic;
+	double time;
+	std::future<bool> result;
+};
+
+struct FCaptureEncoderType
+{
+	const char *name;
+	FFrameEncoder *(*create)(const char *path);
+};
+
+static TArray<FCaptureEncoderType> EncoderTypes;
+static ctpl::thread_pool CapturePool;
+static TArray<FCaptureFrame *> CaptureFrames;
+static FFrameEncoder *Encoder;
+static FileWriter *FrameLog;
+static FString CapturePath;
+static uint64_t CaptureStart, NextCapture, CaptureInterval;
+static int NumFrames, NumDropped, NumFailed;
+
+//==========================================================================
+//
+// Writes every frame as a separate PNG.
+//
+//==========================================================================
+
+class FPNGFrameEncoder : public FFrameEncoder
+{
+	FString Path;
+
+public:
+	FPNGFrameEncoder(const char *path) : Path(path) {}
+
+	bool WriteFrame(int frame, const uint8_t *pixels, const PalEntry *palette, ESSType color_type, int width, int height, int pitch) override
+	{
+		FStringf filename("%sframe_%06d.png", Path.GetChars(), frame);
+		auto file = FileWriter::Open(filename);
+		if (file == nullptr) return false;
+		bool res = M_CreatePNG(file, pixels, palette, color_type, width, height, pitch, 1.f) && M_FinishPNG(file);
+		delete file;
+		return res;
+	}
+};
+
+//==========================================================================
+//
+// Appends all frames as uncompressed 24 bit RGB to a single file. This is
+// the cheapest format to write and any video encoder can read it, e.g.
+// ffmpeg -f rawvideo -pix_fmt rgb24 -s <width>x<height> -r <fps> -i frames.rgb
+// Since the format has no header, frames whose size does not match the
+// first one are rejected.
+//
+//==========================================================================
+
+class FRawFrameEncoder : public FFrameEncoder
+{
+	FileWriter *File = nullptr;
+	TArray<uint8_t> Row;
+	int Width = 0, Height = 0;
+
+public:
+	FRawFrameEncoder(const char *path)
+	{
+		File = FileWriter::Open(FStringf("%sframes.rgb", path));
+	}
+
+	~FRawFrameEncoder()
+	{
+		if (File != nullptr) delete File;
+	}
+
+	bool WriteFrame(int frame, const uint8_t *pixels, const PalEntry *palette, ESSType color_type, int width, int height, int pitch) override
+	{
+		if (File == nullptr) return false;
+		if (Width == 0)
+		{
+			Width = width;
+			Height = height;
+			Row.Resize(width * 3);
+		}
+		if (width != Width || height != Height) return false;
+
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t *src = pixels + y * pitch;
+			uint8_t *dst = Row.Data();
+			for (int x = 0; x < width; x++, dst += 3)
+			{
+				switch (color_type)
+				{
+				case SS_PAL:
+				{
+					PalEntry color = palette[src[x]];
+					dst[0] = color.r;
+					dst[1] = color.g;
+					dst[2] = color.b;
+					break;
+				}
+				case SS_RGB:
+					dst[0] = src[x * 3];
+					dst[1] = src[x * 3 + 1];
+					dst[2] = src[x * 3 + 2];
+					break;
+				case SS_BGRA:
+					dst[0] = src[x * 4 + 2];
+					dst[1] = src[x * 4 + 1];
+					dst[2] = src[x * 4];
+					break;
+				}
+			}
+			if (File->Write(Row.Data(), Row.Size()) != Row.Size()) return false;
+		}
+		return true;
+	}
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void CAP_AddEncoder(const char *name, FFrameEncoder *(*create)(const char *path))
+{
+	EncoderTypes.Push({ name, create });
+}
+
+static void AddDefaultEncoders()
+{
+	if (EncoderTypes.Size() > 0) return;
+	CAP_AddEncoder("png", [](const char *path) -> FFrameEncoder * { return new FPNGFrameEncoder(path); });
+	CAP_AddEncoder("raw", [](const char *path) -> FFrameEncoder * { return new FRawFrameEncoder(path); });
+}
+
+bool CAP_Active()
+{
+	return Encoder != nullptr;
+}
+
+//==========================================================================
+//
+// Collects the frames the worker is done with. With 'wait' set this
+// blocks until all pending frames are written.
+//
+//==========================================================================
+
+static void FinishFrames(bool wait)
+{
+	while (CaptureFrames.Size() > 0)
+	{
+		auto frame = CaptureFrames[0];
+		if (!wait && frame->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) break;
+		CaptureFrames.Delete(0);
+		if (!frame->result.get()) NumFailed++;
+		delete frame;
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void CAP_Start(const char *encodername, double fps)
+{
+	if (Encoder != nullptr)
+	{
+		Printf("Already capturing to %s\n", CapturePath.GetChars());
+		return;
+	}
+	AddDefaultEncoders();
+	unsigned type = EncoderTypes.FindEx([=](const auto &entry) { return !stricmp(entry.name, encodername); });
+	if (type == EncoderTypes.Size())
+	{
+		Printf("Unknown capture encoder '%s'\n", encodername);
+		return;
+	}
+
+	FString path = *screenshot_dir;
+	if (path.IsEmpty()) path = M_GetScreenshotsPath();
+	if (path.IsNotEmpty() && path.Back() != '/' && path.Back() != '\\') path += '/';
+	path = NicePath(path);
+
+	for (int i = 0; i < 10000; i++)
+	{
+		CapturePath.Format("%scapture_%04d/", path.GetChars(), i);
+		if (!DirEntryExists(CapturePath)) break;
+	}
+	CreatePath(CapturePath);
+
+	FrameLog = FileWriter::Open(CapturePath + "frames.txt");
+	if (FrameLog == nullptr)
+	{
+		Printf("Could not create %s\n", CapturePath.GetChars());
+		return;
+	}
+	FrameLog->Printf("# frame tic ms\n");
+
+	Encoder = EncoderTypes[type].create(CapturePath);
+	if (CapturePool.size() == 0) CapturePool.resize(1);
+
+	CaptureInterval = fps > 0 ? uint64_t(1'000'000'000. / fps) : 0;
+	CaptureStart = NextCapture = I_nsTime();
+	NumFrames = NumDropped = NumFailed = 0;
+	Printf("Capturing to %s\n", CapturePath.GetChars());
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void CAP_Stop()
+{
+	if (Encoder == nullptr) return;
+
+	FinishFrames(true);
+	delete Encoder;
+	Encoder = nullptr;
+	delete FrameLog;
+	FrameLog = nullptr;
+
+	Printf("Captured %d frames to %s", NumFrames, CapturePath.GetChars());
+	if (NumDropped > 0) Printf(", %d dropped", NumDropped);
+	if (NumFailed > 0) Printf(", %d could not be written", NumFailed);
+	Printf("\n");
+}
+
+//==========================================================================
+//
+// Called after each presented frame.
+//
+//==========================================================================
+
+void CAP_EndFrame()
+{
+	if (Encoder == nullptr) return;
+
+	FinishFrames(false);
+
+	uint64_t now = I_nsTime();
+	if (now < NextCapture) return;
+	if (CaptureInterval > 0)
+	{
+		// Skip the slots a slow frame missed instead of catching up.
+		NextCapture += CaptureInterval;
+		if (NextCapture <= now) NextCapture = now + CaptureInterval - (now - NextCapture) % CaptureInterval;
+	}
+
+	if (CaptureFrames.Size() >= MAX_PENDING)
+	{
+		NumDropped++;
+		return;
+	}
+
+	int pitch;
+	ESSType color_type;
+	float gamma;
+	auto pixels = screen->GetScreenshotBuffer(pitch, color_type, gamma);
+	if (pixels.Size() == 0)
+	{
+		NumDropped++;
+		return;
+	}
+
+	auto frame = new FCaptureFrame;
+	frame->pixels = std::move(pixels);
+	frame->color_type = color_type;
+	frame->width = screen->GetWidth();
+	frame->height = screen->GetHeight();
+	frame->pitch = pitch;
+	frame->frame = NumFrames++;
+	frame->tic = gametic;
+	frame->time = (now - CaptureStart) / 1'000'000.;
+
+	auto encoder = Encoder;
+	auto log = FrameLog;
+	auto palette = GPalette.BaseColors;
+	frame->result = CapturePool.push([=](int)
+	{
+		bool res = encoder->WriteFrame(frame->frame, frame->pixels.Data(), palette, frame->color_type, frame->width, frame->height, frame->pitch);
+		log->Printf("%d %d %.3f\n", frame->frame, frame->tic, frame->time);
+		frame->pixels.Reset();
+		return res;
+	});
+	CaptureFrames.Push(frame);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(capture)
+{
+	if (argv.argc() < 2 || (stricmp(argv[1], "start") && stricmp(argv[1], "stop")))
+	{
+		Printf("Usage: capture start [png|raw] [<fps>] | capture stop\n");
+		return;
+	}
+	if (!stricmp(argv[1], "start"))
+	{
+		CAP_Start(argv.argc() > 2 ? argv[2] : "png", argv.argc() > 3 ? atof(argv[3]) : TICRATE);
+	}
+	else
+	{
+		CAP_Stop();
+	}
+}
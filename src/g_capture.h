@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+#include "m_png.h"
+
+// Continuous capture of the presented frames for recording gameplay
+// (capture start [<encoder>] [<fps>] | capture stop)
+
+// Encoders only get called from the capture thread, one frame at a time.
+class FFrameEncoder
+{
+public:
+	virtual ~FFrameEncoder() = default;
+	virtual bool WriteFrame(int frame, const uint8_t *pixels, const PalEntry *palette, ESSType color_type, int width, int height, int pitch) = 0;
+};
+
+// 'path' is the capture's directory, including the trailing slash.
+void CAP_AddEncoder(const char *name, FFrameEncoder *(*create)(const char *path));
+
+bool CAP_Active();
+void CAP_Start(const char *encoder, double fps);
+void CAP_Stop();
+void CAP_EndFrame();
@@ -48,6 +48,7 @@ CVAR (Bool, cl_spreaddecals, true, CVAR_ARCHIVE)
 CVAR(Bool, var_pushers, true, CVAR_SERVERINFO);
 CVAR(Bool, gl_cachenodes, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR(Float, gl_cachetime, 0.6f, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR(String, gl_sharednodecache, "", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// read-only directory with prebuilt node caches named by map checksum
 CVAR(Bool, alwaysapplydmflags, false, CVAR_SERVERINFO);
 
 // Show developer messages if true.
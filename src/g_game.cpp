@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <memory>
+#include <future>
 
 #include "i_time.h"
 #include "templates.h"
@@ -84,6 +85,9 @@
 #include "d_buttons.h"
 #include "hwrenderer/scene/hw_drawinfo.h"
 #include "doommenu.h"
+#include "ctpl.h"
+#include "g_benchmark.h"
+#include "g_hitchdetect.h"
 
 
 static FRandom pr_dmspawn ("DMSpawn");
@@ -113,6 +117,7 @@ CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR (Bool, chasedemo, false, 0);
 CVAR (Bool, storesavepic, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, longsavemessages, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR (Bool, save_async, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// compress and write savegames on a worker thread.
 CVAR (String, save_dir, "", CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
 CVAR (Bool, cl_waitforsave, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 CVAR (Bool, enablescriptscreenshot, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
@@ -180,6 +185,9 @@ size_t			maxdemosize;
 uint8_t*			zdemformend;			// end of FORM ZDEM chunk
 uint8_t*			zdembodyend;			// end of ZDEM BODY chunk
 bool 			singledemo; 			// quit after playing a demo from cmdline 
+static int		demostarttic;			// gametic at which the current demo started
+static int		demoseektic = -1;		// demo_seek's target, relative to demostarttic
+static bool		demofromsave;			// the demo continues a savegame and cannot be restarted
  
 bool 			precache = true;		// if true, load all graphics at start 
   
@@ -1082,6 +1090,7 @@ static uint32_t StaticSumSeeds()
 //
 void G_Ticker ()
 {
+	FHitchTicTimer hitchtimer;
 	int i;
 	gamestate_t	oldgamestate;
 
@@ -1938,6 +1947,9 @@ void G_DoLoadGame ()
 	hidecon = gameaction == ga_loadgamehidecon;
 	gameaction = ga_nothing;
 
+	// The savegame might still be in the process of being written.
+	G_FinishSaveGames(true);
+
 	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile(savename.GetChars(), true, true));
 	if (resfile == nullptr)
 	{
@@ -2275,7 +2287,7 @@ static void PutSaveComment (FSerializer &arc)
 
 static void PutSavePic (FileWriter *file, int width, int height)
 {
-	if (width <= 0 || height <= 0 || !storesavepic)
+	if (width <= 0 || height <= 0 || !storesavepic || headless)
 	{
 		M_CreateDummyPNG (file);
 	}
@@ -2288,6 +2300,90 @@ static void PutSavePic (FileWriter *file, int width, int height)
 	}
 }
 
+//==========================================================================
+//
+// Savegame writer
+//
+// Once the game state has been captured into memory, compressing the JSON
+// and writing the zip is done on a worker thread so that the game does not
+// stall. There is only one such thread, so saves that overlap get written
+// in the order they were made, and only the main thread reports the results.
+//
+//==========================================================================
+
+struct FSaveGameJob
+{
+	FString filename;
+	FString description;
+	bool okForQuicksave;
+	bool forceQuicksave;
+	FString info, globals;				// uncompressed, they go into content[1] and content[2].
+	TArray<FString> filenames;
+	TArray<FCompressedBuffer> content;	// the job owns all these buffers.
+	std::future<bool> result;
+};
+
+static ctpl::thread_pool SaveGamePool;
+static TArray<FSaveGameJob *> SaveGameJobs;
+
+static bool WriteSaveGame(FSaveGameJob *job)
+{
+	job->content[1] = CompressJSON(job->info.GetChars(), (unsigned)job->info.Len());
+	job->content[2] = CompressJSON(job->globals.GetChars(), (unsigned)job->globals.Len());
+
+	bool succeeded = false;
+
+	if (WriteZip(job->filename, job->filenames, job->content))
+	{
+		// Check whether the file is ok by trying to open it.
+		FResourceFile *test = FResourceFile::OpenResourceFile(job->filename, true);
+		if (test != nullptr)
+		{
+			delete test;
+			succeeded = true;
+		}
+	}
+
+	for (auto &buf : job->content) buf.Clean();
+	return succeeded;
+}
+
+static void FinishSaveGame(FSaveGameJob *job, bool succeeded)
+{
+	if (succeeded)
+	{
+		savegameManager.NotifyNewSave(job->filename, job->description, job->okForQuicksave, job->forceQuicksave);
+		BackupSaveName = job->filename;
+
+		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), job->filename.GetChars());
+		else Printf("%s\n", GStrings("GGSAVED"));
+	}
+	else
+	{
+		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
+	}
+	delete job;
+}
+
+//==========================================================================
+//
+// Reports the saves that have been written. With 'wait' set this also
+// blocks until the pending ones are done, which is needed before a
+// savegame gets loaded or the game shuts down.
+//
+//==========================================================================
+
+void G_FinishSaveGames(bool wait)
+{
+	while (SaveGameJobs.Size() > 0)
+	{
+		auto job = SaveGameJobs[0];
+		if (!wait && job->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) break;
+		SaveGameJobs.Delete(0);
+		FinishSaveGame(job, job->result.get());
+	}
+}
+
 void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
 {
 	TArray<FCompressedBuffer> savegame_content;
@@ -2385,53 +2481,60 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 		savegameglobals("nextskill", NextSkill);
 	}
 
+	auto job = new FSaveGameJob;
+	job->filename = filename;
+	job->description = description;
+	job->okForQuicksave = okForQuicksave;
+	job->forceQuicksave = forceQuicksave;
+
+	unsigned len;
+	const char *text = savegameinfo.GetOutput(&len);
+	job->info = FString(text, len);
+	text = savegameglobals.GetOutput(&len);
+	job->globals = FString(text, len);
+
 	auto picdata = savepic.GetBuffer();
 	FCompressedBuffer bufpng = { picdata->Size(), picdata->Size(), METHOD_STORED, 0, static_cast<unsigned int>(crc32(0, &(*picdata)[0], picdata->Size())), (char*)&(*picdata)[0] };
+	FCompressedBuffer nobuffer = { 0, 0, METHOD_STORED, 0, 0, nullptr };
 
 	savegame_content.Push(bufpng);
 	savegame_filenames.Push("savepic.png");
-	savegame_content.Push(savegameinfo.GetCompressedOutput());
+	savegame_content.Push(nobuffer);
 	savegame_filenames.Push("info.json");
-	savegame_content.Push(savegameglobals.GetCompressedOutput());
+	savegame_content.Push(nobuffer);
 	savegame_filenames.Push("globals.json");
 
 	G_WriteSnapshots (savegame_filenames, savegame_content);
-	
-
-	bool succeeded = false;
 
-	if (WriteZip(filename, savegame_filenames, savegame_content))
+	// The savepic and the level snapshots belong to the game and may be gone before the job is done, so it gets its own copies.
+	// These are already compressed so this is a lot cheaper than the compression that gets deferred.
+	for (auto &buf : savegame_content)
 	{
-		// Check whether the file is ok by trying to open it.
-		FResourceFile *test = FResourceFile::OpenResourceFile(filename, true);
-		if (test != nullptr)
+		if (buf.mBuffer != nullptr)
 		{
-			delete test;
-			succeeded = true;
+			char *copy = new char[buf.mCompressedSize];
+			memcpy(copy, buf.mBuffer, buf.mCompressedSize);
+			buf.mBuffer = copy;
 		}
 	}
+	job->filenames = std::move(savegame_filenames);
+	job->content = std::move(savegame_content);
 
-	if (succeeded)
-	{
-		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
-		BackupSaveName = filename;
+	// We don't need the snapshot any longer.
+	level.info->Snapshot.Clean();
 
-		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), filename.GetChars());
-		else Printf("%s\n", GStrings("GGSAVED"));
+	if (save_async)
+	{
+		if (SaveGamePool.size() == 0) SaveGamePool.resize(1);
+		job->result = SaveGamePool.push([=](int) { return WriteSaveGame(job); });
+		SaveGameJobs.Push(job);
 	}
 	else
 	{
-		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
+		// Still report any earlier saves first.
+		G_FinishSaveGames(true);
+		FinishSaveGame(job, WriteSaveGame(job));
 	}
-
-
-	// delete the JSON buffers we created just above. Everything else will
-	// either still be needed or taken care of automatically.
-	savegame_content[1].Clean();
-	savegame_content[2].Clean();
-
-	// We don't need the snapshot any longer.
-	level.info->Snapshot.Clean();
 		
 	insave = false;
 
@@ -2907,6 +3010,8 @@ void G_DoPlayDemo (void)
 
 		usergame = false;
 		demoplayback = true;
+		demostarttic = gametic;
+		demofromsave = mapname.Len() == 0;
 	}
 }
 
@@ -2915,7 +3020,7 @@ void G_DoPlayDemo (void)
 //
 void G_TimeDemo (const char* name)
 {
-	nodrawers = !!Args->CheckParm ("-nodraw");
+	nodrawers = headless || !!Args->CheckParm ("-nodraw");
 	noblit = !!Args->CheckParm ("-noblit");
 	timingdemo = true;
 	singletics = true;
@@ -2925,6 +3030,101 @@ void G_TimeDemo (const char* name)
 }
 
 
+//==========================================================================
+//
+// G_StopDemoPlayback
+//
+// Undoes everything the demo's header set up.
+//
+//==========================================================================
+
+static void G_StopDemoPlayback ()
+{
+	C_RestoreCVars ();		// [RH] Restore cvars demo might have changed
+	M_Free (demobuffer);
+	demobuffer = NULL;
+
+	P_SetupWeapons_ntohton();
+	demoplayback = false;
+	netgame = false;
+	multiplayer = false;
+	singletics = false;
+	for (int i = 1; i < MAXPLAYERS; i++)
+		playeringame[i] = 0;
+	consoleplayer = 0;
+	players[0].camera = nullptr;
+	if (StatusBar != NULL)
+	{
+		StatusBar->AttachToPlayer (&players[0]);
+	}
+}
+
+//==========================================================================
+//
+// G_DemoSeeking
+//
+// True while the main loop should run the demo's tics without waiting
+// for the clock, to reach the position requested with demo_seek.
+//
+//==========================================================================
+
+bool G_DemoSeeking ()
+{
+	if (demoseektic < 0) return false;
+	if (demoplayback && gametic - demostarttic < demoseektic) return true;
+	if (demoplayback || gameaction != ga_playdemo)
+	{
+		// Either the target has been reached or the demo is gone.
+		if (demoplayback) Printf ("Demo at %d:%02d\n", demoseektic / TICRATE / 60, demoseektic / TICRATE % 60);
+		demoseektic = -1;
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// CCMD demo_seek
+//
+// Demos only contain the players' input, so there is nothing to jump to:
+// going forward runs the remaining tics as fast as possible and going
+// back replays the demo from its start.
+//
+//==========================================================================
+
+CCMD (demo_seek)
+{
+	if (!demoplayback)
+	{
+		Printf ("No demo is playing.\n");
+		return;
+	}
+
+	int now = gametic - demostarttic;
+	if (argv.argc() < 2)
+	{
+		Printf ("Usage: demo_seek [+|-]<seconds>\n");
+		Printf ("Demo at %d:%02d\n", now / TICRATE / 60, now / TICRATE % 60);
+		return;
+	}
+
+	const char *arg = argv[1];
+	int tics = int(atof(arg) * TICRATE);
+	int target = MAX(0, (*arg == '+' || *arg == '-')? now + tics : tics);
+
+	if (target < now)
+	{
+		if (demofromsave || timingdemo)
+		{
+			Printf ("This demo cannot be rewound.\n");
+			return;
+		}
+		D_SetupUserInfo ();
+		G_StopDemoPlayback ();
+		gameaction = ga_playdemo;
+	}
+	demoseektic = target;
+}
+
 /*
 ===================
 =
@@ -2950,27 +3150,15 @@ bool G_CheckDemoStatus (void)
 		if (timingdemo)
 			endtime = I_GetTime () - starttime;
 
-		C_RestoreCVars ();		// [RH] Restore cvars demo might have changed
-		M_Free (demobuffer);
-		demobuffer = NULL;
-
-		P_SetupWeapons_ntohton();
-		demoplayback = false;
-		netgame = false;
-		multiplayer = false;
-		singletics = false;
-		for (int i = 1; i < MAXPLAYERS; i++)
-			playeringame[i] = 0;
-		consoleplayer = 0;
-		players[0].camera = nullptr;
-		if (StatusBar != NULL)
-		{
-			StatusBar->AttachToPlayer (&players[0]);
-		}
+		G_StopDemoPlayback ();
+		demoseektic = -1;
 		if (singledemo || timingdemo)
 		{
 			if (timingdemo)
 			{
+				// An unattended benchmark either continues with the next demo or exits with the results.
+				if (BM_Active() && BM_EndDemo()) return true;
+
 				// Trying to get back to a stable state after timing a demo
 				// seems to cause problems. I don't feel like fixing that
 				// right now.
@@ -63,6 +63,7 @@ void G_DoLoadGame (void);
 
 // Called by M_Responder.
 void G_SaveGame (const char *filename, const char *description);
+void G_FinishSaveGames (bool wait);	// reports savegames that were written in the background
 // Called by messagebox
 void G_DoQuickSave ();
 
@@ -74,6 +75,7 @@ void G_BeginRecording (const char *startmap);
 void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
 bool G_CheckDemoStatus (void);
+bool G_DemoSeeking ();
 
 void G_Ticker (void);
 bool G_Responder (event_t*	ev);
@@ -0,0 +1,233 @@
+/*
+** g_hitchdetect.cpp
+** Frame time hitch detection with automatic trace capture
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 The GZDoom team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The durations of frames and tics are compared against a rolling average
+** of the previous ones. A frame or tic that takes hitch_threshold times as
+** long as the average, and at least hitch_minimum ms more, counts as a
+** hitch. The zone trace of the last hitch_history seconds then gets
+** written next to the screenshots, with the hitch itself marked as a zone.
+**
+*/
+
+#include "g_hitchdetect.h"
+#include "zonetrace.h"
+#include "gamestate.h"
+#include "g_levellocals.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "i_time.h"
+#include "i_specialpaths.h"
+#include "printf.h"
+#include "stats.h"
+
+EXTERN_CVAR(String, screenshot_dir)
+
+bool HitchActive;
+
+static void HD_Enable();
+
+CUSTOM_CVAR(Float, hitch_threshold, 0.f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+	else HD_Enable();
+}
+
+CUSTOM_CVAR(Float, hitch_minimum, 10.f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+}
+
+CUSTOM_CVAR(Float, hitch_history, 5.f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 1) self = 1;
+	else if (self > 30) self = 30;
+	else HD_Enable();
+}
+
+enum
+{
+	WARMUP_FRAMES = 35,		// frames to skip after a level got entered before anything is considered a hitch.
+};
+
+struct FHitchTimes
+{
+	double Average = 0;		// in ms
+	double Last = 0;
+	int Hitches = 0;
+};
+
+static FHitchTimes FrameTimes, TicTimes;
+static uint64_t LastFrameEnd;
+static uint64_t LastCapture;
+static int Warmup = WARMUP_FRAMES;
+static int LastMaptime;
+static FString LastCaptureFile;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void HD_Enable()
+{
+	HitchActive = hitch_threshold > 0;
+	Trace_SetHistory(HitchActive ? (double)hitch_history : 0.);
+	LastFrameEnd = 0;
+	Warmup = WARMUP_FRAMES;
+}
+
+//==========================================================================
+//
+// Returns true if the given duration counts as a hitch, otherwise it
+// gets added to the average.
+//
+//==========================================================================
+
+static bool HD_Check(FHitchTimes &times, uint64_t start, uint64_t end)
+{
+	double ms = (end - start) / 1'000'000.;
+	times.Last = ms;
+	if (Warmup > 0)
+	{
+		times.Average = times.Average == 0 ? ms : times.Average * 0.75 + ms * 0.25;
+		return false;
+	}
+	if (ms > times.Average * hitch_threshold && ms - times.Average > hitch_minimum)
+	{
+		times.Hitches++;
+		return true;
+	}
+	times.Average = times.Average * (31. / 32.) + ms * (1. / 32.);
+	return false;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void HD_Capture(const char *what, uint64_t start, uint64_t end, double average)
+{
+	Trace_End(what, start);
+
+	// Captures must not overlap, there'd be little new information in them.
+	if (LastCapture != 0 && end - LastCapture < uint64_t(hitch_history * 1'000'000'000.)) return;
+	LastCapture = end;
+
+	FString path = *screenshot_dir;
+	if (path.IsEmpty()) path = M_GetScreenshotsPath();
+	if (path.IsNotEmpty() && path.Back() != '/' && path.Back() != '\\') path += '/';
+	path = NicePath(path);
+	CreatePath(path);
+
+	FString filename;
+	for (int i = 0; i < 10000; i++)
+	{
+		filename.Format("%shitch_%04d.json", path.GetChars(), i);
+		if (!FileExists(filename)) break;
+	}
+
+	if (Trace_WriteHistory(filename))
+	{
+		LastCaptureFile = filename;
+		Printf("%s of %.1f ms (average %.1f ms), trace written to %s\n", what, (end - start) / 1'000'000., average, filename.GetChars());
+	}
+}
+
+//==========================================================================
+//
+// Called once per displayed frame.
+//
+//==========================================================================
+
+void HD_EndFrame()
+{
+	if (!HitchActive) return;
+
+	uint64_t now = I_nsTime();
+	if (gamestate != GS_LEVEL || primaryLevel->maptime < LastMaptime)
+	{
+		// Loading a level and switching between game states are expected to take time.
+		Warmup = WARMUP_FRAMES;
+	}
+	LastMaptime = gamestate == GS_LEVEL ? primaryLevel->maptime : 0;
+
+	if (LastFrameEnd != 0)
+	{
+		double average = FrameTimes.Average;
+		if (HD_Check(FrameTimes, LastFrameEnd, now)) HD_Capture("Frame hitch", LastFrameEnd, now, average);
+	}
+	LastFrameEnd = now;
+	if (Warmup > 0) Warmup--;
+}
+
+//==========================================================================
+//
+// Times a single G_Ticker call.
+//
+//==========================================================================
+
+FHitchTicTimer::FHitchTicTimer()
+{
+	start = HitchActive ? I_nsTime() : 0;
+}
+
+FHitchTicTimer::~FHitchTicTimer()
+{
+	if (start == 0 || !HitchActive) return;
+
+	uint64_t now = I_nsTime();
+	double average = TicTimes.Average;
+	if (HD_Check(TicTimes, start, now)) HD_Capture("Tic hitch", start, now, average);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+ADD_STAT(hitches)
+{
+	FString out;
+	if (!HitchActive)
+	{
+		out = "Hitch detection is off, set hitch_threshold to enable it.";
+		return out;
+	}
+	out.Format("Frame: %.1f ms, average %.1f ms, %d hitches\nTic: %.1f ms, average %.1f ms, %d hitches",
+		FrameTimes.Last, FrameTimes.Average, FrameTimes.Hitches, TicTimes.Last, TicTimes.Average, TicTimes.Hitches);
+	if (LastCaptureFile.IsNotEmpty()) out.AppendFormat("\nLast capture: %s", LastCaptureFile.GetChars());
+	return out;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// Detects frames and tics that take far longer than usual (hitch_threshold)
+// and writes the zone trace of the preceding seconds when one happens.
+
+extern bool HitchActive;
+
+void HD_EndFrame();
+
+class FHitchTicTimer
+{
+	uint64_t start;
+
+public:
+	FHitchTicTimer();
+	~FHitchTicTimer();
+};
@@ -33,6 +33,7 @@
 */
 
 #include <assert.h>
+#include <future>
 #include "templates.h"
 #include "d_main.h"
 #include "g_level.h"
@@ -92,6 +93,7 @@
 #include "p_maputl.h"
 #include "s_music.h"
 #include "texturemanager.h"
+#include "ctpl.h"
 
 void STAT_StartNewGame(const char *lev);
 void STAT_ChangeLevel(const char *newl, FLevelLocals *Level);
@@ -989,7 +991,7 @@ bool FLevelLocals::DoCompleted (FString nextlevel, wbstartstruct_t &wminfo)
 	{ // Remember the level's state for re-entry.
 		if (!(flags2 & LEVEL2_FORGETSTATE))
 		{
-			SnapshotLevel ();
+			SnapshotLevel (true);
 			// Do not free any global strings this level might reference
 			// while it's not loaded.
 			Behaviors.LockLevelVarStrings(levelnum);
@@ -1734,6 +1736,71 @@ void FLevelLocals::AirControlChanged ()
 	}
 }
 
+//==========================================================================
+//
+// Snapshots of levels that are left for another one in the same hub are
+// not needed until the level gets revisited or the game gets saved.
+// So they are stored uncompressed at first, which is a valid buffer for
+// all of these uses, and get compressed on a worker thread. Once that is
+// done, the compressed version replaces the stored one.
+//
+//==========================================================================
+
+struct FSnapshotJob
+{
+	level_info_t *info;
+	FCompressedBuffer stored;		// what was put into info->Snapshot, only for identification.
+	FString text;
+	FCompressedBuffer compressed;
+	std::future<void> result;
+};
+
+static ctpl::thread_pool SnapshotPool;
+static TArray<FSnapshotJob *> SnapshotJobs;
+
+void G_StoreSnapshot(level_info_t *info, const char *text, unsigned len)
+{
+	auto job = new FSnapshotJob;
+	job->info = info;
+	job->text = FString(text, len);
+
+	char *buffer = new char[len];
+	memcpy(buffer, text, len);
+	job->stored = { len, len, METHOD_STORED, 0, static_cast<unsigned int>(crc32(0, (const Bytef*)text, len)), buffer };
+	info->Snapshot.Clean();
+	info->Snapshot = job->stored;
+
+	if (SnapshotPool.size() == 0) SnapshotPool.resize(1);
+	job->result = SnapshotPool.push([=](int) { job->compressed = CompressJSON(job->text.GetChars(), (unsigned)job->text.Len()); });
+	SnapshotJobs.Push(job);
+}
+
+void G_FinishSnapshots(bool wait)
+{
+	while (SnapshotJobs.Size() > 0)
+	{
+		auto job = SnapshotJobs[0];
+		if (!wait && job->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) break;
+		SnapshotJobs.Delete(0);
+		job->result.get();
+
+		// The snapshot may have been replaced or deleted in the mean time. Should a new one have ended up
+		// at the same address, the checksum still ensures that the compressed data is for the same content.
+		auto &snapshot = job->info->Snapshot;
+		if (snapshot.mBuffer == job->stored.mBuffer && snapshot.mMethod == METHOD_STORED &&
+			snapshot.mSize == job->stored.mSize && snapshot.mCRC32 == job->stored.mCRC32)
+		{
+			snapshot.Clean();
+			snapshot = job->compressed;
+		}
+		else
+		{
+			job->compressed.Clean();
+		}
+		delete job;
+	}
+}
+
 //==========================================================================
 //
 //
@@ -1744,6 +1811,9 @@ void G_WriteSnapshots(TArray<FString> &filenames, TArray<FCompressedBuffer> &buf
 	unsigned int i;
 	FString filename;
 
+	// Savegames should get the compressed versions.
+	G_FinishSnapshots(true);
+
 	for (i = 0; i < wadlevelinfos.Size(); i++)
 	{
 		if (wadlevelinfos[i].Snapshot.mCompressedSize > 0)
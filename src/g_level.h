@@ -35,6 +35,8 @@ void G_ClearSnapshots (void);
 void P_RemoveDefereds ();
 void G_ReadSnapshots (FResourceFile *);
 void G_WriteSnapshots (TArray<FString> &, TArray<FCompressedBuffer> &);
+void G_StoreSnapshot (level_info_t *info, const char *text, unsigned len);
+void G_FinishSnapshots (bool wait);
 void G_WriteVisited(FSerializer &arc);
 void G_ReadVisited(FSerializer &arc);
 void G_ClearHubInfo();
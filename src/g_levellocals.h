@@ -54,7 +54,10 @@
 #include "r_data/r_sections.h"
 #include "r_data/r_canvastexture.h"
 #include "r_data/r_interpolate.h"
+#include "p_navigation.h"
+#include "p_soundgraph.h"
 #include "doom_aabbtree.h"
+#include "memarena.h"
 
 //============================================================================
 //
@@ -169,7 +172,7 @@ private:
 	void PlayerSpawnPickClass (int playernum);
 
 public:
-	void SnapshotLevel();
+	void SnapshotLevel(bool deferred = false);
 	void UnSnapshotLevel(bool hubLoad);
 
 	void FinalizePortals();
@@ -409,6 +412,11 @@ public:
 		return true;
 	}
 
+	bool CheckSightZones(sector_t *s1, sector_t *s2)
+	{
+		return sightzones.Size() == 0 || sightzones[s1->Index()] == sightzones[s2->Index()];
+	}
+
 	DThinker *CreateThinker(PClass *cls, int statnum = STAT_DEFAULT)
 	{
 		DThinker *thinker = static_cast<DThinker*>(cls->CreateNew());
@@ -444,6 +452,7 @@ public:
 	TArray<node_t> gamenodes;
 	node_t *headgamenode;
 	TArray<uint8_t> rejectmatrix;
+	TArray<int> sightzones;		// sectors with different zones are not connected.
 	TArray<zone_t>	Zones;
 	TArray<FPolyObj> Polyobjects;
 
@@ -457,6 +466,8 @@ public:
 	TArray<FSectorPortalGroup *> portalGroups;
 	TArray<FLinePortalSpan> linePortalSpans;
 	FSectionContainer sections;
+	FNavGraph navgraph;
+	FSoundGraph soundgraph;
 	FCanvasTextureInfo canvasTextureInfo;
 	EventManager *localEventManager = nullptr;
 	DoomLevelAABBTree* aabbTree = nullptr;
@@ -466,6 +477,17 @@ public:
 
 	FBlockmap blockmap;
 	TArray<polyblock_t *> PolyBlockMap;
+
+	// Storage for small, trivially destructible pieces of level data that live until the level gets unloaded,
+	// like the polyobject blockmap links and the portal groups. It gets released in one go by ClearLevelData.
+	FMemArena LevelArena{ 64 * 1024 };
+
+	template<class T> T *AllocLevelData(size_t count = 1)
+	{
+		auto p = (T *)LevelArena.Alloc(sizeof(T) * count);
+		for (size_t i = 0; i < count; i++) ::new(&p[i]) T;
+		return p;
+	}
 	FUDMFKeyMap UDMFKeys[4];
 
 	// These are copies of the loaded map data that get used by the savegame code to skip unaltered fields
@@ -665,6 +687,7 @@ public:
 	int			ImpactDecalCount;
 
 	FDynamicLight *lights;
+	TArray<AActor *> LightUpdates;	// actors with MF8_RECREATELIGHTS set, processed at the end of the tic
 
 	// links to global game objects
 	TArray<TObjPtr<AActor *>> CorpseQueue;
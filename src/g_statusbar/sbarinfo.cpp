@@ -67,6 +67,8 @@ EXTERN_CVAR(Int, fraglimit)
 EXTERN_CVAR(Int, screenblocks)
 EXTERN_CVAR(Bool, vid_fps)
 
+CVAR(Bool, sbarinfo_cachedraws, true, 0)
+
 class DSBarInfo;
 static double nulclip[] = { 0,0,0,0 };
 
@@ -1065,6 +1067,22 @@ public:
 
 		SetReferences();
 
+		// Everything the status bar shows only changes with the game tic, the
+		// screen layout or some setting, so between those the last output gets
+		// drawn again without evaluating the commands.
+		FDrawKey key;
+		GetDrawKey(state, key);
+		if (sbarinfo_cachedraws && cacheValid && !memcmp(&key, &cachedKey, sizeof(key)))
+		{
+			twod->Replay(cachedDraws);
+			if (state != HUD_AltHud) wrapper->ForceHUDScale(false);
+			ammo1 = ammo2 = nullptr;
+			armor = nullptr;
+			return;
+		}
+		cachedDraws.Clear();
+		twod->BeginRecording(&cachedDraws);
+
 		if(state != HUD_AltHud)
 		{
 			if(hud != lastHud)
@@ -1118,6 +1136,11 @@ public:
 		else
 			lastPopup = NULL;
 
+		twod->EndRecording();
+		// Drawing may have changed some of the state the key is made of.
+		GetDrawKey(state, cachedKey);
+		cacheValid = true;
+
 		// These may not live any longer than beyond here!
 		ammo1 = ammo2 = nullptr;
 		armor = nullptr;
@@ -1128,6 +1151,7 @@ public:
 		// Reset the huds
 		script->ResetHuds();
 		lastHud = -1; // Reset
+		cacheValid = false;
 	}
 
 	bool _MustDrawLog (EHudState state)
@@ -1493,12 +1517,58 @@ public:
 	DBaseStatusBar *wrapper;
 
 private:
+	// Everything outside the playsim the drawn status bar depends on.
+	struct FDrawKey
+	{
+		int gametic;
+		int cvars;
+		int state;
+		int popup;
+		player_t *player;
+		bool automap;
+		bool fullscreenOffsets;
+		bool forcedScale;
+		int width, height;
+		int clip[4];
+		int x, y, relTop;
+		double displacement;
+		double alpha;
+		DVector2 scale;
+		DVector2 offset;
+	};
+
+	void GetDrawKey(EHudState state, FDrawKey &key) const
+	{
+		memset(&key, 0, sizeof(key));	// the key gets compared with memcmp, so the padding must be cleared, too.
+		key.gametic = gametic;
+		key.cvars = FBaseCVar::GetChangeCount();
+		key.state = state;
+		key.popup = currentPopup;
+		key.player = CPlayer;
+		key.automap = automapactive;
+		key.fullscreenOffsets = wrapper->fullscreenOffsets;
+		key.forcedScale = wrapper->ForcedScale;
+		key.width = twod->GetWidth();
+		key.height = twod->GetHeight();
+		twod->GetClipRect(&key.clip[0], &key.clip[1], &key.clip[2], &key.clip[3]);
+		key.x = wrapper->ST_X;
+		key.y = wrapper->ST_Y;
+		key.relTop = wrapper->RelTop;
+		key.displacement = wrapper->Displacement;
+		key.alpha = wrapper->Alpha;
+		key.scale = wrapper->SBarScale;
+		key.offset = wrapper->drawOffset;
+	}
+
 	SBarInfo *script;
 	int pendingPopup;
 	int currentPopup;
 	int lastHud;
 	SBarInfoMainBlock *lastInventoryBar;
 	SBarInfoMainBlock *lastPopup;
+	FDrawKey cachedKey;
+	bool cacheValid = false;
+	F2DDrawer::FRecordedDraws cachedDraws;
 };
 
 
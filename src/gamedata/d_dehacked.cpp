@@ -740,12 +740,22 @@ static void (*MBFCodePointerFactories[])(FunctionCallEmitter&, int, int) =
 
 // Creates new functions for the given state so as to convert MBF-args (misc1 and misc2) into real args.
 
-static void SetDehParams(FState *state, int codepointer, VMDisassemblyDumper &disasmdump)
+static void SetDehParams(FState *state, int codepointer, VMDisassemblyDumper &disasmdump, TMap<FString, VMScriptFunction *> &builtFunctions)
 {
 	static const uint8_t regts[] = { REGT_POINTER, REGT_POINTER, REGT_POINTER };
 	int value1 = state->GetMisc1();
 	int value2 = state->GetMisc2();
 	if (!(value1|value2)) return;
+
+	// Patches tend to use the same parameters on many frames, so each combination only gets compiled once.
+	FString funcname;
+	funcname.Format("Dehacked.%s.%d.%d", MBFCodePointers[codepointer].name.GetChars(), value1, value2);
+	auto built = builtFunctions.CheckKey(funcname);
+	if (built != nullptr)
+	{
+		state->SetAction(*built);
+		return;
+	}
 	
 	bool returnsState = codepointer == 6;
 	
@@ -794,7 +804,8 @@ static void SetDehParams(FState *state, int codepointer, VMDisassemblyDumper &di
 		sfunc->NumArgs = numargs;
 		sfunc->ImplicitArgs = numargs;
 		state->SetAction(sfunc);
-		sfunc->PrintableName.Format("Dehacked.%s.%d.%d", MBFCodePointers[codepointer].name.GetChars(), value1, value2);
+		sfunc->PrintableName = funcname;
+		builtFunctions.Insert(funcname, sfunc);
 
 		disasmdump.Write(sfunc, sfunc->PrintableName);
 
@@ -2640,9 +2651,10 @@ static void UnloadDehSupp ()
 		VMDisassemblyDumper disasmdump(VMDisassemblyDumper::Append);
 
 		// Handle MBF params here, before the required arrays are cleared
+		TMap<FString, VMScriptFunction *> builtFunctions;
 		for (unsigned int i=0; i < MBFParamStates.Size(); i++)
 		{
-			SetDehParams(MBFParamStates[i].state, MBFParamStates[i].pointer, disasmdump);
+			SetDehParams(MBFParamStates[i].state, MBFParamStates[i].pointer, disasmdump, builtFunctions);
 		}
 		MBFParamStates.Clear();
 		MBFParamStates.ShrinkToFit();
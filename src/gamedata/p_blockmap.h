@@ -2,6 +2,7 @@
 #define __P_BLOCKMAP_H
 
 #include "doomtype.h"
+#include "tarray.h"
 
 class AActor;
 
@@ -11,8 +12,7 @@ struct FBlockNode
 	AActor *Me;						// actor this node references
 	int BlockIndex;					// index into blocklinks for the block this node is in
 	int Group;						// portal group this link belongs to (can be different than the actor's own group
-	FBlockNode **PrevActor;			// previous actor in this block
-	FBlockNode *NextActor;			// next actor in this block
+	int Slot;						// position of this node in its block's thing array
 	FBlockNode **PrevBlock;			// previous block this actor is in
 	FBlockNode *NextBlock;			// next block this actor is in
 
@@ -22,6 +22,15 @@ struct FBlockNode
 	static FBlockNode *FreeBlocks;
 };
 
+// One entry in a block's thing array. The actor is stored alongside the node
+// so that walking a block does not have to touch the nodes themselves.
+// Removed links leave a hole (Me == nullptr) until the next FBlockmap::Compact.
+struct FBlockThing
+{
+	AActor *Me;
+	FBlockNode *Node;
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -39,7 +48,9 @@ struct FBlockmap
 	int					bmapheight; 	// in mapblocks
 	double				bmaporgx;
 	double				bmaporgy;		// origin of block map
-	FBlockNode**		blocklinks; 	// for thing chains
+	TArray<FBlockThing>* blockthings;	// for thing arrays, ordered from the oldest to the newest link
+	TArray<int>			dirtyblocks;	// blocks which contain holes
+	TArray<bool>		blockdirty;
 
 	// mapblocks are used to check movement
 	// against lines and things
@@ -75,6 +86,38 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count, unsigned numlines);
 
+	// Links are appended so a block's things have to be walked from the back
+	// to get the newest link first, like the old linked lists did.
+	void LinkThing(FBlockNode *node)
+	{
+		auto &things = blockthings[node->BlockIndex];
+		node->Slot = things.Push({ node->Me, node });
+	}
+
+	// Unlinking only leaves a hole, so that indices held by active iterators stay valid.
+	// A node that was unlinked can be put back into its old position with RelinkThing
+	// as long as no compaction took place in between.
+	void UnlinkThing(FBlockNode *node)
+	{
+		auto &thing = blockthings[node->BlockIndex][node->Slot];
+		thing.Me = nullptr;
+		thing.Node = nullptr;
+		if (!blockdirty[node->BlockIndex])
+		{
+			blockdirty[node->BlockIndex] = true;
+			dirtyblocks.Push(node->BlockIndex);
+		}
+	}
+
+	void RelinkThing(FBlockNode *node)
+	{
+		auto &thing = blockthings[node->BlockIndex][node->Slot];
+		thing.Me = node->Me;
+		thing.Node = node;
+	}
+
+	void Compact();
+
 	void Clear()
 	{
 		if (blockmaplump != nullptr)
@@ -82,11 +125,13 @@ struct FBlockmap
 			delete[] blockmaplump;
 			blockmaplump = nullptr;
 		}
-		if (blocklinks != nullptr)
+		if (blockthings != nullptr)
 		{
-			delete[] blocklinks;
-			blocklinks = nullptr;
+			delete[] blockthings;
+			blockthings = nullptr;
 		}
+		blockdirty.Reset();
+		dirtyblocks.Reset();
 	}
 
 	~FBlockmap()
@@ -558,6 +558,7 @@ struct extsector_t
 	struct xfloor
 	{
 		TDeletingArray<F3DFloor *>		ffloors;		// 3D floors in this sector
+		TArray<F3DFloor *>				solidffloors;	// the existing, solid ones of ffloors in the same order, maintained by P_Recalculate3DFloors
 		TArray<lightlist_t>				lightlist;		// 3D light list
 		TArray<sector_t*>				attached;		// 3D floors attached to this sector
 	} XFloor;
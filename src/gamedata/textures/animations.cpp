@@ -70,6 +70,7 @@ void FTextureAnimator::DeleteAll()
 		}
 	}
 	mAnimations.Clear();
+	mNextSwitchTime = 0;
 
 	for (unsigned i = 0; i < mSwitchDefs.Size(); i++)
 	{
@@ -103,6 +104,7 @@ void FTextureAnimator::DeleteAll()
 
 FAnimDef *FTextureAnimator::AddAnim (FAnimDef *anim)
 {
+	mNextSwitchTime = 0;	// make sure the new animation gets picked up by the next update.
 	// Search for existing duplicate.
 	for (unsigned int i = 0; i < mAnimations.Size(); ++i)
 	{
@@ -915,15 +917,21 @@ void FAnimDef::SetSwitchTime (uint64_t mstime)
 
 void FTextureAnimator::UpdateAnimations (uint64_t mstime)
 {
+	// Most frames no animation is due to switch, so don't bother looking at them.
+	if (mNextSwitchTime != 0 && mstime < mNextSwitchTime) return;
+
+	uint64_t nextswitch = UINT64_MAX;
 	for (unsigned int j = 0; j < mAnimations.Size(); ++j)
 	{
 		FAnimDef *anim = mAnimations[j];
+		bool changed = false;
 
 		// If this is the first time through R_UpdateAnimations, just
 		// initialize the anim's switch time without actually animating.
 		if (anim->SwitchTime == 0)
 		{
 			anim->SetSwitchTime (mstime);
+			changed = true;
 		}
 		else while (anim->SwitchTime <= mstime)
 		{ // Multiple frames may have passed since the last time calling
@@ -974,7 +982,12 @@ void FTextureAnimator::UpdateAnimations (uint64_t mstime)
 				break;
 			}
 			anim->SetSwitchTime (mstime);
+			changed = true;
 		}
+		if (anim->SwitchTime < nextswitch) nextswitch = anim->SwitchTime;
+
+		// The translations only need to be touched when the frame actually advanced.
+		if (!changed) continue;
 
 		if (anim->bDiscrete)
 		{
@@ -988,6 +1001,7 @@ void FTextureAnimator::UpdateAnimations (uint64_t mstime)
 			}
 		}
 	}
+	mNextSwitchTime = nextswitch;
 }
 
 //==========================================================================
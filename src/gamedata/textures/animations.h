@@ -62,6 +62,7 @@ class FTextureAnimator
 	TArray<FAnimDef*> mAnimations;
 	TArray<FSwitchDef*> mSwitchDefs;
 	TArray<FDoorAnimation> mAnimatedDoors;
+	uint64_t mNextSwitchTime = 0;	// earliest time at which any animation needs to advance
 
 	void ParseAnim(FScanner& sc, ETextureType usetype);
 	FAnimDef* ParseRangeAnim(FScanner& sc, FTextureID picnum, ETextureType usetype, bool missing);
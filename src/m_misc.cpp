@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <time.h>
+#include <future>
 
 #include "r_defs.h"
 
@@ -66,12 +67,14 @@
 
 #include "gameconfigfile.h"
 #include "gstrings.h"
+#include "ctpl.h"
 
 FGameConfigFile *GameConfig;
 
 CVAR(Bool, screenshot_quiet, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
 CVAR(String, screenshot_type, "png", CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
 CVAR(String, screenshot_dir, "", CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
+CVAR(Bool, screenshot_async, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);	// encode PNG screenshots on a worker thread.
 EXTERN_CVAR(Bool, longsavemessages);
 
 static long ParseCommandLine (const char *args, int *argc, char **argv);
@@ -505,19 +508,80 @@ void WritePCXfile (FileWriter *file, const uint8_t *buffer, const PalEntry *pale
 //
 // WritePNGfile
 //
-void WritePNGfile (FileWriter *file, const uint8_t *buffer, const PalEntry *palette,
+static bool EncodePNGfile (FileWriter *file, const uint8_t *buffer, const PalEntry *palette,
 				   ESSType color_type, int width, int height, int pitch, float gamma)
 {
 	char software[100];
 	mysnprintf(software, countof(software), GAMENAME " %s", GetVersionString());
-	if (!M_CreatePNG (file, buffer, palette, color_type, width, height, pitch, gamma) ||
-		!M_AppendPNGText (file, "Software", software) ||
-		!M_FinishPNG (file))
+	return M_CreatePNG (file, buffer, palette, color_type, width, height, pitch, gamma) &&
+		M_AppendPNGText (file, "Software", software) &&
+		M_FinishPNG (file);
+}
+
+void WritePNGfile (FileWriter *file, const uint8_t *buffer, const PalEntry *palette,
+				   ESSType color_type, int width, int height, int pitch, float gamma)
+{
+	if (!EncodePNGfile(file, buffer, palette, color_type, width, height, pitch, gamma))
 	{
 		Printf ("%s\n", GStrings("TXT_SCREENSHOTERR"));
 	}
 }
 
+//==========================================================================
+//
+// Screenshot writer
+//
+// PNG compression of a full resolution screenshot takes long enough to
+// cause a visible stall, so once the image has been read back it gets
+// encoded on a worker thread. The file is already opened by the main
+// thread so that the next screenshot cannot pick the same name.
+//
+//==========================================================================
+
+struct FScreenShotJob
+{
+	FString filename;
+	FileWriter *file;
+	TArray<uint8_t> buffer;
+	ESSType color_type;
+	int width, height, pitch;
+	float gamma;
+	std::future<bool> result;
+};
+
+static ctpl::thread_pool ScreenShotPool;
+static TArray<FScreenShotJob *> ScreenShotJobs;
+
+static void ReportScreenShot(const FString &filename)
+{
+	if (!screenshot_quiet)
+	{
+		int slash = -1;
+		if (!longsavemessages) slash = filename.LastIndexOfAny(":/\\");
+		Printf ("Captured %s\n", filename.GetChars()+slash+1);
+	}
+}
+
+//==========================================================================
+//
+// Reports the screenshots that have been written. With 'wait' set this
+// blocks until all pending ones are done.
+//
+//==========================================================================
+
+void M_FinishScreenShots(bool wait)
+{
+	while (ScreenShotJobs.Size() > 0)
+	{
+		auto job = ScreenShotJobs[0];
+		if (!wait && job->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) break;
+		ScreenShotJobs.Delete(0);
+		if (job->result.get()) ReportScreenShot(job->filename);
+		else Printf ("%s\n", GStrings("TXT_SCREENSHOTERR"));
+		delete job;
+	}
+}
+
 
 //
 // M_ScreenShot
@@ -626,19 +690,36 @@ void M_ScreenShot (const char *filename)
 			WritePCXfile(file, buffer.Data(), nullptr, color_type,
 				screen->GetWidth(), screen->GetHeight(), pitch);
 		}
+		else if (screenshot_async)
+		{
+			auto job = new FScreenShotJob;
+			job->filename = autoname;
+			job->file = file;
+			job->buffer = std::move(buffer);
+			job->color_type = color_type;
+			job->width = screen->GetWidth();
+			job->height = screen->GetHeight();
+			job->pitch = pitch;
+			job->gamma = gamma;
+
+			if (ScreenShotPool.size() == 0) ScreenShotPool.resize(1);
+			job->result = ScreenShotPool.push([=](int)
+			{
+				bool res = EncodePNGfile(job->file, job->buffer.Data(), nullptr, job->color_type, job->width, job->height, job->pitch, job->gamma);
+				delete job->file;
+				job->buffer.Reset();
+				return res;
+			});
+			ScreenShotJobs.Push(job);
+			return;
+		}
 		else
 		{
 			WritePNGfile(file, buffer.Data(), nullptr, color_type,
 				screen->GetWidth(), screen->GetHeight(), pitch, gamma);
 		}
 		delete file;
-
-		if (!screenshot_quiet)
-		{
-			int slash = -1;
-			if (!longsavemessages) slash = autoname.LastIndexOfAny(":/\\");
-			Printf ("Captured %s\n", autoname.GetChars()+slash+1);
-		}
+		ReportScreenShot(autoname);
 	}
 	else
 	{
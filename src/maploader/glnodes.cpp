@@ -63,6 +63,7 @@
 
 EXTERN_CVAR(Bool, gl_cachenodes)
 EXTERN_CVAR(Float, gl_cachetime)
+EXTERN_CVAR(String, gl_sharednodecache)
 
 // fixed 32 bit gl_vert format v2.0+ (glBsp 1.91)
 struct mapglvertex_t
@@ -923,7 +924,7 @@ bool MapLoader::LoadGLNodes(MapData * map)
 //
 //==========================================================================
 
-bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime)
+bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime, const int *oldvertextable, unsigned numoldverts)
 {
 	bool ret = false;
 	bool loaded = false;
@@ -978,7 +979,7 @@ bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime)
 		if (Level->maptype != MAPTYPE_BUILD && gl_cachenodes && buildtime/1000.f >= gl_cachetime)
 		{
 			DPrintf(DMSG_NOTIFY, "Caching nodes\n");
-			CreateCachedNodes(map);
+			CreateCachedNodes(map, oldvertextable, numoldverts);
 		}
 		else
 		{
@@ -997,6 +998,27 @@ bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime)
 typedef TArray<uint8_t> MemFile;
 
 
+//==========================================================================
+//
+// Cache files named after the map's checksum only depend on the map data
+// itself, not on the archive it was loaded from. So they can be copied
+// between machines as-is, e.g. into a shared read-only directory.
+//
+//==========================================================================
+
+static FString CreateHashedCacheName(const char *dir, MapData *map, bool create)
+{
+	uint8_t md5[16];
+	map->GetChecksum(md5);
+
+	FString path = dir;
+	if (create) CreatePath(path);
+	path << '/';
+	for (auto c : md5) path.AppendFormat("%02x", c);
+	path << ".gzc";
+	return path;
+}
+
 static FString CreateCacheName(MapData *map, bool create)
 {
 	FString path = M_GetCachePath(create);
@@ -1032,7 +1054,7 @@ static void WriteLong(MemFile &f, uint32_t b)
 	f[v+3] = (uint8_t)(b>>24);
 }
 
-void MapLoader::CreateCachedNodes(MapData *map)
+void MapLoader::CreateCachedNodes(MapData *map, const int *oldvertextable, unsigned numoldverts)
 {
 	MemFile ZNodes;
 
@@ -1100,6 +1122,13 @@ void MapLoader::CreateCachedNodes(MapData *map)
 	uLongf outlen = ZNodes.Size();
 	TArray<Bytef> compressed;
 	int offset = Level->lines.Size() * 8 + 12 + 16;
+
+	// Nodes that were rebuilt in place of the map's own ones (numoldverts is the map's original vertex count then)
+	// renumber the vertices. The table that maps the original vertices to the new ones is needed for vertex slopes
+	// so it has to be stored along with them, otherwise the cache could not stand in for the rebuild.
+	bool rebuiltnodes = numoldverts > 0;
+	if (oldvertextable == nullptr) numoldverts = 0;
+	if (rebuiltnodes) offset += 8 + numoldverts * 4;
 	int r;
 	do
 	{
@@ -1121,9 +1150,21 @@ void MapLoader::CreateCachedNodes(MapData *map)
 		uint32_t ndx[2] = { LittleLong(uint32_t(Index(Level->lines[i].v1))), LittleLong(uint32_t(Index(Level->lines[i].v2))) };
 		memcpy(&compressed[8 + 16 + 8 * i], ndx, 8);
 	}
+	if (rebuiltnodes)
+	{
+		int tablepos = 8 + 16 + 8 * Level->lines.Size();
+		memcpy(&compressed[tablepos], "OVTX", 4);
+		uint32_t count = LittleLong(numoldverts);
+		memcpy(&compressed[tablepos + 4], &count, 4);
+		for (unsigned i = 0; i < numoldverts; i++)
+		{
+			uint32_t ndx = LittleLong(uint32_t(oldvertextable[i]));
+			memcpy(&compressed[tablepos + 8 + 4 * i], &ndx, 4);
+		}
+	}
 	memcpy(&compressed[offset - 4], "ZGL3", 4);
 
-	FString path = CreateCacheName(map, true);
+	FString path = CreateHashedCacheName(M_GetCachePath(true) + "/nodes", map, true);
 	FileWriter *fw = FileWriter::Open(path);
 
 	if (fw != nullptr)
@@ -1142,15 +1183,33 @@ void MapLoader::CreateCachedNodes(MapData *map)
 }
 
 
-bool MapLoader::CheckCachedNodes(MapData *map)
+bool MapLoader::CheckCachedNodes(MapData *map, int **oldvertextable, unsigned numoldverts)
+{
+	// Checksum named files from the user's own cache come first, then the ones from before they were named this way,
+	// and finally the shared directory.
+	if (ReadCachedNodes(map, CreateHashedCacheName(M_GetCachePath(false) + "/nodes", map, false), oldvertextable, numoldverts)) return true;
+	if (ReadCachedNodes(map, CreateCacheName(map, false), oldvertextable, numoldverts)) return true;
+	if ((*gl_sharednodecache)[0] != 0 && ReadCachedNodes(map, CreateHashedCacheName(gl_sharednodecache, map, false), oldvertextable, numoldverts)) return true;
+	return false;
+}
+
+//==========================================================================
+//
+// If oldvertextable is passed, the nodes are meant to replace a forced
+// rebuild and only files that were written for one are accepted.
+//
+//==========================================================================
+
+bool MapLoader::ReadCachedNodes(MapData *map, const char *path, int **oldvertextable, unsigned numoldverts)
 {
 	char magic[4] = {0,0,0,0};
 	uint8_t md5[16];
 	uint8_t md5map[16];
 	uint32_t numlin;
 	TArray<uint32_t> verts;
+	TArray<uint32_t> vertextable;
+	bool hastable = false;
 
-	FString path = CreateCacheName(map, false);
 	FileReader fr;
 
 	if (!fr.OpenFile(path)) return false;
@@ -1170,6 +1229,18 @@ bool MapLoader::CheckCachedNodes(MapData *map)
 	if (fr.Read(verts.Data(), 8 * numlin) != 8 * numlin) return false;
 
 	if (fr.Read(magic, 4) != 4) return false;
+	if (!memcmp(magic, "OVTX", 4))
+	{
+		uint32_t count;
+		if (fr.Read(&count, 4) != 4) return false;
+		count = LittleLong(count);
+		if (count != 0 && count != numoldverts && oldvertextable != nullptr) return false;
+		vertextable.Resize(count);
+		if (fr.Read(vertextable.Data(), 4 * count) != 4 * count) return false;
+		hastable = true;
+		if (fr.Read(magic, 4) != 4) return false;
+	}
+	if (oldvertextable != nullptr && !hastable) return false;
 	if (memcmp(magic, "ZGL2", 4) && memcmp(magic, "ZGL3", 4))  return false;
 
 
@@ -1193,6 +1264,19 @@ bool MapLoader::CheckCachedNodes(MapData *map)
 		line.v1 = &Level->vertexes[LittleLong(verts[i*2])];
 		line.v2 = &Level->vertexes[LittleLong(verts[i*2+1])];
 	}
+
+	if (oldvertextable != nullptr)
+	{
+		*oldvertextable = nullptr;
+		if (vertextable.Size() > 0)
+		{
+			*oldvertextable = new int[vertextable.Size()];
+			for (unsigned i = 0; i < vertextable.Size(); i++)
+			{
+				(*oldvertextable)[i] = int(LittleLong(vertextable[i]));
+			}
+		}
+	}
 	return true;
 }
 
@@ -82,6 +82,7 @@
 #include "vm.h"
 #include "texturemanager.h"
 #include "hw_vertexbuilder.h"
+#include "hwrenderer/scene/hw_occlusion.h"
 
 enum
 {
@@ -2637,8 +2638,10 @@ void MapLoader::LoadBlockMap (MapData * map)
 
 	// clear out mobj chains
 	count = Level->blockmap.bmapwidth*Level->blockmap.bmapheight;
-	Level->blockmap.blocklinks = new FBlockNode *[count];
-	memset (Level->blockmap.blocklinks, 0, count*sizeof(*Level->blockmap.blocklinks));
+	Level->blockmap.blockthings = new TArray<FBlockThing>[count];
+	Level->blockmap.blockdirty.Resize(count);
+	memset(Level->blockmap.blockdirty.Data(), 0, count * sizeof(bool));
+	Level->blockmap.dirtyblocks.Clear();
 	Level->blockmap.blockmap = Level->blockmap.blockmaplump+4;
 }
 
@@ -2843,6 +2846,90 @@ void MapLoader::LoadReject (MapData * map, bool junk)
 	}
 }
 
+//===========================================================================
+//
+// Groups the sectors into zones between which no line of sight can exist,
+// because there is no gap in the map's geometry that connects them.
+// Most maps do not come with a usable REJECT lump, so this is the only
+// way to trivially reject sight checks between completely disconnected
+// parts of a map, like monster closets that can only be left through
+// teleporters.
+//
+// To be safe with broken maps the [GL] subsectors' adjacency is used
+// in addition to the lines, so that gaps in the sector boundaries which
+// are covered by minisegs do not separate anything. This requires the
+// playsim to use the same nodes as the renderer, and without portals
+// because sight can pass through those.
+//
+//===========================================================================
+
+static int FindZone(TArray<int> &zones, int i)
+{
+	while (zones[i] != i)
+	{
+		zones[i] = zones[zones[i]];
+		i = zones[i];
+	}
+	return i;
+}
+
+static void MergeZones(TArray<int> &zones, int a, int b)
+{
+	a = FindZone(zones, a);
+	b = FindZone(zones, b);
+	// always link to the lower index so that the result does not depend on the processing order.
+	if (a < b) zones[b] = a;
+	else if (b < a) zones[a] = b;
+}
+
+void MapLoader::BuildSightZones()
+{
+	Level->sightzones.Clear();
+	if (Level->gamenodes.Size() > 0 || Level->Displacements.size > 1 || Level->subsectors.Size() == 0) return;
+
+	unsigned numsectors = Level->sectors.Size();
+	TArray<int> zones(numsectors, true);
+	for (unsigned i = 0; i < numsectors; i++) zones[i] = i;
+
+	for (auto &line : Level->lines)
+	{
+		if (line.frontsector && line.backsector) MergeZones(zones, line.frontsector->Index(), line.backsector->Index());
+	}
+
+	// Sectors touching the same vertex are merged as well, in case a trace passes right through the vertex.
+	TArray<int> vertexzone(Level->vertexes.Size(), true);
+	for (auto &v : vertexzone) v = -1;
+	for (auto &seg : Level->segs)
+	{
+		if (seg.Subsector == nullptr || seg.Subsector->sector == nullptr) continue;
+		int zone = seg.Subsector->sector->Index();
+
+		if (seg.PartnerSeg != nullptr && seg.PartnerSeg->Subsector != nullptr && seg.PartnerSeg->Subsector->sector != nullptr)
+		{
+			MergeZones(zones, zone, seg.PartnerSeg->Subsector->sector->Index());
+		}
+		for (auto v : { seg.v1, seg.v2 })
+		{
+			auto &vz = vertexzone[v->Index()];
+			if (vz == -1) vz = zone;
+			else MergeZones(zones, vz, zone);
+		}
+	}
+
+	int numzones = 0;
+	for (unsigned i = 0; i < numsectors; i++)
+	{
+		zones[i] = FindZone(zones, i);
+		if (zones[i] == (int)i) numzones++;
+	}
+	// With only one zone the check would be pointless.
+	if (numzones > 1)
+	{
+		Level->sightzones = std::move(zones);
+		DPrintf(DMSG_NOTIFY, "%d sight zones found\n", numzones);
+	}
+}
+
 //===========================================================================
 //
 //
@@ -3104,6 +3191,8 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	uint64_t startTime = 0, endTime = 0;
 
 	bool BuildGLNodes;
+	bool CachedNodes = false;
+	unsigned numoldverts = 0;
 
 	// The node builder needs these indices.
 	for (unsigned int i = 0; i < Level->sides.Size(); ++i)
@@ -3120,23 +3209,36 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 			line.AdjustLine();
 		}
 
-		startTime = I_msTime();
-		TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
-		GetPolySpots(map, polyspots, anchors);
-		FNodeBuilder::FLevel leveldata =
+		// A rebuild that was not explicitly requested needs to be done the same way each time the map
+		// gets loaded, so the nodes from the last time can be used, as long as they were cached along with the vertex remapping.
+		numoldverts = Level->vertexes.Size();
+		int *cachedvertextable = nullptr;
+		if (!gennodes && CheckCachedNodes(map, &cachedvertextable, numoldverts))
+		{
+			DPrintf(DMSG_NOTIFY, "Using cached nodes instead of rebuilding them\n");
+			oldvertextable = cachedvertextable;
+			CachedNodes = true;
+		}
+		else
 		{
-			&Level->vertexes[0], (int)Level->vertexes.Size(),
-			&Level->sides[0], (int)Level->sides.Size(),
-			&Level->lines[0], (int)Level->lines.Size(),
-			0, 0, 0, 0
-		};
-		leveldata.FindMapBounds();
+			startTime = I_msTime();
+			TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
+			GetPolySpots(map, polyspots, anchors);
+			FNodeBuilder::FLevel leveldata =
+			{
+				&Level->vertexes[0], (int)Level->vertexes.Size(),
+				&Level->sides[0], (int)Level->sides.Size(),
+				&Level->lines[0], (int)Level->lines.Size(),
+				0, 0, 0, 0
+			};
+			leveldata.FindMapBounds();
 
-		FNodeBuilder builder(leveldata, polyspots, anchors, BuildGLNodes);
-		builder.Extract(*Level);
-		endTime = I_msTime();
-		DPrintf(DMSG_NOTIFY, "BSP generation took %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, Level->segs.Size());
-		oldvertextable = builder.GetOldVertexTable();
+			FNodeBuilder builder(leveldata, polyspots, anchors, BuildGLNodes);
+			builder.Extract(*Level);
+			endTime = I_msTime();
+			DPrintf(DMSG_NOTIFY, "BSP generation took %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, Level->segs.Size());
+			oldvertextable = builder.GetOldVertexTable();
+		}
 		reloop = true;
 	}
 	else
@@ -3166,7 +3268,10 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	// If the original nodes being loaded are not GL nodes they will be kept around for
 	// use in P_PointInSubsector to avoid problems with maps that depend on the specific
 	// nodes they were built with (P:AR E1M3 is a good example for a map where this is the case.)
-	reloop |= CheckNodes(map, BuildGLNodes, (uint32_t)(endTime - startTime));
+	if (!CachedNodes)
+	{
+		reloop |= CheckNodes(map, BuildGLNodes, (uint32_t)(endTime - startTime), oldvertextable, numoldverts);
+	}
 	
 	// set the head node for gameplay purposes. If the separate gamenodes array is not empty, use that, otherwise use the render nodes.
 	Level->headgamenode = Level->gamenodes.Size() > 0 ? &Level->gamenodes[Level->gamenodes.Size() - 1] : Level->nodes.Size() ? &Level->nodes[Level->nodes.Size() - 1] : nullptr;
@@ -3235,6 +3340,8 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	InitRenderInfo();				// create hardware independent renderer resources for the level. This must be done BEFORE the PolyObj Spawn!!!
 	Level->ClearDynamic3DFloorData();	// CreateVBO must be run on the plain 3D floor data.
 	CreateVBO(screen->mVertexData, Level->sectors);
+	InitWallVertexCache(screen->mVertexData, Level->segs.Size());
+	OcclusionCuller.ResetLevel();
 
 	for (auto &sec : Level->sectors)
 	{
@@ -3243,6 +3350,7 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 
 	SWRenderer->SetColormap(Level);	//The SW renderer needs to do some special setup for the level's default colormap.
 	InitPortalGroups(Level);
+	BuildSightZones();
 	P_InitHealthGroups(Level);
 
 	if (reloop) LoopSidedefs(false);
@@ -165,7 +165,7 @@ private:
 	bool LoadGLSubsectors(FileReader &lump);
 	bool LoadNodes(FileReader &lump);
 	bool DoLoadGLNodes(FileReader * lumps);
-	void CreateCachedNodes(MapData *map);
+	void CreateCachedNodes(MapData *map, const int *oldvertextable = nullptr, unsigned numoldverts = 0);
 
 	// Render info
 	void PrepareSectorData();
@@ -278,8 +278,9 @@ public:
 	template<class subsectortype, class segtype> bool LoadSubsectors(MapData * map);
 	template<class nodetype, class subsectortype> bool LoadNodes(MapData * map);
 	bool LoadGLNodes(MapData * map);
-	bool CheckCachedNodes(MapData *map);
-	bool CheckNodes(MapData * map, bool rebuilt, int buildtime);
+	bool CheckCachedNodes(MapData *map, int **oldvertextable = nullptr, unsigned numoldverts = 0);
+	bool ReadCachedNodes(MapData *map, const char *path, int **oldvertextable = nullptr, unsigned numoldverts = 0);
+	bool CheckNodes(MapData * map, bool rebuilt, int buildtime, const int *oldvertextable = nullptr, unsigned numoldverts = 0);
 	bool CheckForGLNodes();
 
 	void LoadSectors(MapData *map, FMissingTextureTracker &missingtex);
@@ -294,6 +295,7 @@ public:
 	void LoadSideDefs2(MapData *map, FMissingTextureTracker &missingtex);
 	void LoadBlockMap(MapData * map);
 	void LoadReject(MapData * map, bool junk);
+	void BuildSightZones();
 	void LoadBehavior(MapData * map);
 	void GetPolySpots(MapData * map, TArray<FNodeBuilder::FPolyStart> &spots, TArray<FNodeBuilder::FPolyStart> &anchors);
 	void GroupLines(bool buildmap);
@@ -172,6 +172,27 @@ void UDMFParserBase::Skip()
 	}
 }
 
+//===========================================================================
+//
+// Looks up key names through a small cache. Only exact matches hit,
+// different spellings of the same key just use different slots.
+//
+//===========================================================================
+
+FName UDMFParserBase::InternKey(const char *text, int len)
+{
+	unsigned hash = len;
+	for (int i = 0; i < len; i++) hash = hash * 31 + (uint8_t)text[i];
+
+	auto &entry = KeyCache[hash % KeyCacheSize];
+	if (entry.Key == NAME_None || (int)entry.Text.Len() != len || memcmp(entry.Text.GetChars(), text, len))
+	{
+		entry.Text = FString(text, len);
+		entry.Key = text;
+	}
+	return entry.Key;
+}
+
 //===========================================================================
 //
 // Parses a 'key = value' line of the map
@@ -181,7 +202,7 @@ void UDMFParserBase::Skip()
 FName UDMFParserBase::ParseKey(bool checkblock, bool *isblock)
 {
 	sc.MustGetString();
-	FName key = sc.String;
+	FName key = InternKey(sc.String, sc.StringLen);
 	if (checkblock)
 	{
 		if (sc.CheckToken('{'))
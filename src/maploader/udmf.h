@@ -13,6 +13,17 @@ protected:
 	FString parsedString;
 	bool BadCoordinates = false;
 
+	// The same few dozen key names get repeated for every single block, so remember the names
+	// that were last seen per hash slot instead of going through the global name table each time.
+	enum { KeyCacheSize = 256 };
+	struct FKeyCacheEntry
+	{
+		FString Text;
+		FName Key = NAME_None;
+	};
+	FKeyCacheEntry KeyCache[KeyCacheSize];
+
+	FName InternKey(const char *text, int len);
 	void Skip();
 	FName ParseKey(bool checkblock = false, bool *isblock = NULL);
 	int CheckInt(FName key);
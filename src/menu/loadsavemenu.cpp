@@ -131,16 +131,30 @@ int FSavegameManager::InsertSaveNode(FSaveGameNode *node)
 	}
 	else
 	{	// Add node at top of list
-		unsigned int i;
-		for (i = 0; i < SaveGames.Size(); i++)
+		// The current saves are kept sorted by title ahead of the old ones, so the
+		// spot can be found with a binary search. This gets called for every file
+		// in the save directory when the menu is first opened.
+		// The new save placeholder is not part of that order and only ever at the top.
+		unsigned int lo = 0, hi = SaveGames.Size();
+		if (SaveGames[0]->bNoDelete)
 		{
-			if (SaveGames[i]->bOldVersion || node->SaveTitle.CompareNoCase(SaveGames[i]->SaveTitle) <= 0)
+			if (node->SaveTitle.CompareNoCase(SaveGames[0]->SaveTitle) <= 0) hi = 0;
+			else lo = 1;
+		}
+		while (lo < hi)
+		{
+			unsigned int mid = (lo + hi) / 2;
+			if (SaveGames[mid]->bOldVersion || node->SaveTitle.CompareNoCase(SaveGames[mid]->SaveTitle) <= 0)
 			{
-				break;
+				hi = mid;
+			}
+			else
+			{
+				lo = mid + 1;
 			}
 		}
-		SaveGames.Insert(i, node);
-		return i;
+		SaveGames.Insert(lo, node);
+		return lo;
 	}
 }
 
@@ -1069,7 +1069,7 @@ void FLevelLocals::Serialize(FSerializer &arc, bool hubload)
 //
 //==========================================================================
 
-void FLevelLocals::SnapshotLevel()
+void FLevelLocals::SnapshotLevel(bool deferred)
 {
 	info->Snapshot.Clean();
 
@@ -1081,7 +1081,17 @@ void FLevelLocals::SnapshotLevel()
 		{
 			SaveVersion = SAVEVER;
 			Serialize(arc, false);
-			info->Snapshot = arc.GetCompressedOutput();
+			if (deferred)
+			{
+				// The compression is done in the background.
+				unsigned len;
+				const char *text = arc.GetOutput(&len);
+				G_StoreSnapshot(info, text, len);
+			}
+			else
+			{
+				info->Snapshot = arc.GetCompressedOutput();
+			}
 		}
 	}
 }
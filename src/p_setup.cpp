@@ -80,6 +80,7 @@
 #include "texturemanager.h"
 #include "p_lnspec.h"
 #include "d_main.h"
+#include "memstats.h"
 
 extern AActor *SpawnMapThing (int index, FMapThing *mthing, int position);
 
@@ -251,26 +252,50 @@ void FLevelLocals::ClearPortals()
 	sectorPortals[1].mType = PORTS_SKYVIEWPOINT;
 	sectorPortals[1].mFlags = PORTSF_SKYFLATONLY;
 
-	// also clear the render data
+	// also clear the render data. The coverage lists and the groups themselves were allocated from LevelArena.
 	for (auto &sub : subsectors)
 	{
 		for (int j = 0; j < 2; j++)
 		{
-			if (sub.portalcoverage[j].subsectors != nullptr)
-			{
-				delete[] sub.portalcoverage[j].subsectors;
-				sub.portalcoverage[j].subsectors = nullptr;
-			}
+			sub.portalcoverage[j].subsectors = nullptr;
 		}
 	}
-	for (unsigned i = 0; i < portalGroups.Size(); i++)
-	{
-		delete portalGroups[i];
-	}
 	portalGroups.Clear();
 	linePortalSpans.Clear();
 }
 
+//==========================================================================
+//
+// Only the main map data gets counted, not what it points to.
+//
+//==========================================================================
+
+template<class T> static size_t ArrayBytes(const TArray<T> &array)
+{
+	return array.Size() * sizeof(T);
+}
+
+static size_t LevelMemoryUsage()
+{
+	size_t total = 0;
+	for (auto Level : AllLevels())
+	{
+		total += ArrayBytes(Level->vertexes) + ArrayBytes(Level->sectors) + ArrayBytes(Level->lines) + ArrayBytes(Level->sides);
+		total += ArrayBytes(Level->segs) + ArrayBytes(Level->subsectors) + ArrayBytes(Level->nodes);
+		total += ArrayBytes(Level->gamesubsectors) + ArrayBytes(Level->gamenodes);
+		total += ArrayBytes(Level->linebuffer) + ArrayBytes(Level->subsectorbuffer) + ArrayBytes(Level->segbuffer);
+		total += ArrayBytes(Level->rejectmatrix) + ArrayBytes(Level->sightzones) + ArrayBytes(Level->Zones) + ArrayBytes(Level->Polyobjects);
+		total += ArrayBytes(Level->sectorPortals) + ArrayBytes(Level->linePortals) + ArrayBytes(Level->linePortalSpans);
+		total += ArrayBytes(Level->sections.allLines) + ArrayBytes(Level->sections.allSections) + ArrayBytes(Level->sections.allSides);
+		total += ArrayBytes(Level->sections.allSubsectors) + ArrayBytes(Level->sections.allIndices);
+		total += ArrayBytes(Level->loadsectors) + ArrayBytes(Level->loadlines) + ArrayBytes(Level->loadsides);
+		total += size_t(Level->blockmap.bmapwidth) * Level->blockmap.bmapheight * (sizeof(int) + sizeof(TArray<FBlockThing>));
+	}
+	return total;
+}
+
+static FMemReporter LevelMemory(MEM_Level, LevelMemoryUsage);
+
 //==========================================================================
 //
 //
@@ -323,7 +348,10 @@ void FLevelLocals::ClearLevelData()
 	ACSThinker = nullptr;
 	FraggleScriptThinker = nullptr;
 	CorpseQueue.Clear();
+	LightUpdates.Clear();
 	canvasTextureInfo.EmptyList();
+	navgraph.Clear();
+	soundgraph.Clear();
 	sections.Clear();
 	segs.Clear();
 	sectors.Clear();
@@ -341,21 +369,12 @@ void FLevelLocals::ClearLevelData()
 	subsectors.Clear();
 	gamesubsectors.Reset();
 	rejectmatrix.Clear();
+	sightzones.Clear();
 	Zones.Clear();
 	blockmap.Clear();
 	Polyobjects.Clear();
 
-	for (auto &pb : PolyBlockMap)
-	{
-		polyblock_t *link = pb;
-		while (link != nullptr)
-		{
-			polyblock_t *next = link->next;
-			delete link;
-			link = next;
-		}
-	}
-	PolyBlockMap.Reset();
+	PolyBlockMap.Reset();	// the links were allocated from LevelArena.
 
 	deathmatchstarts.Clear();
 	AllPlayerStarts.Clear();
@@ -368,6 +387,7 @@ void FLevelLocals::ClearLevelData()
 	aabbTree = nullptr;
 	if (screen)
 		screen->SetAABBTree(nullptr);
+	LevelArena.FreeAll();
 }
 
 //==========================================================================
@@ -543,7 +563,7 @@ void P_SetupLevel(FLevelLocals *Level, int position, bool newGame)
 	// preload graphics and sounds
 	if (precache)
 	{
-		PrecacheLevel(Level);
+		if (!headless) PrecacheLevel(Level);
 		S_PrecacheLevel(Level);
 	}
 
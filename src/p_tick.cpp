@@ -38,6 +38,8 @@
 #include "events.h"
 #include "actorinlines.h"
 #include "g_game.h"
+#include "g_benchmark.h"
+#include "zonetrace.h"
 
 extern gamestate_t wipegamestate;
 extern uint8_t globalfreeze, globalchangefreeze;
@@ -71,11 +73,38 @@ bool P_CheckTickerPaused ()
 	return false;
 }
 
+//==========================================================================
+//
+// P_UpdateDynamicLights
+//
+// Recreates the light attachments of all actors that requested it since
+// the last call. Destroyed actors leave a null slot behind.
+//
+//==========================================================================
+
+static void P_UpdateDynamicLights(FLevelLocals *Level)
+{
+	auto &queue = Level->LightUpdates;
+	for (unsigned i = 0; i < queue.Size(); i++)
+	{
+		AActor *ac = queue[i];
+		if (ac == nullptr) continue;
+		ac->LightUpdateIndex = -1;
+		if (ac->flags8 & MF8_RECREATELIGHTS)
+		{
+			ac->flags8 &= ~MF8_RECREATELIGHTS;
+			ac->SetDynamicLights();
+		}
+	}
+	queue.Clear();
+}
+
 //
 // P_Ticker
 //
 void P_Ticker (void)
 {
+	TRACE_ZONE("P_Ticker");
 	int i;
 
 	for (auto Level : AllLevels())
@@ -92,22 +121,12 @@ void P_Ticker (void)
 	}
 
 	// run the tic
-	if (paused || P_CheckTickerPaused())
+	if (paused || P_CheckTickerPaused() || BM_FlythroughActive())
 	{
 		// This must run even when the game is paused to catch changes from netevents before the frame is rendered.
 		for (auto Level : AllLevels())
 		{
-			auto it = Level->GetThinkerIterator<AActor>();
-			AActor* ac;
-
-			while ((ac = it.Next()))
-			{
-				if (ac->flags8 & MF8_RECREATELIGHTS)
-				{
-					ac->flags8 &= ~MF8_RECREATELIGHTS;
-					ac->SetDynamicLights();
-				}
-			}
+			P_UpdateDynamicLights(Level);
 		}
 		return;
 	}
@@ -159,6 +178,9 @@ void P_Ticker (void)
 			ac->ClearInterpolation();
 		}
 
+		// Nothing may hold a position in the blockmap's thing arrays here.
+		Level->blockmap.Compact();
+
 		P_ThinkParticles(Level);	// [RH] make the particles think
 
 		for (i = 0; i < MAXPLAYERS; i++)
@@ -178,13 +200,9 @@ void P_Ticker (void)
 		it = Level->GetThinkerIterator<AActor>();
 
 		// Set dynamic lights at the end of the tick, so that this catches all changes being made through the last frame.
+		P_UpdateDynamicLights(Level);
 		while ((ac = it.Next()))
 		{
-			if (ac->flags8 & MF8_RECREATELIGHTS)
-			{
-				ac->flags8 &= ~MF8_RECREATELIGHTS;
-				ac->SetDynamicLights();
-			}
 			// This was merged from P_RunEffects to eliminate the costly duplicate ThinkerIterator loop.
 			if ((ac->effects || ac->fountaincolor) && !Level->isFrozen())
 			{
@@ -367,8 +367,6 @@ void FDynamicLight::Tick()
 //==========================================================================
 void FDynamicLight::UpdateLocation()
 {
-	double oldx= X();
-	double oldy= Y();
 	float oldradius = radius;
 
 	if (IsActive())
@@ -404,7 +402,8 @@ void FDynamicLight::UpdateLocation()
 		radius = intensity * 2.0f;
 		if (radius < m_currentRadius * 2) radius = m_currentRadius * 2;
 
-		if (X() != oldx || Y() != oldy || radius != oldradius)
+		// Small moves that cannot change the outcome of any of the tests the last linking made do not need a relink.
+		if (radius != oldradius || (Pos.XY() - m_linkPos).LengthSquared() > m_linkSlack * m_linkSlack)
 		{
 			//Update the light lists
 			LinkLight();
@@ -541,6 +540,16 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 	section->validcount = dl_validcount;
 
 	bool hitonesidedback = false;
+	double sqrtradius = sqrt(radius);
+	double slack = DBL_MAX;
+
+	// Records how far the light is from flipping the outcome of a distance test.
+	auto trackSlack = [&](double distsq)
+	{
+		double d = fabs(sqrt(distsq) - sqrtradius);
+		if (d < slack) slack = d;
+	};
+
 	for (unsigned i = 0; i < collected_ss.Size(); i++)
 	{
 		auto pos = collected_ss[i].pos;
@@ -555,7 +564,10 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 			if (linedef && linedef->validcount != ::validcount)
 			{
 				// light is in front of the seg
-				if ((pos.Y - v1->fY()) * (v2->fX() - v1->fX()) + (v1->fX() - pos.X) * (v2->fY() - v1->fY()) <= 0)
+				double side = (pos.Y - v1->fY()) * (v2->fX() - v1->fX()) + (v1->fX() - pos.X) * (v2->fY() - v1->fY());
+				double d = fabs(side) / (v2->fPos() - v1->fPos()).Length();
+				if (d < slack) slack = d;
+				if (side <= 0)
 				{
 					linedef->validcount = ::validcount;
 					touching_sides = AddLightNode(&sidedef->lighthead, sidedef, this, touching_sides);
@@ -589,7 +601,14 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 		{
 			// check distance from x/y to seg and if within radius add this seg and, if present the opposing subsector (lather/rinse/repeat)
 			// If out of range we do not need to bother with this seg.
-			if (DistToSeg(pos, segment.start, segment.end) <= radius)
+			double distsq = DistToSeg(pos, segment.start, segment.end);
+			if (i == 0)
+			{
+				// Leaving the starting section would change the order everything gets collected in.
+				slack = MIN(slack, sqrt(distsq));
+			}
+			trackSlack(distsq);
+			if (distsq <= radius)
 			{
 				auto sidedef = segment.sidedef;
 				if (sidedef)
@@ -612,7 +631,9 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 		for (auto side : section->sides)
 		{
 			auto v1 = side->V1(), v2 = side->V2();
-			if (DistToSeg(pos, v1, v2) <= radius)
+			double distsq = DistToSeg(pos, v1, v2);
+			trackSlack(distsq);
+			if (distsq <= radius)
 			{
 				processSide(side, v1, v2);
 			}
@@ -650,6 +671,8 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 		}
 	}
 	shadowmapped = hitonesidedback && !DontShadowmap();
+	// Leave some room for rounding errors.
+	m_linkSlack = slack == DBL_MAX ? 0 : MAX(0., slack - 1. / 256.);
 }
 
 //==========================================================================
@@ -676,6 +699,8 @@ void FDynamicLight::LinkLight()
 		node = node->nextTarget;
 	}
 
+	m_linkPos = Pos.XY();
+	m_linkSlack = 0;
 	if (radius>0)
 	{
 		// passing in radius*radius allows us to do a distance check without any calls to sqrt
@@ -792,6 +817,23 @@ void AActor::SetDynamicLights()
 	}
 }
 
+//==========================================================================
+//
+// Flags the actor's lights for recreation at the end of the tic and queues
+// it on its level so that P_Ticker does not have to scan every actor for it.
+//
+//==========================================================================
+
+void AActor::RequestLightUpdate()
+{
+	flags8 |= MF8_RECREATELIGHTS;
+	if (Level == nullptr) return;
+
+	auto &queue = Level->LightUpdates;
+	if ((unsigned)LightUpdateIndex < queue.Size() && queue[LightUpdateIndex] == this) return;
+	LightUpdateIndex = queue.Push(this);
+}
+
 //==========================================================================
 //
 //
@@ -848,7 +890,7 @@ int AttachLightDef(AActor *self, int _lightid, int _lightname)
 	{
 		auto userlight = self->UserLights[FindUserLight(self, lightid, true)];
 		userlight->CopyFrom(*LightDefaults[lightdef]);
-		self->flags8 |= MF8_RECREATELIGHTS;
+		self->RequestLightUpdate();
 		return 1;
 	}
 	return 0;
@@ -892,7 +934,7 @@ int AttachLightDirect(AActor *self, int _lightid, int type, int color, int radiu
 	{
 		userlight->UnsetSpotPitch();
 	}
-	self->flags8 |= MF8_RECREATELIGHTS;
+	self->RequestLightUpdate();
 	return 1;
 }
 
@@ -929,7 +971,7 @@ int RemoveLight(AActor *self, int _lightid)
 	{
 		delete self->UserLights[userlight];
 		self->UserLights.Delete(userlight);
-		self->flags8 |= MF8_RECREATELIGHTS;
+		self->RequestLightUpdate();
 		return 1;
 	}
 	return 0;
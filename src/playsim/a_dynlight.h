@@ -164,7 +164,7 @@ protected:
 class FInternalLightAssociation
 {
 public:
-	FInternalLightAssociation(FLightAssociation * asso);
+	FInternalLightAssociation(FLightAssociation * asso, const TMap<FName, FLightDefaults *> &lightsByName, const TMap<uint32_t, int> &spritesByName);
 	int Sprite() const { return m_sprite; }
 	int Frame() const { return m_frame; }
 	const FLightDefaults *Light() const { return m_AssocLight; }
@@ -265,9 +265,17 @@ public:
 	FLightNode * touching_sector;
 	float radius;			// The maximum size the light can be with its current settings.
 	float m_currentRadius;	// The current light size.
+	DVector2 m_linkPos;		// where the light was last linked
+	double m_linkSlack;		// how far the light can move from m_linkPos before the links can change
 	int m_tickCount;
 	int m_lastUpdate;
 	int mShadowmapIndex;
+
+	// Shader data for the light's own portal group, set up by the hardware renderer for each viewpoint.
+	float mRenderData[16];
+	int mRenderDataArray;
+	unsigned mRenderDataFrame;
+
 	bool m_active;
 	bool visibletoplayer;
 	bool shadowmapped;
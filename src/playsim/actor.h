@@ -642,6 +642,9 @@ struct FDropItem
 
 const double MinVel = EQUAL_EPSILON;
 
+// Number of tics an idle monster must spend at rest before it falls asleep (sv_actorsleep)
+const int ACTORSLEEP_DELAY = 4;
+
 // Map Object definition.
 class AActor : public DThinker
 {
@@ -687,6 +690,7 @@ public:
 	bool CheckMeleeRange();
 
 	bool CheckNoDelay();
+	bool CanSleep();
 
 	virtual void BeginPlay();			// Called immediately after the actor is created
 	void CallBeginPlay();
@@ -952,12 +956,32 @@ public:
 
 	void AttachLight(unsigned int count, const FLightDefaults *lightdef);
 	void SetDynamicLights();
+	void RequestLightUpdate();
 
 // info for drawing
 // NOTE: The first member variable *must* be snext.
 	AActor			*snext, **sprev;	// links in sector (if needed)
 	DVector3		__Pos;		// double underscores so that it won't get used by accident. Access to this should be exclusively through the designated access functions.
 
+	// The following members are the working set of the movement and collision code
+	// (P_XYMovement, P_ZMovement, P_CheckPosition, blockmap iteration) and are kept
+	// next to the position so that these need as few cache lines per actor as possible.
+	DVector3		Vel;
+	double			radius, Height;		// for movement checking
+	double			floorz, ceilingz;	// closest together of contacted secs
+	double			dropoffz;		// killough 11/98: the lowest floor over all contacted Sectors.
+	ActorFlags		flags;
+	ActorFlags2		flags2;			// Heretic flags
+	ActorFlags3		flags3;			// [RH] Hexen/Heretic actor-dependant behavior made flaggable
+	ActorFlags4		flags4;			// [RH] Even more flags!
+	ActorFlags5		flags5;			// OMG! We need another one.
+	ActorFlags6		flags6;			// Shit! Where did all the flags go?
+	ActorFlags7		flags7;			// WHO WANTS TO BET ON 8!?
+	ActorFlags8		flags8;			// I see your 8, and raise you a bet for 9.
+	FBlockNode		*BlockNode;			// links in blocks (if needed)
+	struct sector_t	*Sector;
+	subsector_t *		subsector;
+
 	DAngle			SpriteAngle;
 	DAngle			SpriteRotation;
 	DRotator		Angles;
@@ -977,16 +1001,7 @@ public:
 	uint32_t			RenderHidden;		// current renderer must *not* have any of these features
 
 	ActorRenderFlags	renderflags;		// Different rendering flags
-	ActorFlags		flags;
-	ActorFlags2		flags2;			// Heretic flags
-	ActorFlags3		flags3;			// [RH] Hexen/Heretic actor-dependant behavior made flaggable
-	ActorFlags4		flags4;			// [RH] Even more flags!
-	ActorFlags5		flags5;			// OMG! We need another one.
-	ActorFlags6		flags6;			// Shit! Where did all the flags go?
-	ActorFlags7		flags7;			// WHO WANTS TO BET ON 8!?
-	ActorFlags8		flags8;			// I see your 8, and raise you a bet for 9.
 	double			Floorclip;		// value to use for floor clipping
-	double			radius, Height;		// for movement checking
 
 	DAngle			VisibleStartAngle;
 	DAngle			VisibleStartPitch;
@@ -994,17 +1009,11 @@ public:
 	DAngle			VisibleEndPitch;
 
 	DVector3		OldRenderPos;
-	DVector3		Vel;
 	double			Speed;
 	double			FloatSpeed;
 
 // interaction info
-	FBlockNode		*BlockNode;			// links in blocks (if needed)
-	struct sector_t	*Sector;
-	subsector_t *		subsector;
 	FSection *			section;
-	double			floorz, ceilingz;	// closest together of contacted secs
-	double			dropoffz;		// killough 11/98: the lowest floor over all contacted Sectors.
 
 	struct sector_t	*floorsector;
 	FTextureID		floorpic;			// contacted sec floorpic
@@ -1023,6 +1032,7 @@ public:
 	int				WoundHealth;		// Health needed to enter wound state
 
 	int32_t			tics;				// state tic counter
+	int32_t			SleepCount;			// tics spent at rest, the actor sleeps once it reaches ACTORSLEEP_DELAY (sv_actorsleep)
 	FState			*state;
 	//VMFunction		*Damage;			// For missiles and monster railgun
 	int				DamageVal;
@@ -1182,6 +1192,7 @@ public:
 	DRotator PrevAngles;
 	int PrevPortalGroup;
 	TArray<FDynamicLight *> AttachedLights;
+	int LightUpdateIndex;		// slot in Level->LightUpdates, only valid while that slot points back here
 	TDeletingArray<FLightDefaults *> UserLights;
 
 	// When was this actor spawned?
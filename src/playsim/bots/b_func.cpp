@@ -149,14 +149,13 @@ bool DBot::Reachable (AActor *rtarget)
 //in doom is 90 degrees infront.
 bool DBot::Check_LOS (AActor *to, DAngle vangle)
 {
-	if (!P_CheckSight (player->mo, to, SF_SEEPASTBLOCKEVERYTHING))
-		return false; // out of sight
-	if (vangle >= 360.)
-		return true;
+	// The view angle is far cheaper to check than the sight line, so it goes first.
 	if (vangle == 0)
 		return false; //Looker seems to be blind.
+	if (vangle < 360. && absangle(player->mo->AngleTo(to), player->mo->Angles.Yaw) > (vangle/2))
+		return false;
 
-	return absangle(player->mo->AngleTo(to), player->mo->Angles.Yaw) <= (vangle/2);
+	return P_CheckSight (player->mo, to, SF_SEEPASTBLOCKEVERYTHING);
 }
 
 //-------------------------------------
@@ -299,6 +298,10 @@ extern int BotWTG;
 
 void FCajunMaster::BotTick(AActor *mo)
 {
+	// Nothing else is of interest to the bots.
+	if (!(mo->flags3 & MF3_ISMONSTER) && !(mo->flags & (MF_SPECIAL | MF_MISSILE)))
+		return;
+
 	BotSupportCycles.Clock();
 	m_Thinking = true;
 	for (int i = 0; i < MAXPLAYERS; i++)
@@ -378,15 +381,13 @@ AActor *DBot::Choose_Mate ()
 			&& ((player->mo->health/2) <= client->mo->health || !deathmatch)
 			&& !Level->BotInfo.IsLeader(client)) //taken?
 		{
-			if (P_CheckSight (player->mo, client->mo, SF_IGNOREVISIBILITY))
-			{
-				test = client->mo->Distance2D(player->mo);
+			// Only someone closer than the current choice needs the sight check.
+			test = client->mo->Distance2D(player->mo);
 
-				if (test < closest_dist)
-				{
-					closest_dist = test;
-					target = client->mo;
-				}
+			if (test < closest_dist && P_CheckSight (player->mo, client->mo, SF_IGNOREVISIBILITY))
+			{
+				closest_dist = test;
+				target = client->mo;
 			}
 		}
 	}
@@ -441,22 +442,21 @@ AActor *DBot::Find_enemy ()
 			&& client->mo->health > 0
 			&& player->mo != client->mo)
 		{
-			if (Check_LOS (client->mo, vangle)) //Here's a strange one, when bot is standing still, the P_CheckSight within Check_LOS almost always returns false. tought it should be the same checksight as below but.. (below works) something must be fuckin wierd screded up. 
-			//if(P_CheckSight(player->mo, players[count].mo))
-			{
-				temp = client->mo->Distance2D(player->mo);
+			// The distance tests are cheap, so only do the line of sight check
+			// for someone who would actually become the new target.
+			temp = client->mo->Distance2D(player->mo);
 
-				//Too dark?
-				if (temp > DARK_DIST &&
-					client->mo->Sector->lightlevel < WHATS_DARK /*&&
-					player->Powers & PW_INFRARED*/)
-					continue;
+			//Too dark?
+			if (temp > DARK_DIST &&
+				client->mo->Sector->lightlevel < WHATS_DARK /*&&
+				player->Powers & PW_INFRARED*/)
+				continue;
 
-				if (temp < closest_dist)
-				{
-					closest_dist = temp;
-					target = client->mo;
-				}
+			if (temp < closest_dist && Check_LOS (client->mo, vangle)) //Here's a strange one, when bot is standing still, the P_CheckSight within Check_LOS almost always returns false. tought it should be the same checksight as below but.. (below works) something must be fuckin wierd screded up. 
+			//if(P_CheckSight(player->mo, players[count].mo))
+			{
+				closest_dist = temp;
+				target = client->mo;
 			}
 		}
 	}
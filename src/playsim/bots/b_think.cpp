@@ -54,6 +54,8 @@
 
 static FRandom pr_botmove ("BotMove");
 
+CVARD(Int, bot_thinkinterval, 1, CVAR_ARCHIVE | CVAR_SERVERINFO, "tics between a bot's choice of mate and enemy; the bots take turns when this is greater than 1")
+
 //This function is called each tic for each bot,
 //so this is what the bot does.
 void DBot::Think ()
@@ -67,14 +69,20 @@ void DBot::Think ()
 
 	if (player->mo->health > 0) //Still alive
 	{
-		if (teamplay || !deathmatch)
+		// Picking a mate and an enemy needs sight checks to everyone, so with
+		// many bots these can be spread out over several tics, with each bot
+		// getting its turn on a different one.
+		bool decide = bot_thinkinterval <= 1 || (Level->maptime + int(player - players)) % bot_thinkinterval == 0;
+
+		if (decide && (teamplay || !deathmatch))
 			mate = Choose_Mate ();
 
 		AActor *actor = player->mo;
 		DAngle oldyaw = actor->Angles.Yaw;
 		DAngle oldpitch = actor->Angles.Pitch;
 
-		Set_enemy ();
+		if (decide)
+			Set_enemy ();
 		ThinkForMove (cmd);
 		TurnToAng ();
 
@@ -42,6 +42,8 @@
 #include "v_text.h"
 #include "g_levellocals.h"
 #include "a_dynlight.h"
+#include "dsectoreffect.h"
+#include "ctpl.h"
 
 
 static int ThinkCount;
@@ -67,6 +69,15 @@ static TMap<FName, ProfileInfo> Profiles;
 static unsigned int profilethinkers, profilelimit;
 DThinker *NextToThink;
 
+// Number of threads for ticking independent sector effects. 0 ticks everything serially.
+CUSTOM_CVAR(Int, parallelthinkers, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+	else if (self > 16) self = 16;
+}
+
+static ctpl::thread_pool ThinkerPool;
+
 //==========================================================================
 //
 //
@@ -111,7 +122,15 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 		// Tick every thinker left from last time
 		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 		{
-			Thinkers[i].TickThinkers(nullptr);
+			// Only the lighting effects are known to be safe to run concurrently.
+			if (i == STAT_LIGHT && parallelthinkers > 1)
+			{
+				Thinkers[i].TickThinkersParallel(parallelthinkers);
+			}
+			else
+			{
+				Thinkers[i].TickThinkers(nullptr);
+			}
 		}
 
 		// Keep ticking the fresh thinkers until there are no new ones.
@@ -362,6 +381,29 @@ void FThinkerList::AddTail(DThinker *thinker)
 	GC::WriteBarrier(thinker, Sentinel);
 	GC::WriteBarrier(tail, thinker);
 	GC::WriteBarrier(Sentinel, thinker);
+	thinker->OwnerList = this;
+	CountClass(thinker->GetClass(), 1);
+}
+
+//==========================================================================
+//
+// A thinker counts for its own class and all its ancestors.
+//
+//==========================================================================
+
+void FThinkerList::CountClass(const PClass *type, int delta)
+{
+	for (; type != nullptr; type = type->ParentClass)
+	{
+		ClassCounts[type->TypeName] += delta;
+	}
+	Generation++;
+}
+
+int FThinkerList::CountOf(const PClass *type) const
+{
+	auto count = ClassCounts.CheckKey(type->TypeName);
+	return count != nullptr ? *count : 0;
 }
 
 //==========================================================================
@@ -483,8 +525,11 @@ bool FThinkerList::DoDestroyThinkers()
 			auto next = node->NextThinker;
 			toDelete.Push(node);
 			node->NextThinker = node->PrevThinker = nullptr;	// clear the links
+			node->OwnerList = nullptr;
 			node = next;
 		}
+		ClassCounts.Clear();
+		Generation++;
 		Sentinel->NextThinker = Sentinel->PrevThinker = nullptr;
 		Sentinel->Destroy();
 		Sentinel = nullptr;
@@ -576,6 +621,7 @@ int FThinkerList::TickThinkers(FThinkerList *dest)
 		if (!(node->ObjectFlags & OF_EuthanizeMe))
 		{ // Only tick thinkers not scheduled for destruction
 			ThinkCount++;
+			P_InvalidateSightCache();
 			node->CallTick();
 			node->ObjectFlags &= ~OF_JustSpawned;
 			GC::CheckGC();
@@ -585,6 +631,105 @@ int FThinkerList::TickThinkers(FThinkerList *dest)
 	return count;
 }
 
+//==========================================================================
+//
+// Ticks the thinkers in this list and runs those which only affect a single
+// sector in parallel on worker threads.
+//
+// Thinkers qualify if they are of a native class that reports an exclusive
+// sector. If more than one sector effect affects the same sector all of them
+// get ticked serially, in list order. And because the qualifying thinkers touch
+// nothing that the serial ones can see, the outcome is identical to ticking
+// the whole list serially so demos and netgames stay in sync.
+//
+// Must not be used on lists of fresh thinkers.
+//
+//==========================================================================
+
+int FThinkerList::TickThinkersParallel(int numworkers)
+{
+	enum { MIN_BATCH_SIZE = 256 };	// below this, dispatching the work costs more than it saves.
+
+	static TArray<DThinker *> batch;
+	static TArray<uint8_t> sectoruse;
+
+	DThinker *node = GetHead();
+	if (node == nullptr) return 0;
+
+	batch.Clear();
+	sectoruse.Clear();
+	for (; node != Sentinel; node = node->NextThinker)
+	{
+		// A scripted thinker may do anything to the others, including destroying them before they get a chance to tick.
+		if (node->GetClass()->bRuntimeClass) return TickThinkers(nullptr);
+
+		// Every sector effect counts, not just the qualifying ones, so that the order of all thinkers that affect a sector is preserved.
+		if (!node->IsKindOf(RUNTIME_CLASS(DSectorEffect))) continue;
+		auto sec = static_cast<DSectorEffect *>(node)->GetSector();
+		if (sec == nullptr) continue;
+
+		if (sectoruse.Size() == 0)
+		{
+			sectoruse.Resize(sec->Level->sectors.Size());
+			memset(sectoruse.Data(), 0, sectoruse.Size());
+		}
+		if (sectoruse[sec->Index()] < 2) sectoruse[sec->Index()]++;
+		if (!(node->ObjectFlags & (OF_JustSpawned | OF_EuthanizeMe)) && node->GetExclusiveSector() == sec) batch.Push(node);
+	}
+
+	// Remove everything that shares its sector with another thinker.
+	unsigned count = 0;
+	for (auto thinker : batch)
+	{
+		if (sectoruse[thinker->GetExclusiveSector()->Index()] == 1) batch[count++] = thinker;
+	}
+	batch.Clamp(count);
+
+	if (batch.Size() < MIN_BATCH_SIZE) return TickThinkers(nullptr);
+
+	if (ThinkerPool.size() != numworkers - 1) ThinkerPool.resize(numworkers - 1);
+
+	// The main thread works on the first slice itself.
+	TArray<std::future<void>> futures;
+	unsigned slice = (batch.Size() + numworkers - 1) / numworkers;
+	for (int i = 1; i < numworkers; i++)
+	{
+		unsigned start = i * slice, end = MIN(start + slice, batch.Size());
+		if (start >= end) break;
+		futures.Push(ThinkerPool.push([=](int) { for (unsigned j = start; j < end; j++) batch[j]->Tick(); }));
+	}
+	for (unsigned j = 0; j < slice && j < batch.Size(); j++) batch[j]->Tick();
+	for (auto &f : futures) f.wait();
+	ThinkCount += batch.Size();
+
+	// Everything else gets ticked serially in list order.
+	int ticked = 0;
+	for (node = GetHead(); node != Sentinel; node = NextToThink)
+	{
+		++ticked;
+		NextToThink = node->NextThinker;
+
+		auto sec = node->GetExclusiveSector();
+		if (sec != nullptr && sectoruse[sec->Index()] == 1 && !(node->ObjectFlags & (OF_JustSpawned | OF_EuthanizeMe)))
+		{
+			continue;	// already got ticked as part of the batch.
+		}
+
+		if (node->ObjectFlags & OF_JustSpawned)
+		{
+			node->CallPostBeginPlay();
+		}
+		if (!(node->ObjectFlags & OF_EuthanizeMe))
+		{ // Only tick thinkers not scheduled for destruction
+			ThinkCount++;
+			node->CallTick();
+			node->ObjectFlags &= ~OF_JustSpawned;
+			GC::CheckGC();
+		}
+	}
+	return ticked;
+}
+
 //==========================================================================
 //
 //
@@ -625,6 +770,7 @@ int FThinkerList::ProfileThinkers(FThinkerList *dest)
 
 			auto &prof = Profiles[node->GetClass()->TypeName];
 			prof.numcalls++;
+			P_InvalidateSightCache();
 			prof.timer.Clock();
 			node->CallTick();
 			prof.timer.Unclock();
@@ -690,6 +836,11 @@ void DThinker::Remove()
 	GC::WriteBarrier(next, prev);
 	NextThinker = nullptr;
 	PrevThinker = nullptr;
+	if (OwnerList != nullptr)
+	{
+		OwnerList->CountClass(GetClass(), -1);
+		OwnerList = nullptr;
+	}
 }
 
 //==========================================================================
@@ -925,6 +1076,8 @@ FThinkerIterator::FThinkerIterator (FLevelLocals *l, const PClass *type, int sta
 	else
 	{
 		m_CurrThinker = prev->NextThinker;
+		m_CurrList = nullptr;
+		m_Remaining = -1;
 		m_SearchingFresh = false;
 	}
 }
@@ -937,10 +1090,24 @@ FThinkerIterator::FThinkerIterator (FLevelLocals *l, const PClass *type, int sta
 
 void FThinkerIterator::Reinit ()
 {
-	m_CurrThinker = Level->Thinkers.Thinkers[m_Stat].GetHead();
+	StartList(Level->Thinkers.Thinkers[m_Stat]);
 	m_SearchingFresh = false;
 }
 
+//==========================================================================
+//
+// Lists without any thinkers of the searched type do not get walked at all.
+//
+//==========================================================================
+
+void FThinkerIterator::StartList(FThinkerList &list)
+{
+	m_CurrList = &list;
+	m_Generation = list.Generation;
+	m_Remaining = m_ParentType != nullptr ? list.CountOf(m_ParentType) : 0;
+	m_CurrThinker = m_Remaining > 0 ? list.GetHead() : nullptr;
+}
+
 //==========================================================================
 //
 //
@@ -961,15 +1128,15 @@ DThinker *FThinkerIterator::Next (bool exact)
 			{
 				while (!(m_CurrThinker->ObjectFlags & OF_Sentinel))
 				{
+					// All of them were found. Anything added since would have changed the generation.
+					if (m_Remaining == 0 && m_CurrList->Generation == m_Generation) break;
+
 					DThinker *thinker = m_CurrThinker;
 					m_CurrThinker = thinker->NextThinker;
-					if (exact)
-					{
-						if (thinker->IsA(m_ParentType)) return thinker;
-					}
-					else if (thinker->IsKindOf(m_ParentType))
+					if (thinker->IsKindOf(m_ParentType))
 					{
-						return thinker;
+						if (m_Remaining > 0) m_Remaining--;
+						if (!exact || thinker->IsA(m_ParentType)) return thinker;
 					}
 					// This can actually happen when a Destroy call on 'thinker' happens to destroy 'm_CurrThinker'.
 					// In that case there is no chance to recover, we have to terminate the iteration of this list.
@@ -978,7 +1145,7 @@ DThinker *FThinkerIterator::Next (bool exact)
 			}
 			if ((m_SearchingFresh = !m_SearchingFresh))
 			{
-				m_CurrThinker = Level->Thinkers.FreshThinkers[m_Stat].GetHead();
+				StartList(Level->Thinkers.FreshThinkers[m_Stat]);
 			}
 		} while (m_SearchingFresh);
 		if (m_SearchStats)
@@ -989,7 +1156,7 @@ DThinker *FThinkerIterator::Next (bool exact)
 				m_Stat = STAT_FIRST_THINKING;
 			}
 		}
-		m_CurrThinker = Level->Thinkers.Thinkers[m_Stat].GetHead();
+		StartList(Level->Thinkers.Thinkers[m_Stat]);
 		m_SearchingFresh = false;
 	} while (m_SearchStats && m_Stat != STAT_FIRST_THINKING);
 	return nullptr;
@@ -45,6 +45,7 @@ struct FState;
 class DThinker;
 class FSerializer;
 struct FLevelLocals;
+struct sector_t;
 
 class FThinkerIterator;
 
@@ -61,13 +62,24 @@ struct FThinkerList
 	void DestroyThinkers();
 	bool DoDestroyThinkers();
 	int TickThinkers(FThinkerList *dest);	// Returns: # of thinkers ticked
+	int TickThinkersParallel(int numworkers);
 	int ProfileThinkers(FThinkerList *dest);
 	void SaveList(FSerializer &arc);
+	int CountOf(const PClass *type) const;
 
 private:
+	void CountClass(const PClass *type, int delta);
+
 	DThinker *Sentinel = nullptr;
 
+	// Number of members of each class, including those of subclasses, so that iterators can skip
+	// lists without any and stop early once they found all of them unless the list changed meanwhile.
+	TMap<FName, int> ClassCounts;
+	unsigned Generation = 0;
+
 	friend struct FThinkerCollection;
+	friend class DThinker;
+	friend class FThinkerIterator;
 };
 
 struct FThinkerCollection
@@ -106,6 +118,11 @@ public:
 	virtual void PostSerialize();
 	void Serialize(FSerializer &arc) override;
 	size_t PropagateMark();
+
+	// Thinkers whose Tick only modifies their own data and the one sector returned here,
+	// and which neither use random numbers nor create or destroy any objects, may be
+	// ticked concurrently with others that affect different sectors.
+	virtual sector_t *GetExclusiveSector() { return nullptr; }
 	
 	void ChangeStatNum (int statnum);
 
@@ -119,6 +136,7 @@ private:
 	friend class FDoomSerializer;
 
 	DThinker *NextThinker = nullptr, *PrevThinker = nullptr;
+	FThinkerList *OwnerList = nullptr;
 
 public:
 	FLevelLocals *Level;
@@ -133,10 +151,15 @@ protected:
 private:
 	FLevelLocals *Level;
 	DThinker *m_CurrThinker;
+	FThinkerList *m_CurrList;
+	int m_Remaining;			// members of m_ParentType left in the current list, -1 if unknown.
+	unsigned m_Generation;
 	uint8_t m_Stat;
 	bool m_SearchStats;
 	bool m_SearchingFresh;
 
+	void StartList(FThinkerList &list);
+
 public:
 	FThinkerIterator (FLevelLocals *Level, const PClass *type, int statnum=MAX_STATNUM+1);
 	FThinkerIterator (FLevelLocals *Level, const PClass *type, int statnum, DThinker *prev);
@@ -284,6 +284,65 @@ char *FParser::GetTokens(char *s)
 }
 
 
+//==========================================================================
+//
+// GetCachedTokens
+//
+// Same as GetTokens(Rover), but only tokenizes each statement of the
+// script once. Later runs copy the tokens from the script's cache.
+//
+//==========================================================================
+
+void FParser::GetCachedTokens()
+{
+	char *data = Script->Data.Data();
+	if (Rover < data || Rover >= data + Script->len)
+	{
+		// included lumps are not part of the script's data.
+		GetTokens(Rover);
+		return;
+	}
+
+	int pos = Script->MakeIndex(Rover);
+	auto line = Script->TokenCache.CheckKey(pos);
+	if (line == nullptr)
+	{
+		// If this throws nothing gets added to the cache.
+		GetTokens(Rover);
+
+		line = &Script->TokenCache[pos];
+		unsigned length = 0;
+		line->Offsets.Resize(NumTokens);
+		line->Types.Resize(NumTokens);
+		for (int i = 0; i < NumTokens; i++)
+		{
+			line->Offsets[i] = int(Tokens[i] - Tokens[0]);
+			line->Types[i] = TokenType[i];
+			unsigned end = unsigned(line->Offsets[i] + strlen(Tokens[i]) + 1);
+			if (end > length) length = end;
+		}
+		line->Text.Resize(length);
+		if (length > 0) memcpy(line->Text.Data(), Tokens[0], length);
+		line->Section = Section;
+		line->BraceType = BraceType;
+		line->LineStart = Script->MakeIndex(LineStart);
+		line->Next = Script->MakeIndex(Rover);
+		return;
+	}
+
+	NumTokens = line->Offsets.Size();
+	if (line->Text.Size() > 0) memcpy(Tokens[0], line->Text.Data(), line->Text.Size());
+	for (int i = 0; i < NumTokens; i++)
+	{
+		Tokens[i] = Tokens[0] + line->Offsets[i];
+		TokenType[i] = line->Types[i];
+	}
+	Section = line->Section;
+	if (Section) BraceType = line->BraceType;
+	LineStart = data + line->LineStart;
+	Rover = data + line->Next;
+}
+
 //==========================================================================
 //
 // PrintTokens: add one character to the current token
@@ -346,7 +405,7 @@ void FParser::Run(char *rover, char *data, char *end)
 			PrevSection = Section; // store from prev. statement
 			
 			// get the line and tokens
-			GetTokens(Rover);
+			GetCachedTokens();
 			
 			if(!NumTokens)
 			{
@@ -334,6 +334,22 @@ public:
 	bool lastiftrue;     // haleyjd: whether last "if" statement was 
 	// true or false
 
+	// Statements that already have been split into tokens, keyed by their
+	// offset in Data. The script text does not change after preprocessing
+	// so this only needs to be done once, not each time the statement runs.
+	// Not serialized, it just gets rebuilt on demand.
+	struct FTokenizedLine
+	{
+		TArray<char> Text;
+		TArray<int> Offsets;
+		TArray<tokentype_t> Types;
+		DFsSection *Section;
+		int BraceType;
+		int LineStart;
+		int Next;
+	};
+	TMap<int, FTokenizedLine> TokenCache;
+
 	DFsScript();
 	void OnDestroy() override;
 	void Serialize(FSerializer &ar);
@@ -429,6 +445,7 @@ struct FParser
 
 	void NextToken();
 	char *GetTokens(char *s);
+	void GetCachedTokens();
 	void PrintTokens();
 	void ErrorMessage(FString msg);
 
@@ -58,6 +58,7 @@ public:
 	void Construct(sector_t *sector, int upper, int lower, int utics, int ltics);
 	void		Serialize(FSerializer &arc);
 	void		Tick();
+	sector_t	*GetExclusiveSector() override { return m_Sector; }
 protected:
 	int 		m_Count;
 	int 		m_MinLight;
@@ -73,6 +74,7 @@ public:
 	void Construct(sector_t *sector);
 	void		Serialize(FSerializer &arc);
 	void		Tick();
+	sector_t	*GetExclusiveSector() override { return m_Sector; }
 protected:
 	int 		m_MinLight;
 	int 		m_MaxLight;
@@ -107,6 +109,7 @@ public:
 
 	void		Serialize(FSerializer &arc);
 	void		Tick();
+	sector_t	*GetExclusiveSector() override { return m_Sector; }
 protected:
 	uint8_t		m_BaseLevel;
 	uint8_t		m_Phase;
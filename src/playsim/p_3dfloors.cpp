@@ -292,6 +292,27 @@ bool P_CheckFor3DCeilingHit(AActor * mo, double z, bool trigger)
 	return false;
 }
 
+//==========================================================================
+//
+// Collects the floors that can actually block movement. Most of the
+// collision code is only interested in those, so this spares them from
+// having to skip over the translucent, swimmable and non-existing ones.
+//
+//==========================================================================
+
+static void P_CollectSolid3DFloors(sector_t *sector)
+{
+	auto &xf = sector->e->XFloor;
+	xf.solidffloors.Clear();
+	for (auto rover : xf.ffloors)
+	{
+		if ((rover->flags & (FF_EXISTS | FF_SOLID)) == (FF_EXISTS | FF_SOLID))
+		{
+			xf.solidffloors.Push(rover);
+		}
+	}
+}
+
 //==========================================================================
 //
 // P_Recalculate3DFloors
@@ -545,6 +566,7 @@ void P_Recalculate3DFloors(sector_t * sector)
 			}
 		}
 	}
+	P_CollectSolid3DFloors(sector);
 }
 
 //==========================================================================
@@ -578,6 +600,7 @@ void FLevelLocals::ClearDynamic3DFloorData()
 				rover->flags |= FF_EXISTS;
 			}
 		}
+		P_CollectSolid3DFloors(&sec);
 	}
 }
 
@@ -682,7 +705,7 @@ void P_LineOpening_XFloors (FLineOpening &open, AActor * thing, const line_t *li
 		extsector_t::xfloor *xf[2] = {&linedef->frontsector->e->XFloor, &linedef->backsector->e->XFloor};
 
 		// Check for 3D-floors in the sector (mostly identical to what Legacy does here)
-		if(xf[0]->ffloors.Size() || xf[1]->ffloors.Size())
+		if(xf[0]->solidffloors.Size() || xf[1]->solidffloors.Size())
 		{
 			double    lowestceiling = open.top;
 			double    highestfloor = open.bottom;
@@ -703,13 +726,8 @@ void P_LineOpening_XFloors (FLineOpening &open, AActor * thing, const line_t *li
 			
 			for(int j=0;j<2;j++)
 			{
-				for(unsigned i=0;i<xf[j]->ffloors.Size();i++)
+				for(auto rover : xf[j]->solidffloors)
 				{
-					F3DFloor *rover = xf[j]->ffloors[i];
-
-					if (!(rover->flags & FF_EXISTS)) continue;
-					if (!(rover->flags & FF_SOLID)) continue;
-					
 					double ff_bottom=rover->bottom.plane->ZatPoint(x, y);
 					double ff_top=rover->top.plane->ZatPoint(x, y);
 					
@@ -797,10 +815,8 @@ secplane_t P_FindFloorPlane(sector_t * sector, const DVector3 &pos)
 	secplane_t retplane = sector->floorplane;
 	if (sector->e)	// apparently this can be called when the data is already gone
 	{
-		for(auto rover : sector->e->XFloor.ffloors)
+		for(auto rover : sector->e->XFloor.solidffloors)
 		{
-			if(!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
-
 			if (rover->top.plane->ZatPoint(pos) == pos.Z)
 			{
 				retplane = *rover->top.plane;
@@ -834,31 +850,28 @@ int	P_Find3DFloor(sector_t * sec, const DVector3 &pos, bool above, bool floor, d
 	if (pos.Z <= cmpz)
 		return -1;
 
-	// Looking through planes from top to bottom
-	for (int i = 0; i < (signed)sec->e->XFloor.ffloors.Size(); ++i)
+	// Looking through planes from top to bottom. We are only interested in solid 3D floors here.
+	// The result is an index into the full list, but it only needs to be looked up once something was found.
+	auto &xf = sec->e->XFloor;
+	for (auto rover : xf.solidffloors)
 	{
-		F3DFloor *rover = sec->e->XFloor.ffloors[i];
-
-		// We are only interested in solid 3D floors here
-		if(!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
-
 		if (above)
 		{
 			// z is above that floor
 			if (floor && (pos.Z >= (cmpz = rover->top.plane->ZatPoint(pos))))
-				return i - 1;
+				return int(xf.ffloors.Find(rover)) - 1;
 			// z is above that ceiling
 			if (pos.Z >= (cmpz = rover->bottom.plane->ZatPoint(pos)))
-				return i - 1;
+				return int(xf.ffloors.Find(rover)) - 1;
 		}
 		else // below
 		{
 			// z is below that ceiling
 			if (!floor && (pos.Z <= (cmpz = rover->bottom.plane->ZatPoint(pos))))
-				return i;
+				return int(xf.ffloors.Find(rover));
 			// z is below that floor
 			if (pos.Z <= (cmpz = rover->top.plane->ZatPoint(pos)))
-				return i;
+				return int(xf.ffloors.Find(rover));
 		}
 	}
 
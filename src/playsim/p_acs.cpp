@@ -645,6 +645,7 @@ struct CallReturn
 	int ReturnAddress;
 	int bDiscardResult;
 	unsigned int EntryInstrCount;
+	cycle_t Time;
 };
 
 
@@ -1680,6 +1681,54 @@ void P_WriteACSVars(FSerializer &arc)
 //---- Inventory functions --------------------------------------//
 //
 
+//============================================================================
+//
+// FindACSActor
+//
+// ACS passes class names around as strings, so each CheckInventory,
+// UseInventory, Spawn etc. has to look up the name and then the class.
+// HUD scripts do this for the same few items every tic, so the most recent
+// lookups are remembered by string address. Since pool strings can be freed
+// and their memory reused the name is compared again on a hit.
+//
+//============================================================================
+
+struct FACSClassCacheEntry
+{
+	const char *Key = nullptr;
+	FString Name;
+	PClassActor *Class = nullptr;
+};
+
+static FACSClassCacheEntry ACSClassCache[64];
+
+static void ClearACSClassCache()
+{
+	for (auto &entry : ACSClassCache)
+	{
+		entry.Key = nullptr;
+		entry.Name = "";
+		entry.Class = nullptr;
+	}
+}
+
+static PClassActor *FindACSActor(const char *name)
+{
+	if (name == nullptr)
+	{
+		return nullptr;
+	}
+	auto &entry = ACSClassCache[((uintptr_t)name >> 3) % countof(ACSClassCache)];
+	if (entry.Key != name || entry.Name.Compare(name) != 0)
+	{
+		entry.Key = name;
+		entry.Name = name;
+		entry.Class = PClass::FindActor(name);
+	}
+	return entry.Class;
+}
+
+
 //============================================================================
 //
 // DoUseInv
@@ -1732,7 +1781,7 @@ static int UseInventory (FLevelLocals *Level, AActor *activator, const char *typ
 	{
 		return 0;
 	}
-	info = PClass::FindActor (type);
+	info = FindACSActor (type);
 	if (info == NULL)
 	{
 		return 0;
@@ -1779,7 +1828,7 @@ int CheckInventory (AActor *activator, const char *type, bool max)
 		return activator->health;
 	}
 
-	PClassActor *info = PClass::FindActor (type);
+	PClassActor *info = FindACSActor (type);
 
 	if (info == NULL)
 	{
@@ -1984,6 +2033,7 @@ void FBehaviorContainer::UnloadModules ()
 		delete StaticModules[i];
 	}
 	StaticModules.Clear ();
+	ClearACSClassCache();
 }
 
 FBehavior *FBehaviorContainer::GetModule (int lib)
@@ -3409,6 +3459,11 @@ void DACSThinker::Serialize(FSerializer &arc)
 
 cycle_t ACSTime;
 
+// Wall time accounting for acsprofile. This is off by default because
+// taking the clock around every script run and function call is not free.
+CVAR(Bool, acs_profiletime, false, 0)
+static cycle_t ACSSpecialTime, ACSBuiltinTime;
+
 void DACSThinker::Tick ()
 {
 	ACSTime.Reset();
@@ -3746,7 +3801,7 @@ void DLevelScript::SetLineTexture (int lineid, int side, int position, int name)
 
 int DLevelScript::DoSpawn (int type, const DVector3 &pos, int tid, DAngle angle, bool force)
 {
-	PClassActor *info = PClass::FindActor(Level->Behaviors.LookupString (type));
+	PClassActor *info = FindACSActor(Level->Behaviors.LookupString (type));
 	AActor *actor = NULL;
 	int spawncount = 0;
 
@@ -6735,6 +6790,57 @@ inline int getshort (int *&pc)
 	return res;
 }
 
+//============================================================================
+//
+// TakeBranchPCD
+//
+// ACC compiles every if, while and for into a comparison that is directly
+// followed by a conditional jump. When that is the case the comparison
+// handlers consume the jump as well, so such conditions only take one trip
+// through the dispatch switch. Jumps are never suspension points and the
+// compared value is popped right away again, so nothing can observe the
+// difference. Only works for pcodes that fit into one byte in the enhanced
+// format.
+//
+//============================================================================
+
+inline bool TakeBranchPCD (int *&pc, ACSFormat fmt, int pcd)
+{
+	if (fmt == ACS_LittleEnhanced)
+	{
+		if (*(uint8_t *)pc != pcd) return false;
+		pc = (int *)((uint8_t *)pc+1);
+	}
+	else
+	{
+		if (LittleLong(*pc) != pcd) return false;
+		pc++;
+	}
+	return true;
+}
+
+#define COMPARE(op) \
+	temp = (STACK(2) op STACK(1)); \
+	if (TakeBranchPCD(pc, fmt, PCD_IFNOTGOTO)) \
+	{ \
+		runaway++; \
+		sp -= 2; \
+		if (!temp) pc = activeBehavior->Ofs2PC (LittleLong(*pc)); \
+		else pc++; \
+	} \
+	else if (TakeBranchPCD(pc, fmt, PCD_IFGOTO)) \
+	{ \
+		runaway++; \
+		sp -= 2; \
+		if (temp) pc = activeBehavior->Ofs2PC (LittleLong(*pc)); \
+		else pc++; \
+	} \
+	else \
+	{ \
+		STACK(2) = temp; \
+		sp--; \
+	}
+
 static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory& Stack, int &sp, bool ranged)
 {
 	if (ranged)
@@ -6759,9 +6865,51 @@ static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory&
 	return true;
 }
 
+//============================================================================
+//
+// GetPCDTimer
+//
+// Returns the acsprofile timer for pcodes that leave the interpreter,
+// so that time spent in line specials and builtins can be told apart
+// from the time spent in the scripts themselves.
+//
+//============================================================================
+
+static cycle_t *GetPCDTimer(int pcd)
+{
+	switch (pcd)
+	{
+	case PCD_LSPEC1:
+	case PCD_LSPEC2:
+	case PCD_LSPEC3:
+	case PCD_LSPEC4:
+	case PCD_LSPEC5:
+	case PCD_LSPEC5RESULT:
+	case PCD_LSPEC5EX:
+	case PCD_LSPEC5EXRESULT:
+	case PCD_LSPEC1DIRECT:
+	case PCD_LSPEC2DIRECT:
+	case PCD_LSPEC3DIRECT:
+	case PCD_LSPEC4DIRECT:
+	case PCD_LSPEC5DIRECT:
+	case PCD_LSPEC1DIRECTB:
+	case PCD_LSPEC2DIRECTB:
+	case PCD_LSPEC3DIRECTB:
+	case PCD_LSPEC4DIRECTB:
+	case PCD_LSPEC5DIRECTB:
+		return &ACSSpecialTime;
+
+	case PCD_CALLFUNC:
+		return &ACSBuiltinTime;
+
+	default:
+		return nullptr;
+	}
+}
+
 PClass *DLevelScript::GetClassForIndex(int index) const
 {
-	return PClass::FindActor(Level->Behaviors.LookupString(index));
+	return FindACSActor(Level->Behaviors.LookupString(index));
 }
 
 int DLevelScript::RunScript()
@@ -6855,8 +7003,22 @@ int DLevelScript::RunScript()
 	int optstart = -1;
 	int temp;
 
+	const bool timing = acs_profiletime;
+	cycle_t runtime;
+	cycle_t *optime = nullptr;
+	if (timing)
+	{
+		runtime.Reset();
+		runtime.Clock();
+	}
+
 	while (state == SCRIPT_Running)
 	{
+		if (optime != nullptr)
+		{
+			optime->Unclock();
+			optime = nullptr;
+		}
 		if (++runaway > 2000000)
 		{
 			Printf ("Runaway %s terminated\n", ScriptPresentation(script).GetChars());
@@ -6877,6 +7039,12 @@ int DLevelScript::RunScript()
 			pcd = NEXTWORD;
 		}
 
+		if (timing)
+		{
+			optime = GetPCDTimer(pcd);
+			if (optime != nullptr) optime->Clock();
+		}
+
 		switch (pcd)
 		{
 		default:
@@ -7173,8 +7341,13 @@ int DLevelScript::RunScript()
 					Stack[sp+i] = 0;
 				}
 				sp += i;
-				::new(&Stack[sp]) CallReturn(activeBehavior->PC2Ofs(pc), activeFunction,
+				auto ret = ::new(&Stack[sp]) CallReturn(activeBehavior->PC2Ofs(pc), activeFunction,
 					activeBehavior, mylocals, localarrays, pcd == PCD_CALLDISCARD, runaway);
+				if (timing)
+				{
+					ret->Time.Reset();
+					ret->Time.Clock();
+				}
 				sp += (sizeof(CallReturn) + sizeof(int) - 1) / sizeof(int);
 				pc = module->Ofs2PC (func->Address);
 				localarrays = &func->LocalArrays;
@@ -7204,7 +7377,13 @@ int DLevelScript::RunScript()
 				}
 				sp -= sizeof(CallReturn)/sizeof(int);
 				retsp = &Stack[sp];
-				activeBehavior->GetFunctionProfileData(activeFunction)->AddRun(runaway - ret->EntryInstrCount);
+				double ms = 0;
+				if (timing)
+				{
+					ret->Time.Unclock();
+					ms = ret->Time.TimeMS();
+				}
+				activeBehavior->GetFunctionProfileData(activeFunction)->AddRun(runaway - ret->EntryInstrCount, ms);
 				sp = int(locals.GetPointer() - &Stack[0]);
 				pc = ret->ReturnModule->Ofs2PC(ret->ReturnAddress);
 				activeFunction = ret->ReturnFunction;
@@ -7260,33 +7439,27 @@ int DLevelScript::RunScript()
 			break;
 
 		case PCD_EQ:
-			STACK(2) = (STACK(2) == STACK(1));
-			sp--;
+			COMPARE(==);
 			break;
 
 		case PCD_NE:
-			STACK(2) = (STACK(2) != STACK(1));
-			sp--;
+			COMPARE(!=);
 			break;
 
 		case PCD_LT:
-			STACK(2) = (STACK(2) < STACK(1));
-			sp--;
+			COMPARE(<);
 			break;
 
 		case PCD_GT:
-			STACK(2) = (STACK(2) > STACK(1));
-			sp--;
+			COMPARE(>);
 			break;
 
 		case PCD_LE:
-			STACK(2) = (STACK(2) <= STACK(1));
-			sp--;
+			COMPARE(<=);
 			break;
 
 		case PCD_GE:
-			STACK(2) = (STACK(2) >= STACK(1));
-			sp--;
+			COMPARE(>=);
 			break;
 
 		case PCD_ASSIGNSCRIPTVAR:
@@ -9287,7 +9460,7 @@ scriptwait:
 		case PCD_SETAMMOCAPACITY:
 			if (activator != NULL)
 			{
-				PClassActor *type = PClass::FindActor (Level->Behaviors.LookupString (STACK(2)));
+				PClassActor *type = FindACSActor (Level->Behaviors.LookupString (STACK(2)));
 
 				if (type != NULL && type->ParentClass == PClass::FindActor(NAME_Ammo))
 				{
@@ -10192,12 +10365,21 @@ scriptwait:
  		}
  	}
 
+	if (optime != nullptr)
+	{
+		optime->Unclock();
+	}
+	if (timing)
+	{
+		runtime.Unclock();
+	}
+
 	if (runaway != 0 && InModuleScriptNumber >= 0)
 	{
 		auto scriptptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
 		if (scriptptr != nullptr)
 		{
-			scriptptr->ProfileData.AddRun(runaway);
+			scriptptr->ProfileData.AddRun(runaway, timing ? runtime.TimeMS() : 0);
 		}
 		else
 		{
@@ -10519,11 +10701,18 @@ void ACSProfileInfo::Reset()
 	NumRuns = 0;
 	MinInstrPerRun = UINT_MAX;
 	MaxInstrPerRun = 0;
+	TotalMS = 0;
+	MaxMSPerRun = 0;
 }
 
-void ACSProfileInfo::AddRun(unsigned int num_instr)
+void ACSProfileInfo::AddRun(unsigned int num_instr, double ms)
 {
 	TotalInstr += num_instr;
+	TotalMS += ms;
+	if (ms > MaxMSPerRun)
+	{
+		MaxMSPerRun = ms;
+	}
 	NumRuns++;
 	if (num_instr < MinInstrPerRun)
 	{
@@ -10623,6 +10812,31 @@ static int sort_by_runs(const void *a_, const void *b_)
 	return b->ProfileData->NumRuns - a->ProfileData->NumRuns;
 }
 
+static int sort_by_time(const void *a_, const void *b_)
+{
+	const ProfileCollector *a = (const ProfileCollector *)a_;
+	const ProfileCollector *b = (const ProfileCollector *)b_;
+
+	double diff = b->ProfileData->TotalMS - a->ProfileData->TotalMS;
+	return diff > 0 ? 1 : diff < 0 ? -1 : 0;
+}
+
+static FString GetProfileName(const ProfileCollector *prof, bool functions)
+{
+	if (functions)
+	{
+		uint32_t *fnames = (uint32_t *)prof->Module->FindChunk(MAKE_ID('F','N','A','M'));
+		if (fnames != nullptr && prof->Index >= 0 && prof->Index < (int)LittleLong(fnames[2]))
+		{
+			return (char *)(fnames + 2) + LittleLong(fnames[3+prof->Index]);
+		}
+		FString name;
+		name.Format("Function %d", prof->Index);
+		return name;
+	}
+	return ScriptPresentation(prof->Module->GetScriptPtr(prof->Index)->Number).GetChars() + 7;
+}
+
 static void ShowProfileData(TArray<ProfileCollector> &profiles, long ilimit,
 	int (*sorter)(const void *, const void *), bool functions)
 {
@@ -10650,8 +10864,8 @@ static void ShowProfileData(TArray<ProfileCollector> &profiles, long ilimit,
 		limit = UINT_MAX;
 	}
 
-	Printf(TEXTCOLOR_YELLOW "Module       %-20s      Total    Runs     Avg     Min     Max\n", typelabels[functions]);
-	Printf(TEXTCOLOR_YELLOW "------------ -------------------- ---------- ------- ------- ------- -------\n");
+	Printf(TEXTCOLOR_YELLOW "Module       %-20s      Total    Runs     Avg     Min     Max  Total ms   Max ms\n", typelabels[functions]);
+	Printf(TEXTCOLOR_YELLOW "------------ -------------------- ---------- ------- ------- ------- ------- --------- --------\n");
 	for (unsigned int i = 0; i < limit && i < profiles.Size(); ++i)
 	{
 		ProfileCollector *prof = &profiles[i];
@@ -10664,36 +10878,71 @@ static void ShowProfileData(TArray<ProfileCollector> &profiles, long ilimit,
 		mysnprintf(modname, sizeof(modname), "%s", prof->Module->GetModuleName());
 
 		// Script/function name
-		if (functions)
-		{
-			uint32_t *fnames = (uint32_t *)prof->Module->FindChunk(MAKE_ID('F','N','A','M'));
-			if (prof->Index >= 0 && prof->Index < (int)LittleLong(fnames[2]))
-			{
-				mysnprintf(scriptname, sizeof(scriptname), "%s",
-					(char *)(fnames + 2) + LittleLong(fnames[3+prof->Index]));
-			}
-			else
-			{
-				mysnprintf(scriptname, sizeof(scriptname), "Function %d", prof->Index);
-			}
-		}
-		else
-		{
-			mysnprintf(scriptname, sizeof(scriptname), "%s",
-				ScriptPresentation(prof->Module->GetScriptPtr(prof->Index)->Number).GetChars() + 7);
-		}
-		Printf("%-12s %-20s%11llu%8u%8u%8u%8u\n",
+		mysnprintf(scriptname, sizeof(scriptname), "%s", GetProfileName(prof, functions).GetChars());
+		Printf("%-12s %-20s%11llu%8u%8u%8u%8u%10.3f%9.3f\n",
 			modname, scriptname,
 			prof->ProfileData->TotalInstr,
 			prof->ProfileData->NumRuns,
 			unsigned(prof->ProfileData->TotalInstr / prof->ProfileData->NumRuns),
 			prof->ProfileData->MinInstrPerRun,
-			prof->ProfileData->MaxInstrPerRun
+			prof->ProfileData->MaxInstrPerRun,
+			prof->ProfileData->TotalMS,
+			prof->ProfileData->MaxMSPerRun
 			);
 	}
 }
 
-void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
+//============================================================================
+//
+// DumpProfileCSV
+//
+// Writes all collected profiling data into a CSV file, one row per
+// script, function and module, plus the time spent in line specials and
+// builtins, for further processing in a spreadsheet.
+//
+//============================================================================
+
+static void WriteProfileRows(FileWriter *fw, FLevelLocals *Level, TArray<ProfileCollector> &profiles, bool functions)
+{
+	for (auto &prof : profiles)
+	{
+		if (prof.ProfileData->NumRuns == 0)
+		{
+			continue;
+		}
+		FString name = GetProfileName(&prof, functions);
+		name.Substitute("\"", "\"\"");
+		fw->Printf("%s,%s,%s,\"%s\",%u,%llu,%u,%u,%.4f,%.4f\n", Level->MapName.GetChars(), functions ? "function" : "script",
+			prof.Module->GetModuleName(), name.GetChars(), prof.ProfileData->NumRuns, prof.ProfileData->TotalInstr,
+			prof.ProfileData->MinInstrPerRun, prof.ProfileData->MaxInstrPerRun, prof.ProfileData->TotalMS, prof.ProfileData->MaxMSPerRun);
+	}
+}
+
+static void DumpProfileCSV(FileWriter *fw, FLevelLocals *Level, TArray<ProfileCollector> &scripts, TArray<ProfileCollector> &functions)
+{
+	WriteProfileRows(fw, Level, scripts, false);
+	WriteProfileRows(fw, Level, functions, true);
+
+	// Module totals only include scripts, because function times are already part of their callers.
+	for (unsigned i = 0; i < scripts.Size(); )
+	{
+		FBehavior *module = scripts[i].Module;
+		ACSProfileInfo total;
+		for (; i < scripts.Size() && scripts[i].Module == module; i++)
+		{
+			auto data = scripts[i].ProfileData;
+			total.TotalInstr += data->TotalInstr;
+			total.NumRuns += data->NumRuns;
+			total.TotalMS += data->TotalMS;
+		}
+		if (total.NumRuns > 0)
+		{
+			fw->Printf("%s,module,%s,,%u,%llu,,,%.4f,\n", Level->MapName.GetChars(), module->GetModuleName(), total.NumRuns, total.TotalInstr, total.TotalMS);
+		}
+	}
+}
+
+void ACSProfile(FLevelLocals *Level, FCommandLine &argv, FileWriter *csv)
 {
 	static int (*sort_funcs[])(const void*, const void *) =
 	{
@@ -10701,10 +10950,11 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 		sort_by_min,
 		sort_by_max,
 		sort_by_avg,
-		sort_by_runs
+		sort_by_runs,
+		sort_by_time
 	};
-	static const char *sort_names[] = { "total", "min", "max", "avg", "runs" };
-	static const uint8_t sort_match_len[] = {   1,     2,     2,     1,      1 };
+	static const char *sort_names[] = { "total", "min", "max", "avg", "runs", "time" };
+	static const uint8_t sort_match_len[] = {   1,     2,     2,     1,      1,      1 };
 
 		TArray<ProfileCollector> ScriptProfiles, FuncProfiles;
 		long limit = 10;
@@ -10712,10 +10962,16 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 
 	assert(countof(sort_names) == countof(sort_match_len));
 
-	Printf("ACS profile for %s\n", Level->MapName.GetChars());
 	Level->Behaviors.ArrangeScriptProfiles(ScriptProfiles);
 	Level->Behaviors.ArrangeFunctionProfiles(FuncProfiles);
 
+	if (csv != nullptr)
+	{
+		DumpProfileCSV(csv, Level, ScriptProfiles, FuncProfiles);
+		return;
+	}
+
+	Printf("ACS profile for %s\n", Level->MapName.GetChars());
 	if (argv.argc() > 1)
 	{
 		// `acsprofile clear` will zero all profiling information collected so far.
@@ -10723,6 +10979,8 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 		{
 			ClearProfiles(ScriptProfiles);
 			ClearProfiles(FuncProfiles);
+			ACSSpecialTime.Reset();
+			ACSBuiltinTime.Reset();
 			return;
 		}
 		for (int i = 1; i < argv.argc(); ++i)
@@ -10755,7 +11013,8 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 			{
 				Printf("Unknown option '%s'\n", argv[i]);
 				Printf("acsprofile clear : Reset profiling information\n");
-				Printf("acsprofile [total|min|max|avg|runs] [<limit>]\n");
+				Printf("acsprofile csv <file> : Write profiling information to a CSV file\n");
+				Printf("acsprofile [total|min|max|avg|runs|time] [<limit>]\n");
 				return;
 			}
 		}
@@ -10763,13 +11022,43 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 
 	ShowProfileData(ScriptProfiles, limit, sorter, false);
 	ShowProfileData(FuncProfiles, limit, sorter, true);
+	if (acs_profiletime)
+	{
+		Printf("Line specials: %.3f ms, builtins: %.3f ms\n", ACSSpecialTime.TimeMS(), ACSBuiltinTime.TimeMS());
+	}
+	else
+	{
+		Printf("Set acs_profiletime to true to collect timing information\n");
+	}
 }
 
 CCMD(acsprofile)
 {
+	FileWriter *csv = nullptr;
+	if (argv.argc() > 1 && stricmp(argv[1], "csv") == 0)
+	{
+		if (argv.argc() < 3)
+		{
+			Printf("Usage: acsprofile csv <file>\n");
+			return;
+		}
+		csv = FileWriter::Open(argv[2]);
+		if (csv == nullptr)
+		{
+			Printf("Unable to open %s\n", argv[2]);
+			return;
+		}
+		csv->Printf("map,type,module,name,runs,totalinstr,mininstr,maxinstr,totalms,maxms\n");
+	}
 	for (auto Level : AllLevels())
 	{
-		ACSProfile(Level, argv);
+		ACSProfile(Level, argv, csv);
+	}
+	if (csv != nullptr)
+	{
+		csv->Printf(",specials,,,,,,,%.4f,\n,builtins,,,,,,,%.4f,\n", ACSSpecialTime.TimeMS(), ACSBuiltinTime.TimeMS());
+		delete csv;
+		Printf("ACS profile written to %s\n", argv[2]);
 	}
 }
 
@@ -10777,3 +11066,36 @@ ADD_STAT(ACS)
 {
 	return FStringf("ACS time: %f ms", ACSTime.TimeMS());
 }
+
+//============================================================================
+//
+// The acsprofile stat page shows the scripts that have used most of the
+// time since the last 'acsprofile clear'.
+//
+//============================================================================
+
+ADD_STAT(acsprofile)
+{
+	FString out;
+	if (!acs_profiletime)
+	{
+		out = "Set acs_profiletime to true to collect timing information";
+		return out;
+	}
+
+	TArray<ProfileCollector> profiles;
+	primaryLevel->Behaviors.ArrangeScriptProfiles(profiles);
+	out.Format("Line specials: %.3f ms, builtins: %.3f ms", ACSSpecialTime.TimeMS(), ACSBuiltinTime.TimeMS());
+	if (profiles.Size() > 0)
+	{
+		qsort(&profiles[0], profiles.Size(), sizeof(ProfileCollector), sort_by_time);
+		for (unsigned i = 0; i < profiles.Size() && i < 8; i++)
+		{
+			auto data = profiles[i].ProfileData;
+			if (data->NumRuns == 0) break;
+			out.AppendFormat("\n%s %s: %.3f ms in %u runs, max %.3f ms", profiles[i].Module->GetModuleName(),
+				GetProfileName(&profiles[i], false).GetChars(), data->TotalMS, data->NumRuns, data->MaxMSPerRun);
+		}
+	}
+	return out;
+}
@@ -154,9 +154,11 @@ struct ACSProfileInfo
 	unsigned int NumRuns;
 	unsigned int MinInstrPerRun;
 	unsigned int MaxInstrPerRun;
+	double TotalMS;
+	double MaxMSPerRun;
 
 	ACSProfileInfo();
-	void AddRun(unsigned int num_instr);
+	void AddRun(unsigned int num_instr, double ms = 0);
 	void Reset();
 };
 
@@ -908,17 +908,10 @@ enum CM_Flags
 	CMF_BADPITCH = 256
 };
 
-DEFINE_ACTION_FUNCTION(AActor, A_SpawnProjectile)
+static AActor *SpawnProjectile(AActor *self, PClassActor *ti, double Spawnheight, double Spawnofs_xy, double angle, int flags, double pitch, int ptr)
 {
-	PARAM_SELF_PROLOGUE(AActor);
-	PARAM_CLASS		(ti, AActor);
-	PARAM_FLOAT	(Spawnheight);
-	PARAM_FLOAT	(Spawnofs_xy);
-	PARAM_ANGLE	(Angle);
-	PARAM_INT	(flags);
-	PARAM_ANGLE	(Pitch);
-	PARAM_INT	(ptr);
-
+	DAngle Angle = angle;
+	DAngle Pitch = pitch;
 	AActor *ref = COPY_AAPTR(self, ptr);
 
 	int aimmode = flags & CMF_AIMMODE;
@@ -1049,7 +1042,20 @@ DEFINE_ACTION_FUNCTION(AActor, A_SpawnProjectile)
 		if (self->SeeState != NULL && (self->health > 0 || !(self->flags3 & MF3_ISMONSTER)))
 			self->SetState(self->SeeState);
 	}
-	ACTION_RETURN_OBJECT(missile);
+	return missile;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, A_SpawnProjectile, SpawnProjectile)
+{
+	PARAM_SELF_PROLOGUE(AActor);
+	PARAM_CLASS		(ti, AActor);
+	PARAM_FLOAT	(Spawnheight);
+	PARAM_FLOAT	(Spawnofs_xy);
+	PARAM_FLOAT	(Angle);
+	PARAM_INT	(flags);
+	PARAM_FLOAT	(Pitch);
+	PARAM_INT	(ptr);
+	ACTION_RETURN_OBJECT(SpawnProjectile(self, ti, Spawnheight, Spawnofs_xy, Angle, flags, Pitch, ptr));
 }
 
 //==========================================================================
@@ -33,7 +33,9 @@ struct FCheckPosition
 	AActor			*stepthing;
 	// [RH] These are used by PIT_CheckThing and P_XYMovement to apply
 	// ripping damage once per tic instead of once per move.
-	TMap<AActor*, bool> LastRipped;
+	// This is a plain array because it is almost always empty and, unlike
+	// a TMap, does not allocate anything for every position check.
+	TArray<AActor*> LastRipped;
 	bool			DoRipping;
 	bool			portalstep;
 	bool			dropoffisportal;
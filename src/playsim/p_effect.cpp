@@ -49,6 +49,9 @@
 #include "vm.h"
 #include "actorinlines.h"
 #include "g_game.h"
+#include "texturemanager.h"
+#include "bitmap.h"
+#include "palutil.h"
 
 CVAR (Int, cl_rockettrails, 1, CVAR_ARCHIVE);
 CVAR (Bool, r_rail_smartspiral, 0, CVAR_ARCHIVE);
@@ -210,6 +213,30 @@ void P_InitEffects ()
 	blood2 = ParticleColor(RPART(kind)/3, GPART(kind)/3, BPART(kind)/3);
 }
 
+//==========================================================================
+//
+// Particles rarely move far enough in one tic to leave their subsector,
+// so checking the old one against its own segs first is a lot cheaper
+// than walking the entire BSP for each particle on every tic.
+// Since render subsectors are always closed convex polygons the point
+// only needs to lie in front of each seg.
+//
+//==========================================================================
+
+static bool PointInSubsectorPoly(const subsector_t *sub, const DVector3 &pos)
+{
+	if (sub->numlines < 3 || (sub->flags & (SSECF_DEGENERATE | SSECF_HOLE))) return false;
+
+	for (uint32_t i = 0; i < sub->numlines; i++)
+	{
+		const seg_t *seg = &sub->firstline[i];
+		double x1 = seg->v1->fX(), y1 = seg->v1->fY();
+		double dx = seg->v2->fX() - x1, dy = seg->v2->fY() - y1;
+		if ((pos.Y - y1) * dx - (pos.X - x1) * dy > 0) return false;
+	}
+	return true;
+}
+
 void P_ThinkParticles (FLevelLocals *Level)
 {
 	int i;
@@ -248,7 +275,10 @@ void P_ThinkParticles (FLevelLocals *Level)
 		particle->Pos.Y = newxy.Y;
 		particle->Pos.Z += particle->Vel.Z;
 		particle->Vel += particle->Acc;
-		particle->subsector = Level->PointInRenderSubsector(particle->Pos);
+		if (particle->subsector == nullptr || !PointInSubsectorPoly(particle->subsector, particle->Pos))
+		{
+			particle->subsector = Level->PointInRenderSubsector(particle->Pos);
+		}
 		sector_t *s = particle->subsector->sector;
 		// Handle crossing a sector portal.
 		if (!s->PortalBlocksMovement(sector_t::ceiling))
@@ -564,6 +594,62 @@ void P_DrawSplash2 (FLevelLocals *Level, int count, const DVector3 &pos, DAngle
 	}
 }
 
+//==========================================================================
+//
+// P_DrawTerrainSplash
+//
+// A particle replacement for a terrain's splash actors. The particles take
+// the color of the liquid's flat, which only gets averaged once per texture.
+//
+//==========================================================================
+
+static TMap<int, uint32_t> SplashColors;
+
+static uint32_t SplashColor(FTextureID flat)
+{
+	auto check = SplashColors.CheckKey(flat.GetIndex());
+	if (check != nullptr) return *check;
+
+	PalEntry average = MAKERGB(128, 128, 128);
+	auto tex = TexMan.GetGameTexture(flat);
+	if (tex != nullptr && tex->isValid())
+	{
+		FBitmap bitmap = tex->GetTexture()->GetBgraBitmap(nullptr);
+		auto buffer = (const uint32_t *)bitmap.GetPixels();
+		if (buffer) average = averageColor(buffer, bitmap.GetWidth() * bitmap.GetHeight(), 0);
+	}
+	uint32_t color = ParticleColor(average.r, average.g, average.b);
+	SplashColors.Insert(flat.GetIndex(), color);
+	return color;
+}
+
+void P_DrawTerrainSplash (FLevelLocals *Level, const DVector3 &pos, FTextureID flat, bool small)
+{
+	uint32_t color = SplashColor(flat);
+	int count = small ? 4 : 12;
+
+	for (; count; count--)
+	{
+		particle_t *p = NewParticle (Level);
+
+		if (!p)
+			break;
+
+		DAngle an = M_Random() * (360 / 256.);
+		double speed = M_Random() / (small ? 256. : 128.);
+		p->ttl = small ? 12 : 20;
+		p->fadestep = FADEFROMTTL(p->ttl);
+		p->alpha = 1.f;
+		p->size = small ? 2 : 3;
+		p->color = color;
+		p->Pos = pos;
+		p->Vel.X = speed * an.Cos();
+		p->Vel.Y = speed * an.Sin();
+		p->Vel.Z = (small ? 1. : 2.) + M_Random() / 64.;
+		p->Acc.Z = -1 / 4.;
+	}
+}
+
 struct TrailSegment
 {
 	DVector3 start;
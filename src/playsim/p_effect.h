@@ -35,6 +35,7 @@
 
 #include "vectors.h"
 #include "doomdef.h"
+#include "textureid.h"
 
 #define FX_ROCKET			0x00000001
 #define FX_GRENADE			0x00000002
@@ -92,4 +93,5 @@ struct SPortalHit
 void P_DrawRailTrail(AActor *source, TArray<SPortalHit> &portalhits, int color1, int color2, double maxdiff = 0, int flags = 0, PClassActor *spawnclass = NULL, DAngle angle = 0., int duration = TICRATE, double sparsity = 1.0, double drift = 1.0, int SpiralOffset = 270, DAngle pitch = 0.);
 void P_DrawSplash (FLevelLocals *Level, int count, const DVector3 &pos, DAngle angle, int kind);
 void P_DrawSplash2 (FLevelLocals *Level, int count, const DVector3 &pos, DAngle angle, int updown, int kind);
+void P_DrawTerrainSplash (FLevelLocals *Level, const DVector3 &pos, FTextureID flat, bool small);
 void P_DisconnectEffect (AActor *actor);
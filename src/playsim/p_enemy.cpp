@@ -108,132 +108,13 @@ double yspeed[8] = {0,SQRTHALF,1,SQRTHALF,0,-SQRTHALF,-1,-SQRTHALF};
 //
 
 
-//----------------------------------------------------------------------------
-//
-// PROC P_RecursiveSound
-//
-// Called by P_NoiseAlert.
-// Traverses adjacent sectors,
-// sound blocking lines cut off traversal.
-//----------------------------------------------------------------------------
-
-struct NoiseTarget
-{
-	sector_t *sec;
-	int soundblocks;
-};
-static TArray<NoiseTarget> NoiseList(128);
-
-static void NoiseMarkSector(sector_t *sec, AActor *soundtarget, bool splash, AActor *emitter, int soundblocks, double maxdist)
-{
-	// wake up all monsters in this sector
-	if (sec->validcount == validcount
-		&& sec->soundtraversed <= soundblocks + 1)
-	{
-		return; 		// already flooded
-	}
-
-	sec->validcount = validcount;
-	sec->soundtraversed = soundblocks + 1;
-	sec->SoundTarget = soundtarget;
-
-	// [RH] Set this in the actors in the sector instead of the sector itself.
-	for (AActor *actor = sec->thinglist; actor != NULL; actor = actor->snext)
-	{
-		if (actor != soundtarget && (!splash || !(actor->flags4 & MF4_NOSPLASHALERT)) &&
-			(!maxdist || (actor->Distance2D(emitter) <= maxdist)))
-		{
-			actor->LastHeard = soundtarget;
-		}
-	}
-	NoiseList.Push({ sec, soundblocks });
-}
-
-
-static void P_RecursiveSound(sector_t *sec, AActor *soundtarget, bool splash, AActor *emitter, int soundblocks, double maxdist)
-{
-	bool checkabove = !sec->PortalBlocksSound(sector_t::ceiling);
-	bool checkbelow = !sec->PortalBlocksSound(sector_t::floor);
-
-	for (auto check : sec->Lines)
-	{
-		// check sector portals
-		// I wish there was a better method to do this than randomly looking through the portal at a few places...
-		if (checkabove)
-		{
-			sector_t *upper = sec->Level->PointInSector(check->v1->fPos() + check->Delta() / 2 + sec->GetPortalDisplacement(sector_t::ceiling));
-			NoiseMarkSector(upper, soundtarget, splash, emitter, soundblocks, maxdist);
-		}
-		if (checkbelow)
-		{
-			sector_t *lower = sec->Level->PointInSector(check->v1->fPos() + check->Delta() / 2 + sec->GetPortalDisplacement(sector_t::floor));
-			NoiseMarkSector(lower, soundtarget, splash, emitter, soundblocks, maxdist);
-		}
-
-		// ... and line portals;
-		FLinePortal *port = check->getPortal();
-		if (port && (port->mFlags & PORTF_SOUNDTRAVERSE))
-		{
-			if (port->mDestination)
-			{
-				NoiseMarkSector(port->mDestination->frontsector, soundtarget, splash, emitter, soundblocks, maxdist);
-			}
-		}
-
-
-		if (check->sidedef[1] == NULL ||
-			!(check->flags & ML_TWOSIDED))
-		{
-			continue;
-		}
-
-		// Early out for intra-sector lines
-		if (check->sidedef[0]->sector == check->sidedef[1]->sector) continue;
-
-		sector_t *other;
-		if (check->sidedef[0]->sector == sec)
-			other = check->sidedef[1]->sector;
-		else
-			other = check->sidedef[0]->sector;
-
-		// check for closed door
-		if ((sec->floorplane.ZatPoint(check->v1->fPos()) >=
-			other->ceilingplane.ZatPoint(check->v1->fPos()) &&
-			sec->floorplane.ZatPoint(check->v2->fPos()) >=
-			other->ceilingplane.ZatPoint(check->v2->fPos()))
-			|| (other->floorplane.ZatPoint(check->v1->fPos()) >=
-				sec->ceilingplane.ZatPoint(check->v1->fPos()) &&
-				other->floorplane.ZatPoint(check->v2->fPos()) >=
-				sec->ceilingplane.ZatPoint(check->v2->fPos()))
-			|| (other->floorplane.ZatPoint(check->v1->fPos()) >=
-				other->ceilingplane.ZatPoint(check->v1->fPos()) &&
-				other->floorplane.ZatPoint(check->v2->fPos()) >=
-				other->ceilingplane.ZatPoint(check->v2->fPos())))
-		{
-			continue;
-		}
-
-		if (check->flags & ML_SOUNDBLOCK)
-		{
-			if (!soundblocks)
-				NoiseMarkSector(other, soundtarget, splash, emitter, 1, maxdist);
-		}
-		else
-		{
-			NoiseMarkSector(other, soundtarget, splash, emitter, soundblocks, maxdist);
-		}
-	}
-}
-
-
-
-
 //----------------------------------------------------------------------------
 //
 // PROC P_NoiseAlert
 //
 // If a monster yells at a player, it will alert other monsters to the
-// player.
+// player. Traverses adjacent sectors, sound blocking lines cut off
+// traversal (see p_soundgraph.cpp).
 //
 //----------------------------------------------------------------------------
 
@@ -245,13 +126,7 @@ void P_NoiseAlert (AActor *emitter, AActor *target, bool splash, double maxdist)
 	if (target != NULL && target->player && (target->player->cheats & CF_NOTARGET))
 		return;
 
-	validcount++;
-	NoiseList.Clear();
-	NoiseMarkSector(emitter->Sector, target, splash, emitter, 0, maxdist);
-	for (unsigned i = 0; i < NoiseList.Size(); i++)
-	{
-		P_RecursiveSound(NoiseList[i].sec, target, splash, emitter, NoiseList[i].soundblocks, maxdist);
-	}
+	emitter->Level->soundgraph.NoiseAlert(emitter, target, splash, maxdist);
 }
 
 //----------------------------------------------------------------------------
@@ -297,7 +172,12 @@ bool AActor::CheckMeleeRange ()
 	return true;				
 }
 
-DEFINE_ACTION_FUNCTION(AActor, CheckMeleeRange)
+static int CheckMeleeRange(AActor *self)
+{
+	return self->CheckMeleeRange();
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, CheckMeleeRange, CheckMeleeRange)
 {
 	PARAM_SELF_PROLOGUE(AActor);
 	ACTION_RETURN_INT(self->CheckMeleeRange());
@@ -359,7 +239,12 @@ bool P_CheckMissileRange (AActor *actor)
 	return actor->SuggestMissileAttack (dist);
 }
 
-DEFINE_ACTION_FUNCTION(AActor, CheckMissileRange)
+static int CheckMissileRange(AActor *self)
+{
+	return P_CheckMissileRange(self);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, CheckMissileRange, CheckMissileRange)
 {
 	PARAM_SELF_PROLOGUE(AActor);
 	ACTION_RETURN_BOOL(P_CheckMissileRange(self));
@@ -1254,13 +1139,15 @@ int P_LookForMonsters (AActor *actor)
 AActor *LookForTIDInBlock (AActor *lookee, int index, void *extparams)
 {
 	FLookExParams *params = (FLookExParams *)extparams;
-	FBlockNode *block;
+	auto &things = lookee->Level->blockmap.blockthings[index];
 	AActor *link;
 	AActor *other;
 	
-	for (block = lookee->Level->blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (unsigned i = things.Size(); i-- > 0; )
 	{
-		link = block->Me;
+		link = things[i].Me;
+		if (link == nullptr)
+			continue;			// unlinked during this tic
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
@@ -1424,14 +1311,16 @@ int P_LookForTID (AActor *actor, INTBOOL allaround, FLookExParams *params)
 
 AActor *LookForEnemiesInBlock (AActor *lookee, int index, void *extparam)
 {
-	FBlockNode *block;
+	auto &things = lookee->Level->blockmap.blockthings[index];
 	AActor *link;
 	AActor *other;
 	FLookExParams *params = (FLookExParams *)extparam;
 	
-	for (block = lookee->Level->blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (unsigned i = things.Size(); i-- > 0; )
 	{
-		link = block->Me;
+		link = things[i].Me;
+		if (link == nullptr)
+			continue;			// unlinked during this tic
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
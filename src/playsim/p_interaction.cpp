@@ -1482,6 +1482,7 @@ static int DoDamageMobj(AActor *target, AActor *inflictor, AActor *source, int d
 {
 	// [ZZ] event handlers need the result.
 	bool needevent = true;
+	if (target != nullptr) target->SleepCount = 0;
 	int realdamage = DamageMobj(target, inflictor, source, damage, mod, flags, angle, needevent);
 	if (realdamage >= 0) //Keep this check separated. Mods relying upon negative numbers may break otherwise.
 		ReactToDamage(target, inflictor, source, realdamage, mod, flags, damage);
@@ -1566,10 +1566,9 @@ bool PIT_CheckThing(FMultiBlockThingsIterator &it, FMultiBlockThingsIterator::Ch
 		{
 			if (!(tm.thing->flags6 & MF6_NOBOSSRIP) || !(thing->flags2 & MF2_BOSS))
 			{
-				bool *check = tm.LastRipped.CheckKey(thing);
-				if (check == NULL || !*check)
+				if (tm.LastRipped.Find(thing) == tm.LastRipped.Size())
 				{
-					tm.LastRipped[thing] = true;
+					tm.LastRipped.Push(thing);
 					if (!(thing->flags & MF_NOBLOOD) &&
 						!(thing->flags2 & MF2_REFLECTIVE) &&
 						!(tm.thing->flags3 & MF3_BLOODLESSIMPACT) &&
@@ -1726,10 +1725,9 @@ bool P_CheckPosition(AActor *thing, const DVector2 &pos, FCheckPosition &tm, boo
 		F3DFloor*  rover;
 		double thingtop = thing->Height > 0 ? thing->Top() : thing->Z() + 1;
 
-		for (unsigned i = 0; i<newsec->e->XFloor.ffloors.Size(); i++)
+		for (unsigned i = 0; i<newsec->e->XFloor.solidffloors.Size(); i++)
 		{
-			rover = newsec->e->XFloor.ffloors[i];
-			if (!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
+			rover = newsec->e->XFloor.solidffloors[i];
 
 			double ff_bottom = rover->bottom.plane->ZatPoint(pos);
 			double ff_top = rover->top.plane->ZatPoint(pos);
@@ -2123,10 +2121,8 @@ static void CheckForPushSpecial(line_t *line, int side, AActor *mobj, DVector2 *
 					}
 				}
 				// we must also check if some 3D floor in the backsector may be blocking
-				for (auto rover : line->backsector->e->XFloor.ffloors)
+				for (auto rover : line->backsector->e->XFloor.solidffloors)
 				{
-					if (!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
-
 					double ff_bottom = rover->bottom.plane->ZatPoint(*posforwindowcheck);
 					double ff_top = rover->top.plane->ZatPoint(*posforwindowcheck);
 
@@ -2682,6 +2678,52 @@ bool P_TryMove(AActor *thing, const DVector2 &pos,
 }
 
 
+//==========================================================================
+//
+// P_IsMoveSweepClear
+//
+// Checks if a missile can cover the given move in one step instead of
+// several ones (see P_XYMovement). This is only the case if the box swept
+// by the entire move touches no line and no other actor and stays in one
+// flat sector without 3D floors, portals or deep water, because then every
+// intermediate P_TryMove would succeed without doing anything else.
+//
+//==========================================================================
+
+bool P_IsMoveSweepClear(AActor *mo, const DVector2 &move)
+{
+	auto Level = mo->Level;
+	auto sec = mo->Sector;
+
+	if (!(mo->flags & MF_MISSILE) || (mo->flags3 & (MF3_FLOORHUGGER | MF3_CEILINGHUGGER))) return false;
+	if (Level->Displacements.size > 1 || (Level->i_compatflags & COMPATF_WALLRUN)) return false;
+	if (sec->heightsec != nullptr || sec->e->XFloor.ffloors.Size() > 0 || sec->floorplane.isSlope() || sec->ceilingplane.isSlope()) return false;
+	if (mo->Z() < sec->floorplane.ZatPoint(mo) || mo->Top() > sec->ceilingplane.ZatPoint(mo)) return false;
+
+	DVector2 start = mo->Pos().XY();
+	FBoundingBox hull = FBoundingBox(start.X, start.Y, mo->radius) | FBoundingBox(start.X + move.X, start.Y + move.Y, mo->radius);
+
+	FBlockLinesIterator lit(Level, hull);
+	line_t *ld;
+	while ((ld = lit.Next()))
+	{
+		if (inRange(hull, ld) && BoxOnLineSide(hull, ld) == -1) return false;
+	}
+
+	FBlockThingsIterator tit(Level, hull);
+	AActor *thing;
+	while ((thing = tit.Next()))
+	{
+		if (thing == mo) continue;
+		if (thing->X() + thing->radius >= hull.Left() && thing->X() - thing->radius <= hull.Right() &&
+			thing->Y() + thing->radius >= hull.Bottom() && thing->Y() - thing->radius <= hull.Top())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 //==========================================================================
 //
 // P_CheckMove
@@ -3198,10 +3240,8 @@ const secplane_t * P_CheckSlopeWalk(AActor *actor, DVector2 &move)
 	const secplane_t *plane = &actor->floorsector->floorplane;
 	double planezhere = plane->ZatPoint(pos);
 
-	for (auto rover : actor->floorsector->e->XFloor.ffloors)
+	for (auto rover : actor->floorsector->e->XFloor.solidffloors)
 	{
-		if (!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
-
 		double thisplanez = rover->top.plane->ZatPoint(pos);
 
 		if (thisplanez > planezhere && thisplanez <= actor->Z() + actor->MaxStepHeight)
@@ -3215,10 +3255,8 @@ const secplane_t * P_CheckSlopeWalk(AActor *actor, DVector2 &move)
 
 	if (actor->floorsector != actor->Sector)
 	{
-		for (auto rover : actor->Sector->e->XFloor.ffloors)
+		for (auto rover : actor->Sector->e->XFloor.solidffloors)
 		{
-			if (!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
-
 			double thisplanez = rover->top.plane->ZatPoint(actor);
 
 			if (thisplanez > planezhere && thisplanez <= actor->Z() + actor->MaxStepHeight)
@@ -4050,25 +4088,25 @@ struct aim_t
 
 				// Crosses a two sided line.
 				// A two sided line will restrict the possible target ranges.
-				FLineOpening open;
-				P_LineOpening(open, NULL, li, it.InterceptPoint(in), (DVector2*)nullptr, FFCF_NODROPOFF);
+				double opentop, openbottom;
+				double openrange = P_LineOpeningHeights(li, it.InterceptPoint(in), opentop, openbottom);
 
 				// The following code assumes that portals on the front of the line have already been processed.
 
-				if (open.range <= 0 || open.bottom >= open.top)
+				if (openrange <= 0 || openbottom >= opentop)
 					return;
 					
 				dist = attackrange * in->frac;
 
-				if (open.bottom != LINEOPEN_MIN)
+				if (openbottom != LINEOPEN_MIN)
 				{
-					pitch = -VecToAngle(dist, open.bottom - shootz);
+					pitch = -VecToAngle(dist, openbottom - shootz);
 					if (pitch < bottompitch) bottompitch = pitch;
 				}
 
-				if (open.top != LINEOPEN_MAX)
+				if (opentop != LINEOPEN_MAX)
 				{
-					pitch = -VecToAngle(dist, open.top - shootz);
+					pitch = -VecToAngle(dist, opentop - shootz);
 					if (pitch > toppitch) toppitch = pitch;
 				}
 
@@ -4086,11 +4124,11 @@ struct aim_t
 				sector_t *exitsec = frontflag ? li->backsector : li->frontsector;
 				lastsector = entersec;
 				// check portal in backsector when aiming up/downward is possible, the line doesn't have portals on both sides and there's actually a portal in the backsector
-				if ((planestocheck & aim_up) && toppitch < 0 && open.top != LINEOPEN_MAX && !entersec->PortalBlocksMovement(sector_t::ceiling))
+				if ((planestocheck & aim_up) && toppitch < 0 && opentop != LINEOPEN_MAX && !entersec->PortalBlocksMovement(sector_t::ceiling))
 				{
 					EnterSectorPortal(sector_t::ceiling, in->frac, entersec, toppitch, MIN<DAngle>(0., bottompitch));
 				}
-				if ((planestocheck & aim_down) && bottompitch > 0 && open.bottom != LINEOPEN_MIN && !entersec->PortalBlocksMovement(sector_t::floor))
+				if ((planestocheck & aim_down) && bottompitch > 0 && openbottom != LINEOPEN_MIN && !entersec->PortalBlocksMovement(sector_t::floor))
 				{
 					EnterSectorPortal(sector_t::floor, in->frac, entersec, MAX<DAngle>(0., toppitch), bottompitch);
 				}
@@ -5865,8 +5903,15 @@ int P_GetRadiusDamage(AActor *self, AActor *thing, int damage, int distance, int
 // P_RadiusAttack
 // Source is the creature that caused the explosion at spot.
 //
+// The candidates of all explosions share one array: damaging a target can
+// cause further explosions before the current one is done, so each call
+// appends its own targets at the end and removes them again when it is
+// done, without allocating anything once the array has grown large enough.
+//
 //==========================================================================
 
+static TArray<AActor*> RadiusTargets;
+
 int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bombdistance, FName bombmod,
 	int flags, int fulldamagedistance)
 {
@@ -5885,7 +5930,7 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 
 	P_GeometryRadiusAttack(bombspot, bombsource, bombdamage, bombdistance, bombmod, fulldamagedistance);
 
-	TArray<AActor*> targets;
+	const unsigned firsttarget = RadiusTargets.Size();
 	int count = 0;
 	while ((it.Next(&cres)))
 	{
@@ -5916,11 +5961,14 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 			)
 			)	continue;
 
-		targets.Push(thing);
+		RadiusTargets.Push(thing);
 	}
 
-	for (AActor *thing : targets)
+	const unsigned lasttarget = RadiusTargets.Size();
+	for (unsigned i = firsttarget; i < lasttarget; i++)
 	{
+		AActor *thing = RadiusTargets[i];
+
 		// Barrels always use the original code, since this makes
 		// them far too "active." BossBrains also use the old code
 		// because some user levels require they have a height of 16,
@@ -6003,6 +6051,7 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 			}
 		}
 	}
+	RadiusTargets.Clamp(firsttarget);
 	return count;
 }
 
@@ -6629,6 +6678,8 @@ bool P_ChangeSector(sector_t *sector, int crunch, double amt, int floorOrCeil, b
 	void(*iterator2)(AActor *, FChangePosition *) = NULL;
 	msecnode_t *n;
 
+	P_InvalidateSightCache();
+
 	cpos.nofit = false;
 	cpos.crushchange = crunch;
 	cpos.moveamt = fabs(amt);
@@ -268,6 +268,48 @@ void P_LineOpening (FLineOpening &open, AActor *actor, const line_t *linedef, co
 	open.range = clamp(open.top - open.bottom, LINEOPEN_MIN, LINEOPEN_MAX);
 }
 
+//==========================================================================
+//
+// P_LineOpeningHeights
+//
+// Only the heights P_LineOpening calculates when called without an actor,
+// reference point and dropoff check, which is all that hitscan aiming
+// needs. This skips looking up textures and terrain and copying the
+// floor planes for every line an aim trace crosses.
+// Returns the range of the opening, which is 0 for one-sided lines.
+//
+//==========================================================================
+
+double P_LineOpeningHeights(const line_t *linedef, const DVector2 &pos, double &top, double &bottom)
+{
+	if (linedef->backsector == NULL)
+	{
+		// single sided line
+		return 0;
+	}
+
+	sector_t *front = linedef->frontsector;
+	sector_t *back = linedef->backsector;
+	double fc = 0, ff = 0, bc = 0, bf = 0;
+
+	if (linedef->flags & ML_PORTALCONNECT)
+	{
+		if (!front->PortalBlocksMovement(sector_t::ceiling)) fc = LINEOPEN_MAX;
+		if (!back->PortalBlocksMovement(sector_t::ceiling)) bc = LINEOPEN_MAX;
+		if (!front->PortalBlocksMovement(sector_t::floor)) ff = LINEOPEN_MIN;
+		if (!back->PortalBlocksMovement(sector_t::floor)) bf = LINEOPEN_MIN;
+	}
+
+	if (fc == 0) fc = front->ceilingplane.ZatPoint(pos);
+	if (bc == 0) bc = back->ceilingplane.ZatPoint(pos);
+	if (ff == 0) ff = front->floorplane.ZatPoint(pos);
+	if (bf == 0) bf = back->floorplane.ZatPoint(pos);
+
+	top = fc < bc ? fc : bc;
+	bottom = ff > bf ? ff : bf;
+	return clamp(top - bottom, LINEOPEN_MIN, LINEOPEN_MAX);
+}
+
 
 //
 // THING POSITION SETTING
@@ -335,11 +377,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 
 		while (block != NULL)
 		{
-			if (block->NextActor != NULL)
-			{
-				block->NextActor->PrevActor = block->PrevActor;
-			}
-			*(block->PrevActor) = block->NextActor;
+			Level->blockmap.UnlinkThing(block);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -535,16 +573,10 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 				{
 					for (int x = x1; x <= x2; ++x)
 					{
-						FBlockNode **link = &Level->blockmap.blocklinks[y*Level->blockmap.bmapwidth + x];
 						FBlockNode *node = FBlockNode::Create(this, x, y, this->Sector->PortalGroup);
 
 						// Link in to block
-						if ((node->NextActor = *link) != NULL)
-						{
-							(*link)->PrevActor = &node->NextActor;
-						}
-						node->PrevActor = link;
-						*link = node;
+						Level->blockmap.LinkThing(node);
 
 						// Link in to actor
 						node->PrevBlock = alink;
@@ -895,7 +927,8 @@ FBlockThingsIterator::FBlockThingsIterator(FLevelLocals *l)
 	minx = maxx = 0;
 	miny = maxy = 0;
 	ClearHash();
-	block = NULL;
+	block = -1;
+	blockpos = 0;
 }
 
 FBlockThingsIterator::FBlockThingsIterator(FLevelLocals *l, int _minx, int _miny, int _maxx, int _maxy)
@@ -945,12 +978,14 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 	cury = y;
 	if (Level->blockmap.isValidBlock(x, y))
 	{
-		block = Level->blockmap.blocklinks[y*Level->blockmap.bmapwidth + x];
+		block = y*Level->blockmap.bmapwidth + x;
+		blockpos = Level->blockmap.blockthings[block].Size();
 	}
 	else
 	{
 		// invalid block
-		block = NULL;
+		block = -1;
+		blockpos = 0;
 	}
 }
 
@@ -975,16 +1010,27 @@ void FBlockThingsIterator::SwitchBlock(int x, int y)
 
 AActor *FBlockThingsIterator::Next(bool centeronly)
 {
+	// Script side iterators can survive a compaction of the blockmap so make sure not to run past the end.
+	if (block >= 0 && blockpos > Level->blockmap.blockthings[block].Size())
+	{
+		blockpos = Level->blockmap.blockthings[block].Size();
+	}
 	for (;;)
 	{
-		while (block != NULL)
+		// The array must be accessed by index because it may grow while the caller processes a returned actor.
+		// Anything linked in the meantime lies past the starting position and will not be returned.
+		while (blockpos > 0)
 		{
-			AActor *me = block->Me;
-			FBlockNode *mynode = block;
+			const FBlockThing &thing = Level->blockmap.blockthings[block][--blockpos];
+			AActor *me = thing.Me;
+			FBlockNode *mynode = thing.Node;
 			HashEntry *entry;
 			int i;
 
-			block = block->NextActor;
+			if (me == nullptr)
+			{
+				continue;
+			}
 			// Don't recheck things that were already checked
 			if (mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode)
 			{ // This actor doesn't span blocks, so we know it can only ever be checked once.
@@ -1053,6 +1099,38 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 
 
 
+//===========================================================================
+//
+// FBlockmap :: Compact
+//
+// Removes the holes unlinked actors left in the thing arrays. This
+// invalidates all positions in these arrays so it may only be called
+// while nothing is iterating over the blockmap and no player prediction
+// is active.
+//
+//===========================================================================
+
+void FBlockmap::Compact()
+{
+	for (auto index : dirtyblocks)
+	{
+		auto &things = blockthings[index];
+		unsigned count = 0;
+
+		for (unsigned i = 0; i < things.Size(); i++)
+		{
+			if (things[i].Me != nullptr)
+			{
+				things[i].Node->Slot = count;
+				things[count++] = things[i];
+			}
+		}
+		things.Clamp(count);
+		blockdirty[index] = false;
+	}
+	dirtyblocks.Clear();
+}
+
 //===========================================================================
 //
 // FMultiBlockThingsIterator :: FMultiBlockThingsIterator
@@ -1163,6 +1241,28 @@ void FMultiBlockThingsIterator::Reset()
 
 TArray<intercept_t> FPathTraverse::intercepts(128);
 
+//===========================================================================
+//
+// FPathTraverse :: AddIntercept
+//
+// Inserts an intercept into the list, sorted by fraction. Equal fractions
+// stay in the order they were found in, which is the order the old
+// repeated minimum search in Next returned them in. The blocks get
+// stepped through in trace order, so new entries almost always belong
+// at the end, or very close to it.
+//
+//===========================================================================
+
+void FPathTraverse::AddIntercept(const intercept_t &newintercept)
+{
+	unsigned pos = intercepts.Size();
+	while (pos > intercept_index && intercepts[pos - 1].frac > newintercept.frac)
+	{
+		pos--;
+	}
+	intercepts.Insert(pos, newintercept);
+}
+
 
 //===========================================================================
 //
@@ -1205,7 +1305,7 @@ void FPathTraverse::AddLineIntercepts(int bx, int by)
 		newintercept.isaline = true;
 		newintercept.done = false;
 		newintercept.d.line = ld;
-		intercepts.Push (newintercept);
+		AddIntercept(newintercept);
 	}
 }
 
@@ -1314,7 +1414,7 @@ void FPathTraverse::AddThingIntercepts (int bx, int by, FBlockThingsIterator &it
 					newintercept.isaline = false;
 					newintercept.done = false;
 					newintercept.d.thing = thing;
-					intercepts.Push (newintercept);
+					AddIntercept(newintercept);
 					break;
 				}
 			}
@@ -1328,7 +1428,7 @@ void FPathTraverse::AddThingIntercepts (int bx, int by, FBlockThingsIterator &it
 				newintercept.isaline = false;
 				newintercept.done = false;
 				newintercept.d.thing = thing;
-				intercepts.Push (newintercept);
+				AddIntercept(newintercept);
 			}
 		}
 		else
@@ -1378,7 +1478,7 @@ void FPathTraverse::AddThingIntercepts (int bx, int by, FBlockThingsIterator &it
 					newintercept.isaline = false;
 					newintercept.done = false;
 					newintercept.d.thing = thing;
-					intercepts.Push (newintercept);
+					AddIntercept(newintercept);
 				}
 			}
 		}
@@ -1394,20 +1494,11 @@ void FPathTraverse::AddThingIntercepts (int bx, int by, FBlockThingsIterator &it
 
 intercept_t *FPathTraverse::Next()
 {
-	intercept_t *in = NULL;
+	if (intercept_next >= intercepts.Size()) return NULL;
 
-	double dist = FLT_MAX;
-	for (unsigned scanpos = intercept_index; scanpos < intercepts.Size (); scanpos++)
-	{
-		intercept_t *scan = &intercepts[scanpos];
-		if (scan->frac < dist && !scan->done)
-		{
-			dist = scan->frac;
-			in = scan;
-		}
-	}
-	
-	if (dist > 1. || in == NULL) return NULL;	// checked everything in range			
+	intercept_t *in = &intercepts[intercept_next];
+	if (in->frac > 1.) return NULL;	// checked everything in range
+	intercept_next++;
 	in->done = true;
 	return in;
 }
@@ -1459,7 +1550,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 	}
 
 	validcount++;
-	intercept_index = intercepts.Size();
+	intercept_index = intercept_next = intercepts.Size();
 	Startfrac = startfrac;
 
 	if (flags & PT_DELTA)
@@ -1796,23 +1887,24 @@ static AActor *RoughBlockCheck (AActor *mo, int index, void *param)
 {
 	BlockCheckInfo *info = (BlockCheckInfo *)param;
 
-	FBlockNode *link;
+	auto &things = mo->Level->blockmap.blockthings[index];
 
-	for (link = mo->Level->blockmap.blocklinks[index]; link != NULL; link = link->NextActor)
+	for (unsigned i = things.Size(); i-- > 0; )
 	{
-		if (link->Me != mo)
+		AActor *link = things[i].Me;
+		if (link != nullptr && link != mo)
 		{
-			if (info->onlyseekable && !mo->CanSeek(link->Me))
+			if (info->onlyseekable && !mo->CanSeek(link))
 			{
 				continue;
 			}
-			if (info->frontonly && P_PointOnDivlineSide(link->Me->X(), link->Me->Y(), &info->frontline) != 0)
+			if (info->frontonly && P_PointOnDivlineSide(link->X(), link->Y(), &info->frontline) != 0)
 			{
 				continue;
 			}
-			if (mo->IsOkayToAttack (link->Me))
+			if (mo->IsOkayToAttack (link))
 			{
-				return link->Me;
+				return link;
 			}
 		}
 	}
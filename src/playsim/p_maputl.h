@@ -125,6 +125,7 @@ inline void P_LineOpening(FLineOpening &open, AActor *thing, const line_t *lined
 {
 	P_LineOpening(open, thing, linedef, xy, reinterpret_cast<const DVector2*>(ref), flags);
 }
+double P_LineOpeningHeights(const line_t *linedef, const DVector2 &xy, double &top, double &bottom);
 
 class FBoundingBox;
 struct polyblock_t;
@@ -286,7 +287,8 @@ class FBlockThingsIterator
 
 	int curx, cury;
 
-	FBlockNode *block;
+	int block;
+	unsigned blockpos;
 
 	int Buckets[32];
 
@@ -370,7 +372,9 @@ protected:
 	unsigned int intercept_index;
 	unsigned int intercept_count;
 	unsigned int count;
+	unsigned int intercept_next;	// the intercepts are kept sorted, so Next only has to advance this.
 
+	void AddIntercept(const intercept_t &newintercept);
 	virtual void AddLineIntercepts(int bx, int by);
 	virtual void AddThingIntercepts(int bx, int by, FBlockThingsIterator &it, bool compatible);
 	FPathTraverse(FLevelLocals *l) 
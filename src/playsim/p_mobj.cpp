@@ -151,6 +151,10 @@ CUSTOM_CVAR (Float, sv_gravity, 800.f, CVAR_SERVERINFO|CVAR_NOSAVE|CVAR_NOINITCA
 	}
 }
 
+CVARD(Bool, sv_actorsleep, false, CVAR_ARCHIVE|CVAR_SERVERINFO, "idle monsters at rest only count down their state tics instead of running a full tick")
+CVARD(Bool, sv_sweptmissiles, false, CVAR_ARCHIVE|CVAR_SERVERINFO, "fast missiles with nothing in their way move in one step instead of several small ones")
+CVARD(Bool, sv_particlesplashes, false, CVAR_ARCHIVE|CVAR_SERVERINFO, "non-player things landing in liquids splash with particles instead of spawning splash actors")
+
 CVAR (Bool, cl_missiledecals, true, CVAR_ARCHIVE)
 CVAR (Bool, addrocketexplosion, false, CVAR_ARCHIVE)
 CVAR (Int, cl_pufftype, 0, CVAR_ARCHIVE);
@@ -226,6 +230,7 @@ void AActor::Serialize(FSerializer &arc)
 		A("ppassheight", projectilepassheight)
 		A("vel", Vel)
 		A("tics", tics)
+		A("sleepcount", SleepCount)
 		A("state", state)
 		A("damage", DamageVal)
 		A("projectilekickback", projectileKickback)
@@ -403,6 +408,11 @@ void AActor::PostSerialize()
 	}
 	ClearInterpolation();
 	UpdateWaterLevel(false);
+	// The pending light queue is not archived, so rebuild it from the flag.
+	if (flags8 & MF8_RECREATELIGHTS)
+	{
+		RequestLightUpdate();
+	}
 }
 
 
@@ -580,7 +590,7 @@ bool AActor::SetState (FState *newstate, bool nofunction)
 		newstate = newstate->GetNextState();
 	} while (tics == 0);
 
-	flags8 |= MF8_RECREATELIGHTS;
+	RequestLightUpdate();
 	return true;
 }
 
@@ -1929,6 +1939,14 @@ double P_XYMovement (AActor *mo, DVector2 scroll)
 		}
 	}
 
+	// If nothing at all is in a missile's way, the small steps cannot hit anything,
+	// so move it in one. The end point is calculated exactly like the last step's.
+	if (steps > 1 && sv_sweptmissiles && P_IsMoveSweepClear(mo, move))
+	{
+		move = move * steps / steps;
+		steps = 1;
+	}
+
 	// P_SlideMove needs to know the step size before P_CheckSlopeWalk
 	// because it also calls P_CheckSlopeWalk on its clipped steps.
 	DVector2 onestep = startmove / steps;
@@ -3532,6 +3550,26 @@ void AActor::Tick ()
 		return;
 	}
 
+	// An idle monster that has been at rest for a while gets put to sleep: all the
+	// movement and sector code would do nothing for it, so only the state countdown
+	// needs to run until the next state change, which always gets a full tick.
+	if (sv_actorsleep && CanSleep())
+	{
+		if (SleepCount < ACTORSLEEP_DELAY)
+		{
+			SleepCount++;
+		}
+		else if (tics > 1)
+		{
+			tics--;
+			return;
+		}
+	}
+	else
+	{
+		SleepCount = 0;
+	}
+
 	if (flags5 & MF5_NOINTERACTION)
 	{
 		// only do the minimally necessary things here to save time:
@@ -4078,6 +4116,43 @@ void AActor::Tick ()
 	}
 }
 
+//==========================================================================
+//
+// AActor :: CanSleep
+//
+// Checks whether a tick would do nothing but count down the state tics:
+// an idle, living monster standing still on flat ground (or hovering)
+// with no scriptable per-tic behavior. Tick still runs in full whenever
+// a state change is due.
+// Anything that wakes it up (damage, a new target, being pushed, a floor
+// moving away, a state change from outside) breaks one of these conditions,
+// so this gets checked again on every tic.
+//
+//==========================================================================
+
+bool AActor::CanSleep()
+{
+	static unsigned VIndex = ~0u;
+	if (VIndex == ~0u)
+	{
+		VIndex = GetVirtualIndex(RUNTIME_CLASS(AActor), "Tick");
+		assert(VIndex != ~0u);
+	}
+
+	if (player != nullptr || target != nullptr || Inventory != nullptr || health <= 0) return false;
+	if (!(flags3 & MF3_ISMONSTER) || !Vel.isZero() || effects != 0 || PoisonDurationReceived != 0) return false;
+	if ((flags & (MF_CORPSE | MF_SKULLFLY | MF_STEALTH | MF_UNMORPHED)) || (flags2 & (MF2_FLOATBOB | MF2_BLASTED))) return false;
+	if ((flags4 & MF4_VFRICTION) || (flags5 & (MF5_NOINTERACTION | MF5_ALWAYSRESPAWN)) || (flags6 & MF6_KILLED)) return false;
+	if ((flags7 & MF7_HANDLENODELAY) || (flags8 & MF8_INSCROLLSEC)) return false;
+	if (Z() != floorz && (!(flags & MF_NOGRAVITY) || Z() < floorz || Top() > ceilingz)) return false;
+	if (Sector->GetHeightSec() != nullptr || Sector->e->XFloor.ffloors.Size() > 0) return false;
+	if (floorsector != nullptr && floorsector->floorplane.isSlope()) return false;
+	if (Level->BotInfo.botnum > 0 || isFrozen()) return false;
+
+	auto clss = GetClass();
+	return clss->Virtuals.Size() > VIndex && clss->Virtuals[VIndex] == RUNTIME_CLASS(AActor)->Virtuals[VIndex];
+}
+
 //==========================================================================
 //
 // AActor :: CheckNoDelay
@@ -4721,7 +4796,7 @@ void AActor::PostBeginPlay ()
 {
 	PrevAngles = Angles;
 	flags7 |= MF7_HANDLENODELAY;
-	flags8 |= MF8_RECREATELIGHTS;
+	RequestLightUpdate();
 }
 
 void AActor::CallPostBeginPlay()
@@ -4851,6 +4926,10 @@ void AActor::OnDestroy ()
 	}
 
 	DeleteAttachedLights();
+	if (Level != nullptr && (unsigned)LightUpdateIndex < Level->LightUpdates.Size() && Level->LightUpdates[LightUpdateIndex] == this)
+	{
+		Level->LightUpdates[LightUpdateIndex] = nullptr;
+	}
 	ClearRenderSectorList();
 	ClearRenderLineList();
 
@@ -6078,6 +6157,7 @@ bool P_HitWater (AActor * thing, sector_t * sec, const DVector3 &pos, bool check
 	AActor *mo = NULL;
 	FSplashDef *splash;
 	int terrainnum;
+	FTextureID flat;
 	sector_t *hsec = NULL;
 	
 	// don't splash above the object
@@ -6119,6 +6199,7 @@ bool P_HitWater (AActor * thing, sector_t * sec, const DVector3 &pos, bool check
 				if ((rover->flags & (FF_SOLID | FF_SWIMMABLE)) || rover->alpha > 0)
 				{
 					terrainnum = rover->model->GetTerrain(rover->top.isceiling);
+					flat = rover->model->GetTexture(rover->top.isceiling);
 					goto foundone;
 				}
 			}
@@ -6130,10 +6211,12 @@ bool P_HitWater (AActor * thing, sector_t * sec, const DVector3 &pos, bool check
 	if (force || hsec == NULL || !(hsec->MoreFlags & SECMF_CLIPFAKEPLANES))
 	{
 		terrainnum = sec->GetTerrain(sector_t::floor);
+		flat = sec->GetTexture(sector_t::floor);
 	}
 	else
 	{
 		terrainnum = hsec->GetTerrain(sector_t::floor);
+		flat = hsec->GetTexture(sector_t::floor);
 	}
 foundone:
 
@@ -6169,7 +6252,12 @@ foundone:
 
 	if (!(thing->flags3 & MF3_DONTSPLASH))
 	{
-		if (smallsplash && splash->SmallSplash)
+		if (sv_particlesplashes && !thing->player)
+		{
+			// Rain and debris can land in liquids many times per tic, so skip the actors.
+			P_DrawTerrainSplash(sec->Level, pos, flat, smallsplash && splash->SmallSplash);
+		}
+		else if (smallsplash && splash->SmallSplash)
 		{
 			mo = Spawn(sec->Level, splash->SmallSplash, pos, ALLOW_REPLACE);
 			if (mo) mo->Floorclip += splash->SmallSplashClip;
@@ -6526,7 +6614,12 @@ AActor *P_SpawnMissileXYZ (DVector3 pos, AActor *source, AActor *dest, PClassAct
 	return (!checkspawn || P_CheckMissileSpawn (th, source->radius)) ? th : NULL;
 }
 
-DEFINE_ACTION_FUNCTION(AActor, SpawnMissileXYZ)
+static AActor *SpawnMissileXYZ(AActor *self, double x, double y, double z, AActor *dest, PClassActor *type, bool check, AActor *owner)
+{
+	return P_SpawnMissileXYZ(DVector3(x, y, z), self, PARAM_NULLCHECK(dest, dest), type, check, owner);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, SpawnMissileXYZ, SpawnMissileXYZ)
 {
 	PARAM_SELF_PROLOGUE(AActor);
 	PARAM_FLOAT(x);
@@ -6548,7 +6641,12 @@ AActor *P_SpawnMissile(AActor *source, AActor *dest, PClassActor *type, AActor *
 	return P_SpawnMissileXYZ(source->PosPlusZ(32 + source->GetBobOffset()), source, dest, type, true, owner);
 }
 
-DEFINE_ACTION_FUNCTION(AActor, SpawnMissile)
+static AActor *SpawnMissile(AActor *self, AActor *dest, PClassActor *type, AActor *owner)
+{
+	return P_SpawnMissile(self, PARAM_NULLCHECK(dest, dest), type, owner);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, SpawnMissile, SpawnMissile)
 {
 	PARAM_SELF_PROLOGUE(AActor);
 	PARAM_OBJECT_NOT_NULL(dest, AActor);
@@ -6566,7 +6664,12 @@ AActor *P_SpawnMissileZ(AActor *source, double z, AActor *dest, PClassActor *typ
 	return P_SpawnMissileXYZ(source->PosAtZ(z), source, dest, type);
 }
 
-DEFINE_ACTION_FUNCTION(AActor, SpawnMissileZ)
+static AActor *SpawnMissileZ(AActor *self, double z, AActor *dest, PClassActor *type)
+{
+	return P_SpawnMissileZ(self, z, PARAM_NULLCHECK(dest, dest), type);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, SpawnMissileZ, SpawnMissileZ)
 {
 	PARAM_SELF_PROLOGUE(AActor);
 	PARAM_FLOAT(z);
@@ -6714,7 +6817,12 @@ AActor *P_SpawnMissileAngleZSpeed (AActor *source, double z,
 	return (!checkspawn || P_CheckMissileSpawn(mo, source->radius)) ? mo : NULL;
 }
 
-DEFINE_ACTION_FUNCTION(AActor, SpawnMissileAngleZSpeed)
+static AActor *SpawnMissileAngleZSpeed(AActor *self, double z, PClassActor *type, double angle, double vz, double speed, AActor *owner, bool checkspawn)
+{
+	return P_SpawnMissileAngleZSpeed(self, z, type, DAngle(angle), vz, speed, owner, checkspawn);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, SpawnMissileAngleZSpeed, SpawnMissileAngleZSpeed)
 {
 	PARAM_SELF_PROLOGUE(AActor);
 	PARAM_FLOAT(z);
@@ -0,0 +1,241 @@
+//
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2026 The GZDoom team
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** p_navigation.cpp
+** Section based navigation graph and flow field path finding
+**
+*/
+
+#include <queue>
+#include <float.h>
+#include "g_levellocals.h"
+#include "p_navigation.h"
+#include "actor.h"
+#include "vm.h"
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FNavGraph::Clear()
+{
+	Level = nullptr;
+	Edges.Reset();
+	FirstEdge.Reset();
+	for (auto &field : Fields)
+	{
+		field.goal = field.time = -1;
+		field.next.Reset();
+	}
+	NextField = 0;
+	Built = false;
+}
+
+//==========================================================================
+//
+// The graph only gets built once something actually asks for a path,
+// so that maps which never use it do not pay for it.
+//
+//==========================================================================
+
+void FNavGraph::Build(FLevelLocals *l)
+{
+	Level = l;
+	Built = true;
+
+	auto &sections = Level->sections;
+	unsigned numsections = sections.allSections.Size();
+
+	TArray<int> edgeForLine(sections.allLines.Size(), true);
+	TArray<int> partnerLine;
+	for (auto &e : edgeForLine) e = -1;
+
+	FirstEdge.Resize(numsections + 1);
+	for (unsigned i = 0; i < numsections; i++)
+	{
+		auto &section = sections.allSections[i];
+		FirstEdge[i] = Edges.Size();
+
+		DVector2 center((section.bounds.left + section.bounds.right) * 0.5, (section.bounds.top + section.bounds.bottom) * 0.5);
+		for (auto &seg : section.segments)
+		{
+			if (seg.partner == nullptr || seg.partner->section == nullptr || seg.partner->section == &section) continue;
+
+			auto other = seg.partner->section;
+			DVector2 othercenter((other->bounds.left + other->bounds.right) * 0.5, (other->bounds.top + other->bounds.bottom) * 0.5);
+			DVector2 mid = (seg.start->fPos() + seg.end->fPos()) * 0.5;
+
+			FNavEdge edge;
+			edge.from = i;
+			edge.to = sections.SectionIndex(other);
+			edge.reverse = -1;
+			edge.line = seg.sidedef ? seg.sidedef->linedef : nullptr;
+			edge.mid = mid;
+			edge.cost = (mid - center).Length() + (othercenter - mid).Length();
+			edgeForLine[int(&seg - sections.allLines.Data())] = Edges.Push(edge);
+			partnerLine.Push(int(seg.partner - sections.allLines.Data()));
+		}
+	}
+	FirstEdge[numsections] = Edges.Size();
+
+	for (unsigned i = 0; i < Edges.Size(); i++)
+	{
+		Edges[i].reverse = edgeForLine[partnerLine[i]];
+	}
+}
+
+//==========================================================================
+//
+// Checks if the given boundary can be crossed in the edge's direction.
+//
+//==========================================================================
+
+bool FNavGraph::CanPass(const FNavEdge &edge, const FNavParams &params) const
+{
+	if (edge.line != nullptr && (edge.line->flags & params.blockmask)) return false;
+
+	auto front = Level->sections.allSections[edge.from].sector;
+	auto back = Level->sections.allSections[edge.to].sector;
+
+	double frontfloor = front->floorplane.ZatPoint(edge.mid);
+	double backfloor = back->floorplane.ZatPoint(edge.mid);
+	double top = MIN(front->ceilingplane.ZatPoint(edge.mid), back->ceilingplane.ZatPoint(edge.mid));
+
+	if (top - MAX(frontfloor, backfloor) < params.height) return false;
+	if (backfloor - frontfloor > params.stepup) return false;
+	if (frontfloor - backfloor > params.dropdown) return false;
+	return true;
+}
+
+//==========================================================================
+//
+// Returns the flow field toward the given section. A field is only valid
+// for the tic it got calculated in because the map geometry may change.
+//
+//==========================================================================
+
+FNavGraph::FNavField *FNavGraph::GetField(int goal, const FNavParams &params)
+{
+	for (auto &field : Fields)
+	{
+		if (field.goal == goal && field.time == Level->maptime && field.params == params) return &field;
+	}
+
+	auto &field = Fields[NextField];
+	if (++NextField == MAX_FIELDS) NextField = 0;
+
+	unsigned numsections = Level->sections.allSections.Size();
+	field.goal = goal;
+	field.time = Level->maptime;
+	field.params = params;
+	field.next.Resize(numsections);
+	for (auto &n : field.next) n = -1;
+
+	// Dijkstra's algorithm, going backward from the goal.
+	TArray<double> dist(numsections, true);
+	for (auto &d : dist) d = DBL_MAX;
+
+	using QueueEntry = std::pair<double, int>;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+	dist[goal] = 0;
+	queue.push({ 0., goal });
+
+	while (!queue.empty())
+	{
+		double d = queue.top().first;
+		int section = queue.top().second;
+		queue.pop();
+		if (d > dist[section]) continue;
+
+		for (int i = FirstEdge[section]; i < FirstEdge[section + 1]; i++)
+		{
+			int r = Edges[i].reverse;
+			if (r < 0) continue;
+			auto &edge = Edges[r];
+			if (d + edge.cost >= dist[edge.from] || !CanPass(edge, params)) continue;
+
+			dist[edge.from] = d + edge.cost;
+			field.next[edge.from] = r;
+			queue.push({ dist[edge.from], edge.from });
+		}
+	}
+	return &field;
+}
+
+//==========================================================================
+//
+// Gets the next point the actor should head for to get to the goal.
+// Returns false if there's no known path.
+//
+//==========================================================================
+
+bool FNavGraph::NextWaypoint(AActor *mo, const DVector2 &goal, DVector2 &waypoint)
+{
+	if (!Built) Build(mo->Level);
+	if (Edges.Size() == 0) return false;
+
+	auto startsection = Level->PointInRenderSubsector(mo->Pos().XY())->section;
+	auto goalsection = Level->PointInRenderSubsector(goal)->section;
+	if (startsection == nullptr || goalsection == nullptr) return false;
+
+	if (startsection == goalsection)
+	{
+		waypoint = goal;
+		return true;
+	}
+
+	FNavParams params;
+	params.blockmask = ML_BLOCKING | ML_BLOCKEVERYTHING;
+	if (!(mo->flags3 & MF3_NOBLOCKMONST) && !((Level->i_compatflags & COMPATF_NOBLOCKFRIENDS) && (mo->flags & MF_FRIENDLY))) params.blockmask |= ML_BLOCKMONSTERS;
+	if (mo->player != nullptr || (mo->flags8 & MF8_BLOCKASPLAYER)) params.blockmask |= ML_BLOCK_PLAYERS;
+	if (mo->flags & MF_FLOAT) params.blockmask |= ML_BLOCK_FLOATERS;
+	params.height = mo->Height;
+	params.stepup = (mo->flags & (MF_FLOAT | MF_NOGRAVITY)) ? DBL_MAX : mo->MaxStepHeight;
+	params.dropdown = (mo->flags & (MF_FLOAT | MF_NOGRAVITY | MF_DROPOFF)) ? DBL_MAX : mo->MaxDropOffHeight;
+
+	auto field = GetField(Level->sections.SectionIndex(goalsection), params);
+	int edge = field->next[Level->sections.SectionIndex(startsection)];
+	if (edge < 0) return false;
+	waypoint = Edges[edge].mid;
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+DEFINE_ACTION_FUNCTION(AActor, FindPathWaypoint)
+{
+	PARAM_SELF_PROLOGUE(AActor);
+	PARAM_FLOAT(x);
+	PARAM_FLOAT(y);
+
+	DVector2 waypoint(x, y);
+	bool res = self->Level->navgraph.NextWaypoint(self, DVector2(x, y), waypoint);
+	if (numret > 1) ret[1].SetVector2(waypoint);
+	if (numret > 0) ret[0].SetInt(res);
+	return numret;
+}
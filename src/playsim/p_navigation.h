@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include "tarray.h"
+#include "vectors.h"
+
+struct FLevelLocals;
+struct line_t;
+class AActor;
+
+//==========================================================================
+//
+// Coarse navigation graph for path finding.
+//
+// The nodes are the map's sections and the edges are the two-sided
+// boundaries between them. Paths get calculated as flow fields toward
+// a goal section, so that all actors of the same kind heading toward
+// the same goal in the same tic share a single search.
+//
+// Passability is only checked against the sectors' main planes at the
+// boundary, so this is a guide for movement, not a substitute for
+// P_TryMove.
+//
+//==========================================================================
+
+class FNavGraph
+{
+	struct FNavEdge
+	{
+		int from, to;			// section indices
+		int reverse;			// the edge going the opposite direction
+		line_t *line;			// nullptr for boundaries between sections that aren't separated by a linedef
+		DVector2 mid;
+		double cost;			// distance from the first section's center via the boundary to the second section's center
+	};
+
+	struct FNavParams
+	{
+		uint32_t blockmask;
+		double height;
+		double stepup;
+		double dropdown;
+
+		bool operator==(const FNavParams &other) const
+		{
+			return blockmask == other.blockmask && height == other.height && stepup == other.stepup && dropdown == other.dropdown;
+		}
+	};
+
+	struct FNavField
+	{
+		FNavParams params;
+		int goal = -1;
+		int time = -1;
+		TArray<int> next;		// for each section the edge to take toward the goal, or -1 if it cannot be reached
+	};
+
+	enum
+	{
+		MAX_FIELDS = 16
+	};
+
+	FLevelLocals *Level = nullptr;
+	TArray<FNavEdge> Edges;
+	TArray<int> FirstEdge;		// edges are ordered by their starting section, this has one extra entry at the end.
+	FNavField Fields[MAX_FIELDS];
+	unsigned NextField = 0;
+	bool Built = false;
+
+	void Build(FLevelLocals *Level);
+	bool CanPass(const FNavEdge &edge, const FNavParams &params) const;
+	FNavField *GetField(int goal, const FNavParams &params);
+
+public:
+	void Clear();
+	bool NextWaypoint(AActor *mo, const DVector2 &goal, DVector2 &waypoint);
+};
@@ -211,6 +211,41 @@ void P_DelSeclist(portnode_t *node, portnode_t *FLinePortal::*sechead)
 }
 
 
+//=============================================================================
+//
+// P_BoxInsideSubsector
+//
+// Checks if a box lies completely inside a subsector with at least one map
+// unit to spare on every side. The render subsectors are convex and closed,
+// and no linedef can pass through their interior, so no line can cross a
+// box like this. Polyobject lines are not part of the nodes, so maps that
+// have polyobjects never take this path.
+//
+//=============================================================================
+
+static bool P_BoxInsideSubsector(const FBoundingBox &box, const subsector_t *sub)
+{
+	if (sub == nullptr || sub->numlines < 3) return false;
+
+	for (unsigned i = 0; i < sub->numlines; i++)
+	{
+		const seg_t *seg = &sub->firstline[i];
+		DVector2 v1 = seg->v1->fPos();
+		DVector2 delta = seg->v2->fPos() - v1;
+		double margin = delta.Length();
+
+		// the interior is on the seg's front side.
+		if ((box.Left() - v1.X) * delta.Y - (box.Top() - v1.Y) * delta.X <= margin ||
+			(box.Right() - v1.X) * delta.Y - (box.Top() - v1.Y) * delta.X <= margin ||
+			(box.Left() - v1.X) * delta.Y - (box.Bottom() - v1.Y) * delta.X <= margin ||
+			(box.Right() - v1.X) * delta.Y - (box.Bottom() - v1.Y) * delta.X <= margin)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 //=============================================================================
 // phares 3/14/98
 //
@@ -237,32 +272,42 @@ msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector
 	}
 
 	FBoundingBox box(thing->X(), thing->Y(), radius);
-	FBlockLinesIterator it(thing->Level, box);
-	line_t *ld;
 
-	while ((ld = it.Next()))
+	// If the box does not leave the thing's subsector, no line can cross it and the only sector
+	// it touches is its own. This is the common case of an actor moving around in open space,
+	// and skipping the blockmap walk still produces the very same list.
+	bool inside = thing->subsector != nullptr && thing->subsector->sector == thing->Sector &&
+		thing->Level->Polyobjects.Size() == 0 && P_BoxInsideSubsector(box, thing->subsector);
+
+	if (!inside)
 	{
-		if (!inRange(box, ld) || BoxOnLineSide(box, ld) != -1)
-			continue;
+		FBlockLinesIterator it(thing->Level, box);
+		line_t *ld;
+
+		while ((ld = it.Next()))
+		{
+			if (!inRange(box, ld) || BoxOnLineSide(box, ld) != -1)
+				continue;
 
-		// This line crosses through the object.
+			// This line crosses through the object.
 
-		// Collect the sector(s) from the line and add to the
-		// sector_list you're examining. If the Thing ends up being
-		// allowed to move to this position, then the sector_list
-		// will be attached to the Thing's AActor at touching_sectorlist.
+			// Collect the sector(s) from the line and add to the
+			// sector_list you're examining. If the Thing ends up being
+			// allowed to move to this position, then the sector_list
+			// will be attached to the Thing's AActor at touching_sectorlist.
 
-		sector_list = P_AddSecnode(ld->frontsector, thing, sector_list, ld->frontsector->*seclisthead);
+			sector_list = P_AddSecnode(ld->frontsector, thing, sector_list, ld->frontsector->*seclisthead);
 
-		// Don't assume all lines are 2-sided, since some Things
-		// like MT_TFOG are allowed regardless of whether their radius takes
-		// them beyond an impassable linedef.
+			// Don't assume all lines are 2-sided, since some Things
+			// like MT_TFOG are allowed regardless of whether their radius takes
+			// them beyond an impassable linedef.
 
-		// killough 3/27/98, 4/4/98:
-		// Use sidedefs instead of 2s flag to determine two-sidedness.
+			// killough 3/27/98, 4/4/98:
+			// Use sidedefs instead of 2s flag to determine two-sidedness.
 
-		if (ld->backsector)
-			sector_list = P_AddSecnode(ld->backsector, thing, sector_list, ld->backsector->*seclisthead);
+			if (ld->backsector)
+				sector_list = P_AddSecnode(ld->backsector, thing, sector_list, ld->backsector->*seclisthead);
+		}
 	}
 
 	// Add the sector of the (x,y) point to sector_list.
@@ -468,8 +513,7 @@ FBlockNode *FBlockNode::Create(AActor *who, int x, int y, int group)
 	}
 	block->BlockIndex = x + y * who->Level->blockmap.bmapwidth;
 	block->Me = who;
-	block->NextActor = nullptr;
-	block->PrevActor = nullptr;
+	block->Slot = -1;
 	block->PrevBlock = nullptr;
 	block->NextBlock = nullptr;
 	return block;
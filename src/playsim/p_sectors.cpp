@@ -994,10 +994,9 @@ double NextHighestCeilingAt(sector_t *sec, double x, double y, double bottomz, d
 	{
 		// Looking through planes from bottom to top
 		double realceil = sec->ceilingplane.ZatPoint(x, y);
-		for (int i = sec->e->XFloor.ffloors.Size() - 1; i >= 0; --i)
+		for (int i = sec->e->XFloor.solidffloors.Size() - 1; i >= 0; --i)
 		{
-			F3DFloor *rover = sec->e->XFloor.ffloors[i];
-			if (!(rover->flags & FF_SOLID) || !(rover->flags & FF_EXISTS)) continue;
+			F3DFloor *rover = sec->e->XFloor.solidffloors[i];
 
 			double ff_bottom = rover->bottom.plane->ZatPoint(x, y);
 			double ff_top = rover->top.plane->ZatPoint(x, y);
@@ -37,6 +37,10 @@
 #include "g_levellocals.h"
 #include "actorinlines.h"
 
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
+
 static FRandom pr_botchecksight ("BotCheckSight");
 static FRandom pr_checksight ("CheckSight");
 
@@ -54,6 +58,48 @@ This uses specialized forms of the maputils routines for optimized performance
 static int sightcounts[6];
 static cycle_t SightCycles;
 static cycle_t MaxSightCycles;
+static int sightcachehits;
+
+//==========================================================================
+//
+// Sight cache
+//
+// Remembers the results of the last traces so that a thinker repeatedly
+// checking the same target during its tick does not have to walk the
+// blockmap each time. The entire cache gets invalidated whenever the next
+// thinker ticks, a line special is executed or a sector moves, so a cached
+// result is the same a fresh trace would return.
+//
+//==========================================================================
+
+struct FSightCacheEntry
+{
+	AActor *t1, *t2;
+	DVector3 pos1, pos2;
+	double height1, height2;
+	int flags;
+	int generation;
+	bool result;
+};
+
+enum { SIGHTCACHE_SIZE = 64 };
+static FSightCacheEntry SightCache[SIGHTCACHE_SIZE];
+static int SightCacheGeneration = 1;
+
+void P_InvalidateSightCache()
+{
+	SightCacheGeneration++;
+}
+
+static FSightCacheEntry *FindSightCacheEntry(AActor *t1, AActor *t2, int flags, bool *found)
+{
+	uintptr_t hash = (uintptr_t)t1 * 31 + (uintptr_t)t2;
+	auto entry = &SightCache[((hash >> 4) ^ (hash >> 10)) & (SIGHTCACHE_SIZE - 1)];
+
+	*found = entry->generation == SightCacheGeneration && entry->t1 == t1 && entry->t2 == t2 && entry->flags == flags &&
+		entry->pos1 == t1->Pos() && entry->pos2 == t2->Pos() && entry->height1 == t1->Height && entry->height2 == t2->Height;
+	return entry;
+}
 
 enum
 {
@@ -422,6 +468,52 @@ bool SightCheck::LineBlocksSight(line_t *ld)
 	return false;
 }
 
+//==========================================================================
+//
+// TraceCrossesLine
+//
+// Checks that the line's vertices are on different sides of the trace and
+// the trace's end points on different sides of the line. This is the same
+// as 4 calls to P_PointOnDivlineSide, but the two tests of each pair are
+// done in parallel. The arithmetic is identical so the results are too.
+//
+//==========================================================================
+
+static inline bool TraceCrossesLine(const divline_t &trace, const line_t *ld)
+{
+	DVector2 v1 = ld->v1->fPos();
+	DVector2 v2 = ld->v2->fPos();
+	DVector2 delta = ld->Delta();
+
+#ifndef NO_SSE
+	const __m128d epsilon = _mm_set1_pd(EQUAL_EPSILON);
+
+	__m128d px = _mm_set_pd(v2.X, v1.X);
+	__m128d py = _mm_set_pd(v2.Y, v1.Y);
+	__m128d side = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(py, _mm_set1_pd(trace.y)), _mm_set1_pd(trace.dx)),
+		_mm_mul_pd(_mm_sub_pd(_mm_set1_pd(trace.x), px), _mm_set1_pd(trace.dy)));
+	int mask = _mm_movemask_pd(_mm_cmpgt_pd(side, epsilon));
+	if (mask == 0 || mask == 3)
+	{
+		return false;
+	}
+
+	px = _mm_add_pd(_mm_set1_pd(trace.x), _mm_set_pd(trace.dx, 0.));
+	py = _mm_add_pd(_mm_set1_pd(trace.y), _mm_set_pd(trace.dy, 0.));
+	side = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(py, _mm_set1_pd(v1.Y)), _mm_set1_pd(delta.X)),
+		_mm_mul_pd(_mm_sub_pd(_mm_set1_pd(v1.X), px), _mm_set1_pd(delta.Y)));
+	mask = _mm_movemask_pd(_mm_cmpgt_pd(side, epsilon));
+	return mask == 1 || mask == 2;
+#else
+	if (P_PointOnDivlineSide(v1, &trace) == P_PointOnDivlineSide(v2, &trace))
+	{
+		return false;
+	}
+	divline_t dl = { v1.X, v1.Y, delta.X, delta.Y };
+	return P_PointOnDivlineSide(trace.x, trace.y, &dl) != P_PointOnDivlineSide(trace.x + trace.dx, trace.y + trace.dy, &dl);
+#endif
+}
+
 /*
 ==================
 =
@@ -432,21 +524,12 @@ bool SightCheck::LineBlocksSight(line_t *ld)
 
 bool SightCheck::P_SightCheckLine (line_t *ld)
 {
-	divline_t dl;
-
 	if (ld->validcount == validcount)
 	{
 		return true;
 	}
 	ld->validcount = validcount;
-	if (P_PointOnDivlineSide (ld->v1->fPos(), &Trace) ==
-		P_PointOnDivlineSide (ld->v2->fPos(), &Trace))
-	{
-		return true;		// line isn't crossed
-	}
-	P_MakeDivline (ld, &dl);
-	if (P_PointOnDivlineSide (Trace.x, Trace.y, &dl) ==
-		P_PointOnDivlineSide (Trace.x+Trace.dx, Trace.y+Trace.dy, &dl))
+	if (!TraceCrossesLine(Trace, ld))
 	{
 		return true;		// line isn't crossed
 	}
@@ -842,7 +925,8 @@ int P_CheckSight (AActor *t1, AActor *t2, int flags)
 {
 	SightCycles.Clock();
 
-	bool res;
+	bool res, cached;
+	FSightCacheEntry *cacheentry;
 
 	if (t1 == nullptr || t2 == nullptr)
 	{
@@ -896,9 +980,26 @@ sightcounts[0]++;
 		}
 	}
 
+	// Disconnected parts of the map cannot see each other. This must come after the checks above
+	// so that the random number generator gets called just like before.
+	if (!t1->Level->CheckSightZones(s1, s2))
+	{
+sightcounts[0]++;
+		res = false;
+		goto done;
+	}
+
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
 
+	cacheentry = FindSightCacheEntry(t1, t2, flags, &cached);
+	if (cached)
+	{
+		sightcachehits++;
+		res = cacheentry->result;
+		goto done;
+	}
+
 	validcount++;
 	portals.Clear();
 	{
@@ -930,6 +1031,16 @@ sightcounts[0]++;
 		}
 	}
 
+	cacheentry->t1 = t1;
+	cacheentry->t2 = t2;
+	cacheentry->pos1 = t1->Pos();
+	cacheentry->pos2 = t2->Pos();
+	cacheentry->height1 = t1->Height;
+	cacheentry->height2 = t2->Height;
+	cacheentry->flags = flags;
+	cacheentry->generation = SightCacheGeneration;
+	cacheentry->result = res;
+
 done:
 	SightCycles.Unclock();
 	return res;
@@ -938,9 +1049,9 @@ done:
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, %4d cached\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5], sightcachehits);
 	return out;
 }
 
@@ -956,4 +1067,6 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	sightcachehits = 0;
+	P_InvalidateSightCache();
 }
@@ -0,0 +1,235 @@
+//
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2026 The GZDoom team
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** p_soundgraph.cpp
+** Sector adjacency graph for monster sound propagation
+**
+*/
+
+#include "g_levellocals.h"
+#include "p_soundgraph.h"
+#include "actor.h"
+#include "d_player.h"
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FSoundGraph::Clear()
+{
+	Level = nullptr;
+	Edges.Reset();
+	Nodes.Reset();
+	NoiseList.Reset();
+	Generation = 0;
+	Built = false;
+}
+
+//==========================================================================
+//
+// Like the navigation graph this only gets built on first use.
+//
+//==========================================================================
+
+void FSoundGraph::Build(FLevelLocals *l)
+{
+	Level = l;
+	Built = true;
+
+	Nodes.Resize(Level->sectors.Size());
+	for (auto &sec : Level->sectors)
+	{
+		auto &node = Nodes[sec.Index()];
+		node.firstedge = Edges.Size();
+		node.visited = 0;
+		node.traversed = 0;
+		node.portalvalid[0] = node.portalvalid[1] = false;
+
+		for (auto check : sec.Lines)
+		{
+			sector_t *other = nullptr;
+			if (check->sidedef[1] != nullptr && check->sidedef[0]->sector != check->sidedef[1]->sector)
+			{
+				other = check->sidedef[0]->sector == &sec ? check->sidedef[1]->sector : check->sidedef[0]->sector;
+			}
+			if (other == nullptr && check->getPortal() == nullptr) continue;
+			Edges.Push({ check, other, check->v1->fPos(), check->v2->fPos() });
+		}
+		node.numedges = Edges.Size() - node.firstedge;
+	}
+}
+
+//==========================================================================
+//
+// Finds the sectors sound reaches through a floor or ceiling portal by
+// looking through it at the middle of each of the sector's lines.
+//
+//==========================================================================
+
+const TArray<sector_t *> &FSoundGraph::GetPortalSectors(sector_t *sec, int plane)
+{
+	auto &node = Nodes[sec->Index()];
+	DVector2 disp = sec->GetPortalDisplacement(plane);
+
+	if (!node.portalvalid[plane] || node.displacement[plane] != disp)
+	{
+		auto &list = node.portalsectors[plane];
+		list.Clear();
+		for (auto check : sec->Lines)
+		{
+			sector_t *found = Level->PointInSector(check->v1->fPos() + check->Delta() / 2 + disp);
+			if (list.Find(found) == list.Size()) list.Push(found);
+		}
+		node.displacement[plane] = disp;
+		node.portalvalid[plane] = true;
+	}
+	return node.portalsectors[plane];
+}
+
+//==========================================================================
+//
+// Wakes up all monsters in this sector
+//
+//==========================================================================
+
+void FSoundGraph::MarkSector(sector_t *sec, AActor *soundtarget, bool splash, AActor *emitter, int soundblocks, double maxdist)
+{
+	auto &node = Nodes[sec->Index()];
+	if (node.visited == Generation && node.traversed <= soundblocks + 1)
+	{
+		return; 		// already flooded
+	}
+
+	node.visited = Generation;
+	node.traversed = soundblocks + 1;
+	sec->soundtraversed = soundblocks + 1;
+	sec->SoundTarget = soundtarget;
+
+	// [RH] Set this in the actors in the sector instead of the sector itself.
+	for (AActor *actor = sec->thinglist; actor != NULL; actor = actor->snext)
+	{
+		if (actor != soundtarget && (!splash || !(actor->flags4 & MF4_NOSPLASHALERT)) &&
+			(!maxdist || (actor->Distance2D(emitter) <= maxdist)))
+		{
+			actor->LastHeard = soundtarget;
+		}
+	}
+	NoiseList.Push({ sec, soundblocks });
+}
+
+//==========================================================================
+//
+// Traverses adjacent sectors,
+// sound blocking lines cut off traversal.
+//
+//==========================================================================
+
+void FSoundGraph::Flood(sector_t *sec, AActor *soundtarget, bool splash, AActor *emitter, int soundblocks, double maxdist)
+{
+	// check sector portals
+	if (sec->Lines.Size() > 0)
+	{
+		for (int plane : { sector_t::ceiling, sector_t::floor })
+		{
+			if (!sec->PortalBlocksSound(plane))
+			{
+				for (auto other : GetPortalSectors(sec, plane))
+				{
+					MarkSector(other, soundtarget, splash, emitter, soundblocks, maxdist);
+				}
+			}
+		}
+	}
+
+	auto &node = Nodes[sec->Index()];
+	for (unsigned i = node.firstedge; i < node.firstedge + node.numedges; i++)
+	{
+		auto &edge = Edges[i];
+		auto check = edge.line;
+
+		// ... and line portals;
+		FLinePortal *port = check->getPortal();
+		if (port && (port->mFlags & PORTF_SOUNDTRAVERSE))
+		{
+			if (port->mDestination)
+			{
+				MarkSector(port->mDestination->frontsector, soundtarget, splash, emitter, soundblocks, maxdist);
+			}
+		}
+
+		sector_t *other = edge.other;
+		if (other == nullptr || !(check->flags & ML_TWOSIDED))
+		{
+			continue;
+		}
+
+		// check for closed door
+		if ((sec->floorplane.ZatPoint(edge.v1) >= other->ceilingplane.ZatPoint(edge.v1) &&
+			sec->floorplane.ZatPoint(edge.v2) >= other->ceilingplane.ZatPoint(edge.v2))
+			|| (other->floorplane.ZatPoint(edge.v1) >= sec->ceilingplane.ZatPoint(edge.v1) &&
+				other->floorplane.ZatPoint(edge.v2) >= sec->ceilingplane.ZatPoint(edge.v2))
+			|| (other->floorplane.ZatPoint(edge.v1) >= other->ceilingplane.ZatPoint(edge.v1) &&
+				other->floorplane.ZatPoint(edge.v2) >= other->ceilingplane.ZatPoint(edge.v2)))
+		{
+			continue;
+		}
+
+		if (check->flags & ML_SOUNDBLOCK)
+		{
+			if (!soundblocks)
+				MarkSector(other, soundtarget, splash, emitter, 1, maxdist);
+		}
+		else
+		{
+			MarkSector(other, soundtarget, splash, emitter, soundblocks, maxdist);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Floods the sound from the emitter's sector breadth first.
+// Instead of validcount every node remembers the alert that last reached
+// it, so this does not interfere with anything else using validcount.
+//
+//==========================================================================
+
+void FSoundGraph::NoiseAlert(AActor *emitter, AActor *target, bool splash, double maxdist)
+{
+	if (!Built) Build(emitter->Level);
+
+	if (++Generation == 0)
+	{
+		// wrapped around, so the old marks cannot be trusted anymore.
+		for (auto &node : Nodes) node.visited = 0;
+		Generation = 1;
+	}
+
+	NoiseList.Clear();
+	MarkSector(emitter->Sector, target, splash, emitter, 0, maxdist);
+	for (unsigned i = 0; i < NoiseList.Size(); i++)
+	{
+		Flood(NoiseList[i].sec, target, splash, emitter, NoiseList[i].soundblocks, maxdist);
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include "tarray.h"
+#include "vectors.h"
+
+struct FLevelLocals;
+struct line_t;
+struct sector_t;
+class AActor;
+
+//==========================================================================
+//
+// Sector adjacency for monster sound propagation (P_NoiseAlert).
+//
+// Each sector only keeps the lines sound can actually pass through, i.e.
+// two-sided lines to other sectors and lines with a portal, so that a
+// flood fill does not have to look at every wall of the map. The sectors
+// found through floor and ceiling portals are cached as long as the
+// portal does not change.
+//
+// Openings and sound blocking flags can change during play, so they are
+// checked on every traversal.
+//
+//==========================================================================
+
+class FSoundGraph
+{
+	struct FSoundEdge
+	{
+		line_t *line;
+		sector_t *other;		// nullptr if the line only leads through a line portal
+		DVector2 v1, v2;
+	};
+
+	struct FSoundNode
+	{
+		unsigned firstedge, numedges;
+		unsigned visited;		// == Generation if flooded by the current alert
+		int traversed;			// 1 + number of sound blocking lines crossed
+		DVector2 displacement[2];	// the portal displacements the cached sectors were found with
+		TArray<sector_t *> portalsectors[2];
+		bool portalvalid[2];
+	};
+
+	struct FNoiseTarget
+	{
+		sector_t *sec;
+		int soundblocks;
+	};
+
+	FLevelLocals *Level = nullptr;
+	TArray<FSoundEdge> Edges;
+	TArray<FSoundNode> Nodes;
+	TArray<FNoiseTarget> NoiseList;
+	unsigned Generation = 0;
+	bool Built = false;
+
+	void Build(FLevelLocals *Level);
+	const TArray<sector_t *> &GetPortalSectors(sector_t *sec, int plane);
+	void MarkSector(sector_t *sec, AActor *soundtarget, bool splash, AActor *emitter, int soundblocks, double maxdist);
+	void Flood(sector_t *sec, AActor *soundtarget, bool splash, AActor *emitter, int soundblocks, double maxdist);
+
+public:
+	void Clear();
+	void NoiseAlert(AActor *emitter, AActor *target, bool splash, double maxdist);
+};
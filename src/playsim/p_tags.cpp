@@ -70,7 +70,7 @@ void FTagManager::AddSectorTag(int sector, int tag)
 			}
 		}
 	}
-	FTagItem it = { sector, tag, -1 };
+	FTagItem it = { sector, tag };
 	allTags.Push(it);
 }
 
@@ -148,7 +148,7 @@ void FTagManager::AddLineID(int line, int tag)
 			}
 		}
 	}
-	FTagItem it = { line, tag, -1 };
+	FTagItem it = { line, tag };
 	allIDs.Push(it);
 }
 
@@ -158,38 +158,66 @@ void FTagManager::AddLineID(int line, int tag)
 //
 //-----------------------------------------------------------------------------
 
-void FTagManager::HashTags()
+void FTagIndex::Build(const TArray<FTagItem> &items)
 {
-	// add an end marker so we do not need to check for the array's size in the other functions.
-	static FTagItem it = { -1, -1, -1 };
-	allTags.Push(it);
-	allIDs.Push(it);
+	Clear();
 
-	// Initially make all slots empty.
-	memset(TagHashFirst, -1, sizeof(TagHashFirst));
-	memset(IDHashFirst, -1, sizeof(IDHashFirst));
-
-	// Proceed from last to first so that lower targets appear first
-	for (int i = allTags.Size() - 1; i >= 0; i--)
+	// Count the targets per tag first, rows are numbered in the order their tags first appear.
+	TArray<unsigned> counts;
+	for (auto &item : items)
 	{
-		if (allTags[i].target >= 0)	// only link valid entries
+		if (item.target < 0) continue;	// only index valid entries
+		auto row = Rows.CheckKey(item.tag);
+		if (row == nullptr)
 		{
-			int hash = ((unsigned int)allTags[i].tag) % FTagManager::TAG_HASH_SIZE;
-			allTags[i].nexttag = TagHashFirst[hash];
-			TagHashFirst[hash] = i;
+			Rows.Insert(item.tag, counts.Size());
+			counts.Push(1);
 		}
+		else counts[*row]++;
 	}
 
-	for (int i = allIDs.Size() - 1; i >= 0; i--)
+	RowStart.Resize(counts.Size() + 1);
+	unsigned total = 0;
+	for (unsigned i = 0; i < counts.Size(); i++)
 	{
-		if (allIDs[i].target >= 0)	// only link valid entries
-		{
-			int hash = ((unsigned int)allIDs[i].tag) % FTagManager::TAG_HASH_SIZE;
-			allIDs[i].nexttag = IDHashFirst[hash];
-			IDHashFirst[hash] = i;
-		}
+		RowStart[i] = total;
+		total += counts[i];
+		counts[i] = RowStart[i];	// reused as the fill position
+	}
+	RowStart[counts.Size()] = total;
+
+	// So that the iterators return the targets in the same order as the items were added.
+	Targets.Resize(total);
+	for (auto &item : items)
+	{
+		if (item.target < 0) continue;
+		Targets[counts[Rows[item.tag]]++] = item.target;
 	}
+}
+
+//-----------------------------------------------------------------------------
+//
+// Needs to be called once all tags have been added, i.e. before the level
+// starts running. Tags do not change during play.
+//
+//-----------------------------------------------------------------------------
 
+void FTagManager::HashTags()
+{
+	// add an end marker so we do not need to check for the array's size in the other functions.
+	static FTagItem it = { -1, -1 };
+	allTags.Push(it);
+	allIDs.Push(it);
+
+	sectorsByTag.Build(allTags);
+	linesByID.Build(allIDs);
+
+	// searching for tag 0 has to be different, because it won't create entries for untagged sectors.
+	untaggedSectors.Clear();
+	for (unsigned i = 0; i < Level->sectors.Size(); i++)
+	{
+		if (!SectorHasTags(i)) untaggedSectors.Push(i);
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -320,6 +348,7 @@ void FTagManager::DumpTags()
 //
 // Find the next sector with a specified tag.
 // Rewritten by Lee Killough to use chained hashing to improve speed
+// and later changed to walk the compressed tag index.
 //
 //-----------------------------------------------------------------------------
 
@@ -331,23 +360,10 @@ int FSectorTagIterator::Next()
 		ret = start;
 		start = -1;
 	}
-	else if (searchtag != 0)
-	{
-		while (start >= 0 && tagManager.allTags[start].tag != searchtag) start = tagManager.allTags[start].nexttag;
-		if (start == -1) return -1;
-		ret = tagManager.allTags[start].target;
-		start = tagManager.allTags[start].nexttag;
-	}
 	else
 	{
-		// with the tag manager, searching for tag 0 has to be different, because it won't create entries for untagged sectors.
-		while (start < (int)tagManager.Level->sectors.Size() && tagManager.SectorHasTags(start))
-		{
-			start++;
-		}
-		if (start == (int)tagManager.Level->sectors.Size()) return -1;
-		ret = start;
-		start++;
+		if (start >= end) return -1;
+		ret = list[start++];
 	}
 	return ret;
 }
@@ -378,10 +394,6 @@ int FSectorTagIterator::NextCompat(bool compat, int start)
 
 int FLineIdIterator::Next()
 {
-	while (start >= 0 && tagManager.allIDs[start].tag != searchtag) start = tagManager.allIDs[start].nexttag;
-	if (start == -1) return -1;
-	int ret = tagManager.allIDs[start].target;
-	start = tagManager.allIDs[start].nexttag;
-	return ret;
+	if (start >= end) return -1;
+	return list[start++];
 }
-
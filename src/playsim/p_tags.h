@@ -8,7 +8,35 @@ struct FTagItem
 {
 	int target;		// either sector or line
 	int tag;
-	int nexttag;	// for hashing
+};
+
+// Compressed tag -> target lookup. All targets with the same tag are stored
+// next to each other, in the order they were added to the tag manager.
+struct FTagIndex
+{
+	TMap<int, unsigned> Rows;	// tag -> row
+	TArray<unsigned> RowStart;	// one extra entry at the end
+	TArray<int> Targets;
+
+	void Clear()
+	{
+		Rows.Clear();
+		RowStart.Clear();
+		Targets.Clear();
+	}
+
+	void Build(const TArray<FTagItem> &items);
+
+	void Find(int tag, int &start, int &end) const
+	{
+		auto row = Rows.CheckKey(tag);
+		if (row == nullptr) start = end = 0;
+		else
+		{
+			start = RowStart[*row];
+			end = RowStart[*row + 1];
+		}
+	}
 };
 
 class FSectorTagIterator;
@@ -17,11 +45,6 @@ struct FLevelLocals;
 
 class FTagManager
 {
-	enum
-	{
-		TAG_HASH_SIZE = 256
-	};
-
 	// Only the iterators and the map loader, including its helpers may access this. Everything else should go through FLevelLocals's interface.
 	friend class FSectorTagIterator;
 	friend class FLineIdIterator;
@@ -34,8 +57,9 @@ class FTagManager
 	TArray<FTagItem> allIDs;
 	TArray<int> startForSector;
 	TArray<int> startForLine;
-	int TagHashFirst[TAG_HASH_SIZE];
-	int IDHashFirst[TAG_HASH_SIZE];
+	FTagIndex sectorsByTag;
+	FTagIndex linesByID;
+	TArray<int> untaggedSectors;
 
 	bool SectorHasTags(int sect) const
 	{
@@ -55,8 +79,9 @@ class FTagManager
 		allIDs.Clear();
 		startForSector.Clear();
 		startForLine.Clear();
-		memset(TagHashFirst, -1, sizeof(TagHashFirst));
-		memset(IDHashFirst, -1, sizeof(IDHashFirst));
+		sectorsByTag.Clear();
+		linesByID.Clear();
+		untaggedSectors.Clear();
 	}
 
 	bool SectorHasTags(const sector_t *sector) const;
@@ -85,6 +110,8 @@ class FSectorTagIterator
 protected:
 	int searchtag;
 	int start;
+	int end;
+	const int *list;
 	FTagManager &tagManager;
 
 	FSectorTagIterator(FTagManager &tm) : tagManager(tm)
@@ -95,7 +122,17 @@ protected:
 	void Init(int tag)
 	{
 		searchtag = tag;
-		start = tag == 0 ? 0 : tagManager.TagHashFirst[((unsigned int)tag) % FTagManager::TAG_HASH_SIZE];
+		if (tag == 0)
+		{
+			list = tagManager.untaggedSectors.Data();
+			start = 0;
+			end = tagManager.untaggedSectors.Size();
+		}
+		else
+		{
+			list = tagManager.sectorsByTag.Targets.Data();
+			tagManager.sectorsByTag.Find(tag, start, end);
+		}
 	}
 
 	void Init(int tag, line_t *line)
@@ -103,12 +140,13 @@ protected:
 		if (tag == 0)
 		{
 			searchtag = INT_MIN;
+			list = nullptr;
 			start = (line == NULL || line->backsector == NULL) ? -1 : line->backsector->Index();
+			end = 0;
 		}
 		else
 		{
-			searchtag = tag;
-			start = tagManager.TagHashFirst[((unsigned int)tag) % FTagManager::TAG_HASH_SIZE];
+			Init(tag);
 		}
 	}
 
@@ -131,14 +169,15 @@ class FLineIdIterator
 {
 	friend struct FLevelLocals;
 protected:
-	int searchtag;
 	int start;
+	int end;
+	const int *list;
 	FTagManager &tagManager;
 
 	FLineIdIterator(FTagManager &tm, int id) : tagManager(tm)
 	{
-		searchtag = id;
-		start = tagManager.IDHashFirst[((unsigned int)id) % FTagManager::TAG_HASH_SIZE];
+		list = tagManager.linesByID.Targets.Data();
+		tagManager.linesByID.Find(id, start, end);
 	}
 
 public:
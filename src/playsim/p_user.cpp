@@ -150,6 +150,20 @@ static TArray<msecnode_t *> PredictionPortalSectors_sprev_Backup;
 static TArray<FLinePortal *> PredictionPortalLinesBackup;
 static TArray<portnode_t *> PredictionPortalLines_sprev_Backup;
 
+// The outcome of the last prediction. As long as no new tic has been
+// run, the predicted state for the tics that were already predicted
+// cannot change, so the next frame can continue from here instead of
+// predicting everything again from gametic.
+static struct PredictionCacheData
+{
+	AActor *Actor;
+	int Gametic;
+	int Maptime;
+	int Maketic;
+	player_t Player;
+	TArray<uint8_t> ActorState;
+} PredictionCache;
+
 // [GRB] Custom player classes
 TArray<FPlayerClass> PlayerClasses;
 
@@ -1275,6 +1289,7 @@ void P_PlayerThink (player_t *player)
 void P_PredictionLerpReset()
 {
 	PredictionLerptics = PredictionLast.gametic = PredictionLerpFrom.gametic = PredictionLerpResult.gametic = 0;
+	PredictionCache.Actor = nullptr;
 }
 
 bool P_LerpCalculate(AActor *pmo, PredictPos from, PredictPos to, PredictPos &result, float scale)
@@ -1448,18 +1463,49 @@ void P_PredictPlayer (player_t *player)
 
 	while (block != NULL)
 	{
-		if (block->NextActor != NULL)
-		{
-			block->NextActor->PrevActor = block->PrevActor;
-		}
-		*(block->PrevActor) = block->NextActor;
+		act->Level->blockmap.UnlinkThing(block);
 		block = block->NextBlock;
 	}
 	act->BlockNode = NULL;
 
 	// Values too small to be usable for lerping can be considered "off".
 	bool CanLerp = (!(cl_predict_lerpscale < 0.01f) && (ticdup == 1)), DoLerp = false, NoInterpolateOld = R_GetViewInterpolationStatus();
-	for (int i = gametic; i < maxtic; ++i)
+	int firsttic = gametic;
+	if (PredictionCache.Actor == act && PredictionCache.Gametic == gametic && PredictionCache.Maptime == act->Level->maptime &&
+		PredictionCache.Maketic <= maxtic && !NoInterpolateOld)
+	{
+		// Nothing has been run since the last prediction, so pick up where it left off.
+		FLinkContext ctx;
+		act->UnlinkFromWorld(&ctx);
+		act->ClearRenderLineList();
+
+		// Same as in P_UnPredictPlayer, these may have been changed outside the playsim.
+		const bool settings_controller = player->settings_controller;
+		AActor *savedcamera = player->camera;
+		int inventorytics = player->inventorytics;
+		auto &actInvSel = act->PointerVar<AActor*>(NAME_InvSel);
+		auto InvSel = actInvSel;
+
+		player->CopyFrom(PredictionCache.Player, false);
+		player->settings_controller = settings_controller;
+		player->camera = savedcamera;
+		player->inventorytics = inventorytics;
+
+		memcpy(&act->snext, PredictionCache.ActorState.Data(), PredictionCache.ActorState.Size() - ((uint8_t *)&act->snext - (uint8_t *)act));
+		actInvSel = InvSel;
+		// The cached links are long gone, the world links get recreated from the predicted position.
+		act->snext = nullptr;
+		act->sprev = nullptr;
+		act->BlockNode = nullptr;
+		act->touching_sectorlist = nullptr;
+		act->touching_rendersectors = nullptr;
+		act->touching_sectorportallist = nullptr;
+		act->touching_lineportallist = nullptr;
+		act->LinkToWorld(&ctx);
+		firsttic = PredictionCache.Maketic;
+	}
+
+	for (int i = firsttic; i < maxtic; ++i)
 	{
 		if (!NoInterpolateOld)
 			R_RebuildViewInterpolation(player);
@@ -1500,7 +1546,27 @@ void P_PredictPlayer (player_t *player)
 		PredictionLast.gametic = maxtic - 1;
 		PredictionLast.pos = player->mo->Pos();
 		//PredictionLast.portalgroup = player->mo->Sector->PortalGroup;
+	}
+
+	// Remember the result, unless the view interpolation got reset along the way
+	// which needs to happen again on the next full prediction.
+	if (!R_GetViewInterpolationStatus() && !NoInterpolateOld)
+	{
+		PredictionCache.Actor = act;
+		PredictionCache.Gametic = gametic;
+		PredictionCache.Maptime = act->Level->maptime;
+		PredictionCache.Maketic = maxtic;
+		PredictionCache.Player.CopyFrom(*player, false);
+		PredictionCache.ActorState.Resize(act->GetClass()->Size);
+		memcpy(PredictionCache.ActorState.Data(), &act->snext, act->GetClass()->Size - ((uint8_t *)&act->snext - (uint8_t *)act));
+	}
+	else
+	{
+		PredictionCache.Actor = nullptr;
+	}
 
+	if (CanLerp)
+	{
 		if (PredictionLerptics > 0)
 		{
 			if (PredictionLerpFrom.gametic > 0 &&
@@ -1586,16 +1652,12 @@ void P_UnPredictPlayer ()
 			act->touching_lineportallist = RestoreNodeList(act, lineportal_list, &FLinePortal::lineportal_thinglist, PredictionPortalLines_sprev_Backup, PredictionPortalLinesBackup);
 		}
 
-		// Now fix the pointers in the blocknode chain
+		// Now put the block nodes back into their old slots
 		FBlockNode *block = act->BlockNode;
 
 		while (block != NULL)
 		{
-			*(block->PrevActor) = block;
-			if (block->NextActor != NULL)
-			{
-				block->NextActor->PrevActor = &block->NextActor;
-			}
+			act->Level->blockmap.RelinkThing(block);
 			block = block->NextBlock;
 		}
 
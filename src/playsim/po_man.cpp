@@ -864,7 +864,7 @@ bool FPolyObj::MovePolyobj (const DVector2 &pos, bool force)
 	UnLinkPolyobj ();
 	DoMovePolyobj (pos);
 
-	if (!force)
+	if (!force && MayBlockMobjs())
 	{
 		bool blocked = false;
 
@@ -957,7 +957,7 @@ bool FPolyObj::RotatePolyobj (DAngle angle, bool fromsave)
 	UpdateBBox();
 
 	// If we are loading a savegame we do not really want to damage actors and be blocked by them. This can also cause crashes when trying to damage incompletely deserialized player pawns.
-	if (!fromsave)
+	if (!fromsave && MayBlockMobjs())
 	{
 		for (unsigned i = 0; i < Sidedefs.Size(); i++)
 		{
@@ -1019,6 +1019,54 @@ void FPolyObj::UnLinkPolyobj ()
 	}
 }
 
+//==========================================================================
+//
+// MayBlockMobjs
+//
+// CheckMobjBlocking only ever acts on solid, clipping actors in the
+// blocks its line's bounding box covers. If there are none anywhere
+// near the polyobject's new position, the per-line checks, which go
+// through the same actors over and over again, can be skipped as a
+// whole. This is the common case for spinning fans and gears.
+//
+//==========================================================================
+
+bool FPolyObj::MayBlockMobjs () const
+{
+	if (Linedefs.Size() == 0) return false;
+
+	FBoundingBox box;
+	box.ClearBox();
+	for (auto ld : Linedefs)
+	{
+		box.AddToBox(DVector2(ld->bbox[BOXLEFT], ld->bbox[BOXBOTTOM]));
+		box.AddToBox(DVector2(ld->bbox[BOXRIGHT], ld->bbox[BOXTOP]));
+	}
+
+	int bmapwidth = Level->blockmap.bmapwidth;
+	int bmapheight = Level->blockmap.bmapheight;
+	int top = clamp(Level->blockmap.GetBlockY(box.Top()), 0, bmapheight - 1);
+	int bottom = clamp(Level->blockmap.GetBlockY(box.Bottom()), 0, bmapheight - 1);
+	int left = clamp(Level->blockmap.GetBlockX(box.Left()), 0, bmapwidth - 1);
+	int right = clamp(Level->blockmap.GetBlockX(box.Right()), 0, bmapwidth - 1);
+
+	for (int j = bottom*bmapwidth; j <= top*bmapwidth; j += bmapwidth)
+	{
+		for (int i = left; i <= right; i++)
+		{
+			for (auto &node : Level->blockmap.blockthings[j+i])
+			{
+				AActor *mobj = node.Me;
+				if (mobj != nullptr && (mobj->flags&MF_SOLID) && !(mobj->flags&MF_NOCLIP))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
 //==========================================================================
 //
 // CheckMobjBlocking
@@ -1028,7 +1076,6 @@ void FPolyObj::UnLinkPolyobj ()
 bool FPolyObj::CheckMobjBlocking (side_t *sd)
 {
 	static TArray<AActor *> checker;
-	FBlockNode *block;
 	AActor *mobj;
 	int i, j, k;
 	int left, right, top, bottom;
@@ -1061,9 +1108,14 @@ bool FPolyObj::CheckMobjBlocking (side_t *sd)
 	{
 		for (i = left; i <= right; i++)
 		{
-			for (block = Level->blockmap.blocklinks[j+i]; block != nullptr; block = block->NextActor)
+			auto &things = Level->blockmap.blockthings[j+i];
+			for (unsigned b = things.Size(); b-- > 0; )
 			{
-				mobj = block->Me;
+				mobj = things[b].Me;
+				if (mobj == nullptr)
+				{
+					continue;
+				}
 				for (k = (int)checker.Size()-1; k >= 0; --k)
 				{
 					if (checker[k] == mobj)
@@ -1191,7 +1243,7 @@ void FPolyObj::LinkPolyobj ()
 				link = &Level->PolyBlockMap[j+i];
 				if(!(*link))
 				{ // CreateThinker a new link at the current block cell
-					*link = new polyblock_t;
+					*link = Level->AllocLevelData<polyblock_t>();
 					(*link)->next = nullptr;
 					(*link)->prev = nullptr;
 					(*link)->polyobj = this;
@@ -1212,7 +1264,7 @@ void FPolyObj::LinkPolyobj ()
 				}
 				else
 				{
-					tempLink->next = new polyblock_t;
+					tempLink->next = Level->AllocLevelData<polyblock_t>();
 					tempLink->next->next = nullptr;
 					tempLink->next->prev = tempLink;
 					tempLink->next->polyobj = this;
@@ -116,6 +116,7 @@ private:
 	void DoMovePolyobj (const DVector2 &pos);
 	void UnLinkPolyobj ();
 	bool CheckMobjBlocking (side_t *sd);
+	bool MayBlockMobjs () const;
 
 };
 
@@ -165,7 +165,7 @@ void FLinePortalTraverse::AddLineIntercepts(int bx, int by)
 		newintercept.isaline = true;
 		newintercept.done = false;
 		newintercept.d.line = ld;
-		intercepts.Push(newintercept);
+		AddIntercept(newintercept);
 	}
 }
 
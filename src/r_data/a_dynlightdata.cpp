@@ -206,29 +206,30 @@ void AddLightDefaults(FLightDefaults *defaults, double attnFactor)
 //
 //==========================================================================
 
-FInternalLightAssociation::FInternalLightAssociation(FLightAssociation * asso)
+static uint32_t SpriteNameKey(const char *name)
 {
-
-	m_AssocLight=NULL;
-	for(unsigned int i=0;i<LightDefaults.Size();i++)
+	uint32_t key = 0;
+	for (int i = 0; i < 4 && name[i] != 0; i++)
 	{
-		if (LightDefaults[i]->GetName() == asso->Light())
-		{
-			m_AssocLight = LightDefaults[i];
-			break;
-		}
+		key |= uint32_t(uint8_t(name[i])) << (i * 8);
 	}
+	return key;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FInternalLightAssociation::FInternalLightAssociation(FLightAssociation * asso, const TMap<FName, FLightDefaults *> &lightsByName, const TMap<uint32_t, int> &spritesByName)
+{
+	auto light = lightsByName.CheckKey(asso->Light());
+	m_AssocLight = light ? *light : nullptr;
 
-	m_sprite=-1;
+	auto sprite = spritesByName.CheckKey(SpriteNameKey(asso->FrameName()));
+	m_sprite = sprite ? *sprite : -1;
 	m_frame = -1;
-	for (unsigned i = 0; i < sprites.Size (); ++i)
-	{
-		if (strncmp (sprites[i].name, asso->FrameName(), 4) == 0)
-		{
-			m_sprite = (int)i;
-			break;
-		}
-	}
 
 	// Only handle lights for full frames. 
 	// I won't bother with special lights for single rotations
@@ -255,6 +256,21 @@ TArray<FLightDefaults *> StateLights;
 
 void InitializeActorLights(TArray<FLightAssociation> &LightAssociations)
 {
+	// Index the lights and sprites by name once instead of searching both lists
+	// for every association and state light. If a name appears more than once the
+	// first entry wins, like the linear searches did.
+	TMap<FName, FLightDefaults *> lightsByName;
+	for (auto ldef : LightDefaults)
+	{
+		if (!lightsByName.CheckKey(ldef->GetName())) lightsByName.Insert(ldef->GetName(), ldef);
+	}
+	TMap<uint32_t, int> spritesByName;
+	for (unsigned i = 0; i < sprites.Size(); i++)
+	{
+		uint32_t key = SpriteNameKey(sprites[i].name);
+		if (!spritesByName.CheckKey(key)) spritesByName.Insert(key, (int)i);
+	}
+
 	for(unsigned int i=0;i<LightAssociations.Size();i++)
 	{
 		PClassActor * ti = PClass::FindActor(LightAssociations[i].ActorName());
@@ -263,7 +279,7 @@ void InitializeActorLights(TArray<FLightAssociation> &LightAssociations)
 			ti = GetRealType(ti);
 			// put this in the class data arena so that we do not have to worry about deleting it ourselves.
 			void *mem = ClassDataAllocator.Alloc(sizeof(FInternalLightAssociation));
-			FInternalLightAssociation * iasso = new(mem) FInternalLightAssociation(&LightAssociations[i]);
+			FInternalLightAssociation * iasso = new(mem) FInternalLightAssociation(&LightAssociations[i], lightsByName, spritesByName);
 			if (iasso->Light() != nullptr)
 				ti->ActorInfo()->LightAssociations.Push(iasso);
 		}
@@ -274,15 +290,8 @@ void InitializeActorLights(TArray<FLightAssociation> &LightAssociations)
 	{
 		if (ParsedStateLights[i] != NAME_None)
 		{
-			StateLights[i] = (FLightDefaults*)-1;	// something invalid that's not NULL.
-			for(unsigned int j=0;j<LightDefaults.Size();j++)
-			{
-				if (LightDefaults[j]->GetName() == ParsedStateLights[i])
-				{
-					StateLights[i] = LightDefaults[j];
-					break;
-				}
-			}
+			auto light = lightsByName.CheckKey(ParsedStateLights[i]);
+			StateLights[i] = light ? *light : (FLightDefaults*)-1;	// something invalid that's not NULL.
 		}
 		else StateLights[i] = NULL;
 	}
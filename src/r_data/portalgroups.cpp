@@ -299,7 +299,7 @@ void BuildPortalCoverage(FLevelLocals *Level, FPortalCoverage *coverage, subsect
 	build.center.y = xs_CRoundToInt(centery / subsector->numlines);
 
 	build.CollectNode(Level->HeadNode(), shape);
-	coverage->subsectors = new uint32_t[build.collect.Size()]; 
+	coverage->subsectors = Level->AllocLevelData<uint32_t>(build.collect.Size());
 	coverage->sscount = build.collect.Size();
 	memcpy(coverage->subsectors, &build.collect[0], build.collect.Size() * sizeof(uint32_t));
 }
@@ -360,7 +360,7 @@ static void GroupSectorPortals(FLevelLocals *Level)
 			// add separate portals for floor and ceiling.
 			if (planeflags & i)
 			{
-				FSectorPortalGroup *portal = new FSectorPortalGroup;
+				FSectorPortalGroup *portal = Level->AllocLevelData<FSectorPortalGroup>();
 				portal->mDisplacement = pair->Key.mDisplacement;
 				portal->plane = (i == 1 ? sector_t::floor : sector_t::ceiling);	/**/
 				Level->portalGroups.Push(portal);
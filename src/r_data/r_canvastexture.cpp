@@ -40,6 +40,10 @@
 #include "serializer.h"
 #include "serialize_obj.h"
 #include "texturemanager.h"
+#include "i_time.h"
+
+CVAR(Int, r_camtex_maxupdates, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// camera textures rendered per frame, 0 = all
+CVAR(Int, r_camtex_maxrate, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// updates per second per camera texture, 0 = every frame
 
 //==========================================================================
 //
@@ -115,18 +119,40 @@ void SetCameraToTexture(AActor *viewpoint, const FString &texturename, double fo
 // FCanvasTextureInfo :: UpdateAll
 //
 // Updates all canvas textures that were visible in the last frame.
+// With a rate or per-frame limit set, the textures that have to wait
+// keep showing their last image and get refreshed in round robin order.
+// Textures that have never been drawn are always updated.
 //
 //==========================================================================
 
 void FCanvasTextureInfo::UpdateAll(std::function<void(AActor *, FCanvasTexture *, double fov)> callback)
 {
-	for (auto &probe : List)
+	unsigned count = List.Size();
+	if (count == 0) return;
+
+	uint64_t now = I_msTime();
+	uint64_t interval = r_camtex_maxrate > 0 ? 1000 / r_camtex_maxrate : 0;
+	int budget = r_camtex_maxupdates > 0 ? r_camtex_maxupdates : INT_MAX;
+
+	if (NextUpdate >= count) NextUpdate = 0;
+	unsigned next = NextUpdate;
+
+	for (unsigned i = 0; i < count; i++)
 	{
-		if (probe.Viewpoint != nullptr && probe.Texture->bNeedsUpdate)
+		unsigned index = (NextUpdate + i) % count;
+		auto &probe = List[index];
+		if (probe.Viewpoint == nullptr || !probe.Texture->bNeedsUpdate) continue;
+
+		if (!probe.Texture->bFirstUpdate)
 		{
-			callback(probe.Viewpoint, probe.Texture, probe.FOV);
+			if (budget <= 0 || now - probe.LastUpdate < interval) continue;
+			budget--;
 		}
+		callback(probe.Viewpoint, probe.Texture, probe.FOV);
+		probe.LastUpdate = now;
+		next = index + 1;
 	}
+	if (r_camtex_maxupdates > 0) NextUpdate = next;
 }
 
 //==========================================================================
@@ -140,6 +166,7 @@ void FCanvasTextureInfo::UpdateAll(std::function<void(AActor *, FCanvasTexture *
 void FCanvasTextureInfo::EmptyList ()
 {
 	List.Clear();
+	NextUpdate = 0;
 }
 
 //==========================================================================
@@ -8,12 +8,14 @@ struct FCanvasTextureEntry
 	FCanvasTexture *Texture;
 	FTextureID PicNum;
 	double FOV;
+	uint64_t LastUpdate = 0;	// real time in ms
 };
 
 
 struct FCanvasTextureInfo
 {
 	TArray<FCanvasTextureEntry> List;
+	unsigned NextUpdate = 0;	// round robin start when not all textures can be updated in one frame
 	
 	void Add (AActor *viewpoint, FTextureID picnum, double fov);
 	void UpdateAll (std::function<void(AActor *, FCanvasTexture *, double fov)> callback);
@@ -66,7 +66,7 @@ public:
 	void UnlinkFromMap() override;
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(double smoothratio);
+	bool Interpolate(double smoothratio);
 	
 	virtual void Serialize(FSerializer &arc);
 	size_t PropagateMark();
@@ -94,7 +94,7 @@ public:
 	void UnlinkFromMap() override;
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(double smoothratio);
+	bool Interpolate(double smoothratio);
 	
 	virtual void Serialize(FSerializer &arc);
 };
@@ -122,7 +122,7 @@ public:
 	void UnlinkFromMap() override;
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(double smoothratio);
+	bool Interpolate(double smoothratio);
 	
 	virtual void Serialize(FSerializer &arc);
 };
@@ -149,7 +149,7 @@ public:
 	void UnlinkFromMap() override;
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(double smoothratio);
+	bool Interpolate(double smoothratio);
 	
 	virtual void Serialize(FSerializer &arc);
 };
@@ -254,12 +254,13 @@ void FInterpolator::DoInterpolations(double smoothratio)
 	}
 
 	didInterp = true;
+	Interpolated.Clear();
 
 	DInterpolation *probe = Head;
 	while (probe != nullptr)
 	{
 		DInterpolation *next = probe->Next;
-		probe->Interpolate(smoothratio);
+		if (probe->Interpolate(smoothratio)) Interpolated.Push(probe);
 		probe = next;
 	}
 }
@@ -275,10 +276,11 @@ void FInterpolator::RestoreInterpolations()
 	if (didInterp)
 	{
 		didInterp = false;
-		for (DInterpolation *probe = Head; probe != nullptr; probe = probe->Next)
+		for (auto probe : Interpolated)
 		{
 			probe->Restore();
 		}
+		Interpolated.Clear();
 	}
 }
 
@@ -292,6 +294,8 @@ void FInterpolator::ClearInterpolations()
 {
 	DInterpolation *probe = Head;
 	Head = nullptr;
+	Interpolated.Clear();
+	didInterp = false;
 
 	while (probe != nullptr)
 	{
@@ -479,7 +483,7 @@ void DSectorPlaneInterpolation::Restore()
 //
 //==========================================================================
 
-void DSectorPlaneInterpolation::Interpolate(double smoothratio)
+bool DSectorPlaneInterpolation::Interpolate(double smoothratio)
 {
 	secplane_t *pplane;
 	int pos;
@@ -498,18 +502,22 @@ void DSectorPlaneInterpolation::Interpolate(double smoothratio)
 	bakheight = pplane->fD();
 	baktexz = sector->GetPlaneTexZ(pos);
 
-	if (refcount == 0 && oldheight == bakheight)
+	if (oldheight == bakheight)
 	{
-		UnlinkFromMap();
-		Destroy();
-	}
-	else
-	{
-		pplane->setD(oldheight + (bakheight - oldheight) * smoothratio);
-		sector->SetPlaneTexZ(pos, oldtexz + (baktexz - oldtexz) * smoothratio, true);
-		P_RecalculateAttached3DFloors(sector);
-		sector->CheckPortalPlane(pos);
+		if (refcount == 0)
+		{
+			UnlinkFromMap();
+			Destroy();
+			return false;
+		}
+		// A plane that did not move during the last tic does not need its attached 3D floors and portals recalculated.
+		if (oldtexz == baktexz) return false;
 	}
+	pplane->setD(oldheight + (bakheight - oldheight) * smoothratio);
+	sector->SetPlaneTexZ(pos, oldtexz + (baktexz - oldtexz) * smoothratio, true);
+	P_RecalculateAttached3DFloors(sector);
+	sector->CheckPortalPlane(pos);
+	return true;
 }
 
 //==========================================================================
@@ -618,21 +626,23 @@ void DSectorScrollInterpolation::Restore()
 //
 //==========================================================================
 
-void DSectorScrollInterpolation::Interpolate(double smoothratio)
+bool DSectorScrollInterpolation::Interpolate(double smoothratio)
 {
 	bakx = sector->GetXOffset(ceiling);
 	baky = sector->GetYOffset(ceiling, false);
 
-	if (refcount == 0 && oldx == bakx && oldy == baky)
+	if (oldx == bakx && oldy == baky)
 	{
-		UnlinkFromMap();
-		Destroy();
-	}
-	else
-	{
-		sector->SetXOffset(ceiling, oldx + (bakx - oldx) * smoothratio);
-		sector->SetYOffset(ceiling, oldy + (baky - oldy) * smoothratio);
+		if (refcount == 0)
+		{
+			UnlinkFromMap();
+			Destroy();
+		}
+		return false;
 	}
+	sector->SetXOffset(ceiling, oldx + (bakx - oldx) * smoothratio);
+	sector->SetYOffset(ceiling, oldy + (baky - oldy) * smoothratio);
+	return true;
 }
 
 //==========================================================================
@@ -718,21 +728,23 @@ void DWallScrollInterpolation::Restore()
 //
 //==========================================================================
 
-void DWallScrollInterpolation::Interpolate(double smoothratio)
+bool DWallScrollInterpolation::Interpolate(double smoothratio)
 {
 	bakx = side->GetTextureXOffset(part);
 	baky = side->GetTextureYOffset(part);
 
-	if (refcount == 0 && oldx == bakx && oldy == baky)
+	if (oldx == bakx && oldy == baky)
 	{
-		UnlinkFromMap();
-		Destroy();
-	}
-	else
-	{
-		side->SetTextureXOffset(part, oldx + (bakx - oldx) * smoothratio);
-		side->SetTextureYOffset(part, oldy + (baky - oldy) * smoothratio);
+		if (refcount == 0)
+		{
+			UnlinkFromMap();
+			Destroy();
+		}
+		return false;
 	}
+	side->SetTextureXOffset(part, oldx + (bakx - oldx) * smoothratio);
+	side->SetTextureYOffset(part, oldy + (baky - oldy) * smoothratio);
+	return true;
 }
 
 //==========================================================================
@@ -827,7 +839,7 @@ void DPolyobjInterpolation::Restore()
 //
 //==========================================================================
 
-void DPolyobjInterpolation::Interpolate(double smoothratio)
+bool DPolyobjInterpolation::Interpolate(double smoothratio)
 {
 	bool changed = false;
 	for(unsigned int i = 0; i < poly->Vertices.Size(); i++)
@@ -843,20 +855,23 @@ void DPolyobjInterpolation::Interpolate(double smoothratio)
 				oldverts[i * 2 + 1] + (bakverts[i * 2 + 1] - oldverts[i * 2 + 1]) * smoothratio);
 		}
 	}
-	if (refcount == 0 && !changed)
+	if (!changed)
 	{
-		UnlinkFromMap();
-		Destroy();
+		if (refcount == 0)
+		{
+			UnlinkFromMap();
+			Destroy();
+		}
+		// A polyobject that did not move does not need its subsector links rebuilt.
+		return false;
 	}
-	else
-	{
-		bakcx = poly->CenterSpot.pos.X;
-		bakcy = poly->CenterSpot.pos.Y;
-		poly->CenterSpot.pos.X = bakcx + (bakcx - oldcx) * smoothratio;
-		poly->CenterSpot.pos.Y = bakcy + (bakcy - oldcy) * smoothratio;
+	bakcx = poly->CenterSpot.pos.X;
+	bakcy = poly->CenterSpot.pos.Y;
+	poly->CenterSpot.pos.X = bakcx + (bakcx - oldcx) * smoothratio;
+	poly->CenterSpot.pos.Y = bakcy + (bakcy - oldcy) * smoothratio;
 
-		poly->ClearSubsectorLinks();
-	}
+	poly->ClearSubsectorLinks();
+	return true;
 }
 
 //==========================================================================
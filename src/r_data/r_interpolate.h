@@ -33,7 +33,8 @@ public:
 	virtual void UnlinkFromMap();
 	virtual void UpdateInterpolation() = 0;
 	virtual void Restore() = 0;
-	virtual void Interpolate(double smoothratio) = 0;
+	// returns false if nothing was changed and Restore does not need to be called.
+	virtual bool Interpolate(double smoothratio) = 0;
 	
 	virtual void Serialize(FSerializer &arc);
 };
@@ -47,6 +48,7 @@ public:
 struct FInterpolator
 {
 	TObjPtr<DInterpolation*> Head = nullptr;
+	TArray<DInterpolation*> Interpolated;	// the ones that need to be restored after rendering.
 	bool didInterp = false;
 	int count = 0;
 
@@ -29,7 +29,6 @@
 #include "stdint.h"
 
 class FTexture;
-int wipe_CalcBurn(uint8_t *buffer, int width, int height, int density);
 
 enum
 {
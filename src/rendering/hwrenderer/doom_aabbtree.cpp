@@ -116,6 +116,7 @@ bool DoomLevelAABBTree::GenerateTree(const FVector2 *centroids, bool dynamicsubt
 bool DoomLevelAABBTree::Update()
 {
 	bool modified = false;
+	changes.Clear();
 	for (unsigned int i = dynamicStartLine; i < mapLines.Size(); i++)
 	{
 		const auto &line = Level->lines[mapLines[i]];
@@ -153,6 +154,14 @@ bool DoomLevelAABBTree::Update()
 					cur.aabb_bottom = MAX(left.aabb_bottom, right.aabb_bottom);
 				}
 
+				const auto &old = treelines[i];
+				AABBTreeChange change;
+				change.left = MIN(MIN(x1, x2), MIN(old.x, old.x + old.dx));
+				change.right = MAX(MAX(x1, x2), MAX(old.x, old.x + old.dx));
+				change.top = MIN(MIN(y1, y2), MIN(old.y, old.y + old.dy));
+				change.bottom = MAX(MAX(y1, y2), MAX(old.y, old.y + old.dy));
+				changes.Push(change);
+
 				treelines[i] = treeline;
 				modified = true;
 			}
@@ -70,14 +70,14 @@ bool GetLight(FDynLightData& dld, int group, Plane & p, FDynamicLight * light, b
 
 //==========================================================================
 //
-// Add one dynamic light to the light data list
+// Sets up the shader data of one light. Returns the light list it belongs in.
 //
 //==========================================================================
-void AddLightToList(FDynLightData &dld, int group, FDynamicLight * light, bool forceAttenuate)
+
+static int MakeLightData(FDynamicLight *light, const DVector3 &pos, float *data)
 {
 	int i = 0;
 
-	DVector3 pos = light->PosRelative(group);
 	float radius = light->GetRadius();
 
 	float cs;
@@ -114,7 +114,7 @@ void AddLightToList(FDynLightData &dld, int group, FDynamicLight * light, bool f
 	}
 	else shadowIndex = 1025.f;
 	// Store attenuate flag in the sign bit of the float.
-	if (light->IsAttenuated() || forceAttenuate) shadowIndex = -shadowIndex;
+	if (light->IsAttenuated()) shadowIndex = -shadowIndex;
 
 	float lightType = 0.0f;
 	float spotInnerAngle = 0.0f;
@@ -136,7 +136,6 @@ void AddLightToList(FDynLightData &dld, int group, FDynamicLight * light, bool f
 		spotDirZ = float(-Angle.Sin() * xzLen);
 	}
 
-	float *data = &dld.arrays[i][dld.arrays[i].Reserve(16)];
 	data[0] = float(pos.X);
 	data[1] = float(pos.Z);
 	data[2] = float(pos.Y);
@@ -153,5 +152,53 @@ void AddLightToList(FDynLightData &dld, int group, FDynamicLight * light, bool f
 	data[13] = spotOuterAngle;
 	data[14] = 0.0f; // unused
 	data[15] = 0.0f; // unused
+	return i;
+}
+
+//==========================================================================
+//
+// The shader data of a light is the same for every surface it touches,
+// as long as the surface is in the light's own portal group. So instead
+// of recalculating it for each surface it is set up once per viewpoint
+// before the scene gets processed. The render threads only read it.
+//
+//==========================================================================
+
+static unsigned LightDataFrame;
+
+void PrepareLightData(FLevelLocals *Level)
+{
+	LightDataFrame++;
+	for (auto light = Level->lights; light; light = light->next)
+	{
+		if (!light->IsActive()) continue;
+		light->mRenderDataArray = MakeLightData(light, light->Pos, light->mRenderData);
+		light->mRenderDataFrame = LightDataFrame;
+	}
+}
+
+//==========================================================================
+//
+// Add one dynamic light to the light data list
+//
+//==========================================================================
+
+void AddLightToList(FDynLightData &dld, int group, FDynamicLight * light, bool forceAttenuate)
+{
+	float *data;
+	if (light->mRenderDataFrame == LightDataFrame && group == light->Sector->PortalGroup)
+	{
+		int i = light->mRenderDataArray;
+		data = &dld.arrays[i][dld.arrays[i].Reserve(16)];
+		memcpy(data, light->mRenderData, sizeof(light->mRenderData));
+	}
+	else
+	{
+		float buffer[16];
+		int i = MakeLightData(light, light->PosRelative(group), buffer);
+		data = &dld.arrays[i][dld.arrays[i].Reserve(16)];
+		memcpy(data, buffer, sizeof(buffer));
+	}
+	if (forceAttenuate && data[7] > 0) data[7] = -data[7];
 }
 
@@ -54,6 +54,8 @@ extern bool NoInterpolateView;
 
 static SWSceneDrawer *swdrawer;
 
+void hw_StreamPrecache(AActor *camera);
+
 void CleanSWDrawer()
 {
 	if (swdrawer) delete swdrawer;
@@ -67,30 +69,48 @@ void CleanSWDrawer()
 void CollectLights(FLevelLocals* Level)
 {
 	IShadowMap* sm = &screen->mShadowMap;
-	int lightindex = 0;
+	bool used[1024] = {};
 
-	// Todo: this should go through the blockmap in a spiral pattern around the player so that closer lights are preferred.
+	// Lights keep their shadowmap row for as long as they are active so that the rows of static lights never need to be rendered again.
 	for (auto light = Level->lights; light; light = light->next)
 	{
 		IShadowMap::LightsProcessed++;
-		if (light->shadowmapped && light->IsActive() && lightindex < 1024)
+		int index = light->mShadowmapIndex;
+		if (light->shadowmapped && light->IsActive() && index < 1024 && !used[index])
 		{
-			IShadowMap::LightsShadowmapped++;
-
-			light->mShadowmapIndex = lightindex;
-			sm->SetLight(lightindex, (float)light->X(), (float)light->Y(), (float)light->Z(), light->GetRadius());
-			lightindex++;
+			used[index] = true;
 		}
 		else
 		{
 			light->mShadowmapIndex = 1024;
 		}
+	}
 
+	// Todo: this should go through the blockmap in a spiral pattern around the player so that closer lights are preferred.
+	int freeindex = 0;
+	for (auto light = Level->lights; light; light = light->next)
+	{
+		if (light->mShadowmapIndex == 1024 && light->shadowmapped && light->IsActive())
+		{
+			while (freeindex < 1024 && used[freeindex]) freeindex++;
+			if (freeindex == 1024) break;
+			used[freeindex] = true;
+			light->mShadowmapIndex = freeindex;
+		}
+	}
+
+	for (auto light = Level->lights; light; light = light->next)
+	{
+		if (light->mShadowmapIndex < 1024)
+		{
+			IShadowMap::LightsShadowmapped++;
+			sm->SetLight(light->mShadowmapIndex, (float)light->X(), (float)light->Y(), (float)light->Z(), light->GetRadius());
+		}
 	}
 
-	for (; lightindex < 1024; lightindex++)
+	for (int lightindex = 0; lightindex < 1024; lightindex++)
 	{
-		sm->SetLight(lightindex, 0, 0, 0, 0);
+		if (!used[lightindex]) sm->SetLight(lightindex, 0, 0, 0, 0);
 	}
 }
 
@@ -119,6 +139,7 @@ sector_t* RenderViewpoint(FRenderViewpoint& mainvp, AActor* camera, IntRect* bou
 	// Update the attenuation flag of all light defaults for each viewpoint.
 	// This function will only do something if the setting differs.
 	FLightDefaults::SetAttenuationForLevel(!!(camera->Level->flags3 & LEVEL3_ATTENUATE));
+	if (camera->Level->HasDynamicLights) PrepareLightData(camera->Level);
 
 	// Render (potentially) multiple views for stereo 3d
 	// Fixme. The view offsetting should be done with a static table and not require setup of the entire render state for the mode.
@@ -365,6 +386,7 @@ sector_t* RenderView(player_t* player)
 		screen->ImageTransitionScene(true); // Only relevant for Vulkan.
 
 		retsec = RenderViewpoint(r_viewpoint, player->camera, NULL, r_viewpoint.FieldOfView.Degrees, ratio, fovratio, true, true);
+		hw_StreamPrecache(player->camera);
 	}
 	All.Unclock();
 	return retsec;
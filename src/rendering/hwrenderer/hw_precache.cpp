@@ -38,11 +38,16 @@
 #include "v_font.h"
 #include "texturemanager.h"
 #include "modelrenderer.h"
+#include "g_levellocals.h"
 #include "hw_models.h"
 #include "d_main.h"
+#include "ctpl.h"
 
 EXTERN_CVAR(Bool, gl_precache)
 
+// How many texture lumps get decompressed in the background ahead of their use while precaching.
+enum { PREFETCH_AHEAD = 16 };
+
 //==========================================================================
 //
 // DFrameBuffer :: PrecacheTexture
@@ -95,8 +100,12 @@ static void PrecacheSprite(FGameTexture *tex, SpriteHits &hits)
 //
 //==========================================================================
 
+void hw_ResetStreamPrecache();
+
 void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitlist)
 {
+	hw_ResetStreamPrecache();
+
 	TMap<FTexture*, bool> allTextures;
 	TArray<FTexture*> layers;
 
@@ -253,6 +262,11 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 						{
 							if (layer.layerTexture) layer.layerTexture->MarkForPrecache(pair->Key, layer.scaleFlags);
 						}
+						if (mat->GetTranslationFlags(pair->Key, CLAMP_XY))
+						{
+							auto &layer = mat->GetLayerArray()[0];
+							layer.layerTexture->MarkForPrecache(FMaterial::TRANSLATION_INDEXED, layer.scaleFlags);
+						}
 					}
 				}
 			}
@@ -275,6 +289,11 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 
 		FImageSource::BeginPrecaching();
 
+		// The source lumps of all images that get created, in the order they will be needed.
+		// Compressed ones get decompressed in the background a few textures ahead of their use.
+		TArray<std::pair<int, int>> prefetchlist;
+		unsigned nextprefetch = 0, consumed = 0;
+
 		// cache all used images
 		for (int i = cnt - 1; i >= 0; i--)
 		{
@@ -282,12 +301,14 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 			auto tex = gtex->GetTexture();
 			if (tex != nullptr && tex->GetImage() != nullptr)
 			{
+				bool used = false;
 				if (texhitlist[i] & (FTextureManager::HIT_Wall | FTextureManager::HIT_Flat | FTextureManager::HIT_Sky))
 				{
 					int flags = shouldUpscale(gtex, UF_Texture);
 					if (tex->GetImage() && tex->GetHardwareTexture(0, flags) == nullptr)
 					{
 						FImageSource::RegisterForPrecache(tex->GetImage(), V_IsTrueColor());
+						used = true;
 					}
 				}
 
@@ -295,13 +316,21 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 				if (spritehitlist[i] != nullptr && (*spritehitlist[i]).CheckKey(0))
 				{
 					FImageSource::RegisterForPrecache(tex->GetImage(), V_IsTrueColor());
+					used = true;
 				}
+				if (used && tex->GetImage()->LumpNum() >= 0) prefetchlist.Push(std::make_pair(i, tex->GetImage()->LumpNum()));
 			}
 		}
 
 		// cache all used textures
 		for (int i = cnt - 1; i >= 0; i--)
 		{
+			while (consumed < prefetchlist.Size() && prefetchlist[consumed].first >= i) consumed++;
+			while (nextprefetch < prefetchlist.Size() && nextprefetch < consumed + PREFETCH_AHEAD)
+			{
+				fileSystem.PrefetchFile(prefetchlist[nextprefetch++].second);
+			}
+
 			auto gtex = TexMan.GameByIndex(i);
 			if (gtex != nullptr)
 			{
@@ -315,8 +344,25 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 
 
 		FImageSource::EndPrecaching();
+		fileSystem.ClearPrefetches();
 
 		// cache all used models
+		// Generating the meshes is independent per model so that part can run in parallel. The upload stays on the main thread.
+		unsigned numthreads = std::thread::hardware_concurrency();
+		if (numthreads > 1)
+		{
+			ctpl::thread_pool pool(numthreads);
+			std::vector<std::future<void>> jobs;
+			for (unsigned i = 0; i < Models.Size(); i++)
+			{
+				if (modellist[i] && !Models[i]->GetVertexBuffer(GLModelRendererType))
+				{
+					jobs.push_back(pool.push([i](int) { Models[i]->PrepareVertexData(); }));
+				}
+			}
+			for (auto &job : jobs) job.get();
+		}
+
 		FModelRenderer* renderer = new FHWModelRenderer(nullptr, *screen->RenderState(), -1);
 		for (unsigned i = 0; i < Models.Size(); i++)
 		{
@@ -334,3 +380,262 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 	delete[] modellist;
 }
 
+
+//==========================================================================
+//
+// Streaming precache
+//
+// Creates the textures, sprites and models of the sections around the
+// camera a few per frame, so that they are ready before they come into
+// view. The search starts from where the camera will be shortly given its
+// current velocity, so sections along the way it moves come first.
+//
+//==========================================================================
+
+CVAR(Int, gl_precache_stream, 2, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// resources created per frame, 0 disables it.
+CVAR(Float, gl_precache_stream_distance, 2048, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+enum
+{
+	STREAM_LOOKAHEAD = 35,		// tics of movement to predict the camera's position
+	STREAM_MAXSECTIONS = 256,	// sections searched per update
+	STREAM_MAXCHECKS = 64,		// queue entries looked at per frame, including the ones that already exist
+};
+
+struct FStreamItem
+{
+	FGameTexture *tex;			// null for models
+	int translation;
+	int scaleflags;
+	int model;
+};
+
+static TArray<FStreamItem> StreamQueue;
+static unsigned StreamPos, StreamPrefetchPos;
+static TArray<int> StreamSectionStamp;	// by section index. Sections whose contents are queued get -1.
+static int StreamStamp;
+static const FSection *StreamLastSection;
+static FLevelLocals *StreamLevel;
+static int StreamMapTime;
+
+//==========================================================================
+//
+// Forgets everything about the previous level.
+//
+//==========================================================================
+
+void hw_ResetStreamPrecache()
+{
+	StreamQueue.Clear();
+	StreamPos = StreamPrefetchPos = 0;
+	StreamSectionStamp.Clear();
+	StreamLastSection = nullptr;
+	StreamLevel = nullptr;
+	fileSystem.ClearPrefetches();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void StreamTexture(FTextureID texid, int translation, bool sprite)
+{
+	if (!texid.isValid()) return;
+	auto tex = TexMan.GetGameTexture(texid, true);
+	if (tex == nullptr || !tex->isValid() || tex->GetTexture()->GetImage() == nullptr) return;
+
+	int scaleflags = sprite ? CTF_Expand : 0;
+	if (shouldUpscale(tex, sprite ? UF_Sprite : UF_Texture)) scaleflags |= CTF_Upscale;
+	StreamQueue.Push({ tex, translation, scaleflags, -1 });
+}
+
+static void StreamActor(AActor *actor)
+{
+	auto remap = GPalette.TranslationToTable(actor->Translation);
+	int translation = remap == nullptr ? 0 : remap->Index;
+
+	FSpriteModelFrame *smf = FindModelFrame(actor->GetClass(), actor->sprite, actor->frame, false);
+	if (smf != nullptr)
+	{
+		for (int i = 0; i < MAX_MODELS_PER_FRAME; i++)
+		{
+			if (smf->skinIDs[i].isValid()) StreamTexture(smf->skinIDs[i], 0, false);
+			if (smf->modelIDs[i] != -1) StreamQueue.Push({ nullptr, 0, 0, smf->modelIDs[i] });
+		}
+		return;
+	}
+	if ((unsigned)actor->sprite >= sprites.Size()) return;
+
+	// Queue all of the sprite's frames because the actor is likely to go through them.
+	auto &spr = sprites[actor->sprite];
+	for (int j = 0; j < spr.numframes; j++)
+	{
+		const spriteframe_t *frame = &SpriteFrames[spr.spriteframes + j];
+		for (int k = 0; k < 16; k++)
+		{
+			// Frames without rotations repeat the same texture.
+			if (k > 0 && frame->Texture[k] == frame->Texture[k - 1]) continue;
+			StreamTexture(frame->Texture[k], translation, true);
+		}
+	}
+}
+
+static void StreamSection(const FSection *section)
+{
+	auto sector = section->sector;
+	StreamTexture(sector->GetTexture(sector_t::floor), 0, false);
+	StreamTexture(sector->GetTexture(sector_t::ceiling), 0, false);
+	for (auto side : section->sides)
+	{
+		for (int i = 0; i < 3; i++) StreamTexture(side->GetTexture(i), 0, false);
+	}
+	// The sector's actors only need to be done once.
+	if (section == &sector->Level->sections.SectionsForSector(sector)[0])
+	{
+		for (AActor *actor = sector->thinglist; actor != nullptr; actor = actor->snext)
+		{
+			if (!(actor->renderflags & RF_INVISIBLE)) StreamActor(actor);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Searches outward from the predicted position through the section
+// adjacency and queues the contents of all sections within range that
+// were not done before, nearest first.
+//
+//==========================================================================
+
+static void StreamUpdateSections(FLevelLocals *Level, const FSection *start, const DVector2 &pos)
+{
+	auto &allSections = Level->sections.allSections;
+	if (StreamSectionStamp.Size() != allSections.Size())
+	{
+		StreamSectionStamp.Resize(allSections.Size());
+		memset(StreamSectionStamp.Data(), 0, StreamSectionStamp.Size() * sizeof(int));
+	}
+	if (++StreamStamp == INT_MAX) StreamStamp = 1;
+
+	BoundingRect point(true);
+	point.addVertex(pos.X, pos.Y);
+	double maxdist = gl_precache_stream_distance;
+
+	TArray<std::pair<double, const FSection*>> found;
+	TArray<const FSection*> open;
+	open.Push(start);
+	auto mark = [&](const FSection *sect) -> bool
+	{
+		int &stamp = StreamSectionStamp[Level->sections.SectionIndex(sect)];
+		if (stamp == StreamStamp || stamp < 0) return false;
+		stamp = StreamStamp;
+		return true;
+	};
+	mark(start);
+
+	for (unsigned i = 0; i < open.Size(); i++)
+	{
+		auto sect = open[i];
+		found.Push(std::make_pair(sect->bounds.distanceTo(point), sect));
+		for (auto &line : sect->segments)
+		{
+			if (line.partner == nullptr || line.partner->section == nullptr || open.Size() >= STREAM_MAXSECTIONS) continue;
+			auto other = line.partner->section;
+			if (other->bounds.distanceTo(point) <= maxdist && mark(other)) open.Push(other);
+		}
+	}
+
+	std::sort(found.begin(), found.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+	for (auto &f : found)
+	{
+		StreamSectionStamp[Level->sections.SectionIndex(f.second)] = -1;
+		StreamSection(f.second);
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool StreamItemExists(const FStreamItem &item, FMaterial **pmat)
+{
+	if (item.tex == nullptr) return Models[item.model]->GetVertexBuffer(GLModelRendererType) != nullptr;
+
+	auto mat = FMaterial::ValidateTexture(item.tex, item.scaleflags);
+	*pmat = mat;
+	if (mat == nullptr) return true;
+	auto &layer = mat->GetLayerArray()[0];
+	int translation = item.translation;
+	if (mat->GetTranslationFlags(translation, CLAMP_NONE)) translation = FMaterial::TRANSLATION_INDEXED;
+	return layer.layerTexture->SystemTextures.GetHardwareTexture(translation, layer.scaleFlags) != nullptr;
+}
+
+void hw_StreamPrecache(AActor *camera)
+{
+	if (gl_precache_stream <= 0 || camera == nullptr || camera->section == nullptr) return;
+
+	auto Level = camera->Level;
+	if (Level != StreamLevel || Level->maptime < StreamMapTime)
+	{
+		// Demo playback does not run the level start precache so a new level needs to be detected here as well.
+		hw_ResetStreamPrecache();
+		StreamLevel = Level;
+	}
+	StreamMapTime = Level->maptime;
+	if (camera->section != StreamLastSection)
+	{
+		StreamLastSection = camera->section;
+		// Drop what was queued for the previous area but not done yet. Anything still in range gets found again.
+		if (StreamPos >= StreamQueue.Size() / 2)
+		{
+			StreamQueue.Delete(0, StreamPos);
+			StreamPrefetchPos -= MIN(StreamPrefetchPos, StreamPos);
+			StreamPos = 0;
+		}
+		StreamUpdateSections(Level, camera->section, camera->Pos().XY() + camera->Vel.XY() * STREAM_LOOKAHEAD);
+	}
+
+	// Start decompressing the images a bit ahead of their use.
+	while (StreamPrefetchPos < StreamQueue.Size() && StreamPrefetchPos < StreamPos + PREFETCH_AHEAD)
+	{
+		auto &item = StreamQueue[StreamPrefetchPos++];
+		FMaterial *mat;
+		if (item.tex != nullptr && !StreamItemExists(item, &mat))
+		{
+			int lump = item.tex->GetTexture()->GetImage()->LumpNum();
+			if (lump >= 0) fileSystem.PrefetchFile(lump);
+		}
+	}
+
+	FModelRenderer *renderer = nullptr;
+	int created = 0;
+	for (int checks = 0; StreamPos < StreamQueue.Size() && checks < STREAM_MAXCHECKS && created < gl_precache_stream; checks++)
+	{
+		auto &item = StreamQueue[StreamPos++];
+		FMaterial *mat = nullptr;
+		if (StreamItemExists(item, &mat)) continue;
+
+		if (item.tex != nullptr)
+		{
+			screen->PrecacheMaterial(mat, item.translation);
+		}
+		else
+		{
+			if (renderer == nullptr) renderer = new FHWModelRenderer(nullptr, *screen->RenderState(), -1);
+			Models[item.model]->BuildVertexBuffer(renderer);
+		}
+		created++;
+	}
+	delete renderer;
+
+	if (StreamPos == StreamQueue.Size())
+	{
+		StreamQueue.Clear();
+		StreamPos = StreamPrefetchPos = 0;
+		fileSystem.ClearPrefetches();
+	}
+}
@@ -26,6 +26,7 @@
 #include "hw_vertexbuilder.h"
 #include "flatvertices.h"
 #include "earcut.hpp"
+#include "ctpl.h"
 
 
 //=============================================================================
@@ -138,12 +139,46 @@ static void CreateVerticesForSector(sector_t *sec, VertexContainer &gen)
 }
 
 
+//==========================================================================
+//
+// Every sector only writes to its own container, so large maps split the
+// sectors into one block per thread. The result does not depend on how the
+// work was divided.
+//
+//==========================================================================
+
 TArray<VertexContainer> BuildVertices(TArray<sector_t> &sectors)
 {
+	enum { MIN_SECTORS_PER_THREAD = 256 };
+
 	TArray<VertexContainer> verticesPerSector(sectors.Size(), true);
-	for (unsigned i=0; i< sectors.Size(); i++)
+	unsigned numthreads = std::thread::hardware_concurrency();
+	numthreads = MIN(numthreads, sectors.Size() / MIN_SECTORS_PER_THREAD);
+
+	if (numthreads > 1)
 	{
-		CreateVerticesForSector(&sectors[i], verticesPerSector[i]);
+		ctpl::thread_pool pool(numthreads);
+		std::vector<std::future<void>> jobs;
+		unsigned blocksize = (sectors.Size() + numthreads - 1) / numthreads;
+		for (unsigned start = 0; start < sectors.Size(); start += blocksize)
+		{
+			unsigned end = MIN(start + blocksize, sectors.Size());
+			jobs.push_back(pool.push([&sectors, &verticesPerSector, start, end](int)
+			{
+				for (unsigned i = start; i < end; i++)
+				{
+					CreateVerticesForSector(&sectors[i], verticesPerSector[i]);
+				}
+			}));
+		}
+		for (auto &job : jobs) job.get();
+	}
+	else
+	{
+		for (unsigned i=0; i< sectors.Size(); i++)
+		{
+			CreateVerticesForSector(&sectors[i], verticesPerSector[i]);
+		}
 	}
 	return verticesPerSector;
 }
@@ -395,7 +430,8 @@ void CreateVBO(FFlatVertexBuffer* fvb, TArray<sector_t>& sectors)
 {
 	fvb->vbo_shadowdata.Resize(fvb->mNumReserved);
 	CreateVertices(fvb, sectors);
-	fvb->mCurIndex = fvb->mIndex = fvb->vbo_shadowdata.Size();
+	fvb->mIndex = fvb->vbo_shadowdata.Size();
+	fvb->Reset();
 	fvb->Copy(0, fvb->mIndex);
 	fvb->mIndexBuffer->SetData(fvb->ibo_data.Size() * sizeof(uint32_t), &fvb->ibo_data[0]);
 }
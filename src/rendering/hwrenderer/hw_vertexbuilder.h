@@ -70,4 +70,5 @@ VertexContainers BuildVertices(TArray<sector_t> &sectors);
 class FFlatVertexBuffer;
 void CheckUpdate(FFlatVertexBuffer* fvb, sector_t* sector);
 void CreateVBO(FFlatVertexBuffer* fvb, TArray<sector_t>& sectors);
+void InitWallVertexCache(FFlatVertexBuffer* fvb, unsigned numsegs);
 
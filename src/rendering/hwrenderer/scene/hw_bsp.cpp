@@ -39,17 +39,25 @@
 #include "hwrenderer/scene/hw_drawstructs.h"
 #include "hwrenderer/scene/hw_drawinfo.h"
 #include "hwrenderer/scene/hw_portal.h"
+#include "hwrenderer/scene/hw_occlusion.h"
 #include "hw_clock.h"
 #include "flatvertices.h"
 #include "hw_vertexbuilder.h"
 
-#ifdef ARCH_IA32
-#include <immintrin.h>
-#endif // ARCH_IA32
+#include "jobqueue.h"
+#include "zonetrace.h"
 
 CVAR(Bool, gl_multithread, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CUSTOM_CVAR(Int, gl_multithread_workers, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	// 0 means to pick a count based on the available hardware threads.
+	if (self < 0) self = 0;
+	else if (self > MAX_RENDER_WORKERS) self = MAX_RENDER_WORKERS;
+}
 
 thread_local bool isWorkerThread;
+thread_local HWDrawList *workerDrawLists;
+std::recursive_mutex SceneDataLock;
 ctpl::thread_pool renderPool(1);
 bool inited = false;
 
@@ -62,7 +70,6 @@ struct RenderJob
 		SpriteJob,
 		ParticleJob,
 		PortalJob,
-		TerminateJob	// inserted when all work is done so that the worker can return.
 	};
 	
 	int type;
@@ -70,74 +77,82 @@ struct RenderJob
 	seg_t *seg;
 };
 
+// One static queue is sufficient here. This code will never be called recursively.
+// Each worker has its own lane in the queue and steals from the others once it runs out of work.
+static TWorkStealingQueue<RenderJob> jobQueue;
+static HWDrawList workerLists[MAX_RENDER_WORKERS][GLDL_TYPES];
 
-class RenderJobQueue
+static void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
 {
-	RenderJob pool[300000];	// Way more than ever needed. The largest ever seen on a single viewpoint is around 40000.
-	std::atomic<int> readindex{};
-	std::atomic<int> writeindex{};
-public:
-	void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
+	// The lanes are sized so that this should never fail. The largest ever seen on a single viewpoint is around 40000 jobs.
+	if (!jobQueue.Push({ type, sub, seg }))
 	{
-		// This does not check for array overflows. The pool should be large enough that it never hits the limit.
-
-		pool[writeindex] = { type, sub, seg };
-		writeindex++;	// update index only after the value has been written.
+		I_FatalError("Render job queue overflow");
 	}
+}
 
-	RenderJob *GetJob()
+//==========================================================================
+//
+// Gets the number of worker threads to use for the current scene
+//
+//==========================================================================
+
+int HWDrawInfo::GetNumRenderWorkers()
+{
+	int numworkers = gl_multithread_workers;
+	if (numworkers == 0)
 	{
-		if (readindex < writeindex) return &pool[readindex++];
-		return nullptr;
+		// leave one hardware thread for the main thread which does the BSP traversal.
+		numworkers = clamp<int>(std::thread::hardware_concurrency() - 1, 1, MAX_RENDER_WORKERS);
 	}
-	
-	void ReleaseAll()
+	return numworkers;
+}
+
+//==========================================================================
+//
+// Moves all items the workers collected into the main draw lists.
+// Must be done before the lists get sorted.
+//
+//==========================================================================
+
+void HWDrawInfo::MergeWorkerDrawLists(int numworkers)
+{
+	for (int i = 0; i < numworkers; i++)
 	{
-		readindex = 0;
-		writeindex = 0;
+		for (int j = 0; j < GLDL_TYPES; j++)
+		{
+			drawlists[j].Append(workerLists[i][j]);
+		}
 	}
-};
-
-static RenderJobQueue jobQueue;	// One static queue is sufficient here. This code will never be called recursively.
+}
 
-void HWDrawInfo::WorkerThread()
+void HWDrawInfo::WorkerThread(int worker)
 {
 	sector_t *front, *back;
 
-	WTTotal.Clock();
+	// The cycle counters are not thread safe so only the first worker gets timed.
+	const bool timed = worker == 0;
+
+	if (timed) WTTotal.Clock();
 	isWorkerThread = true;	// for adding asserts in GL API code. The worker thread may never call any GL API.
-	while (true)
+
+	// With a single worker everything can go directly into the main draw lists.
+	if (jobQueue.NumLanes() > 1)
+	{
+		workerDrawLists = workerLists[worker];
+		RenderDataArena = GetWorkerDataAllocator(worker);
+	}
+
+	while (auto job = jobQueue.WaitForJob(worker))
 	{
-		auto job = jobQueue.GetJob();
-		if (job == nullptr)
-		{
-#ifdef ARCH_IA32
-			// The queue is empty. But yielding would be too costly here and possibly cause further delays down the line if the thread is halted.
-			// So instead add a few pause instructions and retry immediately.
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-#endif // ARCH_IA32
-		}
 		// Note that the main thread MUST have prepared the fake sectors that get used below!
 		// This worker thread cannot prepare them itself without costly synchronization.
-		else switch (job->type)
+		switch (job->type)
 		{
-		case RenderJob::TerminateJob:
-			WTTotal.Unclock();
-			return;
-
 		case RenderJob::WallJob:
 		{
 			HWWall wall;
-			SetupWall.Clock();
+			if (timed) SetupWall.Clock();
 			wall.sub = job->sub;
 
 			front = hw_FakeFlat(job->sub->sector, in_area, false);
@@ -157,46 +172,45 @@ void HWDrawInfo::WorkerThread()
 
 			wall.Process(this, job->seg, front, back);
 			rendered_lines++;
-			SetupWall.Unclock();
+			if (timed) SetupWall.Unclock();
 			break;
 		}
 
 		case RenderJob::FlatJob:
 		{
 			HWFlat flat;
-			SetupFlat.Clock();
+			if (timed) SetupFlat.Clock();
 			flat.section = job->sub->section;
 			front = hw_FakeFlat(job->sub->render_sector, in_area, false);
 			flat.ProcessSector(this, front);
-			SetupFlat.Unclock();
+			if (timed) SetupFlat.Unclock();
 			break;
 		}
 
 		case RenderJob::SpriteJob:
-			SetupSprite.Clock();
+			if (timed) SetupSprite.Clock();
 			front = hw_FakeFlat(job->sub->sector, in_area, false);
 			RenderThings(job->sub, front);
-			SetupSprite.Unclock();
+			if (timed) SetupSprite.Unclock();
 			break;
 
 		case RenderJob::ParticleJob:
-			SetupSprite.Clock();
+			if (timed) SetupSprite.Clock();
 			front = hw_FakeFlat(job->sub->sector, in_area, false);
 			RenderParticles(job->sub, front);
-			SetupSprite.Unclock();
+			if (timed) SetupSprite.Unclock();
 			break;
 
 		case RenderJob::PortalJob:
 			AddSubsectorToPortal((FSectorPortalGroup *)job->seg, job->sub);
 			break;
 		}
-
 	}
-}
-
-
-
 
+	workerDrawLists = nullptr;
+	RenderDataArena = &RenderDataAllocator;
+	if (timed) WTTotal.Unclock();
+}
 
 EXTERN_CVAR(Bool, gl_render_segs)
 
@@ -329,7 +343,7 @@ void HWDrawInfo::AddLine (seg_t *seg, bool portalclip)
 		{
 			if (multithread)
 			{
-				jobQueue.AddJob(RenderJob::WallJob, seg->Subsector, seg);
+				AddJob(RenderJob::WallJob, seg->Subsector, seg);
 			}
 			else
 			{
@@ -393,7 +407,7 @@ void HWDrawInfo::RenderPolyBSPNode (void *node)
 		side ^= 1;
 
 		// It is not necessary to use the slower precise version here
-		if (!mClipper->CheckBox(bsp->bbox[side]))
+		if (!mClipper->CheckBox(bsp->bbox[side]) || (OcclusionCuller.IsActive() && OcclusionCuller.IsOccluded(bsp, side)))
 		{
 			return;
 		}
@@ -515,11 +529,24 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 	sector_t * sec=sub->sector;
 	// Handle all things in sector.
     const auto &vp = Viewpoint;
+	// Things touching more than one sector can be reached by several workers at once,
+	// so with more than one of them the validcount check must be synchronized.
+	const bool lockthings = multithread && jobQueue.NumLanes() > 1;
+
 	for (auto p = sec->touching_renderthings; p != nullptr; p = p->m_snext)
 	{
 		auto thing = p->m_thing;
-		if (thing->validcount == validcount) continue;
-		thing->validcount = validcount;
+		if (lockthings)
+		{
+			std::lock_guard<std::recursive_mutex> lock(SceneDataLock);
+			if (thing->validcount == validcount) continue;
+			thing->validcount = validcount;
+		}
+		else
+		{
+			if (thing->validcount == validcount) continue;
+			thing->validcount = validcount;
+		}
 
 		FIntCVar *cvar = thing->GetInfo()->distancecheck;
 		if (cvar != nullptr && *cvar >= 0)
@@ -560,7 +587,6 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 
 void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 {
-	SetupSprite.Clock();
 	for (int i = Level->ParticlesInSubsec[sub->Index()]; i != NO_PARTICLE; i = Level->Particles[i].snext)
 	{
 		if (mClipPortal)
@@ -572,7 +598,6 @@ void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 		HWSprite sprite;
 		sprite.ProcessParticle(this, &Level->Particles[i], front);
 	}
-	SetupSprite.Unclock();
 }
 
 
@@ -637,7 +662,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 	{
 		if (multithread)
 		{
-			jobQueue.AddJob(RenderJob::ParticleJob, sub, nullptr);
+			AddJob(RenderJob::ParticleJob, sub, nullptr);
 		}
 		else
 		{
@@ -663,7 +688,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 		{
 			if (multithread)
 			{
-				jobQueue.AddJob(RenderJob::SpriteJob, sub, nullptr);
+				AddJob(RenderJob::SpriteJob, sub, nullptr);
 			}
 			else
 			{
@@ -700,7 +725,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 
 					if (multithread)
 					{
-						jobQueue.AddJob(RenderJob::FlatJob, sub);
+						AddJob(RenderJob::FlatJob, sub);
 					}
 					else
 					{
@@ -729,7 +754,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 				{
 					if (multithread)
 					{
-						jobQueue.AddJob(RenderJob::PortalJob, sub, (seg_t *)portal);
+						AddJob(RenderJob::PortalJob, sub, (seg_t *)portal);
 					}
 					else
 					{
@@ -742,7 +767,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 				{
 					if (multithread)
 					{
-						jobQueue.AddJob(RenderJob::PortalJob, sub, (seg_t *)portal);
+						AddJob(RenderJob::PortalJob, sub, (seg_t *)portal);
 					}
 					else
 					{
@@ -800,6 +825,7 @@ void HWDrawInfo::RenderBSPNode (void *node)
 
 void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 {
+	TRACE_ZONE("RenderBSP");
 	Bsp.Clock();
 
 	// Give the DrawInfo the viewpoint in fixed point because that's what the nodes are.
@@ -808,19 +834,39 @@ void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 
 	validcount++;	// used for processing sidedefs only once by the renderer.
 
+	// Occlusion culling is only done for the main view. Portals get clipped to their own area anyway.
+	if (drawpsprites) OcclusionCuller.BeginScene(Level, VPUniforms);
+
 	multithread = gl_multithread;
 	if (multithread)
 	{
+		int numworkers = GetNumRenderWorkers();
+		if (jobQueue.NumLanes() != (unsigned)numworkers)
+		{
+			jobQueue.Init(numworkers, 300000 / numworkers + 1024);	// Way more than ever needed.
+			if (renderPool.size() != numworkers) renderPool.resize(numworkers);
+		}
+		if (numworkers > 1)
+		{
+			// The worker arenas must be created here because the workers cannot safely do it themselves.
+			for (int i = 0; i < numworkers; i++) GetWorkerDataAllocator(i);
+		}
+
 		jobQueue.ReleaseAll();
-		auto future = renderPool.push([&](int id) {
-			WorkerThread();
-		});
+		std::future<void> futures[MAX_RENDER_WORKERS];
+		for (int i = 0; i < numworkers; i++)
+		{
+			futures[i] = renderPool.push([=](int id) {
+				WorkerThread(i);
+			});
+		}
 		RenderBSPNode(node);
 
-		jobQueue.AddJob(RenderJob::TerminateJob, nullptr, nullptr);
+		jobQueue.Finish();
 		Bsp.Unclock();
 		MTWait.Clock();
-		future.wait();
+		for (int i = 0; i < numworkers; i++) futures[i].wait();
+		if (numworkers > 1) MergeWorkerDrawLists(numworkers);
 		MTWait.Unclock();
 	}
 	else
@@ -828,6 +874,7 @@ void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 		RenderBSPNode(node);
 		Bsp.Unclock();
 	}
+	OcclusionCuller.EndScene();
 	// Process all the sprites on the current portal's back side which touch the portal.
 	if (mCurrentPortal != nullptr) mCurrentPortal->RenderAttached(this);
 
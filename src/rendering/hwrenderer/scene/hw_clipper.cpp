@@ -38,6 +38,7 @@
 #include "hw_clipper.h"
 #include "g_levellocals.h"
 #include "basics.h"
+#include <algorithm>
 
 unsigned Clipper::starttime;
 
@@ -48,23 +49,17 @@ Clipper::Clipper()
 
 //-----------------------------------------------------------------------------
 //
-// RemoveRange
+// FirstRange
+//
+// Returns the index of the first range ending at or after the given angle.
+// None of the ranges before it can be affected by anything starting there.
 //
 //-----------------------------------------------------------------------------
 
-void Clipper::RemoveRange(ClipNode * range)
+static unsigned FirstRange(const TArray<ClipRange> &list, angle_t angle)
 {
-	if (range == cliphead)
-	{
-		cliphead = cliphead->next;
-	}
-	else
-	{
-		if (range->prev) range->prev->next = range->next;
-		if (range->next) range->next->prev = range->prev;
-	}
-	
-	Free(range);
+	auto data = list.Data();
+	return unsigned(std::partition_point(data, data + list.Size(), [=](const ClipRange &r) { return r.end < angle; }) - data);
 }
 
 //-----------------------------------------------------------------------------
@@ -75,27 +70,9 @@ void Clipper::RemoveRange(ClipNode * range)
 
 void Clipper::Clear()
 {
-	ClipNode *node = cliphead;
-	ClipNode *temp;
-	
 	blocked = false;
-	while (node != NULL)
-	{
-		temp = node;
-		node = node->next;
-		Free(temp);
-	}
-	node = silhouette;
-
-	while (node != NULL)
-	{
-		temp = node;
-		node = node->next;
-		Free(temp);
-	}
-	
-	cliphead = NULL;
-	silhouette = NULL;
+	ranges.Clear();
+	silhouette.Clear();
 	starttime++;
 }
 
@@ -107,17 +84,9 @@ void Clipper::Clear()
 
 void Clipper::SetSilhouette()
 {
-	ClipNode *node = cliphead;
-	ClipNode *last = NULL;
-
-	while (node != NULL)
+	if (silhouette.Size() == 0)
 	{
-		ClipNode *snode = NewRange(node->start, node->end);
-		if (silhouette == NULL) silhouette = snode;
-		snode->prev = last;
-		if (last != NULL) last->next = snode;
-		last = snode;
-		node = node->next;
+		silhouette = ranges;
 	}
 }
 
@@ -125,25 +94,37 @@ void Clipper::SetSilhouette()
 //
 // IsRangeVisible
 //
+// Only the last range starting before the checked one can contain it.
+//
 //-----------------------------------------------------------------------------
 
 bool Clipper::IsRangeVisible(angle_t startAngle, angle_t endAngle)
 {
-	ClipNode *ci;
-	ci = cliphead;
-	
-	if (endAngle==0 && ci && ci->start==0) return false;
-	
-	while (ci != NULL && ci->start < endAngle)
+	unsigned count = ranges.Size();
+	auto data = ranges.Data();
+
+	if (endAngle == 0 && count > 0 && data[0].start == 0) return false;
+
+	if (startAngle > endAngle)
 	{
-		if (startAngle >= ci->start && endAngle <= ci->end)
+		for (unsigned i = 0; i < count && data[i].start < endAngle; i++)
 		{
-			return false;
+			if (startAngle >= data[i].start && endAngle <= data[i].end) return false;
 		}
-		ci = ci->next;
+		return true;
 	}
-	
-	return true;
+
+	// For an empty range the candidate must start before it, otherwise at or before its start.
+	unsigned i;
+	if (startAngle < endAngle)
+	{
+		i = unsigned(std::partition_point(data, data + count, [=](const ClipRange &r) { return r.start <= startAngle; }) - data);
+	}
+	else
+	{
+		i = unsigned(std::partition_point(data, data + count, [=](const ClipRange &r) { return r.start < startAngle; }) - data);
+	}
+	return i == 0 || endAngle > data[i - 1].end;
 }
 
 //-----------------------------------------------------------------------------
@@ -154,99 +135,64 @@ bool Clipper::IsRangeVisible(angle_t startAngle, angle_t endAngle)
 
 void Clipper::AddClipRange(angle_t start, angle_t end)
 {
-	ClipNode *node, *temp, *prevNode;
-
-	if (cliphead)
+	if (ranges.Size() > 0)
 	{
+		unsigned first = FirstRange(ranges, start);
+
 		//check to see if range contains any old ranges
-		node = cliphead;
-		while (node != NULL && node->start < end)
+		for (unsigned i = first; i < ranges.Size() && ranges[i].start < end;)
 		{
-			if (node->start >= start && node->end <= end)
+			if (ranges[i].start >= start && ranges[i].end <= end)
 			{
-				temp = node;
-				node = node->next;
-				RemoveRange(temp);
+				ranges.Delete(i);
 			}
-			else if (node->start<=start && node->end>=end)
+			else if (ranges[i].start <= start && ranges[i].end >= end)
 			{
 				return;
 			}
 			else
 			{
-				node = node->next;
+				i++;
 			}
 		}
-		
+
 		//check to see if range overlaps a range (or possibly 2)
-		node = cliphead;
-		while (node != NULL && node->start <= end)
+		if (first < ranges.Size() && ranges[first].start <= end)
 		{
-			if (node->end >= start)
+			// we found the first overlapping range
+			auto &range = ranges[first];
+			if (range.start > start)
 			{
-				// we found the first overlapping node
-				if (node->start > start)
-				{
-					// the new range overlaps with this node's start point
-					node->start = start;
-				}
-
-				if (node->end < end) 
-				{
-					node->end = end;
-				}
-
-				ClipNode *node2 = node->next;
-				while (node2 && node2->start <= node->end)
-				{
-					if (node2->end > node->end) node->end = node2->end;
-					ClipNode *delnode = node2;
-					node2 = node2->next;
-					RemoveRange(delnode);
-				}
-				return;
+				// the new range overlaps with this range's start point
+				range.start = start;
 			}
-			node = node->next;		
-		}
-		
-		//just add range
-		node = cliphead;
-		prevNode = NULL;
-		temp = NewRange(start, end);
-		
-		while (node != NULL && node->start < end)
-		{
-			prevNode = node;
-			node = node->next;
-		}
-		
-		temp->next = node;
-		if (node == NULL)
-		{
-			temp->prev = prevNode;
-			if (prevNode) prevNode->next = temp;
-			if (!cliphead) cliphead = temp;
-		}
-		else
-		{
-			if (node == cliphead)
+
+			if (range.end < end)
 			{
-				cliphead->prev = temp;
-				cliphead = temp;
+				range.end = end;
 			}
-			else
+
+			unsigned next = first + 1;
+			while (next < ranges.Size() && ranges[next].start <= range.end)
 			{
-				temp->prev = prevNode;
-				prevNode->next = temp;
-				node->prev = temp;
+				if (ranges[next].end > range.end) range.end = ranges[next].end;
+				next++;
 			}
+			ranges.Delete(first + 1, next - first - 1);
+			return;
+		}
+
+		//just add range
+		unsigned i = first;
+		while (i < ranges.Size() && ranges[i].start < end)
+		{
+			i++;
 		}
+		ranges.Insert(i, { start, end });
 	}
 	else
 	{
-		temp = NewRange(start, end);
-		cliphead = temp;
-		return;
+		ranges.Push({ start, end });
 	}
 }
 
@@ -259,26 +205,23 @@ void Clipper::AddClipRange(angle_t start, angle_t end)
 
 void Clipper::RemoveClipRange(angle_t start, angle_t end)
 {
-	ClipNode *node;
-
-	if (silhouette)
+	if (silhouette.Size() > 0)
 	{
-		node = silhouette;
-		while (node != NULL && node->end <= start)
-		{
-			node = node->next;
-		}
-		if (node != NULL && node->start <= start)
+		auto data = silhouette.Data();
+		unsigned count = silhouette.Size();
+		unsigned i = unsigned(std::partition_point(data, data + count, [=](const ClipRange &r) { return r.end <= start; }) - data);
+
+		if (i < count && data[i].start <= start)
 		{
-			if (node->end >= end) return;
-			start = node->end;
-			node = node->next;
+			if (data[i].end >= end) return;
+			start = data[i].end;
+			i++;
 		}
-		while (node != NULL && node->start < end)
+		while (i < count && data[i].start < end)
 		{
-			DoRemoveClipRange(start, node->start);
-			start = node->end;
-			node = node->next;
+			DoRemoveClipRange(start, data[i].start);
+			start = data[i].end;
+			i++;
 		}
 		if (start >= end) return;
 	}
@@ -293,50 +236,43 @@ void Clipper::RemoveClipRange(angle_t start, angle_t end)
 
 void Clipper::DoRemoveClipRange(angle_t start, angle_t end)
 {
-	ClipNode *node, *temp;
-
-	if (cliphead)
+	if (ranges.Size() > 0)
 	{
+		unsigned first = FirstRange(ranges, start);
+
 		//check to see if range contains any old ranges
-		node = cliphead;
-		while (node != NULL && node->start < end)
+		for (unsigned i = first; i < ranges.Size() && ranges[i].start < end;)
 		{
-			if (node->start >= start && node->end <= end)
+			if (ranges[i].start >= start && ranges[i].end <= end)
 			{
-				temp = node;
-				node = node->next;
-				RemoveRange(temp);
+				ranges.Delete(i);
 			}
 			else
 			{
-				node = node->next;
+				i++;
 			}
 		}
 		
 		//check to see if range overlaps a range (or possibly 2)
-		node = cliphead;
-		while (node != NULL)
+		for (unsigned i = first; i < ranges.Size() && ranges[i].start <= end; i++)
 		{
-			if (node->start >= start && node->start <= end)
+			auto &range = ranges[i];
+			if (range.start >= start)
 			{
-				node->start = end;
+				range.start = end;
 				break;
 			}
-			else if (node->end >= start && node->end <= end)
+			else if (range.end <= end)
 			{
-				node->end=start;
+				range.end = start;
 			}
-			else if (node->start < start && node->end > end)
+			else if (range.start < start && range.end > end)
 			{
-				temp = NewRange(end, node->end);
-				node->end=start;
-				temp->next=node->next;
-				temp->prev=node;
-				node->next=temp;
-				if (temp->next) temp->next->prev=temp;
+				ClipRange split = { end, range.end };
+				range.end = start;
+				ranges.Insert(i + 1, split);
 				break;
 			}
-			node = node->next;
 		}
 	}
 }
@@ -4,37 +4,27 @@
 #include "doomtype.h"
 #include "xs_Float.h"
 #include "r_utility.h"
-#include "memarena.h"
+#include "tarray.h"
 
-class ClipNode
+// The clip ranges are kept in a flat array, sorted by their start angle. They never
+// overlap but adjacent ranges may touch, so their end angles are sorted as well.
+struct ClipRange
 {
-	friend class Clipper;
-	
-	ClipNode *prev, *next;
 	angle_t start, end;
-
-	bool operator== (const ClipNode &other)
-	{
-		return other.start == start && other.end == end;
-	}
 };
 
 
 class Clipper
 {
 	static unsigned starttime;
-	FMemArena nodearena;
-	ClipNode * freelist = nullptr;
 
-	ClipNode * clipnodes = nullptr;
-	ClipNode * cliphead = nullptr;
-	ClipNode * silhouette = nullptr;	// will be preserved even when RemoveClipRange is called
+	TArray<ClipRange> ranges;
+	TArray<ClipRange> silhouette;	// will be preserved even when RemoveClipRange is called
     const FRenderViewpoint *viewpoint = nullptr;
 	bool blocked = false;
 
 	static angle_t AngleToPseudo(angle_t ang);
 	bool IsRangeVisible(angle_t startangle, angle_t endangle);
-	void RemoveRange(ClipNode * cn);
 	void AddClipRange(angle_t startangle, angle_t endangle);
 	void RemoveClipRange(angle_t startangle, angle_t endangle);
 	void DoRemoveClipRange(angle_t start, angle_t end);
@@ -45,33 +35,6 @@ public:
 
 	void Clear();
 
-	void Free(ClipNode *node)
-	{
-		node->next = freelist;
-		freelist = node;
-	}
-
-	ClipNode * GetNew()
-	{
-		if (freelist)
-		{
-			ClipNode * p = freelist;
-			freelist = p->next;
-			return p;
-		}
-		else return (ClipNode*)nodearena.Alloc(sizeof(ClipNode));
-	}
-
-	ClipNode * NewRange(angle_t start, angle_t end)
-	{
-		ClipNode * c = GetNew();
-
-		c->start = start;
-		c->end = end;
-		c->next = c->prev = NULL;
-		return c;
-	}
-    
     void SetViewpoint(const FRenderViewpoint &vp)
     {
         viewpoint = &vp;
@@ -123,6 +123,8 @@ void HWDrawInfo::DrawDecals(FRenderState &state, TArray<HWDecal *> &decals)
 	side_t *wall = nullptr;
 	state.SetDepthMask(false);
 	state.SetDepthBias(-1, -128);
+	// Decals on the same wall mostly share texture, style and light, so let the backend coalesce them.
+	state.EnableDrawBatching(true);
 	for (auto gldecal : decals)
 	{
 		if (gldecal->decal->Side != wall)
@@ -140,6 +142,7 @@ void HWDrawInfo::DrawDecals(FRenderState &state, TArray<HWDecal *> &decals)
 		}
 		gldecal->DrawDecal(this, state);
 	}
+	state.EnableDrawBatching(false);
 	state.EnableSplit(false);
 	state.ClearDepthBias();
 	state.SetTextureMode(TM_NORMAL);
@@ -157,6 +160,7 @@ void HWWall::DrawDecalsForMirror(HWDrawInfo *di, FRenderState &state, TArray<HWD
 	state.SetDepthMask(false);
 	state.SetDepthBias(-1, -128);
 	di->SetFog(state, lightlevel, rellight + getExtraLight(), di->isFullbrightScene(), &Colormap, false);
+	state.EnableDrawBatching(true);
 	for (auto gldecal : decals)
 	{
 		if (gldecal->decal->Side == seg->sidedef)
@@ -164,6 +168,7 @@ void HWWall::DrawDecalsForMirror(HWDrawInfo *di, FRenderState &state, TArray<HWD
 			gldecal->DrawDecal(di, state);
 		}
 	}
+	state.EnableDrawBatching(false);
 	state.ClearDepthBias();
 	state.SetTextureMode(TM_NORMAL);
 	state.SetDepthMask(true);
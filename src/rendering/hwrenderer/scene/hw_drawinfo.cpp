@@ -43,11 +43,13 @@
 #include "hw_lightbuffer.h"
 #include "hw_vrmodes.h"
 #include "hw_clipper.h"
+#include "hw_occlusion.h"
 #include "v_draw.h"
 
 EXTERN_CVAR(Float, r_visibility)
 CVAR(Bool, gl_bandedswlight, false, CVAR_ARCHIVE)
 CVAR(Bool, gl_sort_textures, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVARD(Bool, gl_solid_sprite_pass, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "draw non-translucent sprites in the opaque pass, grouped by texture and translation")
 CVAR(Bool, gl_no_skyclear, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR(Int, gl_enhanced_nv_stealth, 3, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
@@ -97,8 +99,10 @@ HWDrawInfo *FDrawInfoList::GetNew()
 
 void FDrawInfoList::Release(HWDrawInfo * di)
 {
-	di->ClearBuffers();
+	// The per-subsector flag arrays get cleared by StartScene anyway. Doing it here, too,
+	// would needlessly clear them a second time for each portal.
 	di->Level = nullptr;
+	di->ClearBuffers();
 	mList.Push(di);
 }
 
@@ -412,7 +416,8 @@ HWPortal * HWDrawInfo::FindPortal(const void * src)
 
 HWDecal *HWDrawInfo::AddDecal(bool onmirror)
 {
-	auto decal = (HWDecal*)RenderDataAllocator.Alloc(sizeof(HWDecal));
+	std::lock_guard<std::recursive_mutex> lock(SceneDataLock);
+	auto decal = (HWDecal*)RenderDataArena->Alloc(sizeof(HWDecal));
 	Decals[onmirror ? 1 : 0].Push(decal);
 	return decal;
 }
@@ -457,6 +462,36 @@ void HWDrawInfo::CreateScene(bool drawpsprites)
 
 }
 
+//-----------------------------------------------------------------------------
+//
+// Draws an opaque wall and flat list. Every item sets up all the state it
+// needs, so if the backend supports it the lists can be recorded as several
+// ranges on multiple threads.
+//
+//-----------------------------------------------------------------------------
+
+void HWDrawInfo::DrawWallsAndFlats(FRenderState &state, int walllist, int flatlist)
+{
+	auto &walls = drawlists[walllist];
+	auto &flats = drawlists[flatlist];
+	unsigned numwalls = walls.Size();
+	unsigned numflats = flats.Size();
+
+	bool done = state.DrawParallel(numwalls + numflats,
+		[&]() { walls.MakeWallVertices(this); },
+		[&](FRenderState &rs, unsigned start, unsigned end)
+		{
+			if (start < numwalls) walls.DrawWalls(this, rs, false, start, MIN(end, numwalls));
+			if (end > numwalls) flats.DrawFlats(this, rs, false, MAX(start, numwalls) - numwalls, end - numwalls);
+		});
+
+	if (!done)
+	{
+		walls.DrawWalls(this, state, false);
+		flats.DrawFlats(this, state, false);
+	}
+}
+
 //-----------------------------------------------------------------------------
 //
 // RenderScene
@@ -465,7 +500,7 @@ void HWDrawInfo::CreateScene(bool drawpsprites)
 //
 //-----------------------------------------------------------------------------
 
-void HWDrawInfo::RenderScene(FRenderState &state)
+void HWDrawInfo::RenderScene(FRenderState &state, bool mainview)
 {
 	const auto &vp = Viewpoint;
 	RenderAll.Clock();
@@ -491,14 +526,15 @@ void HWDrawInfo::RenderScene(FRenderState &state)
 
 	state.EnableTexture(gl_texture);
 	state.EnableBrightmap(true);
-	drawlists[GLDL_PLAINWALLS].DrawWalls(this, state, false);
-	drawlists[GLDL_PLAINFLATS].DrawFlats(this, state, false);
+	DrawWallsAndFlats(state, GLDL_PLAINWALLS, GLDL_PLAINFLATS);
+
+	// Only the solid geometry is guaranteed to be opaque and static enough to serve as an occluder for the next frames.
+	if (mainview) OcclusionCuller.CaptureDepth(VPUniforms);
 
 
 	// Part 2: masked geometry. This is set up so that only pixels with alpha>gl_mask_threshold will show
 	state.AlphaFunc(Alpha_GEqual, gl_mask_threshold);
-	drawlists[GLDL_MASKEDWALLS].DrawWalls(this, state, false);
-	drawlists[GLDL_MASKEDFLATS].DrawFlats(this, state, false);
+	DrawWallsAndFlats(state, GLDL_MASKEDWALLS, GLDL_MASKEDFLATS);
 
 	// Part 3: masked geometry with polygon offset. This list is empty most of the time so only waste time on it when in use.
 	if (drawlists[GLDL_MASKEDWALLSOFS].Size() > 0)
@@ -510,6 +546,15 @@ void HWDrawInfo::RenderScene(FRenderState &state)
 
 	drawlists[GLDL_MODELS].Draw(this, state, false);
 
+	if (drawlists[GLDL_SOLIDSPRITES].Size() > 0)
+	{
+		// This list only gets filled with gl_solid_sprite_pass, and grouping is its entire point.
+		drawlists[GLDL_SOLIDSPRITES].SortSprites();
+		state.AlphaFunc(Alpha_GEqual, gl_mask_sprite_threshold);
+		drawlists[GLDL_SOLIDSPRITES].Draw(this, state, false);
+		state.AlphaFunc(Alpha_GEqual, gl_mask_threshold);
+	}
+
 	state.SetRenderStyle(STYLE_Translucent);
 
 	// Part 4: Draw decals (not a real pass)
@@ -691,7 +736,7 @@ void HWDrawInfo::DrawScene(int drawmode)
 	RenderState.SetDepthMask(true);
 	if (!gl_no_skyclear) portalState.RenderFirstSkyPortal(recursion, this, RenderState);
 
-	RenderScene(RenderState);
+	RenderScene(RenderState, drawmode == DM_MAINVIEW);
 
 	if (applySSAO && RenderState.GetPassType() == GBUFFER_PASS)
 	{
@@ -732,6 +777,7 @@ void HWDrawInfo::ProcessScene(bool toscreen)
 
 void HWDrawInfo::AddSubsectorToPortal(FSectorPortalGroup *ptg, subsector_t *sub)
 {
+	std::lock_guard<std::recursive_mutex> lock(SceneDataLock);
 	auto portal = FindPortal(ptg);
 	if (!portal)
 	{
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <functional>
+#include <mutex>
 #include "vectors.h"
 #include "r_defs.h"
 #include "r_utility.h"
@@ -79,6 +80,19 @@ enum EPortalClip
 	PClip_Behind,
 };
 
+enum
+{
+	MAX_RENDER_WORKERS = 32
+};
+
+// When several workers process the BSP each of them fills its own set of draw lists.
+// These get merged into the main lists once the BSP traversal is complete.
+extern thread_local HWDrawList *workerDrawLists;
+
+// Guards the scene data that is shared between all BSP workers, i.e. portals, decals and render hack collection.
+// This needs to be recursive because portal processing can end up adding decals.
+extern std::recursive_mutex SceneDataLock;
+
 enum DrawListType
 {
 	GLDL_PLAINWALLS,
@@ -87,6 +101,7 @@ enum DrawListType
 	GLDL_MASKEDFLATS,
 	GLDL_MASKEDWALLSOFS,
 	GLDL_MODELS,
+	GLDL_SOLIDSPRITES,
 
 	GLDL_TRANSLUCENT,
 	GLDL_TRANSLUCENTBORDER,
@@ -188,7 +203,9 @@ private:
 	subsector_t *currentsubsector;	// used by the line processing code.
 	sector_t *currentsector;
 
-	void WorkerThread();
+	void WorkerThread(int worker);
+	int GetNumRenderWorkers();
+	void MergeWorkerDrawLists(int numworkers);
 
 	void UnclipSubsector(subsector_t *sub);
 	
@@ -246,7 +263,8 @@ public:
 
 	void DrawScene(int drawmode);
 	void CreateScene(bool drawpsprites);
-	void RenderScene(FRenderState &state);
+	void DrawWallsAndFlats(FRenderState &state, int walllist, int flatlist);
+	void RenderScene(FRenderState &state, bool mainview = false);
 	void RenderTranslucent(FRenderState &state);
 	void RenderPortal(HWPortal *p, FRenderState &state, bool usestencil);
 	void EndDrawScene(sector_t * viewsector, FRenderState &state);
@@ -304,6 +322,11 @@ public:
 	void ProcessLowerMinisegs(TArray<seg_t *> &lowersegs);
     void AddSubsectorToPortal(FSectorPortalGroup *portal, subsector_t *sub);
     
+	HWDrawList *DrawList(int list)
+	{
+		return workerDrawLists != nullptr ? &workerDrawLists[list] : &drawlists[list];
+	}
+
     void AddWall(HWWall *w);
     void AddMirrorSurface(HWWall *w);
 	void AddFlat(HWFlat *flat, bool fog);
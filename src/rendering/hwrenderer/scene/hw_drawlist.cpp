@@ -39,10 +39,30 @@
 #include "hw_fakeflat.h"
 
 FMemArena RenderDataAllocator(1024*1024);	// Use large blocks to reduce allocation time.
+thread_local FMemArena *RenderDataArena = &RenderDataAllocator;
+static TDeletingArray<FMemArena *> WorkerDataAllocators;
 
 void ResetRenderDataAllocator()
 {
 	RenderDataAllocator.FreeAll();
+	for (auto arena : WorkerDataAllocators) arena->FreeAll();
+}
+
+//==========================================================================
+//
+// Each BSP worker gets its own arena so that allocating draw items
+// does not need any synchronization.
+// Must only be called from the main thread.
+//
+//==========================================================================
+
+FMemArena *GetWorkerDataAllocator(unsigned worker)
+{
+	while (WorkerDataAllocators.Size() <= worker)
+	{
+		WorkerDataAllocators.Push(new FMemArena(1024 * 1024));
+	}
+	return WorkerDataAllocators[worker];
 }
 
 //==========================================================================
@@ -580,14 +600,69 @@ void HWDrawList::SortSpriteIntoWall(HWDrawInfo *di, SortNode * head,SortNode * s
 //
 //==========================================================================
 
-inline int HWDrawList::CompareSprites(SortNode * a,SortNode * b)
+// Sprites are drawn back to front and then by their index. The key packs
+// both into an integer that sorts ascending in that order.
+inline uint64_t HWDrawList::SpriteSortKey(SortNode * a)
 {
-	HWSprite * s1= sprites[drawitems[a->itemindex].index];
-	HWSprite * s2= sprites[drawitems[b->itemindex].index];
+	HWSprite * s = sprites[drawitems[a->itemindex].index];
+
+	float depth = s->depth == 0 ? 0.f : s->depth;	// -0 must compare equal to 0.
+	uint32_t d;
+	memcpy(&d, &depth, sizeof(d));
+	d = (d & 0x80000000u) ? d : ~(d | 0x80000000u);
 
-	if (s1->depth < s2->depth) return 1;
-	if (s1->depth > s2->depth) return -1;
-	return reverseSort? s2->index-s1->index : s1->index-s2->index;
+	uint32_t i = uint32_t(s->index) ^ 0x80000000u;
+	if (reverseSort) i = ~i;
+	return (uint64_t(d) << 32) | i;
+}
+
+//==========================================================================
+//
+// Stable LSD radix sort by key, used for the sprite lists and the opaque
+// lists. Byte positions in which all keys agree are skipped.
+//
+//==========================================================================
+
+template<class T> struct TSortKeyEntry
+{
+	uint64_t key;
+	T value;
+};
+
+template<class T> static void SortByKey(TArray<TSortKeyEntry<T>> &entries)
+{
+	unsigned count = entries.Size();
+	if (count < 64)
+	{
+		std::stable_sort(entries.begin(), entries.end(), [](const TSortKeyEntry<T> &a, const TSortKeyEntry<T> &b)
+		{
+			return a.key < b.key;
+		});
+		return;
+	}
+
+	static TArray<TSortKeyEntry<T>> temp;
+	temp.Resize(count);
+	TSortKeyEntry<T> *src = entries.Data();
+	TSortKeyEntry<T> *dst = temp.Data();
+
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		unsigned buckets[256] = {};
+		for (unsigned i = 0; i < count; i++) buckets[(src[i].key >> shift) & 255]++;
+		if (buckets[(src[0].key >> shift) & 255] == count) continue;
+
+		unsigned sum = 0;
+		for (auto &b : buckets)
+		{
+			unsigned c = b;
+			b = sum;
+			sum += c;
+		}
+		for (unsigned i = 0; i < count; i++) dst[buckets[(src[i].key >> shift) & 255]++] = src[i];
+		std::swap(src, dst);
+	}
+	if (src != entries.Data()) memcpy(entries.Data(), src, count * sizeof(TSortKeyEntry<T>));
 }
 
 //==========================================================================
@@ -598,27 +673,23 @@ inline int HWDrawList::CompareSprites(SortNode * a,SortNode * b)
 SortNode * HWDrawList::SortSpriteList(SortNode * head)
 {
 	SortNode * n;
-	int count;
 	unsigned i;
 
-	static TArray<SortNode*> sortspritelist;
+	static TArray<TSortKeyEntry<SortNode*>> sortspritelist;
 
 	SortNode * parent=head->parent;
 
 	sortspritelist.Clear();
-	for(count=0,n=head;n;n=n->next) sortspritelist.Push(n);
-	std::stable_sort(sortspritelist.begin(), sortspritelist.end(), [=](SortNode *a, SortNode *b)
-	{
-		return CompareSprites(a, b) < 0;
-	});
+	for(n=head;n;n=n->next) sortspritelist.Push({ SpriteSortKey(n), n });
+	SortByKey(sortspritelist);
 
 	for(i=0;i<sortspritelist.Size();i++)
 	{
-		sortspritelist[i]->next=NULL;
-		if (parent) parent->equal=sortspritelist[i];
-		parent=sortspritelist[i];
+		sortspritelist[i].value->next=NULL;
+		if (parent) parent->equal=sortspritelist[i].value;
+		parent=sortspritelist[i].value;
 	}
-	return sortspritelist[0];
+	return sortspritelist[0].value;
 }
 
 //==========================================================================
@@ -709,23 +780,47 @@ void HWDrawList::Sort(HWDrawInfo *di)
 
 //==========================================================================
 //
-// Sorting the drawitems first by texture and then by light level
+// Sorting the opaque drawitems by everything that requires a render state
+// change: first the texture, then the remaining shader and light setup.
+// Items with the same state are drawn front to back.
 //
 //==========================================================================
 
+static uint64_t TextureSortKey(FGameTexture *tex)
+{
+	uint64_t id = tex ? uint64_t(tex->GetID().GetIndex() + 1) : 0;
+	return MIN<uint64_t>(id, 0xffffff) << 40;
+}
+
+static uint64_t StateSortKey(const FColormap &cm, int dynlightindex)
+{
+	uint64_t key = 0;
+	if (dynlightindex >= 0) key |= 1ull << 36;
+	if (cm.FadeColor.d & 0xffffff) key |= 1ull << 35;
+	return key;
+}
+
 void HWDrawList::SortWalls()
 {
 	if (drawitems.Size() > 1)
 	{
-		std::sort(drawitems.begin(), drawitems.end(), [=](const HWDrawItem &a, const HWDrawItem &b) -> bool
+		static TArray<TSortKeyEntry<HWDrawItem>> entries;
+		entries.Clear();
+		for (auto &item : drawitems)
 		{
-			HWWall * w1 = walls[a.index];
-			HWWall * w2 = walls[b.index];
-
-			if (w1->texture != w2->texture) return w1->texture < w2->texture;
-			return (w1->flags & 3) < (w2->flags & 3);
-
-		});
+			HWWall * w = walls[item.index];
+			uint64_t key = TextureSortKey(w->texture) | StateSortKey(w->Colormap, w->dynlightindex);
+			key |= uint64_t(w->flags & 3) << 38;
+			if (w->flags & HWWall::HWF_GLOW) key |= 1ull << 37;
+
+			// ViewDistance is never negative so its bit pattern sorts like its value.
+			uint32_t dist;
+			memcpy(&dist, &w->ViewDistance, sizeof(dist));
+			key |= dist >> 16;
+			entries.Push({ key, item });
+		}
+		SortByKey(entries);
+		for (unsigned i = 0; i < entries.Size(); i++) drawitems[i] = entries[i].value;
 	}
 }
 
@@ -733,16 +828,50 @@ void HWDrawList::SortFlats()
 {
 	if (drawitems.Size() > 1)
 	{
-		std::sort(drawitems.begin(), drawitems.end(), [=](const HWDrawItem &a, const HWDrawItem &b)
+		static TArray<TSortKeyEntry<HWDrawItem>> entries;
+		entries.Clear();
+		for (auto &item : drawitems)
 		{
-			HWFlat * w1 = flats[a.index];
-			HWFlat* w2 = flats[b.index];
-			return w1->texture < w2->texture;
-		});
+			HWFlat * f = flats[item.index];
+			entries.Push({ TextureSortKey(f->texture) | StateSortKey(f->Colormap, f->dynlightindex), item });
+		}
+		SortByKey(entries);
+		for (unsigned i = 0; i < entries.Size(); i++) drawitems[i] = entries[i].value;
 	}
 }
 
 
+//==========================================================================
+//
+// Solid sprites are depth tested like everything else in the opaque pass,
+// so they can be ordered by what they need to have bound, front to back
+// within each group.
+//
+//==========================================================================
+
+void HWDrawList::SortSprites()
+{
+	if (drawitems.Size() > 1)
+	{
+		static TArray<TSortKeyEntry<HWDrawItem>> entries;
+		entries.Clear();
+		for (auto &item : drawitems)
+		{
+			HWSprite * s = sprites[item.index];
+			uint64_t key = TextureSortKey(s->texture) | StateSortKey(s->Colormap, s->dynlightindex);
+			key |= uint64_t(s->translation & 0xffff) << 16;
+
+			float depth = MAX(s->depth, 0.f);
+			uint32_t d;
+			memcpy(&d, &depth, sizeof(d));
+			key |= d >> 16;
+			entries.Push({ key, item });
+		}
+		SortByKey(entries);
+		for (unsigned i = 0; i < entries.Size(); i++) drawitems[i] = entries[i].value;
+	}
+}
+
 //==========================================================================
 //
 //
@@ -751,7 +880,7 @@ void HWDrawList::SortFlats()
 
 HWWall *HWDrawList::NewWall()
 {
-	auto wall = (HWWall*)RenderDataAllocator.Alloc(sizeof(HWWall));
+	auto wall = (HWWall*)RenderDataArena->Alloc(sizeof(HWWall));
 	drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(wall)));
 	return wall;
 }
@@ -763,7 +892,7 @@ HWWall *HWDrawList::NewWall()
 //==========================================================================
 HWFlat *HWDrawList::NewFlat()
 {
-	auto flat = (HWFlat*)RenderDataAllocator.Alloc(sizeof(HWFlat));
+	auto flat = (HWFlat*)RenderDataArena->Alloc(sizeof(HWFlat));
 	drawitems.Push(HWDrawItem(DrawType_FLAT,flats.Push(flat)));
 	return flat;
 }
@@ -775,11 +904,34 @@ HWFlat *HWDrawList::NewFlat()
 //==========================================================================
 HWSprite *HWDrawList::NewSprite()
 {	
-	auto sprite = (HWSprite*)RenderDataAllocator.Alloc(sizeof(HWSprite));
+	auto sprite = (HWSprite*)RenderDataArena->Alloc(sizeof(HWSprite));
 	drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(sprite)));
 	return sprite;
 }
 
+//==========================================================================
+//
+// Moves all items of another list to the end of this one.
+// Used to merge the per-worker lists after multithreaded BSP processing.
+//
+//==========================================================================
+
+void HWDrawList::Append(HWDrawList &other)
+{
+	assert(sorted == nullptr && other.sorted == nullptr);
+
+	int wallofs = walls.Append(other.walls);
+	int flatofs = flats.Append(other.flats);
+	int spriteofs = sprites.Append(other.sprites);
+
+	for (auto &item : other.drawitems)
+	{
+		int ofs = item.rendertype == DrawType_WALL ? wallofs : item.rendertype == DrawType_FLAT ? flatofs : spriteofs;
+		drawitems.Push(HWDrawItem(item.rendertype, item.index + ofs));
+	}
+	other.Reset();
+}
+
 //==========================================================================
 //
 //
@@ -825,10 +977,13 @@ void HWDrawList::DoDraw(HWDrawInfo *di, FRenderState &state, bool translucent, i
 //==========================================================================
 void HWDrawList::Draw(HWDrawInfo *di, FRenderState &state, bool translucent)
 {
+	// Batching only ever merges directly consecutive draws so it is also safe for translucent lists.
+	state.EnableDrawBatching(translucent);
 	for (unsigned i = 0; i < drawitems.Size(); i++)
 	{
 		DoDraw(di, state, translucent, i);
 	}
+	state.EnableDrawBatching(false);
 }
 
 //==========================================================================
@@ -839,11 +994,34 @@ void HWDrawList::Draw(HWDrawInfo *di, FRenderState &state, bool translucent)
 void HWDrawList::DrawWalls(HWDrawInfo *di, FRenderState &state, bool translucent)
 {
 	RenderWall.Clock();
+	DrawWalls(di, state, translucent, 0, drawitems.Size());
+	RenderWall.Unclock();
+}
+
+void HWDrawList::DrawWalls(HWDrawInfo *di, FRenderState &state, bool translucent, unsigned start, unsigned end)
+{
+	state.EnableDrawBatching(!translucent);
+	for (unsigned i = start; i < end; i++)
+	{
+		walls[drawitems[i].index]->DrawWall(di, state, translucent);
+	}
+	state.EnableDrawBatching(false);
+}
+
+//==========================================================================
+//
+// The wall vertex cache cannot be used from several threads, so this
+// must be done up front when the walls get drawn in parallel.
+//
+//==========================================================================
+void HWDrawList::MakeWallVertices(HWDrawInfo *di)
+{
+	if (!screen->BuffersArePersistent()) return;
 	for (auto &item : drawitems)
 	{
-		walls[item.index]->DrawWall(di, state, translucent);
+		auto wall = walls[item.index];
+		wall->MakeVertices(di, !!(wall->flags & HWWall::HWF_TRANSLUCENT));
 	}
-	RenderWall.Unclock();
 }
 
 //==========================================================================
@@ -854,11 +1032,18 @@ void HWDrawList::DrawWalls(HWDrawInfo *di, FRenderState &state, bool translucent
 void HWDrawList::DrawFlats(HWDrawInfo *di, FRenderState &state, bool translucent)
 {
 	RenderFlat.Clock();
-	for (unsigned i = 0; i<drawitems.Size(); i++)
+	DrawFlats(di, state, translucent, 0, drawitems.Size());
+	RenderFlat.Unclock();
+}
+
+void HWDrawList::DrawFlats(HWDrawInfo *di, FRenderState &state, bool translucent, unsigned start, unsigned end)
+{
+	state.EnableDrawBatching(!translucent);
+	for (unsigned i = start; i < end; i++)
 	{
 		flats[drawitems[i].index]->DrawFlat(di, state, translucent);
 	}
-	RenderFlat.Unclock();
+	state.EnableDrawBatching(false);
 }
 
 //==========================================================================
@@ -939,7 +1124,9 @@ void HWDrawList::DrawSorted(HWDrawInfo *di, FRenderState &state)
 	state.ClearClipSplit();
 	state.EnableClipDistance(1, true);
 	state.EnableClipDistance(2, true);
+	state.EnableDrawBatching(true);
 	DrawSorted(di, state, sorted);
+	state.EnableDrawBatching(false);
 	state.EnableClipDistance(1, false);
 	state.EnableClipDistance(2, false);
 	state.ClearClipSplit();
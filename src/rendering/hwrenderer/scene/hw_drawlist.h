@@ -3,7 +3,9 @@
 #include "memarena.h"
 
 extern FMemArena RenderDataAllocator;
+extern thread_local FMemArena *RenderDataArena;	// points to RenderDataAllocator unless inside a BSP worker with its own arena.
 void ResetRenderDataAllocator();
+FMemArena *GetWorkerDataAllocator(unsigned worker);
 struct HWDrawInfo;
 class HWWall;
 class HWFlat;
@@ -31,6 +33,7 @@ struct HWDrawItem
 	HWDrawItemType rendertype;
 	int index;
 	
+	HWDrawItem() = default;
 	HWDrawItem(HWDrawItemType _rendertype,int _index) : rendertype(_rendertype),index(_index) {}
 };
 
@@ -90,9 +93,11 @@ public:
 	HWWall *NewWall();
 	HWFlat *NewFlat();
 	HWSprite *NewSprite();
+	void Append(HWDrawList &other);
 	void Reset();
 	void SortWalls();
 	void SortFlats();
+	void SortSprites();
 	
 	
 	void MakeSortList();
@@ -103,7 +108,7 @@ public:
 	void SortSpriteIntoPlane(SortNode * head,SortNode * sort);
 	void SortWallIntoWall(HWDrawInfo *di, SortNode * head,SortNode * sort);
 	void SortSpriteIntoWall(HWDrawInfo *di, SortNode * head,SortNode * sort);
-	int CompareSprites(SortNode * a,SortNode * b);
+	uint64_t SpriteSortKey(SortNode * a);
 	SortNode * SortSpriteList(SortNode * head);
 	SortNode * DoSort(HWDrawInfo *di, SortNode * head);
 	void Sort(HWDrawInfo *di);
@@ -112,6 +117,9 @@ public:
 	void Draw(HWDrawInfo *di, FRenderState &state, bool translucent);
 	void DrawWalls(HWDrawInfo *di, FRenderState &state, bool translucent);
 	void DrawFlats(HWDrawInfo *di, FRenderState &state, bool translucent);
+	void DrawWalls(HWDrawInfo *di, FRenderState &state, bool translucent, unsigned start, unsigned end);
+	void DrawFlats(HWDrawInfo *di, FRenderState &state, bool translucent, unsigned start, unsigned end);
+	void MakeWallVertices(HWDrawInfo *di);
 
 	void DrawSorted(HWDrawInfo *di, FRenderState &state, SortNode * head);
 	void DrawSorted(HWDrawInfo *di, FRenderState &state);
@@ -30,6 +30,7 @@
 #include "g_levellocals.h"
 
 EXTERN_CVAR(Bool, gl_seamless)
+EXTERN_CVAR(Bool, gl_solid_sprite_pass)
 
 //==========================================================================
 //
@@ -41,7 +42,7 @@ void HWDrawInfo::AddWall(HWWall *wall)
 {
 	if (wall->flags & HWWall::HWF_TRANSLUCENT)
 	{
-		auto newwall = drawlists[GLDL_TRANSLUCENT].NewWall();
+		auto newwall = DrawList(GLDL_TRANSLUCENT)->NewWall();
 		*newwall = *wall;
 	}
 	else
@@ -57,7 +58,7 @@ void HWDrawInfo::AddWall(HWWall *wall)
 		{
 			list = masked ? GLDL_MASKEDWALLS : GLDL_PLAINWALLS;
 		}
-		auto newwall = drawlists[list].NewWall();
+		auto newwall = DrawList(list)->NewWall();
 		*newwall = *wall;
 	}
 }
@@ -71,7 +72,7 @@ void HWDrawInfo::AddWall(HWWall *wall)
 void HWDrawInfo::AddMirrorSurface(HWWall *w)
 {
 	w->type = RENDERWALL_MIRRORSURFACE;
-	auto newwall = drawlists[GLDL_TRANSLUCENTBORDER].NewWall();
+	auto newwall = DrawList(GLDL_TRANSLUCENTBORDER)->NewWall();
 	*newwall = *w;
 
 	// Invalidate vertices to allow setting of texture coordinates
@@ -130,7 +131,7 @@ void HWDrawInfo::AddFlat(HWFlat *flat, bool fog)
 		bool masked = flat->texture->isMasked() && ((flat->renderflags&SSRF_RENDER3DPLANES) || flat->stack);
 		list = masked ? GLDL_MASKEDFLATS : GLDL_PLAINFLATS;
 	}
-	auto newflat = drawlists[list].NewFlat();
+	auto newflat = DrawList(list)->NewFlat();
 	*newflat = *flat;
 }
 
@@ -152,8 +153,14 @@ void HWDrawInfo::AddSprite(HWSprite *sprite, bool translucent)
 	{
 		list = GLDL_MODELS;
 	}
+	if (list == GLDL_TRANSLUCENT && !translucent && gl_solid_sprite_pass && sprite->actor != nullptr &&
+		!sprite->modelframe && (sprite->actor->renderflags & RF_SPRITETYPEMASK) == RF_FACESPRITE)
+	{
+		// Solid billboards do not need to be sorted against the translucent geometry.
+		list = GLDL_SOLIDSPRITES;
+	}
 
-	auto newsprt = drawlists[list].NewSprite();
+	auto newsprt = DrawList(list)->NewSprite();
 	*newsprt = *sprite;
 }
 
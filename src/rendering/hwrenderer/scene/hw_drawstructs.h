@@ -211,6 +211,7 @@ public:
 
 	void SetupLights(HWDrawInfo *di, FDynLightData &lightdata);
 
+	bool GetCachedVertices(bool split);
 	void MakeVertices(HWDrawInfo *di, bool nosplit);
 
 	void SkyPlane(HWDrawInfo *di, sector_t *sector, int plane, bool allowmirror);
@@ -435,6 +436,8 @@ extern const float LARGE_VALUE;
 
 struct FDynLightData;
 struct FDynamicLight;
+struct FLevelLocals;
 bool GetLight(FDynLightData& dld, int group, Plane& p, FDynamicLight* light, bool checkside);
 void AddLightToList(FDynLightData &dld, int group, FDynamicLight* light, bool forceAttenuate);
+void PrepareLightData(FLevelLocals *Level);
 void SetSplitPlanes(FRenderState& state, const secplane_t& top, const secplane_t& bottom);
@@ -0,0 +1,496 @@
+//
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2023 The GZDoom team
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** hw_occlusion.cpp
+** Reprojected depth buffer occlusion test for the BSP traversal
+**
+** The GPU cannot be queried synchronously without stalling, so the depth
+** buffer is copied asynchronously and used once it has arrived, usually
+** one or two frames later. Because it is reprojected with the matrices it
+** was rendered with, camera movement does not cause any errors. What cannot
+** be reprojected is moving geometry, so as long as any plane or polyobject
+** changed since the depth was captured, nothing gets culled.
+**
+** Only the plain walls and flats are captured. Everything else, i.e. masked
+** geometry, sprites, models and portals, may change from frame to frame
+** or not occlude anything at all, so it must not act as an occluder.
+**
+*/
+
+#include <float.h>
+#include "g_levellocals.h"
+#include "r_defs.h"
+#include "m_bbox.h"
+#include "po_man.h"
+#include "v_video.h"
+#include "c_cvars.h"
+#include "hw_occlusion.h"
+#include "hwrenderer/data/hw_viewpointuniforms.h"
+
+CVAR(Bool, gl_occlusioncull, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+HWOcclusionCuller OcclusionCuller;
+
+ADD_STAT(occlusion)
+{
+	FString out;
+	out.Format("reproject=%04.2f ms  tested=%u  culled=%u", OcclusionCuller.ReprojectCycles.TimeMS(), OcclusionCuller.NumTested, OcclusionCuller.NumCulled);
+	return out;
+}
+
+enum
+{
+	DEPTH_WIDTH = 320,		// horizontal resolution of the depth readback
+	CELL_SIZE = 4,			// readback pixels per grid cell in each direction
+};
+
+// Things are only linked into the sectors they touch, so their sprites may stick out of a node's bounds.
+static const double SPRITE_MARGIN_XY = 64;
+static const double SPRITE_MARGIN_Z = 128;
+
+//==========================================================================
+//
+// Matrix utilities. The depth is reprojected in double precision because
+// a single precision clip space inverse is far too inaccurate near the
+// far plane.
+//
+//==========================================================================
+
+static void MakeViewProj(const HWViewpointUniforms &vp, double *result)
+{
+	auto proj = vp.mProjectionMatrix.get();
+	auto view = vp.mViewMatrix.get();
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			double sum = 0;
+			for (int k = 0; k < 4; k++) sum += (double)proj[k * 4 + r] * view[c * 4 + k];
+			result[c * 4 + r] = sum;
+		}
+	}
+}
+
+static void MultMatrix(const double *a, const double *b, double *result)
+{
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			double sum = 0;
+			for (int k = 0; k < 4; k++) sum += a[k * 4 + r] * b[c * 4 + k];
+			result[c * 4 + r] = sum;
+		}
+	}
+}
+
+static bool InvertMatrix(const double *m, double *result)
+{
+	double work[4][8];
+	for (int r = 0; r < 4; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			work[r][c] = m[r * 4 + c];
+			work[r][c + 4] = r == c;
+		}
+	}
+	for (int c = 0; c < 4; c++)
+	{
+		int pivot = c;
+		for (int r = c + 1; r < 4; r++)
+		{
+			if (fabs(work[r][c]) > fabs(work[pivot][c])) pivot = r;
+		}
+		if (fabs(work[pivot][c]) < 1e-12) return false;
+		if (pivot != c)
+		{
+			for (int k = 0; k < 8; k++) std::swap(work[pivot][k], work[c][k]);
+		}
+		double scale = 1. / work[c][c];
+		for (int k = 0; k < 8; k++) work[c][k] *= scale;
+		for (int r = 0; r < 4; r++)
+		{
+			if (r == c) continue;
+			double f = work[r][c];
+			if (f == 0) continue;
+			for (int k = 0; k < 8; k++) work[r][k] -= f * work[c][k];
+		}
+	}
+	for (int r = 0; r < 4; r++)
+	{
+		for (int c = 0; c < 4; c++) result[r * 4 + c] = work[r][c + 4];
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// Must be called whenever a new level is loaded so that no depth data
+// of the old level can survive.
+//
+//==========================================================================
+
+void HWOcclusionCuller::ResetLevel()
+{
+	mGeneration++;
+	mHaveDepth = false;
+	mActive = false;
+	mBoundsGeneration = ~0u;
+	mNodeZ.Clear();
+	mPlaneState.Clear();
+	mPolyState.Clear();
+}
+
+//==========================================================================
+//
+// Checks whether any geometry which can end up in the depth buffer has
+// moved since the last call.
+//
+//==========================================================================
+
+bool HWOcclusionCuller::GeometryChanged(FLevelLocals *Level)
+{
+	bool changed = false;
+
+	unsigned numplanes = Level->sectors.Size() * 8;
+	if (mPlaneState.Size() != numplanes)
+	{
+		mPlaneState.Resize(numplanes);
+		changed = true;
+	}
+	double *state = mPlaneState.Data();
+	for (auto &sec : Level->sectors)
+	{
+		for (auto plane : { &sec.floorplane, &sec.ceilingplane })
+		{
+			auto &normal = plane->Normal();
+			double d = plane->fD();
+			if (state[0] != d || state[1] != normal.X || state[2] != normal.Y || state[3] != normal.Z)
+			{
+				state[0] = d;
+				state[1] = normal.X;
+				state[2] = normal.Y;
+				state[3] = normal.Z;
+				changed = true;
+			}
+			state += 4;
+		}
+	}
+
+	unsigned numverts = 0;
+	for (auto &poly : Level->Polyobjects) numverts += poly.Vertices.Size();
+	if (mPolyState.Size() != numverts)
+	{
+		mPolyState.Resize(numverts);
+		changed = true;
+	}
+	unsigned i = 0;
+	for (auto &poly : Level->Polyobjects)
+	{
+		for (auto vert : poly.Vertices)
+		{
+			auto pos = vert->fPos();
+			if (mPolyState[i] != pos)
+			{
+				mPolyState[i] = pos;
+				changed = true;
+			}
+			i++;
+		}
+	}
+	return changed;
+}
+
+//==========================================================================
+//
+// Height range of everything a subsector may render.
+//
+//==========================================================================
+
+HWOcclusionCuller::ZRange HWOcclusionCuller::SubsectorBounds(subsector_t *sub)
+{
+	ZRange range = { FLT_MAX, -FLT_MAX };
+
+	auto addplane = [&](const secplane_t &plane)
+	{
+		// The subsector is convex so a sloped plane's extremes are at its vertices.
+		unsigned count = plane.isSlope() ? sub->numlines : 1;
+		for (unsigned i = 0; i < count; i++)
+		{
+			float z = (float)plane.ZatPoint(sub->firstline[i].v1);
+			range.lo = std::min(range.lo, z);
+			range.hi = std::max(range.hi, z);
+		}
+	};
+	auto addsector = [&](sector_t *sec)
+	{
+		if (sec == nullptr) return;
+		addplane(sec->floorplane);
+		addplane(sec->ceilingplane);
+		auto hsec = sec->GetHeightSec();
+		if (hsec != nullptr)
+		{
+			addplane(hsec->floorplane);
+			addplane(hsec->ceilingplane);
+		}
+		for (auto ffloor : sec->e->XFloor.ffloors)
+		{
+			addplane(*ffloor->top.plane);
+			addplane(*ffloor->bottom.plane);
+		}
+	};
+
+	if (sub->numlines == 0) return { -FLT_MAX, FLT_MAX };	// degenerate subsectors must never be culled.
+	addsector(sub->sector);
+	if (sub->render_sector != sub->sector) addsector(sub->render_sector);
+	return range;
+}
+
+//==========================================================================
+//
+// Propagates the subsectors' height ranges up the BSP tree.
+//
+//==========================================================================
+
+HWOcclusionCuller::ZRange HWOcclusionCuller::BuildNodeBounds(void *node)
+{
+	if ((size_t)node & 1)
+	{
+		return SubsectorBounds((subsector_t *)((uint8_t *)node - 1));
+	}
+	auto bsp = (node_t *)node;
+	ZRange front = BuildNodeBounds(bsp->children[0]);
+	ZRange back = BuildNodeBounds(bsp->children[1]);
+	mNodeZ[bsp->Index() * 2] = front;
+	mNodeZ[bsp->Index() * 2 + 1] = back;
+	return { std::min(front.lo, back.lo), std::max(front.hi, back.hi) };
+}
+
+void HWOcclusionCuller::BuildBounds(FLevelLocals *Level)
+{
+	mNodeZ.Resize(Level->nodes.Size() * 2);
+	if (Level->nodes.Size() > 0) BuildNodeBounds(Level->HeadNode());
+	mBoundsGeneration = mGeneration;
+}
+
+//==========================================================================
+//
+// Reprojects the last depth readback into the current view and reduces
+// it to a grid of each cell's farthest occluder.
+//
+//==========================================================================
+
+bool HWOcclusionCuller::BuildGrid()
+{
+	double inverse[16], m[16];
+	if (!InvertMatrix(mDepthViewProj, inverse)) return false;
+	MultMatrix(mViewProj, inverse, m);
+
+	const int width = mDepthWidth, height = mDepthHeight;
+	mGridWidth = (width + CELL_SIZE - 1) / CELL_SIZE;
+	mGridHeight = (height + CELL_SIZE - 1) / CELL_SIZE;
+	mGrid.Resize(mGridWidth * mGridHeight);
+	mGridTemp.Resize(mGridWidth * mGridHeight);
+
+	// Cells never hit by any sample are set to the far plane afterward.
+	const float empty = -2.f;
+	for (auto &cell : mGridTemp) cell = empty;
+
+	const float *depth = mDepth.Data();
+	for (int y = 0; y < height; y++)
+	{
+		double ny = (y + 0.5) * 2. / height - 1.;
+		for (int x = 0; x < width; x++)
+		{
+			float d = *depth++;
+			if (d >= 1.f) continue;	// nothing was rendered here.
+
+			double nx = (x + 0.5) * 2. / width - 1.;
+			double nz = d * 2. - 1.;
+			double cw = m[3] * nx + m[7] * ny + m[11] * nz + m[15];
+			if (cw <= 1e-6) continue;	// behind the camera now.
+
+			double rw = 1. / cw;
+			double sz = (m[2] * nx + m[6] * ny + m[10] * nz + m[14]) * rw;
+			if (sz < -1.) continue;	// in front of the near plane, so it hides nothing.
+			double sx = ((m[0] * nx + m[4] * ny + m[8] * nz + m[12]) * rw + 1.) * 0.5 * mGridWidth;
+			double sy = ((m[1] * nx + m[5] * ny + m[9] * nz + m[13]) * rw + 1.) * 0.5 * mGridHeight;
+			if (sx < 0 || sy < 0 || sx >= mGridWidth || sy >= mGridHeight) continue;
+
+			float &cell = mGridTemp[int(sy) * mGridWidth + int(sx)];
+			cell = std::max(cell, (float)sz);
+		}
+	}
+	for (auto &cell : mGridTemp)
+	{
+		if (cell == empty) cell = FLT_MAX;
+	}
+
+	// Samples get spread apart when getting closer to a surface, so expand each cell by its neighbors' farthest depth.
+	for (int y = 0; y < mGridHeight; y++)
+	{
+		int y1 = std::max(y - 1, 0), y2 = std::min(y + 1, mGridHeight - 1);
+		for (int x = 0; x < mGridWidth; x++)
+		{
+			int x1 = std::max(x - 1, 0), x2 = std::min(x + 1, mGridWidth - 1);
+			float farthest = -FLT_MAX;
+			for (int yy = y1; yy <= y2; yy++)
+			{
+				for (int xx = x1; xx <= x2; xx++) farthest = std::max(farthest, mGridTemp[yy * mGridWidth + xx]);
+			}
+			mGrid[y * mGridWidth + x] = farthest;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// Called before the main view's BSP traversal.
+//
+//==========================================================================
+
+void HWOcclusionCuller::BeginScene(FLevelLocals *Level, const HWViewpointUniforms &vp)
+{
+	mActive = false;
+	NumTested = NumCulled = 0;
+	ReprojectCycles.Reset();
+
+	// Stereo modes work as well: each eye reprojects whichever eye's depth was read back last,
+	// and the small eye offset is no different from the camera moving between two frames.
+	if (!gl_occlusioncull)
+	{
+		// Geometry changes are not tracked while disabled so any data still in flight cannot be trusted anymore.
+		mGeneration++;
+		mHaveDepth = false;
+		return;
+	}
+
+	ReprojectCycles.Clock();
+	if (Level != mLevel)
+	{
+		ResetLevel();
+		mLevel = Level;
+	}
+	if (GeometryChanged(Level)) mGeneration++;
+
+	if (mPending && screen->FinishSceneDepthReadback(mDepth))
+	{
+		mPending = false;
+		mHaveDepth = mDepth.Size() == unsigned(mPendingWidth * mPendingHeight);
+		mDepthWidth = mPendingWidth;
+		mDepthHeight = mPendingHeight;
+		mDepthGeneration = mPendingGeneration;
+		memcpy(mDepthViewProj, mPendingViewProj, sizeof(mDepthViewProj));
+	}
+
+	if (mHaveDepth && mDepthGeneration == mGeneration)
+	{
+		if (mBoundsGeneration != mGeneration) BuildBounds(Level);
+		MakeViewProj(vp, mViewProj);
+		mActive = BuildGrid();
+	}
+	ReprojectCycles.Unclock();
+}
+
+//==========================================================================
+//
+// Called after the main view's plain walls and flats have been rendered.
+//
+//==========================================================================
+
+void HWOcclusionCuller::CaptureDepth(const HWViewpointUniforms &vp)
+{
+	if (!gl_occlusioncull || mPending) return;
+
+	const auto &bounds = screen->mSceneViewport;
+	if (bounds.width <= 0 || bounds.height <= 0) return;
+	int width = std::min<int>(DEPTH_WIDTH, bounds.width);
+	int height = std::max(1, width * bounds.height / bounds.width);
+
+	if (screen->StartSceneDepthReadback(width, height))
+	{
+		mPending = true;
+		mPendingWidth = width;
+		mPendingHeight = height;
+		mPendingGeneration = mGeneration;
+		MakeViewProj(vp, mPendingViewProj);
+	}
+}
+
+//==========================================================================
+//
+// Checks whether one side of a node is completely hidden.
+//
+//==========================================================================
+
+bool HWOcclusionCuller::IsOccluded(const node_t *node, int side)
+{
+	unsigned index = node->Index() * 2 + side;
+	if (index >= mNodeZ.Size()) return false;
+	NumTested++;
+
+	const float *bbox = node->bbox[side];
+	const ZRange &zrange = mNodeZ[index];
+	double x1 = bbox[BOXLEFT] - SPRITE_MARGIN_XY, x2 = bbox[BOXRIGHT] + SPRITE_MARGIN_XY;
+	double y1 = bbox[BOXBOTTOM] - SPRITE_MARGIN_XY, y2 = bbox[BOXTOP] + SPRITE_MARGIN_XY;
+	double z1 = zrange.lo - SPRITE_MARGIN_Z, z2 = zrange.hi + SPRITE_MARGIN_Z;
+
+	double minx = DBL_MAX, miny = DBL_MAX, maxx = -DBL_MAX, maxy = -DBL_MAX, nearz = DBL_MAX;
+	const double *m = mViewProj;
+	for (int i = 0; i < 8; i++)
+	{
+		// The renderer's coordinate system has y and z swapped.
+		double px = (i & 1) ? x2 : x1;
+		double py = (i & 2) ? z2 : z1;
+		double pz = (i & 4) ? y2 : y1;
+		double cw = m[3] * px + m[7] * py + m[11] * pz + m[15];
+		if (cw <= 1e-3) return false;	// the box reaches behind the near plane.
+
+		double rw = 1. / cw;
+		double sx = (m[0] * px + m[4] * py + m[8] * pz + m[12]) * rw;
+		double sy = (m[1] * px + m[5] * py + m[9] * pz + m[13]) * rw;
+		double sz = (m[2] * px + m[6] * py + m[10] * pz + m[14]) * rw;
+		minx = std::min(minx, sx);
+		maxx = std::max(maxx, sx);
+		miny = std::min(miny, sy);
+		maxy = std::max(maxy, sy);
+		nearz = std::min(nearz, sz);
+	}
+	if (nearz <= -1. || maxx < -1. || minx > 1. || maxy < -1. || miny > 1.) return false;
+
+	int cx1 = clamp(int((minx + 1.) * 0.5 * mGridWidth), 0, mGridWidth - 1);
+	int cx2 = clamp(int((maxx + 1.) * 0.5 * mGridWidth), 0, mGridWidth - 1);
+	int cy1 = clamp(int((miny + 1.) * 0.5 * mGridHeight), 0, mGridHeight - 1);
+	int cy2 = clamp(int((maxy + 1.) * 0.5 * mGridHeight), 0, mGridHeight - 1);
+	for (int y = cy1; y <= cy2; y++)
+	{
+		const float *cell = &mGrid[y * mGridWidth];
+		for (int x = cx1; x <= cx2; x++)
+		{
+			if (cell[x] >= nearz) return false;
+		}
+	}
+	NumCulled++;
+	return true;
+}
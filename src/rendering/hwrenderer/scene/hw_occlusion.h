@@ -0,0 +1,78 @@
+#pragma once
+
+#include "tarray.h"
+#include "vectors.h"
+#include "stats.h"
+
+struct FLevelLocals;
+struct HWViewpointUniforms;
+struct node_t;
+struct subsector_t;
+
+//==========================================================================
+//
+// Occlusion culling for the main view's BSP traversal.
+//
+// The depth buffer of an earlier frame's opaque walls and flats gets read
+// back in a downscaled version and reprojected into the current view.
+// This yields a coarse depth grid against which the node bounding boxes
+// can be tested, so that subtrees which are completely hidden behind
+// closer geometry can be skipped before they ever reach the clipper.
+//
+//==========================================================================
+
+class HWOcclusionCuller
+{
+	struct ZRange
+	{
+		float lo, hi;
+	};
+
+	// the readback which is currently in flight
+	bool mPending = false;
+	int mPendingWidth = 0, mPendingHeight = 0;
+	double mPendingViewProj[16];
+	unsigned mPendingGeneration = 0;
+
+	// the most recent depth data that arrived
+	TArray<float> mDepth;
+	int mDepthWidth = 0, mDepthHeight = 0;
+	double mDepthViewProj[16];
+	unsigned mDepthGeneration = 0;
+	bool mHaveDepth = false;
+
+	// the coarse depth grid for the current frame
+	TArray<float> mGrid;
+	TArray<float> mGridTemp;
+	int mGridWidth = 0, mGridHeight = 0;
+	double mViewProj[16];
+	bool mActive = false;
+
+	// static level data
+	FLevelLocals *mLevel = nullptr;
+	unsigned mGeneration = 0;
+	unsigned mBoundsGeneration = ~0u;
+	TArray<ZRange> mNodeZ;
+	TArray<double> mPlaneState;
+	TArray<DVector2> mPolyState;
+
+	bool GeometryChanged(FLevelLocals *Level);
+	void BuildBounds(FLevelLocals *Level);
+	ZRange BuildNodeBounds(void *node);
+	ZRange SubsectorBounds(subsector_t *sub);
+	bool BuildGrid();
+
+public:
+	cycle_t ReprojectCycles;
+	unsigned NumTested = 0;
+	unsigned NumCulled = 0;
+
+	void ResetLevel();
+	void BeginScene(FLevelLocals *Level, const HWViewpointUniforms &vp);
+	void CaptureDepth(const HWViewpointUniforms &vp);
+	void EndScene() { mActive = false; }
+	bool IsActive() const { return mActive; }
+	bool IsOccluded(const node_t *node, int side);
+};
+
+extern HWOcclusionCuller OcclusionCuller;
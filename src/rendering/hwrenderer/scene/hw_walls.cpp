@@ -567,6 +567,7 @@ void HWWall::PutPortal(HWDrawInfo *di, int ptype, int plane)
 	HWPortal * portal = nullptr;
 
 	MakeVertices(di, false);
+	std::lock_guard<std::recursive_mutex> lock(SceneDataLock);
 	switch (ptype)
 	{
 		// portals don't go into the draw list.
@@ -25,9 +25,71 @@
 #include "flatvertices.h"
 #include "hwrenderer/scene/hw_drawinfo.h"
 #include "hwrenderer/scene/hw_drawstructs.h"
+#include "hwrenderer/hw_vertexbuilder.h"
+#include "v_video.h"
 
 EXTERN_CVAR(Bool, gl_seamless)
 
+//==========================================================================
+//
+// Persistent vertex storage for the regular upper, middle and lower wall
+// parts. Each seg gets one slot per part in a pool that lies outside the
+// per-frame area of the vertex buffer. A slot is only rewritten when the
+// wall's geometry changed, i.e. when a mover changed the planes or a
+// scroller changed the texture coordinates, so that static walls never
+// need to write any vertex data after they were first seen.
+//
+//==========================================================================
+
+struct FWallVertexKey
+{
+	HWSeg glseg;
+	float ztop[2], zbottom[2];
+	texcoord tcs[4];
+	int split;
+};
+
+struct FWallVertexSlot
+{
+	FWallVertexKey key;
+	unsigned vertindex;
+	unsigned capacity;
+	unsigned vertcount;
+	unsigned lastframe;
+};
+
+static TArray<FWallVertexSlot> WallVertexSlots;
+static unsigned WallPoolIndex, WallPoolEnd;
+
+void InitWallVertexCache(FFlatVertexBuffer* fvb, unsigned numsegs)
+{
+	WallVertexSlots.Resize(numsegs * 3);
+	memset(WallVertexSlots.Data(), 0, WallVertexSlots.Size() * sizeof(FWallVertexSlot));
+
+	// Most walls only need 4 vertices but seamless splitting adds some. Never use more than a quarter of the buffer's remaining space.
+	unsigned poolsize = std::min(numsegs * 3 * 6, (FFlatVertexBuffer::BUFFER_SIZE_TO_USE - fvb->mIndex) / 4);
+	WallPoolIndex = fvb->mIndex;
+	WallPoolEnd = fvb->mIndex + poolsize;
+	fvb->mIndex = WallPoolEnd;
+	fvb->Reset();
+}
+
+static FWallVertexSlot *GetWallVertexSlot(const HWWall *wall)
+{
+	int part;
+	switch (wall->type)
+	{
+	case RENDERWALL_TOP: part = 0; break;
+	case RENDERWALL_M1S:
+	case RENDERWALL_M2S:
+	case RENDERWALL_M2SNF: part = 1; break;
+	case RENDERWALL_BOTTOM: part = 2; break;
+	default: return nullptr;
+	}
+	unsigned index = wall->seg->Index() * 3 + part;
+	return index < WallVertexSlots.Size() ? &WallVertexSlots[index] : nullptr;
+}
+
 //==========================================================================
 //
 // Split upper edge of wall
@@ -262,11 +324,57 @@ int HWWall::CountVertices()
 //
 //==========================================================================
 
+bool HWWall::GetCachedVertices(bool split)
+{
+	// Splits at the vertices depend on the heights of all sectors around them, which are not part of the key.
+	if (split && ((glseg.fracleft == 0 && vertexes[0] && vertexes[0]->numheights) || (glseg.fracright == 1 && vertexes[1] && vertexes[1]->numheights))) return false;
+
+	auto slot = GetWallVertexSlot(this);
+	if (slot == nullptr) return false;
+
+	FWallVertexKey key;
+	memset(&key, 0, sizeof(key));	// the key gets compared with memcmp so the padding must be cleared.
+	key.glseg = glseg;
+	memcpy(key.ztop, ztop, sizeof(ztop));
+	memcpy(key.zbottom, zbottom, sizeof(zbottom));
+	memcpy(key.tcs, tcs, sizeof(tcs));
+	key.split = split ? 1 + (flags & (HWF_NOSPLITUPPER | HWF_NOSPLITLOWER)) : 0;
+
+	auto fvb = screen->mVertexData;
+	if (slot->capacity > 0 && !memcmp(&key, &slot->key, sizeof(key)))
+	{
+		vertindex = slot->vertindex;
+		vertcount = slot->vertcount;
+		slot->lastframe = fvb->mFrameCount;
+		return true;
+	}
+
+	// Another part of the same seg, e.g. from a 3D floor split, may already use the slot in this frame.
+	if (slot->capacity > 0 && slot->lastframe == fvb->mFrameCount) return false;
+
+	unsigned count = split ? CountVertices() : 4;
+	if (count > slot->capacity)
+	{
+		if (slot->capacity > 0 || WallPoolIndex + count > WallPoolEnd) return false;
+		slot->vertindex = WallPoolIndex;
+		slot->capacity = count;
+		WallPoolIndex += count;
+	}
+	auto ptr = fvb->GetBuffer(slot->vertindex);
+	slot->key = key;
+	slot->vertcount = CreateVertices(ptr, split);
+	slot->lastframe = fvb->mFrameCount;
+	vertindex = slot->vertindex;
+	vertcount = slot->vertcount;
+	return true;
+}
+
 void HWWall::MakeVertices(HWDrawInfo *di, bool nosplit)
 {
 	if (vertcount == 0)
 	{
 		bool split = (gl_seamless && !nosplit && seg->sidedef != nullptr && !(seg->sidedef->Flags & WALLF_POLYOBJ) && !(flags & HWF_NOSPLIT));
+		if (GetCachedVertices(split)) return;
 		auto ret = screen->mVertexData->AllocVertices(split ? CountVertices() : 4);
 		vertindex = ret.second;
 		vertcount = CreateVertices(ret.first, split);
@@ -0,0 +1,128 @@
+/*
+**  Helper functions for the AVX2 truecolor drawers
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba.h"
+
+// The AVX2 drawers work on four pixels at a time with one 16 bit value per color channel.
+// All of these may only be used from functions that are marked with AVX2TARGET.
+
+namespace swrenderer
+{
+	namespace DrawAVX2
+	{
+		// Expands four BGRA pixels to 16 bits per channel.
+		FORCEINLINE AVX2TARGET __m256i VECTORCALL UnpackPixels(__m128i pixels)
+		{
+			return _mm256_cvtepu8_epi16(pixels);
+		}
+
+		// Saturates four pixels back to 8 bits per channel.
+		FORCEINLINE AVX2TARGET __m128i VECTORCALL PackPixels(__m256i color)
+		{
+			// packus works within each 128 bit lane, so the two halves need to be moved together afterwards.
+			__m256i packed = _mm256_packus_epi16(color, _mm256_setzero_si256());
+			packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+			return _mm256_castsi256_si128(packed);
+		}
+
+		// Repeats a constant of two pixels, as used by the SSE2 drawers, for all four pixels.
+		FORCEINLINE AVX2TARGET __m256i VECTORCALL Broadcast(__m128i twopixels)
+		{
+			return _mm256_broadcastsi128_si256(twopixels);
+		}
+
+		// Turns one 32 bit value per pixel into the same 16 bit value for each channel of that pixel.
+		FORCEINLINE AVX2TARGET __m256i VECTORCALL ExpandPerPixel(__m128i values)
+		{
+			__m128i v = _mm_packs_epi32(values, values);
+			v = _mm_unpacklo_epi16(v, v);
+			__m128i lo = _mm_unpacklo_epi32(v, v);
+			__m128i hi = _mm_unpackhi_epi32(v, v);
+			return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		}
+
+		// Calculates the colored light contribution of the dynamic lights. viewpos holds the varying coordinate of each of the four pixels.
+		FORCEINLINE AVX2TARGET __m256i VECTORCALL AddLights(__m256i material, __m256i fgcolor, const DrawerLight *lights, int num_lights, __m128 viewpos, bool columnlight)
+		{
+			__m256i lit = _mm256_setzero_si256();
+
+			for (int i = 0; i != num_lights; i++)
+			{
+				// Walls vary in z, the squared xy distance is stored in x and the normal factor in y.
+				// Spans vary in x, the squared yz distance is stored in y and the normal factor in z.
+				__m128 light_xy2 = _mm_set1_ps(columnlight ? lights[i].x : lights[i].y);
+				__m128 light_pos = _mm_set1_ps(columnlight ? lights[i].z : lights[i].x);
+				__m128 light_normal = _mm_set1_ps(columnlight ? lights[i].y : lights[i].z);
+				__m128 light_radius = _mm_set1_ps(lights[i].radius);
+				__m128 m256 = _mm_set1_ps(256.0f);
+
+				// L = light-pos
+				// dist = sqrt(dot(L, L))
+				// distance_attenuation = 1 - MIN(dist * (1/radius), 1)
+				__m128 L = _mm_sub_ps(light_pos, viewpos);
+				__m128 dist2 = _mm_add_ps(light_xy2, _mm_mul_ps(L, L));
+				__m128 rcp_dist = _mm_rsqrt_ps(dist2);
+				__m128 dist = _mm_mul_ps(dist2, rcp_dist);
+				__m128 distance_attenuation = _mm_sub_ps(m256, _mm_min_ps(_mm_mul_ps(dist, light_radius), m256));
+
+				// The simple light type
+				__m128 simple_attenuation = distance_attenuation;
+
+				// The point light type
+				// diffuse = dot(N,L) * attenuation
+				__m128 point_attenuation = _mm_mul_ps(_mm_mul_ps(light_normal, rcp_dist), distance_attenuation);
+
+				__m128 is_attenuated = _mm_cmpeq_ps(light_normal, _mm_setzero_ps());
+				__m256i attenuation = ExpandPerPixel(_mm_cvtps_epi32(_mm_blendv_ps(point_attenuation, simple_attenuation, is_attenuated)));
+
+				__m256i light_color = UnpackPixels(_mm_set1_epi32(lights[i].color));
+
+				lit = _mm256_add_epi16(lit, _mm256_srli_epi16(_mm256_mullo_epi16(light_color, attenuation), 8));
+			}
+
+			lit = _mm256_min_epi16(lit, _mm256_set1_epi16(256));
+
+			fgcolor = _mm256_add_epi16(fgcolor, _mm256_srli_epi16(_mm256_mullo_epi16(material, lit), 8));
+			fgcolor = _mm256_min_epi16(fgcolor, _mm256_set1_epi16(255));
+			return fgcolor;
+		}
+
+		// Desaturation intensity of each pixel, placed in the color channels.
+		FORCEINLINE AVX2TARGET __m256i VECTORCALL Intensity(__m128i ifgcolor, int desaturate)
+		{
+			// red * 77 + green * 143 + blue * 37, with the alpha channel dropped
+			__m256i weighted = _mm256_madd_epi16(UnpackPixels(ifgcolor), _mm256_setr_epi16(37, 143, 77, 0, 37, 143, 77, 0, 37, 143, 77, 0, 37, 143, 77, 0));
+			__m256i sum = _mm256_hadd_epi32(weighted, weighted);
+			sum = _mm256_permute4x64_epi64(sum, _MM_SHUFFLE(3, 1, 2, 0));
+			__m128i intensity = _mm_mullo_epi32(_mm_srli_epi32(_mm256_castsi256_si128(sum), 8), _mm_set1_epi32(desaturate));
+
+			// intensity can exceed the signed 16 bit range, so it must not be packed with signed saturation
+			__m128i v = _mm_packus_epi32(intensity, intensity);
+			v = _mm_unpacklo_epi16(v, v);
+			__m128i lo = _mm_unpacklo_epi32(v, v);
+			__m128i hi = _mm_unpackhi_epi32(v, v);
+			__m256i result = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+			return _mm256_and_si256(result, _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0));
+		}
+	}
+}
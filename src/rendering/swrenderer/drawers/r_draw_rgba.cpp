@@ -59,6 +59,8 @@
 #include "r_draw_sprite32_sse2.h"
 #include "r_draw_span32_sse2.h"
 #include "r_draw_sky32_sse2.h"
+#include "r_draw_wall32_avx2.h"
+#include "r_draw_span32_avx2.h"
 #endif
 
 #include "gi.h"
@@ -79,36 +81,45 @@ CVAR(Bool, r_mipmap, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 // Level of detail texture bias
 CVAR(Float, r_lod_bias, -1.5, 0); // To do: add CVAR_ARCHIVE | CVAR_GLOBALCONFIG when a good default has been decided
 
+// Use the AVX2 wall and span drawers if the CPU supports them
+CVAR(Bool, r_avx2drawers, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+
+#ifndef NO_SSE
+#define PUSH_DRAWER(command, avx2command) if (CPU.bAVX2 && r_avx2drawers) Queue->Push<avx2command>(args); else Queue->Push<command>(args)
+#else
+#define PUSH_DRAWER(command, avx2command) Queue->Push<command>(args)
+#endif
+
 namespace swrenderer
 {
 	void SWTruecolorDrawers::DrawWall(const WallDrawerArgs &args)
 	{
-		Queue->Push<DrawWall32Command>(args);
+		PUSH_DRAWER(DrawWall32Command, DrawWall32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawWallMasked(const WallDrawerArgs &args)
 	{
-		Queue->Push<DrawWallMasked32Command>(args);
+		PUSH_DRAWER(DrawWallMasked32Command, DrawWallMasked32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawWallAdd(const WallDrawerArgs &args)
 	{
-		Queue->Push<DrawWallAddClamp32Command>(args);
+		PUSH_DRAWER(DrawWallAddClamp32Command, DrawWallAddClamp32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawWallAddClamp(const WallDrawerArgs &args)
 	{
-		Queue->Push<DrawWallAddClamp32Command>(args);
+		PUSH_DRAWER(DrawWallAddClamp32Command, DrawWallAddClamp32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawWallSubClamp(const WallDrawerArgs &args)
 	{
-		Queue->Push<DrawWallSubClamp32Command>(args);
+		PUSH_DRAWER(DrawWallSubClamp32Command, DrawWallSubClamp32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawWallRevSubClamp(const WallDrawerArgs &args)
 	{
-		Queue->Push<DrawWallRevSubClamp32Command>(args);
+		PUSH_DRAWER(DrawWallRevSubClamp32Command, DrawWallRevSubClamp32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawColumn(const SpriteDrawerArgs &args)
@@ -212,32 +223,32 @@ namespace swrenderer
 
 	void SWTruecolorDrawers::DrawSpan(const SpanDrawerArgs &args)
 	{
-		Queue->Push<DrawSpan32Command>(args);
+		PUSH_DRAWER(DrawSpan32Command, DrawSpan32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMasked(const SpanDrawerArgs &args)
 	{
-		Queue->Push<DrawSpanMasked32Command>(args);
+		PUSH_DRAWER(DrawSpanMasked32Command, DrawSpanMasked32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanTranslucent(const SpanDrawerArgs &args)
 	{
-		Queue->Push<DrawSpanTranslucent32Command>(args);
+		PUSH_DRAWER(DrawSpanTranslucent32Command, DrawSpanTranslucent32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedTranslucent(const SpanDrawerArgs &args)
 	{
-		Queue->Push<DrawSpanAddClamp32Command>(args);
+		PUSH_DRAWER(DrawSpanAddClamp32Command, DrawSpanAddClamp32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanAddClamp(const SpanDrawerArgs &args)
 	{
-		Queue->Push<DrawSpanTranslucent32Command>(args);
+		PUSH_DRAWER(DrawSpanTranslucent32Command, DrawSpanTranslucent32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedAddClamp(const SpanDrawerArgs &args)
 	{
-		Queue->Push<DrawSpanAddClamp32Command>(args);
+		PUSH_DRAWER(DrawSpanAddClamp32Command, DrawSpanAddClamp32AVX2Command);
 	}
 	
 	void SWTruecolorDrawers::DrawSingleSkyColumn(const SkyDrawerArgs &args)
@@ -493,40 +504,21 @@ namespace swrenderer
 		uint32_t light = LightBgra::calc_light_multiplier(_light);
 		ShadeConstants constants = _shade_constants;
 
-		do
+		if (constants.simple_shade)
 		{
-			uint32_t red = (dest[x] >> 16) & 0xff;
-			uint32_t green = (dest[x] >> 8) & 0xff;
-			uint32_t blue = dest[x] & 0xff;
-
-			if (constants.simple_shade)
+			do
 			{
-				red = red * light / 256;
-				green = green * light / 256;
-				blue = blue * light / 256;
-			}
-			else
+				dest[x] = LightBgra::shade_bgra_simple(dest[x], light);
+			} while (++x <= x2);
+		}
+		else
+		{
+			LightBgra::ShadeFactors factors = LightBgra::calc_shade_factors(light, constants);
+			do
 			{
-				uint32_t inv_light = 256 - light;
-				uint32_t inv_desaturate = 256 - constants.desaturate;
-
-				uint32_t intensity = ((red * 77 + green * 143 + blue * 37) >> 8) * constants.desaturate;
-
-				red = (red * inv_desaturate + intensity) / 256;
-				green = (green * inv_desaturate + intensity) / 256;
-				blue = (blue * inv_desaturate + intensity) / 256;
-
-				red = (constants.fade_red * inv_light + red * light) / 256;
-				green = (constants.fade_green * inv_light + green * light) / 256;
-				blue = (constants.fade_blue * inv_light + blue * light) / 256;
-
-				red = (red * constants.light_red) / 256;
-				green = (green * constants.light_green) / 256;
-				blue = (blue * constants.light_blue) / 256;
-			}
-
-			dest[x] = 0xff000000 | (red << 16) | (green << 8) | blue;
-		} while (++x <= x2);
+				dest[x] = 0xff000000 | LightBgra::shade_bgra(dest[x], factors, constants);
+			} while (++x <= x2);
+		}
 	}
 
 	/////////////////////////////////////////////////////////////////////////////
@@ -588,6 +580,10 @@ namespace swrenderer
 		fixed_t light = lightstart;
 		fixed_t steplight = (lightend - lightstart) / count;
 
+		// The light multiplier only changes every few pixels, so keep the factors until it does.
+		uint32_t factorslight = LightBgra::calc_light_multiplier(light);
+		LightBgra::ShadeFactors factors = LightBgra::calc_shade_factors(factorslight, _shade_constants);
+
 		// Texture coordinates
 		double uz = _plane_su[2] + _plane_su[1] * (viewport->viewwindow.centery - _y) + _plane_su[0] * (_x1 - viewport->viewwindow.centerx);
 		double vz = _plane_sv[2] + _plane_sv[1] * (viewport->viewwindow.centery - _y) + _plane_sv[0] * (_x1 - viewport->viewwindow.centerx);
@@ -619,10 +615,20 @@ namespace swrenderer
 				uint32_t sy = ((v >> 16) * source_height) >> 16;
 				uint32_t fg = _source[sy + sx * source_height];
 
+				uint32_t lightmul = LightBgra::calc_light_multiplier(light);
 				if (_shade_constants.simple_shade)
-					*(dest++) = LightBgra::shade_bgra_simple(fg, LightBgra::calc_light_multiplier(light));
+				{
+					*(dest++) = LightBgra::shade_bgra_simple(fg, lightmul);
+				}
 				else
-					*(dest++) = LightBgra::shade_bgra(fg, LightBgra::calc_light_multiplier(light), _shade_constants);
+				{
+					if (lightmul != factorslight)
+					{
+						factorslight = lightmul;
+						factors = LightBgra::calc_shade_factors(factorslight, _shade_constants);
+					}
+					*(dest++) = LightBgra::shade_bgra(fg, factors, _shade_constants);
+				}
 
 				u += stepu;
 				v += stepv;
@@ -646,10 +652,20 @@ namespace swrenderer
 			uint32_t sy = ((v >> 16) * source_height) >> 16;
 			uint32_t fg = _source[sy + sx * source_height];
 
+			uint32_t lightmul = LightBgra::calc_light_multiplier(light);
 			if (_shade_constants.simple_shade)
-				*(dest++) = LightBgra::shade_bgra_simple(fg, LightBgra::calc_light_multiplier(light));
+			{
+				*(dest++) = LightBgra::shade_bgra_simple(fg, lightmul);
+			}
 			else
-				*(dest++) = LightBgra::shade_bgra(fg, LightBgra::calc_light_multiplier(light), _shade_constants);
+			{
+				if (lightmul != factorslight)
+				{
+					factorslight = lightmul;
+					factors = LightBgra::calc_shade_factors(factorslight, _shade_constants);
+				}
+				*(dest++) = LightBgra::shade_bgra(fg, factors, _shade_constants);
+			}
 
 			iz += _plane_sz[0];
 			uz += _plane_su[0];
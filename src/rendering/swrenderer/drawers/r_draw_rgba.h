@@ -70,6 +70,14 @@ namespace swrenderer
 	#define VECTORCALL
 	#endif
 
+	// Allow AVX2 instructions in a single function without building the whole file for AVX2.
+	// Such functions may only be called after checking CPU.bAVX2.
+	#if defined(__GNUC__)
+	#define AVX2TARGET __attribute__((target("avx2")))
+	#else
+	#define AVX2TARGET
+	#endif
+
 	class DrawFuzzColumnRGBACommand : public DrawerCommand
 	{
 		int _x;
@@ -359,6 +367,50 @@ namespace swrenderer
 			return 0xff000000 | (red << 16) | (green << 8) | blue;
 		}
 
+		// The parts of shade_bgra that only depend on the light level, for loops that shade many pixels with the same light
+		struct ShadeFactors
+		{
+			uint32_t light;
+			uint32_t inv_desaturate;
+			uint32_t fade_red, fade_green, fade_blue;
+		};
+
+		FORCEINLINE static ShadeFactors calc_shade_factors(uint32_t light, const ShadeConstants &constants)
+		{
+			ShadeFactors factors;
+			uint32_t inv_light = 256 - light;
+			factors.light = light;
+			factors.inv_desaturate = 256 - constants.desaturate;
+			factors.fade_red = constants.fade_red * inv_light;
+			factors.fade_green = constants.fade_green * inv_light;
+			factors.fade_blue = constants.fade_blue * inv_light;
+			return factors;
+		}
+
+		// Same result as shade_bgra for a non-simple shade
+		FORCEINLINE static uint32_t shade_bgra(uint32_t color, const ShadeFactors &factors, const ShadeConstants &constants)
+		{
+			uint32_t alpha = color & 0xff000000;
+			uint32_t red = (color >> 16) & 0xff;
+			uint32_t green = (color >> 8) & 0xff;
+			uint32_t blue = color & 0xff;
+
+			uint32_t intensity = ((red * 77 + green * 143 + blue * 37) >> 8) * constants.desaturate;
+
+			red = (red * factors.inv_desaturate + intensity) / 256;
+			green = (green * factors.inv_desaturate + intensity) / 256;
+			blue = (blue * factors.inv_desaturate + intensity) / 256;
+
+			red = (factors.fade_red + red * factors.light) / 256;
+			green = (factors.fade_green + green * factors.light) / 256;
+			blue = (factors.fade_blue + blue * factors.light) / 256;
+
+			red = (red * constants.light_red) / 256;
+			green = (green * constants.light_green) / 256;
+			blue = (blue * constants.light_blue) / 256;
+			return alpha | (red << 16) | (green << 8) | blue;
+		}
+
 		FORCEINLINE static uint32_t shade_bgra(uint32_t color, uint32_t light, const ShadeConstants &constants)
 		{
 			uint32_t alpha = color & 0xff000000;
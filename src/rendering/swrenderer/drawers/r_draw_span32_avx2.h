@@ -0,0 +1,348 @@
+/*
+**  AVX2 drawer commands for spans
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba.h"
+#include "swrenderer/drawers/r_draw_span32_sse2.h"
+#include "swrenderer/drawers/r_draw32_avx2.h"
+#include "swrenderer/viewport/r_spandrawer.h"
+
+namespace swrenderer
+{
+	// Same output as DrawSpan32T, but four pixels per iteration and gathered texture fetches.
+	template<typename BlendT>
+	class DrawSpan32AVX2T : public DrawSpan32T<BlendT>
+	{
+		typedef DrawSpan32T<BlendT> Super;
+		typedef typename Super::TextureData TextureData;
+		using Super::args;
+
+	public:
+		DrawSpan32AVX2T(const SpanDrawerArgs &drawerargs) : Super(drawerargs) { }
+
+		void Execute(DrawerThread *thread) override
+		{
+			using namespace DrawSpan32TModes;
+
+			if (thread->line_skipped_by_thread(args.DestY())) return;
+
+			TextureData texdata;
+			texdata.width = args.TextureWidth();
+			texdata.height = args.TextureHeight();
+			texdata.xstep = args.TextureUStep();
+			texdata.ystep = args.TextureVStep();
+			texdata.xfrac = args.TextureUPos();
+			texdata.yfrac = args.TextureVPos();
+
+			texdata.source = (const uint32_t*)args.TexturePixels();
+
+			double lod = args.TextureLOD();
+			bool mipmapped = args.MipmappedTexture();
+
+			bool magnifying = lod < 0.0;
+			if (r_mipmap && mipmapped)
+			{
+				int level = (int)lod;
+				while (level > 0)
+				{
+					if (texdata.width <= 2 || texdata.height <= 2)
+						break;
+
+					texdata.source += texdata.width * texdata.height;
+					texdata.width = MAX<uint32_t>(texdata.width / 2, 1);
+					texdata.height = MAX<uint32_t>(texdata.height / 2, 1);
+					level--;
+				}
+			}
+
+			texdata.xone = (0x80000000u / texdata.width) << 1;
+			texdata.yone = (0x80000000u / texdata.height) << 1;
+
+			bool is_nearest_filter = (magnifying && !r_magfilter) || (!magnifying && !r_minfilter);
+			bool is_64x64 = texdata.width == 64 && texdata.height == 64;
+
+			auto shade_constants = args.ColormapConstants();
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+				{
+					if (is_64x64)
+						Loop<SimpleShade, NearestFilter, TextureSize64x64>(thread, texdata, shade_constants);
+					else
+						Loop<SimpleShade, NearestFilter, TextureSizeAny>(thread, texdata, shade_constants);
+				}
+				else
+				{
+					if (is_64x64)
+						Loop<SimpleShade, LinearFilter, TextureSize64x64>(thread, texdata, shade_constants);
+					else
+						Loop<SimpleShade, LinearFilter, TextureSizeAny>(thread, texdata, shade_constants);
+				}
+			}
+			else
+			{
+				if (is_nearest_filter)
+				{
+					if (is_64x64)
+						Loop<AdvancedShade, NearestFilter, TextureSize64x64>(thread, texdata, shade_constants);
+					else
+						Loop<AdvancedShade, NearestFilter, TextureSizeAny>(thread, texdata, shade_constants);
+				}
+				else
+				{
+					if (is_64x64)
+						Loop<AdvancedShade, LinearFilter, TextureSize64x64>(thread, texdata, shade_constants);
+					else
+						Loop<AdvancedShade, LinearFilter, TextureSizeAny>(thread, texdata, shade_constants);
+				}
+			}
+		}
+
+		// Must not be inlined into Execute because that one is not compiled for AVX2.
+		template<typename ShadeModeT, typename FilterModeT, typename TextureSizeT>
+		AVX2TARGET void Loop(DrawerThread *thread, TextureData texdata, ShadeConstants shade_constants)
+		{
+			using namespace DrawSpan32TModes;
+
+			// Shade constants
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m256i mlight = DrawAVX2::Broadcast(_mm_set_epi16(256, light, light, light, 256, light, light, light));
+			__m128i inv_light = _mm_set_epi16(0, 256 - light, 256 - light, 256 - light, 0, 256 - light, 256 - light, 256 - light);
+
+			__m256i inv_desaturate, shade_fade, shade_light;
+			int desaturate;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				inv_desaturate = DrawAVX2::Broadcast(_mm_setr_epi16(256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate));
+				__m128i fade = _mm_set_epi16(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue, shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = DrawAVX2::Broadcast(_mm_mullo_epi16(fade, inv_light));
+				shade_light = DrawAVX2::Broadcast(_mm_set_epi16(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue, shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue));
+				desaturate = shade_constants.desaturate;
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+			}
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpx = args.dc_viewpos.X;
+			float stepvpx = args.dc_viewpos_step.X;
+			__m128 viewpos_x = _mm_setr_ps(vpx, vpx + stepvpx, vpx + stepvpx * 2.0f, vpx + stepvpx * 3.0f);
+			__m128 step_viewpos_x = _mm_set1_ps(stepvpx * 4.0f);
+
+			int count = args.DestX2() - args.DestX1() + 1;
+			uint32_t *dest = (uint32_t*)args.Viewport()->GetDest(args.DestX1(), args.DestY());
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				texdata.xfrac -= texdata.xone / 2;
+				texdata.yfrac -= texdata.yone / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			__m128i xfracoffsets = _mm_setr_epi32(0, texdata.xstep, texdata.xstep * 2, texdata.xstep * 3);
+			__m128i yfracoffsets = _mm_setr_epi32(0, texdata.ystep, texdata.ystep * 2, texdata.ystep * 3);
+			__m128i mwidth = _mm_set1_epi32(texdata.width);
+			__m128i mheight = _mm_set1_epi32(texdata.height);
+
+			int avxcount = count / 4;
+			for (int index = 0; index < avxcount; index++)
+			{
+				int offset = index * 4;
+
+				__m128i bgcolor;
+				if (BlendT::Mode != (int)SpanBlendModes::Opaque)
+				{
+					bgcolor = _mm_loadu_si128((const __m128i*)(dest + offset));
+				}
+				else
+				{
+					bgcolor = _mm_setzero_si128();
+				}
+
+				__m128i fgcolor;
+				if (FilterModeT::Mode == (int)FilterModes::Nearest)
+				{
+					__m128i xfracs = _mm_add_epi32(_mm_set1_epi32(texdata.xfrac), xfracoffsets);
+					__m128i yfracs = _mm_add_epi32(_mm_set1_epi32(texdata.yfrac), yfracoffsets);
+					__m128i sample_index;
+					if (TextureSizeT::Mode == (int)SpanTextureSize::Size64x64)
+					{
+						sample_index = _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(xfracs, 32 - 6 - 6), _mm_set1_epi32(63 * 64)), _mm_srli_epi32(yfracs, 32 - 6));
+					}
+					else
+					{
+						__m128i x = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(xfracs, 16), mwidth), 16);
+						__m128i y = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(yfracs, 16), mheight), 16);
+						sample_index = _mm_add_epi32(_mm_mullo_epi32(x, mheight), y);
+					}
+					fgcolor = _mm_i32gather_epi32((const int*)texdata.source, sample_index, 4);
+				}
+				else
+				{
+					uint32_t ifgcolor[4];
+					for (int i = 0; i < 4; i++)
+						ifgcolor[i] = Super::template Sample<FilterModeT, TextureSizeT>(texdata.width, texdata.height, texdata.xone, texdata.yone, texdata.xstep, texdata.ystep, texdata.xfrac + texdata.xstep * i, texdata.yfrac + texdata.ystep * i, texdata.source);
+					fgcolor = _mm_loadu_si128((const __m128i*)ifgcolor);
+				}
+				texdata.xfrac += texdata.xstep * 4;
+				texdata.yfrac += texdata.ystep * 4;
+
+				__m128i outcolor = Process<ShadeModeT>(fgcolor, bgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_x, srcalpha, destalpha);
+
+				_mm_storeu_si128((__m128i*)(dest + offset), outcolor);
+				viewpos_x = _mm_add_ps(viewpos_x, step_viewpos_x);
+			}
+
+			int remaining = count - avxcount * 4;
+			if (remaining > 0)
+			{
+				int offset = avxcount * 4;
+
+				uint32_t ifgcolor[4] = { 0, 0, 0, 0 };
+				uint32_t ibgcolor[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < remaining; i++)
+				{
+					if (BlendT::Mode != (int)SpanBlendModes::Opaque)
+						ibgcolor[i] = dest[offset + i];
+					ifgcolor[i] = Super::template Sample<FilterModeT, TextureSizeT>(texdata.width, texdata.height, texdata.xone, texdata.yone, texdata.xstep, texdata.ystep, texdata.xfrac, texdata.yfrac, texdata.source);
+					texdata.xfrac += texdata.xstep;
+					texdata.yfrac += texdata.ystep;
+				}
+
+				__m128i outcolor = Process<ShadeModeT>(_mm_loadu_si128((const __m128i*)ifgcolor), _mm_loadu_si128((const __m128i*)ibgcolor), mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_x, srcalpha, destalpha);
+
+				uint32_t ioutcolor[4];
+				_mm_storeu_si128((__m128i*)ioutcolor, outcolor);
+				for (int i = 0; i < remaining; i++)
+					dest[offset + i] = ioutcolor[i];
+			}
+
+			_mm256_zeroupper();
+		}
+
+		template<typename ShadeModeT>
+		FORCEINLINE AVX2TARGET __m128i VECTORCALL Process(__m128i ifgcolor, __m128i ibgcolor, __m256i mlight, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, const DrawerLight *lights, int num_lights, __m128 viewpos_x, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawSpan32TModes;
+
+			__m256i fgcolor = DrawAVX2::UnpackPixels(ifgcolor);
+			__m256i bgcolor = (BlendT::Mode != (int)SpanBlendModes::Opaque) ? DrawAVX2::UnpackPixels(ibgcolor) : _mm256_setzero_si256();
+
+			__m256i material = fgcolor;
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+			}
+			else
+			{
+				__m256i intensity = DrawAVX2::Intensity(ifgcolor, desaturate);
+
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fgcolor, inv_desaturate), intensity), 8);
+				fgcolor = _mm256_mullo_epi16(fgcolor, mlight);
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(shade_fade, fgcolor), 8);
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, shade_light), 8);
+			}
+			fgcolor = DrawAVX2::AddLights(material, fgcolor, lights, num_lights, viewpos_x, false);
+
+			return Blend(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+		}
+
+		FORCEINLINE AVX2TARGET __m128i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, __m128i ifgcolor, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawSpan32TModes;
+
+			if (BlendT::Mode == (int)SpanBlendModes::Opaque)
+			{
+				return _mm_or_si128(DrawAVX2::PackPixels(fgcolor), _mm_set1_epi32(0xff000000));
+			}
+			else if (BlendT::Mode == (int)SpanBlendModes::Masked)
+			{
+				__m256i mask = _mm256_cmpeq_epi32(_mm256_packus_epi16(fgcolor, _mm256_setzero_si256()), _mm256_setzero_si256());
+				mask = _mm256_unpacklo_epi8(mask, _mm256_setzero_si256());
+				__m256i outcolor = _mm256_or_si256(_mm256_and_si256(mask, bgcolor), _mm256_andnot_si256(mask, fgcolor));
+				return _mm_or_si128(DrawAVX2::PackPixels(outcolor), _mm_set1_epi32(0xff000000));
+			}
+			else
+			{
+				__m256i fgalpha, bgalpha;
+				if (BlendT::Mode == (int)SpanBlendModes::Translucent)
+				{
+					fgalpha = _mm256_set1_epi16(srcalpha);
+					bgalpha = _mm256_set1_epi16(destalpha);
+				}
+				else
+				{
+					__m128i alpha = _mm_srli_epi32(ifgcolor, 24);
+					alpha = _mm_add_epi32(alpha, _mm_srli_epi32(alpha, 7)); // 255->256
+					__m128i inv_alpha = _mm_sub_epi32(_mm_set1_epi32(256), alpha);
+
+					bgalpha = DrawAVX2::ExpandPerPixel(_mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_set1_epi32(destalpha), alpha), _mm_slli_epi32(inv_alpha, 8)), _mm_set1_epi32(128)), 8));
+					fgalpha = DrawAVX2::ExpandPerPixel(_mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_set1_epi32(srcalpha), alpha), _mm_set1_epi32(128)), 8));
+				}
+
+				fgcolor = _mm256_mullo_epi16(fgcolor, fgalpha);
+				bgcolor = _mm256_mullo_epi16(bgcolor, bgalpha);
+
+				__m256i fg_lo = _mm256_unpacklo_epi16(fgcolor, _mm256_setzero_si256());
+				__m256i bg_lo = _mm256_unpacklo_epi16(bgcolor, _mm256_setzero_si256());
+				__m256i fg_hi = _mm256_unpackhi_epi16(fgcolor, _mm256_setzero_si256());
+				__m256i bg_hi = _mm256_unpackhi_epi16(bgcolor, _mm256_setzero_si256());
+
+				__m256i out_lo, out_hi;
+				if (BlendT::Mode == (int)SpanBlendModes::Translucent || BlendT::Mode == (int)SpanBlendModes::AddClamp)
+				{
+					out_lo = _mm256_add_epi32(fg_lo, bg_lo);
+					out_hi = _mm256_add_epi32(fg_hi, bg_hi);
+				}
+				else if (BlendT::Mode == (int)SpanBlendModes::SubClamp)
+				{
+					out_lo = _mm256_sub_epi32(fg_lo, bg_lo);
+					out_hi = _mm256_sub_epi32(fg_hi, bg_hi);
+				}
+				else
+				{
+					out_lo = _mm256_sub_epi32(bg_lo, fg_lo);
+					out_hi = _mm256_sub_epi32(bg_hi, fg_hi);
+				}
+
+				out_lo = _mm256_srai_epi32(out_lo, 8);
+				out_hi = _mm256_srai_epi32(out_hi, 8);
+				__m256i outcolor = _mm256_packs_epi32(out_lo, out_hi);
+				return _mm_or_si128(DrawAVX2::PackPixels(outcolor), _mm_set1_epi32(0xff000000));
+			}
+		}
+	};
+
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::OpaqueSpan> DrawSpan32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::MaskedSpan> DrawSpanMasked32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::TranslucentSpan> DrawSpanTranslucent32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::AddClampSpan> DrawSpanAddClamp32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::SubClampSpan> DrawSpanSubClamp32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::RevSubClampSpan> DrawSpanRevSubClamp32AVX2Command;
+}
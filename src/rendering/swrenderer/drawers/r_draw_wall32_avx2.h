@@ -0,0 +1,329 @@
+/*
+**  AVX2 drawer commands for walls
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_pal.h"
+#include "swrenderer/drawers/r_draw_rgba.h"
+#include "swrenderer/drawers/r_draw_wall32_sse2.h"
+#include "swrenderer/drawers/r_draw32_avx2.h"
+#include "swrenderer/viewport/r_walldrawer.h"
+
+namespace swrenderer
+{
+	// Same output as DrawWall32T, but four pixels per iteration and gathered texture fetches.
+	template<typename BlendT>
+	class DrawWall32AVX2T : public DrawWallCommand
+	{
+	public:
+		DrawWall32AVX2T(const WallDrawerArgs &drawerargs) : DrawWallCommand(drawerargs) { }
+
+		void DrawColumn(DrawerThread *thread, const WallColumnDrawerArgs& args) override
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			bool is_nearest_filter = (source2 == nullptr);
+			auto shade_constants = args.ColormapConstants();
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+					Loop<SimpleShade, NearestFilter>(thread, args, shade_constants);
+				else
+					Loop<SimpleShade, LinearFilter>(thread, args, shade_constants);
+			}
+			else
+			{
+				if (is_nearest_filter)
+					Loop<AdvancedShade, NearestFilter>(thread, args, shade_constants);
+				else
+					Loop<AdvancedShade, LinearFilter>(thread, args, shade_constants);
+			}
+		}
+
+		// Must not be inlined into DrawColumn because that one is not compiled for AVX2.
+		template<typename ShadeModeT, typename FilterModeT>
+		AVX2TARGET void Loop(DrawerThread *thread, const WallColumnDrawerArgs& args, ShadeConstants shade_constants)
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source = (const uint32_t*)args.TexturePixels();
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			int textureheight = args.TextureHeight();
+			uint32_t one = ((0x80000000 + textureheight - 1) / textureheight) * 2 + 1;
+
+			// Shade constants
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m256i mlight = DrawAVX2::Broadcast(_mm_set_epi16(256, light, light, light, 256, light, light, light));
+			__m128i inv_light = _mm_set_epi16(0, 256 - light, 256 - light, 256 - light, 0, 256 - light, 256 - light, 256 - light);
+
+			__m256i inv_desaturate, shade_fade, shade_light;
+			int desaturate;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				inv_desaturate = DrawAVX2::Broadcast(_mm_setr_epi16(256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate));
+				__m128i fade = _mm_set_epi16(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue, shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = DrawAVX2::Broadcast(_mm_mullo_epi16(fade, inv_light));
+				shade_light = DrawAVX2::Broadcast(_mm_set_epi16(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue, shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue));
+				desaturate = shade_constants.desaturate;
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+			}
+
+			int count = args.Count();
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			uint32_t texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+			int dest_y = args.DestY();
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpz = args.dc_viewpos.Z + args.dc_viewpos_step.Z * thread->skipped_by_thread(dest_y);
+			float stepvpz = args.dc_viewpos_step.Z * thread->num_cores;
+			__m128 viewpos_z = _mm_setr_ps(vpz, vpz + stepvpz, vpz + stepvpz * 2.0f, vpz + stepvpz * 3.0f);
+			__m128 step_viewpos_z = _mm_set1_ps(stepvpz * 4.0f);
+
+			count = thread->count_for_thread(dest_y, count);
+			if (count <= 0) return;
+			frac += thread->skipped_by_thread(dest_y) * fracstep;
+			dest = thread->dest_for_thread(dest_y, pitch, dest);
+			fracstep *= thread->num_cores;
+			pitch *= thread->num_cores;
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				frac -= one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			__m128i destoffsets = _mm_setr_epi32(0, pitch, pitch * 2, pitch * 3);
+			__m128i fracoffsets = _mm_setr_epi32(0, fracstep, fracstep * 2, fracstep * 3);
+			__m128i mtextureheight = _mm_set1_epi32(textureheight);
+
+			int avxcount = count / 4;
+			for (int index = 0; index < avxcount; index++)
+			{
+				uint32_t *destpos = dest + index * pitch * 4;
+
+				__m128i bgcolor;
+				if (BlendT::Mode != (int)WallBlendModes::Opaque)
+				{
+					bgcolor = _mm_i32gather_epi32((const int*)destpos, destoffsets, 4);
+				}
+				else
+				{
+					bgcolor = _mm_setzero_si128();
+				}
+
+				__m128i fgcolor;
+				if (FilterModeT::Mode == (int)FilterModes::Nearest)
+				{
+					__m128i fracs = _mm_add_epi32(_mm_set1_epi32(frac), fracoffsets);
+					__m128i sample_index = _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(fracs, FRACBITS), mtextureheight), FRACBITS);
+					fgcolor = _mm_i32gather_epi32((const int*)source, sample_index, 4);
+				}
+				else
+				{
+					uint32_t ifgcolor[4];
+					for (int i = 0; i < 4; i++)
+						ifgcolor[i] = Sample<FilterModeT>(frac + fracstep * i, source, source2, textureheight, one, texturefracx);
+					fgcolor = _mm_loadu_si128((const __m128i*)ifgcolor);
+				}
+				frac += fracstep * 4;
+
+				__m128i outcolor = Process<ShadeModeT>(fgcolor, bgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_z, srcalpha, destalpha);
+
+				destpos[0] = _mm_cvtsi128_si32(outcolor);
+				destpos[pitch] = _mm_extract_epi32(outcolor, 1);
+				destpos[pitch * 2] = _mm_extract_epi32(outcolor, 2);
+				destpos[pitch * 3] = _mm_extract_epi32(outcolor, 3);
+				viewpos_z = _mm_add_ps(viewpos_z, step_viewpos_z);
+			}
+
+			int remaining = count - avxcount * 4;
+			if (remaining > 0)
+			{
+				uint32_t *destpos = dest + avxcount * pitch * 4;
+
+				uint32_t ifgcolor[4] = { 0, 0, 0, 0 };
+				uint32_t ibgcolor[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < remaining; i++)
+				{
+					if (BlendT::Mode != (int)WallBlendModes::Opaque)
+						ibgcolor[i] = destpos[i * pitch];
+					ifgcolor[i] = Sample<FilterModeT>(frac, source, source2, textureheight, one, texturefracx);
+					frac += fracstep;
+				}
+
+				__m128i outcolor = Process<ShadeModeT>(_mm_loadu_si128((const __m128i*)ifgcolor), _mm_loadu_si128((const __m128i*)ibgcolor), mlight, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_z, srcalpha, destalpha);
+
+				uint32_t ioutcolor[4];
+				_mm_storeu_si128((__m128i*)ioutcolor, outcolor);
+				for (int i = 0; i < remaining; i++)
+					destpos[i * pitch] = ioutcolor[i];
+			}
+
+			_mm256_zeroupper();
+		}
+
+		template<typename FilterModeT>
+		FORCEINLINE unsigned int VECTORCALL Sample(uint32_t frac, const uint32_t *source, const uint32_t *source2, int textureheight, uint32_t one, uint32_t texturefracx)
+		{
+			using namespace DrawWall32TModes;
+
+			if (FilterModeT::Mode == (int)FilterModes::Nearest)
+			{
+				int sample_index = ((frac >> FRACBITS) * textureheight) >> FRACBITS;
+				return source[sample_index];
+			}
+			else
+			{
+				unsigned int frac_y0 = (frac >> FRACBITS) * textureheight;
+				unsigned int frac_y1 = ((frac + one) >> FRACBITS) * textureheight;
+				unsigned int y0 = frac_y0 >> FRACBITS;
+				unsigned int y1 = frac_y1 >> FRACBITS;
+
+				unsigned int p00 = source[y0];
+				unsigned int p01 = source[y1];
+				unsigned int p10 = source2[y0];
+				unsigned int p11 = source2[y1];
+
+				unsigned int inv_b = texturefracx;
+				unsigned int inv_a = (frac_y1 >> (FRACBITS - 4)) & 15;
+				unsigned int a = 16 - inv_a;
+				unsigned int b = 16 - inv_b;
+
+				unsigned int sred = (RPART(p00) * (a * b) + RPART(p01) * (inv_a * b) + RPART(p10) * (a * inv_b) + RPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int sgreen = (GPART(p00) * (a * b) + GPART(p01) * (inv_a * b) + GPART(p10) * (a * inv_b) + GPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int sblue = (BPART(p00) * (a * b) + BPART(p01) * (inv_a * b) + BPART(p10) * (a * inv_b) + BPART(p11) * (inv_a * inv_b) + 127) >> 8;
+				unsigned int salpha = (APART(p00) * (a * b) + APART(p01) * (inv_a * b) + APART(p10) * (a * inv_b) + APART(p11) * (inv_a * inv_b) + 127) >> 8;
+
+				return (salpha << 24) | (sred << 16) | (sgreen << 8) | sblue;
+			}
+		}
+
+		template<typename ShadeModeT>
+		FORCEINLINE AVX2TARGET __m128i VECTORCALL Process(__m128i ifgcolor, __m128i ibgcolor, __m256i mlight, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, const DrawerLight *lights, int num_lights, __m128 viewpos_z, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawWall32TModes;
+
+			__m256i fgcolor = DrawAVX2::UnpackPixels(ifgcolor);
+			__m256i bgcolor = (BlendT::Mode != (int)WallBlendModes::Opaque) ? DrawAVX2::UnpackPixels(ibgcolor) : _mm256_setzero_si256();
+
+			fgcolor = Shade<ShadeModeT>(fgcolor, mlight, ifgcolor, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_z);
+			return Blend(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+		}
+
+		template<typename ShadeModeT>
+		FORCEINLINE AVX2TARGET __m256i VECTORCALL Shade(__m256i fgcolor, __m256i mlight, __m128i ifgcolor, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, const DrawerLight *lights, int num_lights, __m128 viewpos_z)
+		{
+			using namespace DrawWall32TModes;
+
+			__m256i material = fgcolor;
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+			}
+			else
+			{
+				__m256i intensity = DrawAVX2::Intensity(ifgcolor, desaturate);
+
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fgcolor, inv_desaturate), intensity), 8);
+				fgcolor = _mm256_mullo_epi16(fgcolor, mlight);
+				fgcolor = _mm256_srli_epi16(_mm256_add_epi16(shade_fade, fgcolor), 8);
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, shade_light), 8);
+			}
+
+			return DrawAVX2::AddLights(material, fgcolor, lights, num_lights, viewpos_z, true);
+		}
+
+		FORCEINLINE AVX2TARGET __m128i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, __m128i ifgcolor, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawWall32TModes;
+
+			if (BlendT::Mode == (int)WallBlendModes::Opaque)
+			{
+				return _mm_or_si128(DrawAVX2::PackPixels(fgcolor), _mm_set1_epi32(0xff000000));
+			}
+			else if (BlendT::Mode == (int)WallBlendModes::Masked)
+			{
+				__m256i mask = _mm256_cmpeq_epi32(_mm256_packus_epi16(fgcolor, _mm256_setzero_si256()), _mm256_setzero_si256());
+				mask = _mm256_unpacklo_epi8(mask, _mm256_setzero_si256());
+				__m256i outcolor = _mm256_or_si256(_mm256_and_si256(mask, bgcolor), _mm256_andnot_si256(mask, fgcolor));
+				return _mm_or_si128(DrawAVX2::PackPixels(outcolor), _mm_set1_epi32(0xff000000));
+			}
+			else
+			{
+				__m128i alpha = _mm_srli_epi32(ifgcolor, 24);
+				alpha = _mm_add_epi32(alpha, _mm_srli_epi32(alpha, 7)); // 255->256
+				__m128i inv_alpha = _mm_sub_epi32(_mm_set1_epi32(256), alpha);
+
+				__m128i bgalpha = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_set1_epi32(destalpha), alpha), _mm_slli_epi32(inv_alpha, 8)), _mm_set1_epi32(128)), 8);
+				__m128i fgalpha = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_set1_epi32(srcalpha), alpha), _mm_set1_epi32(128)), 8);
+
+				fgcolor = _mm256_mullo_epi16(fgcolor, DrawAVX2::ExpandPerPixel(fgalpha));
+				bgcolor = _mm256_mullo_epi16(bgcolor, DrawAVX2::ExpandPerPixel(bgalpha));
+
+				__m256i fg_lo = _mm256_unpacklo_epi16(fgcolor, _mm256_setzero_si256());
+				__m256i bg_lo = _mm256_unpacklo_epi16(bgcolor, _mm256_setzero_si256());
+				__m256i fg_hi = _mm256_unpackhi_epi16(fgcolor, _mm256_setzero_si256());
+				__m256i bg_hi = _mm256_unpackhi_epi16(bgcolor, _mm256_setzero_si256());
+
+				__m256i out_lo, out_hi;
+				if (BlendT::Mode == (int)WallBlendModes::AddClamp)
+				{
+					out_lo = _mm256_add_epi32(fg_lo, bg_lo);
+					out_hi = _mm256_add_epi32(fg_hi, bg_hi);
+				}
+				else if (BlendT::Mode == (int)WallBlendModes::SubClamp)
+				{
+					out_lo = _mm256_sub_epi32(fg_lo, bg_lo);
+					out_hi = _mm256_sub_epi32(fg_hi, bg_hi);
+				}
+				else
+				{
+					out_lo = _mm256_sub_epi32(bg_lo, fg_lo);
+					out_hi = _mm256_sub_epi32(bg_hi, fg_hi);
+				}
+
+				out_lo = _mm256_srai_epi32(out_lo, 8);
+				out_hi = _mm256_srai_epi32(out_hi, 8);
+				__m256i outcolor = _mm256_packs_epi32(out_lo, out_hi);
+				return _mm_or_si128(DrawAVX2::PackPixels(outcolor), _mm_set1_epi32(0xff000000));
+			}
+		}
+	};
+
+	typedef DrawWall32AVX2T<DrawWall32TModes::OpaqueWall> DrawWall32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::MaskedWall> DrawWallMasked32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::AddClampWall> DrawWallAddClamp32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::SubClampWall> DrawWallSubClamp32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::RevSubClampWall> DrawWallRevSubClamp32AVX2Command;
+}
@@ -146,6 +146,14 @@ namespace swrenderer
 
 		light_list = pl->lights;
 
+		// The lights stay the same for the whole plane, so only count them once instead of for every row.
+		max_lights = 0;
+		for (VisiblePlaneLight *cur_node = light_list; cur_node; cur_node = cur_node->next)
+		{
+			if (cur_node->lightsource->IsActive())
+				max_lights++;
+		}
+
 		RenderLines(pl);
 	}
 
@@ -211,21 +219,11 @@ namespace swrenderer
 			drawerargs.dc_normal.Y = 0.0f;
 			drawerargs.dc_normal.Z = (y >= viewport->CenterY) ? 1.0f : -1.0f;
 
-			// Calculate max lights that can touch the row so we can allocate memory for the list
-			int max_lights = 0;
-			VisiblePlaneLight *cur_node = light_list;
-			while (cur_node)
-			{
-				if (cur_node->lightsource->IsActive())
-					max_lights++;
-				cur_node = cur_node->next;
-			}
-
 			drawerargs.dc_num_lights = 0;
 			drawerargs.dc_lights = Thread->FrameMemory->AllocMemory<DrawerLight>(max_lights);
 
 			// Setup lights for row
-			cur_node = light_list;
+			VisiblePlaneLight *cur_node = light_list;
 			while (cur_node)
 			{
 				double lightX = cur_node->lightsource->X() - Thread->Viewport->viewpoint.Pos.X;
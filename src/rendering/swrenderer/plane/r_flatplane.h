@@ -50,6 +50,7 @@ namespace swrenderer
 		double xstepscale, ystepscale;
 		double basexfrac, baseyfrac;
 		VisiblePlaneLight *light_list;
+		int max_lights;
 		FSoftwareTexture *tex;
 
 		SpanDrawerArgs drawerargs;
@@ -272,7 +272,6 @@ namespace swrenderer
 		}
 		else
 		{
-			// make a new visplane
 			unsigned hash;
 
 			if (pl->portal != nullptr && !Thread->Portal->InSkyBox(pl->portal) && viewactive)
@@ -283,6 +282,21 @@ namespace swrenderer
 			{
 				hash = CalcHash(pl->picnum.GetIndex(), pl->lightlevel, pl->height);
 			}
+
+			// Before making a new visplane, look for an earlier split of the same one
+			// that is still free in this range. Without this, every sector behind a
+			// column that is already in use gets its own visplane.
+			for (VisiblePlane *check = visplanes[hash]; check != nullptr; check = check->next)
+			{
+				if (check != pl && IsSamePlane(check, pl) && IsRangeFree(check, start, stop))
+				{
+					check->left = MIN(check->left, start);
+					check->right = MAX(check->right, stop);
+					return check;
+				}
+			}
+
+			// make a new visplane
 			VisiblePlane *new_pl = Add(hash);
 
 			new_pl->height = pl->height;
@@ -309,6 +323,34 @@ namespace swrenderer
 		return pl;
 	}
 
+	bool VisiblePlaneList::IsSamePlane(const VisiblePlane *a, const VisiblePlane *b)
+	{
+		return a->height == b->height &&
+			a->picnum == b->picnum &&
+			a->lightlevel == b->lightlevel &&
+			a->xform == b->xform &&
+			a->colormap == b->colormap &&
+			a->portal == b->portal &&
+			a->extralight == b->extralight &&
+			a->visibility == b->visibility &&
+			a->viewpos == b->viewpos &&
+			a->viewangle == b->viewangle &&
+			a->sky == b->sky &&
+			a->Alpha == b->Alpha &&
+			a->Additive == b->Additive &&
+			a->CurrentPortalUniq == b->CurrentPortalUniq &&
+			a->MirrorFlags == b->MirrorFlags &&
+			a->CurrentSkybox == b->CurrentSkybox;
+	}
+
+	bool VisiblePlaneList::IsRangeFree(const VisiblePlane *pl, int start, int stop)
+	{
+		int x = MAX(start, pl->left);
+		int end = MIN(stop, pl->right);
+		while (x < end && pl->top[x] == 0x7fff) x++;
+		return x >= end;
+	}
+
 	bool VisiblePlaneList::HasPortalPlanes() const
 	{
 		return visplanes[MAXVISPLANES] != nullptr;
@@ -55,6 +55,8 @@ namespace swrenderer
 	private:
 		VisiblePlaneList();
 		VisiblePlane *Add(unsigned hash);
+		static bool IsSamePlane(const VisiblePlane *a, const VisiblePlane *b);
+		static bool IsRangeFree(const VisiblePlane *pl, int start, int stop);
 
 		enum { MAXVISPLANES = 128 }; // must be a power of 2
 		VisiblePlane *visplanes[MAXVISPLANES + 1];
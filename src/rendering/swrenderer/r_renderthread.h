@@ -63,6 +63,9 @@ namespace swrenderer
 		int X2 = MAXWIDTH;
 		bool MainThread = false;
 
+		// How long the last scene slice of this thread took, in nanoseconds
+		uint64_t SliceTime = 0;
+
 		std::unique_ptr<RenderMemory> FrameMemory;
 		std::unique_ptr<RenderOpaquePass> OpaquePass;
 		std::unique_ptr<RenderTranslucentPass> TranslucentPass;
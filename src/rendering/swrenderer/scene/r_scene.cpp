@@ -57,6 +57,7 @@
 #include "r_memory.h"
 #include "swrenderer/r_renderthread.h"
 #include "swrenderer/things/r_playersprite.h"
+#include "i_time.h"
 #include <chrono>
 
 #ifdef WIN32
@@ -67,6 +68,7 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 0, 0);
+CVAR(Bool, r_scene_balanceslices, true, 0);
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 bool r_modelscene = false;
@@ -221,14 +223,16 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
+		UpdateSliceBounds(numThreads);
+
 		// Setup threads:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
 		for (int i = 0; i < numThreads; i++)
 		{
 			*Threads[i]->Viewport = *MainThread()->Viewport;
 			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			Threads[i]->X1 = SliceBounds[i];
+			Threads[i]->X2 = SliceBounds[i + 1];
 		}
 		run_id++;
 		start_lock.unlock();
@@ -265,8 +269,68 @@ namespace swrenderer
 		MainThread()->X2 = viewwidth;
 	}
 
+	//==========================================================================
+	//
+	// Moves the slice borders so that each thread gets about the same amount
+	// of work, assuming the cost per column within each slice of the last
+	// frame stays the same.
+	//
+	//==========================================================================
+
+	void RenderScene::UpdateSliceBounds(int numThreads)
+	{
+		bool reset = !r_scene_balanceslices || (int)SliceBounds.Size() != numThreads + 1 || SliceBounds.Last() != viewwidth;
+
+		double totaltime = 0.0;
+		for (int i = 0; i < numThreads && !reset; i++)
+			totaltime += (double)Threads[i]->SliceTime;
+
+		if (reset || totaltime <= 0.0)
+		{
+			SliceBounds.Resize(numThreads + 1);
+			for (int i = 0; i <= numThreads; i++)
+				SliceBounds[i] = viewwidth * i / numThreads;
+			return;
+		}
+
+		// Walk the cumulative cost of the old slices and cut it into equal parts
+		TArray<int> newbounds(numThreads + 1, true);
+		newbounds[0] = 0;
+		newbounds[numThreads] = viewwidth;
+		double target = totaltime / numThreads;
+		double cost = 0.0;
+		int slice = 0;
+		for (int i = 1; i < numThreads; i++)
+		{
+			double wanted = target * i;
+			while (slice < numThreads - 1 && cost + (double)Threads[slice]->SliceTime < wanted)
+			{
+				cost += (double)Threads[slice]->SliceTime;
+				slice++;
+			}
+
+			int x1 = SliceBounds[slice];
+			int x2 = SliceBounds[slice + 1];
+			double slicetime = (double)Threads[slice]->SliceTime;
+			double t = slicetime > 0.0 ? clamp((wanted - cost) / slicetime, 0.0, 1.0) : 0.0;
+			newbounds[i] = x1 + (int)((x2 - x1) * t);
+		}
+
+		// Only go half the way to avoid oscillating, and keep a minimum width for every slice
+		int minwidth = std::max(viewwidth / (numThreads * 8), 1);
+		for (int i = 1; i < numThreads; i++)
+		{
+			int x = (SliceBounds[i] + newbounds[i]) / 2;
+			x = std::max(x, SliceBounds[i - 1] + minwidth);
+			x = std::min(x, viewwidth - (numThreads - i) * minwidth);
+			SliceBounds[i] = x;
+		}
+	}
+
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
 	{
+		uint64_t starttime = I_nsTime();
+
 		thread->DrawQueue->Clear();
 		thread->FrameMemory->Clear();
 		thread->Clip3D->Cleanup();
@@ -307,6 +371,8 @@ namespace swrenderer
 		}
 
 		DrawerThreads::Execute(thread->DrawQueue);
+
+		thread->SliceTime = I_nsTime() - starttime;
 	}
 
 	void RenderScene::StartThreads(size_t numThreads)
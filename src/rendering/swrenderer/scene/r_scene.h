@@ -61,6 +61,7 @@ namespace swrenderer
 		void RenderActorView(AActor *actor,bool renderplayersprite, bool dontmaplines);
 		void RenderThreadSlices();
 		void RenderThreadSlice(RenderThread *thread);
+		void UpdateSliceBounds(int numThreads);
 		void RenderPSprites();
 
 		void StartThreads(size_t numThreads);
@@ -71,6 +72,7 @@ namespace swrenderer
 
 		std::unique_ptr<PolyDepthStencil> DepthStencil;
 		std::vector<std::unique_ptr<RenderThread>> Threads;
+		TArray<int> SliceBounds;
 		std::mutex start_mutex;
 		std::condition_variable start_condition;
 		bool shutdown_flag = false;
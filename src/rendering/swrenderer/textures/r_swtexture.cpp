@@ -39,6 +39,7 @@
 #include "m_alloc.h"
 #include "imagehelpers.h"
 #include "texturemanager.h"
+#include "memstats.h"
 
 
 inline EUpscaleFlags scaleFlagFromUseType(ETextureType useType)
@@ -56,6 +57,25 @@ inline EUpscaleFlags scaleFlagFromUseType(ETextureType useType)
 		return UF_Texture;
 	}
 }
+//==========================================================================
+//
+// The software renderer's copies of the texture data
+//
+//==========================================================================
+
+static size_t SoftwareTextureUsage()
+{
+	size_t total = 0;
+	for (int i = 0; i < TexMan.NumTextures(); i++)
+	{
+		auto tex = TexMan.GameByIndex(i);
+		if (tex != nullptr && tex->GetSoftwareTexture() != nullptr) total += tex->GetSoftwareTexture()->GetMemoryUsage();
+	}
+	return total;
+}
+
+static FMemReporter SoftwareTextureMemory(MEM_Textures, SoftwareTextureUsage);
+
 //==========================================================================
 //
 //
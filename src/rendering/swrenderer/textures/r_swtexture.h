@@ -95,6 +95,11 @@ public:
 		Pixels.Reset();
 		PixelsBgra.Reset();
 	}
+
+	size_t GetMemoryUsage() const override
+	{
+		return Pixels.Size() + PixelsBgra.Size() * sizeof(uint32_t);
+	}
 	
 	// Returns true if the next call to GetPixels() will return an image different from the
 	// last call to GetPixels(). This should be considered valid only if a call to CheckModified()
@@ -160,6 +165,11 @@ public:
 	bool CheckModified (int which) override;
 	void GenerateBgraMipmapsFast();
 
+	size_t GetMemoryUsage() const override
+	{
+		return FSoftwareTexture::GetMemoryUsage() + WarpedPixels[0].Size() + WarpedPixels[1].Size() + WarpedPixelsRgba.Size() * sizeof(uint32_t);
+	}
+
 private:
 
 	int NextPo2 (int v); // [mxd]
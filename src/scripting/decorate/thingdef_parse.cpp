@@ -51,6 +51,7 @@
 #include "v_video.h"
 #ifndef _MSC_VER
 #include "i_system.h"  // for strlwr()
+#include "zonetrace.h"
 #endif // !_MSC_VER
 
 void ParseOldDecoration(FScanner &sc, EDefinitionType def, PNamespace *ns);
@@ -1282,6 +1283,7 @@ void ParseDecorate (FScanner &sc, PNamespace *ns)
 						fileSystem.GetResourceFileFullName(includefile), sc.String);
 				}
 			}
+			TRACE_ZONE_ARG("DECORATE", sc.String);
 			FScanner newscanner;
 			newscanner.Open(sc.String);
 			ParseDecorate(newscanner, ns);
@@ -1346,6 +1348,8 @@ void ParseAllDecorate()
 
 	while ((lump = fileSystem.FindLump("DECORATE", &lastlump)) != -1)
 	{
+		FString lumpname = fileSystem.GetFileFullPath(lump);
+		TRACE_ZONE_ARG("DECORATE", lumpname.GetChars());
 		FScanner sc(lump);
 		auto ns = Namespaces.NewNamespace(sc.LumpNum);
 		ParseDecorate(sc, ns);
@@ -55,6 +55,7 @@
 #include "thingdef.h"
 #include "zcc_parser.h"
 #include "zcc_compile_doom.h"
+#include "zonetrace.h"
 
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
 void InitThingdef();
@@ -417,6 +418,8 @@ void ParseScripts()
 
 	while ((lump = fileSystem.FindLump("ZSCRIPT", &lastlump)) != -1)
 	{
+		FString lumpname = fileSystem.GetFileFullPath(lump);
+		TRACE_ZONE_ARG("ZSCRIPT", lumpname.GetChars());
 		ZCCParseState state;
 		auto newns = ParseOneScript(lump, state);
 		PSymbolTable symtable;
@@ -440,21 +443,33 @@ void ParseScripts()
 
 void LoadActors()
 {
-	cycle_t timer;
+	cycle_t timer, zscripttimer, decoratetimer, buildtimer;
 
 	timer.Reset(); timer.Clock();
+	zscripttimer.Reset();
+	decoratetimer.Reset();
+	buildtimer.Reset();
 	FScriptPosition::ResetErrorCounter();
 
 	SetDoomCompileEnvironment();
 	InitThingdef();
 	FScriptPosition::StrictErrors = true;
+	zscripttimer.Clock();
 	ParseScripts();
+	zscripttimer.Unclock();
 
 	FScriptPosition::StrictErrors = strictdecorate;
+	decoratetimer.Clock();
 	ParseAllDecorate();
 	SynthesizeFlagFields();
+	decoratetimer.Unclock();
 
-	FunctionBuildList.Build();
+	buildtimer.Clock();
+	{
+		TRACE_ZONE("Code generation");
+		FunctionBuildList.Build();
+	}
+	buildtimer.Unclock();
 
 	if (FScriptPosition::ErrorCounter > 0)
 	{
@@ -519,7 +534,11 @@ void LoadActors()
 	}
 
 	timer.Unclock();
-	if (!batchrun) Printf("script parsing took %.2f ms\n", timer.TimeMS());
+	if (!batchrun)
+	{
+		Printf("script parsing took %.2f ms\n", timer.TimeMS());
+		DPrintf(DMSG_NOTIFY, "  ZScript: %.2f ms, DECORATE: %.2f ms, code generation: %.2f ms\n", zscripttimer.TimeMS(), decoratetimer.TimeMS(), buildtimer.TimeMS());
+	}
 
 	// Now we may call the scripted OnDestroy method.
 	PClass::bVMOperational = true;
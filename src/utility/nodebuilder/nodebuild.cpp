@@ -41,13 +41,67 @@
 #include <string.h>
 #include <math.h>
 
+#include <thread>
+#include <future>
+#include <vector>
+
 #include "doomdata.h"
 #include "nodebuild.h"
+#include "ctpl.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NODEBUILD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NODEBUILD_NEON
+#endif
 
 const int MaxSegs = 64;
 const int SplitCost = 8;
 const int AAPreference = 16;
 
+// Scoring splitters is only worth spreading over several threads if this many seg classifications are needed.
+const unsigned ParallelScoreWork = 1 << 18;
+
+static ctpl::thread_pool NodeBuilderPool;
+
+// Calculates the same side numerators as ClassifyLine for an entire set of segs, two at a time where possible.
+
+static void CalcSideNumerators (const double *x1, const double *y1, const double *x2, const double *y2, double *num1, double *num2, unsigned count,
+	double d_x1, double d_y1, double d_dx, double d_dy)
+{
+	unsigned j = 0;
+#if defined(NODEBUILD_SSE2)
+	const __m128d nx = _mm_set1_pd(d_x1), ny = _mm_set1_pd(d_y1), ndx = _mm_set1_pd(d_dx), ndy = _mm_set1_pd(d_dy);
+	for (; j + 2 <= count; j += 2)
+	{
+		__m128d a = _mm_mul_pd(_mm_sub_pd(ny, _mm_loadu_pd(y1 + j)), ndx);
+		__m128d b = _mm_mul_pd(_mm_sub_pd(nx, _mm_loadu_pd(x1 + j)), ndy);
+		_mm_storeu_pd(num1 + j, _mm_sub_pd(a, b));
+		a = _mm_mul_pd(_mm_sub_pd(ny, _mm_loadu_pd(y2 + j)), ndx);
+		b = _mm_mul_pd(_mm_sub_pd(nx, _mm_loadu_pd(x2 + j)), ndy);
+		_mm_storeu_pd(num2 + j, _mm_sub_pd(a, b));
+	}
+#elif defined(NODEBUILD_NEON)
+	const float64x2_t nx = vdupq_n_f64(d_x1), ny = vdupq_n_f64(d_y1), ndx = vdupq_n_f64(d_dx), ndy = vdupq_n_f64(d_dy);
+	for (; j + 2 <= count; j += 2)
+	{
+		float64x2_t a = vmulq_f64(vsubq_f64(ny, vld1q_f64(y1 + j)), ndx);
+		float64x2_t b = vmulq_f64(vsubq_f64(nx, vld1q_f64(x1 + j)), ndy);
+		vst1q_f64(num1 + j, vsubq_f64(a, b));
+		a = vmulq_f64(vsubq_f64(ny, vld1q_f64(y2 + j)), ndx);
+		b = vmulq_f64(vsubq_f64(nx, vld1q_f64(x2 + j)), ndy);
+		vst1q_f64(num2 + j, vsubq_f64(a, b));
+	}
+#endif
+	for (; j < count; j++)
+	{
+		num1[j] = (d_y1 - y1[j]) * d_dx - (d_x1 - x1[j]) * d_dy;
+		num2[j] = (d_y1 - y2[j]) * d_dx - (d_x1 - x2[j]) * d_dy;
+	}
+}
+
 #if 0
 #define D(x) x
 #else
@@ -104,8 +158,8 @@ void FNodeBuilder::Clear()
 	SegList.Clear();
 	PlaneChecked.Clear();
 	Planes.Clear();
-	Touched.Clear();
-	Colinear.Clear();
+	Scratch.Touched.Clear();
+	Scratch.Colinear.Clear();
 	SplitSharers.Clear();
 	if (VertexMap == NULL)
 	{
@@ -428,7 +482,8 @@ bool FNodeBuilder::ShoveSegBehind (uint32_t set, node_t &node, uint32_t seg, uin
 		node.dx = -node.dx;
 		node.dy = -node.dy;
 	}
-	return Heuristic (node, set, false) > 0;
+	CollectSetSegs (set);
+	return Heuristic (node, false, Scratch) > 0;
 }
 
 // Splitters are chosen to coincide with segs in the given set. To reduce the
@@ -456,6 +511,13 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 
 	D(Printf (PRINT_LOG, "Processing set %d\n", set));
 
+	// Which segs get tried does not depend on any of the scores, so collect them first.
+	SplitterCandidates.Clear();
+	SetSegs.Clear();
+	SetX1.Clear();
+	SetY1.Clear();
+	SetX2.Clear();
+	SetY2.Clear();
 	while (seg != UINT_MAX)
 	{
 		FPrivSeg *pseg = &Segs[seg];
@@ -473,28 +535,34 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 				}
 
 				stepleft = step;
-				SetNodeFromSeg (node, pseg);
-
-				int value = Heuristic (node, set, nosplit);
-
-				D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
-					(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
-
-				if (value > bestvalue)
-				{
-					bestvalue = value;
-					bestseg = seg;
-				}
-				else if (value < 0)
-				{
-					nosplitters = true;
-				}
+				SplitterCandidates.Push(seg);
 			}
 		}
 
+		AddSetSeg (seg);
 		seg = pseg->next;
 	}
 
+	ScoreSplitters (nosplit);
+
+	// Pick the winner in list order so that the result is the same no matter how the scoring was distributed.
+	for (unsigned i = 0; i < SplitterCandidates.Size(); i++)
+	{
+		int value = SplitterScores[i];
+
+		D(Printf (PRINT_LOG, "Seg %5d, ld %d scores %d\n", SplitterCandidates[i], Segs[SplitterCandidates[i]].linedef, value));
+
+		if (value > bestvalue)
+		{
+			bestvalue = value;
+			bestseg = SplitterCandidates[i];
+		}
+		else if (value < 0)
+		{
+			nosplitters = true;
+		}
+	}
+
 	if (bestseg == UINT_MAX)
 	{ // No lines split any others into two sets, so this is a convex region.
 	D(Printf (PRINT_LOG, "set %d, step %d, nosplit %d has no good splitter (%d)\n", set, step, nosplit, nosplitters));
@@ -508,13 +576,89 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 	return 1;
 }
 
+void FNodeBuilder::AddSetSeg (uint32_t segnum)
+{
+	const FPrivSeg *pseg = &Segs[segnum];
+	SetSegs.Push(segnum);
+	SetX1.Push(double(Vertices[pseg->v1].x));
+	SetY1.Push(double(Vertices[pseg->v1].y));
+	SetX2.Push(double(Vertices[pseg->v2].x));
+	SetY2.Push(double(Vertices[pseg->v2].y));
+}
+
+void FNodeBuilder::CollectSetSegs (uint32_t set)
+{
+	SetSegs.Clear();
+	SetX1.Clear();
+	SetY1.Clear();
+	SetX2.Clear();
+	SetY2.Clear();
+	for (uint32_t seg = set; seg != UINT_MAX; seg = Segs[seg].next)
+	{
+		AddSetSeg (seg);
+	}
+}
+
+// Scores all splitter candidates against the current set. Each candidate is
+// independent of the others, so large sets get split up between threads.
+// The map's geometry is not modified while this runs, so the only thing
+// the workers need for themselves are the scratch lists of Heuristic.
+
+void FNodeBuilder::ScoreSplitters (bool nosplit)
+{
+	unsigned numcandidates = SplitterCandidates.Size();
+	SplitterScores.Resize(numcandidates);
+
+	unsigned numthreads = std::thread::hardware_concurrency();
+	if (numthreads > 1 && numcandidates > 1 && (uint64_t)numcandidates * SetSegs.Size() >= ParallelScoreWork)
+	{
+		numthreads = MIN(numthreads, numcandidates);
+		if ((unsigned)NodeBuilderPool.size() != numthreads - 1) NodeBuilderPool.resize(numthreads - 1);
+
+		auto scoreRange = [=](unsigned start, unsigned end, FHeuristicScratch &scratch)
+		{
+			node_t node;
+			for (unsigned i = start; i < end; i++)
+			{
+				SetNodeFromSeg (node, &Segs[SplitterCandidates[i]]);
+				SplitterScores[i] = Heuristic (node, nosplit, scratch);
+			}
+		};
+
+		// The main thread scores the first slice itself.
+		std::vector<std::future<void>> jobs;
+		unsigned slice = (numcandidates + numthreads - 1) / numthreads;
+		for (unsigned t = 1; t < numthreads; t++)
+		{
+			unsigned start = t * slice, end = MIN(start + slice, numcandidates);
+			if (start >= end) break;
+			jobs.push_back(NodeBuilderPool.push([=](int)
+			{
+				FHeuristicScratch scratch;
+				scoreRange(start, end, scratch);
+			}));
+		}
+		scoreRange(0, MIN(slice, numcandidates), Scratch);
+		for (auto &job : jobs) job.get();
+	}
+	else
+	{
+		node_t node;
+		for (unsigned i = 0; i < numcandidates; i++)
+		{
+			SetNodeFromSeg (node, &Segs[SplitterCandidates[i]]);
+			SplitterScores[i] = Heuristic (node, nosplit, Scratch);
+		}
+	}
+}
+
 // Given a splitter (node), returns a score based on how "good" the resulting
 // split in a set of segs is. Higher scores are better. -1 means this splitter
 // splits something it shouldn't and will only be returned if honorNoSplit is
 // true. A score of 0 means that the splitter does not split any of the segs
 // in the set.
 
-int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
+int FNodeBuilder::Heuristic (node_t &node, bool honorNoSplit, FHeuristicScratch &scratch)
 {
 	// Set the initial score above 0 so that near vertex anti-weighting is less likely to produce a negative score.
 	int score = 1000000;
@@ -522,18 +666,28 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	int counts[2] = { 0, 0 };
 	int realSegs[2] = { 0, 0 };
 	int specialSegs[2] = { 0, 0 };
-	uint32_t i = set;
 	int sidev[2];
 	int side;
 	bool splitter = false;
 	unsigned int max, m2, p, q;
 	double frac;
+	TArray<int> &touched = scratch.Touched;
+	TArray<int> &colinear = scratch.Colinear;
+
+	touched.Clear ();
+	colinear.Clear ();
 
-	Touched.Clear ();
-	Colinear.Clear ();
+	// Calculate the side numerators for all segs of the set in one go, so that only the rare
+	// cases close to the splitter need any further work inside ClassifyLine.
+	const unsigned numsegs = SetSegs.Size();
+	scratch.Num1.Resize(numsegs);
+	scratch.Num2.Resize(numsegs);
+	CalcSideNumerators (SetX1.Data(), SetY1.Data(), SetX2.Data(), SetY2.Data(), scratch.Num1.Data(), scratch.Num2.Data(), numsegs,
+		double(node.x), double(node.y), double(node.dx), double(node.dy));
 
-	while (i != UINT_MAX)
+	for (unsigned j = 0; j < numsegs; j++)
 	{
+		const uint32_t i = SetSegs[j];
 		const FPrivSeg *test = &Segs[i];
 
 		if (HackSeg == i)
@@ -542,7 +696,7 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 		}
 		else
 		{
-			side = ClassifyLine (node, &Vertices[test->v1], &Vertices[test->v2], sidev);
+			side = ClassifyLine (node, scratch.Num1[j], scratch.Num2[j], &Vertices[test->v1], &Vertices[test->v2], sidev);
 		}
 		switch (side)
 		{
@@ -556,32 +710,32 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 			{
 				if ((sidev[0] | sidev[1]) != 0)
 				{
-					max = Touched.Size();
+					max = touched.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Touched[p] == test->loopnum)
+						if (touched[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Touched.Push (test->loopnum);
+						touched.Push (test->loopnum);
 					}
 				}
 				else
 				{
-					max = Colinear.Size();
+					max = colinear.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Colinear[p] == test->loopnum)
+						if (colinear[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Colinear.Push (test->loopnum);
+						colinear.Push (test->loopnum);
 					}
 				}
 			}
@@ -663,7 +817,6 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 		}
 
 		segsInSet++;
-		i = test->next;
 	}
 
 	// If this line is outside all the others, return a special score
@@ -698,8 +851,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	// seg of that sector must be crossing the container's corner and does not
 	// actually split the container.
 
-	max = Touched.Size ();
-	m2 = Colinear.Size ();
+	max = touched.Size ();
+	m2 = colinear.Size ();
 
 	// If honorNoSplit is false, then both these lists will be empty.
 
@@ -712,10 +865,10 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 
 	for (p = 0; p < max; ++p)
 	{
-		int look = Touched[p];
+		int look = touched[p];
 		for (q = 0; q < m2; ++q)
 		{
-			if (look == Colinear[q])
+			if (look == colinear[q])
 			{
 				break;
 			}
@@ -265,8 +265,21 @@ private:
 	TArray<uint8_t> PlaneChecked;
 	TArray<FSimpleLine> Planes;
 
-	TArray<int> Touched;	// Loops a splitter touches on a vertex
-	TArray<int> Colinear;	// Loops with edges colinear to a splitter
+	struct FHeuristicScratch
+	{
+		TArray<int> Touched;	// Loops a splitter touches on a vertex
+		TArray<int> Colinear;	// Loops with edges colinear to a splitter
+		TArray<double> Num1, Num2;	// Side numerators of the segs' vertices relative to the splitter
+	};
+
+	FHeuristicScratch Scratch;
+	TArray<uint32_t> SplitterCandidates;	// Segs SelectSplitter is going to score
+	TArray<int> SplitterScores;
+
+	// The segs of the set being split, with their coordinates stored as separate arrays
+	// so that a splitter can be classified against all of them in one vectorizable loop.
+	TArray<uint32_t> SetSegs;
+	TArray<double> SetX1, SetY1, SetX2, SetY2;
 	FEventTree Events;		// Vertices intersected by the current splitter
 
 	TArray<FSplitSharer> SplitSharers;	// Segs colinear with the current splitter
@@ -297,7 +310,10 @@ private:
 	bool ShoveSegBehind (uint32_t set, node_t &node, uint32_t seg, uint32_t mate);	int SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg, int step, bool nosplit);
 	void SplitSegs (uint32_t set, node_t &node, uint32_t splitseg, uint32_t &outset0, uint32_t &outset1, unsigned int &count0, unsigned int &count1);
 	uint32_t SplitSeg (uint32_t segnum, int splitvert, int v1InFront);
-	int Heuristic (node_t &node, uint32_t set, bool honorNoSplit);
+	int Heuristic (node_t &node, bool honorNoSplit, FHeuristicScratch &scratch);
+	void ScoreSplitters (bool nosplit);
+	void AddSetSeg (uint32_t segnum);
+	void CollectSetSegs (uint32_t set);
 
 	// Returns:
 	//	0 = seg is in front
@@ -306,6 +322,9 @@ private:
 
 	int ClassifyLine (node_t &node, const FPrivVert *v1, const FPrivVert *v2, int sidev[2]);
 
+	// Same as above, for when the side numerators of the two vertices have already been calculated.
+	int ClassifyLine (node_t &node, double s_num1, double s_num2, const FPrivVert *v1, const FPrivVert *v2, int sidev[2]);
+
 	void FixSplitSharers (const node_t &node);
 	double AddIntersection (const node_t &node, int vertex);
 	void AddMinisegs (const node_t &node, uint32_t splitseg, uint32_t &fset, uint32_t &rset);
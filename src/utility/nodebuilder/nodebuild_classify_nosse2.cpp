@@ -17,6 +17,13 @@ int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVer
 	double s_num1 = (d_y1 - d_yv1) * d_dx - (d_x1 - d_xv1) * d_dy;
 	double s_num2 = (d_y1 - d_yv2) * d_dx - (d_x1 - d_xv2) * d_dy;
 
+	return ClassifyLine(node, s_num1, s_num2, v1, v2, sidev);
+}
+
+int FNodeBuilder::ClassifyLine(node_t &node, double s_num1, double s_num2, const FPrivVert *v1, const FPrivVert *v2, int sidev[2])
+{
+	double d_dx = double(node.dx);
+	double d_dy = double(node.dy);
 	int nears = 0;
 
 	if (s_num1 <= -FAR_ENOUGH)
@@ -1,14 +1,36 @@
-
 layout(location=0) in vec4 vTexCoord;
 layout(location=1) in vec4 vColor;
 layout(location=0) out vec4 FragColor;
 
-void main()
+// The burn mask is generated here so that the wipe does not need to update
+// a texture every tic. The vertex color's alpha is the wipe's progress.
+// screen_shader.cpp's EffectBurn needs to stay in sync with this.
+
+float BurnHash(ivec2 p)
 {
-	vec4 frag = vColor;
+	uint h = uint(p.x) * 374761393u + uint(p.y) * 668265263u;
+	h = (h ^ (h >> 13)) * 1274126177u;
+	return float((h ^ (h >> 16)) & 0xffffu) / 65535.0;
+}
 
+float BurnNoise(vec2 p)
+{
+	ivec2 i = ivec2(floor(p));
+	vec2 f = fract(p);
+	f = f * f * (3.0 - 2.0 * f);
+	float a = mix(BurnHash(i), BurnHash(i + ivec2(1, 0)), f.x);
+	float b = mix(BurnHash(i + ivec2(0, 1)), BurnHash(i + ivec2(1, 1)), f.x);
+	return mix(a, b, f.y);
+}
+
+void main()
+{
 	vec4 t1 = texture(tex, vTexCoord.xy);
-	vec4 t2 = texture(texture2, vec2(vTexCoord.x, 1.0-vTexCoord.y));
-	
-	FragColor = frag * vec4(t1.r, t1.g, t1.b, t2.a);
+
+	// The fire starts at the bottom and climbs up.
+	vec2 p = vec2(vTexCoord.x * 16.0, (1.0 - vTexCoord.y) * 8.0);
+	float noise = (BurnNoise(p) * 4.0 + BurnNoise(p * 2.0) * 2.0 + BurnNoise(p * 4.0)) / 7.0;
+	float level = vColor.a * 1.75 - vTexCoord.y - noise * 0.5;
+
+	FragColor = vec4(vColor.rgb * t1.rgb, clamp(level * 4.0, 0.0, 1.0));
 }
@@ -44,6 +44,8 @@ vec2 GetTexCoord();
 const int TEXF_Brightmap = 0x10000;
 const int TEXF_Detailmap = 0x20000;
 const int TEXF_Glowmap = 0x40000;
+const int TEXF_Translated = 0x80000;
+const int TEXF_TranslatedFilter = 0x100000;
 
 //===========================================================================
 //
@@ -152,6 +154,38 @@ const int Tex_Blend_Hardlight = 4;
 	return texel;
 }
 
+//===========================================================================
+//
+// Translated paletted textures contain the color indices and
+// texture8 the translation's palette.
+//
+//===========================================================================
+
+vec4 getTranslatedIndex(vec2 st)
+{
+	float index = texture(tex, st).r;
+	return texture(texture8, vec2((index * 255.0 + 0.5) / 256.0, 0.5));
+}
+
+vec4 getTranslatedTexel(vec2 st)
+{
+	if ((uTextureMode & TEXF_TranslatedFilter) == 0) return getTranslatedIndex(st);
+
+	// Indices cannot be filtered so this has to be done on the translated colors.
+	// They get weighted by their alpha so that the transparent index does not darken the edges.
+	vec2 size = vec2(textureSize(tex, 0));
+	vec2 pos = st * size - 0.5;
+	vec2 f = fract(pos);
+	vec2 tl = (floor(pos) + 0.5) / size;
+	vec2 texelsize = 1.0 / size;
+	vec4 c00 = getTranslatedIndex(tl);
+	vec4 c10 = getTranslatedIndex(tl + vec2(texelsize.x, 0.0));
+	vec4 c01 = getTranslatedIndex(tl + vec2(0.0, texelsize.y));
+	vec4 c11 = getTranslatedIndex(tl + texelsize);
+	vec4 sum = mix(mix(vec4(c00.rgb * c00.a, c00.a), vec4(c10.rgb * c10.a, c10.a), f.x), mix(vec4(c01.rgb * c01.a, c01.a), vec4(c11.rgb * c11.a, c11.a), f.x), f.y);
+	return sum.a > 0.0 ? vec4(sum.rgb / sum.a, sum.a) : vec4(0.0);
+}
+
 //===========================================================================
 //
 // This function is common for all (non-special-effect) fragment shaders
@@ -160,7 +194,7 @@ const int Tex_Blend_Hardlight = 4;
 
 vec4 getTexel(vec2 st)
 {
-	vec4 texel = texture(tex, st);
+	vec4 texel = (uTextureMode & TEXF_Translated) != 0 ? getTranslatedTexel(st) : texture(tex, st);
 	
 	//
 	// Apply texture modes
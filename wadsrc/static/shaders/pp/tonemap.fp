@@ -79,11 +79,32 @@ vec3 Tonemap(vec3 color)
 #error Tonemap mode define is missing
 #endif
 
+#if defined(COLORMAP)
+
+// Same as colormap.fp, merged in here to save a full screen pass.
+vec3 Colormap(vec3 color)
+{
+	color = clamp(pow(color, vec3(uFixedColormapStart.a)), 0.0, 1.0);
+	if (uFixedColormapRange.a == 0)
+	{
+		float gray = (color.r * 0.3 + color.g * 0.56 + color.b * 0.14);
+		vec4 cm = uFixedColormapStart + gray * uFixedColormapRange;
+		color = clamp(cm.rgb, 0.0, 1.0);
+	}
+	return color;
+}
+
+#endif
+
 void main()
 {
 	vec3 color = texture(InputTexture, TexCoord).rgb;
 #ifndef PALETTE
 	color = Linear(color); // needed because gzdoom's scene texture is not linear at the moment
 #endif
-	FragColor = vec4(Tonemap(color), 1.0);
+	color = Tonemap(color);
+#if defined(COLORMAP)
+	color = Colormap(color);
+#endif
+	FragColor = vec4(color, 1.0);
 }